@@ -50,6 +50,7 @@ namespace DirectX
             protected:
                 // Internal, untyped drawing method.
                 void __cdecl Draw(D3D11_PRIMITIVE_TOPOLOGY topology, bool isIndexed, _In_opt_count_(indexCount) uint16_t const* indices, size_t indexCount, size_t vertexCount, _Out_ void** pMappedVertices);
+                void __cdecl Draw32(D3D11_PRIMITIVE_TOPOLOGY topology, bool isIndexed, _In_opt_count_(indexCount) uint32_t const* indices, size_t indexCount, size_t vertexCount, _Out_ void** pMappedVertices);
 
             private:
                 // Private implementation.
@@ -98,6 +99,16 @@ namespace DirectX
                 memcpy(mappedVertices, vertices, vertexCount * sizeof(TVertex));
             }
 
+            // 32-bit indices, for batches created with maxVertices above 65536.
+            void DrawIndexed(D3D11_PRIMITIVE_TOPOLOGY topology, _In_reads_(indexCount) uint32_t const* indices, size_t indexCount, _In_reads_(vertexCount) TVertex const* vertices, size_t vertexCount)
+            {
+                void* mappedVertices;
+
+                PrimitiveBatchBase::Draw32(topology, true, indices, indexCount, vertexCount, &mappedVertices);
+
+                memcpy(mappedVertices, vertices, vertexCount * sizeof(TVertex));
+            }
+
 
             void DrawLine(TVertex const& v1, TVertex const& v2)
             {
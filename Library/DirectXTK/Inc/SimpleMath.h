@@ -16,6 +16,7 @@
 
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
 #include <cstring>
 #include <functional>
 
@@ -110,6 +111,75 @@ namespace DirectX
             static RECT Union(const RECT& rcta, const RECT& rctb) noexcept;
         };
 
+        //------------------------------------------------------------------------------
+        // Structure-of-arrays vector streams, with each component in its own array, for the batch
+        // operations on Vector2, Vector3 and Vector4. These run with the widest SIMD instruction set
+        // the CPU supports (AVX-512, AVX2, or whatever DirectXMath was built for), chosen at runtime.
+        // The AVX2 and AVX-512 paths use fused multiply-add, so transformed results can differ in the
+        // last bits from the array overloads.
+        struct Vector2Stream
+        {
+            float* x;
+            float* y;
+
+            Vector2Stream() noexcept : x(nullptr), y(nullptr) {}
+            constexpr Vector2Stream(float* ix, float* iy) noexcept : x(ix), y(iy) {}
+        };
+
+        struct ConstVector2Stream
+        {
+            const float* x;
+            const float* y;
+
+            ConstVector2Stream() noexcept : x(nullptr), y(nullptr) {}
+            constexpr ConstVector2Stream(const float* ix, const float* iy) noexcept : x(ix), y(iy) {}
+            ConstVector2Stream(const Vector2Stream& s) noexcept : x(s.x), y(s.y) {}
+        };
+
+        struct Vector3Stream
+        {
+            float* x;
+            float* y;
+            float* z;
+
+            Vector3Stream() noexcept : x(nullptr), y(nullptr), z(nullptr) {}
+            constexpr Vector3Stream(float* ix, float* iy, float* iz) noexcept : x(ix), y(iy), z(iz) {}
+        };
+
+        struct ConstVector3Stream
+        {
+            const float* x;
+            const float* y;
+            const float* z;
+
+            ConstVector3Stream() noexcept : x(nullptr), y(nullptr), z(nullptr) {}
+            constexpr ConstVector3Stream(const float* ix, const float* iy, const float* iz) noexcept : x(ix), y(iy), z(iz) {}
+            ConstVector3Stream(const Vector3Stream& s) noexcept : x(s.x), y(s.y), z(s.z) {}
+        };
+
+        struct Vector4Stream
+        {
+            float* x;
+            float* y;
+            float* z;
+            float* w;
+
+            Vector4Stream() noexcept : x(nullptr), y(nullptr), z(nullptr), w(nullptr) {}
+            constexpr Vector4Stream(float* ix, float* iy, float* iz, float* iw) noexcept : x(ix), y(iy), z(iz), w(iw) {}
+        };
+
+        struct ConstVector4Stream
+        {
+            const float* x;
+            const float* y;
+            const float* z;
+            const float* w;
+
+            ConstVector4Stream() noexcept : x(nullptr), y(nullptr), z(nullptr), w(nullptr) {}
+            constexpr ConstVector4Stream(const float* ix, const float* iy, const float* iz, const float* iw) noexcept : x(ix), y(iy), z(iz), w(iw) {}
+            ConstVector4Stream(const Vector4Stream& s) noexcept : x(s.x), y(s.y), z(s.z), w(s.w) {}
+        };
+
         //------------------------------------------------------------------------------
         // 2D vector
         struct Vector2 : public XMFLOAT2
@@ -207,6 +277,12 @@ namespace DirectX
             static Vector2 TransformNormal(const Vector2& v, const Matrix& m) noexcept;
             static void TransformNormal(_In_reads_(count) const Vector2* varray, size_t count, const Matrix& m, _Out_writes_(count) Vector2* resultArray) noexcept;
 
+            // Structure-of-arrays streams. Results may be written over the inputs.
+            static void Transform(const ConstVector2Stream& v, size_t count, const Matrix& m, const Vector2Stream& result) noexcept;
+            static void TransformNormal(const ConstVector2Stream& v, size_t count, const Matrix& m, const Vector2Stream& result) noexcept;
+            static void Normalize(const ConstVector2Stream& v, size_t count, const Vector2Stream& result) noexcept;
+            static void Dot(const ConstVector2Stream& v1, const ConstVector2Stream& v2, size_t count, _Out_writes_(count) float* result) noexcept;
+
             // Constants
             static const Vector2 Zero;
             static const Vector2 One;
@@ -320,6 +396,12 @@ namespace DirectX
             static Vector3 TransformNormal(const Vector3& v, const Matrix& m) noexcept;
             static void TransformNormal(_In_reads_(count) const Vector3* varray, size_t count, const Matrix& m, _Out_writes_(count) Vector3* resultArray) noexcept;
 
+            // Structure-of-arrays streams. Results may be written over the inputs.
+            static void Transform(const ConstVector3Stream& v, size_t count, const Matrix& m, const Vector3Stream& result) noexcept;
+            static void TransformNormal(const ConstVector3Stream& v, size_t count, const Matrix& m, const Vector3Stream& result) noexcept;
+            static void Normalize(const ConstVector3Stream& v, size_t count, const Vector3Stream& result) noexcept;
+            static void Dot(const ConstVector3Stream& v1, const ConstVector3Stream& v2, size_t count, _Out_writes_(count) float* result) noexcept;
+
             // Constants
             static const Vector3 Zero;
             static const Vector3 One;
@@ -439,6 +521,11 @@ namespace DirectX
             static Vector4 Transform(const Vector4& v, const Matrix& m) noexcept;
             static void Transform(_In_reads_(count) const Vector4* varray, size_t count, const Matrix& m, _Out_writes_(count) Vector4* resultArray) noexcept;
 
+            // Structure-of-arrays streams. Results may be written over the inputs.
+            static void Transform(const ConstVector4Stream& v, size_t count, const Matrix& m, const Vector4Stream& result) noexcept;
+            static void Normalize(const ConstVector4Stream& v, size_t count, const Vector4Stream& result) noexcept;
+            static void Dot(const ConstVector4Stream& v1, const ConstVector4Stream& v2, size_t count, _Out_writes_(count) float* result) noexcept;
+
             // Constants
             static const Vector4 Zero;
             static const Vector4 One;
@@ -611,6 +698,19 @@ namespace DirectX
             static void Transform(const Matrix& M, const Quaternion& rotation, Matrix& result) noexcept;
             static Matrix Transform(const Matrix& M, const Quaternion& rotation) noexcept;
 
+            // Array operations, with results identical to M1[i] * M2[i]. The result array may be one of the inputs.
+            static void Multiply(_In_reads_(count) const Matrix* M1, _In_reads_(count) const Matrix* M2, size_t count, _Out_writes_(count) Matrix* result) noexcept;
+
+            // For affine M1[i] and M2[i] (last column 0, 0, 0, 1): the products without their last column,
+            // transposed, as bone palettes are passed to shaders (see IEffectSkinning::SetBoneTransforms).
+        #if DIRECTX_MATH_VERSION >= 313
+            static void MultiplyAffine(_In_reads_(count) const Matrix* M1, _In_reads_(count) const Matrix* M2, size_t count, _Out_writes_(count) XMFLOAT3X4* result) noexcept;
+        #endif
+
+            // Concatenates a hierarchy of local transforms: result[i] = local[i] * result[parents[i]], or
+            // local[i] * root where parents[i] is uint32_t(-1). Parents must come before their children.
+            static void MultiplyHierarchy(_In_reads_(count) const Matrix* local, _In_reads_(count) const uint32_t* parents, size_t count, const Matrix& root, _Out_writes_(count) Matrix* result) noexcept;
+
             // Constants
             static const Matrix Identity;
         };
@@ -765,6 +865,17 @@ namespace DirectX
 
             static float Angle(const Quaternion& q1, const Quaternion& q2) noexcept;
 
+            // Array operations on quaternions stored as separate x, y, z and w arrays, interpolating
+            // along the shorter arc like the single versions. Results may be written over either input.
+            static void Lerp(const ConstVector4Stream& q1, const ConstVector4Stream& q2, size_t count, float t, const Vector4Stream& result) noexcept;
+            static void Slerp(const ConstVector4Stream& q1, const ConstVector4Stream& q2, size_t count, float t, const Vector4Stream& result) noexcept;
+
+            // Approximates Slerp to within 1e-3 radians, for about the cost of Lerp.
+            static void FastSlerp(const ConstVector4Stream& q1, const ConstVector4Stream& q2, size_t count, float t, const Vector4Stream& result) noexcept;
+
+            // Normalized weighted sum of several poses, each negated where needed to share a hemisphere with poses[0].
+            static void Blend(_In_reads_(poseCount) const ConstVector4Stream* poses, _In_reads_(poseCount) const float* weights, size_t poseCount, size_t count, const Vector4Stream& result) noexcept;
+
             // Constants
             static const Quaternion Identity;
         };
@@ -777,6 +888,148 @@ namespace DirectX
         Quaternion operator/ (const Quaternion& Q1, const Quaternion& Q2) noexcept;
         Quaternion operator* (float S, const Quaternion& Q) noexcept;
 
+        //------------------------------------------------------------------------------
+        // Compact storage for large arrays of vectors, normals, rotations and transforms. Each converts
+        // to and from the full precision type on assignment, but has no math of its own.
+
+        // Vectors of 16-bit floats, which keep about three significant digits. The array conversions
+        // handle 8 or 16 components per instruction where the CPU supports it.
+        struct HalfVector2 : public PackedVector::XMHALF2
+        {
+            HalfVector2() noexcept : XMHALF2(0.f, 0.f) {}
+            HalfVector2(const Vector2& v) noexcept { PackedVector::XMStoreHalf2(this, XMLoadFloat2(&v)); }
+            explicit HalfVector2(FXMVECTOR V) noexcept { PackedVector::XMStoreHalf2(this, V); }
+            HalfVector2(const PackedVector::XMHALF2& h) noexcept : XMHALF2(h) {}
+
+            HalfVector2(const HalfVector2&) = default;
+            HalfVector2& operator=(const HalfVector2&) = default;
+
+            HalfVector2(HalfVector2&&) = default;
+            HalfVector2& operator=(HalfVector2&&) = default;
+
+            operator Vector2() const noexcept { return PackedVector::XMLoadHalf2(this); }
+
+            // The arrays must not overlap.
+            static void Pack(_In_reads_(count) const Vector2* varray, size_t count, _Out_writes_(count) HalfVector2* resultArray) noexcept;
+            static void Unpack(_In_reads_(count) const HalfVector2* varray, size_t count, _Out_writes_(count) Vector2* resultArray) noexcept;
+        };
+
+        struct HalfVector3
+        {
+            PackedVector::HALF x;
+            PackedVector::HALF y;
+            PackedVector::HALF z;
+
+            HalfVector3() noexcept : x(0), y(0), z(0) {}
+            HalfVector3(const Vector3& v) noexcept : HalfVector3(XMLoadFloat3(&v)) {}
+            explicit HalfVector3(FXMVECTOR V) noexcept;
+
+            HalfVector3(const HalfVector3&) = default;
+            HalfVector3& operator=(const HalfVector3&) = default;
+
+            HalfVector3(HalfVector3&&) = default;
+            HalfVector3& operator=(HalfVector3&&) = default;
+
+            operator Vector3() const noexcept;
+
+            // The arrays must not overlap.
+            static void Pack(_In_reads_(count) const Vector3* varray, size_t count, _Out_writes_(count) HalfVector3* resultArray) noexcept;
+            static void Unpack(_In_reads_(count) const HalfVector3* varray, size_t count, _Out_writes_(count) Vector3* resultArray) noexcept;
+        };
+
+        struct HalfVector4 : public PackedVector::XMHALF4
+        {
+            HalfVector4() noexcept : XMHALF4(0.f, 0.f, 0.f, 0.f) {}
+            HalfVector4(const Vector4& v) noexcept { PackedVector::XMStoreHalf4(this, XMLoadFloat4(&v)); }
+            explicit HalfVector4(FXMVECTOR V) noexcept { PackedVector::XMStoreHalf4(this, V); }
+            HalfVector4(const PackedVector::XMHALF4& h) noexcept : XMHALF4(h) {}
+
+            HalfVector4(const HalfVector4&) = default;
+            HalfVector4& operator=(const HalfVector4&) = default;
+
+            HalfVector4(HalfVector4&&) = default;
+            HalfVector4& operator=(HalfVector4&&) = default;
+
+            operator Vector4() const noexcept { return PackedVector::XMLoadHalf4(this); }
+
+            // The arrays must not overlap.
+            static void Pack(_In_reads_(count) const Vector4* varray, size_t count, _Out_writes_(count) HalfVector4* resultArray) noexcept;
+            static void Unpack(_In_reads_(count) const HalfVector4* varray, size_t count, _Out_writes_(count) Vector4* resultArray) noexcept;
+        };
+
+        // Direction in 4 bytes, octahedral encoded as two 16-bit normalized integers. Decodes to a unit
+        // vector within about 1e-4 radians of the original. Zero vectors come back as +Z.
+        struct PackedNormal : public PackedVector::XMSHORTN2
+        {
+            PackedNormal() noexcept : XMSHORTN2(int16_t(0), int16_t(0)) {}
+            PackedNormal(const Vector3& v) noexcept : PackedNormal(XMLoadFloat3(&v)) {}
+            explicit PackedNormal(FXMVECTOR V) noexcept;
+
+            PackedNormal(const PackedNormal&) = default;
+            PackedNormal& operator=(const PackedNormal&) = default;
+
+            PackedNormal(PackedNormal&&) = default;
+            PackedNormal& operator=(PackedNormal&&) = default;
+
+            operator Vector3() const noexcept;
+
+            // The arrays must not overlap.
+            static void Pack(_In_reads_(count) const Vector3* varray, size_t count, _Out_writes_(count) PackedNormal* resultArray) noexcept;
+            static void Unpack(_In_reads_(count) const PackedNormal* varray, size_t count, _Out_writes_(count) Vector3* resultArray) noexcept;
+        };
+
+        // Unit quaternion in 6 bytes, stored as its three smallest components to 15 bits each plus which
+        // component was left out. Decodes to a rotation within about 1e-4 radians of the original.
+        struct PackedQuaternion
+        {
+            // The low 15 bits of each hold a component. The top bits of the first two are the index of the missing one.
+            uint16_t packed[3];
+
+            PackedQuaternion() noexcept : packed{ 0xBFFF, 0xBFFF, 0x3FFF } {}
+            PackedQuaternion(const Quaternion& q) noexcept : PackedQuaternion(XMLoadFloat4(&q)) {}
+            explicit PackedQuaternion(FXMVECTOR V) noexcept;
+
+            PackedQuaternion(const PackedQuaternion&) = default;
+            PackedQuaternion& operator=(const PackedQuaternion&) = default;
+
+            PackedQuaternion(PackedQuaternion&&) = default;
+            PackedQuaternion& operator=(PackedQuaternion&&) = default;
+
+            operator Quaternion() const noexcept;
+
+            // The arrays must not overlap.
+            static void Pack(_In_reads_(count) const Quaternion* qarray, size_t count, _Out_writes_(count) PackedQuaternion* resultArray) noexcept;
+            static void Unpack(_In_reads_(count) const PackedQuaternion* qarray, size_t count, _Out_writes_(count) Quaternion* resultArray) noexcept;
+        };
+
+        // Matrix without its last column, which must be 0, 0, 0, 1, as it is for any combination of scales,
+        // rotations and translations. Converts back through Matrix(const XMFLOAT4X3&).
+        struct AffineMatrix : public XMFLOAT4X3
+        {
+            AffineMatrix() noexcept
+                : XMFLOAT4X3(1.f, 0, 0,
+                    0, 1.f, 0,
+                    0, 0, 1.f,
+                    0, 0, 0)
+            {
+            }
+            AffineMatrix(const Matrix& M) noexcept { XMStoreFloat4x3(this, XMLoadFloat4x4(&M)); }
+            explicit AffineMatrix(CXMMATRIX M) noexcept { XMStoreFloat4x3(this, M); }
+            AffineMatrix(const XMFLOAT4X3& M) noexcept : XMFLOAT4X3(M) {}
+
+            AffineMatrix(const AffineMatrix&) = default;
+            AffineMatrix& operator=(const AffineMatrix&) = default;
+
+            AffineMatrix(AffineMatrix&&) = default;
+            AffineMatrix& operator=(AffineMatrix&&) = default;
+
+            operator XMMATRIX() const noexcept { return XMLoadFloat4x3(this); }
+
+            // The arrays must not overlap.
+            static void Pack(_In_reads_(count) const Matrix* marray, size_t count, _Out_writes_(count) AffineMatrix* resultArray) noexcept;
+            static void Unpack(_In_reads_(count) const AffineMatrix* marray, size_t count, _Out_writes_(count) Matrix* resultArray) noexcept;
+        };
+
         //------------------------------------------------------------------------------
         // Color
         struct Color : public XMFLOAT4
@@ -865,6 +1118,32 @@ namespace DirectX
 
             static void Lerp(const Color& c1, const Color& c2, float t, Color& result) noexcept;
             static Color Lerp(const Color& c1, const Color& c2, float t) noexcept;
+
+            // Color arrays, such as images and vertex colors, which handle 2 or 4 colors per instruction where
+            // the CPU supports it. The result may be the same array as the source.
+            // SRGBToLinear and LinearToSRGB give the same results as XMColorSRGBToRGB and XMColorRGBToSRGB;
+            // the Fast versions are several times quicker, and within 1e-6 of them.
+            static void SRGBToLinear(_In_reads_(count) const Color* carray, size_t count, _Out_writes_(count) Color* resultArray) noexcept;
+            static void LinearToSRGB(_In_reads_(count) const Color* carray, size_t count, _Out_writes_(count) Color* resultArray) noexcept;
+            static void SRGBToLinearFast(_In_reads_(count) const Color* carray, size_t count, _Out_writes_(count) Color* resultArray) noexcept;
+            static void LinearToSRGBFast(_In_reads_(count) const Color* carray, size_t count, _Out_writes_(count) Color* resultArray) noexcept;
+
+            // Unpremultiply turns colors with no alpha into transparent black.
+            static void Premultiply(_In_reads_(count) const Color* carray, size_t count, _Out_writes_(count) Color* resultArray) noexcept;
+            static void Unpremultiply(_In_reads_(count) const Color* carray, size_t count, _Out_writes_(count) Color* resultArray) noexcept;
+
+            static void AdjustSaturation(_In_reads_(count) const Color* carray, size_t count, float sat, _Out_writes_(count) Color* resultArray) noexcept;
+
+            // 8-bit colors, rounded as by RGBA() and BGRA(). The arrays must not overlap.
+            static void Pack(_In_reads_(count) const Color* carray, size_t count, _Out_writes_(count) DirectX::PackedVector::XMUBYTEN4* resultArray) noexcept;
+            static void Pack(_In_reads_(count) const Color* carray, size_t count, _Out_writes_(count) DirectX::PackedVector::XMCOLOR* resultArray) noexcept;
+            static void Unpack(_In_reads_(count) const DirectX::PackedVector::XMUBYTEN4* carray, size_t count, _Out_writes_(count) Color* resultArray) noexcept;
+            static void Unpack(_In_reads_(count) const DirectX::PackedVector::XMCOLOR* carray, size_t count, _Out_writes_(count) Color* resultArray) noexcept;
+
+            // Converts between RGBA and BGRA 8-bit colors by swapping red and blue. The result may be the
+            // same memory as the source.
+            static void Swizzle(_In_reads_(count) const DirectX::PackedVector::XMUBYTEN4* carray, size_t count, _Out_writes_(count) DirectX::PackedVector::XMCOLOR* resultArray) noexcept;
+            static void Swizzle(_In_reads_(count) const DirectX::PackedVector::XMCOLOR* carray, size_t count, _Out_writes_(count) DirectX::PackedVector::XMUBYTEN4* resultArray) noexcept;
         };
 
         // Binary operators
@@ -903,6 +1182,41 @@ namespace DirectX
             bool Intersects(const Plane& plane, _Out_ float& Dist) const noexcept;
         };
 
+        //------------------------------------------------------------------------------
+        // Frustum culling of bounding volume arrays
+        class FrustumCuller
+        {
+        public:
+            // Normalized, with normals pointing into the frustum.
+            Plane planes[6];
+
+            explicit FrustumCuller(const BoundingFrustum& frustum) noexcept;
+            explicit FrustumCuller(const Matrix& viewProjection) noexcept;
+
+            FrustumCuller(const FrustumCuller&) = default;
+            FrustumCuller& operator=(const FrustumCuller&) = default;
+
+            FrustumCuller(FrustumCuller&&) = default;
+            FrustumCuller& operator=(FrustumCuller&&) = default;
+
+            // Sets bit (i % 32) of visible[i / 32] if volume i is not entirely behind any of the planes,
+            // testing 4 to 16 volumes at a time. Like most culling, this is conservative: volumes just
+            // outside the corners of the frustum, which BoundingFrustum::Contains finds DISJOINT, may
+            // still be reported as visible. Unused bits of the last word are cleared.
+            void Cull(_In_reads_(count) const BoundingSphere* spheres, size_t count, _Out_writes_((count + 31) / 32) uint32_t* visible) const noexcept;
+            void Cull(_In_reads_(count) const BoundingBox* boxes, size_t count, _Out_writes_((count + 31) / 32) uint32_t* visible) const noexcept;
+
+            // Structure-of-arrays spheres (centers and radii) and boxes (centers and extents).
+            void Cull(const ConstVector3Stream& centers, _In_reads_(count) const float* radii, size_t count, _Out_writes_((count + 31) / 32) uint32_t* visible) const noexcept;
+            void Cull(const ConstVector3Stream& centers, const ConstVector3Stream& extents, size_t count, _Out_writes_((count + 31) / 32) uint32_t* visible) const noexcept;
+
+            // Same results, with large arrays split across worker threads.
+            void CullParallel(_In_reads_(count) const BoundingSphere* spheres, size_t count, _Out_writes_((count + 31) / 32) uint32_t* visible) const;
+            void CullParallel(_In_reads_(count) const BoundingBox* boxes, size_t count, _Out_writes_((count + 31) / 32) uint32_t* visible) const;
+            void CullParallel(const ConstVector3Stream& centers, _In_reads_(count) const float* radii, size_t count, _Out_writes_((count + 31) / 32) uint32_t* visible) const;
+            void CullParallel(const ConstVector3Stream& centers, const ConstVector3Stream& extents, size_t count, _Out_writes_((count + 31) / 32) uint32_t* visible) const;
+        };
+
         //------------------------------------------------------------------------------
         // Viewport
         class Viewport
@@ -986,6 +1300,23 @@ namespace DirectX
             Vector3 Unproject(const Vector3& p, const Matrix& proj, const Matrix& view, const Matrix& world) const noexcept;
             void Unproject(const Vector3& p, const Matrix& proj, const Matrix& view, const Matrix& world, Vector3& result) const noexcept;
 
+            // Array versions, which combine the matrices and the viewport into one transform for the whole
+            // array. Results may differ from the single versions in the last bits, and may be written over
+            // the inputs.
+            void Project(_In_reads_(count) const Vector3* parray, size_t count, const Matrix& proj, const Matrix& view, const Matrix& world, _Out_writes_(count) Vector3* resultArray) const noexcept;
+            void Project(const ConstVector3Stream& p, size_t count, const Matrix& proj, const Matrix& view, const Matrix& world, const Vector3Stream& result) const noexcept;
+
+            void Unproject(_In_reads_(count) const Vector3* parray, size_t count, const Matrix& proj, const Matrix& view, const Matrix& world, _Out_writes_(count) Vector3* resultArray) const noexcept;
+            void Unproject(const ConstVector3Stream& p, size_t count, const Matrix& proj, const Matrix& view, const Matrix& world, const Vector3Stream& result) const noexcept;
+
+            // Screen rectangle, in whole pixels, covering each box as transformed by world. The part of a box
+            // behind the camera is left out, and the rectangle is clipped to the viewport. Boxes entirely off
+            // screen get empty rectangles. Returns the number of boxes at least partly on screen.
+            size_t ProjectBounds(_In_reads_(count) const BoundingBox* boxes, size_t count, const Matrix& proj, const Matrix& view, const Matrix& world, _Out_writes_(count) Rectangle* resultArray) const noexcept;
+
+            // Same results, with large arrays split across worker threads.
+            size_t ProjectBoundsParallel(_In_reads_(count) const BoundingBox* boxes, size_t count, const Matrix& proj, const Matrix& view, const Matrix& world, _Out_writes_(count) Rectangle* resultArray) const;
+
             // Static methods
         #if defined(__dxgi1_2_h__) || defined(__d3d11_x_h__) || defined(__d3d12_x_h__) || defined(__XBOX_D3D12_X__)
             static RECT __cdecl ComputeDisplayArea(DXGI_SCALING scaling, UINT backBufferWidth, UINT backBufferHeight, int outputWidth, int outputHeight) noexcept;
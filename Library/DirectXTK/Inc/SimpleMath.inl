@@ -3307,6 +3307,126 @@ inline float Quaternion::Angle(const Quaternion& q1, const Quaternion& q2) noexc
 }
 
 
+/****************************************************************************
+ *
+ * Compact storage
+ *
+ ****************************************************************************/
+
+inline HalfVector3::HalfVector3(FXMVECTOR V) noexcept
+{
+    using namespace DirectX;
+    PackedVector::XMHALF4 h;
+    PackedVector::XMStoreHalf4(&h, V);
+    x = h.x;
+    y = h.y;
+    z = h.z;
+}
+
+inline HalfVector3::operator Vector3() const noexcept
+{
+    using namespace DirectX;
+    const PackedVector::XMHALF4 h(x, y, z, 0);
+    return PackedVector::XMLoadHalf4(&h);
+}
+
+inline PackedNormal::PackedNormal(FXMVECTOR V) noexcept
+{
+    using namespace DirectX;
+
+    // Project onto the octahedron |x| + |y| + |z| = 1, then fold its lower half out over the corners.
+    const XMVECTOR A = XMVectorAbs(V);
+    const float l1 = XMVectorGetX(A) + XMVectorGetY(A) + XMVectorGetZ(A);
+
+    XMVECTOR P = (l1 > 0.f) ? XMVectorScale(V, 1.f / l1) : g_XMZero;
+
+    if (XMVectorGetZ(P) < 0.f)
+    {
+        // (1 - |y|, 1 - |x|), keeping the signs of x and y
+        const XMVECTOR F = XMVectorSubtract(g_XMOne, XMVectorAbs(XMVectorSwizzle<1, 0, 2, 3>(P)));
+        P = XMVectorSelect(F, XMVectorNegate(F), XMVectorLess(P, g_XMZero));
+    }
+
+    PackedVector::XMStoreShortN2(this, P);
+}
+
+inline PackedNormal::operator Vector3() const noexcept
+{
+    using namespace DirectX;
+
+    XMVECTOR P = PackedVector::XMLoadShortN2(this);
+
+    const XMVECTOR A = XMVectorAbs(P);
+    const float z = 1.f - XMVectorGetX(A) - XMVectorGetY(A);
+
+    if (z < 0.f)
+    {
+        // The fold is its own inverse.
+        const XMVECTOR F = XMVectorSubtract(g_XMOne, XMVectorAbs(XMVectorSwizzle<1, 0, 2, 3>(P)));
+        P = XMVectorSelect(F, XMVectorNegate(F), XMVectorLess(P, g_XMZero));
+    }
+
+    return XMVector3Normalize(XMVectorSetZ(P, z));
+}
+
+inline PackedQuaternion::PackedQuaternion(FXMVECTOR V) noexcept
+{
+    using namespace DirectX;
+
+    XMFLOAT4 q;
+    XMStoreFloat4(&q, V);
+
+    const float c[4] = { q.x, q.y, q.z, q.w };
+
+    uint32_t largest = 0;
+    for (uint32_t i = 1; i < 4; i++)
+    {
+        if (fabsf(c[i]) > fabsf(c[largest]))
+            largest = i;
+    }
+
+    // q and -q are the same rotation, so the missing component is made positive. The others are then
+    // within +/- 1/sqrt(2), which maps to 0 to 32766 (with 0 exactly at 16383).
+    const float scale = (c[largest] < 0.f) ? -1.41421356f * 16383.f : 1.41421356f * 16383.f;
+
+    for (uint32_t i = 0, j = 0; i < 4; i++)
+    {
+        if (i == largest)
+            continue;
+
+        auto bits = static_cast<uint32_t>(XMMin(XMMax(c[i] * scale + 16383.5f, 0.f), 32766.f));
+
+        if (j < 2)
+            bits |= ((largest >> j) & 1u) << 15;
+
+        packed[j++] = static_cast<uint16_t>(bits);
+    }
+}
+
+inline PackedQuaternion::operator Quaternion() const noexcept
+{
+    using namespace DirectX;
+
+    const uint32_t largest = (uint32_t(packed[0]) >> 15) | ((uint32_t(packed[1]) >> 15) << 1);
+
+    float c[4] = {};
+    float sum = 0.f;
+
+    for (uint32_t i = 0, j = 0; i < 4; i++)
+    {
+        if (i == largest)
+            continue;
+
+        c[i] = (float(packed[j++] & 0x7FFFu) - 16383.f) * (1.f / (1.41421356f * 16383.f));
+        sum += c[i] * c[i];
+    }
+
+    c[largest] = sqrtf(XMMax(1.f - sum, 0.f));
+
+    return XMQuaternionNormalize(XMVectorSet(c[0], c[1], c[2], c[3]));
+}
+
+
 /****************************************************************************
  *
  * Color
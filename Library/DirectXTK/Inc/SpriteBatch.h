@@ -45,6 +45,27 @@ namespace DirectX
             SpriteEffects_FlipBoth = SpriteEffects_FlipHorizontally | SpriteEffects_FlipVertically,
         };
 
+        struct SpriteBatchStatistics
+        {
+            size_t      spritesQueued;          // Sprites drawn between Begin and End
+            size_t      spritesCulled;          // Sprites skipped by culling
+            size_t      batchesIssued;          // Draw calls issued
+            size_t      textureChanges;         // Batches split off because the texture changed, or all texture slots were in use
+            size_t      bufferWraps;            // Times the vertex or instance buffer ran out of room and was discarded
+            size_t      bytesMapped;            // Vertex, texture slot and instance data written to mapped buffers
+            uint64_t    sortMicroseconds;       // Time spent sorting and culling queued sprites, if SetStageTiming is on
+            uint64_t    expandMicroseconds;     // Time spent generating vertices or instances, if SetStageTiming is on
+            uint64_t    submitMicroseconds;     // Time spent mapping buffers and issuing draws, excluding expansion, if SetStageTiming is on
+        };
+
+        // One sprite of a run drawn by SpriteBatch::DrawRun. Origin is in source pixels, as for Draw.
+        struct SpriteRunElement
+        {
+            XMFLOAT2    position;
+            XMFLOAT2    origin;
+            RECT        sourceRectangle;
+        };
+
         class SpriteBatch
         {
         public:
@@ -82,6 +103,119 @@ namespace DirectX
             void XM_CALLCONV Draw(_In_ ID3D11ShaderResourceView* texture, RECT const& destinationRectangle, FXMVECTOR color = Colors::White);
             void XM_CALLCONV Draw(_In_ ID3D11ShaderResourceView* texture, RECT const& destinationRectangle, _In_opt_ RECT const* sourceRectangle, FXMVECTOR color = Colors::White, float rotation = 0, XMFLOAT2 const& origin = Float2Zero, SpriteEffects effects = SpriteEffects_None, float layerDepth = 0);
 
+            // Draw a run of sprites that share a texture, color, rotation, scale, effects and depth, such as the glyphs of one or
+            // more strings. Same result as calling Draw for each element in turn, but the arguments are checked and the queue
+            // grown once for the whole run, which makes it much cheaper for large numbers of small sprites.
+            void XM_CALLCONV DrawRun(_In_ ID3D11ShaderResourceView* texture, _In_reads_(count) SpriteRunElement const* elements, size_t count, FXMVECTOR color = Colors::White, float rotation = 0, FXMVECTOR scale = g_XMOne, SpriteEffects effects = SpriteEffects_None, float layerDepth = 0);
+
+            // Rotation mode to be applied to the sprite transformation
+            void __cdecl SetRotation(DXGI_MODE_ROTATION mode);
+            DXGI_MODE_ROTATION __cdecl GetRotation() const noexcept;
+
+            // Set viewport for sprite transformation
+            void __cdecl SetViewport(const D3D11_VIEWPORT& viewPort);
+
+            // Generate vertices for batches of at least 'threshold' sprites on a pool of worker threads (off by default)
+            void __cdecl SetParallelVertexGeneration(bool enable, size_t threshold = 512) noexcept;
+
+            // Let each draw call sample from up to 'count' textures, so sprites using different textures no longer
+            // break the batch (1 by default). Values above 1 require Feature Level 10.0, and are ignored while custom
+            // shaders are set, since those expect a single texture.
+            void __cdecl SetMaxTexturesPerBatch(size_t count);
+
+            // Let Draw be called from several threads at once between Begin and End (off by default). Each thread
+            // records into its own queue, and End merges them: Deferred mode draws each thread's sprites in the order
+            // that thread submitted them, with threads in the order they first drew; sorted modes sort the merged
+            // sprites as usual. Begin and End must still be called from one thread, before and after all the others
+            // have finished drawing. Cannot be combined with SpriteSortMode_Immediate.
+            void __cdecl SetThreadedRecording(bool enable);
+
+            // Upload one 64 byte instance per sprite and expand the corners in the vertex shader, instead of four 36 byte
+            // vertices (off by default). Batches are then no longer limited by the 16-bit index buffer. Requires Feature
+            // Level 10.0, and is ignored while custom shaders are set, since those expect the usual vertex layout.
+            void __cdecl SetInstancedRendering(bool enable);
+
+            // Statistics for the most recent Begin/End pair, or for the current one while it is in progress.
+            SpriteBatchStatistics __cdecl GetStatistics() const noexcept;
+
+            // Mark the sort, expand and submit stages with trace events for graphics debuggers (off by default).
+            void __cdecl SetTraceEvents(bool enable) noexcept;
+
+            // Time the sort, expand and submit stages for GetStatistics (off by default). This reads the clock around every
+            // stage, which SpriteSortMode_Immediate runs for each sprite.
+            void __cdecl SetStageTiming(bool enable) noexcept;
+
+            // Skip sprites whose rotated bounds lie entirely outside the viewport, or outside an optional clip rectangle in
+            // untransformed screen pixels, before expanding them into vertices (off by default). Only applies to queued sort
+            // modes, and is skipped when the transform matrix includes a perspective projection.
+            void __cdecl SetCulling(bool enable, _In_opt_ RECT const* clipRectangle = nullptr) noexcept;
+
+            // Number of sprites culled since the last Begin.
+            size_t __cdecl GetCulledSpriteCount() const noexcept;
+
+            static constexpr size_t MaxTexturesPerBatch = 8;
+
+        private:
+            // Private implementation.
+            struct Impl;
+
+            std::unique_ptr<Impl> pImpl;
+
+            static const XMMATRIX MatrixIdentity;
+            static const XMFLOAT2 Float2Zero;
+
+            friend class StaticSpriteBatch;
+        };
+
+
+        // Retained companion to SpriteBatch, for content that rarely changes such as tile layers and HUD frames.
+        // Sprites are recorded once, then sorted and expanded into a GPU vertex buffer that Render replays with
+        // only a change of transform. Ranges of recorded sprites can be redrawn in place without a full rebuild.
+        class StaticSpriteBatch
+        {
+        public:
+            explicit StaticSpriteBatch(_In_ ID3D11DeviceContext* deviceContext);
+
+            StaticSpriteBatch(StaticSpriteBatch&&) noexcept;
+            StaticSpriteBatch& operator= (StaticSpriteBatch&&) noexcept;
+
+            StaticSpriteBatch(StaticSpriteBatch const&) = delete;
+            StaticSpriteBatch& operator= (StaticSpriteBatch const&) = delete;
+
+            virtual ~StaticSpriteBatch();
+
+            // Begin/End recording sprites, replacing any previous contents. Sprites are numbered in the order they are drawn.
+            void __cdecl Begin(SpriteSortMode sortMode = SpriteSortMode_Deferred);
+            void __cdecl End();
+
+            // Begin redrawing recorded sprites in place, starting from the specified sprite number. Redrawn sprites
+            // must use the same texture as before, and keep their original position in the sort order.
+            void __cdecl BeginUpdate(size_t firstSprite);
+
+            // Draw overloads, matching those of SpriteBatch.
+            void XM_CALLCONV Draw(_In_ ID3D11ShaderResourceView* texture, XMFLOAT2 const& position, FXMVECTOR color = Colors::White);
+            void XM_CALLCONV Draw(_In_ ID3D11ShaderResourceView* texture, XMFLOAT2 const& position, _In_opt_ RECT const* sourceRectangle, FXMVECTOR color = Colors::White, float rotation = 0, XMFLOAT2 const& origin = Float2Zero, float scale = 1, SpriteEffects effects = SpriteEffects_None, float layerDepth = 0);
+            void XM_CALLCONV Draw(_In_ ID3D11ShaderResourceView* texture, XMFLOAT2 const& position, _In_opt_ RECT const* sourceRectangle, FXMVECTOR color, float rotation, XMFLOAT2 const& origin, XMFLOAT2 const& scale, SpriteEffects effects = SpriteEffects_None, float layerDepth = 0);
+
+            void XM_CALLCONV Draw(_In_ ID3D11ShaderResourceView* texture, FXMVECTOR position, FXMVECTOR color = Colors::White);
+            void XM_CALLCONV Draw(_In_ ID3D11ShaderResourceView* texture, FXMVECTOR position, _In_opt_ RECT const* sourceRectangle, FXMVECTOR color = Colors::White, float rotation = 0, FXMVECTOR origin = g_XMZero, float scale = 1, SpriteEffects effects = SpriteEffects_None, float layerDepth = 0);
+            void XM_CALLCONV Draw(_In_ ID3D11ShaderResourceView* texture, FXMVECTOR position, _In_opt_ RECT const* sourceRectangle, FXMVECTOR color, float rotation, FXMVECTOR origin, GXMVECTOR scale, SpriteEffects effects = SpriteEffects_None, float layerDepth = 0);
+
+            void XM_CALLCONV Draw(_In_ ID3D11ShaderResourceView* texture, RECT const& destinationRectangle, FXMVECTOR color = Colors::White);
+            void XM_CALLCONV Draw(_In_ ID3D11ShaderResourceView* texture, RECT const& destinationRectangle, _In_opt_ RECT const* sourceRectangle, FXMVECTOR color = Colors::White, float rotation = 0, XMFLOAT2 const& origin = Float2Zero, SpriteEffects effects = SpriteEffects_None, float layerDepth = 0);
+
+            void XM_CALLCONV DrawRun(_In_ ID3D11ShaderResourceView* texture, _In_reads_(count) SpriteRunElement const* elements, size_t count, FXMVECTOR color = Colors::White, float rotation = 0, FXMVECTOR scale = g_XMOne, SpriteEffects effects = SpriteEffects_None, float layerDepth = 0);
+
+            // Draws all the recorded sprites.
+            void XM_CALLCONV Render(FXMMATRIX transformMatrix = MatrixIdentity,
+                _In_opt_ ID3D11BlendState* blendState = nullptr,
+                _In_opt_ ID3D11SamplerState* samplerState = nullptr,
+                _In_opt_ ID3D11DepthStencilState* depthStencilState = nullptr,
+                _In_opt_ ID3D11RasterizerState* rasterizerState = nullptr,
+                _In_opt_ std::function<void __cdecl()> setCustomShaders = nullptr);
+
+            size_t __cdecl GetSpriteCount() const noexcept;
+
             // Rotation mode to be applied to the sprite transformation
             void __cdecl SetRotation(DXGI_MODE_ROTATION mode);
             DXGI_MODE_ROTATION __cdecl GetRotation() const noexcept;
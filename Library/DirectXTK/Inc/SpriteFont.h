@@ -20,12 +20,87 @@ namespace DirectX
 {
     inline namespace DX11
     {
+        enum TextWrapping : uint32_t
+        {
+            TextWrapping_None,
+            TextWrapping_Word,          // Break at whitespace, or between characters if a word does not fit on a line of its own
+            TextWrapping_Character,
+        };
+
+        enum TextAlignment : uint32_t
+        {
+            TextAlignment_Left,
+            TextAlignment_Center,
+            TextAlignment_Right,
+        };
+
+        struct TextLayoutOptions
+        {
+            float           maxWidth;   // Width to wrap lines at, or to truncate them at if wrapping is off and ellipsis is set. 0 for no limit
+            float           maxHeight;  // Lines that would not fit within this height are dropped. 0 for no limit
+            TextWrapping    wrapping;
+            TextAlignment   alignment;  // Relative to maxWidth, or to the widest line if there is no limit
+            bool            ellipsis;   // End truncated lines with U+2026, or "..." if the font does not contain it
+        };
+
+        struct TextMetrics
+        {
+            XMFLOAT2        size;       // Same as MeasureString
+            RECT            drawBounds; // Same as MeasureDrawBounds at the position given
+            size_t          lineCount;  // Each line break starts a new line, even if it is empty
+        };
+
+        // A string laid out once by SpriteFont::CreateLayout, which can then be drawn and measured
+        // repeatedly without looking up its glyphs again. Copies share the same immutable data.
+        // A layout refers to the glyphs of the font that created it, so must not outlive it.
+        class TextLayout
+        {
+        public:
+            TextLayout() noexcept;
+
+            TextLayout(TextLayout&&) noexcept;
+            TextLayout& operator= (TextLayout&&) noexcept;
+
+            TextLayout(TextLayout const&);
+            TextLayout& operator= (TextLayout const&);
+
+            virtual ~TextLayout();
+
+            // Same results as SpriteFont::DrawString for the text the layout was created from, if created without options.
+            void XM_CALLCONV Draw(_In_ SpriteBatch* spriteBatch, FXMVECTOR position, FXMVECTOR color = Colors::White, float rotation = 0, FXMVECTOR origin = g_XMZero, float scale = 1, SpriteEffects effects = SpriteEffects_None, float layerDepth = 0) const;
+            void XM_CALLCONV Draw(_In_ SpriteBatch* spriteBatch, FXMVECTOR position, FXMVECTOR color, float rotation, FXMVECTOR origin, GXMVECTOR scale, SpriteEffects effects = SpriteEffects_None, float layerDepth = 0) const;
+
+            // Same as SpriteFont::MeasureString and MeasureDrawBounds with ignoreWhitespace = true, for the wrapped and aligned text.
+            XMVECTOR XM_CALLCONV GetSize() const noexcept;
+            RECT __cdecl GetDrawBounds(XMFLOAT2 const& position) const noexcept;
+
+            // Line metrics. Each line break starts a new line, even if it is empty.
+            size_t __cdecl GetGlyphCount() const noexcept;
+            size_t __cdecl GetLineCount() const noexcept;
+            float __cdecl GetLineWidth(size_t line) const;
+
+            // True if maxWidth or maxHeight cut any text off.
+            bool __cdecl IsTruncated() const noexcept;
+
+        private:
+            friend class SpriteFont;
+
+            // Private implementation.
+            class Impl;
+
+            std::shared_ptr<Impl const> pImpl;
+        };
+
+
         class SpriteFont
         {
         public:
             struct Glyph;
 
-            SpriteFont(_In_ ID3D11Device* device, _In_z_ wchar_t const* fileName, bool forceSRGB = false);
+            // Loading from a file maps it into memory and uses the glyphs in place, so the file stays open for as long as the
+            // font exists, and on Windows it cannot be overwritten or deleted until then. Pass keepFileMapped = false to copy
+            // the glyphs instead and release the file as soon as the font is loaded.
+            SpriteFont(_In_ ID3D11Device* device, _In_z_ wchar_t const* fileName, bool forceSRGB = false, bool keepFileMapped = true);
             SpriteFont(_In_ ID3D11Device* device, _In_reads_bytes_(dataSize) uint8_t const* dataBlob, _In_ size_t dataSize, bool forceSRGB = false);
             SpriteFont(_In_ ID3D11ShaderResourceView* texture, _In_reads_(glyphCount) Glyph const* glyphs, _In_ size_t glyphCount, _In_ float lineSpacing);
 
@@ -48,6 +123,9 @@ namespace DirectX
             RECT __cdecl MeasureDrawBounds(_In_z_ wchar_t const* text, XMFLOAT2 const& position, bool ignoreWhitespace = true) const;
             RECT XM_CALLCONV MeasureDrawBounds(_In_z_ wchar_t const* text, FXMVECTOR position, bool ignoreWhitespace = true) const;
 
+            // MeasureString and MeasureDrawBounds together, measured in a single pass.
+            TextMetrics __cdecl MeasureText(_In_z_ wchar_t const* text, XMFLOAT2 const& position = Float2Zero, bool ignoreWhitespace = true) const;
+
             // UTF-8
             void XM_CALLCONV DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ char const* text, XMFLOAT2 const& position, FXMVECTOR color = Colors::White, float rotation = 0, XMFLOAT2 const& origin = Float2Zero, float scale = 1, SpriteEffects effects = SpriteEffects_None, float layerDepth = 0) const;
             void XM_CALLCONV DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ char const* text, XMFLOAT2 const& position, FXMVECTOR color, float rotation, XMFLOAT2 const& origin, XMFLOAT2 const& scale, SpriteEffects effects = SpriteEffects_None, float layerDepth = 0) const;
@@ -59,12 +137,35 @@ namespace DirectX
             RECT __cdecl MeasureDrawBounds(_In_z_ char const* text, XMFLOAT2 const& position, bool ignoreWhitespace = true) const;
             RECT XM_CALLCONV MeasureDrawBounds(_In_z_ char const* text, FXMVECTOR position, bool ignoreWhitespace = true) const;
 
+            TextMetrics __cdecl MeasureText(_In_z_ char const* text, XMFLOAT2 const& position = Float2Zero, bool ignoreWhitespace = true) const;
+
+            // Precomputed layouts, for text that is drawn many times, optionally wrapped and aligned within a box.
+            TextLayout __cdecl CreateLayout(_In_z_ wchar_t const* text) const;
+            TextLayout __cdecl CreateLayout(_In_z_ char const* text) const;
+            TextLayout __cdecl CreateLayout(_In_z_ wchar_t const* text, TextLayoutOptions const& options) const;
+            TextLayout __cdecl CreateLayout(_In_z_ char const* text, TextLayoutOptions const& options) const;
+
+            // Lays out text with the same options as an earlier layout from this font, only redoing the lines from the
+            // first change onwards. Much faster for text that grows or is edited at the end, such as logs and text input.
+            TextLayout __cdecl UpdateLayout(TextLayout const& previous, _In_z_ wchar_t const* text) const;
+            TextLayout __cdecl UpdateLayout(TextLayout const& previous, _In_z_ char const* text) const;
+
+            // Optional cache of layouts used by DrawString and MeasureString, holding up to maxEntries
+            // recently used strings. Zero (the default) disables it. Changing the line spacing or the
+            // default character empties the cache.
+            void __cdecl SetLayoutCacheSize(size_t maxEntries);
+            size_t __cdecl GetLayoutCacheSize() const noexcept;
+
             // Spacing properties
             float __cdecl GetLineSpacing() const noexcept;
             void __cdecl SetLineSpacing(float spacing);
 
             // Font properties
+            // Where wchar_t is 16-bit, GetDefaultCharacter cannot hold a default outside the Basic
+            // Multilingual Plane, which a .spritefont file can specify, and returns it truncated.
+            // GetDefaultCodePoint always returns the full code point, or 0 if there is no default.
             wchar_t __cdecl GetDefaultCharacter() const noexcept;
+            uint32_t __cdecl GetDefaultCodePoint() const noexcept;
             void __cdecl SetDefaultCharacter(wchar_t character);
 
             bool __cdecl ContainsCharacter(wchar_t character) const;
@@ -0,0 +1,82 @@
+//--------------------------------------------------------------------------------------
+// File: TriangleBVH.h
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SimpleMath.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+
+namespace DirectX
+{
+    // Bounding volume hierarchy over an indexed triangle mesh, for picking with SimpleMath::Ray
+    // without testing every triangle. Triangles are numbered in index buffer order (index / 3).
+    class TriangleBVH
+    {
+    public:
+        static constexpr uint32_t NoHit = uint32_t(-1);
+
+        TriangleBVH() noexcept(false);
+
+        TriangleBVH(TriangleBVH&&) noexcept;
+        TriangleBVH& operator= (TriangleBVH&&) noexcept;
+
+        TriangleBVH(TriangleBVH const&) = delete;
+        TriangleBVH& operator= (TriangleBVH const&) = delete;
+
+        virtual ~TriangleBVH();
+
+        // Builds the tree with the surface area heuristic, using the worker threads for large meshes.
+        // Vertex positions are the first three floats of each vertex, so the vertex types from
+        // VertexTypes.h, and the VertexCollection from GeometricPrimitive, can be used directly.
+        void __cdecl Build(_In_reads_bytes_(vertexCount * vertexStride) void const* vertices, size_t vertexCount, size_t vertexStride,
+            _In_reads_(indexCount) uint16_t const* indices, size_t indexCount);
+        void __cdecl Build(_In_reads_bytes_(vertexCount * vertexStride) void const* vertices, size_t vertexCount, size_t vertexStride,
+            _In_reads_(indexCount) uint32_t const* indices, size_t indexCount);
+
+        template<typename TVertex, typename TIndex>
+        void Build(std::vector<TVertex> const& vertices, std::vector<TIndex> const& indices)
+        {
+            Build(vertices.data(), vertices.size(), sizeof(TVertex), indices.data(), indices.size());
+        }
+
+        // Updates the bounds for vertices that have moved, such as after skinning, keeping the tree.
+        // Much cheaper than Build, but picking slows down if the mesh deforms far from the original.
+        void __cdecl Refit(_In_reads_bytes_(vertexCount * vertexStride) void const* vertices, size_t vertexCount, size_t vertexStride);
+
+        template<typename TVertex>
+        void Refit(std::vector<TVertex> const& vertices)
+        {
+            Refit(vertices.data(), vertices.size(), sizeof(TVertex));
+        }
+
+        // Nearest triangle along the ray. As for Ray::Intersects, the direction must be normalized,
+        // and dist is set to zero when nothing is hit.
+        bool __cdecl Intersects(SimpleMath::Ray const& ray, _Out_ float& dist, _Out_opt_ uint32_t* triangle = nullptr) const noexcept;
+
+        // Nearest triangle along each ray, traced in packets of 4, 8 or 16 depending on the CPU, which
+        // is fastest for rays that go in similar directions. Misses get NoHit. Returns the number of hits.
+        size_t __cdecl Intersects(_In_reads_(count) SimpleMath::Ray const* rays, size_t count,
+            _Out_writes_(count) float* dist, _Out_writes_(count) uint32_t* triangles) const noexcept;
+
+        size_t __cdecl GetTriangleCount() const noexcept;
+
+        BoundingBox __cdecl GetBounds() const noexcept;
+
+    private:
+        // Private implementation.
+        class Impl;
+
+        std::unique_ptr<Impl> pImpl;
+    };
+}
@@ -0,0 +1,122 @@
+//--------------------------------------------------------------------------------------
+// File: AdaptiveRing.h
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace DirectX
+{
+    // Sizing policy for a dynamic buffer that is filled as a ring and mapped with discard each
+    // time it wraps. Every discard can make the driver rename the buffer, so the ring grows when
+    // the observed demand makes it wrap often, and slowly shrinks back when demand drops.
+    //
+    // Demand is reported once per interval, which should be one frame of the buffer's users: a
+    // Begin/End pair for PrimitiveBatch, which owns its buffers, and the Begin/End pairs of every
+    // batch on the device context for SpriteBatch, which shares them. The policy is independent
+    // of Direct3D so it can be simulated from recorded per-frame counts.
+    class AdaptiveRingSizer
+    {
+    public:
+        // Number of intervals over which wraps and peak demand are gathered before deciding whether to resize.
+        static constexpr size_t WindowSize = 64;
+
+        AdaptiveRingSizer(size_t minCapacity, size_t maxCapacity) noexcept :
+            mMinCapacity(minCapacity),
+            mMaxCapacity(std::max(minCapacity, maxCapacity)),
+            mCapacity(minCapacity),
+            mIntervals(0),
+            mWindowWraps(0),
+            mWindowPeak(0),
+            mTotalIntervals(0),
+            mTotalWraps(0)
+        {
+        }
+
+        size_t GetCapacity() const noexcept { return mCapacity; }
+
+        // Total number of intervals recorded, and times the ring wrapped during them.
+        uint64_t GetIntervalCount() const noexcept { return mTotalIntervals; }
+        uint64_t GetWrapCount() const noexcept { return mTotalWraps; }
+
+        // Records the elements written during one interval, and how many times the ring wrapped
+        // (each wrap costs one discard). Returns true if GetCapacity has changed, in which case
+        // the caller should recreate its buffer at the new size.
+        bool EndInterval(size_t elementsWritten, size_t wraps) noexcept
+        {
+            const size_t previousCapacity = mCapacity;
+
+            mTotalIntervals++;
+            mTotalWraps += wraps;
+
+            mWindowWraps += wraps;
+            mWindowPeak = std::max(mWindowPeak, elementsWritten);
+
+            if (elementsWritten > mCapacity)
+            {
+                // A single interval overran the whole ring, so grow straight away, leaving room for it to double.
+                Resize(elementsWritten * 2);
+                ResetWindow();
+            }
+            else if (++mIntervals >= WindowSize)
+            {
+                if (mWindowWraps * 8 > WindowSize)
+                {
+                    // Wrapping more than once every eight intervals: double the ring.
+                    Resize(mCapacity * 2);
+                }
+                else if (mWindowWraps * 32 <= WindowSize && mWindowPeak * 4 < mCapacity)
+                {
+                    // Demand fits comfortably in a quarter of the ring and it rarely wraps, so give some
+                    // memory back. Even if halving doubles the wrap rate, that stays below the growth threshold.
+                    Resize(mCapacity / 2);
+                }
+
+                ResetWindow();
+            }
+
+            return mCapacity != previousCapacity;
+        }
+
+    private:
+        void Resize(size_t target) noexcept
+        {
+            // Keep capacities a power-of-two multiple of the minimum, so repeated resizes settle on a few sizes.
+            size_t capacity = mMinCapacity;
+
+            while (capacity < target && capacity < mMaxCapacity)
+            {
+                capacity *= 2;
+            }
+
+            mCapacity = std::min(capacity, mMaxCapacity);
+        }
+
+        void ResetWindow() noexcept
+        {
+            mIntervals = 0;
+            mWindowWraps = 0;
+            mWindowPeak = 0;
+        }
+
+        size_t mMinCapacity;
+        size_t mMaxCapacity;
+        size_t mCapacity;
+
+        size_t mIntervals;
+        size_t mWindowWraps;
+        size_t mWindowPeak;
+
+        uint64_t mTotalIntervals;
+        uint64_t mTotalWraps;
+    };
+}
@@ -0,0 +1,765 @@
+//--------------------------------------------------------------------------------------
+// File: ColorKernels.h
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CpuFeatures.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <DirectXMath.h>
+#include <DirectXPackedVector.h>
+
+
+namespace DirectX
+{
+    namespace ColorKernels
+    {
+        // Colors are four floats in XMFLOAT4 order, and the color results may be the same array as the
+        // source. Packed colors are XMUBYTEN4 (RGBA) or XMCOLOR (BGRA) values, which must not overlap
+        // the float colors; the swizzle may work in place.
+        using ColorKernel = void (*)(float const* source, size_t count, float* result);
+        using SaturationKernel = void (*)(float const* source, size_t count, float saturation, float* result);
+        using PackKernel = void (*)(float const* source, size_t count, uint32_t* result);
+        using UnpackKernel = void (*)(uint32_t const* source, size_t count, float* result);
+        using SwizzleKernel = void (*)(uint32_t const* source, size_t count, uint32_t* result);
+
+        struct Kernels
+        {
+            ColorKernel srgbToLinearFast;
+            ColorKernel linearToSRGBFast;
+            ColorKernel premultiply;
+            ColorKernel unpremultiply;
+            SaturationKernel adjustSaturation;
+            PackKernel packRGBA;
+            PackKernel packBGRA;
+            UnpackKernel unpackRGBA;
+            UnpackKernel unpackBGRA;
+            SwizzleKernel swapRedBlue;
+        };
+
+        // The sRGB transfer function, as used by XMColorSRGBToRGB and XMColorRGBToSRGB.
+        constexpr float SRGBCutoff = 0.04045f;
+        constexpr float LinearCutoff = 0.0031308f;
+        constexpr float LinearSlope = 12.92f;
+        constexpr float CurveScale = 1.055f;
+        constexpr float CurveBias = 0.055f;
+        constexpr float Gamma = 2.4f;
+
+        // The fast conversions raise to the power through log2 and exp2. Log2 reduces the mantissa to
+        // [sqrt(1/2), sqrt(2)), then uses u = (m - 1) / (m + 1), as log2(m) = u * P(u^2). Exp2 splits off the
+        // integer part, and 2^f = 1 + f * Q(f) on [0, 1). Both polynomials interpolate at Chebyshev nodes,
+        // for errors of about 6e-8 and 2e-7, keeping the conversions within 1e-6 of the exact ones.
+        constexpr float Log2P0 = 2.88539042f;
+        constexpr float Log2P1 = 0.961588947f;
+        constexpr float Log2P2 = 0.595759607f;
+
+        constexpr float Exp2Q0 = 0.693147568f;
+        constexpr float Exp2Q1 = 0.240207194f;
+        constexpr float Exp2Q2 = 0.0556570544f;
+        constexpr float Exp2Q3 = 0.0091993876f;
+        constexpr float Exp2Q4 = 0.00178836874f;
+
+        constexpr float Sqrt2 = 1.41421356f;
+
+        // Luminance weights, as used by XMColorAdjustSaturation.
+        constexpr float LuminanceR = 0.2125f;
+        constexpr float LuminanceG = 0.7154f;
+        constexpr float LuminanceB = 0.0721f;
+
+        // One color at a time with DirectXMath, so it runs wherever DirectXMath does.
+        namespace Baseline
+        {
+            // Positive, finite x.
+            inline XMVECTOR XM_CALLCONV Log2(FXMVECTOR x) noexcept
+            {
+                XMVECTOR e = XMVectorSubtract(XMConvertVectorIntToFloat(XMVectorAndInt(x, g_XMInfinity), 23), XMVectorReplicate(127.f));
+                XMVECTOR m = XMVectorOrInt(XMVectorAndInt(x, g_XMQNaNTest), g_XMOne);
+
+                const XMVECTOR high = XMVectorGreater(m, XMVectorReplicate(Sqrt2));
+                m = XMVectorSelect(m, XMVectorMultiply(m, g_XMOneHalf), high);
+                e = XMVectorAdd(e, XMVectorAndInt(high, g_XMOne));
+
+                const XMVECTOR u = XMVectorDivide(XMVectorSubtract(m, g_XMOne), XMVectorAdd(m, g_XMOne));
+                const XMVECTOR z = XMVectorMultiply(u, u);
+
+                XMVECTOR p = XMVectorMultiplyAdd(XMVectorReplicate(Log2P2), z, XMVectorReplicate(Log2P1));
+                p = XMVectorMultiplyAdd(p, z, XMVectorReplicate(Log2P0));
+
+                return XMVectorMultiplyAdd(p, u, e);
+            }
+
+            // y from -126 to 127.
+            inline XMVECTOR XM_CALLCONV Exp2(FXMVECTOR y) noexcept
+            {
+                const XMVECTOR i = XMVectorFloor(y);
+                const XMVECTOR f = XMVectorSubtract(y, i);
+
+                XMVECTOR q = XMVectorMultiplyAdd(XMVectorReplicate(Exp2Q4), f, XMVectorReplicate(Exp2Q3));
+                q = XMVectorMultiplyAdd(q, f, XMVectorReplicate(Exp2Q2));
+                q = XMVectorMultiplyAdd(q, f, XMVectorReplicate(Exp2Q1));
+                q = XMVectorMultiplyAdd(q, f, XMVectorReplicate(Exp2Q0));
+                q = XMVectorMultiplyAdd(q, f, g_XMOne);
+
+                // 2^i, built directly as the exponent bits.
+                const XMVECTOR scale = XMConvertVectorFloatToInt(XMVectorAdd(i, XMVectorReplicate(127.f)), 23);
+
+                return XMVectorMultiply(q, scale);
+            }
+
+            inline XMVECTOR XM_CALLCONV SRGBToLinear(FXMVECTOR c) noexcept
+            {
+                const XMVECTOR cutoff = XMVectorReplicate(SRGBCutoff);
+
+                const XMVECTOR v = XMVectorSaturate(c);
+                const XMVECTOR linear = XMVectorMultiply(v, XMVectorReplicate(1.f / LinearSlope));
+
+                const XMVECTOR x = XMVectorMultiplyAdd(XMVectorMax(v, cutoff), XMVectorReplicate(1.f / CurveScale), XMVectorReplicate(CurveBias / CurveScale));
+                const XMVECTOR curve = Exp2(XMVectorMultiply(Log2(x), XMVectorReplicate(Gamma)));
+
+                const XMVECTOR result = XMVectorSelect(linear, curve, XMVectorGreater(v, cutoff));
+                return XMVectorSelect(c, result, g_XMSelect1110);
+            }
+
+            inline XMVECTOR XM_CALLCONV LinearToSRGB(FXMVECTOR c) noexcept
+            {
+                const XMVECTOR cutoff = XMVectorReplicate(LinearCutoff);
+
+                const XMVECTOR v = XMVectorSaturate(c);
+                const XMVECTOR linear = XMVectorMultiply(v, XMVectorReplicate(LinearSlope));
+
+                const XMVECTOR x = Exp2(XMVectorMultiply(Log2(XMVectorMax(v, cutoff)), XMVectorReplicate(1.f / Gamma)));
+                const XMVECTOR curve = XMVectorMultiplyAdd(x, XMVectorReplicate(CurveScale), XMVectorReplicate(-CurveBias));
+
+                const XMVECTOR result = XMVectorSelect(curve, linear, XMVectorLess(v, cutoff));
+                return XMVectorSelect(c, result, g_XMSelect1110);
+            }
+
+            inline XMVECTOR XM_CALLCONV Premultiply(FXMVECTOR c) noexcept
+            {
+                const XMVECTOR a = XMVectorSelect(g_XMIdentityR3, XMVectorSplatW(c), g_XMSelect1110);
+                return XMVectorMultiply(c, a);
+            }
+
+            // Colors with no alpha become transparent black.
+            inline XMVECTOR XM_CALLCONV Unpremultiply(FXMVECTOR c) noexcept
+            {
+                const XMVECTOR a = XMVectorSplatW(c);
+                const XMVECTOR result = XMVectorAndInt(XMVectorDivide(c, a), XMVectorGreater(a, g_XMZero));
+                return XMVectorSelect(c, result, g_XMSelect1110);
+            }
+
+            template<XMVECTOR (XM_CALLCONV *Op)(FXMVECTOR)>
+            inline void TransformColors(float const* source, size_t count, float* result) noexcept
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    const XMVECTOR c = XMLoadFloat4(reinterpret_cast<XMFLOAT4 const*>(source + i * 4));
+                    XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(result + i * 4), Op(c));
+                }
+            }
+
+            inline void AdjustSaturation(float const* source, size_t count, float saturation, float* result) noexcept
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    const XMVECTOR c = XMLoadFloat4(reinterpret_cast<XMFLOAT4 const*>(source + i * 4));
+                    XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(result + i * 4), XMColorAdjustSaturation(c, saturation));
+                }
+            }
+
+            inline void PackRGBA(float const* source, size_t count, uint32_t* result) noexcept
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    PackedVector::XMUBYTEN4 packed;
+                    PackedVector::XMStoreUByteN4(&packed, XMLoadFloat4(reinterpret_cast<XMFLOAT4 const*>(source + i * 4)));
+                    result[i] = packed.v;
+                }
+            }
+
+            inline void PackBGRA(float const* source, size_t count, uint32_t* result) noexcept
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    PackedVector::XMCOLOR packed;
+                    PackedVector::XMStoreColor(&packed, XMLoadFloat4(reinterpret_cast<XMFLOAT4 const*>(source + i * 4)));
+                    result[i] = packed.c;
+                }
+            }
+
+            inline void UnpackRGBA(uint32_t const* source, size_t count, float* result) noexcept
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    const PackedVector::XMUBYTEN4 packed(source[i]);
+                    XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(result + i * 4), PackedVector::XMLoadUByteN4(&packed));
+                }
+            }
+
+            inline void UnpackBGRA(uint32_t const* source, size_t count, float* result) noexcept
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    const PackedVector::XMCOLOR packed(source[i]);
+                    XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(result + i * 4), PackedVector::XMLoadColor(&packed));
+                }
+            }
+
+            inline void SwapRedBlue(uint32_t const* source, size_t count, uint32_t* result) noexcept
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    const uint32_t c = source[i];
+                    result[i] = (c & 0xFF00FF00u) | ((c >> 16) & 0xFFu) | ((c & 0xFFu) << 16);
+                }
+            }
+
+            inline Kernels const& GetKernels() noexcept
+            {
+                static const Kernels s_kernels =
+                {
+                    TransformColors<SRGBToLinear>,
+                    TransformColors<LinearToSRGB>,
+                    TransformColors<Premultiply>,
+                    TransformColors<Unpremultiply>,
+                    AdjustSaturation,
+                    PackRGBA,
+                    PackBGRA,
+                    UnpackRGBA,
+                    UnpackBGRA,
+                    SwapRedBlue,
+                };
+
+                return s_kernels;
+            }
+        }
+
+    #if defined(DIRECTX_SIMD_X86)
+        DIRECTX_BEGIN_TARGET_AVX2
+
+        // Two colors per register, with a masked load and store for an odd one at the end. Packing goes
+        // four colors at a time, through a padded copy for the remainder, so that every color is rounded
+        // the same way.
+        namespace AVX2
+        {
+            inline __m256 Log2(__m256 x) noexcept
+            {
+                const __m256i bits = _mm256_castps_si256(x);
+                const __m256 one = _mm256_set1_ps(1.f);
+
+                __m256 e = _mm256_sub_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(bits, 23)), _mm256_set1_ps(127.f));
+                __m256 m = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007FFFFF)), _mm256_set1_epi32(0x3F800000)));
+
+                const __m256 high = _mm256_cmp_ps(m, _mm256_set1_ps(Sqrt2), _CMP_GT_OQ);
+                m = _mm256_blendv_ps(m, _mm256_mul_ps(m, _mm256_set1_ps(0.5f)), high);
+                e = _mm256_add_ps(e, _mm256_and_ps(high, one));
+
+                const __m256 u = _mm256_div_ps(_mm256_sub_ps(m, one), _mm256_add_ps(m, one));
+                const __m256 z = _mm256_mul_ps(u, u);
+
+                __m256 p = _mm256_fmadd_ps(_mm256_set1_ps(Log2P2), z, _mm256_set1_ps(Log2P1));
+                p = _mm256_fmadd_ps(p, z, _mm256_set1_ps(Log2P0));
+
+                return _mm256_fmadd_ps(p, u, e);
+            }
+
+            inline __m256 Exp2(__m256 y) noexcept
+            {
+                const __m256 i = _mm256_floor_ps(y);
+                const __m256 f = _mm256_sub_ps(y, i);
+
+                __m256 q = _mm256_fmadd_ps(_mm256_set1_ps(Exp2Q4), f, _mm256_set1_ps(Exp2Q3));
+                q = _mm256_fmadd_ps(q, f, _mm256_set1_ps(Exp2Q2));
+                q = _mm256_fmadd_ps(q, f, _mm256_set1_ps(Exp2Q1));
+                q = _mm256_fmadd_ps(q, f, _mm256_set1_ps(Exp2Q0));
+                q = _mm256_fmadd_ps(q, f, _mm256_set1_ps(1.f));
+
+                const __m256i scale = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(i), _mm256_set1_epi32(127)), 23);
+
+                return _mm256_mul_ps(q, _mm256_castsi256_ps(scale));
+            }
+
+            // Clamps to [0, 1] as XMVectorSaturate does, so NaN becomes zero.
+            inline __m256 Saturate(__m256 c) noexcept
+            {
+                return _mm256_min_ps(_mm256_max_ps(c, _mm256_setzero_ps()), _mm256_set1_ps(1.f));
+            }
+
+            inline __m256 SRGBToLinear(__m256 c) noexcept
+            {
+                const __m256 cutoff = _mm256_set1_ps(SRGBCutoff);
+
+                const __m256 v = Saturate(c);
+                const __m256 linear = _mm256_mul_ps(v, _mm256_set1_ps(1.f / LinearSlope));
+
+                const __m256 x = _mm256_fmadd_ps(_mm256_max_ps(v, cutoff), _mm256_set1_ps(1.f / CurveScale), _mm256_set1_ps(CurveBias / CurveScale));
+                const __m256 curve = Exp2(_mm256_mul_ps(Log2(x), _mm256_set1_ps(Gamma)));
+
+                const __m256 result = _mm256_blendv_ps(linear, curve, _mm256_cmp_ps(v, cutoff, _CMP_GT_OQ));
+                return _mm256_blend_ps(result, c, 0x88);
+            }
+
+            inline __m256 LinearToSRGB(__m256 c) noexcept
+            {
+                const __m256 cutoff = _mm256_set1_ps(LinearCutoff);
+
+                const __m256 v = Saturate(c);
+                const __m256 linear = _mm256_mul_ps(v, _mm256_set1_ps(LinearSlope));
+
+                const __m256 x = Exp2(_mm256_mul_ps(Log2(_mm256_max_ps(v, cutoff)), _mm256_set1_ps(1.f / Gamma)));
+                const __m256 curve = _mm256_fmadd_ps(x, _mm256_set1_ps(CurveScale), _mm256_set1_ps(-CurveBias));
+
+                const __m256 result = _mm256_blendv_ps(curve, linear, _mm256_cmp_ps(v, cutoff, _CMP_LT_OQ));
+                return _mm256_blend_ps(result, c, 0x88);
+            }
+
+            inline __m256 Premultiply(__m256 c) noexcept
+            {
+                const __m256 a = _mm256_blend_ps(_mm256_permute_ps(c, _MM_SHUFFLE(3, 3, 3, 3)), _mm256_set1_ps(1.f), 0x88);
+                return _mm256_mul_ps(c, a);
+            }
+
+            inline __m256 Unpremultiply(__m256 c) noexcept
+            {
+                const __m256 a = _mm256_permute_ps(c, _MM_SHUFFLE(3, 3, 3, 3));
+                const __m256 result = _mm256_and_ps(_mm256_div_ps(c, a), _mm256_cmp_ps(a, _mm256_setzero_ps(), _CMP_GT_OQ));
+                return _mm256_blend_ps(result, c, 0x88);
+            }
+
+            // The first color of the register, for the odd one at the end.
+            inline __m256i TailMask() noexcept
+            {
+                return _mm256_setr_epi32(-1, -1, -1, -1, 0, 0, 0, 0);
+            }
+
+            template<__m256 (*Op)(__m256)>
+            inline void TransformColors(float const* source, size_t count, float* result) noexcept
+            {
+                size_t i = 0;
+
+                for (; i + 2 <= count; i += 2)
+                {
+                    _mm256_storeu_ps(result + i * 4, Op(_mm256_loadu_ps(source + i * 4)));
+                }
+
+                if (i < count)
+                {
+                    const __m256i mask = TailMask();
+                    _mm256_maskstore_ps(result + i * 4, mask, Op(_mm256_maskload_ps(source + i * 4, mask)));
+                }
+            }
+
+            // As XMColorAdjustSaturation: luminance + (color - luminance) * saturation, keeping alpha.
+            inline __m256 AdjustSaturation(__m256 c, __m256 saturation) noexcept
+            {
+                const __m256 w = _mm256_mul_ps(c, _mm256_setr_ps(LuminanceR, LuminanceG, LuminanceB, 0.f, LuminanceR, LuminanceG, LuminanceB, 0.f));
+
+                __m256 luminance = _mm256_add_ps(_mm256_permute_ps(w, _MM_SHUFFLE(0, 0, 0, 0)), _mm256_permute_ps(w, _MM_SHUFFLE(1, 1, 1, 1)));
+                luminance = _mm256_add_ps(luminance, _mm256_permute_ps(w, _MM_SHUFFLE(2, 2, 2, 2)));
+
+                const __m256 result = _mm256_fmadd_ps(_mm256_sub_ps(c, luminance), saturation, luminance);
+                return _mm256_blend_ps(result, c, 0x88);
+            }
+
+            inline void AdjustSaturation(float const* source, size_t count, float saturation, float* result) noexcept
+            {
+                const __m256 s = _mm256_set1_ps(saturation);
+
+                size_t i = 0;
+
+                for (; i + 2 <= count; i += 2)
+                {
+                    _mm256_storeu_ps(result + i * 4, AdjustSaturation(_mm256_loadu_ps(source + i * 4), s));
+                }
+
+                if (i < count)
+                {
+                    const __m256i mask = TailMask();
+                    _mm256_maskstore_ps(result + i * 4, mask, AdjustSaturation(_mm256_maskload_ps(source + i * 4, mask), s));
+                }
+            }
+
+            // Saturate, scale to 255 and round to nearest even, as XMStoreUByteN4 and XMStoreColor do.
+            inline __m256i ToBytes(__m256 c) noexcept
+            {
+                return _mm256_cvtps_epi32(_mm256_mul_ps(Saturate(c), _mm256_set1_ps(255.f)));
+            }
+
+            // Four colors in XMFLOAT4 order to packed ones. BGRA swaps red and blue first.
+            template<bool BGRA>
+            inline __m128i PackFour(float const* source) noexcept
+            {
+                __m256 c0 = _mm256_loadu_ps(source);
+                __m256 c1 = _mm256_loadu_ps(source + 8);
+
+                if (BGRA)
+                {
+                    c0 = _mm256_permute_ps(c0, _MM_SHUFFLE(3, 0, 1, 2));
+                    c1 = _mm256_permute_ps(c1, _MM_SHUFFLE(3, 0, 1, 2));
+                }
+
+                // The packs work within each half, leaving colors 0 and 2 in the low half, and 1 and 3 in the high.
+                __m256i packed = _mm256_packs_epi32(ToBytes(c0), ToBytes(c1));
+                packed = _mm256_packus_epi16(packed, packed);
+                packed = _mm256_permutevar8x32_epi32(packed, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+
+                return _mm256_castsi256_si128(packed);
+            }
+
+            template<bool BGRA>
+            inline void PackColors(float const* source, size_t count, uint32_t* result) noexcept
+            {
+                size_t i = 0;
+
+                for (; i + 4 <= count; i += 4)
+                {
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(result + i), PackFour<BGRA>(source + i * 4));
+                }
+
+                if (i < count)
+                {
+                    float f[16] = {};
+                    uint32_t c[4];
+
+                    memcpy(f, source + i * 4, (count - i) * 4 * sizeof(float));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(c), PackFour<BGRA>(f));
+                    memcpy(result + i, c, (count - i) * sizeof(uint32_t));
+                }
+            }
+
+            inline void PackRGBA(float const* source, size_t count, uint32_t* result) noexcept
+            {
+                PackColors<false>(source, count, result);
+            }
+
+            inline void PackBGRA(float const* source, size_t count, uint32_t* result) noexcept
+            {
+                PackColors<true>(source, count, result);
+            }
+
+            // Bytes to floats over 255, which is exactly what XMLoadUByteN4 and XMLoadColor compute.
+            template<bool BGRA>
+            inline __m256 FromBytes(__m128i bytes) noexcept
+            {
+                const __m256 c = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(bytes)), _mm256_set1_ps(1.f / 255.f));
+                return BGRA ? _mm256_permute_ps(c, _MM_SHUFFLE(3, 0, 1, 2)) : c;
+            }
+
+            template<bool BGRA>
+            inline void UnpackColors(uint32_t const* source, size_t count, float* result) noexcept
+            {
+                size_t i = 0;
+
+                for (; i + 2 <= count; i += 2)
+                {
+                    const __m128i bytes = _mm_loadl_epi64(reinterpret_cast<__m128i const*>(source + i));
+                    _mm256_storeu_ps(result + i * 4, FromBytes<BGRA>(bytes));
+                }
+
+                if (i < count)
+                {
+                    const __m128i bytes = _mm_cvtsi32_si128(static_cast<int>(source[i]));
+                    _mm256_maskstore_ps(result + i * 4, TailMask(), FromBytes<BGRA>(bytes));
+                }
+            }
+
+            inline void UnpackRGBA(uint32_t const* source, size_t count, float* result) noexcept
+            {
+                UnpackColors<false>(source, count, result);
+            }
+
+            inline void UnpackBGRA(uint32_t const* source, size_t count, float* result) noexcept
+            {
+                UnpackColors<true>(source, count, result);
+            }
+
+            // Eight colors at a time, leaving the remainder to the scalar loop.
+            inline void SwapRedBlue(uint32_t const* source, size_t count, uint32_t* result) noexcept
+            {
+                const __m256i order = _mm256_setr_epi8(
+                    2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+                    2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+                size_t i = 0;
+
+                for (; i + 8 <= count; i += 8)
+                {
+                    const __m256i c = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(source + i));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(result + i), _mm256_shuffle_epi8(c, order));
+                }
+
+                Baseline::SwapRedBlue(source + i, count - i, result + i);
+            }
+
+            inline Kernels const& GetKernels() noexcept
+            {
+                static const Kernels s_kernels =
+                {
+                    TransformColors<SRGBToLinear>,
+                    TransformColors<LinearToSRGB>,
+                    TransformColors<Premultiply>,
+                    TransformColors<Unpremultiply>,
+                    AdjustSaturation,
+                    PackRGBA,
+                    PackBGRA,
+                    UnpackRGBA,
+                    UnpackBGRA,
+                    SwapRedBlue,
+                };
+
+                return s_kernels;
+            }
+        }
+
+        DIRECTX_END_TARGET
+
+        DIRECTX_BEGIN_TARGET_AVX512
+
+        // Four colors per register, leaving the remainder to AVX2. Swapping bytes needs AVX-512BW,
+        // so that stays with AVX2.
+        namespace AVX512
+        {
+            inline __m512 Log2(__m512 x) noexcept
+            {
+                const __m512i bits = _mm512_castps_si512(x);
+                const __m512 one = _mm512_set1_ps(1.f);
+
+                __m512 e = _mm512_sub_ps(_mm512_cvtepi32_ps(_mm512_srli_epi32(bits, 23)), _mm512_set1_ps(127.f));
+                __m512 m = _mm512_castsi512_ps(_mm512_or_si512(_mm512_and_si512(bits, _mm512_set1_epi32(0x007FFFFF)), _mm512_set1_epi32(0x3F800000)));
+
+                const __mmask16 high = _mm512_cmp_ps_mask(m, _mm512_set1_ps(Sqrt2), _CMP_GT_OQ);
+                m = _mm512_mask_mul_ps(m, high, m, _mm512_set1_ps(0.5f));
+                e = _mm512_mask_add_ps(e, high, e, one);
+
+                const __m512 u = _mm512_div_ps(_mm512_sub_ps(m, one), _mm512_add_ps(m, one));
+                const __m512 z = _mm512_mul_ps(u, u);
+
+                __m512 p = _mm512_fmadd_ps(_mm512_set1_ps(Log2P2), z, _mm512_set1_ps(Log2P1));
+                p = _mm512_fmadd_ps(p, z, _mm512_set1_ps(Log2P0));
+
+                return _mm512_fmadd_ps(p, u, e);
+            }
+
+            inline __m512 Exp2(__m512 y) noexcept
+            {
+                const __m512 i = _mm512_roundscale_ps(y, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+                const __m512 f = _mm512_sub_ps(y, i);
+
+                __m512 q = _mm512_fmadd_ps(_mm512_set1_ps(Exp2Q4), f, _mm512_set1_ps(Exp2Q3));
+                q = _mm512_fmadd_ps(q, f, _mm512_set1_ps(Exp2Q2));
+                q = _mm512_fmadd_ps(q, f, _mm512_set1_ps(Exp2Q1));
+                q = _mm512_fmadd_ps(q, f, _mm512_set1_ps(Exp2Q0));
+                q = _mm512_fmadd_ps(q, f, _mm512_set1_ps(1.f));
+
+                const __m512i scale = _mm512_slli_epi32(_mm512_add_epi32(_mm512_cvtps_epi32(i), _mm512_set1_epi32(127)), 23);
+
+                return _mm512_mul_ps(q, _mm512_castsi512_ps(scale));
+            }
+
+            inline __m512 Saturate(__m512 c) noexcept
+            {
+                return _mm512_min_ps(_mm512_max_ps(c, _mm512_setzero_ps()), _mm512_set1_ps(1.f));
+            }
+
+            inline __m512 SRGBToLinear(__m512 c) noexcept
+            {
+                const __m512 cutoff = _mm512_set1_ps(SRGBCutoff);
+
+                const __m512 v = Saturate(c);
+                const __m512 linear = _mm512_mul_ps(v, _mm512_set1_ps(1.f / LinearSlope));
+
+                const __m512 x = _mm512_fmadd_ps(_mm512_max_ps(v, cutoff), _mm512_set1_ps(1.f / CurveScale), _mm512_set1_ps(CurveBias / CurveScale));
+                const __m512 curve = Exp2(_mm512_mul_ps(Log2(x), _mm512_set1_ps(Gamma)));
+
+                const __m512 result = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(v, cutoff, _CMP_GT_OQ), linear, curve);
+                return _mm512_mask_blend_ps(0x8888, result, c);
+            }
+
+            inline __m512 LinearToSRGB(__m512 c) noexcept
+            {
+                const __m512 cutoff = _mm512_set1_ps(LinearCutoff);
+
+                const __m512 v = Saturate(c);
+                const __m512 linear = _mm512_mul_ps(v, _mm512_set1_ps(LinearSlope));
+
+                const __m512 x = Exp2(_mm512_mul_ps(Log2(_mm512_max_ps(v, cutoff)), _mm512_set1_ps(1.f / Gamma)));
+                const __m512 curve = _mm512_fmadd_ps(x, _mm512_set1_ps(CurveScale), _mm512_set1_ps(-CurveBias));
+
+                const __m512 result = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(v, cutoff, _CMP_LT_OQ), curve, linear);
+                return _mm512_mask_blend_ps(0x8888, result, c);
+            }
+
+            inline __m512 Premultiply(__m512 c) noexcept
+            {
+                const __m512 a = _mm512_mask_blend_ps(0x8888, _mm512_permute_ps(c, _MM_SHUFFLE(3, 3, 3, 3)), _mm512_set1_ps(1.f));
+                return _mm512_mul_ps(c, a);
+            }
+
+            inline __m512 Unpremultiply(__m512 c) noexcept
+            {
+                const __m512 a = _mm512_permute_ps(c, _MM_SHUFFLE(3, 3, 3, 3));
+                const __m512 result = _mm512_maskz_div_ps(_mm512_cmp_ps_mask(a, _mm512_setzero_ps(), _CMP_GT_OQ), c, a);
+                return _mm512_mask_blend_ps(0x8888, result, c);
+            }
+
+            template<__m512 (*Op)(__m512), void (*Remainder)(float const*, size_t, float*)>
+            inline void TransformColors(float const* source, size_t count, float* result) noexcept
+            {
+                size_t i = 0;
+
+                for (; i + 4 <= count; i += 4)
+                {
+                    _mm512_storeu_ps(result + i * 4, Op(_mm512_loadu_ps(source + i * 4)));
+                }
+
+                Remainder(source + i * 4, count - i, result + i * 4);
+            }
+
+            inline void AdjustSaturation(float const* source, size_t count, float saturation, float* result) noexcept
+            {
+                const __m512 s = _mm512_set1_ps(saturation);
+                const __m512 weights = _mm512_setr_ps(
+                    LuminanceR, LuminanceG, LuminanceB, 0.f, LuminanceR, LuminanceG, LuminanceB, 0.f,
+                    LuminanceR, LuminanceG, LuminanceB, 0.f, LuminanceR, LuminanceG, LuminanceB, 0.f);
+
+                size_t i = 0;
+
+                for (; i + 4 <= count; i += 4)
+                {
+                    const __m512 c = _mm512_loadu_ps(source + i * 4);
+                    const __m512 w = _mm512_mul_ps(c, weights);
+
+                    __m512 luminance = _mm512_add_ps(_mm512_permute_ps(w, _MM_SHUFFLE(0, 0, 0, 0)), _mm512_permute_ps(w, _MM_SHUFFLE(1, 1, 1, 1)));
+                    luminance = _mm512_add_ps(luminance, _mm512_permute_ps(w, _MM_SHUFFLE(2, 2, 2, 2)));
+
+                    const __m512 adjusted = _mm512_fmadd_ps(_mm512_sub_ps(c, luminance), s, luminance);
+                    _mm512_storeu_ps(result + i * 4, _mm512_mask_blend_ps(0x8888, adjusted, c));
+                }
+
+                AVX2::AdjustSaturation(source + i * 4, count - i, saturation, result + i * 4);
+            }
+
+            template<bool BGRA>
+            inline void PackColors(float const* source, size_t count, uint32_t* result) noexcept
+            {
+                size_t i = 0;
+
+                for (; i + 4 <= count; i += 4)
+                {
+                    __m512 c = _mm512_loadu_ps(source + i * 4);
+
+                    if (BGRA)
+                    {
+                        c = _mm512_permute_ps(c, _MM_SHUFFLE(3, 0, 1, 2));
+                    }
+
+                    const __m512i bytes = _mm512_cvtps_epi32(_mm512_mul_ps(Saturate(c), _mm512_set1_ps(255.f)));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(result + i), _mm512_cvtepi32_epi8(bytes));
+                }
+
+                AVX2::PackColors<BGRA>(source + i * 4, count - i, result + i);
+            }
+
+            inline void PackRGBA(float const* source, size_t count, uint32_t* result) noexcept
+            {
+                PackColors<false>(source, count, result);
+            }
+
+            inline void PackBGRA(float const* source, size_t count, uint32_t* result) noexcept
+            {
+                PackColors<true>(source, count, result);
+            }
+
+            template<bool BGRA>
+            inline void UnpackColors(uint32_t const* source, size_t count, float* result) noexcept
+            {
+                size_t i = 0;
+
+                for (; i + 4 <= count; i += 4)
+                {
+                    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<__m128i const*>(source + i));
+
+                    __m512 c = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(bytes)), _mm512_set1_ps(1.f / 255.f));
+
+                    if (BGRA)
+                    {
+                        c = _mm512_permute_ps(c, _MM_SHUFFLE(3, 0, 1, 2));
+                    }
+
+                    _mm512_storeu_ps(result + i * 4, c);
+                }
+
+                AVX2::UnpackColors<BGRA>(source + i, count - i, result + i * 4);
+            }
+
+            inline void UnpackRGBA(uint32_t const* source, size_t count, float* result) noexcept
+            {
+                UnpackColors<false>(source, count, result);
+            }
+
+            inline void UnpackBGRA(uint32_t const* source, size_t count, float* result) noexcept
+            {
+                UnpackColors<true>(source, count, result);
+            }
+
+            inline Kernels const& GetKernels() noexcept
+            {
+                static const Kernels s_kernels =
+                {
+                    TransformColors<SRGBToLinear, AVX2::TransformColors<AVX2::SRGBToLinear>>,
+                    TransformColors<LinearToSRGB, AVX2::TransformColors<AVX2::LinearToSRGB>>,
+                    TransformColors<Premultiply, AVX2::TransformColors<AVX2::Premultiply>>,
+                    TransformColors<Unpremultiply, AVX2::TransformColors<AVX2::Unpremultiply>>,
+                    AdjustSaturation,
+                    PackRGBA,
+                    PackBGRA,
+                    UnpackRGBA,
+                    UnpackBGRA,
+                    AVX2::SwapRedBlue,
+                };
+
+                return s_kernels;
+            }
+        }
+
+        DIRECTX_END_TARGET
+    #endif
+
+        // The kernels for an instruction set, which the CPU must support.
+        inline Kernels const& GetColorKernels(SimdLevel level) noexcept
+        {
+        #if defined(DIRECTX_SIMD_X86)
+            switch (level)
+            {
+            case SimdLevel::AVX512:
+                return AVX512::GetKernels();
+
+            case SimdLevel::AVX2:
+                return AVX2::GetKernels();
+
+            default:
+                break;
+            }
+        #else
+            (void)level;
+        #endif
+
+            return Baseline::GetKernels();
+        }
+
+        // The kernels for the widest instruction set this CPU supports.
+        inline Kernels const& GetColorKernels() noexcept
+        {
+            return GetColorKernels(GetSimdLevel());
+        }
+    }
+}
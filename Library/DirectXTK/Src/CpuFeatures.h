@@ -0,0 +1,133 @@
+//--------------------------------------------------------------------------------------
+// File: CpuFeatures.h
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstdint>
+
+#if (defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)) && !defined(_M_ARM64EC) && !defined(_XM_NO_INTRINSICS_)
+#define DIRECTX_SIMD_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// Code between DIRECTX_BEGIN_TARGET_AVX2 (or _AVX512) and DIRECTX_END_TARGET may use those instruction
+// sets, whatever the compiler options, and must only run if GetSimdLevel reports them. MSVC allows
+// these intrinsics anywhere; GCC and Clang need the functions marked as targeting them.
+#if defined(DIRECTX_SIMD_X86) && defined(__clang__)
+#define DIRECTX_BEGIN_TARGET_AVX2 _Pragma("clang attribute push(__attribute__((target(\"avx2,fma,f16c\"))), apply_to = function)")
+#define DIRECTX_BEGIN_TARGET_AVX512 _Pragma("clang attribute push(__attribute__((target(\"avx2,fma,f16c,avx512f\"))), apply_to = function)")
+#define DIRECTX_END_TARGET _Pragma("clang attribute pop")
+#elif defined(DIRECTX_SIMD_X86) && defined(__GNUC__)
+#define DIRECTX_BEGIN_TARGET_AVX2 _Pragma("GCC push_options") _Pragma("GCC target(\"avx2,fma,f16c\")")
+#define DIRECTX_BEGIN_TARGET_AVX512 _Pragma("GCC push_options") _Pragma("GCC target(\"avx2,fma,f16c,avx512f\")")
+#define DIRECTX_END_TARGET _Pragma("GCC pop_options")
+#else
+#define DIRECTX_BEGIN_TARGET_AVX2
+#define DIRECTX_BEGIN_TARGET_AVX512
+#define DIRECTX_END_TARGET
+#endif
+
+
+namespace DirectX
+{
+    // Instruction sets that batch math kernels can choose between at runtime. Baseline is whatever
+    // DirectXMath was built for (SSE2 or better, ARM-NEON, or no intrinsics).
+    enum class SimdLevel
+    {
+        Baseline,
+        AVX2,       // Including FMA3 and F16C
+        AVX512,     // AVX-512F
+    };
+
+    namespace Private
+    {
+    #if defined(DIRECTX_SIMD_X86)
+        inline void CpuId(uint32_t leaf, uint32_t subleaf, uint32_t regs[4]) noexcept
+        {
+        #ifdef _MSC_VER
+            int info[4];
+            __cpuidex(info, static_cast<int>(leaf), static_cast<int>(subleaf));
+
+            for (int i = 0; i < 4; i++)
+            {
+                regs[i] = static_cast<uint32_t>(info[i]);
+            }
+        #else
+            __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+        #endif
+        }
+
+        // Which register states the OS saves on context switches. Only valid if OSXSAVE is set.
+        inline uint64_t ReadXCR0() noexcept
+        {
+        #ifdef _MSC_VER
+            return _xgetbv(0);
+        #else
+            uint32_t low, high;
+            __asm__ __volatile__("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+            return (uint64_t(high) << 32) | low;
+        #endif
+        }
+    #endif
+
+        inline SimdLevel DetectSimdLevel() noexcept
+        {
+        #if defined(DIRECTX_SIMD_X86)
+            uint32_t regs[4];
+
+            CpuId(0, 0, regs);
+            if (regs[0] < 7)
+                return SimdLevel::Baseline;
+
+            CpuId(1, 0, regs);
+
+            const bool osxsave = (regs[2] & (1u << 27)) != 0;
+            const bool avx = (regs[2] & (1u << 28)) != 0;
+            const bool fma = (regs[2] & (1u << 12)) != 0;
+            const bool f16c = (regs[2] & (1u << 29)) != 0;
+
+            if (!osxsave || !avx || !fma || !f16c)
+                return SimdLevel::Baseline;
+
+            // XMM and YMM state, then the AVX-512 opmask, upper ZMM and high ZMM state.
+            const uint64_t xcr0 = ReadXCR0();
+
+            if ((xcr0 & 0x6) != 0x6)
+                return SimdLevel::Baseline;
+
+            CpuId(7, 0, regs);
+
+            const bool avx2 = (regs[1] & (1u << 5)) != 0;
+            const bool avx512f = (regs[1] & (1u << 16)) != 0;
+
+            if (!avx2)
+                return SimdLevel::Baseline;
+
+            if (avx512f && (xcr0 & 0xE6) == 0xE6)
+                return SimdLevel::AVX512;
+
+            return SimdLevel::AVX2;
+        #else
+            return SimdLevel::Baseline;
+        #endif
+        }
+    }
+
+    // The widest instruction set available on this CPU, detected once.
+    inline SimdLevel GetSimdLevel() noexcept
+    {
+        static const SimdLevel s_level = Private::DetectSimdLevel();
+        return s_level;
+    }
+}
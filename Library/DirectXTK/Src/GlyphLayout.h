@@ -0,0 +1,631 @@
+//--------------------------------------------------------------------------------------
+// File: GlyphLayout.h
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "TextDecoder.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cwctype>
+#include <vector>
+
+
+namespace DirectX
+{
+    // iswspace only takes a wint_t, which cannot hold code points beyond the BMP on Windows.
+    // None of those are whitespace.
+    inline bool IsWhitespaceCharacter(uint32_t character) noexcept
+    {
+        return (character <= 0xFFFF) && iswspace(static_cast<wint_t>(character));
+    }
+
+
+    // The core glyph layout algorithm, shared between DrawString, MeasureString and TextLayout.
+    //
+    // findGlyph(codePoint) returns a pointer to a glyph with the members of SpriteFont::Glyph.
+    // action(glyph, x, y, advance) is called for each glyph that is output, and newLine(y) each
+    // time a line break moves the pen down to y. Only depends on the standard library, so layout
+    // can be tested without a Direct3D device.
+    template<typename TChar, typename TFindGlyph, typename TAction, typename TNewLine>
+    void LayoutGlyphs(TChar const* text, float lineSpacing, bool ignoreWhitespace, TFindGlyph&& findGlyph, TAction&& action, TNewLine&& newLine)
+    {
+        float x = 0;
+        float y = 0;
+
+        TextDecoder<TChar> decoder(text);
+
+        for (uint32_t character = decoder.Next(); character != 0; character = decoder.Next())
+        {
+            switch (character)
+            {
+            case '\r':
+                // Skip carriage returns.
+                continue;
+
+            case '\n':
+                // New line.
+                x = 0;
+                y += lineSpacing;
+                newLine(y);
+                break;
+
+            default:
+                // Output this character.
+                auto glyph = findGlyph(character);
+
+                x += glyph->XOffset;
+
+                if (x < 0)
+                    x = 0;
+
+                const float advance = float(glyph->Subrect.right) - float(glyph->Subrect.left) + glyph->XAdvance;
+
+                if (!ignoreWhitespace
+                    || !IsWhitespaceCharacter(character)
+                    || ((glyph->Subrect.right - glyph->Subrect.left) > 1)
+                    || ((glyph->Subrect.bottom - glyph->Subrect.top) > 1))
+                {
+                    action(glyph, x, y, advance);
+                }
+
+                x += advance;
+                break;
+            }
+        }
+    }
+
+
+    // Turns glyphs placed by the layout into the sprites of a SpriteBatch::DrawRun, collecting them
+    // in fixed size chunks that are passed to flush(elements, count) as they fill up. TElement has
+    // the members of SpriteRunElement. Glyphs from several strings can share one writer, calling
+    // SetPlacement between them, as long as they are drawn with the same color and transform.
+    template<typename TElement, size_t ChunkSize = 256>
+    class GlyphRunWriter
+    {
+    public:
+        GlyphRunWriter() noexcept :
+            mPositionX(0),
+            mPositionY(0),
+            mBaseX(0),
+            mBaseY(0),
+            mFlipX(false),
+            mFlipY(false),
+            mCount(0)
+        {
+        }
+
+        GlyphRunWriter(GlyphRunWriter const&) = delete;
+        GlyphRunWriter& operator= (GlyphRunWriter const&) = delete;
+
+        // Sets where following glyphs are drawn. base is the origin passed to DrawString, already
+        // offset by the text size on mirrored axes. effects holds SpriteEffects flags.
+        void SetPlacement(float positionX, float positionY, float baseX, float baseY, uint32_t effects) noexcept
+        {
+            mPositionX = positionX;
+            mPositionY = positionY;
+            mBaseX = baseX;
+            mBaseY = baseY;
+            mFlipX = (effects & 1) != 0;
+            mFlipY = (effects & 2) != 0;
+        }
+
+        template<typename TGlyph, typename TFlush>
+        void Add(TGlyph const* glyph, float x, float y, TFlush&& flush)
+        {
+            auto& element = mElements[mCount];
+
+            const float glyphY = y + glyph->YOffset;
+
+            element.position.x = mPositionX;
+            element.position.y = mPositionY;
+
+            // The sprite origin moves against the pen position. For mirrored characters it
+            // specifies the bottom and/or right of the glyph instead of the top left.
+            element.origin.x = mFlipX ?
+                mBaseX + x + float(glyph->Subrect.right - glyph->Subrect.left) :
+                mBaseX - x;
+            element.origin.y = mFlipY ?
+                mBaseY + glyphY + float(glyph->Subrect.bottom - glyph->Subrect.top) :
+                mBaseY - glyphY;
+
+            element.sourceRectangle = glyph->Subrect;
+
+            if (++mCount == ChunkSize)
+            {
+                Flush(flush);
+            }
+        }
+
+        // Passes any glyphs not yet flushed to flush(elements, count).
+        template<typename TFlush>
+        void Flush(TFlush&& flush)
+        {
+            if (mCount > 0)
+            {
+                flush(static_cast<TElement const*>(mElements), mCount);
+                mCount = 0;
+            }
+        }
+
+    private:
+        float mPositionX;
+        float mPositionY;
+        float mBaseX;
+        float mBaseY;
+        bool mFlipX;
+        bool mFlipY;
+
+        size_t mCount;
+        TElement mElements[ChunkSize];
+    };
+
+
+    // Controls how GlyphLayout fits text into a box. The default (all zero) value lays text out
+    // exactly as DrawString does, breaking lines only at line feeds.
+    struct GlyphLayoutOptions
+    {
+        enum Wrapping : uint32_t
+        {
+            WrapNone,
+            WrapWord,
+            WrapCharacter,
+        };
+
+        enum Alignment : uint32_t
+        {
+            AlignLeft,
+            AlignCenter,
+            AlignRight,
+        };
+
+        float maxWidth;             // Lines are wrapped, or truncated if ellipsisLength is set, at this width. 0 for no limit.
+        float maxHeight;            // Lines that would end below this are dropped. 0 for no limit.
+        Wrapping wrapping;
+        Alignment alignment;        // Relative to maxWidth, or to the widest line if there is no limit.
+        uint32_t ellipsis[3];       // Code points appended to truncated lines.
+        size_t ellipsisLength;
+    };
+
+
+    // The glyphs of a string as placed by the layout, skipping invisible whitespace just as
+    // DrawString does, along with the size MeasureString would report and per-line metrics.
+    //
+    // Lines are filled greedily. Word wrapping breaks at the last run of whitespace that fits,
+    // dropping the whitespace, and falls back to breaking between characters when a single word
+    // is wider than the line. Since a line only depends on the text from its own start up to the
+    // character that ends it, Update can keep every line that ends before the first changed
+    // character, and only lay out the rest again.
+    template<typename TGlyph>
+    class GlyphLayout
+    {
+    public:
+        struct PlacedGlyph
+        {
+            TGlyph const* glyph;
+            float x;
+            float y;
+            float advance;
+        };
+
+        struct Line
+        {
+            size_t firstGlyph;
+            size_t glyphCount;
+            size_t firstCharacter;  // Index of the first code point of the line in GetText.
+            size_t endCharacter;    // The line depends on the code points before this index, and no others.
+            float y;
+            float width;            // Extent of the glyphs, before alignment.
+            float height;           // Extent below y, as measured by MeasureString.
+            float offset;           // Horizontal alignment offset, already applied to the glyphs.
+            bool truncated;         // Text was dropped from the end of this line.
+        };
+
+        GlyphLayout() noexcept :
+            mOptions{},
+            mLineSpacing(0),
+            mWidth(0),
+            mHeight(0)
+        {
+        }
+
+        template<typename TChar, typename TFindGlyph>
+        void Build(TChar const* text, float lineSpacing, TFindGlyph&& findGlyph)
+        {
+            Build(text, lineSpacing, GlyphLayoutOptions{}, findGlyph);
+        }
+
+        template<typename TChar, typename TFindGlyph>
+        void Build(TChar const* text, float lineSpacing, GlyphLayoutOptions const& options, TFindGlyph&& findGlyph)
+        {
+            Decode(text, mText);
+
+            mOptions = options;
+            mLineSpacing = lineSpacing;
+
+            mGlyphs.clear();
+            mLines.clear();
+
+            LayoutFrom(0, findGlyph);
+        }
+
+        // Lays out new text with the same options, reusing the lines that precede the first
+        // difference from the previous text. Returns how many lines were reused.
+        template<typename TChar, typename TFindGlyph>
+        size_t Update(TChar const* text, TFindGlyph&& findGlyph)
+        {
+            std::vector<uint32_t> newText;
+            Decode(text, newText);
+
+            const size_t common = static_cast<size_t>(std::mismatch(mText.begin(), mText.begin() + static_cast<ptrdiff_t>(std::min(mText.size(), newText.size())), newText.begin()).first - mText.begin());
+
+            mText.swap(newText);
+
+            // The last line always depends on where the text ends, so at least that one is laid out again.
+            auto line = std::find_if(mLines.begin(), mLines.end(), [=](Line const& l) noexcept { return l.endCharacter > common; });
+
+            const size_t restart = static_cast<size_t>(line - mLines.begin());
+            const size_t firstCharacter = (line != mLines.end()) ? line->firstCharacter : 0;
+
+            mGlyphs.resize((line != mLines.end()) ? line->firstGlyph : 0);
+            mLines.resize(restart);
+
+            LayoutFrom(firstCharacter, findGlyph);
+
+            return restart;
+        }
+
+        std::vector<PlacedGlyph> const& GetGlyphs() const noexcept { return mGlyphs; }
+        std::vector<Line> const& GetLines() const noexcept { return mLines; }
+        std::vector<uint32_t> const& GetText() const noexcept { return mText; }
+        GlyphLayoutOptions const& GetOptions() const noexcept { return mOptions; }
+
+        float GetWidth() const noexcept { return mWidth; }
+        float GetHeight() const noexcept { return mHeight; }
+
+        bool IsTruncated() const noexcept
+        {
+            return std::any_of(mLines.begin(), mLines.end(), [](Line const& line) noexcept { return line.truncated; });
+        }
+
+    private:
+        static constexpr size_t NoLine = SIZE_MAX;
+
+        template<typename TChar>
+        static void Decode(TChar const* text, std::vector<uint32_t>& result)
+        {
+            result.clear();
+
+            TextDecoder<TChar> decoder(text);
+
+            for (uint32_t character = decoder.Next(); character != 0; character = decoder.Next())
+            {
+                result.push_back(character);
+            }
+        }
+
+        // Lays out lines starting from the code point at index start, then updates the totals.
+        template<typename TFindGlyph>
+        void LayoutFrom(size_t start, TFindGlyph& findGlyph)
+        {
+            size_t maxLines = SIZE_MAX;
+
+            if (mOptions.maxHeight > 0 && mLineSpacing > 0)
+            {
+                maxLines = std::max<size_t>(1, static_cast<size_t>(mOptions.maxHeight / mLineSpacing));
+            }
+
+            size_t next = start;
+
+            while (next != NoLine)
+            {
+                if (mLines.size() >= maxLines)
+                {
+                    // Out of room. Whether any text was left over depends on all of it.
+                    mLines.back().endCharacter = SIZE_MAX;
+
+                    if (next < mText.size())
+                    {
+                        Truncate(mLines.back(), findGlyph);
+                    }
+
+                    break;
+                }
+
+                next = LayoutLine(next, findGlyph);
+            }
+
+            Align();
+        }
+
+        // Lays out one line, and returns where the next starts, or NoLine if this is the last.
+        template<typename TFindGlyph>
+        size_t LayoutLine(size_t start, TFindGlyph& findGlyph)
+        {
+            const float maxWidth = mOptions.maxWidth;
+            const bool wrap = (maxWidth > 0) && (mOptions.wrapping != GlyphLayoutOptions::WrapNone);
+            const bool clip = (maxWidth > 0) && !wrap && (mOptions.ellipsisLength > 0);
+
+            Line line = { mGlyphs.size(), 0, start, mText.size() + 1, static_cast<float>(mLines.size()) * mLineSpacing, 0, 0, 0, false };
+
+            float x = 0;
+            size_t next = NoLine;
+
+            // Where the line would end and the next begin if broken at the last run of whitespace.
+            size_t breakGlyphs = NoLine;
+            size_t wordStart = start;
+
+            bool hasContent = false;
+            bool inWhitespace = false;
+
+            for (size_t i = start; i < mText.size(); i++)
+            {
+                const uint32_t character = mText[i];
+
+                if (character == '\r')
+                    continue;
+
+                if (character == '\n')
+                {
+                    next = i + 1;
+                    line.endCharacter = next;
+                    break;
+                }
+
+                auto glyph = findGlyph(character);
+
+                const float glyphX = std::max(x + glyph->XOffset, 0.0f);
+                const float width = float(glyph->Subrect.right) - float(glyph->Subrect.left);
+                const bool whitespace = IsWhitespaceCharacter(character);
+
+                if (whitespace)
+                {
+                    if (!inWhitespace && hasContent)
+                    {
+                        breakGlyphs = mGlyphs.size();
+                    }
+
+                    inWhitespace = true;
+                }
+                else
+                {
+                    if (inWhitespace)
+                    {
+                        wordStart = i;
+                        inWhitespace = false;
+                    }
+
+                    // Whitespace may hang past the edge, but nothing else, unless it is the first thing on the line.
+                    if ((wrap || clip) && hasContent && (glyphX + width > maxWidth))
+                    {
+                        if (clip)
+                        {
+                            line.truncated = true;
+                            next = NextLineStart(i);
+                            line.endCharacter = (next != NoLine) ? next : mText.size() + 1;
+                        }
+                        else
+                        {
+                            if (mOptions.wrapping == GlyphLayoutOptions::WrapWord && breakGlyphs != NoLine)
+                            {
+                                mGlyphs.resize(breakGlyphs);
+                                next = wordStart;
+                            }
+                            else
+                            {
+                                next = i;
+                            }
+
+                            line.endCharacter = i + 1;
+                        }
+
+                        break;
+                    }
+
+                    hasContent = true;
+                }
+
+                const float advance = width + glyph->XAdvance;
+
+                if (IsVisible(glyph, whitespace))
+                {
+                    mGlyphs.push_back({ glyph, glyphX, line.y, advance });
+                }
+
+                x = glyphX + advance;
+            }
+
+            line.glyphCount = mGlyphs.size() - line.firstGlyph;
+
+            Measure(line);
+
+            mLines.push_back(line);
+
+            if (line.truncated)
+            {
+                Truncate(mLines.back(), findGlyph);
+            }
+
+            return next;
+        }
+
+        // Marks a line as truncated, replacing its trailing glyphs with the ellipsis if there is one.
+        template<typename TFindGlyph>
+        void Truncate(Line& line, TFindGlyph& findGlyph)
+        {
+            line.truncated = true;
+
+            if (!mOptions.ellipsisLength)
+                return;
+
+            // Measure the ellipsis on its own.
+            TGlyph const* ellipsis[3] = {};
+            float ellipsisWidth = 0;
+
+            {
+                float x = 0;
+
+                for (size_t i = 0; i < mOptions.ellipsisLength; i++)
+                {
+                    ellipsis[i] = findGlyph(mOptions.ellipsis[i]);
+
+                    x = std::max(x + ellipsis[i]->XOffset, 0.0f);
+
+                    const float width = float(ellipsis[i]->Subrect.right) - float(ellipsis[i]->Subrect.left);
+
+                    ellipsisWidth = std::max(ellipsisWidth, x + width);
+
+                    x += width + ellipsis[i]->XAdvance;
+                }
+            }
+
+            // Drop glyphs from the end until the ellipsis fits after them, along with any trailing whitespace.
+            while (line.glyphCount > 0)
+            {
+                auto const& last = mGlyphs[line.firstGlyph + line.glyphCount - 1];
+
+                const bool fits = !(mOptions.maxWidth > 0) || (last.x + last.advance + ellipsisWidth <= mOptions.maxWidth);
+
+                if (fits && !IsWhitespaceCharacter(last.glyph->Character))
+                    break;
+
+                line.glyphCount--;
+            }
+
+            mGlyphs.resize(line.firstGlyph + line.glyphCount);
+
+            float x = 0;
+
+            if (line.glyphCount > 0)
+            {
+                auto const& last = mGlyphs.back();
+
+                x = last.x + last.advance;
+            }
+
+            for (size_t i = 0; i < mOptions.ellipsisLength; i++)
+            {
+                auto glyph = ellipsis[i];
+
+                x = std::max(x + glyph->XOffset, 0.0f);
+
+                const float advance = float(glyph->Subrect.right) - float(glyph->Subrect.left) + glyph->XAdvance;
+
+                mGlyphs.push_back({ glyph, x, line.y, advance });
+
+                x += advance;
+            }
+
+            line.glyphCount = mGlyphs.size() - line.firstGlyph;
+
+            Measure(line);
+        }
+
+        // Matches the measurement in MeasureString.
+        void Measure(Line& line) const noexcept
+        {
+            line.width = 0;
+            line.height = 0;
+
+            for (size_t i = line.firstGlyph; i < line.firstGlyph + line.glyphCount; i++)
+            {
+                auto const& placed = mGlyphs[i];
+                auto const glyph = placed.glyph;
+
+                auto const w = static_cast<float>(glyph->Subrect.right - glyph->Subrect.left);
+                auto h = static_cast<float>(glyph->Subrect.bottom - glyph->Subrect.top) + glyph->YOffset;
+
+                h = IsWhitespaceCharacter(glyph->Character) ?
+                    mLineSpacing :
+                    std::max(h, mLineSpacing);
+
+                line.width = std::max(line.width, placed.x - line.offset + w);
+                line.height = std::max(line.height, h);
+            }
+        }
+
+        // Applies the alignment to every line, and updates the totals.
+        void Align() noexcept
+        {
+            float alignWidth = mOptions.maxWidth;
+
+            if (!(alignWidth > 0))
+            {
+                alignWidth = 0;
+
+                for (auto const& line : mLines)
+                {
+                    alignWidth = std::max(alignWidth, line.width);
+                }
+            }
+
+            mWidth = 0;
+            mHeight = 0;
+
+            for (auto& line : mLines)
+            {
+                float offset = 0;
+
+                if (mOptions.alignment == GlyphLayoutOptions::AlignCenter)
+                {
+                    offset = (alignWidth - line.width) * 0.5f;
+                }
+                else if (mOptions.alignment == GlyphLayoutOptions::AlignRight)
+                {
+                    offset = alignWidth - line.width;
+                }
+
+                // Lines kept by Update already have their old offset applied.
+                const float delta = offset - line.offset;
+
+                if (delta != 0)
+                {
+                    for (size_t i = line.firstGlyph; i < line.firstGlyph + line.glyphCount; i++)
+                    {
+                        mGlyphs[i].x += delta;
+                    }
+
+                    line.offset = offset;
+                }
+
+                if (line.glyphCount > 0)
+                {
+                    mWidth = std::max(mWidth, line.offset + line.width);
+                    mHeight = std::max(mHeight, line.y + line.height);
+                }
+            }
+        }
+
+        // Invisible whitespace is skipped, just as DrawString does.
+        static bool IsVisible(TGlyph const* glyph, bool whitespace) noexcept
+        {
+            return !whitespace
+                || ((glyph->Subrect.right - glyph->Subrect.left) > 1)
+                || ((glyph->Subrect.bottom - glyph->Subrect.top) > 1);
+        }
+
+        // Returns the start of the line after the one holding the code point at index i.
+        size_t NextLineStart(size_t i) const noexcept
+        {
+            auto lineFeed = std::find(mText.begin() + static_cast<ptrdiff_t>(i), mText.end(), uint32_t('\n'));
+
+            return (lineFeed != mText.end()) ? static_cast<size_t>(lineFeed - mText.begin()) + 1 : NoLine;
+        }
+
+        std::vector<uint32_t> mText;
+        GlyphLayoutOptions mOptions;
+        float mLineSpacing;
+
+        std::vector<PlacedGlyph> mGlyphs;
+        std::vector<Line> mLines;
+        float mWidth;
+        float mHeight;
+    };
+}
@@ -0,0 +1,216 @@
+//--------------------------------------------------------------------------------------
+// File: GlyphLookup.h
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+namespace DirectX
+{
+    // Maps code points to glyph indices in constant time. Built once when a font is loaded.
+    //
+    // Code points below DirectRange (Latin, Greek, Cyrillic, Hebrew, Arabic and so on) index a
+    // flat array. Everything above goes through a two-level page table. The top level holds one
+    // entry per 256 code points, and each page present in the font stores a 256-bit occupancy
+    // mask plus the rank of its first code point, so a glyph's index is that rank plus the
+    // number of mask bits below it. Sparse sets such as CJK subsets cost 48 bytes per page.
+    // Values beyond the Unicode range, which only custom glyph sets can contain, fall back to
+    // a binary search so they cannot inflate the page table.
+    class GlyphLookupTable
+    {
+    public:
+        static constexpr uint32_t NotFound = UINT32_MAX;
+        static constexpr uint32_t DirectRange = 0x800;
+        static constexpr uint32_t MaxCodePoint = 0x10FFFF;
+
+        GlyphLookupTable() = default;
+
+        // Builds the table from count code points in ascending order. If a code point appears
+        // more than once, it maps to the first of them.
+        void Build(uint32_t const* codePoints, size_t count)
+        {
+            mDirect.clear();
+            mPageIndex.clear();
+            mPages.clear();
+            mRemap.clear();
+            mOutOfRange.clear();
+
+            // Copies of the constants, so they are not bound to references (which would need out of line definitions before C++17).
+            const uint32_t empty = NotFound;
+            const uint32_t directRange = DirectRange;
+            const uint32_t maxTableCodePoint = MaxCodePoint;
+
+            // Only code points within the Unicode range go in the tables.
+            const size_t tableCount = static_cast<size_t>(std::upper_bound(codePoints, codePoints + count, maxTableCodePoint) - codePoints);
+
+            for (size_t i = tableCount; i < count; i++)
+            {
+                if (i == tableCount || codePoints[i] != codePoints[i - 1])
+                {
+                    mOutOfRange.push_back({ codePoints[i], static_cast<uint32_t>(i) });
+                }
+            }
+
+            count = tableCount;
+
+            if (!count)
+                return;
+
+            const uint32_t maxCodePoint = codePoints[count - 1];
+
+            mDirect.assign(std::min(maxCodePoint + 1, directRange), empty);
+
+            if (maxCodePoint >= directRange)
+            {
+                mPageIndex.assign((maxCodePoint >> PageShift) + 1, empty);
+            }
+
+            // Ranks count unique code points, which only differ from glyph indices if there are duplicates.
+            uint32_t rank = 0;
+
+            for (size_t i = 0; i < count; i++)
+            {
+                const uint32_t codePoint = codePoints[i];
+
+                if (i > 0 && codePoint == codePoints[i - 1])
+                {
+                    if (mRemap.empty())
+                    {
+                        // First duplicate found: every unique code point so far matched its glyph index.
+                        mRemap.reserve(count);
+
+                        for (uint32_t j = 0; j < rank; j++)
+                        {
+                            mRemap.push_back(j);
+                        }
+                    }
+
+                    continue;
+                }
+
+                if (!mRemap.empty())
+                {
+                    mRemap.push_back(static_cast<uint32_t>(i));
+                }
+
+                if (codePoint < DirectRange)
+                {
+                    mDirect[codePoint] = static_cast<uint32_t>(i);
+                }
+                else
+                {
+                    auto& pageEntry = mPageIndex[codePoint >> PageShift];
+
+                    if (pageEntry == NotFound)
+                    {
+                        pageEntry = static_cast<uint32_t>(mPages.size());
+                        mPages.push_back({});
+                    }
+
+                    auto& page = mPages[pageEntry];
+                    const uint32_t word = (codePoint >> 6) & 3;
+
+                    if (!page.bits[word])
+                    {
+                        // The first code point in each word of the mask sets that word's starting rank.
+                        page.base[word] = rank;
+                    }
+
+                    page.bits[word] |= uint64_t(1) << (codePoint & 63);
+                }
+
+                rank++;
+            }
+
+            // The number of pages is not known in advance, so drop the slack left by growing the vector.
+            mPages.shrink_to_fit();
+        }
+
+        // Returns the glyph index for a code point, or NotFound.
+        uint32_t Find(uint32_t codePoint) const noexcept
+        {
+            if (codePoint < mDirect.size())
+                return mDirect[codePoint];
+
+            const size_t pageNumber = codePoint >> PageShift;
+
+            if (pageNumber >= mPageIndex.size())
+                return (codePoint > MaxCodePoint) ? FindOutOfRange(codePoint) : NotFound;
+
+            const uint32_t pageEntry = mPageIndex[pageNumber];
+
+            if (pageEntry == NotFound)
+                return NotFound;
+
+            auto const& page = mPages[pageEntry];
+            const uint32_t word = (codePoint >> 6) & 3;
+            const uint64_t bit = uint64_t(1) << (codePoint & 63);
+
+            if (!(page.bits[word] & bit))
+                return NotFound;
+
+            const uint32_t rank = page.base[word] + PopCount(page.bits[word] & (bit - 1));
+
+            return mRemap.empty() ? rank : mRemap[rank];
+        }
+
+        // Bytes used by the table, for comparing against other lookup schemes.
+        size_t GetMemoryUsage() const noexcept
+        {
+            return mDirect.capacity() * sizeof(uint32_t)
+                + mPageIndex.capacity() * sizeof(uint32_t)
+                + mPages.capacity() * sizeof(Page)
+                + mRemap.capacity() * sizeof(uint32_t)
+                + mOutOfRange.capacity() * sizeof(Entry);
+        }
+
+    private:
+        static constexpr uint32_t PageShift = 8;
+
+        struct Page
+        {
+            uint32_t base[4];
+            uint64_t bits[4];
+        };
+
+        struct Entry
+        {
+            uint32_t codePoint;
+            uint32_t index;
+        };
+
+        uint32_t FindOutOfRange(uint32_t codePoint) const noexcept
+        {
+            auto it = std::lower_bound(mOutOfRange.begin(), mOutOfRange.end(), codePoint,
+                [](Entry const& entry, uint32_t value) noexcept { return entry.codePoint < value; });
+
+            return (it != mOutOfRange.end() && it->codePoint == codePoint) ? it->index : NotFound;
+        }
+
+        // Portable population count; the hardware instruction is not guaranteed on every target.
+        static uint32_t PopCount(uint64_t value) noexcept
+        {
+            value = value - ((value >> 1) & 0x5555555555555555ull);
+            value = (value & 0x3333333333333333ull) + ((value >> 2) & 0x3333333333333333ull);
+            value = (value + (value >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+
+            return static_cast<uint32_t>((value * 0x0101010101010101ull) >> 56);
+        }
+
+        std::vector<uint32_t> mDirect;
+        std::vector<uint32_t> mPageIndex;
+        std::vector<Page> mPages;
+        std::vector<uint32_t> mRemap;
+        std::vector<Entry> mOutOfRange;
+    };
+}
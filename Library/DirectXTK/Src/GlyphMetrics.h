@@ -0,0 +1,247 @@
+//--------------------------------------------------------------------------------------
+// File: GlyphMetrics.h
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "GlyphLayout.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if (defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)) && !defined(_XM_NO_INTRINSICS_)
+#define DIRECTX_GLYPHMETRICS_SSE2
+#include <emmintrin.h>
+#endif
+
+
+namespace DirectX
+{
+    // Everything MeasureString and MeasureDrawBounds report, gathered in one pass.
+    struct GlyphMetricsResult
+    {
+        float width;        // MeasureString
+        float height;
+        float left;         // MeasureDrawBounds, before conversion to whole pixels. Only valid if glyphCount > 0.
+        float top;
+        float right;
+        float bottom;
+        size_t glyphCount;  // Glyphs that contributed to the measurements.
+        size_t lineCount;
+    };
+
+
+    // Per-glyph measurement data, precomputed whenever the font or its line spacing changes, so
+    // measuring a string needs no whitespace classification and no per-glyph branching.
+    //
+    // Glyphs are positioned exactly as LayoutGlyphs does. Each glyph then contributes one vector
+    // maximum and one vector minimum, whose lanes hold the MeasureString size and the draw bounds.
+    // Every value is computed with the same sequence of float operations as the separate
+    // MeasureString and MeasureDrawBounds loops, so the results are identical.
+    template<typename TGlyph>
+    class GlyphMetricsTable
+    {
+    public:
+        // Index of the entries used for characters missing from the font. They are measured as the
+        // default glyph, but whether they can be skipped as whitespace depends on the character.
+        size_t GetDefaultIndex(bool whitespace) const noexcept
+        {
+            return mEntries.size() - (whitespace ? 1 : 2);
+        }
+
+        void Build(TGlyph const* glyphs, size_t count, TGlyph const* defaultGlyph, float lineSpacing)
+        {
+            mEntries.resize(count + 2);
+
+            for (size_t i = 0; i < count; i++)
+            {
+                const bool whitespace = IsWhitespaceCharacter(glyphs[i].Character);
+
+                mEntries[i] = MakeEntry(glyphs[i], whitespace, whitespace, lineSpacing);
+            }
+
+            if (defaultGlyph)
+            {
+                const bool whitespace = IsWhitespaceCharacter(defaultGlyph->Character);
+
+                mEntries[count] = MakeEntry(*defaultGlyph, whitespace, false, lineSpacing);
+                mEntries[count + 1] = MakeEntry(*defaultGlyph, whitespace, true, lineSpacing);
+            }
+            else
+            {
+                mEntries[count] = Entry{};
+                mEntries[count + 1] = Entry{};
+            }
+        }
+
+        // Lays out and measures text drawn at positionX, positionY. findIndex(codePoint) returns the
+        // glyph index, or GetDefaultIndex for characters not in the font.
+        template<typename TChar, typename TFindIndex>
+        GlyphMetricsResult Measure(TChar const* text, float lineSpacing, bool ignoreWhitespace, float positionX, float positionY, TFindIndex&& findIndex) const
+        {
+            const uint32_t skipFlags = ignoreWhitespace ? InvisibleFlag : 0;
+
+            float x = 0;
+            float y = 0;
+            size_t glyphCount = 0;
+            size_t lineCount = 1;
+
+        #if defined(DIRECTX_GLYPHMETRICS_SSE2)
+            // Lanes: MeasureString width and height, then the right and bottom of the draw bounds.
+            __m128 maximum = _mm_setr_ps(0, 0, -FLT_MAX, -FLT_MAX);
+
+            // Lanes 2 and 3 hold the left and top of the draw bounds.
+            __m128 minimum = _mm_set1_ps(FLT_MAX);
+
+            const __m128 position = _mm_setr_ps(0, 0, positionX, positionY);
+            const __m128 topMask = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1));
+        #else
+            float width = 0;
+            float height = 0;
+            float left = FLT_MAX;
+            float top = FLT_MAX;
+            float right = -FLT_MAX;
+            float bottom = -FLT_MAX;
+        #endif
+
+            TextDecoder<TChar> decoder(text);
+
+            for (uint32_t character = decoder.Next(); character != 0; character = decoder.Next())
+            {
+                switch (character)
+                {
+                case '\r':
+                    continue;
+
+                case '\n':
+                    x = 0;
+                    y += lineSpacing;
+                    lineCount++;
+                    break;
+
+                default:
+                    auto const& entry = mEntries[findIndex(character)];
+
+                    x += entry.xOffset;
+
+                    if (x < 0)
+                        x = 0;
+
+                    if (!(entry.flags & skipFlags))
+                    {
+                    #if defined(DIRECTX_GLYPHMETRICS_SSE2)
+                        // x, y, position.x + x, position.y + y + inkTop.
+                        __m128 origin = _mm_add_ps(_mm_setr_ps(x, y, x, y), position);
+                        origin = _mm_add_ps(origin, _mm_and_ps(_mm_loadu_ps(&entry.xOffset), topMask));
+
+                        maximum = _mm_max_ps(maximum, _mm_add_ps(origin, _mm_loadu_ps(entry.extent)));
+                        minimum = _mm_min_ps(minimum, origin);
+                    #else
+                        const float minX = positionX + x;
+                        const float minY = positionY + y + entry.inkTop;
+
+                        width = std::max(width, x + entry.extent[0]);
+                        height = std::max(height, y + entry.extent[1]);
+                        left = std::min(left, minX);
+                        top = std::min(top, minY);
+                        right = std::max(right, minX + entry.extent[2]);
+                        bottom = std::max(bottom, minY + entry.extent[3]);
+                    #endif
+
+                        glyphCount++;
+                    }
+
+                    x += entry.advance;
+                    break;
+                }
+            }
+
+            GlyphMetricsResult result;
+
+        #if defined(DIRECTX_GLYPHMETRICS_SSE2)
+            alignas(16) float maximumLanes[4];
+            alignas(16) float minimumLanes[4];
+
+            _mm_store_ps(maximumLanes, maximum);
+            _mm_store_ps(minimumLanes, minimum);
+
+            result.width = maximumLanes[0];
+            result.height = maximumLanes[1];
+            result.left = minimumLanes[2];
+            result.top = minimumLanes[3];
+            result.right = maximumLanes[2];
+            result.bottom = maximumLanes[3];
+        #else
+            result.width = width;
+            result.height = height;
+            result.left = left;
+            result.top = top;
+            result.right = right;
+            result.bottom = bottom;
+        #endif
+
+            result.glyphCount = glyphCount;
+            result.lineCount = lineCount;
+
+            return result;
+        }
+
+    private:
+        static constexpr uint32_t InvisibleFlag = 1;
+
+        // Loaded unaligned, since std::vector does not honor over-aligned types before C++17.
+        struct Entry
+        {
+            // Added to the glyph position: MeasureString width and height, then the draw bounds
+            // width (at least the advance) and height, measured from the top of the ink.
+            float extent[4];
+
+            // Lane 3 of these four holds inkTop, so they load as one vector with the top offset in place.
+            float xOffset;
+            float advance;
+            uint32_t flags;
+            float inkTop;
+        };
+
+        static_assert(sizeof(Entry) == 32, "Entry is loaded as two vectors");
+
+        // Matches the measurements in MeasureString and MeasureDrawBounds, which classify the glyph,
+        // and the whitespace skipping in LayoutGlyphs, which classifies the character drawn with it.
+        static Entry MakeEntry(TGlyph const& glyph, bool whitespace, bool whitespaceCharacter, float lineSpacing) noexcept
+        {
+            const float w = static_cast<float>(glyph.Subrect.right - glyph.Subrect.left);
+            const float h = static_cast<float>(glyph.Subrect.bottom - glyph.Subrect.top);
+            const float advance = float(glyph.Subrect.right) - float(glyph.Subrect.left) + glyph.XAdvance;
+
+            Entry entry = {};
+
+            entry.extent[0] = w;
+            entry.extent[1] = whitespace ? lineSpacing : std::max(h + glyph.YOffset, lineSpacing);
+            entry.extent[2] = std::max(advance, w);
+            entry.extent[3] = whitespace ? lineSpacing : h;
+
+            entry.xOffset = glyph.XOffset;
+            entry.advance = advance;
+            entry.inkTop = whitespace ? 0.0f : glyph.YOffset;
+
+            if (whitespaceCharacter
+                && ((glyph.Subrect.right - glyph.Subrect.left) <= 1)
+                && ((glyph.Subrect.bottom - glyph.Subrect.top) <= 1))
+            {
+                entry.flags |= InvisibleFlag;
+            }
+
+            return entry;
+        }
+
+        std::vector<Entry> mEntries;
+    };
+}
@@ -0,0 +1,200 @@
+//--------------------------------------------------------------------------------------
+// File: HalfKernels.h
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CpuFeatures.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <DirectXMath.h>
+#include <DirectXPackedVector.h>
+
+
+namespace DirectX
+{
+    namespace HalfKernels
+    {
+        using PackedVector::HALF;
+
+        // Converts arrays of count components, which must not overlap.
+        using FloatToHalfKernel = void (*)(float const* source, size_t count, HALF* result);
+        using HalfToFloatKernel = void (*)(HALF const* source, size_t count, float* result);
+
+        struct Kernels
+        {
+            FloatToHalfKernel floatToHalf;
+            HalfToFloatKernel halfToFloat;
+        };
+
+        // DirectXMath's own conversions, which use F16C four at a time when it is built for it.
+        namespace Baseline
+        {
+            inline void FloatToHalf(float const* source, size_t count, HALF* result) noexcept
+            {
+                PackedVector::XMConvertFloatToHalfStream(result, sizeof(HALF), source, sizeof(float), count);
+            }
+
+            inline void HalfToFloat(HALF const* source, size_t count, float* result) noexcept
+            {
+                PackedVector::XMConvertHalfToFloatStream(result, sizeof(float), source, sizeof(HALF), count);
+            }
+
+            inline Kernels const& GetKernels() noexcept
+            {
+                static const Kernels s_kernels =
+                {
+                    FloatToHalf,
+                    HalfToFloat,
+                };
+
+                return s_kernels;
+            }
+        }
+
+    #if defined(DIRECTX_SIMD_X86)
+        DIRECTX_BEGIN_TARGET_AVX2
+
+        // Eight components at a time with F16C. The remainder goes through a padded copy, so that every
+        // component is converted the same way, rounding to nearest even.
+        namespace AVX2
+        {
+            inline void FloatToHalf(float const* source, size_t count, HALF* result) noexcept
+            {
+                size_t i = 0;
+
+                for (; i + 8 <= count; i += 8)
+                {
+                    const __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(source + i), _MM_FROUND_TO_NEAREST_INT);
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(result + i), h);
+                }
+
+                if (i < count)
+                {
+                    float f[8] = {};
+                    HALF h[8];
+
+                    memcpy(f, source + i, (count - i) * sizeof(float));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(h), _mm256_cvtps_ph(_mm256_loadu_ps(f), _MM_FROUND_TO_NEAREST_INT));
+                    memcpy(result + i, h, (count - i) * sizeof(HALF));
+                }
+            }
+
+            inline void HalfToFloat(HALF const* source, size_t count, float* result) noexcept
+            {
+                size_t i = 0;
+
+                for (; i + 8 <= count; i += 8)
+                {
+                    const __m128i h = _mm_loadu_si128(reinterpret_cast<__m128i const*>(source + i));
+                    _mm256_storeu_ps(result + i, _mm256_cvtph_ps(h));
+                }
+
+                if (i < count)
+                {
+                    HALF h[8] = {};
+                    float f[8];
+
+                    memcpy(h, source + i, (count - i) * sizeof(HALF));
+                    _mm256_storeu_ps(f, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<__m128i const*>(h))));
+                    memcpy(result + i, f, (count - i) * sizeof(float));
+                }
+            }
+
+            inline Kernels const& GetKernels() noexcept
+            {
+                static const Kernels s_kernels =
+                {
+                    FloatToHalf,
+                    HalfToFloat,
+                };
+
+                return s_kernels;
+            }
+        }
+
+        DIRECTX_END_TARGET
+
+        DIRECTX_BEGIN_TARGET_AVX512
+
+        // Sixteen components at a time, leaving the remainder to AVX2.
+        namespace AVX512
+        {
+            inline void FloatToHalf(float const* source, size_t count, HALF* result) noexcept
+            {
+                size_t i = 0;
+
+                for (; i + 16 <= count; i += 16)
+                {
+                    const __m256i h = _mm512_cvtps_ph(_mm512_loadu_ps(source + i), _MM_FROUND_TO_NEAREST_INT);
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(result + i), h);
+                }
+
+                AVX2::FloatToHalf(source + i, count - i, result + i);
+            }
+
+            inline void HalfToFloat(HALF const* source, size_t count, float* result) noexcept
+            {
+                size_t i = 0;
+
+                for (; i + 16 <= count; i += 16)
+                {
+                    const __m256i h = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(source + i));
+                    _mm512_storeu_ps(result + i, _mm512_cvtph_ps(h));
+                }
+
+                AVX2::HalfToFloat(source + i, count - i, result + i);
+            }
+
+            inline Kernels const& GetKernels() noexcept
+            {
+                static const Kernels s_kernels =
+                {
+                    FloatToHalf,
+                    HalfToFloat,
+                };
+
+                return s_kernels;
+            }
+        }
+
+        DIRECTX_END_TARGET
+    #endif
+
+        // The kernels for an instruction set, which the CPU must support.
+        inline Kernels const& GetHalfKernels(SimdLevel level) noexcept
+        {
+        #if defined(DIRECTX_SIMD_X86)
+            switch (level)
+            {
+            case SimdLevel::AVX512:
+                return AVX512::GetKernels();
+
+            case SimdLevel::AVX2:
+                return AVX2::GetKernels();
+
+            default:
+                break;
+            }
+        #else
+            (void)level;
+        #endif
+
+            return Baseline::GetKernels();
+        }
+
+        // The kernels for the widest instruction set this CPU supports.
+        inline Kernels const& GetHalfKernels() noexcept
+        {
+            return GetHalfKernels(GetSimdLevel());
+        }
+    }
+}
@@ -0,0 +1,209 @@
+//--------------------------------------------------------------------------------------
+// File: MappedFile.h
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#ifdef _WIN32
+#include "PlatformHelpers.h"
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+namespace DirectX
+{
+    // A read-only view of a whole file, mapped into memory rather than read into a buffer. Pages
+    // are only loaded when touched, and being backed by the file they cost no commit charge, so
+    // loaders can use data in place and pass large payloads straight to resource creation.
+    // The view stays valid until Close, or until the object is destroyed.
+    class MappedFile
+    {
+    public:
+        MappedFile() noexcept :
+            mData(nullptr),
+            mSize(0)
+        {
+        }
+
+        MappedFile(MappedFile&& other) noexcept :
+            mData(other.mData),
+            mSize(other.mSize)
+        {
+            other.mData = nullptr;
+            other.mSize = 0;
+        }
+
+        MappedFile& operator= (MappedFile&& other) noexcept
+        {
+            if (this != &other)
+            {
+                Close();
+
+                mData = other.mData;
+                mSize = other.mSize;
+
+                other.mData = nullptr;
+                other.mSize = 0;
+            }
+
+            return *this;
+        }
+
+        MappedFile(MappedFile const&) = delete;
+        MappedFile& operator= (MappedFile const&) = delete;
+
+        ~MappedFile()
+        {
+            Close();
+        }
+
+    #ifdef _WIN32
+        HRESULT Open(wchar_t const* fileName) noexcept
+        {
+            Close();
+
+            if (!fileName)
+                return E_INVALIDARG;
+
+        #if (_WIN32_WINNT >= _WIN32_WINNT_WIN8)
+            ScopedHandle hFile(safe_handle(CreateFile2(
+                fileName,
+                GENERIC_READ, FILE_SHARE_READ, OPEN_EXISTING,
+                nullptr)));
+        #else
+            ScopedHandle hFile(safe_handle(CreateFileW(
+                fileName,
+                GENERIC_READ, FILE_SHARE_READ,
+                nullptr,
+                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                nullptr)));
+        #endif
+
+            if (!hFile)
+                return HRESULT_FROM_WIN32(GetLastError());
+
+            FILE_STANDARD_INFO fileInfo;
+            if (!GetFileInformationByHandleEx(hFile.get(), FileStandardInfo, &fileInfo, sizeof(fileInfo)))
+            {
+                return HRESULT_FROM_WIN32(GetLastError());
+            }
+
+            // Same limit as BinaryReader::ReadEntireFile. Empty files cannot be mapped.
+            if (fileInfo.EndOfFile.HighPart > 0)
+                return E_FAIL;
+
+            if (!fileInfo.EndOfFile.LowPart)
+                return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+
+            // The view keeps the mapping and file open, so both handles can be closed once it exists.
+        #if defined(WINAPI_FAMILY) && (WINAPI_FAMILY == WINAPI_FAMILY_APP)
+            ScopedHandle hMapping(CreateFileMappingFromApp(hFile.get(), nullptr, PAGE_READONLY, 0, nullptr));
+        #else
+            ScopedHandle hMapping(CreateFileMappingW(hFile.get(), nullptr, PAGE_READONLY, 0, 0, nullptr));
+        #endif
+
+            if (!hMapping)
+                return HRESULT_FROM_WIN32(GetLastError());
+
+        #if defined(WINAPI_FAMILY) && (WINAPI_FAMILY == WINAPI_FAMILY_APP)
+            void* view = MapViewOfFileFromApp(hMapping.get(), FILE_MAP_READ, 0, 0);
+        #else
+            void* view = MapViewOfFile(hMapping.get(), FILE_MAP_READ, 0, 0, 0);
+        #endif
+
+            if (!view)
+                return HRESULT_FROM_WIN32(GetLastError());
+
+            mData = static_cast<uint8_t const*>(view);
+            mSize = fileInfo.EndOfFile.LowPart;
+
+            return S_OK;
+        }
+    #else
+        // Returns 0 on success, or an errno value.
+        int Open(char const* fileName) noexcept
+        {
+            Close();
+
+            if (!fileName)
+                return EINVAL;
+
+            const int fd = open(fileName, O_RDONLY | O_CLOEXEC);
+
+            if (fd < 0)
+                return errno;
+
+            struct stat fileInfo;
+            int result = 0;
+
+            if (fstat(fd, &fileInfo) != 0)
+            {
+                result = errno;
+            }
+            else if (fileInfo.st_size <= 0)
+            {
+                // Empty files cannot be mapped.
+                result = EINVAL;
+            }
+            else
+            {
+                const size_t size = static_cast<size_t>(fileInfo.st_size);
+
+                void* view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+                if (view == MAP_FAILED)
+                {
+                    result = errno;
+                }
+                else
+                {
+                    mData = static_cast<uint8_t const*>(view);
+                    mSize = size;
+                }
+            }
+
+            // The mapping keeps its own reference to the file.
+            close(fd);
+
+            return result;
+        }
+    #endif
+
+        void Close() noexcept
+        {
+            if (mData)
+            {
+            #ifdef _WIN32
+                UnmapViewOfFile(mData);
+            #else
+                munmap(const_cast<uint8_t*>(mData), mSize);
+            #endif
+
+                mData = nullptr;
+                mSize = 0;
+            }
+        }
+
+        bool IsOpen() const noexcept { return mData != nullptr; }
+
+        uint8_t const* GetData() const noexcept { return mData; }
+        size_t GetSize() const noexcept { return mSize; }
+
+    private:
+        uint8_t const* mData;
+        size_t mSize;
+    };
+}
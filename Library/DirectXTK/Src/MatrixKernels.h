@@ -0,0 +1,214 @@
+//--------------------------------------------------------------------------------------
+// File: MatrixKernels.h
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CpuFeatures.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include <DirectXMath.h>
+
+
+namespace DirectX
+{
+    namespace MatrixKernels
+    {
+        // Parent index of a matrix at the root of a hierarchy (matches ModelBone::c_Invalid).
+        constexpr uint32_t NoParent = uint32_t(-1);
+
+        // Matrices are 16 floats in XMFLOAT4X4 order; 3x4 results are 12 floats in XMFLOAT3X4 order.
+        // Results may alias an input array exactly, but must not otherwise overlap them.
+        using MultiplyKernel = void (*)(float const* m1, float const* m2, size_t count, float* result);
+        using MultiplyHierarchyKernel = void (*)(float const* local, uint32_t const* parents, size_t count, float const* root, float* result);
+
+        struct Kernels
+        {
+            MultiplyKernel multiply;
+            MultiplyKernel multiply3x4;
+            MultiplyHierarchyKernel multiplyHierarchy;
+        };
+
+        // XMMatrixMultiply one matrix at a time, so the results are those of Matrix::operator* by definition.
+        namespace Baseline
+        {
+            inline void Multiply(float const* m1, float const* m2, size_t count, float* result) noexcept
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    auto const M1 = XMLoadFloat4x4(reinterpret_cast<XMFLOAT4X4 const*>(m1 + i * 16));
+                    auto const M2 = XMLoadFloat4x4(reinterpret_cast<XMFLOAT4X4 const*>(m2 + i * 16));
+
+                    XMStoreFloat4x4(reinterpret_cast<XMFLOAT4X4*>(result + i * 16), XMMatrixMultiply(M1, M2));
+                }
+            }
+
+            inline void Multiply3x4(float const* m1, float const* m2, size_t count, float* result) noexcept
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    auto const M1 = XMLoadFloat4x4(reinterpret_cast<XMFLOAT4X4 const*>(m1 + i * 16));
+                    auto const M2 = XMLoadFloat4x4(reinterpret_cast<XMFLOAT4X4 const*>(m2 + i * 16));
+
+                    // XMStoreFloat3x4, which older versions of DirectXMath lack.
+                    const XMMATRIX M = XMMatrixTranspose(XMMatrixMultiply(M1, M2));
+
+                    XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(result + i * 12), M.r[0]);
+                    XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(result + i * 12 + 4), M.r[1]);
+                    XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(result + i * 12 + 8), M.r[2]);
+                }
+            }
+
+            inline void MultiplyHierarchy(float const* local, uint32_t const* parents, size_t count, float const* root, float* result) noexcept
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    const uint32_t parent = parents[i];
+                    assert(parent == NoParent || parent < i);
+
+                    float const* m2 = (parent == NoParent) ? root : result + size_t(parent) * 16;
+
+                    Multiply(local + i * 16, m2, 1, result + i * 16);
+                }
+            }
+
+            inline Kernels const& GetKernels() noexcept
+            {
+                static const Kernels s_kernels =
+                {
+                    Multiply,
+                    Multiply3x4,
+                    MultiplyHierarchy,
+                };
+
+                return s_kernels;
+            }
+        }
+
+    // When DirectXMath is itself built for AVX2, XMMatrixMultiply fuses its multiply-adds, so the
+    // wider kernels (which match its SSE code) are only used when they give identical results.
+    #if defined(DIRECTX_SIMD_X86) && !defined(_XM_AVX2_INTRINSICS_) && !defined(_XM_FMA3_INTRINSICS_)
+    #define DIRECTX_MATRIXKERNELS_WIDE
+    #endif
+
+    // GCC fuses separate multiplies and adds where FMA is available unless told not to, which
+    // would change the results. MSVC never fuses intrinsics, and Clang only within one expression.
+    #if defined(__GNUC__) && !defined(__clang__)
+    #define DIRECTX_MATRIXKERNELS_NO_CONTRACT _Pragma("GCC optimize(\"fp-contract=off\")")
+    #else
+    #define DIRECTX_MATRIXKERNELS_NO_CONTRACT
+    #endif
+
+    #if defined(DIRECTX_MATRIXKERNELS_WIDE)
+        DIRECTX_BEGIN_TARGET_AVX2
+        DIRECTX_MATRIXKERNELS_NO_CONTRACT
+
+        // Two rows of a matrix at a time.
+        namespace AVX2
+        {
+            struct Rows
+            {
+                using Vector = __m256;
+
+                static constexpr size_t Count = 2;
+
+                static __m256 Load(float const* p) noexcept { return _mm256_loadu_ps(p); }
+                static void Store(float* p, __m256 v) noexcept { _mm256_storeu_ps(p, v); }
+                static __m256 Broadcast(float const* row) noexcept { return _mm256_broadcast_ps(reinterpret_cast<__m128 const*>(row)); }
+
+                template<int Element>
+                static __m256 Splat(__m256 v) noexcept { return _mm256_shuffle_ps(v, v, _MM_SHUFFLE(Element, Element, Element, Element)); }
+
+                static __m256 Add(__m256 a, __m256 b) noexcept { return _mm256_add_ps(a, b); }
+                static __m256 Multiply(__m256 a, __m256 b) noexcept { return _mm256_mul_ps(a, b); }
+
+                static __m128 Row(__m256 const* rows, size_t index) noexcept
+                {
+                    __m256 const& v = rows[index / 2];
+                    return (index & 1) ? _mm256_extractf128_ps(v, 1) : _mm256_castps256_ps128(v);
+                }
+            };
+
+        #include "MatrixKernels.inl"
+        }
+
+        DIRECTX_END_TARGET
+
+        DIRECTX_BEGIN_TARGET_AVX512
+        DIRECTX_MATRIXKERNELS_NO_CONTRACT
+
+        // A whole matrix at a time.
+        namespace AVX512
+        {
+            struct Rows
+            {
+                using Vector = __m512;
+
+                static constexpr size_t Count = 4;
+
+                static __m512 Load(float const* p) noexcept { return _mm512_loadu_ps(p); }
+                static void Store(float* p, __m512 v) noexcept { _mm512_storeu_ps(p, v); }
+                static __m512 Broadcast(float const* row) noexcept { return _mm512_broadcast_f32x4(_mm_loadu_ps(row)); }
+
+                template<int Element>
+                static __m512 Splat(__m512 v) noexcept { return _mm512_shuffle_ps(v, v, _MM_SHUFFLE(Element, Element, Element, Element)); }
+
+                static __m512 Add(__m512 a, __m512 b) noexcept { return _mm512_add_ps(a, b); }
+                static __m512 Multiply(__m512 a, __m512 b) noexcept { return _mm512_mul_ps(a, b); }
+
+                static __m128 Row(__m512 const* rows, size_t index) noexcept
+                {
+                    switch (index)
+                    {
+                    case 0: return _mm512_castps512_ps128(rows[0]);
+                    case 1: return _mm512_extractf32x4_ps(rows[0], 1);
+                    case 2: return _mm512_extractf32x4_ps(rows[0], 2);
+                    default: return _mm512_extractf32x4_ps(rows[0], 3);
+                    }
+                }
+            };
+
+        #include "MatrixKernels.inl"
+        }
+
+        DIRECTX_END_TARGET
+    #endif
+
+        // The kernels for an instruction set the CPU supports. Where the wider kernels are left out,
+        // every level gets the baseline ones.
+        inline Kernels const& GetMatrixKernels(SimdLevel level) noexcept
+        {
+        #if defined(DIRECTX_MATRIXKERNELS_WIDE)
+            switch (level)
+            {
+            case SimdLevel::AVX512:
+                return AVX512::GetKernels();
+
+            case SimdLevel::AVX2:
+                return AVX2::GetKernels();
+
+            default:
+                break;
+            }
+        #else
+            (void)level;
+        #endif
+
+            return Baseline::GetKernels();
+        }
+
+        // The kernels for the widest instruction set this CPU supports.
+        inline Kernels const& GetMatrixKernels() noexcept
+        {
+            return GetMatrixKernels(GetSimdLevel());
+        }
+    }
+}
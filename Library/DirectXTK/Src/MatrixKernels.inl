@@ -0,0 +1,110 @@
+//--------------------------------------------------------------------------------------
+// File: MatrixKernels.inl
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+// No include guard: MatrixKernels.h includes this once per instruction set, inside a namespace that
+// defines Rows, so each copy of these kernels is compiled for that instruction set.
+//
+// Rows::Count rows of m1 are multiplied at a time, with each row of m2 repeated across them. The
+// products are multiplied and summed exactly as the SSE version of XMMatrixMultiply does, so the
+// results match Matrix::operator*.
+
+// m1 * m2 as 4 / Rows::Count vectors. Everything is loaded before anything is stored by the caller.
+inline void MultiplyRows(float const* m1, float const* m2, Rows::Vector* result) noexcept
+{
+    using Vector = Rows::Vector;
+
+    const Vector r0 = Rows::Broadcast(m2);
+    const Vector r1 = Rows::Broadcast(m2 + 4);
+    const Vector r2 = Rows::Broadcast(m2 + 8);
+    const Vector r3 = Rows::Broadcast(m2 + 12);
+
+    for (size_t j = 0; j < 4 / Rows::Count; j++)
+    {
+        const Vector v = Rows::Load(m1 + j * 4 * Rows::Count);
+
+        const Vector x = Rows::Multiply(Rows::Splat<0>(v), r0);
+        const Vector y = Rows::Multiply(Rows::Splat<1>(v), r1);
+        const Vector z = Rows::Multiply(Rows::Splat<2>(v), r2);
+        const Vector w = Rows::Multiply(Rows::Splat<3>(v), r3);
+
+        result[j] = Rows::Add(Rows::Add(x, z), Rows::Add(y, w));
+    }
+}
+
+inline void StoreRows(float* result, Rows::Vector const* rows) noexcept
+{
+    for (size_t j = 0; j < 4 / Rows::Count; j++)
+    {
+        Rows::Store(result + j * 4 * Rows::Count, rows[j]);
+    }
+}
+
+inline void Multiply(float const* m1, float const* m2, size_t count, float* result) noexcept
+{
+    Rows::Vector rows[4 / Rows::Count];
+
+    for (size_t i = 0; i < count; i++)
+    {
+        MultiplyRows(m1 + i * 16, m2 + i * 16, rows);
+        StoreRows(result + i * 16, rows);
+    }
+}
+
+// Transposed, without the last column (XMStoreFloat3x4).
+inline void Multiply3x4(float const* m1, float const* m2, size_t count, float* result) noexcept
+{
+    Rows::Vector rows[4 / Rows::Count];
+
+    for (size_t i = 0; i < count; i++)
+    {
+        MultiplyRows(m1 + i * 16, m2 + i * 16, rows);
+
+        __m128 r0 = Rows::Row(rows, 0);
+        __m128 r1 = Rows::Row(rows, 1);
+        __m128 r2 = Rows::Row(rows, 2);
+        __m128 r3 = Rows::Row(rows, 3);
+
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+        float* p = result + i * 12;
+
+        _mm_storeu_ps(p, r0);
+        _mm_storeu_ps(p + 4, r1);
+        _mm_storeu_ps(p + 8, r2);
+    }
+}
+
+inline void MultiplyHierarchy(float const* local, uint32_t const* parents, size_t count, float const* root, float* result) noexcept
+{
+    Rows::Vector rows[4 / Rows::Count];
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const uint32_t parent = parents[i];
+        assert(parent == NoParent || parent < i);
+
+        float const* m2 = (parent == NoParent) ? root : result + size_t(parent) * 16;
+
+        MultiplyRows(local + i * 16, m2, rows);
+        StoreRows(result + i * 16, rows);
+    }
+}
+
+
+inline Kernels const& GetKernels() noexcept
+{
+    static const Kernels s_kernels =
+    {
+        Multiply,
+        Multiply3x4,
+        MultiplyHierarchy,
+    };
+
+    return s_kernels;
+}
@@ -0,0 +1,150 @@
+//--------------------------------------------------------------------------------------
+// File: PerThreadSegments.h
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace DirectX
+{
+    // Hands each producer thread its own segment to append to, so threads never contend while
+    // recording. Looking up the segment takes a lock only the first time a thread uses it in each
+    // generation; after that a thread-local cache returns it directly. The segments of threads
+    // that used them in the last generation are kept, so their memory is reused from one frame to
+    // the next; the others are freed, so threads that come and go do not pile up segments.
+    template<typename TSegment>
+    class PerThreadSegments
+    {
+    public:
+        PerThreadSegments() :
+            mGeneration(NewGeneration()),
+            mActiveCount(0)
+        {
+        }
+
+        PerThreadSegments(PerThreadSegments const&) = delete;
+        PerThreadSegments& operator= (PerThreadSegments const&) = delete;
+
+        // Returns the calling thread's segment, creating it on first use.
+        TSegment& Get()
+        {
+            auto& cache = ThreadCache();
+
+            if (cache.generation == mGeneration)
+                return *cache.segment;
+
+            std::lock_guard<std::mutex> lock(mMutex);
+
+            const auto thisThread = std::this_thread::get_id();
+
+            auto it = std::find_if(mSegments.begin(), mSegments.end(), [&](Entry const& entry) { return entry.owner == thisThread; });
+
+            if (it == mSegments.end())
+            {
+                mSegments.push_back({ thisThread, std::make_unique<TSegment>(), 0, 0 });
+                it = mSegments.end() - 1;
+            }
+
+            // Remember when this thread first used its segment in the current generation.
+            if (it->generation != mGeneration)
+            {
+                it->generation = mGeneration;
+                it->order = mActiveCount++;
+            }
+
+            cache.generation = mGeneration;
+            cache.segment = it->segment.get();
+
+            return *cache.segment;
+        }
+
+        // Invokes action(segment) for every segment used in the current generation, in the order
+        // threads first asked for them. Must not run concurrently with Get.
+        template<typename TAction>
+        void ForEachActive(TAction&& action)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+
+            mOrdered.clear();
+
+            for (auto& entry : mSegments)
+            {
+                if (entry.generation == mGeneration)
+                {
+                    mOrdered.push_back(&entry);
+                }
+            }
+
+            std::sort(mOrdered.begin(), mOrdered.end(), [](Entry const* a, Entry const* b) { return a->order < b->order; });
+
+            for (auto entry : mOrdered)
+            {
+                action(*entry->segment);
+            }
+        }
+
+        // Starts a new generation, so every thread looks its segment up again, and frees the
+        // segments nobody used in the generation just ending. Their threads' caches hold an older
+        // generation, so cannot match again. Must not run concurrently with Get.
+        void NextGeneration() noexcept
+        {
+            mSegments.erase(std::remove_if(mSegments.begin(), mSegments.end(), [&](Entry const& entry) { return entry.generation != mGeneration; }),
+                mSegments.end());
+
+            mGeneration = NewGeneration();
+            mActiveCount = 0;
+        }
+
+    private:
+        struct Entry
+        {
+            std::thread::id owner;
+            std::unique_ptr<TSegment> segment;
+            uint64_t generation;
+            size_t order;
+        };
+
+        struct Cache
+        {
+            uint64_t generation;
+            TSegment* segment;
+        };
+
+        // Generations are unique across every instance, so a cache entry left behind by another
+        // instance (or a destroyed one at the same address) can never match.
+        static uint64_t NewGeneration() noexcept
+        {
+            static std::atomic<uint64_t> s_nextGeneration(1);
+
+            return s_nextGeneration.fetch_add(1);
+        }
+
+        static Cache& ThreadCache() noexcept
+        {
+            static thread_local Cache t_cache = {};
+
+            return t_cache;
+        }
+
+        std::mutex mMutex;
+        std::vector<Entry> mSegments;
+        std::vector<Entry*> mOrdered;
+
+        uint64_t mGeneration;
+        size_t mActiveCount;
+    };
+}
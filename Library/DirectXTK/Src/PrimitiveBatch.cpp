@@ -9,6 +9,7 @@
 
 #include "pch.h"
 #include "PrimitiveBatch.h"
+#include "AdaptiveRing.h"
 #include "DirectXHelpers.h"
 #include "GraphicsMemory.h"
 #include "PlatformHelpers.h"
@@ -27,11 +28,19 @@ public:
     void Begin();
     void End();
 
-    void Draw(D3D11_PRIMITIVE_TOPOLOGY topology, bool isIndexed, _In_opt_count_(indexCount) uint16_t const* indices, size_t indexCount, size_t vertexCount, _Out_ void** pMappedVertices);
+    template<typename TIndex>
+    void Draw(D3D11_PRIMITIVE_TOPOLOGY topology, bool isIndexed, _In_opt_count_(indexCount) TIndex const* indices, size_t indexCount, size_t vertexCount, _Out_ void** pMappedVertices);
 
 private:
     void FlushBatch();
 
+#if !defined(_XBOX_ONE) || !defined(_TITLE)
+    void CreateBuffers();
+    void EndRingInterval();
+#endif
+
+    size_t IndexSize() const noexcept { return (mIndexFormat == DXGI_FORMAT_R32_UINT) ? sizeof(uint32_t) : sizeof(uint16_t); }
+
 #if defined(_XBOX_ONE) && defined(_TITLE)
     ComPtr<ID3D11DeviceContextX> mDeviceContext;
 #else
@@ -44,6 +53,17 @@ private:
     size_t mMaxVertices;
     size_t mVertexSize;
 
+    // The buffers are used as rings, sized from the demand seen between Begin and End. The
+    // per-draw limits stay at mMaxIndices and mMaxVertices as the buffers grow.
+    AdaptiveRingSizer mIndexRing;
+    AdaptiveRingSizer mVertexRing;
+    DXGI_FORMAT mIndexFormat;
+
+    size_t mIntervalIndices;
+    size_t mIntervalVertices;
+    size_t mIndexWraps;
+    size_t mVertexWraps;
+
     D3D11_PRIMITIVE_TOPOLOGY mCurrentTopology;
     bool mInBeginEndPair;
     bool mCurrentlyIndexed;
@@ -103,6 +123,26 @@ namespace
         SetDebugObjectName(*pBuffer, "DirectXTK:PrimitiveBatch");
     }
 #endif
+
+    // The most bytes a single D3D11 buffer may hold.
+    constexpr uint64_t MaxBufferBytes = uint64_t(D3D11_REQ_RESOURCE_SIZE_IN_MEGABYTES_EXPRESSION_A_TERM) * 1024u * 1024u;
+
+    // How far the rings may grow beyond the sizes passed to the constructor.
+    constexpr size_t MaxRingGrowth = 16;
+
+    // Largest ring capacity for elements of the given size, starting from minCapacity.
+    size_t MaxRingCapacity(size_t minCapacity, size_t elementSize) noexcept
+    {
+        const uint64_t limit = std::min<uint64_t>(MaxBufferBytes, UINT32_MAX) / elementSize;
+
+        return static_cast<size_t>(std::min<uint64_t>(uint64_t(minCapacity) * MaxRingGrowth, limit));
+    }
+
+    // Vertices beyond the reach of 16-bit indices need a 32-bit index buffer.
+    DXGI_FORMAT IndexFormatFor(size_t vertexCapacity) noexcept
+    {
+        return (vertexCapacity > 65536) ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT;
+    }
 }
 
 
@@ -111,6 +151,13 @@ PrimitiveBatchBase::Impl::Impl(_In_ ID3D11DeviceContext* deviceContext, size_t m
     : mMaxIndices(maxIndices),
     mMaxVertices(maxVertices),
     mVertexSize(vertexSize),
+    mIndexRing(maxIndices, MaxRingCapacity(maxIndices, sizeof(uint32_t))),
+    mVertexRing(maxVertices, MaxRingCapacity(maxVertices, std::max<size_t>(vertexSize, 1))),
+    mIndexFormat(IndexFormatFor(maxVertices)),
+    mIntervalIndices(0),
+    mIntervalVertices(0),
+    mIndexWraps(0),
+    mVertexWraps(0),
     mCurrentTopology(D3D11_PRIMITIVE_TOPOLOGY_UNDEFINED),
     mInBeginEndPair(false),
     mCurrentlyIndexed(false),
@@ -137,7 +184,7 @@ mMappedVertices{}
     if (vertexSize > D3D11_REQ_MULTI_ELEMENT_STRUCTURE_SIZE_IN_BYTES)
         throw std::invalid_argument("Vertex size is too large for DirectX 11");
 
-    const uint64_t ibBytes = uint64_t(maxIndices) * sizeof(uint16_t);
+    const uint64_t ibBytes = uint64_t(maxIndices) * IndexSize();
     if (ibBytes > uint64_t(D3D11_REQ_RESOURCE_SIZE_IN_MEGABYTES_EXPRESSION_A_TERM * 1024u * 1024u)
         || ibBytes > UINT32_MAX)
         throw std::invalid_argument("IB too large for DirectX 11");
@@ -166,18 +213,64 @@ mMappedVertices{}
 #else
     mDeviceContext = deviceContext;
 
+    CreateBuffers();
+#endif
+}
+
+
+#if !defined(_XBOX_ONE) || !defined(_TITLE)
+// Creates the vertex and index buffers at the current ring capacities.
+void PrimitiveBatchBase::Impl::CreateBuffers()
+{
+    ComPtr<ID3D11Device> device;
+    mDeviceContext->GetDevice(&device);
+
+    mIndexFormat = IndexFormatFor(mVertexRing.GetCapacity());
+
     // If you only intend to draw non-indexed geometry, specify maxIndices = 0 to skip creating the index buffer.
-    if (maxIndices > 0)
+    if (mMaxIndices > 0)
     {
+        const size_t ibBytes = mIndexRing.GetCapacity() * IndexSize();
+
+        mIndexBuffer.Reset();
         CreateDynamicBuffer(device.Get(), static_cast<uint32_t>(ibBytes), D3D11_BIND_INDEX_BUFFER, &mIndexBuffer);
     }
 
     // Create the vertex buffer.
+    const size_t vbBytes = mVertexRing.GetCapacity() * mVertexSize;
+
+    mVertexBuffer.Reset();
     CreateDynamicBuffer(device.Get(), static_cast<uint32_t>(vbBytes), D3D11_BIND_VERTEX_BUFFER, &mVertexBuffer);
-#endif
+
+    // The new buffers start out empty, so the next Map calls must discard.
+    mCurrentIndex = 0;
+    mCurrentVertex = 0;
 }
 
 
+// Reports the demand seen since Begin to the ring sizers, recreating the buffers if either picks a new capacity.
+void PrimitiveBatchBase::Impl::EndRingInterval()
+{
+    bool resized = mVertexRing.EndInterval(mIntervalVertices, mVertexWraps);
+
+    if (mMaxIndices > 0)
+    {
+        resized |= mIndexRing.EndInterval(mIntervalIndices, mIndexWraps);
+    }
+
+    if (resized)
+    {
+        CreateBuffers();
+    }
+
+    mIntervalIndices = 0;
+    mIntervalVertices = 0;
+    mIndexWraps = 0;
+    mVertexWraps = 0;
+}
+#endif
+
+
 // Begins a batch of primitive drawing operations.
 void PrimitiveBatchBase::Impl::Begin()
 {
@@ -190,7 +283,7 @@ void PrimitiveBatchBase::Impl::Begin()
     // Bind the index buffer.
     if (mMaxIndices > 0)
     {
-        mDeviceContext->IASetIndexBuffer(mIndexBuffer.Get(), DXGI_FORMAT_R16_UINT, 0);
+        mDeviceContext->IASetIndexBuffer(mIndexBuffer.Get(), mIndexFormat, 0);
     }
 
     // Bind the vertex buffer.
@@ -220,6 +313,10 @@ void PrimitiveBatchBase::Impl::End()
 
     FlushBatch();
 
+#if !defined(_XBOX_ONE) || !defined(_TITLE)
+    EndRingInterval();
+#endif
+
     mInBeginEndPair = false;
 }
 
@@ -260,12 +357,37 @@ namespace
         *basePosition = currentPosition;
     }
 #endif
+
+    // Copies indices into a mapped index buffer of the given format, offsetting them by baseIndex.
+    template<typename TIndex>
+    void CopyIndices(_Out_ void* destination, DXGI_FORMAT format, _In_reads_(indexCount) TIndex const* indices, size_t indexCount, size_t baseIndex) noexcept
+    {
+        if (format == DXGI_FORMAT_R32_UINT)
+        {
+            auto outputIndices = static_cast<uint32_t*>(destination);
+
+            for (size_t i = 0; i < indexCount; i++)
+            {
+                outputIndices[i] = static_cast<uint32_t>(indices[i] + baseIndex);
+            }
+        }
+        else
+        {
+            auto outputIndices = static_cast<uint16_t*>(destination);
+
+            for (size_t i = 0; i < indexCount; i++)
+            {
+                outputIndices[i] = static_cast<uint16_t>(indices[i] + baseIndex);
+            }
+        }
+    }
 }
 
 
 // Adds new geometry to the batch.
+template<typename TIndex>
 _Use_decl_annotations_
-void PrimitiveBatchBase::Impl::Draw(D3D11_PRIMITIVE_TOPOLOGY topology, bool isIndexed, uint16_t const* indices, size_t indexCount, size_t vertexCount, void** pMappedVertices)
+void PrimitiveBatchBase::Impl::Draw(D3D11_PRIMITIVE_TOPOLOGY topology, bool isIndexed, TIndex const* indices, size_t indexCount, size_t vertexCount, void** pMappedVertices)
 {
     if (isIndexed && !indices)
         throw std::invalid_argument("Indices cannot be null");
@@ -280,8 +402,8 @@ void PrimitiveBatchBase::Impl::Draw(D3D11_PRIMITIVE_TOPOLOGY topology, bool isIn
         throw std::logic_error("Begin must be called before Draw");
 
     // Can we merge this primitive in with an existing batch, or must we flush first?
-    const bool wrapIndexBuffer = (mCurrentIndex + indexCount > mMaxIndices);
-    const bool wrapVertexBuffer = (mCurrentVertex + vertexCount > mMaxVertices);
+    const bool wrapIndexBuffer = (mCurrentIndex + indexCount > mIndexRing.GetCapacity());
+    const bool wrapVertexBuffer = (mCurrentVertex + vertexCount > mVertexRing.GetCapacity());
 
     if ((topology != mCurrentTopology) ||
         (isIndexed != mCurrentlyIndexed) ||
@@ -298,7 +420,7 @@ void PrimitiveBatchBase::Impl::Draw(D3D11_PRIMITIVE_TOPOLOGY topology, bool isIn
 
         if (isIndexed)
         {
-            grfxMemoryIB = grfxMem.Allocate(mDeviceContext.Get(), mMaxIndices * sizeof(uint16_t), 64);
+            grfxMemoryIB = grfxMem.Allocate(mDeviceContext.Get(), mMaxIndices * IndexSize(), 64);
         }
 
         grfxMemoryVB = grfxMem.Allocate(mDeviceContext.Get(), mMaxVertices * mVertexSize, 64);
@@ -312,12 +434,9 @@ void PrimitiveBatchBase::Impl::Draw(D3D11_PRIMITIVE_TOPOLOGY topology, bool isIn
     if (isIndexed)
     {
         assert(grfxMemoryIB != nullptr);
-        auto outputIndices = reinterpret_cast<uint16_t*>(grfxMemoryIB) + mCurrentIndex;
+        auto outputIndices = static_cast<uint8_t*>(grfxMemoryIB) + mCurrentIndex * IndexSize();
 
-        for (size_t i = 0; i < indexCount; i++)
-        {
-            outputIndices[i] = (uint16_t)(indices[i] + mCurrentVertex);
-        }
+        CopyIndices(outputIndices, mIndexFormat, indices, indexCount, mCurrentVertex);
 
         mCurrentIndex += indexCount;
     }
@@ -328,11 +447,22 @@ void PrimitiveBatchBase::Impl::Draw(D3D11_PRIMITIVE_TOPOLOGY topology, bool isIn
 
     mCurrentVertex += vertexCount;
 #else
+    // Each wrap makes the next Map discard, which the ring sizers use to decide whether to grow.
     if (wrapIndexBuffer)
+    {
+        if (mCurrentIndex > 0)
+            mIndexWraps++;
+
         mCurrentIndex = 0;
+    }
 
     if (wrapVertexBuffer)
+    {
+        if (mCurrentVertex > 0)
+            mVertexWraps++;
+
         mCurrentVertex = 0;
+    }
 
     // If we are not already in a batch, lock the buffers.
     if (mCurrentTopology == D3D11_PRIMITIVE_TOPOLOGY_UNDEFINED)
@@ -351,20 +481,19 @@ void PrimitiveBatchBase::Impl::Draw(D3D11_PRIMITIVE_TOPOLOGY topology, bool isIn
     // Copy over the index data.
     if (isIndexed)
     {
-        auto outputIndices = static_cast<uint16_t*>(mMappedIndices.pData) + mCurrentIndex;
+        auto outputIndices = static_cast<uint8_t*>(mMappedIndices.pData) + mCurrentIndex * IndexSize();
 
-        for (size_t i = 0; i < indexCount; i++)
-        {
-            outputIndices[i] = static_cast<uint16_t>(indices[i] + mCurrentVertex - mBaseVertex);
-        }
+        CopyIndices(outputIndices, mIndexFormat, indices, indexCount, mCurrentVertex - mBaseVertex);
 
         mCurrentIndex += indexCount;
+        mIntervalIndices += indexCount;
     }
 
     // Return the output vertex data location.
     *pMappedVertices = static_cast<uint8_t*>(mMappedVertices.pData) + (mCurrentVertex * mVertexSize);
 
     mCurrentVertex += vertexCount;
+    mIntervalVertices += vertexCount;
 #endif
 }
 
@@ -382,7 +511,7 @@ void PrimitiveBatchBase::Impl::FlushBatch()
     if (mCurrentlyIndexed)
     {
         // Draw indexed geometry.
-        mDeviceContext->IASetPlacementIndexBuffer(mIndexBuffer.Get(), grfxMemoryIB, DXGI_FORMAT_R16_UINT);
+        mDeviceContext->IASetPlacementIndexBuffer(mIndexBuffer.Get(), grfxMemoryIB, mIndexFormat);
         mDeviceContext->IASetPlacementVertexBuffer(0, mVertexBuffer.Get(), grfxMemoryVB, (UINT)mVertexSize);
 
         mDeviceContext->DrawIndexed((UINT)mCurrentIndex, 0, 0);
@@ -452,3 +581,11 @@ void PrimitiveBatchBase::Draw(D3D11_PRIMITIVE_TOPOLOGY topology, bool isIndexed,
 {
     pImpl->Draw(topology, isIndexed, indices, indexCount, vertexCount, pMappedVertices);
 }
+
+
+// Custom draw method taking 32-bit indices.
+_Use_decl_annotations_
+void PrimitiveBatchBase::Draw32(D3D11_PRIMITIVE_TOPOLOGY topology, bool isIndexed, uint32_t const* indices, size_t indexCount, size_t vertexCount, void** pMappedVertices)
+{
+    pImpl->Draw(topology, isIndexed, indices, indexCount, vertexCount, pMappedVertices);
+}
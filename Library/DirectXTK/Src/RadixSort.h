@@ -0,0 +1,142 @@
+//--------------------------------------------------------------------------------------
+// File: RadixSort.h
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+
+namespace DirectX
+{
+    namespace RadixSort
+    {
+        // A sort key paired with the position of the item it was extracted from.
+        template<typename TKey>
+        struct KeyIndex
+        {
+            TKey key;
+            uint32_t index;
+        };
+
+
+        // Maps a float onto an unsigned integer that sorts in the same order.
+        // Negative values have all bits flipped, positive values just the sign bit.
+        // Negative zero is folded onto positive zero, since the two compare equal.
+        inline uint32_t FloatToSortableKey(float value) noexcept
+        {
+            uint32_t bits;
+            memcpy(&bits, &value, sizeof(bits));
+
+            if (bits == 0x80000000u)
+                bits = 0;
+
+            const uint32_t mask = static_cast<uint32_t>(-static_cast<int32_t>(bits >> 31)) | 0x80000000u;
+
+            return bits ^ mask;
+        }
+
+
+        // Stable least-significant-digit radix sort on 8-bit digits. Only the lowest keyBytes
+        // bytes of each key are considered, and any pass where every key shares the same digit
+        // is skipped. Returns whichever of items or scratch holds the sorted output.
+        template<typename TKey>
+        KeyIndex<TKey>* Sort(
+            _Inout_updates_(count) KeyIndex<TKey>* items,
+            _Out_writes_(count) KeyIndex<TKey>* scratch,
+            size_t count,
+            size_t keyBytes = sizeof(TKey)) noexcept
+        {
+            constexpr size_t RadixBits = 8;
+            constexpr size_t RadixSize = size_t(1) << RadixBits;
+            constexpr size_t SmallSortSize = 64;
+
+            assert(keyBytes <= sizeof(TKey));
+
+            // Tiny inputs are cheaper to insertion sort than to histogram.
+            if (count <= SmallSortSize)
+            {
+                const TKey keyMask = (keyBytes < sizeof(TKey))
+                    ? static_cast<TKey>((TKey(1) << (keyBytes * RadixBits)) - 1)
+                    : static_cast<TKey>(~TKey(0));
+
+                for (size_t i = 1; i < count; i++)
+                {
+                    const KeyIndex<TKey> item = items[i];
+                    const TKey itemKey = item.key & keyMask;
+
+                    size_t j = i;
+
+                    while (j > 0 && (items[j - 1].key & keyMask) > itemKey)
+                    {
+                        items[j] = items[j - 1];
+                        j--;
+                    }
+
+                    items[j] = item;
+                }
+
+                return items;
+            }
+
+            // Build the histograms for every digit in a single pass over the keys.
+            size_t histograms[sizeof(TKey)][RadixSize] = {};
+
+            for (size_t i = 0; i < count; i++)
+            {
+                TKey key = items[i].key;
+
+                for (size_t digit = 0; digit < keyBytes; digit++)
+                {
+                    histograms[digit][key & (RadixSize - 1)]++;
+                    key = static_cast<TKey>(key >> RadixBits);
+                }
+            }
+
+            KeyIndex<TKey>* source = items;
+            KeyIndex<TKey>* dest = scratch;
+
+            for (size_t digit = 0; digit < keyBytes; digit++)
+            {
+                size_t* histogram = histograms[digit];
+
+                // If every key has the same value for this digit, the pass would not change anything.
+                const size_t shift = digit * RadixBits;
+
+                if (histogram[(source[0].key >> shift) & (RadixSize - 1)] == count)
+                    continue;
+
+                // Convert counts to output offsets.
+                size_t offset = 0;
+
+                for (size_t bucket = 0; bucket < RadixSize; bucket++)
+                {
+                    const size_t bucketCount = histogram[bucket];
+                    histogram[bucket] = offset;
+                    offset += bucketCount;
+                }
+
+                // Scatter in input order, which is what keeps the sort stable.
+                for (size_t i = 0; i < count; i++)
+                {
+                    const size_t bucket = (source[i].key >> shift) & (RadixSize - 1);
+
+                    dest[histogram[bucket]++] = source[i];
+                }
+
+                std::swap(source, dest);
+            }
+
+            return source;
+        }
+    }
+}
@@ -221,6 +221,9 @@ call :CompileShaderSM4%1 DebugEffect ps PSRGBBiTangents
 
 call :CompileShader%1 SpriteEffect vs SpriteVertexShader
 call :CompileShader%1 SpriteEffect ps SpritePixelShader
+call :CompileShaderSM4%1 SpriteEffect vs SpriteVertexShaderMultiTexture
+call :CompileShaderSM4%1 SpriteEffect ps SpritePixelShaderMultiTexture
+call :CompileShaderSM4%1 SpriteEffect vs SpriteVertexShaderInstanced
 
 call :CompileShader%1 DGSLEffect vs main
 call :CompileShader%1 DGSLEffect vs mainVc
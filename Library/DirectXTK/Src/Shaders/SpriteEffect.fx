@@ -27,3 +27,71 @@ float4 SpritePixelShader(float4 color    : COLOR0,
 {
     return Texture.Sample(TextureSampler, texCoord) * color;
 }
+
+
+// Variant that lets each draw sample from several textures, bound to consecutive slots.
+// The slot is carried per vertex, and is the same for all four vertices of a sprite.
+#define MaxTextures 8
+
+Texture2D<float4> Textures[MaxTextures] : register(t0);
+
+
+void SpriteVertexShaderMultiTexture(inout float4 color    : COLOR0,
+    inout float2 texCoord : TEXCOORD0,
+    uint textureIndexIn   : TEXINDEX,
+    out nointerpolation uint textureIndex : TEXINDEX0,
+    inout float4 position : SV_Position)
+{
+    textureIndex = textureIndexIn;
+    position = mul(position, MatrixTransform);
+}
+
+
+float4 SpritePixelShaderMultiTexture(float4 color    : COLOR0,
+    float2 texCoord : TEXCOORD0,
+    nointerpolation uint textureIndex : TEXINDEX0) : SV_Target0
+{
+    // Gradients are computed outside the branch, as they are undefined in divergent flow control.
+    const float2 dx = ddx(texCoord);
+    const float2 dy = ddy(texCoord);
+
+    float4 texel;
+
+    [branch] switch (textureIndex)
+    {
+        case 0:  texel = Textures[0].SampleGrad(TextureSampler, texCoord, dx, dy); break;
+        case 1:  texel = Textures[1].SampleGrad(TextureSampler, texCoord, dx, dy); break;
+        case 2:  texel = Textures[2].SampleGrad(TextureSampler, texCoord, dx, dy); break;
+        case 3:  texel = Textures[3].SampleGrad(TextureSampler, texCoord, dx, dy); break;
+        case 4:  texel = Textures[4].SampleGrad(TextureSampler, texCoord, dx, dy); break;
+        case 5:  texel = Textures[5].SampleGrad(TextureSampler, texCoord, dx, dy); break;
+        case 6:  texel = Textures[6].SampleGrad(TextureSampler, texCoord, dx, dy); break;
+        default: texel = Textures[7].SampleGrad(TextureSampler, texCoord, dx, dy); break;
+    }
+
+    return texel * color;
+}
+
+
+// Variant that reads one instance per sprite and expands it into the four corners, which are
+// numbered in triangle strip order: top left, top right, bottom left, bottom right. Outputs
+// match SpriteVertexShaderMultiTexture, so it is paired with SpritePixelShaderMultiTexture.
+void SpriteVertexShaderInstanced(uint vertexId : SV_VertexID,
+    float4 positionAxisX  : SPRITE0,
+    float4 axisYDepthSlot : SPRITE1,
+    float4 texCoordRect   : SPRITE2,
+    float4 colorIn        : COLOR0,
+    out float4 color      : COLOR0,
+    out float2 texCoord   : TEXCOORD0,
+    out nointerpolation uint textureIndex : TEXINDEX0,
+    out float4 position   : SV_Position)
+{
+    const float2 corner = float2(vertexId & 1, vertexId >> 1);
+
+    position = float4(positionAxisX.xy + corner.x * positionAxisX.zw + corner.y * axisYDepthSlot.xy, axisYDepthSlot.z, 1);
+    position = mul(position, MatrixTransform);
+
+    texCoord = texCoordRect.xy + corner * texCoordRect.zw;
+    color = colorIn;
+    textureIndex = (uint)axisYDepthSlot.w;
+}
@@ -10,6 +10,11 @@
 
 #include "pch.h"
 #include "SimpleMath.h"
+#include "ColorKernels.h"
+#include "HalfKernels.h"
+#include "MatrixKernels.h"
+#include "VectorStream.h"
+#include "WorkerPool.h"
 
 /****************************************************************************
  *
@@ -57,6 +62,409 @@ namespace DirectX
 using namespace DirectX;
 using namespace DirectX::SimpleMath;
 
+/****************************************************************************
+ *
+ * Vector streams
+ *
+ ****************************************************************************/
+
+using VectorStream::GetStreamKernels;
+
+void Vector2::Transform(const ConstVector2Stream& v, size_t count, const Matrix& m, const Vector2Stream& result) noexcept
+{
+    GetStreamKernels().transformCoord2({ { v.x, v.y } }, count, m, { { result.x, result.y } });
+}
+
+void Vector2::TransformNormal(const ConstVector2Stream& v, size_t count, const Matrix& m, const Vector2Stream& result) noexcept
+{
+    GetStreamKernels().transformNormal2({ { v.x, v.y } }, count, m, { { result.x, result.y } });
+}
+
+void Vector2::Normalize(const ConstVector2Stream& v, size_t count, const Vector2Stream& result) noexcept
+{
+    GetStreamKernels().normalize2({ { v.x, v.y } }, count, { { result.x, result.y } });
+}
+
+void Vector2::Dot(const ConstVector2Stream& v1, const ConstVector2Stream& v2, size_t count, float* result) noexcept
+{
+    GetStreamKernels().dot2({ { v1.x, v1.y } }, { { v2.x, v2.y } }, count, result);
+}
+
+void Vector3::Transform(const ConstVector3Stream& v, size_t count, const Matrix& m, const Vector3Stream& result) noexcept
+{
+    GetStreamKernels().transformCoord3({ { v.x, v.y, v.z } }, count, m, { { result.x, result.y, result.z } });
+}
+
+void Vector3::TransformNormal(const ConstVector3Stream& v, size_t count, const Matrix& m, const Vector3Stream& result) noexcept
+{
+    GetStreamKernels().transformNormal3({ { v.x, v.y, v.z } }, count, m, { { result.x, result.y, result.z } });
+}
+
+void Vector3::Normalize(const ConstVector3Stream& v, size_t count, const Vector3Stream& result) noexcept
+{
+    GetStreamKernels().normalize3({ { v.x, v.y, v.z } }, count, { { result.x, result.y, result.z } });
+}
+
+void Vector3::Dot(const ConstVector3Stream& v1, const ConstVector3Stream& v2, size_t count, float* result) noexcept
+{
+    GetStreamKernels().dot3({ { v1.x, v1.y, v1.z } }, { { v2.x, v2.y, v2.z } }, count, result);
+}
+
+void Vector4::Transform(const ConstVector4Stream& v, size_t count, const Matrix& m, const Vector4Stream& result) noexcept
+{
+    GetStreamKernels().transform4({ { v.x, v.y, v.z, v.w } }, count, m, { { result.x, result.y, result.z, result.w } });
+}
+
+void Vector4::Normalize(const ConstVector4Stream& v, size_t count, const Vector4Stream& result) noexcept
+{
+    GetStreamKernels().normalize4({ { v.x, v.y, v.z, v.w } }, count, { { result.x, result.y, result.z, result.w } });
+}
+
+void Vector4::Dot(const ConstVector4Stream& v1, const ConstVector4Stream& v2, size_t count, float* result) noexcept
+{
+    GetStreamKernels().dot4({ { v1.x, v1.y, v1.z, v1.w } }, { { v2.x, v2.y, v2.z, v2.w } }, count, result);
+}
+
+void Quaternion::Lerp(const ConstVector4Stream& q1, const ConstVector4Stream& q2, size_t count, float t, const Vector4Stream& result) noexcept
+{
+    GetStreamKernels().quaternionLerp({ { q1.x, q1.y, q1.z, q1.w } }, { { q2.x, q2.y, q2.z, q2.w } }, count, t, { { result.x, result.y, result.z, result.w } });
+}
+
+void Quaternion::Slerp(const ConstVector4Stream& q1, const ConstVector4Stream& q2, size_t count, float t, const Vector4Stream& result) noexcept
+{
+    GetStreamKernels().quaternionSlerp({ { q1.x, q1.y, q1.z, q1.w } }, { { q2.x, q2.y, q2.z, q2.w } }, count, t, { { result.x, result.y, result.z, result.w } });
+}
+
+void Quaternion::FastSlerp(const ConstVector4Stream& q1, const ConstVector4Stream& q2, size_t count, float t, const Vector4Stream& result) noexcept
+{
+    GetStreamKernels().quaternionFastSlerp({ { q1.x, q1.y, q1.z, q1.w } }, { { q2.x, q2.y, q2.z, q2.w } }, count, t, { { result.x, result.y, result.z, result.w } });
+}
+
+// The poses are passed straight through, rather than copied, so the two layouts must agree.
+static_assert(sizeof(ConstVector4Stream) == sizeof(VectorStream::StreamInput), "Layout mismatch");
+static_assert(offsetof(ConstVector4Stream, w) == offsetof(VectorStream::StreamInput, c[3]), "Layout mismatch");
+
+void Quaternion::Blend(const ConstVector4Stream* poses, const float* weights, size_t poseCount, size_t count, const Vector4Stream& result) noexcept
+{
+    GetStreamKernels().quaternionBlend(reinterpret_cast<VectorStream::StreamInput const*>(poses), weights, poseCount, count, { { result.x, result.y, result.z, result.w } });
+}
+
+
+/****************************************************************************
+ *
+ * Matrix arrays
+ *
+ ****************************************************************************/
+
+static_assert(sizeof(Matrix) == 16 * sizeof(float), "Matrix arrays are multiplied as packed floats");
+
+using MatrixKernels::GetMatrixKernels;
+
+void Matrix::Multiply(const Matrix* M1, const Matrix* M2, size_t count, Matrix* result) noexcept
+{
+    GetMatrixKernels().multiply(&M1->_11, &M2->_11, count, &result->_11);
+}
+
+#if DIRECTX_MATH_VERSION >= 313
+void Matrix::MultiplyAffine(const Matrix* M1, const Matrix* M2, size_t count, XMFLOAT3X4* result) noexcept
+{
+    GetMatrixKernels().multiply3x4(&M1->_11, &M2->_11, count, &result->_11);
+}
+#endif
+
+void Matrix::MultiplyHierarchy(const Matrix* local, const uint32_t* parents, size_t count, const Matrix& root, Matrix* result) noexcept
+{
+    GetMatrixKernels().multiplyHierarchy(&local->_11, parents, count, &root._11, &result->_11);
+}
+
+
+/****************************************************************************
+ *
+ * Compact storage
+ *
+ ****************************************************************************/
+
+// Half vector arrays are converted as packed components.
+static_assert(sizeof(HalfVector2) == 2 * sizeof(PackedVector::HALF) && sizeof(Vector2) == 2 * sizeof(float), "Layout mismatch");
+static_assert(sizeof(HalfVector3) == 3 * sizeof(PackedVector::HALF) && sizeof(Vector3) == 3 * sizeof(float), "Layout mismatch");
+static_assert(sizeof(HalfVector4) == 4 * sizeof(PackedVector::HALF) && sizeof(Vector4) == 4 * sizeof(float), "Layout mismatch");
+
+static_assert(sizeof(PackedNormal) == 4, "PackedNormal should be 4 bytes");
+static_assert(sizeof(PackedQuaternion) == 6, "PackedQuaternion should be 6 bytes");
+static_assert(sizeof(AffineMatrix) == 12 * sizeof(float), "AffineMatrix should be 48 bytes");
+
+using HalfKernels::GetHalfKernels;
+
+void HalfVector2::Pack(const Vector2* varray, size_t count, HalfVector2* resultArray) noexcept
+{
+    GetHalfKernels().floatToHalf(&varray->x, count * 2, &resultArray->x);
+}
+
+void HalfVector2::Unpack(const HalfVector2* varray, size_t count, Vector2* resultArray) noexcept
+{
+    GetHalfKernels().halfToFloat(&varray->x, count * 2, &resultArray->x);
+}
+
+void HalfVector3::Pack(const Vector3* varray, size_t count, HalfVector3* resultArray) noexcept
+{
+    GetHalfKernels().floatToHalf(&varray->x, count * 3, &resultArray->x);
+}
+
+void HalfVector3::Unpack(const HalfVector3* varray, size_t count, Vector3* resultArray) noexcept
+{
+    GetHalfKernels().halfToFloat(&varray->x, count * 3, &resultArray->x);
+}
+
+void HalfVector4::Pack(const Vector4* varray, size_t count, HalfVector4* resultArray) noexcept
+{
+    GetHalfKernels().floatToHalf(&varray->x, count * 4, &resultArray->x);
+}
+
+void HalfVector4::Unpack(const HalfVector4* varray, size_t count, Vector4* resultArray) noexcept
+{
+    GetHalfKernels().halfToFloat(&varray->x, count * 4, &resultArray->x);
+}
+
+void PackedNormal::Pack(const Vector3* varray, size_t count, PackedNormal* resultArray) noexcept
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        resultArray[i] = PackedNormal(XMLoadFloat3(&varray[i]));
+    }
+}
+
+void PackedNormal::Unpack(const PackedNormal* varray, size_t count, Vector3* resultArray) noexcept
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        resultArray[i] = varray[i];
+    }
+}
+
+void PackedQuaternion::Pack(const Quaternion* qarray, size_t count, PackedQuaternion* resultArray) noexcept
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        resultArray[i] = PackedQuaternion(XMLoadFloat4(&qarray[i]));
+    }
+}
+
+void PackedQuaternion::Unpack(const PackedQuaternion* qarray, size_t count, Quaternion* resultArray) noexcept
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        resultArray[i] = qarray[i];
+    }
+}
+
+void AffineMatrix::Pack(const Matrix* marray, size_t count, AffineMatrix* resultArray) noexcept
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        XMStoreFloat4x3(&resultArray[i], XMLoadFloat4x4(&marray[i]));
+    }
+}
+
+void AffineMatrix::Unpack(const AffineMatrix* marray, size_t count, Matrix* resultArray) noexcept
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        XMStoreFloat4x4(&resultArray[i], XMLoadFloat4x3(&marray[i]));
+    }
+}
+
+
+/****************************************************************************
+ *
+ * FrustumCuller
+ *
+ ****************************************************************************/
+
+namespace
+{
+    // Arrays of bounding volumes are copied to the stack this many at a time, then culled as
+    // structure-of-arrays streams. A multiple of 32, so each chunk fills whole words of the mask.
+    constexpr size_t CullChunkSize = 256;
+
+    // Parallel culling hands out at least this many words of the mask (32 volumes each) at a time.
+    constexpr size_t ParallelCullWords = 1024;
+
+    VectorStream::CullPlanes GetCullPlanes(_In_reads_(6) const Plane* planes) noexcept
+    {
+        VectorStream::CullPlanes result;
+
+        for (size_t p = 0; p < 6; p++)
+        {
+            result.x[p] = planes[p].x;
+            result.y[p] = planes[p].y;
+            result.z[p] = planes[p].z;
+            result.d[p] = planes[p].w;
+            result.absX[p] = fabsf(planes[p].x);
+            result.absY[p] = fabsf(planes[p].y);
+            result.absZ[p] = fabsf(planes[p].z);
+        }
+
+        return result;
+    }
+
+    void CullSphereRange(VectorStream::CullPlanes const& planes, _In_reads_(count) const BoundingSphere* spheres, size_t count, _Out_writes_((count + 31) / 32) uint32_t* visible) noexcept
+    {
+        float x[CullChunkSize];
+        float y[CullChunkSize];
+        float z[CullChunkSize];
+        float radius[CullChunkSize];
+
+        for (size_t base = 0; base < count; base += CullChunkSize)
+        {
+            const size_t chunk = std::min(CullChunkSize, count - base);
+
+            for (size_t i = 0; i < chunk; i++)
+            {
+                auto const& sphere = spheres[base + i];
+
+                x[i] = sphere.Center.x;
+                y[i] = sphere.Center.y;
+                z[i] = sphere.Center.z;
+                radius[i] = sphere.Radius;
+            }
+
+            GetStreamKernels().cullSpheres(planes, { { x, y, z } }, radius, chunk, visible + base / 32);
+        }
+    }
+
+    void CullBoxRange(VectorStream::CullPlanes const& planes, _In_reads_(count) const BoundingBox* boxes, size_t count, _Out_writes_((count + 31) / 32) uint32_t* visible) noexcept
+    {
+        float x[CullChunkSize];
+        float y[CullChunkSize];
+        float z[CullChunkSize];
+        float ex[CullChunkSize];
+        float ey[CullChunkSize];
+        float ez[CullChunkSize];
+
+        for (size_t base = 0; base < count; base += CullChunkSize)
+        {
+            const size_t chunk = std::min(CullChunkSize, count - base);
+
+            for (size_t i = 0; i < chunk; i++)
+            {
+                auto const& box = boxes[base + i];
+
+                x[i] = box.Center.x;
+                y[i] = box.Center.y;
+                z[i] = box.Center.z;
+                ex[i] = box.Extents.x;
+                ey[i] = box.Extents.y;
+                ez[i] = box.Extents.z;
+            }
+
+            GetStreamKernels().cullBoxes(planes, { { x, y, z } }, { { ex, ey, ez } }, chunk, visible + base / 32);
+        }
+    }
+
+    // Splits culling count volumes into ranges that start on whole words of the visibility mask,
+    // calling cullRange(first, count, words) for each on the worker pool.
+    template<typename TCullRange>
+    void ParallelCull(size_t count, uint32_t* visible, TCullRange&& cullRange)
+    {
+        WorkerPool::Get().ParallelFor((count + 31) / 32, ParallelCullWords, [&](size_t begin, size_t end) noexcept
+            {
+                const size_t first = begin * 32;
+
+                cullRange(first, std::min(end * 32, count) - first, visible + begin);
+            });
+    }
+}
+
+FrustumCuller::FrustumCuller(const BoundingFrustum& frustum) noexcept
+{
+    XMVECTOR P[6];
+    frustum.GetPlanes(&P[0], &P[1], &P[2], &P[3], &P[4], &P[5]);
+
+    // The frustum's planes face outwards.
+    for (size_t p = 0; p < 6; p++)
+    {
+        XMStoreFloat4(&planes[p], XMVectorNegate(P[p]));
+    }
+}
+
+FrustumCuller::FrustumCuller(const Matrix& viewProjection) noexcept
+{
+    // Gribb & Hartmann, "Fast Extraction of Viewing Frustum Planes from the World-View-Projection Matrix" (2001),
+    // for Direct3D clip space, where z runs from 0 to 1.
+    const XMMATRIX M = XMMatrixTranspose(viewProjection);
+
+    XMStoreFloat4(&planes[0], XMPlaneNormalize(XMVectorAdd(M.r[3], M.r[0])));
+    XMStoreFloat4(&planes[1], XMPlaneNormalize(XMVectorSubtract(M.r[3], M.r[0])));
+    XMStoreFloat4(&planes[2], XMPlaneNormalize(XMVectorAdd(M.r[3], M.r[1])));
+    XMStoreFloat4(&planes[3], XMPlaneNormalize(XMVectorSubtract(M.r[3], M.r[1])));
+    XMStoreFloat4(&planes[4], XMPlaneNormalize(M.r[2]));
+    XMStoreFloat4(&planes[5], XMPlaneNormalize(XMVectorSubtract(M.r[3], M.r[2])));
+}
+
+void FrustumCuller::Cull(const BoundingSphere* spheres, size_t count, uint32_t* visible) const noexcept
+{
+    CullSphereRange(GetCullPlanes(planes), spheres, count, visible);
+}
+
+void FrustumCuller::Cull(const BoundingBox* boxes, size_t count, uint32_t* visible) const noexcept
+{
+    CullBoxRange(GetCullPlanes(planes), boxes, count, visible);
+}
+
+void FrustumCuller::Cull(const ConstVector3Stream& centers, const float* radii, size_t count, uint32_t* visible) const noexcept
+{
+    GetStreamKernels().cullSpheres(GetCullPlanes(planes), { { centers.x, centers.y, centers.z } }, radii, count, visible);
+}
+
+void FrustumCuller::Cull(const ConstVector3Stream& centers, const ConstVector3Stream& extents, size_t count, uint32_t* visible) const noexcept
+{
+    GetStreamKernels().cullBoxes(GetCullPlanes(planes), { { centers.x, centers.y, centers.z } }, { { extents.x, extents.y, extents.z } }, count, visible);
+}
+
+void FrustumCuller::CullParallel(const BoundingSphere* spheres, size_t count, uint32_t* visible) const
+{
+    auto const cullPlanes = GetCullPlanes(planes);
+
+    ParallelCull(count, visible, [&](size_t first, size_t rangeCount, uint32_t* words) noexcept
+        {
+            CullSphereRange(cullPlanes, spheres + first, rangeCount, words);
+        });
+}
+
+void FrustumCuller::CullParallel(const BoundingBox* boxes, size_t count, uint32_t* visible) const
+{
+    auto const cullPlanes = GetCullPlanes(planes);
+
+    ParallelCull(count, visible, [&](size_t first, size_t rangeCount, uint32_t* words) noexcept
+        {
+            CullBoxRange(cullPlanes, boxes + first, rangeCount, words);
+        });
+}
+
+void FrustumCuller::CullParallel(const ConstVector3Stream& centers, const float* radii, size_t count, uint32_t* visible) const
+{
+    auto const cullPlanes = GetCullPlanes(planes);
+
+    ParallelCull(count, visible, [&](size_t first, size_t rangeCount, uint32_t* words) noexcept
+        {
+            GetStreamKernels().cullSpheres(cullPlanes, { { centers.x + first, centers.y + first, centers.z + first } }, radii + first, rangeCount, words);
+        });
+}
+
+void FrustumCuller::CullParallel(const ConstVector3Stream& centers, const ConstVector3Stream& extents, size_t count, uint32_t* visible) const
+{
+    auto const cullPlanes = GetCullPlanes(planes);
+
+    ParallelCull(count, visible, [&](size_t first, size_t rangeCount, uint32_t* words) noexcept
+        {
+            GetStreamKernels().cullBoxes(cullPlanes,
+                { { centers.x + first, centers.y + first, centers.z + first } },
+                { { extents.x + first, extents.y + first, extents.z + first } },
+                rangeCount, words);
+        });
+}
+
+
 /****************************************************************************
  *
  * Quaternion
@@ -144,6 +552,91 @@ void Quaternion::LookRotation(const Vector3& forward, const Vector3& up, Quatern
 }
 
 
+/****************************************************************************
+ *
+ * Color
+ *
+ ****************************************************************************/
+
+// Color arrays are converted as packed floats and 32-bit values.
+static_assert(sizeof(Color) == 4 * sizeof(float), "Color should be 16 bytes");
+static_assert(sizeof(PackedVector::XMUBYTEN4) == sizeof(uint32_t) && sizeof(PackedVector::XMCOLOR) == sizeof(uint32_t), "Layout mismatch");
+
+using ColorKernels::GetColorKernels;
+
+// XMVectorPow works one component at a time, so the exact conversions gain nothing from wider registers.
+void Color::SRGBToLinear(const Color* carray, size_t count, Color* resultArray) noexcept
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        XMStoreFloat4(&resultArray[i], XMColorSRGBToRGB(XMLoadFloat4(&carray[i])));
+    }
+}
+
+void Color::LinearToSRGB(const Color* carray, size_t count, Color* resultArray) noexcept
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        XMStoreFloat4(&resultArray[i], XMColorRGBToSRGB(XMLoadFloat4(&carray[i])));
+    }
+}
+
+void Color::SRGBToLinearFast(const Color* carray, size_t count, Color* resultArray) noexcept
+{
+    GetColorKernels().srgbToLinearFast(&carray->x, count, &resultArray->x);
+}
+
+void Color::LinearToSRGBFast(const Color* carray, size_t count, Color* resultArray) noexcept
+{
+    GetColorKernels().linearToSRGBFast(&carray->x, count, &resultArray->x);
+}
+
+void Color::Premultiply(const Color* carray, size_t count, Color* resultArray) noexcept
+{
+    GetColorKernels().premultiply(&carray->x, count, &resultArray->x);
+}
+
+void Color::Unpremultiply(const Color* carray, size_t count, Color* resultArray) noexcept
+{
+    GetColorKernels().unpremultiply(&carray->x, count, &resultArray->x);
+}
+
+void Color::AdjustSaturation(const Color* carray, size_t count, float sat, Color* resultArray) noexcept
+{
+    GetColorKernels().adjustSaturation(&carray->x, count, sat, &resultArray->x);
+}
+
+void Color::Pack(const Color* carray, size_t count, PackedVector::XMUBYTEN4* resultArray) noexcept
+{
+    GetColorKernels().packRGBA(&carray->x, count, &resultArray->v);
+}
+
+void Color::Pack(const Color* carray, size_t count, PackedVector::XMCOLOR* resultArray) noexcept
+{
+    GetColorKernels().packBGRA(&carray->x, count, &resultArray->c);
+}
+
+void Color::Unpack(const PackedVector::XMUBYTEN4* carray, size_t count, Color* resultArray) noexcept
+{
+    GetColorKernels().unpackRGBA(&carray->v, count, &resultArray->x);
+}
+
+void Color::Unpack(const PackedVector::XMCOLOR* carray, size_t count, Color* resultArray) noexcept
+{
+    GetColorKernels().unpackBGRA(&carray->c, count, &resultArray->x);
+}
+
+void Color::Swizzle(const PackedVector::XMUBYTEN4* carray, size_t count, PackedVector::XMCOLOR* resultArray) noexcept
+{
+    GetColorKernels().swapRedBlue(&carray->v, count, &resultArray->c);
+}
+
+void Color::Swizzle(const PackedVector::XMCOLOR* carray, size_t count, PackedVector::XMUBYTEN4* resultArray) noexcept
+{
+    GetColorKernels().swapRedBlue(&carray->c, count, &resultArray->v);
+}
+
+
  /****************************************************************************
  *
  * Viewport
@@ -245,3 +738,175 @@ RECT Viewport::ComputeTitleSafeArea(UINT backBufferWidth, UINT backBufferHeight)
 
     return rct;
 }
+
+namespace
+{
+    // Points and boxes are copied to the stack this many at a time, then run through the stream kernels.
+    constexpr size_t ProjectChunkSize = 256;
+
+    // Parallel ProjectBounds hands out at least this many boxes at a time.
+    constexpr size_t ParallelProjectBoxes = 4096;
+
+    // World, view and projection, then XMVector3Project's mapping from clip space to the viewport. That
+    // is applied after the divide by w, but being affine, it gives the same results applied before.
+    Matrix ProjectTransform(const Viewport& vp, const Matrix& proj, const Matrix& view, const Matrix& world) noexcept
+    {
+        const float halfWidth = vp.width * 0.5f;
+        const float halfHeight = vp.height * 0.5f;
+
+        const XMMATRIX toViewport(
+            halfWidth, 0, 0, 0,
+            0, -halfHeight, 0, 0,
+            0, 0, vp.maxDepth - vp.minDepth, 0,
+            vp.x + halfWidth, vp.y + halfHeight, vp.minDepth, 1.f);
+
+        return XMMatrixMultiply(XMMatrixMultiply(XMMatrixMultiply(world, view), proj), toViewport);
+    }
+
+    // The inverse: XMVector3Unproject's mapping back to clip space, then the inverse of world, view and projection.
+    Matrix UnprojectTransform(const Viewport& vp, const Matrix& proj, const Matrix& view, const Matrix& world) noexcept
+    {
+        const float scaleX = 2.f / vp.width;
+        const float scaleY = -2.f / vp.height;
+        const float scaleZ = 1.f / (vp.maxDepth - vp.minDepth);
+
+        const XMMATRIX fromViewport(
+            scaleX, 0, 0, 0,
+            0, scaleY, 0, 0,
+            0, 0, scaleZ, 0,
+            -vp.x * scaleX - 1.f, -vp.y * scaleY + 1.f, -vp.minDepth * scaleZ, 1.f);
+
+        const XMMATRIX worldViewProj = XMMatrixMultiply(XMMatrixMultiply(world, view), proj);
+
+        return XMMatrixMultiply(fromViewport, XMMatrixInverse(nullptr, worldViewProj));
+    }
+
+    void TransformPointRange(const Matrix& m, _In_reads_(count) const Vector3* parray, size_t count, _Out_writes_(count) Vector3* resultArray) noexcept
+    {
+        float x[ProjectChunkSize];
+        float y[ProjectChunkSize];
+        float z[ProjectChunkSize];
+
+        for (size_t base = 0; base < count; base += ProjectChunkSize)
+        {
+            const size_t chunk = std::min(ProjectChunkSize, count - base);
+
+            for (size_t i = 0; i < chunk; i++)
+            {
+                auto const& p = parray[base + i];
+
+                x[i] = p.x;
+                y[i] = p.y;
+                z[i] = p.z;
+            }
+
+            GetStreamKernels().transformCoord3({ { x, y, z } }, chunk, m, { { x, y, z } });
+
+            for (size_t i = 0; i < chunk; i++)
+            {
+                resultArray[base + i] = Vector3(x[i], y[i], z[i]);
+            }
+        }
+    }
+
+    // Screen bounds from the kernel are clipped to the viewport, then rounded out to whole pixels.
+    size_t ProjectBoxRange(const Viewport& vp, const Matrix& m, _In_reads_(count) const BoundingBox* boxes, size_t count, _Out_writes_(count) Rectangle* resultArray) noexcept
+    {
+        float x[ProjectChunkSize];
+        float y[ProjectChunkSize];
+        float z[ProjectChunkSize];
+        float ex[ProjectChunkSize];
+        float ey[ProjectChunkSize];
+        float ez[ProjectChunkSize];
+
+        const float right = vp.x + vp.width;
+        const float bottom = vp.y + vp.height;
+
+        size_t visible = 0;
+
+        for (size_t base = 0; base < count; base += ProjectChunkSize)
+        {
+            const size_t chunk = std::min(ProjectChunkSize, count - base);
+
+            for (size_t i = 0; i < chunk; i++)
+            {
+                auto const& box = boxes[base + i];
+
+                x[i] = box.Center.x;
+                y[i] = box.Center.y;
+                z[i] = box.Center.z;
+                ex[i] = box.Extents.x;
+                ey[i] = box.Extents.y;
+                ez[i] = box.Extents.z;
+            }
+
+            // The bounds are written over the centers, which are no longer needed.
+            GetStreamKernels().projectBoxes(m, { { x, y, z } }, { { ex, ey, ez } }, chunk, { { x, y, ex, ey } });
+
+            for (size_t i = 0; i < chunk; i++)
+            {
+                const float minX = std::max(x[i], vp.x);
+                const float minY = std::max(y[i], vp.y);
+                const float maxX = std::min(ex[i], right);
+                const float maxY = std::min(ey[i], bottom);
+
+                Rectangle& rect = resultArray[base + i];
+
+                if (minX <= maxX && minY <= maxY)
+                {
+                    rect.x = static_cast<long>(floorf(minX));
+                    rect.y = static_cast<long>(floorf(minY));
+                    rect.width = static_cast<long>(ceilf(maxX)) - rect.x;
+                    rect.height = static_cast<long>(ceilf(maxY)) - rect.y;
+
+                    visible++;
+                }
+                else
+                {
+                    rect = Rectangle();
+                }
+            }
+        }
+
+        return visible;
+    }
+}
+
+void Viewport::Project(const Vector3* parray, size_t count, const Matrix& proj, const Matrix& view, const Matrix& world, Vector3* resultArray) const noexcept
+{
+    TransformPointRange(ProjectTransform(*this, proj, view, world), parray, count, resultArray);
+}
+
+void Viewport::Project(const ConstVector3Stream& p, size_t count, const Matrix& proj, const Matrix& view, const Matrix& world, const Vector3Stream& result) const noexcept
+{
+    GetStreamKernels().transformCoord3({ { p.x, p.y, p.z } }, count, ProjectTransform(*this, proj, view, world), { { result.x, result.y, result.z } });
+}
+
+void Viewport::Unproject(const Vector3* parray, size_t count, const Matrix& proj, const Matrix& view, const Matrix& world, Vector3* resultArray) const noexcept
+{
+    TransformPointRange(UnprojectTransform(*this, proj, view, world), parray, count, resultArray);
+}
+
+void Viewport::Unproject(const ConstVector3Stream& p, size_t count, const Matrix& proj, const Matrix& view, const Matrix& world, const Vector3Stream& result) const noexcept
+{
+    GetStreamKernels().transformCoord3({ { p.x, p.y, p.z } }, count, UnprojectTransform(*this, proj, view, world), { { result.x, result.y, result.z } });
+}
+
+size_t Viewport::ProjectBounds(const BoundingBox* boxes, size_t count, const Matrix& proj, const Matrix& view, const Matrix& world, Rectangle* resultArray) const noexcept
+{
+    return ProjectBoxRange(*this, ProjectTransform(*this, proj, view, world), boxes, count, resultArray);
+}
+
+size_t Viewport::ProjectBoundsParallel(const BoundingBox* boxes, size_t count, const Matrix& proj, const Matrix& view, const Matrix& world, Rectangle* resultArray) const
+{
+    const Matrix m = ProjectTransform(*this, proj, view, world);
+
+    std::atomic<size_t> visible(0);
+
+    WorkerPool::Get().ParallelFor(count, ParallelProjectBoxes, [&](size_t begin, size_t end) noexcept
+        {
+            visible += ProjectBoxRange(*this, m, boxes + begin, end - begin, resultArray + begin);
+        });
+
+    return visible;
+}
@@ -15,7 +15,17 @@
 #include "DirectXHelpers.h"
 #include "VertexTypes.h"
 #include "AlignedNew.h"
+#include "AdaptiveRing.h"
+#include "PerThreadSegments.h"
+#include "RadixSort.h"
 #include "SharedResourcePool.h"
+#include "SpriteCulling.h"
+#include "SpriteExpansion.h"
+#include "SpriteInstances.h"
+#include "SpriteTextureGroups.h"
+#include "WorkerPool.h"
+
+#include <chrono>
 
 using namespace DirectX;
 using Microsoft::WRL::ComPtr;
@@ -26,11 +36,76 @@ namespace
 #if defined(_XBOX_ONE) && defined(_TITLE)
 #include "XboxOneSpriteEffect_SpriteVertexShader.inc"
 #include "XboxOneSpriteEffect_SpritePixelShader.inc"
+#include "XboxOneSpriteEffect_SpriteVertexShaderMultiTexture.inc"
+#include "XboxOneSpriteEffect_SpritePixelShaderMultiTexture.inc"
+#include "XboxOneSpriteEffect_SpriteVertexShaderInstanced.inc"
 #else
 #include "SpriteEffect_SpriteVertexShader.inc"
 #include "SpriteEffect_SpritePixelShader.inc"
+#include "SpriteEffect_SpriteVertexShaderMultiTexture.inc"
+#include "SpriteEffect_SpritePixelShaderMultiTexture.inc"
+#include "SpriteEffect_SpriteVertexShaderInstanced.inc"
 #endif
 
+    // Vertex layout used when a draw samples from several textures. The texture slot of each
+    // vertex comes from a second vertex buffer, so the main vertex data is unchanged.
+    const D3D11_INPUT_ELEMENT_DESC MultiTextureInputElements[] =
+    {
+        { "SV_Position", 0, DXGI_FORMAT_R32G32B32_FLOAT,    0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+        { "COLOR",       0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+        { "TEXCOORD",    0, DXGI_FORMAT_R32G32_FLOAT,       0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+        { "TEXINDEX",    0, DXGI_FORMAT_R8_UINT,            1, 0,                            D3D11_INPUT_PER_VERTEX_DATA, 0 },
+    };
+
+    // Instance layout used when the vertex shader expands each sprite into its corners. There is
+    // no per-vertex data, as the shader derives the corner from SV_VertexID.
+    const D3D11_INPUT_ELEMENT_DESC InstancedInputElements[] =
+    {
+        { "SPRITE", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+        { "SPRITE", 1, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+        { "SPRITE", 2, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+        { "COLOR",  0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+    };
+
+    // Adds the time spent in a scope to a running total, and optionally marks the scope with a
+    // trace event so it shows up in graphics debuggers.
+    class ScopedStage
+    {
+    public:
+        ScopedStage(_In_opt_ std::chrono::steady_clock::duration* total, _In_opt_ ID3DUserDefinedAnnotation* annotation, _In_z_ LPCWSTR name) noexcept :
+            mTotal(total),
+            mAnnotation(annotation),
+            mStart(total ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point())
+        {
+            if (mAnnotation)
+            {
+                mAnnotation->BeginEvent(name);
+            }
+        }
+
+        ScopedStage(ScopedStage const&) = delete;
+        ScopedStage& operator= (ScopedStage const&) = delete;
+
+        ~ScopedStage()
+        {
+            if (mTotal)
+            {
+                *mTotal += std::chrono::steady_clock::now() - mStart;
+            }
+
+            if (mAnnotation)
+            {
+                mAnnotation->EndEvent();
+            }
+        }
+
+    private:
+        std::chrono::steady_clock::duration* mTotal;
+        ID3DUserDefinedAnnotation* mAnnotation;
+        std::chrono::steady_clock::time_point mStart;
+    };
+
+
     // Helper looks up the D3D device corresponding to a context interface.
     inline ComPtr<ID3D11Device> GetDevice(_In_ ID3D11DeviceContext* deviceContext)
     {
@@ -79,23 +154,66 @@ public:
         FXMVECTOR originRotationDepth,
         unsigned int flags);
 
+    void XM_CALLCONV DrawRun(_In_ ID3D11ShaderResourceView* texture,
+        _In_reads_(count) SpriteRunElement const* elements,
+        size_t count,
+        FXMVECTOR color,
+        FXMVECTOR scale,
+        FXMVECTOR rotationDepth,
+        unsigned int flags);
+
 
-    // Info about a single sprite that is waiting to be drawn.
-    XM_ALIGNED_STRUCT(16) SpriteInfo : public AlignedNew<SpriteInfo>
+    // A run of retained sprites that share a texture, as captured for StaticSpriteBatch.
+    struct RetainedBatch
     {
-        XMFLOAT4A source;
-        XMFLOAT4A destination;
-        XMFLOAT4A color;
-        XMFLOAT4A originRotationDepth;
-        ID3D11ShaderResourceView* texture;
-        unsigned int flags;
+        ComPtr<ID3D11ShaderResourceView> texture;
+        size_t firstSprite;
+        size_t spriteCount;
+    };
+
+    // Ends a Begin/End pair by sorting and expanding the queued sprites into a vertex array instead of
+    // drawing them. locations receives the position of each queued sprite within the sorted output.
+    void Capture(std::vector<VertexPositionColorTexture>& vertices,
+        std::vector<RetainedBatch>& batches,
+        std::vector<uint32_t>& locations);
+
+    // Draws sprites previously captured into a vertex buffer.
+    void XM_CALLCONV DrawRetained(_In_ ID3D11Buffer* vertexBuffer,
+        _In_reads_(batchCount) RetainedBatch const* batches,
+        size_t batchCount,
+        _In_opt_ ID3D11BlendState* blendState,
+        _In_opt_ ID3D11SamplerState* samplerState,
+        _In_opt_ ID3D11DepthStencilState* depthStencilState,
+        _In_opt_ ID3D11RasterizerState* rasterizerState,
+        const std::function<void()>& setCustomShaders,
+        FXMMATRIX transformMatrix);
+
+
+    // Combine values from the public SpriteEffects enum with these internal-only flags.
+    static constexpr unsigned int SourceInTexels = SpriteExpansion::SourceInTexels;
+    static constexpr unsigned int DestSizeInPixels = SpriteExpansion::DestSizeInPixels;
 
+    static_assert((SpriteEffects_FlipBoth & (SourceInTexels | DestSizeInPixels)) == 0, "Flag bits must not overlap");
+    static_assert(SpriteEffects_FlipHorizontally == SpriteExpansion::FlipHorizontally &&
+        SpriteEffects_FlipVertically == SpriteExpansion::FlipVertically, "The vertex expansion reads the SpriteEffects bits directly");
 
-        // Combine values from the public SpriteEffects enum with these internal-only flags.
-        static constexpr unsigned int SourceInTexels = 4;
-        static constexpr unsigned int DestSizeInPixels = 8;
 
-        static_assert((SpriteEffects_FlipBoth & (SourceInTexels | DestSizeInPixels)) == 0, "Flag bits must not overlap");
+    // Aligned storage for one four-component field of a queued sprite.
+    XM_ALIGNED_STRUCT(16) SpriteField : public XMFLOAT4A, public AlignedNew<SpriteField>
+    {
+    };
+
+
+    // Sprites waiting to be drawn. Each field lives in its own array rather than in one record
+    // per sprite, so the SIMD expansion path can load the same field of several sprites at once.
+    struct SpriteQueue
+    {
+        std::unique_ptr<SpriteField[]> source;
+        std::unique_ptr<SpriteField[]> destination;
+        std::unique_ptr<SpriteField[]> color;
+        std::unique_ptr<SpriteField[]> originRotationDepth;
+        std::unique_ptr<ID3D11ShaderResourceView*[]> texture;
+        std::unique_ptr<unsigned int[]> flags;
     };
 
     DXGI_MODE_ROTATION mRotation;
@@ -103,18 +221,101 @@ public:
     bool mSetViewport;
     D3D11_VIEWPORT mViewPort;
 
+    bool mParallelVertexGeneration;
+    size_t mParallelThreshold;
+
+    size_t mMaxTexturesPerBatch;
+
+    bool mThreadedRecording;
+
+    bool mCulling;
+    bool mUseClipRectangle;
+    RECT mClipRectangle;
+    size_t mCulledSpriteCount;
+
+    bool mInstancedRendering;
+
+    bool mTraceEvents;
+    bool mStageTiming;
+
+    SpriteBatchStatistics GetStatistics() const noexcept;
+
+    void SetMaxTexturesPerBatch(size_t count);
+    void SetThreadedRecording(bool enable);
+    void SetInstancedRendering(bool enable);
+
 private:
+    // Sprites recorded by one thread while threaded recording is enabled. End appends the
+    // segments of every thread that drew something onto the main queue.
+    struct RecordingSegment
+    {
+        RecordingSegment() noexcept : count(0), arraySize(0) {}
+
+        SpriteQueue queue;
+        size_t count;
+        size_t arraySize;
+        std::vector<ComPtr<ID3D11ShaderResourceView>> textureReferences;
+    };
+
     // Implementation helper methods.
-    void GrowSpriteQueue();
-    void PrepareForRendering();
+    static void GrowSpriteQueue(SpriteQueue& queue, size_t count, size_t& arraySize, size_t minSize);
+    static void CopySprites(SpriteQueue const& source, SpriteQueue& dest, size_t destStart, size_t count);
+    static void XM_CALLCONV StoreSprite(SpriteQueue& queue,
+        uint32_t sprite,
+        _In_ ID3D11ShaderResourceView* texture,
+        FXMVECTOR destination,
+        _In_opt_ RECT const* sourceRectangle,
+        FXMVECTOR color,
+        FXMVECTOR originRotationDepth,
+        unsigned int flags);
+    static void XM_CALLCONV StoreSpriteRun(SpriteQueue& queue,
+        size_t first,
+        _In_ ID3D11ShaderResourceView* texture,
+        _In_reads_(count) SpriteRunElement const* elements,
+        size_t count,
+        FXMVECTOR color,
+        FXMVECTOR scale,
+        FXMVECTOR rotationDepth,
+        unsigned int flags);
+    static void AddTextureReference(std::vector<ComPtr<ID3D11ShaderResourceView>>& references, _In_ ID3D11ShaderResourceView* texture);
+    void MergeRecordingSegments();
+    size_t CullSprites();
+    ID3DUserDefinedAnnotation* GetTraceAnnotation() const noexcept;
+    std::chrono::steady_clock::duration* GetStageTotal(std::chrono::steady_clock::duration& total) noexcept;
+    XMMATRIX GetRenderTransform(_In_ ID3D11DeviceContext* deviceContext, _Out_opt_ XMMATRIX* viewportTransform = nullptr);
+    void PrepareForRendering(bool multiTexture, bool instanced);
     void FlushBatch();
+    void ResetQueue();
     void SortSprites();
-    void GrowSortedSprites();
+    void SortSpritesByKey(size_t keyBytes);
+    void GrowSortedSprites(size_t count);
 
-    void RenderBatch(_In_ ID3D11ShaderResourceView* texture, _In_reads_(count) SpriteInfo const* const* sprites, size_t count);
+    void FlushTextureGroups();
 
-    static void XM_CALLCONV RenderSprite(_In_ SpriteInfo const* sprite,
-        _Out_writes_(VerticesPerSprite) VertexPositionColorTexture* vertices,
+    void RenderBatch(_In_reads_(textureCount) ID3D11ShaderResourceView* const* textures,
+        size_t textureCount,
+        _In_reads_(count) uint32_t const* sprites,
+        _In_reads_opt_(count) uint8_t const* textureSlots,
+        size_t count);
+
+    void RenderInstances(_In_reads_(count) uint32_t const* sprites,
+        _In_reads_opt_(count) uint8_t const* textureSlots,
+        size_t count);
+
+    void PackInstances(_In_reads_(count) uint32_t const* sprites,
+        _In_reads_opt_(count) uint8_t const* textureSlots,
+        size_t count,
+        _Out_writes_(count) SpriteInstance* instances);
+
+    void GenerateBatchVertices(_In_reads_(count) uint32_t const* sprites,
+        size_t count,
+        _Out_writes_(count * VerticesPerSprite) VertexPositionColorTexture* vertices);
+
+    XMVECTOR LookupTextureSize(_In_ ID3D11ShaderResourceView* texture);
+
+    void XM_CALLCONV GenerateVertices(_In_reads_(count) uint32_t const* sprites,
+        size_t count,
+        _Out_writes_(count * VerticesPerSprite) VertexPositionColorTexture* vertices,
         FXMVECTOR textureSize,
         FXMVECTOR inverseTextureSize);
 
@@ -128,30 +329,78 @@ private:
     static constexpr size_t InitialQueueSize = 64;
     static constexpr size_t VerticesPerSprite = 4;
     static constexpr size_t IndicesPerSprite = 6;
+    static constexpr size_t ParallelChunkSize = SpriteExpansion::ParallelChunkSize;
+    static constexpr size_t MaxInstanceBatchSize = 16384;
+    static constexpr size_t MaxVertexRingSize = MaxBatchSize * 16;
 
 
     // Queue of sprites waiting to be drawn.
-    std::unique_ptr<SpriteInfo[]> mSpriteQueue;
+    SpriteQueue mSpriteQueue;
 
     size_t mSpriteQueueCount;
     size_t mSpriteQueueArraySize;
 
 
-    // To avoid needlessly copying around bulky SpriteInfo structures, we leave that
-    // actual data alone and just sort this array of pointers instead. But we want contiguous
-    // memory for cache efficiency, so these pointers are just shortcuts into the single
-    // mSpriteQueue array, and we take care to keep them in order when sorting is disabled.
-    std::vector<SpriteInfo const*> mSortedSprites;
+    // To avoid needlessly copying around bulky sprite data, we leave that actual data alone
+    // and just sort this array of queue indices instead. When sorting is disabled we take
+    // care to keep it holding the identity order, so it can be reused from batch to batch.
+    std::vector<uint32_t> mSortedSprites;
+
+
+    // Sort keys are extracted once per sprite into a contiguous array, so the radix sort
+    // never has to gather from the queue arrays. The scratch array is the radix ping-pong buffer.
+    using SortKey = RadixSort::KeyIndex<uint64_t>;
+
+    std::vector<SortKey> mSortKeys;
+    std::vector<SortKey> mSortScratch;
 
 
-    // If each SpriteInfo instance held a refcount on its texture, could end up with
+    // When draws can sample from several textures, the sorted sprites are split into groups of at
+    // most mMaxTexturesPerBatch textures, and this array holds the slot of each sprite in its group.
+    using TextureGrouper = SpriteTextureGrouper<ID3D11ShaderResourceView*, MaxTexturesPerBatch>;
+
+    std::vector<uint8_t> mTextureSlots;
+
+
+    // Texture sizes looked up since the queue was last reset. The queue holds references on its
+    // textures, so no entry can refer to a released texture whose address has been reused.
+    SpriteTextureCache<ID3D11ShaderResourceView*, XMFLOAT2> mTextureSizes;
+
+
+    // If each queued sprite held a refcount on its texture, could end up with
     // many redundant AddRef/Release calls on the same object, so instead we use
     // this separate list to hold just a single refcount each time we change texture.
     std::vector<ComPtr<ID3D11ShaderResourceView>> mSpriteTextureReferences;
 
 
+    // Per-thread queues used while threaded recording is enabled.
+    PerThreadSegments<RecordingSegment> mRecordingSegments;
+
+
+    // Counters for the current Begin/End pair, reset by Begin. The counts are cheap enough to always
+    // gather. The times are only gathered when stage timing is on, and are accumulated at full clock
+    // resolution and only converted when queried.
+    struct Statistics
+    {
+        size_t spritesQueued;
+        size_t batchesIssued;
+        size_t textureChanges;
+        size_t bufferWraps;
+        size_t bytesMapped;
+        std::chrono::steady_clock::duration sortTime;
+        std::chrono::steady_clock::duration expandTime;
+        std::chrono::steady_clock::duration renderTime;
+    };
+
+    Statistics mStatistics;
+
+    // The ContextResources::ringInterval in which this batch last ended.
+    uint64_t mLastRingInterval;
+
+
     // Mode settings from the last Begin call.
     bool mInBeginEndPair;
+    bool mDrawInstanced;
 
     SpriteSortMode mSortMode;
     ComPtr<ID3D11BlendState> mBlendState;
@@ -172,10 +421,21 @@ private:
         ComPtr<ID3D11InputLayout> inputLayout;
         ComPtr<ID3D11Buffer> indexBuffer;
 
+        // Shaders for drawing from several textures at once, only created on Feature Level 10.0 or later.
+        ComPtr<ID3D11VertexShader> multiTextureVertexShader;
+        ComPtr<ID3D11PixelShader> multiTexturePixelShader;
+        ComPtr<ID3D11InputLayout> multiTextureInputLayout;
+
+        // Vertex shader that expands one instance per sprite, paired with the multi-texture pixel shader.
+        ComPtr<ID3D11VertexShader> instancedVertexShader;
+        ComPtr<ID3D11InputLayout> instancedInputLayout;
+
         CommonStates stateObjects;
 
     private:
         void CreateShaders(_In_ ID3D11Device* device);
+        void CreateMultiTextureShaders(_In_ ID3D11Device* device);
+        void CreateInstancedShaders(_In_ ID3D11Device* device);
         void CreateIndexBuffer(_In_ ID3D11Device* device);
 
         static std::vector<short> CreateIndexValues();
@@ -195,12 +455,36 @@ private:
 
         ComPtr<ID3D11Buffer> vertexBuffer;
 
+        // Per-vertex texture slots for multi-texture draws, created on first use.
+        ComPtr<ID3D11Buffer> textureSlotBuffer;
+
+        // Per-sprite instances for instanced draws, created on first use.
+        ComPtr<ID3D11Buffer> instanceBuffer;
+
         ConstantBuffer<XMMATRIX> constantBuffer;
 
         size_t vertexBufferPosition;
 
+        // Sizes the vertex ring from the number of sprites written in each frame, so busy frames
+        // stop wrapping (and discarding) the buffer several times over. Every SpriteBatch on this
+        // context writes to the ring, so an interval spans the Begin/End pairs of all of them; see
+        // SpriteBatch::Impl::Begin for where one ends.
+        AdaptiveRingSizer vertexRing;
+        size_t intervalSprites;
+        size_t intervalWraps;
+        uint64_t ringInterval;
+
+        SpriteInstanceRing instanceRing;
+
+        // Used to emit trace events, if the context supports it.
+        ComPtr<ID3DUserDefinedAnnotation> annotation;
+
         bool inImmediateMode;
 
+        void CreateTextureSlotBuffer();
+        void CreateInstanceBuffer();
+        void EndRingInterval();
+
     private:
         void CreateVertexBuffer();
     };
@@ -230,6 +514,12 @@ SpriteBatch::Impl::DeviceResources::DeviceResources(_In_ ID3D11Device* device)
 {
     CreateShaders(device);
     CreateIndexBuffer(device);
+
+    if (device->GetFeatureLevel() >= D3D_FEATURE_LEVEL_10_0)
+    {
+        CreateMultiTextureShaders(device);
+        CreateInstancedShaders(device);
+    }
 }
 
 
@@ -264,6 +554,60 @@ void SpriteBatch::Impl::DeviceResources::CreateShaders(_In_ ID3D11Device* device
 }
 
 
+// Creates the shaders and input layout for drawing from several textures at once.
+void SpriteBatch::Impl::DeviceResources::CreateMultiTextureShaders(_In_ ID3D11Device* device)
+{
+    ThrowIfFailed(
+        device->CreateVertexShader(SpriteEffect_SpriteVertexShaderMultiTexture,
+            sizeof(SpriteEffect_SpriteVertexShaderMultiTexture),
+            nullptr,
+            &multiTextureVertexShader)
+    );
+
+    ThrowIfFailed(
+        device->CreatePixelShader(SpriteEffect_SpritePixelShaderMultiTexture,
+            sizeof(SpriteEffect_SpritePixelShaderMultiTexture),
+            nullptr,
+            &multiTexturePixelShader)
+    );
+
+    ThrowIfFailed(
+        device->CreateInputLayout(MultiTextureInputElements,
+            static_cast<UINT>(std::size(MultiTextureInputElements)),
+            SpriteEffect_SpriteVertexShaderMultiTexture,
+            sizeof(SpriteEffect_SpriteVertexShaderMultiTexture),
+            &multiTextureInputLayout)
+    );
+
+    SetDebugObjectName(multiTextureVertexShader.Get(), "DirectXTK:SpriteBatch");
+    SetDebugObjectName(multiTexturePixelShader.Get(), "DirectXTK:SpriteBatch");
+    SetDebugObjectName(multiTextureInputLayout.Get(), "DirectXTK:SpriteBatch");
+}
+
+
+// Creates the vertex shader and input layout for expanding one instance per sprite.
+void SpriteBatch::Impl::DeviceResources::CreateInstancedShaders(_In_ ID3D11Device* device)
+{
+    ThrowIfFailed(
+        device->CreateVertexShader(SpriteEffect_SpriteVertexShaderInstanced,
+            sizeof(SpriteEffect_SpriteVertexShaderInstanced),
+            nullptr,
+            &instancedVertexShader)
+    );
+
+    ThrowIfFailed(
+        device->CreateInputLayout(InstancedInputElements,
+            static_cast<UINT>(std::size(InstancedInputElements)),
+            SpriteEffect_SpriteVertexShaderInstanced,
+            sizeof(SpriteEffect_SpriteVertexShaderInstanced),
+            &instancedInputLayout)
+    );
+
+    SetDebugObjectName(instancedVertexShader.Get(), "DirectXTK:SpriteBatch");
+    SetDebugObjectName(instancedInputLayout.Get(), "DirectXTK:SpriteBatch");
+}
+
+
 // Creates the SpriteBatch index buffer.
 void SpriteBatch::Impl::DeviceResources::CreateIndexBuffer(_In_ ID3D11Device* device)
 {
@@ -315,6 +659,11 @@ std::vector<short> SpriteBatch::Impl::DeviceResources::CreateIndexValues()
 SpriteBatch::Impl::ContextResources::ContextResources(_In_ ID3D11DeviceContext* context)
     :constantBuffer(GetDevice(context).Get()),
     vertexBufferPosition(0),
+    vertexRing(MaxBatchSize, MaxVertexRingSize),
+    intervalSprites(0),
+    intervalWraps(0),
+    ringInterval(1),
+    instanceRing(MaxInstanceBatchSize, MinBatchSize),
     inImmediateMode(false)
 {
 #if defined(_XBOX_ONE) && defined(_TITLE)
@@ -323,6 +672,13 @@ SpriteBatch::Impl::ContextResources::ContextResources(_In_ ID3D11DeviceContext*
     deviceContext = context;
 #endif
 
+    // Trace events are optional, so failing to find the interface is not an error.
+#if defined(_XBOX_ONE) && defined(_TITLE)
+    std::ignore = context->QueryInterface(IID_GRAPHICS_PPV_ARGS(annotation.GetAddressOf()));
+#else
+    std::ignore = context->QueryInterface(IID_PPV_ARGS(annotation.GetAddressOf()));
+#endif
+
     CreateVertexBuffer();
 }
 
@@ -351,7 +707,7 @@ void SpriteBatch::Impl::ContextResources::CreateVertexBuffer()
 #else
     D3D11_BUFFER_DESC vertexBufferDesc = {};
 
-    vertexBufferDesc.ByteWidth = sizeof(VertexPositionColorTexture) * MaxBatchSize * VerticesPerSprite;
+    vertexBufferDesc.ByteWidth = static_cast<UINT>(sizeof(VertexPositionColorTexture) * vertexRing.GetCapacity() * VerticesPerSprite);
     vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
     vertexBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
     vertexBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
@@ -365,14 +721,127 @@ void SpriteBatch::Impl::ContextResources::CreateVertexBuffer()
 }
 
 
+// Creates the vertex buffer holding per-vertex texture slots for multi-texture draws.
+void SpriteBatch::Impl::ContextResources::CreateTextureSlotBuffer()
+{
+#if defined(_XBOX_ONE) && defined(_TITLE)
+    D3D11_BUFFER_DESC slotBufferDesc = {};
+
+    slotBufferDesc.ByteWidth = sizeof(uint8_t) * MaxBatchSize * VerticesPerSprite;
+    slotBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+    slotBufferDesc.Usage = D3D11_USAGE_DEFAULT;
+    slotBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+    auto device = GetDevice(deviceContext.Get());
+
+    ComPtr<ID3D11DeviceX> deviceX;
+    ThrowIfFailed(device.As(&deviceX));
+
+    ThrowIfFailed(
+        deviceX->CreatePlacementBuffer(&slotBufferDesc, nullptr, &textureSlotBuffer)
+    );
+#else
+    D3D11_BUFFER_DESC slotBufferDesc = {};
+
+    slotBufferDesc.ByteWidth = static_cast<UINT>(sizeof(uint8_t) * vertexRing.GetCapacity() * VerticesPerSprite);
+    slotBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+    slotBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+    slotBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+    ThrowIfFailed(
+        GetDevice(deviceContext.Get())->CreateBuffer(&slotBufferDesc, nullptr, &textureSlotBuffer)
+    );
+#endif
+
+    SetDebugObjectName(textureSlotBuffer.Get(), "DirectXTK:SpriteBatch");
+}
+
+
+// Reports the sprites written since the last call to the ring sizer, recreating the vertex
+// buffers if it picks a new capacity. Called from Begin, before anything is drawn.
+void SpriteBatch::Impl::ContextResources::EndRingInterval()
+{
+#if !defined(_XBOX_ONE) || !defined(_TITLE)
+    const bool resized = vertexRing.EndInterval(intervalSprites, intervalWraps);
+
+    if (resized)
+    {
+        CreateVertexBuffer();
+
+        if (textureSlotBuffer)
+        {
+            CreateTextureSlotBuffer();
+        }
+
+        // The new buffers start out empty, so the next Map must discard.
+        vertexBufferPosition = 0;
+    }
+#endif
+
+    intervalSprites = 0;
+    intervalWraps = 0;
+    ringInterval++;
+}
+
+
+// Creates the buffer of per-sprite instances.
+void SpriteBatch::Impl::ContextResources::CreateInstanceBuffer()
+{
+#if defined(_XBOX_ONE) && defined(_TITLE)
+    D3D11_BUFFER_DESC instanceBufferDesc = {};
+
+    instanceBufferDesc.ByteWidth = sizeof(SpriteInstance) * MaxInstanceBatchSize;
+    instanceBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+    instanceBufferDesc.Usage = D3D11_USAGE_DEFAULT;
+    instanceBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+    auto device = GetDevice(deviceContext.Get());
+
+    ComPtr<ID3D11DeviceX> deviceX;
+    ThrowIfFailed(device.As(&deviceX));
+
+    ThrowIfFailed(
+        deviceX->CreatePlacementBuffer(&instanceBufferDesc, nullptr, &instanceBuffer)
+    );
+#else
+    D3D11_BUFFER_DESC instanceBufferDesc = {};
+
+    instanceBufferDesc.ByteWidth = sizeof(SpriteInstance) * MaxInstanceBatchSize;
+    instanceBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+    instanceBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+    instanceBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+    ThrowIfFailed(
+        GetDevice(deviceContext.Get())->CreateBuffer(&instanceBufferDesc, nullptr, &instanceBuffer)
+    );
+#endif
+
+    SetDebugObjectName(instanceBuffer.Get(), "DirectXTK:SpriteBatch");
+}
+
+
 // Per-SpriteBatch constructor.
 SpriteBatch::Impl::Impl(_In_ ID3D11DeviceContext* deviceContext)
     : mRotation(DXGI_MODE_ROTATION_IDENTITY),
     mSetViewport(false),
     mViewPort{},
+    mParallelVertexGeneration(false),
+    mParallelThreshold(512),
+    mMaxTexturesPerBatch(1),
+    mThreadedRecording(false),
+    mCulling(false),
+    mUseClipRectangle(false),
+    mClipRectangle{},
+    mCulledSpriteCount(0),
+    mInstancedRendering(false),
+    mTraceEvents(false),
+    mStageTiming(false),
     mSpriteQueueCount(0),
     mSpriteQueueArraySize(0),
+    mStatistics{},
+    mLastRingInterval(0),
     mInBeginEndPair(false),
+    mDrawInstanced(false),
     mSortMode(SpriteSortMode_Deferred),
     mTransformMatrix(MatrixIdentity),
     mDeviceResources(deviceResourcesPool.DemandCreate(GetDevice(deviceContext).Get())),
@@ -394,6 +863,20 @@ void XM_CALLCONV SpriteBatch::Impl::Begin(SpriteSortMode sortMode,
     if (mInBeginEndPair)
         throw std::logic_error("Cannot nest Begin calls on a single SpriteBatch");
 
+    if (mThreadedRecording && sortMode == SpriteSortMode_Immediate)
+        throw std::logic_error("SpriteSortMode_Immediate cannot be used with threaded recording");
+
+    // The vertex ring is shared by every SpriteBatch on this context, and sized from the demand of
+    // whole frames, which may draw with several batches. Rather than needing a per-frame call, the
+    // interval ends when a batch that has already ended in it begins again, since that batch must
+    // have moved on to the next frame. A batch drawn twice in one frame ends the interval early,
+    // which only splits that frame's demand across two intervals. The ring is left alone while
+    // another batch is drawing straight from it in immediate mode.
+    if (mLastRingInterval == mContextResources->ringInterval && !mContextResources->inImmediateMode)
+    {
+        mContextResources->EndRingInterval();
+    }
+
     mSortMode = sortMode;
     mBlendState = blendState;
     mSamplerState = samplerState;
@@ -408,11 +891,20 @@ void XM_CALLCONV SpriteBatch::Impl::Begin(SpriteSortMode sortMode,
         if (mContextResources->inImmediateMode)
             throw std::logic_error("Only one SpriteBatch at a time can use SpriteSortMode_Immediate");
 
-        PrepareForRendering();
+        PrepareForRendering(false, false);
 
         mContextResources->inImmediateMode = true;
     }
 
+    if (mThreadedRecording)
+    {
+        // Make every thread look up its segment again, so End knows which ones were used.
+        mRecordingSegments.NextGeneration();
+    }
+
+    mCulledSpriteCount = 0;
+    mStatistics = {};
+
     mInBeginEndPair = true;
 }
 
@@ -434,10 +926,26 @@ void SpriteBatch::Impl::End()
         if (mContextResources->inImmediateMode)
             throw std::logic_error("Cannot end one SpriteBatch while another is using SpriteSortMode_Immediate");
 
-        PrepareForRendering();
-        FlushBatch();
+        MergeRecordingSegments();
+
+        // Custom shaders expect a single texture and four vertices per sprite, so they always get one batch per texture.
+        const bool multiTexture = (mMaxTexturesPerBatch > 1) && !mSetCustomShaders;
+        const bool instanced = mInstancedRendering && !mSetCustomShaders;
+
+        PrepareForRendering(multiTexture, instanced);
+
+        if (multiTexture)
+        {
+            FlushTextureGroups();
+        }
+        else
+        {
+            FlushBatch();
+        }
     }
 
+    mLastRingInterval = mContextResources->ringInterval;
+
     // Break circular reference chains, in case the state lambda closed
     // over an object that holds a reference to this SpriteBatch.
     mSetCustomShaders = nullptr;
@@ -446,6 +954,83 @@ void SpriteBatch::Impl::End()
 }
 
 
+// Sets how many textures a single draw call can sample from.
+void SpriteBatch::Impl::SetMaxTexturesPerBatch(size_t count)
+{
+    if (!count || count > MaxTexturesPerBatch)
+        throw std::invalid_argument("count must be between 1 and MaxTexturesPerBatch");
+
+    if (count > 1 && !mDeviceResources->multiTextureVertexShader)
+        throw std::runtime_error("SpriteBatch multi-texture batching requires Feature Level 10.0 or later");
+
+    if (mInBeginEndPair)
+        throw std::logic_error("Cannot change the texture batching mode between Begin and End");
+
+    mMaxTexturesPerBatch = count;
+}
+
+
+// Sets whether Draw may be called from several threads at once.
+void SpriteBatch::Impl::SetThreadedRecording(bool enable)
+{
+    if (mInBeginEndPair)
+        throw std::logic_error("Cannot change the recording mode between Begin and End");
+
+    mThreadedRecording = enable;
+}
+
+
+// Converts the counters for the current Begin/End pair into the public statistics structure.
+SpriteBatchStatistics SpriteBatch::Impl::GetStatistics() const noexcept
+{
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+
+    SpriteBatchStatistics stats = {};
+
+    stats.spritesQueued = mStatistics.spritesQueued;
+    stats.spritesCulled = mCulledSpriteCount;
+    stats.batchesIssued = mStatistics.batchesIssued;
+    stats.textureChanges = mStatistics.textureChanges;
+    stats.bufferWraps = mStatistics.bufferWraps;
+    stats.bytesMapped = mStatistics.bytesMapped;
+    stats.sortMicroseconds = static_cast<uint64_t>(duration_cast<microseconds>(mStatistics.sortTime).count());
+    stats.expandMicroseconds = static_cast<uint64_t>(duration_cast<microseconds>(mStatistics.expandTime).count());
+
+    // Expansion happens inside the submit stage, so subtract it to report the two separately.
+    stats.submitMicroseconds = static_cast<uint64_t>(duration_cast<microseconds>(mStatistics.renderTime - mStatistics.expandTime).count());
+
+    return stats;
+}
+
+
+// Returns the interface used to emit trace events, or null if they are disabled.
+ID3DUserDefinedAnnotation* SpriteBatch::Impl::GetTraceAnnotation() const noexcept
+{
+    return mTraceEvents ? mContextResources->annotation.Get() : nullptr;
+}
+
+
+// Returns the running total a stage should add its time to, or null if stage timing is disabled.
+std::chrono::steady_clock::duration* SpriteBatch::Impl::GetStageTotal(std::chrono::steady_clock::duration& total) noexcept
+{
+    return mStageTiming ? &total : nullptr;
+}
+
+
+// Sets whether sprites are drawn from one instance each, expanded in the vertex shader.
+void SpriteBatch::Impl::SetInstancedRendering(bool enable)
+{
+    if (enable && !mDeviceResources->instancedVertexShader)
+        throw std::runtime_error("SpriteBatch instanced rendering requires Feature Level 10.0 or later");
+
+    if (mInBeginEndPair)
+        throw std::logic_error("Cannot change the rendering mode between Begin and End");
+
+    mInstancedRendering = enable;
+}
+
+
 // Adds a single sprite to the queue.
 _Use_decl_annotations_
 void XM_CALLCONV SpriteBatch::Impl::Draw(ID3D11ShaderResourceView* texture,
@@ -461,95 +1046,303 @@ void XM_CALLCONV SpriteBatch::Impl::Draw(ID3D11ShaderResourceView* texture,
     if (!mInBeginEndPair)
         throw std::logic_error("Begin must be called before Draw");
 
-    // Get a pointer to the output sprite.
-    if (mSpriteQueueCount >= mSpriteQueueArraySize)
-    {
-        GrowSpriteQueue();
-    }
-
-    SpriteInfo* sprite = &mSpriteQueue[mSpriteQueueCount];
-
-    XMVECTOR dest = destination;
-
-    if (sourceRectangle)
+    if (mThreadedRecording)
     {
-        // User specified an explicit source region.
-        const XMVECTOR source = LoadRect(sourceRectangle);
+        // Append to the calling thread's own segment, which no other thread touches until End.
+        auto& segment = mRecordingSegments.Get();
 
-        XMStoreFloat4A(&sprite->source, source);
-
-        // If the destination size is relative to the source region, convert it to pixels.
-        if (!(flags & SpriteInfo::DestSizeInPixels))
+        if (segment.count >= segment.arraySize)
         {
-            dest = XMVectorPermute<0, 1, 6, 7>(dest, XMVectorMultiply(dest, source)); // dest.zw *= source.zw
+            GrowSpriteQueue(segment.queue, segment.count, segment.arraySize, segment.count + 1);
         }
 
-        flags |= SpriteInfo::SourceInTexels | SpriteInfo::DestSizeInPixels;
-    }
-    else
-    {
-        // No explicit source region, so use the entire texture.
-        static const XMVECTORF32 wholeTexture = { { { 0, 0, 1, 1 } } };
+        StoreSprite(segment.queue, static_cast<uint32_t>(segment.count), texture, destination, sourceRectangle, color, originRotationDepth, flags);
 
-        XMStoreFloat4A(&sprite->source, wholeTexture);
+        segment.count++;
+
+        AddTextureReference(segment.textureReferences, texture);
+        return;
     }
 
-    // Store sprite parameters.
-    XMStoreFloat4A(&sprite->destination, dest);
-    XMStoreFloat4A(&sprite->color, color);
-    XMStoreFloat4A(&sprite->originRotationDepth, originRotationDepth);
+    // Find the queue slot for the output sprite.
+    if (mSpriteQueueCount >= mSpriteQueueArraySize)
+    {
+        GrowSpriteQueue(mSpriteQueue, mSpriteQueueCount, mSpriteQueueArraySize, mSpriteQueueCount + 1);
+    }
 
-    sprite->texture = texture;
-    sprite->flags = flags;
+    auto const sprite = static_cast<uint32_t>(mSpriteQueueCount);
+
+    StoreSprite(mSpriteQueue, sprite, texture, destination, sourceRectangle, color, originRotationDepth, flags);
 
     if (mSortMode == SpriteSortMode_Immediate)
     {
         // If we are in immediate mode, draw this sprite straight away.
-        RenderBatch(texture, &sprite, 1);
+        mStatistics.spritesQueued++;
+
+        RenderBatch(&texture, 1, &sprite, nullptr, 1);
     }
     else
     {
         // Queue this sprite for later sorting and batched rendering.
         mSpriteQueueCount++;
 
-        // Make sure we hold a refcount on this texture until the sprite has been drawn. Only checking the
-        // back of the vector means we will add duplicate references if the caller switches back and forth
-        // between multiple repeated textures, but calling AddRef more times than strictly necessary hurts
-        // nothing, and is faster than scanning the whole list or using a map to detect all duplicates.
-        if (mSpriteTextureReferences.empty() || texture != mSpriteTextureReferences.back().Get())
+        AddTextureReference(mSpriteTextureReferences, texture);
+    }
+}
+
+
+// Adds a run of sprites to the queue. The checks, queue growth and texture reference are done
+// once for the whole run, rather than once per sprite as when calling Draw in a loop.
+_Use_decl_annotations_
+void XM_CALLCONV SpriteBatch::Impl::DrawRun(ID3D11ShaderResourceView* texture,
+    SpriteRunElement const* elements,
+    size_t count,
+    FXMVECTOR color,
+    FXMVECTOR scale,
+    FXMVECTOR rotationDepth,
+    unsigned int flags)
+{
+    if (!texture)
+        throw std::invalid_argument("Texture cannot be null");
+
+    if (!elements && count > 0)
+        throw std::invalid_argument("Elements cannot be null");
+
+    if (!mInBeginEndPair)
+        throw std::logic_error("Begin must be called before Draw");
+
+    if (!count)
+        return;
+
+    if (mThreadedRecording)
+    {
+        auto& segment = mRecordingSegments.Get();
+
+        if (segment.count + count > segment.arraySize)
+        {
+            GrowSpriteQueue(segment.queue, segment.count, segment.arraySize, segment.count + count);
+        }
+
+        StoreSpriteRun(segment.queue, segment.count, texture, elements, count, color, scale, rotationDepth, flags);
+
+        segment.count += count;
+
+        AddTextureReference(segment.textureReferences, texture);
+        return;
+    }
+
+    if (mSpriteQueueCount + count > mSpriteQueueArraySize)
+    {
+        GrowSpriteQueue(mSpriteQueue, mSpriteQueueCount, mSpriteQueueArraySize, mSpriteQueueCount + count);
+    }
+
+    StoreSpriteRun(mSpriteQueue, mSpriteQueueCount, texture, elements, count, color, scale, rotationDepth, flags);
+
+    if (mSortMode == SpriteSortMode_Immediate)
+    {
+        // The queue is always empty in immediate mode, so the run occupies its first slots, and
+        // mSortedSprites holds their indices once it has been grown to cover them.
+        mStatistics.spritesQueued += count;
+
+        if (mSortedSprites.size() < count)
         {
-            mSpriteTextureReferences.emplace_back(texture);
+            GrowSortedSprites(count);
         }
+
+        RenderBatch(&texture, 1, mSortedSprites.data(), nullptr, count);
+    }
+    else
+    {
+        mSpriteQueueCount += count;
+
+        AddTextureReference(mSpriteTextureReferences, texture);
     }
 }
 
 
-// Dynamically expands the array used to store pending sprite information.
-void SpriteBatch::Impl::GrowSpriteQueue()
+// Writes a run of sprites into consecutive queue slots, producing the same fields as StoreSprite
+// does for a sprite drawn with an explicit source rectangle.
+_Use_decl_annotations_
+void XM_CALLCONV SpriteBatch::Impl::StoreSpriteRun(SpriteQueue& queue,
+    size_t first,
+    ID3D11ShaderResourceView* texture,
+    SpriteRunElement const* elements,
+    size_t count,
+    FXMVECTOR color,
+    FXMVECTOR scale,
+    FXMVECTOR rotationDepth,
+    unsigned int flags)
 {
-    // Grow by a factor of 2.
-    const size_t newSize = std::max(InitialQueueSize, mSpriteQueueArraySize * 2);
+    static_assert(offsetof(SpriteRunElement, origin) == offsetof(SpriteRunElement, position) + sizeof(XMFLOAT2), "Position and origin are loaded as one vector");
 
-    // Allocate the new array.
-    auto newArray = std::make_unique<SpriteInfo[]>(newSize);
+    // 1, 1, scale.x, scale.y, so one multiply converts the source size to the destination size.
+    const XMVECTOR sizeScale = XMVectorPermute<0, 1, 4, 5>(g_XMOne, scale);
 
-    // Copy over any existing sprites.
-    for (size_t i = 0; i < mSpriteQueueCount; i++)
+    flags |= SourceInTexels | DestSizeInPixels;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        auto const& element = elements[i];
+        const size_t sprite = first + i;
+
+        const XMVECTOR positionOrigin = XMLoadFloat4(reinterpret_cast<XMFLOAT4 const*>(&element.position)); // x, y, origin.x, origin.y
+        const XMVECTOR source = LoadRect(&element.sourceRectangle);
+
+        XMStoreFloat4A(&queue.source[sprite], source);
+        XMStoreFloat4A(&queue.destination[sprite], XMVectorPermute<0, 1, 6, 7>(positionOrigin, XMVectorMultiply(source, sizeScale)));
+        XMStoreFloat4A(&queue.color[sprite], color);
+        XMStoreFloat4A(&queue.originRotationDepth[sprite], XMVectorPermute<2, 3, 4, 5>(positionOrigin, rotationDepth));
+
+        queue.texture[sprite] = texture;
+        queue.flags[sprite] = flags;
+    }
+}
+
+
+// Writes the parameters of one sprite into a queue slot.
+_Use_decl_annotations_
+void XM_CALLCONV SpriteBatch::Impl::StoreSprite(SpriteQueue& queue,
+    uint32_t sprite,
+    ID3D11ShaderResourceView* texture,
+    FXMVECTOR destination,
+    RECT const* sourceRectangle,
+    FXMVECTOR color,
+    FXMVECTOR originRotationDepth,
+    unsigned int flags)
+{
+    XMVECTOR dest = destination;
+
+    if (sourceRectangle)
+    {
+        // User specified an explicit source region.
+        const XMVECTOR source = LoadRect(sourceRectangle);
+
+        XMStoreFloat4A(&queue.source[sprite], source);
+
+        // If the destination size is relative to the source region, convert it to pixels.
+        if (!(flags & DestSizeInPixels))
+        {
+            dest = XMVectorPermute<0, 1, 6, 7>(dest, XMVectorMultiply(dest, source)); // dest.zw *= source.zw
+        }
+
+        flags |= SourceInTexels | DestSizeInPixels;
+    }
+    else
+    {
+        // No explicit source region, so use the entire texture.
+        static const XMVECTORF32 wholeTexture = { { { 0, 0, 1, 1 } } };
+
+        XMStoreFloat4A(&queue.source[sprite], wholeTexture);
+    }
+
+    // Store sprite parameters.
+    XMStoreFloat4A(&queue.destination[sprite], dest);
+    XMStoreFloat4A(&queue.color[sprite], color);
+    XMStoreFloat4A(&queue.originRotationDepth[sprite], originRotationDepth);
+
+    queue.texture[sprite] = texture;
+    queue.flags[sprite] = flags;
+}
+
+
+// Makes sure we hold a refcount on a texture until the sprites using it have been drawn.
+_Use_decl_annotations_
+void SpriteBatch::Impl::AddTextureReference(std::vector<ComPtr<ID3D11ShaderResourceView>>& references, ID3D11ShaderResourceView* texture)
+{
+    // Only checking the back of the vector means we will add duplicate references if the caller switches back
+    // and forth between multiple repeated textures, but calling AddRef more times than strictly necessary hurts
+    // nothing, and is faster than scanning the whole list or using a map to detect all duplicates.
+    if (references.empty() || texture != references.back().Get())
+    {
+        references.emplace_back(texture);
+    }
+}
+
+
+// Dynamically expands the arrays used to store pending sprite information.
+void SpriteBatch::Impl::GrowSpriteQueue(SpriteQueue& queue, size_t count, size_t& arraySize, size_t minSize)
+{
+    // Grow by a factor of 2.
+    size_t newSize = std::max(InitialQueueSize, arraySize * 2);
+
+    while (newSize < minSize)
     {
-        newArray[i] = mSpriteQueue[i];
+        newSize *= 2;
     }
 
-    // Replace the previous array with the new one.
-    mSpriteQueue = std::move(newArray);
-    mSpriteQueueArraySize = newSize;
+    if (newSize > UINT32_MAX)
+        throw std::overflow_error("Too many sprites queued");
+
+    // Allocate the new arrays.
+    SpriteQueue newQueue;
+
+    newQueue.source = std::make_unique<SpriteField[]>(newSize);
+    newQueue.destination = std::make_unique<SpriteField[]>(newSize);
+    newQueue.color = std::make_unique<SpriteField[]>(newSize);
+    newQueue.originRotationDepth = std::make_unique<SpriteField[]>(newSize);
+    newQueue.texture = std::make_unique<ID3D11ShaderResourceView*[]>(newSize);
+    newQueue.flags = std::make_unique<unsigned int[]>(newSize);
+
+    // Copy over any existing sprites.
+    CopySprites(queue, newQueue, 0, count);
+
+    // Replace the previous arrays with the new ones.
+    queue = std::move(newQueue);
+    arraySize = newSize;
+}
+
+
+// Copies the first count sprites of one queue to another, starting at slot destStart.
+void SpriteBatch::Impl::CopySprites(SpriteQueue const& source, SpriteQueue& dest, size_t destStart, size_t count)
+{
+    if (!count)
+        return;
+
+    std::copy_n(source.source.get(), count, dest.source.get() + destStart);
+    std::copy_n(source.destination.get(), count, dest.destination.get() + destStart);
+    std::copy_n(source.color.get(), count, dest.color.get() + destStart);
+    std::copy_n(source.originRotationDepth.get(), count, dest.originRotationDepth.get() + destStart);
+    std::copy_n(source.texture.get(), count, dest.texture.get() + destStart);
+    std::copy_n(source.flags.get(), count, dest.flags.get() + destStart);
+}
+
+
+// Appends the sprites recorded by each thread to the main queue. Threads are merged in the order they
+// first drew during this Begin/End pair, each keeping its own submission order, which is the order that
+// SpriteSortMode_Deferred draws in. The sorted modes then reorder the merged queue by key as usual.
+void SpriteBatch::Impl::MergeRecordingSegments()
+{
+    if (!mThreadedRecording)
+        return;
+
+    mRecordingSegments.ForEachActive([&](RecordingSegment& segment)
+        {
+            if (!segment.count)
+                return;
+
+            const size_t total = mSpriteQueueCount + segment.count;
+
+            if (total > mSpriteQueueArraySize)
+            {
+                GrowSpriteQueue(mSpriteQueue, mSpriteQueueCount, mSpriteQueueArraySize, total);
+            }
+
+            CopySprites(segment.queue, mSpriteQueue, mSpriteQueueCount, segment.count);
+
+            mSpriteQueueCount = total;
+
+            mSpriteTextureReferences.insert(mSpriteTextureReferences.end(),
+                std::make_move_iterator(segment.textureReferences.begin()),
+                std::make_move_iterator(segment.textureReferences.end()));
 
-    // Clear any dangling SpriteInfo pointers left over from previous rendering.
-    mSortedSprites.clear();
+            segment.count = 0;
+            segment.textureReferences.clear();
+        });
 }
 
 
 // Sets up D3D device state ready for drawing sprites.
-void SpriteBatch::Impl::PrepareForRendering()
+void SpriteBatch::Impl::PrepareForRendering(bool multiTexture, bool instanced)
 {
     auto deviceContext = mContextResources->deviceContext.Get();
 
@@ -565,26 +1358,73 @@ void SpriteBatch::Impl::PrepareForRendering()
     deviceContext->PSSetSamplers(0, 1, &samplerState);
 
     // Set shaders.
-    deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-    deviceContext->IASetInputLayout(mDeviceResources->inputLayout.Get());
-    deviceContext->VSSetShader(mDeviceResources->vertexShader.Get(), nullptr, 0);
-    deviceContext->PSSetShader(mDeviceResources->pixelShader.Get(), nullptr, 0);
+    mDrawInstanced = instanced;
+
+    if (instanced)
+    {
+        // Each instance is drawn as a four vertex strip, so no index buffer is needed.
+        deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+        deviceContext->IASetInputLayout(mDeviceResources->instancedInputLayout.Get());
+        deviceContext->VSSetShader(mDeviceResources->instancedVertexShader.Get(), nullptr, 0);
+        deviceContext->PSSetShader(mDeviceResources->multiTexturePixelShader.Get(), nullptr, 0);
+
+        if (!mContextResources->instanceBuffer)
+        {
+            mContextResources->CreateInstanceBuffer();
+        }
+    }
+    else if (multiTexture)
+    {
+        deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        deviceContext->IASetInputLayout(mDeviceResources->multiTextureInputLayout.Get());
+        deviceContext->VSSetShader(mDeviceResources->multiTextureVertexShader.Get(), nullptr, 0);
+        deviceContext->PSSetShader(mDeviceResources->multiTexturePixelShader.Get(), nullptr, 0);
+
+        if (!mContextResources->textureSlotBuffer)
+        {
+            mContextResources->CreateTextureSlotBuffer();
+        }
+    }
+    else
+    {
+        deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        deviceContext->IASetInputLayout(mDeviceResources->inputLayout.Get());
+        deviceContext->VSSetShader(mDeviceResources->vertexShader.Get(), nullptr, 0);
+        deviceContext->PSSetShader(mDeviceResources->pixelShader.Get(), nullptr, 0);
+    }
 
     // Set the vertex and index buffer.
 #if !defined(_XBOX_ONE) || !defined(_TITLE)
-    auto vertexBuffer = mContextResources->vertexBuffer.Get();
-    constexpr UINT vertexStride = sizeof(VertexPositionColorTexture);
     constexpr UINT vertexOffset = 0;
 
-    deviceContext->IASetVertexBuffers(0, 1, &vertexBuffer, &vertexStride, &vertexOffset);
+    if (instanced)
+    {
+        auto instanceBuffer = mContextResources->instanceBuffer.Get();
+        constexpr UINT instanceStride = sizeof(SpriteInstance);
+
+        deviceContext->IASetVertexBuffers(0, 1, &instanceBuffer, &instanceStride, &vertexOffset);
+    }
+    else
+    {
+        auto vertexBuffer = mContextResources->vertexBuffer.Get();
+        constexpr UINT vertexStride = sizeof(VertexPositionColorTexture);
+
+        deviceContext->IASetVertexBuffers(0, 1, &vertexBuffer, &vertexStride, &vertexOffset);
+    }
+
+    if (multiTexture && !instanced)
+    {
+        auto slotBuffer = mContextResources->textureSlotBuffer.Get();
+        constexpr UINT slotStride = sizeof(uint8_t);
+
+        deviceContext->IASetVertexBuffers(1, 1, &slotBuffer, &slotStride, &vertexOffset);
+    }
 #endif
 
     deviceContext->IASetIndexBuffer(mDeviceResources->indexBuffer.Get(), DXGI_FORMAT_R16_UINT, 0);
 
     // Set the transform matrix.
-    const XMMATRIX transformMatrix = (mRotation == DXGI_MODE_ROTATION_UNSPECIFIED)
-        ? mTransformMatrix
-        : (mTransformMatrix * GetViewportTransform(deviceContext, mRotation));
+    const XMMATRIX transformMatrix = GetRenderTransform(deviceContext);
 
 #if defined(_XBOX_ONE) && defined(_TITLE)
     void* grfxMemory;
@@ -603,6 +1443,7 @@ void SpriteBatch::Impl::PrepareForRendering()
     if (deviceContext->GetType() == D3D11_DEVICE_CONTEXT_DEFERRED)
     {
         mContextResources->vertexBufferPosition = 0;
+        mContextResources->instanceRing.Reset();
     }
 
     // Hook lets the caller replace our settings with their own custom shaders.
@@ -619,15 +1460,31 @@ void SpriteBatch::Impl::FlushBatch()
     if (!mSpriteQueueCount)
         return;
 
-    SortSprites();
+    mStatistics.spritesQueued += mSpriteQueueCount;
+
+    size_t visibleCount;
+
+    {
+        ScopedStage stage(GetStageTotal(mStatistics.sortTime), GetTraceAnnotation(), L"SpriteBatch Sort");
+
+        SortSprites();
+
+        visibleCount = CullSprites();
+    }
+
+    if (!visibleCount)
+    {
+        ResetQueue();
+        return;
+    }
 
     // Walk through the sorted sprite list, looking for adjacent entries that share a texture.
     ID3D11ShaderResourceView* batchTexture = nullptr;
     size_t batchStart = 0;
 
-    for (size_t pos = 0; pos < mSpriteQueueCount; pos++)
+    for (size_t pos = 0; pos < visibleCount; pos++)
     {
-        ID3D11ShaderResourceView* texture = mSortedSprites[pos]->texture;
+        ID3D11ShaderResourceView* texture = mSpriteQueue.texture[mSortedSprites[pos]];
 
         _Analysis_assume_(texture != nullptr);
 
@@ -636,7 +1493,9 @@ void SpriteBatch::Impl::FlushBatch()
         {
             if (pos > batchStart)
             {
-                RenderBatch(batchTexture, &mSortedSprites[batchStart], pos - batchStart);
+                RenderBatch(&batchTexture, 1, &mSortedSprites[batchStart], nullptr, pos - batchStart);
+
+                mStatistics.textureChanges++;
             }
 
             batchTexture = texture;
@@ -645,412 +1504,1328 @@ void SpriteBatch::Impl::FlushBatch()
     }
 
     // Flush the final batch.
-    RenderBatch(batchTexture, &mSortedSprites[batchStart], mSpriteQueueCount - batchStart);
-
-    // Reset the queue.
-    mSpriteQueueCount = 0;
-    mSpriteTextureReferences.clear();
+    RenderBatch(&batchTexture, 1, &mSortedSprites[batchStart], nullptr, visibleCount - batchStart);
 
-    // When sorting is disabled, we persist mSortedSprites data from one batch to the next, to avoid
-    // uneccessary work in GrowSortedSprites. But we never reuse these when sorting, because re-sorting
-    // previously sorted items gives unstable ordering if some sprites have identical sort keys.
-    if (mSortMode != SpriteSortMode_Deferred)
-    {
-        mSortedSprites.clear();
-    }
+    ResetQueue();
 }
 
 
-// Sorts the array of queued sprites.
-void SpriteBatch::Impl::SortSprites()
+// Sends queued sprites to the graphics device, letting each draw sample from several textures.
+void SpriteBatch::Impl::FlushTextureGroups()
 {
-    // Fill the mSortedSprites vector.
-    if (mSortedSprites.size() < mSpriteQueueCount)
+    if (!mSpriteQueueCount)
+        return;
+
+    mStatistics.spritesQueued += mSpriteQueueCount;
+
+    size_t visibleCount;
+
     {
-        GrowSortedSprites();
+        ScopedStage stage(GetStageTotal(mStatistics.sortTime), GetTraceAnnotation(), L"SpriteBatch Sort");
+
+        SortSprites();
+
+        visibleCount = CullSprites();
     }
 
-    switch (mSortMode)
+    if (mTextureSlots.size() < visibleCount)
     {
-    case SpriteSortMode_Texture:
-        // Sort by texture.
-        std::sort(mSortedSprites.begin(), mSortedSprites.begin() + static_cast<int>(mSpriteQueueCount),
-            [](SpriteInfo const* x, SpriteInfo const* y) noexcept -> bool
-            {
-                return x->texture < y->texture;
-            });
-        break;
+        mTextureSlots.resize(visibleCount);
+    }
 
-    case SpriteSortMode_BackToFront:
-        // Sort back to front.
-        std::sort(mSortedSprites.begin(), mSortedSprites.begin() + static_cast<int>(mSpriteQueueCount),
-            [](SpriteInfo const* x, SpriteInfo const* y) noexcept -> bool
+    // Split the sorted sprites into groups that fit in the available texture slots, without reordering them.
+    TextureGrouper::Build(visibleCount,
+        mMaxTexturesPerBatch,
+        [&](size_t pos) { return mSpriteQueue.texture[mSortedSprites[pos]]; },
+        mTextureSlots.data(),
+        [&](TextureGrouper::Group const& group)
+        {
+            // Every group after the first was started because all its predecessor's texture slots were in use.
+            if (group.firstSprite > 0)
             {
-                return x->originRotationDepth.w > y->originRotationDepth.w;
-            });
-        break;
+                mStatistics.textureChanges++;
+            }
 
-    case SpriteSortMode_FrontToBack:
-        // Sort front to back.
-        std::sort(mSortedSprites.begin(), mSortedSprites.begin() + static_cast<int>(mSpriteQueueCount),
-            [](SpriteInfo const* x, SpriteInfo const* y) noexcept -> bool
-            {
-                return x->originRotationDepth.w < y->originRotationDepth.w;
-            });
-        break;
+            RenderBatch(group.textures, group.textureCount, &mSortedSprites[group.firstSprite], &mTextureSlots[group.firstSprite], group.spriteCount);
+        });
 
-    default:
-        break;
-    }
+    ResetQueue();
 }
 
 
-// Populates the mSortedSprites vector with pointers to individual elements of the mSpriteQueue array.
-void SpriteBatch::Impl::GrowSortedSprites()
+// Empties the queue once its sprites have been drawn or captured.
+void SpriteBatch::Impl::ResetQueue()
 {
-    const size_t previousSize = mSortedSprites.size();
-
-    mSortedSprites.resize(mSpriteQueueCount);
+    mSpriteQueueCount = 0;
+    mSpriteTextureReferences.clear();
+    mTextureSizes.Clear();
 
-    for (size_t i = previousSize; i < mSpriteQueueCount; i++)
+    // When sorting is disabled, we persist mSortedSprites data from one batch to the next, to avoid
+    // uneccessary work in GrowSortedSprites. Sorted batches overwrite the whole array with the radix
+    // sort output, and culling compacts it, so it no longer holds the identity order that
+    // GrowSortedSprites relies on.
+    if (mSortMode != SpriteSortMode_Deferred || mCulledSpriteCount > 0)
     {
-        mSortedSprites[i] = &mSpriteQueue[i];
+        mSortedSprites.clear();
     }
 }
 
 
-// Submits a batch of sprites to the GPU.
-_Use_decl_annotations_
-void SpriteBatch::Impl::RenderBatch(ID3D11ShaderResourceView* texture, SpriteInfo const* const* sprites, size_t count)
+// Removes sprites that cannot touch the visible region from the front of mSortedSprites, keeping the
+// order of the rest, and returns how many remain.
+size_t SpriteBatch::Impl::CullSprites()
 {
-    auto deviceContext = mContextResources->deviceContext.Get();
+    if (!mCulling)
+        return mSpriteQueueCount;
 
-    // Draw using the specified texture.
-    deviceContext->PSSetShaderResources(0, 1, &texture);
+    XMMATRIX viewportTransform;
+    const XMMATRIX transform = GetRenderTransform(mContextResources->deviceContext.Get(), &viewportTransform);
 
-    const XMVECTOR textureSize = GetTextureSize(texture);
-    const XMVECTOR inverseTextureSize = XMVectorReciprocal(textureSize);
+    // The visible region in clip space, optionally narrowed by the clip rectangle.
+    XMVECTOR region = XMVectorSet(-1, -1, 1, 1);
 
-    while (count > 0)
+    if (mUseClipRectangle)
     {
-        // How many sprites do we want to draw?
-        size_t batchSize = count;
+        const XMVECTOR topLeft = XMVector2Transform(XMVectorSet(float(mClipRectangle.left), float(mClipRectangle.top), 0, 0), viewportTransform);
+        const XMVECTOR bottomRight = XMVector2Transform(XMVectorSet(float(mClipRectangle.right), float(mClipRectangle.bottom), 0, 0), viewportTransform);
 
-        // How many sprites does the D3D vertex buffer have room for?
-        const size_t remainingSpace = MaxBatchSize - mContextResources->vertexBufferPosition;
+        // Viewport rotation can swap or flip the axes, so take the bounds of the transformed corners.
+        const XMVECTOR clipMin = XMVectorMin(topLeft, bottomRight);
+        const XMVECTOR clipMax = XMVectorMax(topLeft, bottomRight);
 
-        if (batchSize > remainingSpace)
+        region = XMVectorPermute<0, 1, 6, 7>(XMVectorMax(region, clipMin), XMVectorMin(region, XMVectorSwizzle<0, 1, 0, 1>(clipMax)));
+    }
+
+    SpriteCuller culler;
+
+    if (!culler.SetTransform(transform, region))
+        return mSpriteQueueCount;
+
+    // Resolve each sprite's size and origin the same way RenderSprite does, four sprites at a time.
+    XMFLOAT4A rects[4];
+    XMFLOAT4A originRotationDepth[4];
+
+    size_t visibleCount = 0;
+
+    for (size_t pos = 0; pos < mSpriteQueueCount; pos += 4)
+    {
+        const size_t count = std::min<size_t>(4, mSpriteQueueCount - pos);
+
+        for (size_t i = 0; i < 4; i++)
         {
-            if (remainingSpace < MinBatchSize)
+            // Pad a partial final group by repeating its first sprite.
+            const uint32_t sprite = mSortedSprites[pos + (i < count ? i : 0)];
+
+            const XMVECTOR source = XMLoadFloat4A(&mSpriteQueue.source[sprite]);
+            const XMVECTOR destination = XMLoadFloat4A(&mSpriteQueue.destination[sprite]);
+            const XMVECTOR ord = XMLoadFloat4A(&mSpriteQueue.originRotationDepth[sprite]);
+            const unsigned int flags = mSpriteQueue.flags[sprite];
+
+            XMVECTOR sourceSize = XMVectorSwizzle<2, 3, 2, 3>(source);
+            XMVECTOR destinationSize = XMVectorSwizzle<2, 3, 2, 3>(destination);
+
+            if ((flags & (SourceInTexels | DestSizeInPixels)) != (SourceInTexels | DestSizeInPixels))
             {
-                // If we are out of room, or about to submit an excessively small batch, wrap back to the start of the vertex buffer.
-                mContextResources->vertexBufferPosition = 0;
+                const XMVECTOR textureSize = LookupTextureSize(mSpriteQueue.texture[sprite]);
 
-                batchSize = std::min(count, MaxBatchSize);
+                if (!(flags & SourceInTexels))
+                {
+                    sourceSize = textureSize;
+                }
+
+                if (!(flags & DestSizeInPixels))
+                {
+                    destinationSize = XMVectorMultiply(destinationSize, textureSize);
+                }
             }
-            else
+
+            const XMVECTOR isZeroMask = XMVectorEqual(sourceSize, XMVectorZero());
+            const XMVECTOR origin = XMVectorDivide(ord, XMVectorSelect(sourceSize, g_XMEpsilon, isZeroMask));
+
+            XMStoreFloat4A(&rects[i], XMVectorPermute<0, 1, 4, 5>(destination, destinationSize));
+            XMStoreFloat4A(&originRotationDepth[i], XMVectorPermute<0, 1, 6, 7>(origin, ord));
+        }
+
+        static const uint32_t lanes[4] = { 0, 1, 2, 3 };
+
+        const XMMATRIX rectRows = SpriteExpansion::LoadTransposed4(rects, lanes);
+        const XMMATRIX ordRows = SpriteExpansion::LoadTransposed4(originRotationDepth, lanes);
+
+        const unsigned int visible = culler.Test4(rectRows, ordRows);
+
+        // Compact in place. Writes never overtake reads, since at most one sprite is kept per sprite read.
+        for (size_t i = 0; i < count; i++)
+        {
+            if (visible & (1u << i))
             {
-                // Take however many sprites fit in what's left of the vertex buffer.
-                batchSize = remainingSpace;
+                mSortedSprites[visibleCount++] = mSortedSprites[pos + i];
             }
         }
+    }
+
+    mCulledSpriteCount += mSpriteQueueCount - visibleCount;
+
+    return visibleCount;
+}
+
+
+// Sorts the array of queued sprites.
+void SpriteBatch::Impl::SortSprites()
+{
+    if (mSortMode == SpriteSortMode_Deferred || mSortMode == SpriteSortMode_Immediate)
+    {
+        // Fill the mSortedSprites vector.
+        if (mSortedSprites.size() < mSpriteQueueCount)
+        {
+            GrowSortedSprites(mSpriteQueueCount);
+        }
+
+        return;
+    }
+
+    assert(mSpriteQueueCount <= UINT32_MAX);
+
+    if (mSortKeys.size() < mSpriteQueueCount)
+    {
+        mSortKeys.resize(mSpriteQueueCount);
+        mSortScratch.resize(mSpriteQueueCount);
+    }
+
+    size_t keyBytes = sizeof(uint32_t);
+
+    switch (mSortMode)
+    {
+    case SpriteSortMode_Texture:
+        // Sort by texture, in ascending address order.
+        for (size_t i = 0; i < mSpriteQueueCount; i++)
+        {
+            mSortKeys[i] = { reinterpret_cast<uintptr_t>(mSpriteQueue.texture[i]), static_cast<uint32_t>(i) };
+        }
+
+        keyBytes = sizeof(uintptr_t);
+        break;
+
+    case SpriteSortMode_BackToFront:
+        // Sort back to front, by inverting the key so larger depths come first.
+        for (size_t i = 0; i < mSpriteQueueCount; i++)
+        {
+            mSortKeys[i] = { ~RadixSort::FloatToSortableKey(mSpriteQueue.originRotationDepth[i].w), static_cast<uint32_t>(i) };
+        }
+        break;
+
+    case SpriteSortMode_FrontToBack:
+        // Sort front to back.
+        for (size_t i = 0; i < mSpriteQueueCount; i++)
+        {
+            mSortKeys[i] = { RadixSort::FloatToSortableKey(mSpriteQueue.originRotationDepth[i].w), static_cast<uint32_t>(i) };
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    SortSpritesByKey(keyBytes);
+}
+
+
+// Radix sorts the extracted keys, then rebuilds mSortedSprites in sorted order.
+void SpriteBatch::Impl::SortSpritesByKey(size_t keyBytes)
+{
+    SortKey const* sorted = RadixSort::Sort(mSortKeys.data(), mSortScratch.data(), mSpriteQueueCount, keyBytes);
+
+    if (mSortedSprites.size() < mSpriteQueueCount)
+    {
+        mSortedSprites.resize(mSpriteQueueCount);
+    }
+
+    for (size_t i = 0; i < mSpriteQueueCount; i++)
+    {
+        mSortedSprites[i] = sorted[i].index;
+    }
+}
+
+
+// Populates the mSortedSprites vector with the identity order of the first count mSpriteQueue entries.
+void SpriteBatch::Impl::GrowSortedSprites(size_t count)
+{
+    const size_t previousSize = mSortedSprites.size();
+
+    mSortedSprites.resize(count);
+
+    for (size_t i = previousSize; i < count; i++)
+    {
+        mSortedSprites[i] = static_cast<uint32_t>(i);
+    }
+}
+
+
+// Sorts and expands the queued sprites for StaticSpriteBatch, then ends the Begin/End pair.
+void SpriteBatch::Impl::Capture(std::vector<VertexPositionColorTexture>& vertices,
+    std::vector<RetainedBatch>& batches,
+    std::vector<uint32_t>& locations)
+{
+    if (!mInBeginEndPair)
+        throw std::logic_error("Begin must be called before End");
+
+    MergeRecordingSegments();
+
+    vertices.resize(mSpriteQueueCount * VerticesPerSprite);
+    locations.resize(mSpriteQueueCount);
+    batches.clear();
+
+    if (mSpriteQueueCount > 0)
+    {
+        SortSprites();
+
+        // Walk through the sorted sprite list, expanding each run of sprites that share a texture.
+        auto captureBatch = [&](ID3D11ShaderResourceView* texture, size_t start, size_t count)
+        {
+            GenerateBatchVertices(&mSortedSprites[start], count, &vertices[start * VerticesPerSprite]);
+
+            batches.push_back({ texture, start, count });
+        };
+
+        ID3D11ShaderResourceView* batchTexture = nullptr;
+        size_t batchStart = 0;
+
+        for (size_t pos = 0; pos < mSpriteQueueCount; pos++)
+        {
+            ID3D11ShaderResourceView* texture = mSpriteQueue.texture[mSortedSprites[pos]];
+
+            if (texture != batchTexture)
+            {
+                if (pos > batchStart)
+                {
+                    captureBatch(batchTexture, batchStart, pos - batchStart);
+                }
+
+                batchTexture = texture;
+                batchStart = pos;
+            }
+
+            locations[mSortedSprites[pos]] = static_cast<uint32_t>(pos);
+        }
+
+        captureBatch(batchTexture, batchStart, mSpriteQueueCount - batchStart);
+
+        ResetQueue();
+    }
+
+    mSetCustomShaders = nullptr;
+
+    mInBeginEndPair = false;
+}
+
+
+// Draws sprites previously captured into a vertex buffer, using the shared index buffer with a
+// base vertex offset so the retained buffer can hold any number of sprites.
+_Use_decl_annotations_
+void XM_CALLCONV SpriteBatch::Impl::DrawRetained(ID3D11Buffer* vertexBuffer,
+    RetainedBatch const* batches,
+    size_t batchCount,
+    ID3D11BlendState* blendState,
+    ID3D11SamplerState* samplerState,
+    ID3D11DepthStencilState* depthStencilState,
+    ID3D11RasterizerState* rasterizerState,
+    const std::function<void()>& setCustomShaders,
+    FXMMATRIX transformMatrix)
+{
+    if (mInBeginEndPair)
+        throw std::logic_error("Cannot render a StaticSpriteBatch while recording it");
+
+    if (mContextResources->inImmediateMode)
+        throw std::logic_error("Cannot render a StaticSpriteBatch while a SpriteBatch is using SpriteSortMode_Immediate");
+
+    mBlendState = blendState;
+    mSamplerState = samplerState;
+    mDepthStencilState = depthStencilState;
+    mRasterizerState = rasterizerState;
+    mSetCustomShaders = setCustomShaders;
+    mTransformMatrix = transformMatrix;
+
+    PrepareForRendering(false, false);
+
+    auto deviceContext = mContextResources->deviceContext.Get();
+
+    constexpr UINT vertexStride = sizeof(VertexPositionColorTexture);
+    constexpr UINT vertexOffset = 0;
+
+    deviceContext->IASetVertexBuffers(0, 1, &vertexBuffer, &vertexStride, &vertexOffset);
+
+    for (size_t i = 0; i < batchCount; i++)
+    {
+        ID3D11ShaderResourceView* texture = batches[i].texture.Get();
+
+        deviceContext->PSSetShaderResources(0, 1, &texture);
+
+        // The shared index buffer only covers MaxBatchSize sprites, so large runs are split.
+        for (size_t offset = 0; offset < batches[i].spriteCount; offset += MaxBatchSize)
+        {
+            const size_t batchSize = std::min(batches[i].spriteCount - offset, MaxBatchSize);
+
+            auto const indexCount = static_cast<UINT>(batchSize * IndicesPerSprite);
+            auto const baseVertex = static_cast<INT>((batches[i].firstSprite + offset) * VerticesPerSprite);
+
+            deviceContext->DrawIndexed(indexCount, 0, baseVertex);
+        }
+    }
+
+    mSetCustomShaders = nullptr;
+}
+
+
+// Submits a batch of sprites to the GPU. When textureSlots is not null, the batch draws from
+// several textures, and each sprite's slot within the textures array is written per vertex.
+_Use_decl_annotations_
+void SpriteBatch::Impl::RenderBatch(ID3D11ShaderResourceView* const* textures,
+    size_t textureCount,
+    uint32_t const* sprites,
+    uint8_t const* textureSlots,
+    size_t count)
+{
+    auto deviceContext = mContextResources->deviceContext.Get();
+
+    ScopedStage stage(GetStageTotal(mStatistics.renderTime), GetTraceAnnotation(), L"SpriteBatch Submit");
+
+    // Draw using the specified textures.
+    deviceContext->PSSetShaderResources(0, static_cast<UINT>(textureCount), textures);
+
+    if (mDrawInstanced)
+    {
+        RenderInstances(sprites, textureSlots, count);
+        return;
+    }
+
+    while (count > 0)
+    {
+        // How many sprites do we want to draw? The shared index buffer only covers MaxBatchSize sprites.
+        size_t batchSize = std::min(count, MaxBatchSize);
+
+        // How many sprites does the D3D vertex buffer have room for?
+        const size_t remainingSpace = mContextResources->vertexRing.GetCapacity() - mContextResources->vertexBufferPosition;
+
+        if (batchSize > remainingSpace)
+        {
+            if (remainingSpace < MinBatchSize)
+            {
+                // If we are out of room, or about to submit an excessively small batch, wrap back to the start of the vertex buffer.
+                if (mContextResources->vertexBufferPosition > 0)
+                {
+                    mStatistics.bufferWraps++;
+                    mContextResources->intervalWraps++;
+                }
+
+                mContextResources->vertexBufferPosition = 0;
+
+                batchSize = std::min(count, MaxBatchSize);
+            }
+            else
+            {
+                // Take however many sprites fit in what's left of the vertex buffer.
+                batchSize = remainingSpace;
+            }
+        }
+
+    #if defined(_XBOX_ONE) && defined(_TITLE)
+        void *grfxMemory = GraphicsMemory::Get().Allocate(deviceContext, sizeof(VertexPositionColorTexture) * batchSize * VerticesPerSprite, 64);
+
+        auto vertices = static_cast<VertexPositionColorTexture*>(grfxMemory);
+    #else
+            // Lock the vertex buffer.
+        const D3D11_MAP mapType = (mContextResources->vertexBufferPosition == 0) ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE;
+
+        D3D11_MAPPED_SUBRESOURCE mappedBuffer;
+
+        ThrowIfFailed(
+            deviceContext->Map(mContextResources->vertexBuffer.Get(), 0, mapType, 0, &mappedBuffer)
+        );
+
+        auto vertices = static_cast<VertexPositionColorTexture*>(mappedBuffer.pData) + mContextResources->vertexBufferPosition * VerticesPerSprite;
+    #endif
+
+            // Generate sprite vertex data.
+        assert(batchSize <= count);
+
+        {
+            ScopedStage expand(GetStageTotal(mStatistics.expandTime), GetTraceAnnotation(), L"SpriteBatch Expand");
+
+            GenerateBatchVertices(sprites, batchSize, vertices);
+        }
+
+        mStatistics.bytesMapped += sizeof(VertexPositionColorTexture) * batchSize * VerticesPerSprite;
+
+    #if defined(_XBOX_ONE) && defined(_TITLE)
+        deviceContext->IASetPlacementVertexBuffer(0, mContextResources->vertexBuffer.Get(), grfxMemory, sizeof(VertexPositionColorTexture));
+    #else
+        deviceContext->Unmap(mContextResources->vertexBuffer.Get(), 0);
+    #endif
+
+        // Write the texture slot of each vertex, which is the same for all four corners of a sprite.
+        if (textureSlots)
+        {
+        #if defined(_XBOX_ONE) && defined(_TITLE)
+            void *slotMemory = GraphicsMemory::Get().Allocate(deviceContext, sizeof(uint8_t) * batchSize * VerticesPerSprite, 64);
+
+            auto slots = static_cast<uint8_t*>(slotMemory);
+        #else
+            ThrowIfFailed(
+                deviceContext->Map(mContextResources->textureSlotBuffer.Get(), 0, mapType, 0, &mappedBuffer)
+            );
+
+            auto slots = static_cast<uint8_t*>(mappedBuffer.pData) + mContextResources->vertexBufferPosition * VerticesPerSprite;
+        #endif
+
+            for (size_t i = 0; i < batchSize; i++)
+            {
+                memset(slots + i * VerticesPerSprite, textureSlots[i], VerticesPerSprite);
+            }
+
+            mStatistics.bytesMapped += sizeof(uint8_t) * batchSize * VerticesPerSprite;
+
+        #if defined(_XBOX_ONE) && defined(_TITLE)
+            deviceContext->IASetPlacementVertexBuffer(1, mContextResources->textureSlotBuffer.Get(), slotMemory, sizeof(uint8_t));
+        #else
+            deviceContext->Unmap(mContextResources->textureSlotBuffer.Get(), 0);
+        #endif
+
+            textureSlots += batchSize;
+        }
+
+            // Ok lads, the time has come for us draw ourselves some sprites! The index buffer is
+            // relative to the first sprite, so the ring position is applied as a base vertex.
+        auto const indexCount = static_cast<UINT>(batchSize * IndicesPerSprite);
+
+        auto const baseVertex = static_cast<INT>(mContextResources->vertexBufferPosition * VerticesPerSprite);
+
+        deviceContext->DrawIndexed(indexCount, 0, baseVertex);
+
+        mStatistics.batchesIssued++;
+        mContextResources->intervalSprites += batchSize;
+
+        // Advance the buffer position.
+    #if !defined(_XBOX_ONE) || !defined(_TITLE)
+        mContextResources->vertexBufferPosition += batchSize;
+    #endif
+
+        sprites += batchSize;
+        count -= batchSize;
+    }
+}
+
+
+// Uploads one instance per sprite and draws them, letting the vertex shader expand the corners.
+_Use_decl_annotations_
+void SpriteBatch::Impl::RenderInstances(uint32_t const* sprites,
+    uint8_t const* textureSlots,
+    size_t count)
+{
+    auto deviceContext = mContextResources->deviceContext.Get();
+
+    while (count > 0)
+    {
+    #if defined(_XBOX_ONE) && defined(_TITLE)
+        const size_t batchSize = std::min(count, MaxInstanceBatchSize);
+        constexpr UINT startInstance = 0;
+
+        void *grfxMemory = GraphicsMemory::Get().Allocate(deviceContext, sizeof(SpriteInstance) * batchSize, 64);
+
+        auto instances = static_cast<SpriteInstance*>(grfxMemory);
+    #else
+        // Find room in the instance buffer, which is only limited by its size since there is no index buffer.
+        auto const span = mContextResources->instanceRing.Reserve(count);
+
+        if (span.wrapped)
+        {
+            mStatistics.bufferWraps++;
+        }
+
+        const size_t batchSize = span.count;
+        auto const startInstance = static_cast<UINT>(span.start);
+
+        const D3D11_MAP mapType = span.discard ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE;
+
+        D3D11_MAPPED_SUBRESOURCE mappedBuffer;
+
+        ThrowIfFailed(
+            deviceContext->Map(mContextResources->instanceBuffer.Get(), 0, mapType, 0, &mappedBuffer)
+        );
+
+        auto instances = static_cast<SpriteInstance*>(mappedBuffer.pData) + span.start;
+    #endif
+
+        {
+            ScopedStage expand(GetStageTotal(mStatistics.expandTime), GetTraceAnnotation(), L"SpriteBatch Expand");
+
+            PackInstances(sprites, textureSlots, batchSize, instances);
+        }
+
+        mStatistics.bytesMapped += sizeof(SpriteInstance) * batchSize;
+
+    #if defined(_XBOX_ONE) && defined(_TITLE)
+        deviceContext->IASetPlacementVertexBuffer(0, mContextResources->instanceBuffer.Get(), grfxMemory, sizeof(SpriteInstance));
+    #else
+        deviceContext->Unmap(mContextResources->instanceBuffer.Get(), 0);
+    #endif
+
+        deviceContext->DrawInstanced(static_cast<UINT>(VerticesPerSprite), static_cast<UINT>(batchSize), 0, startInstance);
+
+        mStatistics.batchesIssued++;
+
+        sprites += batchSize;
+        count -= batchSize;
+
+        if (textureSlots)
+        {
+            textureSlots += batchSize;
+        }
+    }
+}
+
+
+// Packs instance data for a run of sorted sprites, which may use several different textures.
+_Use_decl_annotations_
+void SpriteBatch::Impl::PackInstances(uint32_t const* sprites,
+    uint8_t const* textureSlots,
+    size_t count,
+    SpriteInstance* instances)
+{
+    size_t start = 0;
+
+    while (start < count)
+    {
+        // Find the end of this run of sprites that share a texture.
+        ID3D11ShaderResourceView* texture = mSpriteQueue.texture[sprites[start]];
+
+        size_t end = start + 1;
+
+        while (end < count && mSpriteQueue.texture[sprites[end]] == texture)
+        {
+            end++;
+        }
+
+        const XMVECTOR textureSize = LookupTextureSize(texture);
+        const XMVECTOR inverseTextureSize = XMVectorReciprocal(textureSize);
+
+        uint8_t const* runSlots = textureSlots ? textureSlots + start : nullptr;
+
+        if (mParallelVertexGeneration && end - start >= mParallelThreshold)
+        {
+            WorkerPool::Get().ParallelFor(end - start, ParallelChunkSize, [&](size_t begin, size_t finish) noexcept
+                {
+                    SpriteExpansion::PackSprites(mSpriteQueue, sprites + start + begin, runSlots ? runSlots + begin : nullptr, finish - begin, instances + start + begin, textureSize, inverseTextureSize);
+                });
+        }
+        else
+        {
+            SpriteExpansion::PackSprites(mSpriteQueue, sprites + start, runSlots, end - start, instances + start, textureSize, inverseTextureSize);
+        }
+
+        start = end;
+    }
+}
+
+
+// Generates vertex data for a run of sorted sprites, which may use several different textures.
+_Use_decl_annotations_
+void SpriteBatch::Impl::GenerateBatchVertices(uint32_t const* sprites,
+    size_t count,
+    VertexPositionColorTexture* vertices)
+{
+    size_t start = 0;
+
+    while (start < count)
+    {
+        // Find the end of this run of sprites that share a texture.
+        ID3D11ShaderResourceView* texture = mSpriteQueue.texture[sprites[start]];
+
+        size_t end = start + 1;
+
+        while (end < count && mSpriteQueue.texture[sprites[end]] == texture)
+        {
+            end++;
+        }
+
+        const XMVECTOR textureSize = LookupTextureSize(texture);
+        const XMVECTOR inverseTextureSize = XMVectorReciprocal(textureSize);
+
+        GenerateVertices(sprites + start, end - start, vertices + start * VerticesPerSprite, textureSize, inverseTextureSize);
+
+        start = end;
+    }
+}
+
+
+// Returns the size of a texture, querying the texture only the first time it is seen in a batch.
+XMVECTOR SpriteBatch::Impl::LookupTextureSize(_In_ ID3D11ShaderResourceView* texture)
+{
+    // Immediate mode holds no references on its textures, so caching could return the
+    // size of a released texture whose address has since been reused.
+    if (mSortMode == SpriteSortMode_Immediate)
+        return GetTextureSize(texture);
+
+    XMFLOAT2 const& size = mTextureSizes.Get(texture, [](ID3D11ShaderResourceView* t)
+        {
+            XMFLOAT2 result;
+            XMStoreFloat2(&result, GetTextureSize(t));
+            return result;
+        });
+
+    return XMLoadFloat2(&size);
+}
+
+
+// Generates vertex data for a run of sprites that share a texture, splitting large runs across
+// worker threads that each write their own disjoint range of the output.
+_Use_decl_annotations_
+void XM_CALLCONV SpriteBatch::Impl::GenerateVertices(uint32_t const* sprites,
+    size_t count,
+    VertexPositionColorTexture* vertices,
+    FXMVECTOR textureSize,
+    FXMVECTOR inverseTextureSize)
+{
+    if (mParallelVertexGeneration && count >= mParallelThreshold)
+    {
+        WorkerPool::Get().ParallelFor(count, ParallelChunkSize, [&](size_t begin, size_t end) noexcept
+            {
+                SpriteExpansion::RenderSprites(mSpriteQueue, sprites + begin, end - begin, vertices + begin * VerticesPerSprite, textureSize, inverseTextureSize);
+            });
+    }
+    else
+    {
+        SpriteExpansion::RenderSprites(mSpriteQueue, sprites, count, vertices, textureSize, inverseTextureSize);
+    }
+}
+
+
+// Helper looks up the size of the specified texture.
+XMVECTOR SpriteBatch::Impl::GetTextureSize(_In_ ID3D11ShaderResourceView* texture)
+{
+    // Convert resource view to underlying resource.
+    ComPtr<ID3D11Resource> resource;
+
+    texture->GetResource(&resource);
+
+    // Cast to texture.
+    ComPtr<ID3D11Texture2D> texture2D;
+
+    if (FAILED(resource.As(&texture2D)))
+    {
+        throw std::invalid_argument("SpriteBatch can only draw Texture2D resources");
+    }
+
+    // Query the texture size.
+    D3D11_TEXTURE2D_DESC desc;
+
+    texture2D->GetDesc(&desc);
+
+    // Convert to vector format.
+    const XMVECTOR size = XMVectorMergeXY(
+        XMLoadInt(&desc.Width),
+        XMLoadInt(&desc.Height));
+
+    return XMConvertVectorUIntToFloat(size, 0);
+}
+
+
+// Combines the user transform with the viewport transform, giving the matrix that maps sprite coordinates to clip space.
+_Use_decl_annotations_
+XMMATRIX SpriteBatch::Impl::GetRenderTransform(ID3D11DeviceContext* deviceContext, XMMATRIX* viewportTransform)
+{
+    const XMMATRIX viewport = (mRotation == DXGI_MODE_ROTATION_UNSPECIFIED)
+        ? XMMatrixIdentity()
+        : GetViewportTransform(deviceContext, mRotation);
+
+    if (viewportTransform)
+    {
+        *viewportTransform = viewport;
+    }
+
+    return (mRotation == DXGI_MODE_ROTATION_UNSPECIFIED) ? mTransformMatrix : (mTransformMatrix * viewport);
+}
+
+
+// Generates a viewport transform matrix for rendering sprites using x-right y-down screen pixel coordinates.
+XMMATRIX SpriteBatch::Impl::GetViewportTransform(_In_ ID3D11DeviceContext* deviceContext, DXGI_MODE_ROTATION rotation)
+{
+    // Look up the current viewport.
+    if (!mSetViewport)
+    {
+        UINT viewportCount = 1;
+
+        deviceContext->RSGetViewports(&viewportCount, &mViewPort);
+
+        if (viewportCount != 1)
+            throw std::runtime_error("No viewport is set");
+    }
+
+    // Compute the matrix.
+    const float xScale = (mViewPort.Width > 0) ? 2.0f / mViewPort.Width : 0.0f;
+    const float yScale = (mViewPort.Height > 0) ? 2.0f / mViewPort.Height : 0.0f;
+
+    switch (rotation)
+    {
+    case DXGI_MODE_ROTATION_ROTATE90:
+        return XMMATRIX
+        (
+            0, -yScale, 0, 0,
+            -xScale, 0, 0, 0,
+            0, 0, 1, 0,
+            1, 1, 0, 1
+        );
+
+    case DXGI_MODE_ROTATION_ROTATE270:
+        return XMMATRIX
+        (
+            0, yScale, 0, 0,
+            xScale, 0, 0, 0,
+            0, 0, 1, 0,
+            -1, -1, 0, 1
+        );
+
+    case DXGI_MODE_ROTATION_ROTATE180:
+        return XMMATRIX
+        (
+            -xScale, 0, 0, 0,
+            0, yScale, 0, 0,
+            0, 0, 1, 0,
+            1, -1, 0, 1
+        );
+
+    default:
+        return XMMATRIX
+        (
+            xScale, 0, 0, 0,
+            0, -yScale, 0, 0,
+            0, 0, 1, 0,
+            -1, 1, 0, 1
+        );
+    }
+}
+
+
+// Public constructor.
+SpriteBatch::SpriteBatch(_In_ ID3D11DeviceContext* deviceContext)
+    : pImpl(std::make_unique<Impl>(deviceContext))
+{
+}
+
+
+SpriteBatch::SpriteBatch(SpriteBatch&&) noexcept = default;
+SpriteBatch& SpriteBatch::operator= (SpriteBatch&&) noexcept = default;
+SpriteBatch::~SpriteBatch() = default;
+
+
+_Use_decl_annotations_
+void XM_CALLCONV SpriteBatch::Begin(SpriteSortMode sortMode,
+    ID3D11BlendState* blendState,
+    ID3D11SamplerState* samplerState,
+    ID3D11DepthStencilState* depthStencilState,
+    ID3D11RasterizerState* rasterizerState,
+    std::function<void()> setCustomShaders,
+    FXMMATRIX transformMatrix)
+{
+    pImpl->Begin(sortMode, blendState, samplerState, depthStencilState, rasterizerState, setCustomShaders, transformMatrix);
+}
+
+
+void SpriteBatch::End()
+{
+    pImpl->End();
+}
+
+
+_Use_decl_annotations_
+void XM_CALLCONV SpriteBatch::Draw(ID3D11ShaderResourceView* texture, XMFLOAT2 const& position, FXMVECTOR color)
+{
+    const XMVECTOR destination = XMVectorPermute<0, 1, 4, 5>(XMLoadFloat2(&position), g_XMOne); // x, y, 1, 1
+
+    pImpl->Draw(texture, destination, nullptr, color, g_XMZero, 0);
+}
+
+
+_Use_decl_annotations_
+void XM_CALLCONV SpriteBatch::Draw(ID3D11ShaderResourceView* texture,
+    XMFLOAT2 const& position,
+    RECT const* sourceRectangle,
+    FXMVECTOR color,
+    float rotation,
+    XMFLOAT2 const& origin,
+    float scale,
+    SpriteEffects effects,
+    float layerDepth)
+{
+    const XMVECTOR destination = XMVectorPermute<0, 1, 4, 4>(XMLoadFloat2(&position), XMLoadFloat(&scale)); // x, y, scale, scale
+
+    const XMVECTOR originRotationDepth = XMVectorSet(origin.x, origin.y, rotation, layerDepth);
+
+    pImpl->Draw(texture, destination, sourceRectangle, color, originRotationDepth, static_cast<unsigned int>(effects));
+}
+
+
+_Use_decl_annotations_
+void XM_CALLCONV SpriteBatch::Draw(ID3D11ShaderResourceView* texture,
+    XMFLOAT2 const& position,
+    RECT const* sourceRectangle,
+    FXMVECTOR color,
+    float rotation,
+    XMFLOAT2 const& origin,
+    XMFLOAT2 const& scale,
+    SpriteEffects effects,
+    float layerDepth)
+{
+    const XMVECTOR destination = XMVectorPermute<0, 1, 4, 5>(XMLoadFloat2(&position), XMLoadFloat2(&scale)); // x, y, scale.x, scale.y
+
+    const XMVECTOR originRotationDepth = XMVectorSet(origin.x, origin.y, rotation, layerDepth);
+
+    pImpl->Draw(texture, destination, sourceRectangle, color, originRotationDepth, static_cast<unsigned int>(effects));
+}
+
+
+_Use_decl_annotations_
+void XM_CALLCONV SpriteBatch::Draw(ID3D11ShaderResourceView* texture, FXMVECTOR position, FXMVECTOR color)
+{
+    const XMVECTOR destination = XMVectorPermute<0, 1, 4, 5>(position, g_XMOne); // x, y, 1, 1
+
+    pImpl->Draw(texture, destination, nullptr, color, g_XMZero, 0);
+}
+
+
+_Use_decl_annotations_
+void XM_CALLCONV SpriteBatch::Draw(ID3D11ShaderResourceView* texture,
+    FXMVECTOR position,
+    RECT const* sourceRectangle,
+    FXMVECTOR color,
+    float rotation,
+    FXMVECTOR origin,
+    float scale,
+    SpriteEffects effects,
+    float layerDepth)
+{
+    const XMVECTOR destination = XMVectorPermute<0, 1, 4, 4>(position, XMLoadFloat(&scale)); // x, y, scale, scale
+
+    const XMVECTOR rotationDepth = XMVectorMergeXY(XMVectorReplicate(rotation), XMVectorReplicate(layerDepth));
+
+    const XMVECTOR originRotationDepth = XMVectorPermute<0, 1, 4, 5>(origin, rotationDepth);
+
+    pImpl->Draw(texture, destination, sourceRectangle, color, originRotationDepth, static_cast<unsigned int>(effects));
+}
+
+
+_Use_decl_annotations_
+void XM_CALLCONV SpriteBatch::Draw(ID3D11ShaderResourceView* texture,
+    FXMVECTOR position,
+    RECT const* sourceRectangle,
+    FXMVECTOR color,
+    float rotation,
+    FXMVECTOR origin,
+    GXMVECTOR scale,
+    SpriteEffects effects,
+    float layerDepth)
+{
+    const XMVECTOR destination = XMVectorPermute<0, 1, 4, 5>(position, scale); // x, y, scale.x, scale.y
+
+    const XMVECTOR rotationDepth = XMVectorMergeXY(XMVectorReplicate(rotation), XMVectorReplicate(layerDepth));
+
+    const XMVECTOR originRotationDepth = XMVectorPermute<0, 1, 4, 5>(origin, rotationDepth);
+
+    pImpl->Draw(texture, destination, sourceRectangle, color, originRotationDepth, static_cast<unsigned int>(effects));
+}
+
+
+_Use_decl_annotations_
+void XM_CALLCONV SpriteBatch::Draw(ID3D11ShaderResourceView* texture, RECT const& destinationRectangle, FXMVECTOR color)
+{
+    const XMVECTOR destination = LoadRect(&destinationRectangle); // x, y, w, h
+
+    pImpl->Draw(texture, destination, nullptr, color, g_XMZero, Impl::DestSizeInPixels);
+}
+
+
+_Use_decl_annotations_
+void XM_CALLCONV SpriteBatch::Draw(ID3D11ShaderResourceView* texture,
+    RECT const& destinationRectangle,
+    RECT const* sourceRectangle,
+    FXMVECTOR color,
+    float rotation,
+    XMFLOAT2 const& origin,
+    SpriteEffects effects,
+    float layerDepth)
+{
+    const XMVECTOR destination = LoadRect(&destinationRectangle); // x, y, w, h
+
+    const XMVECTOR originRotationDepth = XMVectorSet(origin.x, origin.y, rotation, layerDepth);
+
+    pImpl->Draw(texture, destination, sourceRectangle, color, originRotationDepth, static_cast<unsigned int>(effects) | Impl::DestSizeInPixels);
+}
+
+
+_Use_decl_annotations_
+void XM_CALLCONV SpriteBatch::DrawRun(ID3D11ShaderResourceView* texture,
+    SpriteRunElement const* elements,
+    size_t count,
+    FXMVECTOR color,
+    float rotation,
+    FXMVECTOR scale,
+    SpriteEffects effects,
+    float layerDepth)
+{
+    const XMVECTOR rotationDepth = XMVectorMergeXY(XMVectorReplicate(rotation), XMVectorReplicate(layerDepth));
+
+    pImpl->DrawRun(texture, elements, count, color, scale, rotationDepth, static_cast<unsigned int>(effects));
+}
+
+
+void SpriteBatch::SetRotation(DXGI_MODE_ROTATION mode)
+{
+    pImpl->mRotation = mode;
+}
+
+
+DXGI_MODE_ROTATION SpriteBatch::GetRotation() const noexcept
+{
+    return pImpl->mRotation;
+}
+
+
+void SpriteBatch::SetViewport(const D3D11_VIEWPORT& viewPort)
+{
+    pImpl->mSetViewport = true;
+    pImpl->mViewPort = viewPort;
+}
+
+
+void SpriteBatch::SetParallelVertexGeneration(bool enable, size_t threshold) noexcept
+{
+    pImpl->mParallelVertexGeneration = enable;
+    pImpl->mParallelThreshold = threshold;
+}
+
+
+void SpriteBatch::SetMaxTexturesPerBatch(size_t count)
+{
+    pImpl->SetMaxTexturesPerBatch(count);
+}
+
+
+void SpriteBatch::SetThreadedRecording(bool enable)
+{
+    pImpl->SetThreadedRecording(enable);
+}
+
+
+void SpriteBatch::SetInstancedRendering(bool enable)
+{
+    pImpl->SetInstancedRendering(enable);
+}
+
+
+SpriteBatchStatistics SpriteBatch::GetStatistics() const noexcept
+{
+    return pImpl->GetStatistics();
+}
+
+
+void SpriteBatch::SetTraceEvents(bool enable) noexcept
+{
+    pImpl->mTraceEvents = enable;
+}
+
+
+void SpriteBatch::SetStageTiming(bool enable) noexcept
+{
+    pImpl->mStageTiming = enable;
+}
+
+
+_Use_decl_annotations_
+void SpriteBatch::SetCulling(bool enable, RECT const* clipRectangle) noexcept
+{
+    pImpl->mCulling = enable;
+    pImpl->mUseClipRectangle = (clipRectangle != nullptr);
+    pImpl->mClipRectangle = clipRectangle ? *clipRectangle : RECT{};
+}
+
+
+size_t SpriteBatch::GetCulledSpriteCount() const noexcept
+{
+    return pImpl->mCulledSpriteCount;
+}
+
+
+//======================================================================================
+// StaticSpriteBatch
+//======================================================================================
+
+// Internal StaticSpriteBatch implementation class. Sprites are recorded through an ordinary
+// SpriteBatch, whose implementation also does the sorting, vertex expansion and drawing.
+struct StaticSpriteBatch::Impl
+{
+    explicit Impl(_In_ ID3D11DeviceContext* deviceContext);
+
+    void Begin(SpriteSortMode sortMode);
+    void BeginUpdate(size_t firstSprite);
+    void End();
 
-    #if defined(_XBOX_ONE) && defined(_TITLE)
-        void *grfxMemory = GraphicsMemory::Get().Allocate(deviceContext, sizeof(VertexPositionColorTexture) * batchSize * VerticesPerSprite, 64);
+    void XM_CALLCONV Render(FXMMATRIX transformMatrix,
+        _In_opt_ ID3D11BlendState* blendState,
+        _In_opt_ ID3D11SamplerState* samplerState,
+        _In_opt_ ID3D11DepthStencilState* depthStencilState,
+        _In_opt_ ID3D11RasterizerState* rasterizerState,
+        const std::function<void()>& setCustomShaders);
 
-        auto vertices = static_cast<VertexPositionColorTexture*>(grfxMemory);
-    #else
-            // Lock the vertex buffer.
-        const D3D11_MAP mapType = (mContextResources->vertexBufferPosition == 0) ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE;
+    size_t GetSpriteCount() const noexcept { return mLocations.size(); }
 
-        D3D11_MAPPED_SUBRESOURCE mappedBuffer;
+    SpriteBatch mRecorder;
 
-        ThrowIfFailed(
-            deviceContext->Map(mContextResources->vertexBuffer.Get(), 0, mapType, 0, &mappedBuffer)
-        );
+private:
+    using RetainedBatch = SpriteBatch::Impl::RetainedBatch;
 
-        auto vertices = static_cast<VertexPositionColorTexture*>(mappedBuffer.pData) + mContextResources->vertexBufferPosition * VerticesPerSprite;
-    #endif
+    static constexpr size_t VerticesPerSprite = 4;
 
-            // Generate sprite vertex data.
-        for (size_t i = 0; i < batchSize; i++)
-        {
-            assert(i < count);
-            _Analysis_assume_(i < count);
-            RenderSprite(sprites[i], vertices, textureSize, inverseTextureSize);
+    void CreateVertexBuffer();
+    void ApplyUpdate();
 
-            vertices += VerticesPerSprite;
-        }
+    ComPtr<ID3D11DeviceContext> mDeviceContext;
+    ComPtr<ID3D11Buffer> mVertexBuffer;
 
-    #if defined(_XBOX_ONE) && defined(_TITLE)
-        deviceContext->IASetPlacementVertexBuffer(0, mContextResources->vertexBuffer.Get(), grfxMemory, sizeof(VertexPositionColorTexture));
-    #else
-        deviceContext->Unmap(mContextResources->vertexBuffer.Get(), 0);
-    #endif
+    // CPU copy of the vertex buffer contents, in sorted order, so updates can be merged into it.
+    std::vector<VertexPositionColorTexture> mVertices;
+    std::vector<RetainedBatch> mBatches;
 
-            // Ok lads, the time has come for us draw ourselves some sprites!
-        auto const startIndex = static_cast<UINT>(mContextResources->vertexBufferPosition * IndicesPerSprite);
-        auto const indexCount = static_cast<UINT>(batchSize * IndicesPerSprite);
+    // Position of each recorded sprite within the sorted order, and the texture used at each position.
+    std::vector<uint32_t> mLocations;
+    std::vector<ID3D11ShaderResourceView*> mTextures;
 
-        deviceContext->DrawIndexed(indexCount, startIndex, 0);
+    // Sprites captured by BeginUpdate/End, before they are merged into the arrays above.
+    std::vector<VertexPositionColorTexture> mUpdateVertices;
+    std::vector<RetainedBatch> mUpdateBatches;
+    std::vector<uint32_t> mUpdateLocations;
 
-        // Advance the buffer position.
-    #if !defined(_XBOX_ONE) || !defined(_TITLE)
-        mContextResources->vertexBufferPosition += batchSize;
-    #endif
+    bool mInBeginEndPair;
+    bool mUpdating;
+    size_t mUpdateFirstSprite;
+};
 
-        sprites += batchSize;
-        count -= batchSize;
-    }
+
+// Per-StaticSpriteBatch constructor.
+StaticSpriteBatch::Impl::Impl(_In_ ID3D11DeviceContext* deviceContext)
+    : mRecorder(deviceContext),
+    mDeviceContext(deviceContext),
+    mInBeginEndPair(false),
+    mUpdating(false),
+    mUpdateFirstSprite(0)
+{
 }
 
 
-// Generates vertex data for drawing a single sprite.
-_Use_decl_annotations_
-void XM_CALLCONV SpriteBatch::Impl::RenderSprite(SpriteInfo const* sprite,
-    VertexPositionColorTexture* vertices,
-    FXMVECTOR textureSize,
-    FXMVECTOR inverseTextureSize)
+// Begins recording a new set of sprites.
+void StaticSpriteBatch::Impl::Begin(SpriteSortMode sortMode)
 {
-    // Load sprite parameters into SIMD registers.
-    XMVECTOR source = XMLoadFloat4A(&sprite->source);
-    const XMVECTOR destination = XMLoadFloat4A(&sprite->destination);
-    const XMVECTOR color = XMLoadFloat4A(&sprite->color);
-    const XMVECTOR originRotationDepth = XMLoadFloat4A(&sprite->originRotationDepth);
+    if (mInBeginEndPair)
+        throw std::logic_error("Cannot nest Begin calls on a single StaticSpriteBatch");
 
-    const float rotation = sprite->originRotationDepth.z;
-    const unsigned int flags = sprite->flags;
+    if (sortMode == SpriteSortMode_Immediate)
+        throw std::invalid_argument("StaticSpriteBatch does not support SpriteSortMode_Immediate");
 
-    // Extract the source and destination sizes into separate vectors.
-    XMVECTOR sourceSize = XMVectorSwizzle<2, 3, 2, 3>(source);
-    XMVECTOR destinationSize = XMVectorSwizzle<2, 3, 2, 3>(destination);
+    mRecorder.pImpl->Begin(sortMode, nullptr, nullptr, nullptr, nullptr, nullptr, MatrixIdentity);
 
-    // Scale the origin offset by source size, taking care to avoid overflow if the source region is zero.
-    const XMVECTOR isZeroMask = XMVectorEqual(sourceSize, XMVectorZero());
-    const XMVECTOR nonZeroSourceSize = XMVectorSelect(sourceSize, g_XMEpsilon, isZeroMask);
+    mInBeginEndPair = true;
+    mUpdating = false;
+}
 
-    XMVECTOR origin = XMVectorDivide(originRotationDepth, nonZeroSourceSize);
 
-    // Convert the source region from texels to mod-1 texture coordinate format.
-    if (flags & SpriteInfo::SourceInTexels)
-    {
-        source = XMVectorMultiply(source, inverseTextureSize);
-        sourceSize = XMVectorMultiply(sourceSize, inverseTextureSize);
-    }
-    else
-    {
-        origin = XMVectorMultiply(origin, inverseTextureSize);
-    }
+// Begins redrawing recorded sprites in place.
+void StaticSpriteBatch::Impl::BeginUpdate(size_t firstSprite)
+{
+    if (mInBeginEndPair)
+        throw std::logic_error("Cannot nest Begin calls on a single StaticSpriteBatch");
 
-    // If the destination size is relative to the source region, convert it to pixels.
-    if (!(flags & SpriteInfo::DestSizeInPixels))
-    {
-        destinationSize = XMVectorMultiply(destinationSize, textureSize);
-    }
+    if (firstSprite > mLocations.size())
+        throw std::out_of_range("firstSprite is past the end of the recorded sprites");
 
-    // Compute a 2x2 rotation matrix.
-    XMVECTOR rotationMatrix1;
-    XMVECTOR rotationMatrix2;
+    // Updated sprites are captured in the order they are drawn, then scattered to their sorted positions.
+    mRecorder.pImpl->Begin(SpriteSortMode_Deferred, nullptr, nullptr, nullptr, nullptr, nullptr, MatrixIdentity);
 
-    if (rotation != 0)
-    {
-        float sin, cos;
+    mInBeginEndPair = true;
+    mUpdating = true;
+    mUpdateFirstSprite = firstSprite;
+}
+
+
+// Ends recording or updating, and uploads the results to the GPU.
+void StaticSpriteBatch::Impl::End()
+{
+    if (!mInBeginEndPair)
+        throw std::logic_error("Begin must be called before End");
 
-        XMScalarSinCos(&sin, &cos, rotation);
+    mInBeginEndPair = false;
 
-        const XMVECTOR sinV = XMLoadFloat(&sin);
-        const XMVECTOR cosV = XMLoadFloat(&cos);
+    if (mUpdating)
+    {
+        mRecorder.pImpl->Capture(mUpdateVertices, mUpdateBatches, mUpdateLocations);
 
-        rotationMatrix1 = XMVectorMergeXY(cosV, sinV);
-        rotationMatrix2 = XMVectorMergeXY(XMVectorNegate(sinV), cosV);
+        ApplyUpdate();
     }
     else
     {
-        rotationMatrix1 = g_XMIdentityR0;
-        rotationMatrix2 = g_XMIdentityR1;
-    }
+        mRecorder.pImpl->Capture(mVertices, mBatches, mLocations);
 
-    // The four corner vertices are computed by transforming these unit-square positions.
-    static XMVECTORF32 cornerOffsets[VerticesPerSprite] =
-    {
-        { { { 0, 0, 0, 0 } } },
-        { { { 1, 0, 0, 0 } } },
-        { { { 0, 1, 0, 0 } } },
-        { { { 1, 1, 0, 0 } } },
-    };
+        mTextures.resize(mLocations.size());
 
-    // Tricksy alert! Texture coordinates are computed from the same cornerOffsets
-    // table as vertex positions, but if the sprite is mirrored, this table
-    // must be indexed in a different order. This is done as follows:
-    //
-    //    position = cornerOffsets[i]
-    //    texcoord = cornerOffsets[i ^ SpriteEffects]
+        for (auto const& batch : mBatches)
+        {
+            std::fill_n(mTextures.begin() + static_cast<ptrdiff_t>(batch.firstSprite), batch.spriteCount, batch.texture.Get());
+        }
 
-    static_assert(SpriteEffects_FlipHorizontally == 1 &&
-        SpriteEffects_FlipVertically == 2, "If you change these enum values, the mirroring implementation must be updated to match");
+        CreateVertexBuffer();
+    }
+}
 
-    const unsigned int mirrorBits = flags & 3u;
 
-    // Generate the four output vertices.
-    for (size_t i = 0; i < VerticesPerSprite; i++)
-    {
-        // Calculate position.
-        const XMVECTOR cornerOffset = XMVectorMultiply(XMVectorSubtract(cornerOffsets[i], origin), destinationSize);
+// Creates the GPU vertex buffer holding all the recorded sprites. The CPU never maps it, and
+// only writes to it again through UpdateSubresource when a range of sprites is redrawn.
+void StaticSpriteBatch::Impl::CreateVertexBuffer()
+{
+    mVertexBuffer.Reset();
 
-        // Apply 2x2 rotation matrix.
-        const XMVECTOR position1 = XMVectorMultiplyAdd(XMVectorSplatX(cornerOffset), rotationMatrix1, destination);
-        const XMVECTOR position2 = XMVectorMultiplyAdd(XMVectorSplatY(cornerOffset), rotationMatrix2, position1);
+    if (mVertices.empty())
+        return;
 
-        // Set z = depth.
-        const XMVECTOR position = XMVectorPermute<0, 1, 7, 6>(position2, originRotationDepth);
+    const uint64_t sizeInBytes = uint64_t(sizeof(VertexPositionColorTexture)) * mVertices.size();
 
-        // Write position as a Float4, even though VertexPositionColor::position is an XMFLOAT3.
-        // This is faster, and harmless as we are just clobbering the first element of the
-        // following color field, which will immediately be overwritten with its correct value.
-        XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&vertices[i].position), position);
+    if (sizeInBytes > UINT32_MAX)
+        throw std::overflow_error("Too many sprites recorded in StaticSpriteBatch");
 
-        // Write the color.
-        XMStoreFloat4(&vertices[i].color, color);
+    D3D11_BUFFER_DESC vertexBufferDesc = {};
 
-        // Compute and write the texture coordinate.
-        const XMVECTOR textureCoordinate = XMVectorMultiplyAdd(cornerOffsets[static_cast<unsigned int>(i) ^ mirrorBits], sourceSize, source);
+    vertexBufferDesc.ByteWidth = static_cast<UINT>(sizeInBytes);
+    vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+    vertexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
 
-        XMStoreFloat2(&vertices[i].textureCoordinate, textureCoordinate);
-    }
+    D3D11_SUBRESOURCE_DATA vertexDataDesc = { mVertices.data(), 0, 0 };
+
+    ThrowIfFailed(
+        GetDevice(mDeviceContext.Get())->CreateBuffer(&vertexBufferDesc, &vertexDataDesc, &mVertexBuffer)
+    );
+
+    SetDebugObjectName(mVertexBuffer.Get(), "DirectXTK:StaticSpriteBatch");
 }
 
 
-// Helper looks up the size of the specified texture.
-XMVECTOR SpriteBatch::Impl::GetTextureSize(_In_ ID3D11ShaderResourceView* texture)
+// Merges sprites captured by BeginUpdate/End into the retained vertices, then uploads the changed span.
+void StaticSpriteBatch::Impl::ApplyUpdate()
 {
-    // Convert resource view to underlying resource.
-    ComPtr<ID3D11Resource> resource;
+    const size_t count = mUpdateLocations.size();
 
-    texture->GetResource(&resource);
+    if (!count)
+        return;
 
-    // Cast to texture.
-    ComPtr<ID3D11Texture2D> texture2D;
+    if (count > mLocations.size() - mUpdateFirstSprite)
+        throw std::out_of_range("StaticSpriteBatch update extends past the end of the recorded sprites");
 
-    if (FAILED(resource.As(&texture2D)))
+    // Validate every sprite before changing anything, so a failed update leaves the batch intact.
+    for (auto const& batch : mUpdateBatches)
     {
-        throw std::invalid_argument("SpriteBatch can only draw Texture2D resources");
+        for (size_t i = batch.firstSprite; i < batch.firstSprite + batch.spriteCount; i++)
+        {
+            if (mTextures[mLocations[mUpdateFirstSprite + i]] != batch.texture.Get())
+                throw std::invalid_argument("StaticSpriteBatch updates cannot change the texture of a sprite");
+        }
     }
 
-    // Query the texture size.
-    D3D11_TEXTURE2D_DESC desc;
-
-    texture2D->GetDesc(&desc);
+    size_t firstChanged = mLocations.size();
+    size_t lastChanged = 0;
 
-    // Convert to vector format.
-    const XMVECTOR size = XMVectorMergeXY(
-        XMLoadInt(&desc.Width),
-        XMLoadInt(&desc.Height));
+    for (size_t i = 0; i < count; i++)
+    {
+        const size_t location = mLocations[mUpdateFirstSprite + i];
 
-    return XMConvertVectorUIntToFloat(size, 0);
-}
+        std::copy_n(&mUpdateVertices[i * VerticesPerSprite], VerticesPerSprite, &mVertices[location * VerticesPerSprite]);
 
+        firstChanged = std::min(firstChanged, location);
+        lastChanged = std::max(lastChanged, location);
+    }
 
-// Generates a viewport transform matrix for rendering sprites using x-right y-down screen pixel coordinates.
-XMMATRIX SpriteBatch::Impl::GetViewportTransform(_In_ ID3D11DeviceContext* deviceContext, DXGI_MODE_ROTATION rotation)
-{
-    // Look up the current viewport.
-    if (!mSetViewport)
-    {
-        UINT viewportCount = 1;
+    // Sprites are usually updated in small contiguous ranges, so uploading the span covering
+    // every changed sprite is simpler and cheaper than issuing one copy per sprite.
+    constexpr size_t spriteSize = sizeof(VertexPositionColorTexture) * VerticesPerSprite;
 
-        deviceContext->RSGetViewports(&viewportCount, &mViewPort);
+    D3D11_BOX box = {};
 
-        if (viewportCount != 1)
-            throw std::runtime_error("No viewport is set");
-    }
+    box.left = static_cast<UINT>(firstChanged * spriteSize);
+    box.right = static_cast<UINT>((lastChanged + 1) * spriteSize);
+    box.bottom = 1;
+    box.back = 1;
 
-    // Compute the matrix.
-    const float xScale = (mViewPort.Width > 0) ? 2.0f / mViewPort.Width : 0.0f;
-    const float yScale = (mViewPort.Height > 0) ? 2.0f / mViewPort.Height : 0.0f;
+    mDeviceContext->UpdateSubresource(mVertexBuffer.Get(), 0, &box, &mVertices[firstChanged * VerticesPerSprite], 0, 0);
+}
 
-    switch (rotation)
-    {
-    case DXGI_MODE_ROTATION_ROTATE90:
-        return XMMATRIX
-        (
-            0, -yScale, 0, 0,
-            -xScale, 0, 0, 0,
-            0, 0, 1, 0,
-            1, 1, 0, 1
-        );
 
-    case DXGI_MODE_ROTATION_ROTATE270:
-        return XMMATRIX
-        (
-            0, yScale, 0, 0,
-            xScale, 0, 0, 0,
-            0, 0, 1, 0,
-            -1, -1, 0, 1
-        );
+// Draws all the recorded sprites.
+_Use_decl_annotations_
+void XM_CALLCONV StaticSpriteBatch::Impl::Render(FXMMATRIX transformMatrix,
+    ID3D11BlendState* blendState,
+    ID3D11SamplerState* samplerState,
+    ID3D11DepthStencilState* depthStencilState,
+    ID3D11RasterizerState* rasterizerState,
+    const std::function<void()>& setCustomShaders)
+{
+    if (mInBeginEndPair)
+        throw std::logic_error("Cannot render a StaticSpriteBatch while recording it");
 
-    case DXGI_MODE_ROTATION_ROTATE180:
-        return XMMATRIX
-        (
-            -xScale, 0, 0, 0,
-            0, yScale, 0, 0,
-            0, 0, 1, 0,
-            1, -1, 0, 1
-        );
+    if (!mVertexBuffer)
+        return;
 
-    default:
-        return XMMATRIX
-        (
-            xScale, 0, 0, 0,
-            0, -yScale, 0, 0,
-            0, 0, 1, 0,
-            -1, 1, 0, 1
-        );
-    }
+    mRecorder.pImpl->DrawRetained(mVertexBuffer.Get(), mBatches.data(), mBatches.size(),
+        blendState, samplerState, depthStencilState, rasterizerState, setCustomShaders, transformMatrix);
 }
 
 
+// Constants.
+const XMMATRIX StaticSpriteBatch::MatrixIdentity = XMMatrixIdentity();
+const XMFLOAT2 StaticSpriteBatch::Float2Zero(0, 0);
+
+
 // Public constructor.
-SpriteBatch::SpriteBatch(_In_ ID3D11DeviceContext* deviceContext)
+StaticSpriteBatch::StaticSpriteBatch(_In_ ID3D11DeviceContext* deviceContext)
     : pImpl(std::make_unique<Impl>(deviceContext))
 {
 }
 
 
-SpriteBatch::SpriteBatch(SpriteBatch&&) noexcept = default;
-SpriteBatch& SpriteBatch::operator= (SpriteBatch&&) noexcept = default;
-SpriteBatch::~SpriteBatch() = default;
+StaticSpriteBatch::StaticSpriteBatch(StaticSpriteBatch&&) noexcept = default;
+StaticSpriteBatch& StaticSpriteBatch::operator= (StaticSpriteBatch&&) noexcept = default;
+StaticSpriteBatch::~StaticSpriteBatch() = default;
 
 
-_Use_decl_annotations_
-void XM_CALLCONV SpriteBatch::Begin(SpriteSortMode sortMode,
-    ID3D11BlendState* blendState,
-    ID3D11SamplerState* samplerState,
-    ID3D11DepthStencilState* depthStencilState,
-    ID3D11RasterizerState* rasterizerState,
-    std::function<void()> setCustomShaders,
-    FXMMATRIX transformMatrix)
+void StaticSpriteBatch::Begin(SpriteSortMode sortMode)
 {
-    pImpl->Begin(sortMode, blendState, samplerState, depthStencilState, rasterizerState, setCustomShaders, transformMatrix);
+    pImpl->Begin(sortMode);
 }
 
 
-void SpriteBatch::End()
+void StaticSpriteBatch::BeginUpdate(size_t firstSprite)
+{
+    pImpl->BeginUpdate(firstSprite);
+}
+
+
+void StaticSpriteBatch::End()
 {
     pImpl->End();
 }
 
 
 _Use_decl_annotations_
-void XM_CALLCONV SpriteBatch::Draw(ID3D11ShaderResourceView* texture, XMFLOAT2 const& position, FXMVECTOR color)
+void XM_CALLCONV StaticSpriteBatch::Draw(ID3D11ShaderResourceView* texture, XMFLOAT2 const& position, FXMVECTOR color)
 {
-    const XMVECTOR destination = XMVectorPermute<0, 1, 4, 5>(XMLoadFloat2(&position), g_XMOne); // x, y, 1, 1
-
-    pImpl->Draw(texture, destination, nullptr, color, g_XMZero, 0);
+    pImpl->mRecorder.Draw(texture, position, color);
 }
 
 
 _Use_decl_annotations_
-void XM_CALLCONV SpriteBatch::Draw(ID3D11ShaderResourceView* texture,
+void XM_CALLCONV StaticSpriteBatch::Draw(ID3D11ShaderResourceView* texture,
     XMFLOAT2 const& position,
     RECT const* sourceRectangle,
     FXMVECTOR color,
@@ -1060,16 +2835,12 @@ void XM_CALLCONV SpriteBatch::Draw(ID3D11ShaderResourceView* texture,
     SpriteEffects effects,
     float layerDepth)
 {
-    const XMVECTOR destination = XMVectorPermute<0, 1, 4, 4>(XMLoadFloat2(&position), XMLoadFloat(&scale)); // x, y, scale, scale
-
-    const XMVECTOR originRotationDepth = XMVectorSet(origin.x, origin.y, rotation, layerDepth);
-
-    pImpl->Draw(texture, destination, sourceRectangle, color, originRotationDepth, static_cast<unsigned int>(effects));
+    pImpl->mRecorder.Draw(texture, position, sourceRectangle, color, rotation, origin, scale, effects, layerDepth);
 }
 
 
 _Use_decl_annotations_
-void XM_CALLCONV SpriteBatch::Draw(ID3D11ShaderResourceView* texture,
+void XM_CALLCONV StaticSpriteBatch::Draw(ID3D11ShaderResourceView* texture,
     XMFLOAT2 const& position,
     RECT const* sourceRectangle,
     FXMVECTOR color,
@@ -1079,25 +2850,19 @@ void XM_CALLCONV SpriteBatch::Draw(ID3D11ShaderResourceView* texture,
     SpriteEffects effects,
     float layerDepth)
 {
-    const XMVECTOR destination = XMVectorPermute<0, 1, 4, 5>(XMLoadFloat2(&position), XMLoadFloat2(&scale)); // x, y, scale.x, scale.y
-
-    const XMVECTOR originRotationDepth = XMVectorSet(origin.x, origin.y, rotation, layerDepth);
-
-    pImpl->Draw(texture, destination, sourceRectangle, color, originRotationDepth, static_cast<unsigned int>(effects));
+    pImpl->mRecorder.Draw(texture, position, sourceRectangle, color, rotation, origin, scale, effects, layerDepth);
 }
 
 
 _Use_decl_annotations_
-void XM_CALLCONV SpriteBatch::Draw(ID3D11ShaderResourceView* texture, FXMVECTOR position, FXMVECTOR color)
+void XM_CALLCONV StaticSpriteBatch::Draw(ID3D11ShaderResourceView* texture, FXMVECTOR position, FXMVECTOR color)
 {
-    const XMVECTOR destination = XMVectorPermute<0, 1, 4, 5>(position, g_XMOne); // x, y, 1, 1
-
-    pImpl->Draw(texture, destination, nullptr, color, g_XMZero, 0);
+    pImpl->mRecorder.Draw(texture, position, color);
 }
 
 
 _Use_decl_annotations_
-void XM_CALLCONV SpriteBatch::Draw(ID3D11ShaderResourceView* texture,
+void XM_CALLCONV StaticSpriteBatch::Draw(ID3D11ShaderResourceView* texture,
     FXMVECTOR position,
     RECT const* sourceRectangle,
     FXMVECTOR color,
@@ -1107,18 +2872,12 @@ void XM_CALLCONV SpriteBatch::Draw(ID3D11ShaderResourceView* texture,
     SpriteEffects effects,
     float layerDepth)
 {
-    const XMVECTOR destination = XMVectorPermute<0, 1, 4, 4>(position, XMLoadFloat(&scale)); // x, y, scale, scale
-
-    const XMVECTOR rotationDepth = XMVectorMergeXY(XMVectorReplicate(rotation), XMVectorReplicate(layerDepth));
-
-    const XMVECTOR originRotationDepth = XMVectorPermute<0, 1, 4, 5>(origin, rotationDepth);
-
-    pImpl->Draw(texture, destination, sourceRectangle, color, originRotationDepth, static_cast<unsigned int>(effects));
+    pImpl->mRecorder.Draw(texture, position, sourceRectangle, color, rotation, origin, scale, effects, layerDepth);
 }
 
 
 _Use_decl_annotations_
-void XM_CALLCONV SpriteBatch::Draw(ID3D11ShaderResourceView* texture,
+void XM_CALLCONV StaticSpriteBatch::Draw(ID3D11ShaderResourceView* texture,
     FXMVECTOR position,
     RECT const* sourceRectangle,
     FXMVECTOR color,
@@ -1128,27 +2887,19 @@ void XM_CALLCONV SpriteBatch::Draw(ID3D11ShaderResourceView* texture,
     SpriteEffects effects,
     float layerDepth)
 {
-    const XMVECTOR destination = XMVectorPermute<0, 1, 4, 5>(position, scale); // x, y, scale.x, scale.y
-
-    const XMVECTOR rotationDepth = XMVectorMergeXY(XMVectorReplicate(rotation), XMVectorReplicate(layerDepth));
-
-    const XMVECTOR originRotationDepth = XMVectorPermute<0, 1, 4, 5>(origin, rotationDepth);
-
-    pImpl->Draw(texture, destination, sourceRectangle, color, originRotationDepth, static_cast<unsigned int>(effects));
+    pImpl->mRecorder.Draw(texture, position, sourceRectangle, color, rotation, origin, scale, effects, layerDepth);
 }
 
 
 _Use_decl_annotations_
-void XM_CALLCONV SpriteBatch::Draw(ID3D11ShaderResourceView* texture, RECT const& destinationRectangle, FXMVECTOR color)
+void XM_CALLCONV StaticSpriteBatch::Draw(ID3D11ShaderResourceView* texture, RECT const& destinationRectangle, FXMVECTOR color)
 {
-    const XMVECTOR destination = LoadRect(&destinationRectangle); // x, y, w, h
-
-    pImpl->Draw(texture, destination, nullptr, color, g_XMZero, Impl::SpriteInfo::DestSizeInPixels);
+    pImpl->mRecorder.Draw(texture, destinationRectangle, color);
 }
 
 
 _Use_decl_annotations_
-void XM_CALLCONV SpriteBatch::Draw(ID3D11ShaderResourceView* texture,
+void XM_CALLCONV StaticSpriteBatch::Draw(ID3D11ShaderResourceView* texture,
     RECT const& destinationRectangle,
     RECT const* sourceRectangle,
     FXMVECTOR color,
@@ -1157,28 +2908,55 @@ void XM_CALLCONV SpriteBatch::Draw(ID3D11ShaderResourceView* texture,
     SpriteEffects effects,
     float layerDepth)
 {
-    const XMVECTOR destination = LoadRect(&destinationRectangle); // x, y, w, h
+    pImpl->mRecorder.Draw(texture, destinationRectangle, sourceRectangle, color, rotation, origin, effects, layerDepth);
+}
 
-    const XMVECTOR originRotationDepth = XMVectorSet(origin.x, origin.y, rotation, layerDepth);
 
-    pImpl->Draw(texture, destination, sourceRectangle, color, originRotationDepth, static_cast<unsigned int>(effects) | Impl::SpriteInfo::DestSizeInPixels);
+_Use_decl_annotations_
+void XM_CALLCONV StaticSpriteBatch::DrawRun(ID3D11ShaderResourceView* texture,
+    SpriteRunElement const* elements,
+    size_t count,
+    FXMVECTOR color,
+    float rotation,
+    FXMVECTOR scale,
+    SpriteEffects effects,
+    float layerDepth)
+{
+    pImpl->mRecorder.DrawRun(texture, elements, count, color, rotation, scale, effects, layerDepth);
 }
 
 
-void SpriteBatch::SetRotation(DXGI_MODE_ROTATION mode)
+_Use_decl_annotations_
+void XM_CALLCONV StaticSpriteBatch::Render(FXMMATRIX transformMatrix,
+    ID3D11BlendState* blendState,
+    ID3D11SamplerState* samplerState,
+    ID3D11DepthStencilState* depthStencilState,
+    ID3D11RasterizerState* rasterizerState,
+    std::function<void()> setCustomShaders)
 {
-    pImpl->mRotation = mode;
+    pImpl->Render(transformMatrix, blendState, samplerState, depthStencilState, rasterizerState, setCustomShaders);
 }
 
 
-DXGI_MODE_ROTATION SpriteBatch::GetRotation() const noexcept
+size_t StaticSpriteBatch::GetSpriteCount() const noexcept
 {
-    return pImpl->mRotation;
+    return pImpl->GetSpriteCount();
 }
 
 
-void SpriteBatch::SetViewport(const D3D11_VIEWPORT& viewPort)
+void StaticSpriteBatch::SetRotation(DXGI_MODE_ROTATION mode)
 {
-    pImpl->mSetViewport = true;
-    pImpl->mViewPort = viewPort;
+    pImpl->mRecorder.SetRotation(mode);
+}
+
+
+DXGI_MODE_ROTATION StaticSpriteBatch::GetRotation() const noexcept
+{
+    return pImpl->mRecorder.GetRotation();
+}
+
+
+void StaticSpriteBatch::SetViewport(const D3D11_VIEWPORT& viewPort)
+{
+    pImpl->mRecorder.SetViewport(viewPort);
 }
@@ -0,0 +1,114 @@
+//--------------------------------------------------------------------------------------
+// File: SpriteCulling.h
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <DirectXMath.h>
+
+#include <cmath>
+#include <cstdint>
+
+
+namespace DirectX
+{
+    // Conservative visibility test for rotated sprite rectangles. Each sprite is reduced to the
+    // axis aligned bounds of its rotated corners, which are then transformed to clip space and
+    // compared against a rectangular region. Only depends on DirectXMath, so the math can be
+    // tested without a Direct3D device.
+    class SpriteCuller
+    {
+    public:
+        SpriteCuller() noexcept :
+            mTransform{},
+            mRegion{}
+        {
+        }
+
+        // Sets the transform from sprite coordinates to clip space, and the clip space region
+        // (minX, minY, maxX, maxY) that sprites must touch to be kept. Returns false if the
+        // transform is a perspective projection, which this test does not handle.
+        bool XM_CALLCONV SetTransform(FXMMATRIX transform, FXMVECTOR region) noexcept
+        {
+            XMStoreFloat4x4(&mTransform, transform);
+
+            if (mTransform._14 != 0 || mTransform._24 != 0 || mTransform._34 != 0 || !(mTransform._44 > 0))
+                return false;
+
+            // With a constant w, scaling the region avoids dividing every transformed position.
+            XMStoreFloat4(&mRegion, XMVectorScale(region, mTransform._44));
+
+            return true;
+        }
+
+        // Tests four sprites. The rows of rects hold the x, y, width and height of each sprite in
+        // pixels, and the rows of originRotationDepth hold its origin as a fraction of the size,
+        // its rotation and its depth. Bit i of the result is set if sprite i may be visible.
+        unsigned int XM_CALLCONV Test4(FXMMATRIX rects, CXMMATRIX originRotationDepth) const noexcept
+        {
+            XMVECTOR sin, cos;
+            XMVectorSinCos(&sin, &cos, originRotationDepth.r[2]);
+
+            // Center and half size of the unrotated rectangle, relative to the rotation origin.
+            const XMVECTOR halfWidth = XMVectorScale(rects.r[2], 0.5f);
+            const XMVECTOR halfHeight = XMVectorScale(rects.r[3], 0.5f);
+
+            const XMVECTOR localX = XMVectorSubtract(halfWidth, XMVectorMultiply(originRotationDepth.r[0], rects.r[2]));
+            const XMVECTOR localY = XMVectorSubtract(halfHeight, XMVectorMultiply(originRotationDepth.r[1], rects.r[3]));
+
+            // Rotate the center, and find the half size of the rotated bounds.
+            const XMVECTOR centerX = XMVectorAdd(rects.r[0], XMVectorSubtract(XMVectorMultiply(cos, localX), XMVectorMultiply(sin, localY)));
+            const XMVECTOR centerY = XMVectorAdd(rects.r[1], XMVectorAdd(XMVectorMultiply(sin, localX), XMVectorMultiply(cos, localY)));
+
+            const XMVECTOR absSin = XMVectorAbs(sin);
+            const XMVECTOR absCos = XMVectorAbs(cos);
+            const XMVECTOR absHalfWidth = XMVectorAbs(halfWidth);
+            const XMVECTOR absHalfHeight = XMVectorAbs(halfHeight);
+
+            // Pad the bounds slightly, so rounding differences from the vertex path never cull a visible edge.
+            const XMVECTOR padding = XMVectorReplicate(1.0f + 1e-4f);
+
+            const XMVECTOR extentX = XMVectorMultiply(XMVectorMultiplyAdd(absCos, absHalfWidth, XMVectorMultiply(absSin, absHalfHeight)), padding);
+            const XMVECTOR extentY = XMVectorMultiply(XMVectorMultiplyAdd(absSin, absHalfWidth, XMVectorMultiply(absCos, absHalfHeight)), padding);
+
+            // Transform the bounds to clip space.
+            const XMVECTOR clipX = XMVectorMultiplyAdd(centerX, XMVectorReplicate(mTransform._11),
+                XMVectorMultiplyAdd(centerY, XMVectorReplicate(mTransform._21),
+                    XMVectorMultiplyAdd(originRotationDepth.r[3], XMVectorReplicate(mTransform._31), XMVectorReplicate(mTransform._41))));
+
+            const XMVECTOR clipY = XMVectorMultiplyAdd(centerX, XMVectorReplicate(mTransform._12),
+                XMVectorMultiplyAdd(centerY, XMVectorReplicate(mTransform._22),
+                    XMVectorMultiplyAdd(originRotationDepth.r[3], XMVectorReplicate(mTransform._32), XMVectorReplicate(mTransform._42))));
+
+            const XMVECTOR clipExtentX = XMVectorMultiplyAdd(extentX, XMVectorReplicate(std::abs(mTransform._11)), XMVectorMultiply(extentY, XMVectorReplicate(std::abs(mTransform._21))));
+            const XMVECTOR clipExtentY = XMVectorMultiplyAdd(extentX, XMVectorReplicate(std::abs(mTransform._12)), XMVectorMultiply(extentY, XMVectorReplicate(std::abs(mTransform._22))));
+
+            // Cull sprites that lie entirely outside the region. Testing for "outside" rather than
+            // "inside" means sprites with NaN coordinates are kept, as they were before culling.
+            XMVECTOR outside = XMVectorLess(XMVectorAdd(clipX, clipExtentX), XMVectorReplicate(mRegion.x));
+            outside = XMVectorOrInt(outside, XMVectorLess(XMVectorAdd(clipY, clipExtentY), XMVectorReplicate(mRegion.y)));
+            outside = XMVectorOrInt(outside, XMVectorGreater(XMVectorSubtract(clipX, clipExtentX), XMVectorReplicate(mRegion.z)));
+            outside = XMVectorOrInt(outside, XMVectorGreater(XMVectorSubtract(clipY, clipExtentY), XMVectorReplicate(mRegion.w)));
+
+            uint32_t record;
+            XMVectorEqualIntR(&record, outside, XMVectorFalseInt());
+
+            if (XMComparisonAllTrue(record))
+                return 0xF;
+
+            XMUINT4 lanes;
+            XMStoreUInt4(&lanes, outside);
+
+            return (lanes.x ? 0u : 1u) | (lanes.y ? 0u : 2u) | (lanes.z ? 0u : 4u) | (lanes.w ? 0u : 8u);
+        }
+
+    private:
+        XMFLOAT4X4 mTransform;
+        XMFLOAT4 mRegion;
+    };
+}
@@ -0,0 +1,731 @@
+//--------------------------------------------------------------------------------------
+// File: SpriteExpansion.h
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpriteInstances.h"
+
+#include <DirectXMath.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+
+namespace DirectX
+{
+    // Expands queued sprites into four corner vertices each, one sprite at a time or four or
+    // eight at once, or packs them into instances for the instanced path. SpriteBatch keeps each sprite field in its own array of 16-byte aligned
+    // XMFLOAT4A, so the queue type needs source, destination, color and originRotationDepth
+    // arrays of those plus a flags array. The vertex type needs an XMFLOAT3 position directly
+    // followed by an XMFLOAT4 color, and an XMFLOAT2 textureCoordinate, as in
+    // VertexPositionColorTexture.
+    namespace SpriteExpansion
+    {
+        // Flag bits: the low two are the public SpriteEffects values, the others are set by
+        // SpriteBatch when it queues the sprite.
+        constexpr unsigned int FlipHorizontally = 1;
+        constexpr unsigned int FlipVertically = 2;
+        constexpr unsigned int SourceInTexels = 4;
+        constexpr unsigned int DestSizeInPixels = 8;
+
+        constexpr size_t VerticesPerSprite = 4;
+
+        // Sprites per chunk when a run is split across worker threads, about 18KB of vertices.
+        constexpr size_t ParallelChunkSize = 128;
+
+
+        // Loads the same field of four queued sprites, transposed so that each returned row holds
+        // one component (x, y, z or w) of all four sprites.
+        template<typename T>
+        inline XMMATRIX XM_CALLCONV LoadTransposed4(_In_ T const* field, _In_reads_(4) uint32_t const* sprites)
+        {
+            const XMMATRIX m(
+                XMLoadFloat4A(&field[sprites[0]]),
+                XMLoadFloat4A(&field[sprites[1]]),
+                XMLoadFloat4A(&field[sprites[2]]),
+                XMLoadFloat4A(&field[sprites[3]]));
+
+            return XMMatrixTranspose(m);
+        }
+
+
+        // Four-wide version of XMScalarSinCos. This performs exactly the same sequence of operations
+        // as the scalar function, so the SIMD sprite path produces the same vertices as RenderSprite.
+        inline void XM_CALLCONV SinCos4(_Out_ XMVECTOR* pSin, _Out_ XMVECTOR* pCos, FXMVECTOR value)
+        {
+            // Map value to y in [-pi,pi], x = 2*pi*quotient + remainder.
+            XMVECTOR quotient = XMVectorMultiply(XMVectorReplicate(XM_1DIV2PI), value);
+
+            const XMVECTOR rounding = XMVectorSelect(XMVectorNegate(g_XMOneHalf), g_XMOneHalf, XMVectorGreaterOrEqual(value, g_XMZero));
+
+            quotient = XMVectorTruncate(XMVectorAdd(quotient, rounding));
+
+            XMVECTOR y = XMVectorSubtract(value, XMVectorMultiply(g_XMTwoPi, quotient));
+
+            // Map y to [-pi/2,pi/2] with sin(y) = sin(value).
+            const XMVECTOR above = XMVectorGreater(y, g_XMHalfPi);
+            const XMVECTOR below = XMVectorLess(y, XMVectorNegate(g_XMHalfPi));
+
+            y = XMVectorSelect(y, XMVectorSubtract(g_XMPi, y), above);
+            y = XMVectorSelect(y, XMVectorSubtract(XMVectorReplicate(-XM_PI), y), below);
+
+            const XMVECTOR sign = XMVectorSelect(g_XMOne, g_XMNegativeOne, XMVectorOrInt(above, below));
+
+            const XMVECTOR y2 = XMVectorMultiply(y, y);
+
+            // 11-degree minimax approximation
+            XMVECTOR s = XMVectorMultiply(XMVectorReplicate(-2.3889859e-08f), y2);
+            s = XMVectorAdd(s, XMVectorReplicate(2.7525562e-06f));
+            s = XMVectorAdd(XMVectorMultiply(s, y2), XMVectorReplicate(-0.00019840874f));
+            s = XMVectorAdd(XMVectorMultiply(s, y2), XMVectorReplicate(0.0083333310f));
+            s = XMVectorAdd(XMVectorMultiply(s, y2), XMVectorReplicate(-0.16666667f));
+            s = XMVectorAdd(XMVectorMultiply(s, y2), g_XMOne);
+            *pSin = XMVectorMultiply(s, y);
+
+            // 10-degree minimax approximation
+            XMVECTOR c = XMVectorMultiply(XMVectorReplicate(-2.6051615e-07f), y2);
+            c = XMVectorAdd(c, XMVectorReplicate(2.4760495e-05f));
+            c = XMVectorAdd(XMVectorMultiply(c, y2), XMVectorReplicate(-0.0013888378f));
+            c = XMVectorAdd(XMVectorMultiply(c, y2), XMVectorReplicate(0.041666638f));
+            c = XMVectorAdd(XMVectorMultiply(c, y2), XMVectorReplicate(-0.5f));
+            c = XMVectorAdd(XMVectorMultiply(c, y2), g_XMOne);
+            *pCos = XMVectorMultiply(sign, c);
+        }
+
+
+#if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+        // The eight-wide sprite path is compiled for AVX regardless of the project settings,
+        // and only called after checking that the CPU and OS support it.
+#if (defined(__clang__) || defined(__GNUC__)) && !defined(__AVX__)
+#define SPRITEBATCH_TARGET_AVX __attribute__((target("avx")))
+#else
+#define SPRITEBATCH_TARGET_AVX
+#endif
+
+#if defined(__clang__) && !defined(__AVX__)
+        __attribute__((target("xsave")))
+#endif
+        inline bool CheckAVXSupport() noexcept
+        {
+        #if defined(__AVX__)
+            return true;
+        #elif defined(_MSC_VER)
+            int cpuInfo[4] = {};
+            __cpuid(cpuInfo, 1);
+
+            // The CPU must support AVX, and the OS must save the YMM registers on context switch.
+            const bool osxsave = (cpuInfo[2] & (1 << 27)) != 0;
+            const bool avx = (cpuInfo[2] & (1 << 28)) != 0;
+
+            if (!osxsave || !avx)
+                return false;
+
+            return (_xgetbv(0) & 6) == 6;
+        #else
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx") != 0;
+        #endif
+        }
+
+        inline bool IsAVXSupported() noexcept
+        {
+            static const bool s_supported = CheckAVXSupport();
+
+            return s_supported;
+        }
+
+
+        // Loads the same field of four queued sprites into the four __m128 rows of out, transposed.
+        template<typename T>
+        inline void LoadTransposed4(_In_ T const* field, _In_reads_(4) uint32_t const* sprites, _Out_writes_(4) __m128* out) noexcept
+        {
+            out[0] = _mm_load_ps(&field[sprites[0]].x);
+            out[1] = _mm_load_ps(&field[sprites[1]].x);
+            out[2] = _mm_load_ps(&field[sprites[2]].x);
+            out[3] = _mm_load_ps(&field[sprites[3]].x);
+
+            _MM_TRANSPOSE4_PS(out[0], out[1], out[2], out[3]);
+        }
+
+
+        // Loads the same field of eight queued sprites, transposed so each output holds one
+        // component of all eight sprites.
+        template<typename T>
+        SPRITEBATCH_TARGET_AVX
+        inline void LoadTransposed8(_In_ T const* field, _In_reads_(8) uint32_t const* sprites, _Out_writes_(4) __m256* out) noexcept
+        {
+            __m128 lo[4];
+            __m128 hi[4];
+
+            LoadTransposed4(field, sprites, lo);
+            LoadTransposed4(field, sprites + 4, hi);
+
+            for (size_t i = 0; i < 4; i++)
+            {
+                out[i] = _mm256_insertf128_ps(_mm256_castps128_ps256(lo[i]), hi[i], 1);
+            }
+        }
+
+
+        SPRITEBATCH_TARGET_AVX
+        inline __m256 MultiplyAdd8(__m256 a, __m256 b, __m256 c) noexcept
+        {
+        #if defined(_XM_FMA3_INTRINSICS_)
+            return _mm256_fmadd_ps(a, b, c);
+        #else
+            return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+        #endif
+        }
+
+
+        // Eight-wide version of SinCos4, see there.
+        SPRITEBATCH_TARGET_AVX
+        inline void SinCos8(_Out_ __m256* pSin, _Out_ __m256* pCos, __m256 value) noexcept
+        {
+            const __m256 zero = _mm256_setzero_ps();
+            const __m256 one = _mm256_set1_ps(1.f);
+            const __m256 halfPi = _mm256_set1_ps(XM_PIDIV2);
+
+            __m256 quotient = _mm256_mul_ps(_mm256_set1_ps(XM_1DIV2PI), value);
+
+            const __m256 rounding = _mm256_blendv_ps(_mm256_set1_ps(-0.5f), _mm256_set1_ps(0.5f), _mm256_cmp_ps(value, zero, _CMP_GE_OQ));
+
+            quotient = _mm256_round_ps(_mm256_add_ps(quotient, rounding), _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+
+            __m256 y = _mm256_sub_ps(value, _mm256_mul_ps(_mm256_set1_ps(XM_2PI), quotient));
+
+            const __m256 above = _mm256_cmp_ps(y, halfPi, _CMP_GT_OQ);
+            const __m256 below = _mm256_cmp_ps(y, _mm256_sub_ps(zero, halfPi), _CMP_LT_OQ);
+
+            y = _mm256_blendv_ps(y, _mm256_sub_ps(_mm256_set1_ps(XM_PI), y), above);
+            y = _mm256_blendv_ps(y, _mm256_sub_ps(_mm256_set1_ps(-XM_PI), y), below);
+
+            const __m256 sign = _mm256_blendv_ps(one, _mm256_set1_ps(-1.f), _mm256_or_ps(above, below));
+
+            const __m256 y2 = _mm256_mul_ps(y, y);
+
+            __m256 s = _mm256_mul_ps(_mm256_set1_ps(-2.3889859e-08f), y2);
+            s = _mm256_add_ps(s, _mm256_set1_ps(2.7525562e-06f));
+            s = _mm256_add_ps(_mm256_mul_ps(s, y2), _mm256_set1_ps(-0.00019840874f));
+            s = _mm256_add_ps(_mm256_mul_ps(s, y2), _mm256_set1_ps(0.0083333310f));
+            s = _mm256_add_ps(_mm256_mul_ps(s, y2), _mm256_set1_ps(-0.16666667f));
+            s = _mm256_add_ps(_mm256_mul_ps(s, y2), one);
+            *pSin = _mm256_mul_ps(s, y);
+
+            __m256 c = _mm256_mul_ps(_mm256_set1_ps(-2.6051615e-07f), y2);
+            c = _mm256_add_ps(c, _mm256_set1_ps(2.4760495e-05f));
+            c = _mm256_add_ps(_mm256_mul_ps(c, y2), _mm256_set1_ps(-0.0013888378f));
+            c = _mm256_add_ps(_mm256_mul_ps(c, y2), _mm256_set1_ps(0.041666638f));
+            c = _mm256_add_ps(_mm256_mul_ps(c, y2), _mm256_set1_ps(-0.5f));
+            c = _mm256_add_ps(_mm256_mul_ps(c, y2), one);
+            *pCos = _mm256_mul_ps(sign, c);
+        }
+#endif
+
+
+        // Transposes one corner of four sprites from component-major to vertex order and writes it out.
+        template<typename TVertex>
+        inline void XM_CALLCONV StoreCorners(_Out_writes_(4 * VerticesPerSprite) TVertex* vertices,
+            size_t corner,
+            FXMMATRIX positions,
+            CXMMATRIX textureCoordinates,
+            _In_reads_(4) XMVECTOR const* colors) noexcept
+        {
+            const XMMATRIX position = XMMatrixTranspose(positions);
+            const XMMATRIX textureCoordinate = XMMatrixTranspose(textureCoordinates);
+
+            for (size_t i = 0; i < 4; i++)
+            {
+                TVertex& vertex = vertices[i * VerticesPerSprite + corner];
+
+                // As in RenderSprite, the position is written as a Float4, clobbering the first element
+                // of the following color field which is immediately overwritten with its correct value.
+                XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&vertex.position), position.r[i]);
+                XMStoreFloat4(&vertex.color, colors[i]);
+                XMStoreFloat2(&vertex.textureCoordinate, textureCoordinate.r[i]);
+            }
+        }
+
+
+        // Generates vertex data for drawing a single sprite.
+        template<typename TQueue, typename TVertex>
+        inline void XM_CALLCONV RenderSprite(TQueue const& queue,
+            uint32_t sprite,
+            _Out_writes_(VerticesPerSprite) TVertex* vertices,
+            FXMVECTOR textureSize,
+            FXMVECTOR inverseTextureSize) noexcept
+        {
+            // Load sprite parameters into SIMD registers.
+            XMVECTOR source = XMLoadFloat4A(&queue.source[sprite]);
+            const XMVECTOR destination = XMLoadFloat4A(&queue.destination[sprite]);
+            const XMVECTOR color = XMLoadFloat4A(&queue.color[sprite]);
+            const XMVECTOR originRotationDepth = XMLoadFloat4A(&queue.originRotationDepth[sprite]);
+
+            const float rotation = queue.originRotationDepth[sprite].z;
+            const unsigned int flags = queue.flags[sprite];
+
+            // Extract the source and destination sizes into separate vectors.
+            XMVECTOR sourceSize = XMVectorSwizzle<2, 3, 2, 3>(source);
+            XMVECTOR destinationSize = XMVectorSwizzle<2, 3, 2, 3>(destination);
+
+            // Scale the origin offset by source size, taking care to avoid overflow if the source region is zero.
+            const XMVECTOR isZeroMask = XMVectorEqual(sourceSize, XMVectorZero());
+            const XMVECTOR nonZeroSourceSize = XMVectorSelect(sourceSize, g_XMEpsilon, isZeroMask);
+
+            XMVECTOR origin = XMVectorDivide(originRotationDepth, nonZeroSourceSize);
+
+            // Convert the source region from texels to mod-1 texture coordinate format.
+            if (flags & SourceInTexels)
+            {
+                source = XMVectorMultiply(source, inverseTextureSize);
+                sourceSize = XMVectorMultiply(sourceSize, inverseTextureSize);
+            }
+            else
+            {
+                origin = XMVectorMultiply(origin, inverseTextureSize);
+            }
+
+            // If the destination size is relative to the source region, convert it to pixels.
+            if (!(flags & DestSizeInPixels))
+            {
+                destinationSize = XMVectorMultiply(destinationSize, textureSize);
+            }
+
+            // Compute a 2x2 rotation matrix.
+            XMVECTOR rotationMatrix1;
+            XMVECTOR rotationMatrix2;
+
+            if (rotation != 0)
+            {
+                float sin, cos;
+
+                XMScalarSinCos(&sin, &cos, rotation);
+
+                const XMVECTOR sinV = XMLoadFloat(&sin);
+                const XMVECTOR cosV = XMLoadFloat(&cos);
+
+                rotationMatrix1 = XMVectorMergeXY(cosV, sinV);
+                rotationMatrix2 = XMVectorMergeXY(XMVectorNegate(sinV), cosV);
+            }
+            else
+            {
+                rotationMatrix1 = g_XMIdentityR0;
+                rotationMatrix2 = g_XMIdentityR1;
+            }
+
+            // The four corner vertices are computed by transforming these unit-square positions.
+            static const XMVECTORF32 cornerOffsets[VerticesPerSprite] =
+            {
+                { { { 0, 0, 0, 0 } } },
+                { { { 1, 0, 0, 0 } } },
+                { { { 0, 1, 0, 0 } } },
+                { { { 1, 1, 0, 0 } } },
+            };
+
+            // Tricksy alert! Texture coordinates are computed from the same cornerOffsets
+            // table as vertex positions, but if the sprite is mirrored, this table
+            // must be indexed in a different order. This is done as follows:
+            //
+            //    position = cornerOffsets[i]
+            //    texcoord = cornerOffsets[i ^ SpriteEffects]
+
+            static_assert(FlipHorizontally == 1 &&
+                FlipVertically == 2, "If you change these values, the mirroring implementation must be updated to match");
+
+            const unsigned int mirrorBits = flags & 3u;
+
+            // Generate the four output vertices.
+            for (size_t i = 0; i < VerticesPerSprite; i++)
+            {
+                // Calculate position.
+                const XMVECTOR cornerOffset = XMVectorMultiply(XMVectorSubtract(cornerOffsets[i], origin), destinationSize);
+
+                // Apply 2x2 rotation matrix.
+                const XMVECTOR position1 = XMVectorMultiplyAdd(XMVectorSplatX(cornerOffset), rotationMatrix1, destination);
+                const XMVECTOR position2 = XMVectorMultiplyAdd(XMVectorSplatY(cornerOffset), rotationMatrix2, position1);
+
+                // Set z = depth.
+                const XMVECTOR position = XMVectorPermute<0, 1, 7, 6>(position2, originRotationDepth);
+
+                // Write position as a Float4, even though VertexPositionColor::position is an XMFLOAT3.
+                // This is faster, and harmless as we are just clobbering the first element of the
+                // following color field, which will immediately be overwritten with its correct value.
+                XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&vertices[i].position), position);
+
+                // Write the color.
+                XMStoreFloat4(&vertices[i].color, color);
+
+                // Compute and write the texture coordinate.
+                const XMVECTOR textureCoordinate = XMVectorMultiplyAdd(cornerOffsets[static_cast<unsigned int>(i) ^ mirrorBits], sourceSize, source);
+
+                XMStoreFloat2(&vertices[i].textureCoordinate, textureCoordinate);
+            }
+        }
+
+
+        // Generates vertex data for four sprites at once. Each SIMD lane processes one sprite,
+        // following the same sequence of operations as RenderSprite so the results are identical.
+        template<typename TQueue, typename TVertex>
+        inline void XM_CALLCONV RenderSprites4(TQueue const& queue,
+            _In_reads_(4) uint32_t const* sprites,
+            _Out_writes_(4 * VerticesPerSprite) TVertex* vertices,
+            FXMVECTOR textureSize,
+            FXMVECTOR inverseTextureSize) noexcept
+        {
+            // Load sprite parameters, one component of four sprites per register.
+            const XMMATRIX source = LoadTransposed4(queue.source.get(), sprites);
+            const XMMATRIX destination = LoadTransposed4(queue.destination.get(), sprites);
+            const XMMATRIX originRotationDepth = LoadTransposed4(queue.originRotationDepth.get(), sprites);
+
+            const XMVECTOR colors[4] =
+            {
+                XMLoadFloat4A(&queue.color[sprites[0]]),
+                XMLoadFloat4A(&queue.color[sprites[1]]),
+                XMLoadFloat4A(&queue.color[sprites[2]]),
+                XMLoadFloat4A(&queue.color[sprites[3]]),
+            };
+
+            const unsigned int flags[4] =
+            {
+                queue.flags[sprites[0]],
+                queue.flags[sprites[1]],
+                queue.flags[sprites[2]],
+                queue.flags[sprites[3]],
+            };
+
+            auto flagMask = [&](unsigned int flag)
+            {
+                return XMVectorSelectControl(
+                    (flags[0] & flag) ? 1u : 0u,
+                    (flags[1] & flag) ? 1u : 0u,
+                    (flags[2] & flag) ? 1u : 0u,
+                    (flags[3] & flag) ? 1u : 0u);
+            };
+
+            const XMVECTOR flipHorizontally = flagMask(FlipHorizontally);
+            const XMVECTOR flipVertically = flagMask(FlipVertically);
+            const XMVECTOR sourceInTexels = flagMask(SourceInTexels);
+            const XMVECTOR destSizeInPixels = flagMask(DestSizeInPixels);
+
+            const XMVECTOR textureWidth = XMVectorSplatX(textureSize);
+            const XMVECTOR textureHeight = XMVectorSplatY(textureSize);
+            const XMVECTOR inverseTextureWidth = XMVectorSplatX(inverseTextureSize);
+            const XMVECTOR inverseTextureHeight = XMVectorSplatY(inverseTextureSize);
+
+            XMVECTOR sourceX = source.r[0];
+            XMVECTOR sourceY = source.r[1];
+            XMVECTOR sourceWidth = source.r[2];
+            XMVECTOR sourceHeight = source.r[3];
+
+            // Scale the origin offset by source size, taking care to avoid overflow if the source region is zero.
+            XMVECTOR originX = XMVectorDivide(originRotationDepth.r[0],
+                XMVectorSelect(sourceWidth, g_XMEpsilon, XMVectorEqual(sourceWidth, g_XMZero)));
+            XMVECTOR originY = XMVectorDivide(originRotationDepth.r[1],
+                XMVectorSelect(sourceHeight, g_XMEpsilon, XMVectorEqual(sourceHeight, g_XMZero)));
+
+            // Convert the source region from texels to mod-1 texture coordinate format.
+            sourceX = XMVectorSelect(sourceX, XMVectorMultiply(sourceX, inverseTextureWidth), sourceInTexels);
+            sourceY = XMVectorSelect(sourceY, XMVectorMultiply(sourceY, inverseTextureHeight), sourceInTexels);
+            sourceWidth = XMVectorSelect(sourceWidth, XMVectorMultiply(sourceWidth, inverseTextureWidth), sourceInTexels);
+            sourceHeight = XMVectorSelect(sourceHeight, XMVectorMultiply(sourceHeight, inverseTextureHeight), sourceInTexels);
+
+            originX = XMVectorSelect(XMVectorMultiply(originX, inverseTextureWidth), originX, sourceInTexels);
+            originY = XMVectorSelect(XMVectorMultiply(originY, inverseTextureHeight), originY, sourceInTexels);
+
+            // If the destination size is relative to the source region, convert it to pixels.
+            const XMVECTOR destinationWidth = XMVectorSelect(XMVectorMultiply(destination.r[2], textureWidth), destination.r[2], destSizeInPixels);
+            const XMVECTOR destinationHeight = XMVectorSelect(XMVectorMultiply(destination.r[3], textureHeight), destination.r[3], destSizeInPixels);
+
+            // Compute a 2x2 rotation matrix, using the identity for unrotated sprites.
+            const XMVECTOR rotation = originRotationDepth.r[2];
+            const XMVECTOR notRotated = XMVectorEqual(rotation, g_XMZero);
+
+            XMVECTOR sin, cos;
+
+            SinCos4(&sin, &cos, rotation);
+
+            const XMVECTOR negativeSin = XMVectorSelect(XMVectorNegate(sin), g_XMZero, notRotated);
+
+            sin = XMVectorSelect(sin, g_XMZero, notRotated);
+            cos = XMVectorSelect(cos, g_XMOne, notRotated);
+
+            // Texture coordinates of the left and right edges, top and bottom edges, after mirroring.
+            const XMVECTOR left = XMVectorSelect(g_XMZero, g_XMOne, flipHorizontally);
+            const XMVECTOR right = XMVectorSelect(g_XMOne, g_XMZero, flipHorizontally);
+            const XMVECTOR top = XMVectorSelect(g_XMZero, g_XMOne, flipVertically);
+            const XMVECTOR bottom = XMVectorSelect(g_XMOne, g_XMZero, flipVertically);
+
+            // Generate the four output vertices of each sprite.
+            for (size_t i = 0; i < VerticesPerSprite; i++)
+            {
+                const XMVECTOR cornerX = (i & 1) ? g_XMOne : g_XMZero;
+                const XMVECTOR cornerY = (i & 2) ? g_XMOne : g_XMZero;
+
+                // Calculate position.
+                const XMVECTOR offsetX = XMVectorMultiply(XMVectorSubtract(cornerX, originX), destinationWidth);
+                const XMVECTOR offsetY = XMVectorMultiply(XMVectorSubtract(cornerY, originY), destinationHeight);
+
+                // Apply 2x2 rotation matrix.
+                const XMVECTOR positionX = XMVectorMultiplyAdd(offsetY, negativeSin, XMVectorMultiplyAdd(offsetX, cos, destination.r[0]));
+                const XMVECTOR positionY = XMVectorMultiplyAdd(offsetY, cos, XMVectorMultiplyAdd(offsetX, sin, destination.r[1]));
+
+                // Compute the texture coordinate.
+                const XMVECTOR textureU = XMVectorMultiplyAdd((i & 1) ? right : left, sourceWidth, sourceX);
+                const XMVECTOR textureV = XMVectorMultiplyAdd((i & 2) ? bottom : top, sourceHeight, sourceY);
+
+                StoreCorners(vertices, i,
+                    XMMATRIX(positionX, positionY, originRotationDepth.r[3], g_XMZero),
+                    XMMATRIX(textureU, textureV, g_XMZero, g_XMZero),
+                    colors);
+            }
+        }
+
+
+#if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+        // Eight-wide AVX version of RenderSprites4.
+        template<typename TQueue, typename TVertex>
+        SPRITEBATCH_TARGET_AVX
+        inline void XM_CALLCONV RenderSprites8(TQueue const& queue,
+            _In_reads_(8) uint32_t const* sprites,
+            _Out_writes_(8 * VerticesPerSprite) TVertex* vertices,
+            FXMVECTOR textureSize,
+            FXMVECTOR inverseTextureSize) noexcept
+        {
+            // Load sprite parameters, one component of eight sprites per register.
+            __m256 source[4];
+            __m256 destination[4];
+            __m256 originRotationDepth[4];
+
+            LoadTransposed8(queue.source.get(), sprites, source);
+            LoadTransposed8(queue.destination.get(), sprites, destination);
+            LoadTransposed8(queue.originRotationDepth.get(), sprites, originRotationDepth);
+
+            // Expand the flags into per-lane masks.
+            enum { FlipHorizontallyMask, FlipVerticallyMask, SourceInTexelsMask, DestSizeInPixelsMask, MaskCount };
+
+            int32_t masks[MaskCount][8];
+
+            for (size_t i = 0; i < 8; i++)
+            {
+                const unsigned int flags = queue.flags[sprites[i]];
+
+                masks[FlipHorizontallyMask][i] = (flags & FlipHorizontally) ? -1 : 0;
+                masks[FlipVerticallyMask][i] = (flags & FlipVertically) ? -1 : 0;
+                masks[SourceInTexelsMask][i] = (flags & SourceInTexels) ? -1 : 0;
+                masks[DestSizeInPixelsMask][i] = (flags & DestSizeInPixels) ? -1 : 0;
+            }
+
+            const __m256 flipHorizontally = _mm256_loadu_ps(reinterpret_cast<float const*>(masks[FlipHorizontallyMask]));
+            const __m256 flipVertically = _mm256_loadu_ps(reinterpret_cast<float const*>(masks[FlipVerticallyMask]));
+            const __m256 sourceInTexels = _mm256_loadu_ps(reinterpret_cast<float const*>(masks[SourceInTexelsMask]));
+            const __m256 destSizeInPixels = _mm256_loadu_ps(reinterpret_cast<float const*>(masks[DestSizeInPixelsMask]));
+
+            const __m256 zero = _mm256_setzero_ps();
+            const __m256 one = _mm256_set1_ps(1.f);
+            const __m256 epsilon = _mm256_set1_ps(g_XMEpsilon.f[0]);
+
+            const __m256 textureWidth = _mm256_set1_ps(XMVectorGetX(textureSize));
+            const __m256 textureHeight = _mm256_set1_ps(XMVectorGetY(textureSize));
+            const __m256 inverseTextureWidth = _mm256_set1_ps(XMVectorGetX(inverseTextureSize));
+            const __m256 inverseTextureHeight = _mm256_set1_ps(XMVectorGetY(inverseTextureSize));
+
+            __m256 sourceX = source[0];
+            __m256 sourceY = source[1];
+            __m256 sourceWidth = source[2];
+            __m256 sourceHeight = source[3];
+
+            // Scale the origin offset by source size, taking care to avoid overflow if the source region is zero.
+            __m256 originX = _mm256_div_ps(originRotationDepth[0],
+                _mm256_blendv_ps(sourceWidth, epsilon, _mm256_cmp_ps(sourceWidth, zero, _CMP_EQ_OQ)));
+            __m256 originY = _mm256_div_ps(originRotationDepth[1],
+                _mm256_blendv_ps(sourceHeight, epsilon, _mm256_cmp_ps(sourceHeight, zero, _CMP_EQ_OQ)));
+
+            // Convert the source region from texels to mod-1 texture coordinate format.
+            sourceX = _mm256_blendv_ps(sourceX, _mm256_mul_ps(sourceX, inverseTextureWidth), sourceInTexels);
+            sourceY = _mm256_blendv_ps(sourceY, _mm256_mul_ps(sourceY, inverseTextureHeight), sourceInTexels);
+            sourceWidth = _mm256_blendv_ps(sourceWidth, _mm256_mul_ps(sourceWidth, inverseTextureWidth), sourceInTexels);
+            sourceHeight = _mm256_blendv_ps(sourceHeight, _mm256_mul_ps(sourceHeight, inverseTextureHeight), sourceInTexels);
+
+            originX = _mm256_blendv_ps(_mm256_mul_ps(originX, inverseTextureWidth), originX, sourceInTexels);
+            originY = _mm256_blendv_ps(_mm256_mul_ps(originY, inverseTextureHeight), originY, sourceInTexels);
+
+            // If the destination size is relative to the source region, convert it to pixels.
+            const __m256 destinationWidth = _mm256_blendv_ps(_mm256_mul_ps(destination[2], textureWidth), destination[2], destSizeInPixels);
+            const __m256 destinationHeight = _mm256_blendv_ps(_mm256_mul_ps(destination[3], textureHeight), destination[3], destSizeInPixels);
+
+            // Compute a 2x2 rotation matrix, using the identity for unrotated sprites.
+            const __m256 rotation = originRotationDepth[2];
+            const __m256 notRotated = _mm256_cmp_ps(rotation, zero, _CMP_EQ_OQ);
+
+            __m256 sin, cos;
+
+            SinCos8(&sin, &cos, rotation);
+
+            const __m256 negativeSin = _mm256_blendv_ps(_mm256_sub_ps(zero, sin), zero, notRotated);
+
+            sin = _mm256_blendv_ps(sin, zero, notRotated);
+            cos = _mm256_blendv_ps(cos, one, notRotated);
+
+            // Texture coordinates of the left and right edges, top and bottom edges, after mirroring.
+            const __m256 left = _mm256_blendv_ps(zero, one, flipHorizontally);
+            const __m256 right = _mm256_blendv_ps(one, zero, flipHorizontally);
+            const __m256 top = _mm256_blendv_ps(zero, one, flipVertically);
+            const __m256 bottom = _mm256_blendv_ps(one, zero, flipVertically);
+
+            // Compute all four corners, keeping the results in component-major order.
+            enum { PositionX, PositionY, TextureU, TextureV, ComponentCount };
+
+            XMFLOAT4A results[VerticesPerSprite][ComponentCount][2];
+
+            for (size_t i = 0; i < VerticesPerSprite; i++)
+            {
+                const __m256 cornerX = (i & 1) ? one : zero;
+                const __m256 cornerY = (i & 2) ? one : zero;
+
+                const __m256 offsetX = _mm256_mul_ps(_mm256_sub_ps(cornerX, originX), destinationWidth);
+                const __m256 offsetY = _mm256_mul_ps(_mm256_sub_ps(cornerY, originY), destinationHeight);
+
+                _mm256_storeu_ps(&results[i][PositionX][0].x, MultiplyAdd8(offsetY, negativeSin, MultiplyAdd8(offsetX, cos, destination[0])));
+                _mm256_storeu_ps(&results[i][PositionY][0].x, MultiplyAdd8(offsetY, cos, MultiplyAdd8(offsetX, sin, destination[1])));
+                _mm256_storeu_ps(&results[i][TextureU][0].x, MultiplyAdd8((i & 1) ? right : left, sourceWidth, sourceX));
+                _mm256_storeu_ps(&results[i][TextureV][0].x, MultiplyAdd8((i & 2) ? bottom : top, sourceHeight, sourceY));
+            }
+
+            XMFLOAT4A depth[2];
+
+            _mm256_storeu_ps(&depth[0].x, originRotationDepth[3]);
+
+            // Interleaving the output is done with 128-bit operations, so avoid paying for
+            // a transition between AVX and legacy SSE code on older hardware.
+            _mm256_zeroupper();
+
+            for (size_t half = 0; half < 2; half++)
+            {
+                uint32_t const* halfSprites = sprites + half * 4;
+
+                const XMVECTOR colors[4] =
+                {
+                    XMLoadFloat4A(&queue.color[halfSprites[0]]),
+                    XMLoadFloat4A(&queue.color[halfSprites[1]]),
+                    XMLoadFloat4A(&queue.color[halfSprites[2]]),
+                    XMLoadFloat4A(&queue.color[halfSprites[3]]),
+                };
+
+                for (size_t i = 0; i < VerticesPerSprite; i++)
+                {
+                    StoreCorners(vertices + half * 4 * VerticesPerSprite, i,
+                        XMMATRIX(XMLoadFloat4A(&results[i][PositionX][half]), XMLoadFloat4A(&results[i][PositionY][half]), XMLoadFloat4A(&depth[half]), g_XMZero),
+                        XMMATRIX(XMLoadFloat4A(&results[i][TextureU][half]), XMLoadFloat4A(&results[i][TextureV][half]), g_XMZero, g_XMZero),
+                        colors);
+                }
+            }
+        }
+#endif
+
+
+        // Generates vertex data for a run of sprites. This only touches the output memory, so
+        // it can be run on a plain memory buffer or on several threads at once.
+        template<typename TQueue, typename TVertex>
+        inline void XM_CALLCONV RenderSprites(TQueue const& queue,
+            _In_reads_(count) uint32_t const* sprites,
+            size_t count,
+            _Out_writes_(count * VerticesPerSprite) TVertex* vertices,
+            FXMVECTOR textureSize,
+            FXMVECTOR inverseTextureSize) noexcept
+        {
+            size_t i = 0;
+
+#if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+            if (count >= 8 && IsAVXSupported())
+            {
+                for (; i + 8 <= count; i += 8)
+                {
+                    RenderSprites8(queue, sprites + i, vertices + i * VerticesPerSprite, textureSize, inverseTextureSize);
+                }
+            }
+#endif
+
+            for (; i + 4 <= count; i += 4)
+            {
+                RenderSprites4(queue, sprites + i, vertices + i * VerticesPerSprite, textureSize, inverseTextureSize);
+            }
+
+            for (; i < count; i++)
+            {
+                RenderSprite(queue, sprites[i], vertices + i * VerticesPerSprite, textureSize, inverseTextureSize);
+            }
+        }
+
+
+        // Resolves the parameters of a run of sprites the same way as RenderSprite, and packs them
+        // into instances. This only touches the output memory, so it can run on several threads at once.
+        template<typename TQueue>
+        inline void XM_CALLCONV PackSprites(TQueue const& queue,
+            _In_reads_(count) uint32_t const* sprites,
+            _In_reads_opt_(count) uint8_t const* textureSlots,
+            size_t count,
+            _Out_writes_(count) SpriteInstance* instances,
+            FXMVECTOR textureSize,
+            FXMVECTOR inverseTextureSize) noexcept
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                const uint32_t sprite = sprites[i];
+
+                XMVECTOR source = XMLoadFloat4A(&queue.source[sprite]);
+                const XMVECTOR destination = XMLoadFloat4A(&queue.destination[sprite]);
+                const XMVECTOR color = XMLoadFloat4A(&queue.color[sprite]);
+                const XMVECTOR originRotationDepth = XMLoadFloat4A(&queue.originRotationDepth[sprite]);
+
+                const unsigned int flags = queue.flags[sprite];
+
+                const XMVECTOR sourceSize = XMVectorSwizzle<2, 3, 2, 3>(source);
+                XMVECTOR destinationSize = XMVectorSwizzle<2, 3, 2, 3>(destination);
+
+                // Scale the origin offset by source size, taking care to avoid overflow if the source region is zero.
+                const XMVECTOR isZeroMask = XMVectorEqual(sourceSize, XMVectorZero());
+                const XMVECTOR nonZeroSourceSize = XMVectorSelect(sourceSize, g_XMEpsilon, isZeroMask);
+
+                XMVECTOR origin = XMVectorDivide(originRotationDepth, nonZeroSourceSize);
+
+                // Convert the source region from texels to mod-1 texture coordinate format. Only the
+                // xy of the texture size are set, so widen them to cover the region size in zw too.
+                if (flags & SourceInTexels)
+                {
+                    source = XMVectorMultiply(source, XMVectorSwizzle<0, 1, 0, 1>(inverseTextureSize));
+                }
+                else
+                {
+                    origin = XMVectorMultiply(origin, inverseTextureSize);
+                }
+
+                // If the destination size is relative to the source region, convert it to pixels.
+                if (!(flags & DestSizeInPixels))
+                {
+                    destinationSize = XMVectorMultiply(destinationSize, textureSize);
+                }
+
+                PackSpriteInstance(&instances[i],
+                    XMVectorPermute<0, 1, 4, 5>(destination, destinationSize),
+                    source,
+                    color,
+                    XMVectorPermute<0, 1, 6, 7>(origin, originRotationDepth),
+                    flags & (FlipHorizontally | FlipVertically),
+                    textureSlots ? textureSlots[i] : 0u);
+            }
+        }
+    }
+}
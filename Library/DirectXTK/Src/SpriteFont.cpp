@@ -15,30 +15,89 @@
 #include "SpriteFont.h"
 #include "DirectXHelpers.h"
 #include "BinaryReader.h"
+#include "GlyphLayout.h"
+#include "GlyphMetrics.h"
+#include "GlyphLookup.h"
 #include "LoaderHelpers.h"
+#include "MappedFile.h"
+#include "TextLayoutCache.h"
 
 using namespace DirectX;
 using Microsoft::WRL::ComPtr;
 
 
+// Internal TextLayout implementation class.
+class TextLayout::Impl
+{
+public:
+    void XM_CALLCONV Draw(_In_ SpriteBatch* spriteBatch, FXMVECTOR position, FXMVECTOR color, float rotation, FXMVECTOR origin, GXMVECTOR scale, SpriteEffects effects, float layerDepth) const;
+
+    RECT GetDrawBounds(XMFLOAT2 const& position) const noexcept;
+
+    // Fields.
+    ComPtr<ID3D11ShaderResourceView> texture;
+    GlyphLayout<SpriteFont::Glyph> layout;
+    float lineSpacing;
+
+    // The font that created the layout, and its layoutGeneration at the time.
+    void const* font;
+    uint64_t fontGeneration;
+};
+
+
 // Internal SpriteFont implementation class.
 class SpriteFont::Impl
 {
 public:
     Impl(_In_ ID3D11Device* device,
         _In_ BinaryReader* reader,
-        bool forceSRGB) noexcept(false);
+        bool forceSRGB,
+        _In_opt_ MappedFile* file = nullptr) noexcept(false);
     Impl(_In_ ID3D11ShaderResourceView* texture,
         _In_reads_(glyphCount) Glyph const* glyphs,
         size_t glyphCount,
         float lineSpacing) noexcept(false);
 
-    Glyph const* FindGlyph(wchar_t character) const;
+    Glyph const* FindGlyph(uint32_t character) const;
 
-    void SetDefaultCharacter(wchar_t character);
+    bool ContainsCharacter(uint32_t character) const noexcept
+    {
+        return glyphLookup.Find(character) != GlyphLookupTable::NotFound;
+    }
+
+    void SetDefaultCharacter(uint32_t character);
+
+    // Text is decoded as it is laid out, so UTF-8 and wide strings share one path with no intermediate copy.
+    template<typename TChar, typename TAction>
+    void ForEachGlyph(_In_z_ TChar const* text, TAction action, bool ignoreWhitespace) const;
+
+    template<typename TChar>
+    void XM_CALLCONV DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ TChar const* text, FXMVECTOR position, FXMVECTOR color, float rotation, FXMVECTOR origin, GXMVECTOR scale, SpriteEffects effects, float layerDepth) const;
+
+    template<typename TChar>
+    XMVECTOR MeasureString(_In_z_ TChar const* text, bool ignoreWhitespace) const;
+
+    template<typename TChar>
+    RECT MeasureDrawBounds(_In_z_ TChar const* text, XMFLOAT2 const& position, bool ignoreWhitespace) const;
 
-    template<typename TAction>
-    void ForEachGlyph(_In_z_ wchar_t const* text, TAction action, bool ignoreWhitespace) const;
+    // Measures everything MeasureString and MeasureDrawBounds report in a single pass, using glyphMetrics.
+    template<typename TChar>
+    GlyphMetricsResult MeasureGlyphs(_In_z_ TChar const* text, XMFLOAT2 const& position, bool ignoreWhitespace) const;
+
+    template<typename TChar>
+    std::shared_ptr<TextLayout::Impl const> CreateLayout(_In_z_ TChar const* text, GlyphLayoutOptions const& options = GlyphLayoutOptions{}) const;
+
+    template<typename TChar>
+    std::shared_ptr<TextLayout::Impl const> UpdateLayout(_In_opt_ TextLayout::Impl const* previous, _In_z_ TChar const* text) const;
+
+    GlyphLayoutOptions GetLayoutOptions(TextLayoutOptions const& options) const;
+
+    // Returns the cached layout of text, creating it on a miss. Only valid while the cache is enabled.
+    template<typename TChar>
+    std::shared_ptr<TextLayout::Impl const> GetCachedLayout(_In_z_ TChar const* text) const
+    {
+        return layoutCache.GetOrCreate(text, [&]() { return CreateLayout(text); });
+    }
 
     void CreateTextureResource(_In_ ID3D11Device* device,
         uint32_t width, uint32_t height,
@@ -46,18 +105,33 @@ public:
         uint32_t stride, uint32_t rows,
         _In_reads_(stride * rows) const uint8_t* data) noexcept(false);
 
-    const wchar_t* ConvertUTF8(_In_z_ const char *text) noexcept(false);
+    void BuildGlyphLookup();
+    void BuildGlyphMetrics();
 
     // Fields.
     ComPtr<ID3D11ShaderResourceView> texture;
-    std::vector<Glyph> glyphs;
-    std::vector<uint32_t> glyphsIndex;
+    Glyph const* glyphs;
+    size_t glyphCount;
+    GlyphLookupTable glyphLookup;
+    GlyphMetricsTable<Glyph> glyphMetrics;
     Glyph const* defaultGlyph;
     float lineSpacing;
 
-private:
-    size_t utfBufferSize;
-    std::unique_ptr<wchar_t[]> utfBuffer;
+    // The glyphs point into one of these: a copy, or the mapped .spritefont file they were loaded from.
+    std::vector<Glyph> glyphStorage;
+    MappedFile fileMapping;
+
+    // Layouts of recently drawn strings, when enabled by SetLayoutCacheSize.
+    mutable TextLayoutCache<TextLayout::Impl> layoutCache;
+
+    // Changed whenever existing layouts go stale, so UpdateLayout knows to start from scratch.
+    uint64_t layoutGeneration;
+
+    void InvalidateLayouts()
+    {
+        layoutGeneration++;
+        layoutCache.Clear();
+    }
 };
 
 
@@ -87,15 +161,19 @@ namespace DirectX
 }
 
 
-// Reads a SpriteFont from the binary format created by the MakeSpriteFont utility.
+// Reads a SpriteFont from the binary format created by the MakeSpriteFont utility. If the reader is
+// reading a mapped file, the font takes over the mapping and uses the glyph array in place.
 _Use_decl_annotations_
 SpriteFont::Impl::Impl(
     ID3D11Device* device,
     BinaryReader* reader,
-    bool forceSRGB) noexcept(false) :
+    bool forceSRGB,
+    MappedFile* file) noexcept(false) :
+    glyphs(nullptr),
+    glyphCount(0),
     defaultGlyph(nullptr),
     lineSpacing(0),
-    utfBufferSize(0)
+    layoutGeneration(0)
 {
     // Validate the header.
     for (char const* magic = spriteFontMagic; *magic; magic++)
@@ -108,21 +186,32 @@ SpriteFont::Impl::Impl(
     }
 
     // Read the glyph data.
-    auto glyphCount = reader->Read<uint32_t>();
+    glyphCount = reader->Read<uint32_t>();
     auto glyphData = reader->ReadArray<Glyph>(glyphCount);
 
-    glyphs.assign(glyphData, glyphData + glyphCount);
-    glyphsIndex.reserve(glyphs.size());
+    if (file && (reinterpret_cast<uintptr_t>(glyphData) % alignof(Glyph)) == 0)
+    {
+        glyphs = glyphData;
+    }
+    else
+    {
+        // A memory blob may not outlive the font, or be suitably aligned.
+        glyphStorage.assign(glyphData, glyphData + glyphCount);
+        glyphs = glyphStorage.data();
+    }
 
-    for (auto& glyph : glyphs)
+    if (!std::is_sorted(glyphs, glyphs + glyphCount))
     {
-        glyphsIndex.emplace_back(glyph.Character);
+        DebugTrace("ERROR: SpriteFont provided with an invalid .spritefont file\n");
+        throw std::runtime_error("Glyphs must be in ascending codepoint order");
     }
 
+    BuildGlyphLookup();
+
     // Read font properties.
     lineSpacing = reader->Read<float>();
 
-    SetDefaultCharacter(static_cast<wchar_t>(reader->Read<uint32_t>()));
+    SetDefaultCharacter(reader->Read<uint32_t>());
 
     // Read the texture data.
     auto textureWidth = reader->Read<uint32_t>();
@@ -145,13 +234,18 @@ SpriteFont::Impl::Impl(
         textureFormat = LoaderHelpers::MakeSRGB(textureFormat);
     }
 
-    // Create the D3D texture.
+    // Create the D3D texture. The initial data is read straight from the reader's memory.
     CreateTextureResource(
         device,
         textureWidth, textureHeight,
         textureFormat,
         textureStride, textureRows,
         textureData);
+
+    if (file && glyphs == glyphData)
+    {
+        fileMapping = std::move(*file);
+    }
 }
 
 
@@ -160,134 +254,404 @@ _Use_decl_annotations_
 SpriteFont::Impl::Impl(
     ID3D11ShaderResourceView* itexture,
     Glyph const* iglyphs,
-    size_t glyphCount,
+    size_t iglyphCount,
     float ilineSpacing) noexcept(false) :
     texture(itexture),
-    glyphs(iglyphs, iglyphs + glyphCount),
+    glyphs(nullptr),
+    glyphCount(iglyphCount),
     defaultGlyph(nullptr),
     lineSpacing(ilineSpacing),
-    utfBufferSize(0)
+    glyphStorage(iglyphs, iglyphs + iglyphCount),
+    layoutGeneration(0)
 {
-    if (!std::is_sorted(iglyphs, iglyphs + glyphCount))
+    if (!std::is_sorted(iglyphs, iglyphs + iglyphCount))
     {
         throw std::runtime_error("Glyphs must be in ascending codepoint order");
     }
 
-    glyphsIndex.reserve(glyphs.size());
+    glyphs = glyphStorage.data();
 
-    for (auto& glyph : glyphs)
+    BuildGlyphLookup();
+    BuildGlyphMetrics();
+}
+
+
+// Builds the table that maps characters to glyphs.
+void SpriteFont::Impl::BuildGlyphLookup()
+{
+    std::vector<uint32_t> characters;
+    characters.reserve(glyphCount);
+
+    for (size_t i = 0; i < glyphCount; i++)
     {
-        glyphsIndex.emplace_back(glyph.Character);
+        characters.emplace_back(glyphs[i].Character);
     }
+
+    glyphLookup.Build(characters.data(), characters.size());
 }
 
 
-// Looks up the requested glyph, falling back to the default character if it is not in the font.
-SpriteFont::Glyph const* SpriteFont::Impl::FindGlyph(wchar_t character) const
+// Precomputes the per-glyph data used by MeasureGlyphs. Depends on the line spacing and the default glyph.
+void SpriteFont::Impl::BuildGlyphMetrics()
 {
-    // Rather than use std::lower_bound (which includes a slow debug path when built for _DEBUG),
-    // we implement a binary search inline to ensure sufficient Debug build performance to be useful
-    // for text-heavy applications.
+    glyphMetrics.Build(glyphs, glyphCount, defaultGlyph, lineSpacing);
+}
+
 
-    size_t lower = 0;
-    size_t higher = glyphs.size() - 1;
-    size_t index = higher / 2;
-    const size_t size = glyphs.size();
+// Looks up the requested glyph, falling back to the default character if it is not in the font.
+SpriteFont::Glyph const* SpriteFont::Impl::FindGlyph(uint32_t character) const
+{
+    const uint32_t index = glyphLookup.Find(character);
 
-    while (index < size)
+    if (index != GlyphLookupTable::NotFound)
     {
-        const auto curChar = glyphsIndex[index];
-        if (curChar == character) { return &glyphs[index]; }
-        if (curChar < character)
-        {
-            lower = index + 1;
-        }
-        else
-        {
-            higher = index - 1;
-        }
-        if (higher < lower) { break; }
-        else if (higher - lower <= 4)
-        {
-            for (index = lower; index <= higher; index++)
-            {
-                if (glyphsIndex[index] == character)
-                {
-                    return &glyphs[index];
-                }
-            }
-        }
-        index = lower + ((higher - lower) / 2);
+        return &glyphs[index];
     }
 
+    // Missing characters all share the default glyph, which is looked up once when it is set.
     if (defaultGlyph)
     {
         return defaultGlyph;
     }
 
-    DebugTrace("ERROR: SpriteFont encountered a character not in the font (%u, %C), and no default glyph was provided\n", character, character);
+    DebugTrace("ERROR: SpriteFont encountered a character not in the font (U+%04X), and no default glyph was provided\n", character);
     throw std::runtime_error("Character not in font");
 }
 
 
 // Sets the missing-character fallback glyph.
-void SpriteFont::Impl::SetDefaultCharacter(wchar_t character)
+void SpriteFont::Impl::SetDefaultCharacter(uint32_t character)
 {
     defaultGlyph = nullptr;
 
+    // Existing layouts may have used the old default glyph.
+    InvalidateLayouts();
+
     if (character)
     {
         defaultGlyph = FindGlyph(character);
     }
+
+    BuildGlyphMetrics();
 }
 
 
-// The core glyph layout algorithm, shared between DrawString and MeasureString.
-template<typename TAction>
-void SpriteFont::Impl::ForEachGlyph(_In_z_ wchar_t const* text, TAction action, bool ignoreWhitespace) const
+// The core glyph layout algorithm, used by DrawString. Measuring goes through MeasureGlyphs instead.
+template<typename TChar, typename TAction>
+void SpriteFont::Impl::ForEachGlyph(_In_z_ TChar const* text, TAction action, bool ignoreWhitespace) const
 {
-    float x = 0;
-    float y = 0;
+    LayoutGlyphs(text, lineSpacing, ignoreWhitespace,
+        [this](uint32_t character) { return FindGlyph(character); },
+        action,
+        [](float) noexcept {});
+}
+
+
+namespace
+{
+    static_assert(SpriteEffects_FlipHorizontally == 1 &&
+        SpriteEffects_FlipVertically == 2, "If you change these enum values, the following table and GlyphRunWriter must be updated to match");
+
+    // Lookup table indicates which axes are mirrored for each SpriteEffects enum value.
+    const XMVECTORF32 axisIsMirroredTable[4] =
+    {
+        { { { 0, 0, 0, 0 } } },
+        { { { 1, 0, 0, 0 } } },
+        { { { 0, 1, 0, 0 } } },
+        { { { 1, 1, 0, 0 } } },
+    };
+
+    // If the text is mirrored, offsets the start position by the size of the text.
+    inline XMVECTOR XM_CALLCONV MirroredBaseOffset(FXMVECTOR origin, FXMVECTOR textSize, SpriteEffects effects) noexcept
+    {
+        if (!effects)
+            return origin;
+
+        return XMVectorNegativeMultiplySubtract(textSize, axisIsMirroredTable[effects & 3], origin);
+    }
 
-    for (; *text; text++)
+    using GlyphRun = GlyphRunWriter<SpriteRunElement>;
+
+    // Points a GlyphRunWriter at a string drawn at position, with the origin adjusted by MirroredBaseOffset.
+    inline void XM_CALLCONV SetGlyphRunPlacement(GlyphRun& run, FXMVECTOR position, FXMVECTOR baseOffset, SpriteEffects effects) noexcept
+    {
+        XMFLOAT4 placement;
+        XMStoreFloat4(&placement, XMVectorPermute<0, 1, 4, 5>(position, baseOffset));
+
+        run.SetPlacement(placement.x, placement.y, placement.z, placement.w, effects);
+    }
+
+    // Grows result to cover a glyph placed at x, y by the layout, drawn at position.
+    inline void AddGlyphDrawBounds(RECT& result, _In_ SpriteFont::Glyph const* glyph, float x, float y, float advance, XMFLOAT2 const& position, float lineSpacing) noexcept
     {
-        const wchar_t character = *text;
+        auto const isWhitespace = IsWhitespaceCharacter(glyph->Character);
+        auto const w = static_cast<float>(glyph->Subrect.right - glyph->Subrect.left);
+        auto const h = isWhitespace ?
+            lineSpacing :
+            static_cast<float>(glyph->Subrect.bottom - glyph->Subrect.top);
+
+        const float minX = position.x + x;
+        const float minY = position.y + y + (isWhitespace ? 0.0f : glyph->YOffset);
 
-        switch (character)
+        const float maxX = std::max(minX + advance, minX + w);
+        const float maxY = minY + h;
+
+        if (minX < float(result.left))
+            result.left = long(minX);
+
+        if (minY < float(result.top))
+            result.top = long(minY);
+
+        if (float(result.right) < maxX)
+            result.right = long(maxX);
+
+        if (float(result.bottom) < maxY)
+            result.bottom = long(maxY);
+    }
+
+    // Converts the bounds from MeasureGlyphs to whole pixels, with the same results as AddGlyphDrawBounds.
+    inline RECT GetDrawBounds(GlyphMetricsResult const& metrics) noexcept
+    {
+        RECT result = { 0, 0, 0, 0 };
+
+        if (metrics.glyphCount > 0)
+        {
+            result.left = long(metrics.left);
+            result.top = long(metrics.top);
+        }
+
+        if (metrics.right > 0)
+            result.right = long(metrics.right);
+
+        if (metrics.bottom > 0)
+            result.bottom = long(metrics.bottom);
+
+        return result;
+    }
+
+    inline TextMetrics GetTextMetrics(GlyphMetricsResult const& metrics) noexcept
+    {
+        TextMetrics result;
+
+        result.size = XMFLOAT2(metrics.width, metrics.height);
+        result.drawBounds = GetDrawBounds(metrics);
+        result.lineCount = metrics.lineCount;
+
+        return result;
+    }
+}
+
+
+// Lays out and draws a string.
+template<typename TChar>
+void XM_CALLCONV SpriteFont::Impl::DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ TChar const* text, FXMVECTOR position, FXMVECTOR color, float rotation, FXMVECTOR origin, GXMVECTOR scale, SpriteEffects effects, float layerDepth) const
+{
+    if (layoutCache.GetCapacity() > 0)
+    {
+        GetCachedLayout(text)->Draw(spriteBatch, position, color, rotation, origin, scale, effects, layerDepth);
+        return;
+    }
+
+    const XMVECTOR baseOffset = effects ? MirroredBaseOffset(origin, MeasureString(text, true), effects) : origin;
+
+    // Glyphs are handed to the SpriteBatch a chunk at a time, rather than with one Draw call each.
+    GlyphRun run;
+    SetGlyphRunPlacement(run, position, baseOffset, effects);
+
+    auto flush = [&](SpriteRunElement const* elements, size_t count)
+        {
+            spriteBatch->DrawRun(texture.Get(), elements, count, color, rotation, scale, effects, layerDepth);
+        };
+
+    ForEachGlyph(text, [&](Glyph const* glyph, float x, float y, float advance)
         {
-        case '\r':
-            // Skip carriage returns.
-            continue;
+            UNREFERENCED_PARAMETER(advance);
+
+            run.Add(glyph, x, y, flush);
+        }, true);
+
+    run.Flush(flush);
+}
+
+
+// Measures the size of a string as laid out by DrawString.
+template<typename TChar>
+XMVECTOR SpriteFont::Impl::MeasureString(_In_z_ TChar const* text, bool ignoreWhitespace) const
+{
+    if (ignoreWhitespace && layoutCache.GetCapacity() > 0)
+    {
+        auto layout = GetCachedLayout(text);
+
+        return XMVectorSet(layout->layout.GetWidth(), layout->layout.GetHeight(), 0, 0);
+    }
+
+    auto const metrics = MeasureGlyphs(text, Float2Zero, ignoreWhitespace);
 
-        case '\n':
-            // New line.
-            x = 0;
-            y += lineSpacing;
-            break;
+    return XMVectorSet(metrics.width, metrics.height, 0, 0);
+}
+
+
+// Measures the pixel rectangle a string covers when drawn at the given position.
+template<typename TChar>
+RECT SpriteFont::Impl::MeasureDrawBounds(_In_z_ TChar const* text, XMFLOAT2 const& position, bool ignoreWhitespace) const
+{
+    if (ignoreWhitespace && layoutCache.GetCapacity() > 0)
+    {
+        return GetCachedLayout(text)->GetDrawBounds(position);
+    }
 
-        default:
-            // Output this character.
-            auto glyph = FindGlyph(character);
+    return GetDrawBounds(MeasureGlyphs(text, position, ignoreWhitespace));
+}
 
-            x += glyph->XOffset;
 
-            if (x < 0)
-                x = 0;
+// Lays out a string and measures it in one pass, with no whitespace classification or glyph
+// lookups beyond finding each glyph's index.
+template<typename TChar>
+GlyphMetricsResult SpriteFont::Impl::MeasureGlyphs(_In_z_ TChar const* text, XMFLOAT2 const& position, bool ignoreWhitespace) const
+{
+    return glyphMetrics.Measure(text, lineSpacing, ignoreWhitespace, position.x, position.y,
+        [this](uint32_t character) -> size_t
+        {
+            const uint32_t index = glyphLookup.Find(character);
 
-            const float advance = float(glyph->Subrect.right) - float(glyph->Subrect.left) + glyph->XAdvance;
+            if (index != GlyphLookupTable::NotFound)
+            {
+                return index;
+            }
 
-            if (!ignoreWhitespace
-                || !iswspace(character)
-                || ((glyph->Subrect.right - glyph->Subrect.left) > 1)
-                || ((glyph->Subrect.bottom - glyph->Subrect.top) > 1))
+            if (!defaultGlyph)
             {
-                action(glyph, x, y, advance);
+                DebugTrace("ERROR: SpriteFont encountered a character not in the font (U+%04X), and no default glyph was provided\n", character);
+                throw std::runtime_error("Character not in font");
             }
 
-            x += advance;
-            break;
+            return glyphMetrics.GetDefaultIndex(IsWhitespaceCharacter(character));
+        });
+}
+
+
+// Lays out a string once, so it can be drawn and measured repeatedly.
+template<typename TChar>
+std::shared_ptr<TextLayout::Impl const> SpriteFont::Impl::CreateLayout(_In_z_ TChar const* text, GlyphLayoutOptions const& options) const
+{
+    auto layout = std::make_shared<TextLayout::Impl>();
+
+    layout->texture = texture;
+    layout->lineSpacing = lineSpacing;
+    layout->font = this;
+    layout->fontGeneration = layoutGeneration;
+    layout->layout.Build(text, lineSpacing, options, [this](uint32_t character) { return FindGlyph(character); });
+
+    return layout;
+}
+
+
+// Lays out a string that may share a prefix with an earlier layout, reusing the lines before the first difference.
+template<typename TChar>
+std::shared_ptr<TextLayout::Impl const> SpriteFont::Impl::UpdateLayout(_In_opt_ TextLayout::Impl const* previous, _In_z_ TChar const* text) const
+{
+    if (!previous)
+        return CreateLayout(text);
+
+    if (previous->font != this)
+        throw std::invalid_argument("Layout was created by a different SpriteFont");
+
+    // If the font has changed since, none of the previous layout can be trusted.
+    if (previous->fontGeneration != layoutGeneration)
+        return CreateLayout(text, previous->layout.GetOptions());
+
+    // Layouts are shared and immutable, so update a copy.
+    auto layout = std::make_shared<TextLayout::Impl>(*previous);
+
+    layout->layout.Update(text, [this](uint32_t character) { return FindGlyph(character); });
+
+    return layout;
+}
+
+
+// Converts the public layout options.
+GlyphLayoutOptions SpriteFont::Impl::GetLayoutOptions(TextLayoutOptions const& options) const
+{
+    // Compared as integers, since comparing different enumeration types is deprecated.
+    static_assert(uint32_t(TextWrapping_None) == uint32_t(GlyphLayoutOptions::WrapNone)
+        && uint32_t(TextWrapping_Word) == uint32_t(GlyphLayoutOptions::WrapWord)
+        && uint32_t(TextWrapping_Character) == uint32_t(GlyphLayoutOptions::WrapCharacter), "TextWrapping must match GlyphLayoutOptions::Wrapping");
+
+    static_assert(uint32_t(TextAlignment_Left) == uint32_t(GlyphLayoutOptions::AlignLeft)
+        && uint32_t(TextAlignment_Center) == uint32_t(GlyphLayoutOptions::AlignCenter)
+        && uint32_t(TextAlignment_Right) == uint32_t(GlyphLayoutOptions::AlignRight), "TextAlignment must match GlyphLayoutOptions::Alignment");
+
+    if (options.wrapping > TextWrapping_Character)
+        throw std::invalid_argument("Invalid wrapping mode");
+
+    if (options.alignment > TextAlignment_Right)
+        throw std::invalid_argument("Invalid alignment");
+
+    GlyphLayoutOptions result = {};
+
+    result.maxWidth = options.maxWidth;
+    result.maxHeight = options.maxHeight;
+    result.wrapping = static_cast<GlyphLayoutOptions::Wrapping>(options.wrapping);
+    result.alignment = static_cast<GlyphLayoutOptions::Alignment>(options.alignment);
+
+    if (options.ellipsis)
+    {
+        if (ContainsCharacter(0x2026))
+        {
+            result.ellipsis[0] = 0x2026;
+            result.ellipsisLength = 1;
+        }
+        else
+        {
+            result.ellipsis[0] = result.ellipsis[1] = result.ellipsis[2] = '.';
+            result.ellipsisLength = 3;
         }
     }
+
+    return result;
+}
+
+
+// Replays a layout into a SpriteBatch.
+_Use_decl_annotations_
+void XM_CALLCONV TextLayout::Impl::Draw(SpriteBatch* spriteBatch, FXMVECTOR position, FXMVECTOR color, float rotation, FXMVECTOR origin, GXMVECTOR scale, SpriteEffects effects, float layerDepth) const
+{
+    const XMVECTOR baseOffset = MirroredBaseOffset(origin, XMVectorSet(layout.GetWidth(), layout.GetHeight(), 0, 0), effects);
+
+    GlyphRun run;
+    SetGlyphRunPlacement(run, position, baseOffset, effects);
+
+    auto flush = [&](SpriteRunElement const* elements, size_t count)
+        {
+            spriteBatch->DrawRun(texture.Get(), elements, count, color, rotation, scale, effects, layerDepth);
+        };
+
+    for (auto const& placed : layout.GetGlyphs())
+    {
+        run.Add(placed.glyph, placed.x, placed.y, flush);
+    }
+
+    run.Flush(flush);
+}
+
+
+// Measures the pixel rectangle a layout covers when drawn at the given position.
+RECT TextLayout::Impl::GetDrawBounds(XMFLOAT2 const& position) const noexcept
+{
+    RECT result = { LONG_MAX, LONG_MAX, 0, 0 };
+
+    for (auto const& placed : layout.GetGlyphs())
+    {
+        AddGlyphDrawBounds(result, placed.glyph, placed.x, placed.y, placed.advance, position, lineSpacing);
+    }
+
+    if (result.left == LONG_MAX)
+    {
+        result.left = 0;
+        result.top = 0;
+    }
+
+    return result;
 }
 
 
@@ -333,43 +697,27 @@ void SpriteFont::Impl::CreateTextureResource(
 }
 
 
-const wchar_t* SpriteFont::Impl::ConvertUTF8(_In_z_ const char *text) noexcept(false)
+// Construct from a binary file created by the MakeSpriteFont utility.
+// The file is mapped rather than read, so the texture data goes straight from the file to the
+// device. Unless keepFileMapped is false, the glyphs are also used in place, and the file stays
+// open for reading while the font exists.
+_Use_decl_annotations_
+SpriteFont::SpriteFont(ID3D11Device* device, wchar_t const* fileName, bool forceSRGB, bool keepFileMapped)
 {
-    if (!utfBuffer)
-    {
-        utfBufferSize = 1024;
-        utfBuffer.reset(new wchar_t[1024]);
-    }
-
-    int result = MultiByteToWideChar(CP_UTF8, 0, text, -1, utfBuffer.get(), static_cast<int>(utfBufferSize));
-    if (!result && (GetLastError() == ERROR_INSUFFICIENT_BUFFER))
-    {
-        // Compute required buffer size
-        result = MultiByteToWideChar(CP_UTF8, 0, text, -1, nullptr, 0);
-        utfBufferSize = AlignUp(static_cast<size_t>(result), 1024u);
-        utfBuffer.reset(new wchar_t[utfBufferSize]);
-
-        // Retry conversion
-        result = MultiByteToWideChar(CP_UTF8, 0, text, -1, utfBuffer.get(), static_cast<int>(utfBufferSize));
-    }
+    MappedFile file;
 
-    if (!result)
+    HRESULT hr = file.Open(fileName);
+    if (FAILED(hr))
     {
-        DebugTrace("ERROR: MultiByteToWideChar failed with error %u.\n", GetLastError());
-        throw std::system_error(std::error_code(static_cast<int>(GetLastError()), std::system_category()), "MultiByteToWideChar");
+        DebugTrace("ERROR: SpriteFont failed (%08X) to load '%ls'\n",
+            static_cast<unsigned int>(hr), fileName);
+        throw std::runtime_error("SpriteFont");
     }
 
-    return utfBuffer.get();
-}
-
-
-// Construct from a binary file created by the MakeSpriteFont utility.
-_Use_decl_annotations_
-SpriteFont::SpriteFont(ID3D11Device* device, wchar_t const* fileName, bool forceSRGB)
-{
-    BinaryReader reader(fileName);
+    BinaryReader reader(file.GetData(), file.GetSize());
 
-    pImpl = std::make_unique<Impl>(device, &reader, forceSRGB);
+    // Without the file, Impl copies the glyphs, and the mapping closes when this returns.
+    pImpl = std::make_unique<Impl>(device, &reader, forceSRGB, keepFileMapped ? &file : nullptr);
 }
 
 
@@ -417,125 +765,75 @@ void XM_CALLCONV SpriteFont::DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ wc
 
 void XM_CALLCONV SpriteFont::DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ wchar_t const* text, FXMVECTOR position, FXMVECTOR color, float rotation, FXMVECTOR origin, GXMVECTOR scale, SpriteEffects effects, float layerDepth) const
 {
-    static_assert(SpriteEffects_FlipHorizontally == 1 &&
-        SpriteEffects_FlipVertically == 2, "If you change these enum values, the following tables must be updated to match");
-
-// Lookup table indicates which way to move along each axis per SpriteEffects enum value.
-    static XMVECTORF32 axisDirectionTable[4] =
-    {
-        { { { -1, -1, 0, 0 } } },
-        { { {  1, -1, 0, 0 } } },
-        { { { -1,  1, 0, 0 } } },
-        { { {  1,  1, 0, 0 } } },
-    };
-
-    // Lookup table indicates which axes are mirrored for each SpriteEffects enum value.
-    static XMVECTORF32 axisIsMirroredTable[4] =
-    {
-        { { { 0, 0, 0, 0 } } },
-        { { { 1, 0, 0, 0 } } },
-        { { { 0, 1, 0, 0 } } },
-        { { { 1, 1, 0, 0 } } },
-    };
-
-    XMVECTOR baseOffset = origin;
-
-    // If the text is mirrored, offset the start position accordingly.
-    if (effects)
-    {
-        baseOffset = XMVectorNegativeMultiplySubtract(
-            MeasureString(text),
-            axisIsMirroredTable[effects & 3],
-            baseOffset);
-    }
-
-    // Draw each character in turn.
-    pImpl->ForEachGlyph(text, [&](Glyph const* glyph, float x, float y, float advance)
-        {
-            UNREFERENCED_PARAMETER(advance);
-
-            XMVECTOR offset = XMVectorMultiplyAdd(XMVectorSet(x, y + glyph->YOffset, 0, 0), axisDirectionTable[effects & 3], baseOffset);
+    pImpl->DrawString(spriteBatch, text, position, color, rotation, origin, scale, effects, layerDepth);
+}
 
-            if (effects)
-            {
-                // For mirrored characters, specify bottom and/or right instead of top left.
-                XMVECTOR glyphRect = XMConvertVectorIntToFloat(XMLoadInt4(reinterpret_cast<uint32_t const*>(&glyph->Subrect)), 0);
 
-                // xy = glyph width/height.
-                glyphRect = XMVectorSubtract(XMVectorSwizzle<2, 3, 0, 1>(glyphRect), glyphRect);
+XMVECTOR XM_CALLCONV SpriteFont::MeasureString(_In_z_ wchar_t const* text, bool ignoreWhitespace) const
+{
+    return pImpl->MeasureString(text, ignoreWhitespace);
+}
 
-                offset = XMVectorMultiplyAdd(glyphRect, axisIsMirroredTable[effects & 3], offset);
-            }
 
-            spriteBatch->Draw(pImpl->texture.Get(), position, &glyph->Subrect, color, rotation, offset, scale, effects, layerDepth);
-        }, true);
+RECT SpriteFont::MeasureDrawBounds(_In_z_ wchar_t const* text, XMFLOAT2 const& position, bool ignoreWhitespace) const
+{
+    return pImpl->MeasureDrawBounds(text, position, ignoreWhitespace);
 }
 
 
-XMVECTOR XM_CALLCONV SpriteFont::MeasureString(_In_z_ wchar_t const* text, bool ignoreWhitespace) const
+RECT XM_CALLCONV SpriteFont::MeasureDrawBounds(_In_z_ wchar_t const* text, FXMVECTOR position, bool ignoreWhitespace) const
 {
-    XMVECTOR result = XMVectorZero();
+    XMFLOAT2 pos;
+    XMStoreFloat2(&pos, position);
 
-    pImpl->ForEachGlyph(text, [&](Glyph const* glyph, float x, float y, float advance)
-        {
-            UNREFERENCED_PARAMETER(advance);
+    return MeasureDrawBounds(text, pos, ignoreWhitespace);
+}
 
-            auto const w = static_cast<float>(glyph->Subrect.right - glyph->Subrect.left);
-            auto h = static_cast<float>(glyph->Subrect.bottom - glyph->Subrect.top) + glyph->YOffset;
 
-            h = iswspace(wchar_t(glyph->Character)) ?
-                pImpl->lineSpacing :
-                std::max(h, pImpl->lineSpacing);
+TextMetrics SpriteFont::MeasureText(_In_z_ wchar_t const* text, XMFLOAT2 const& position, bool ignoreWhitespace) const
+{
+    return GetTextMetrics(pImpl->MeasureGlyphs(text, position, ignoreWhitespace));
+}
 
-            result = XMVectorMax(result, XMVectorSet(x + w, y + h, 0, 0));
-        }, ignoreWhitespace);
 
-    return result;
+// UTF-8
+void XM_CALLCONV SpriteFont::DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ char const* text, XMFLOAT2 const& position, FXMVECTOR color, float rotation, XMFLOAT2 const& origin, float scale, SpriteEffects effects, float layerDepth) const
+{
+    DrawString(spriteBatch, text, XMLoadFloat2(&position), color, rotation, XMLoadFloat2(&origin), XMVectorReplicate(scale), effects, layerDepth);
 }
 
 
-RECT SpriteFont::MeasureDrawBounds(_In_z_ wchar_t const* text, XMFLOAT2 const& position, bool ignoreWhitespace) const
+void XM_CALLCONV SpriteFont::DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ char const* text, XMFLOAT2 const& position, FXMVECTOR color, float rotation, XMFLOAT2 const& origin, XMFLOAT2 const& scale, SpriteEffects effects, float layerDepth) const
 {
-    RECT result = { LONG_MAX, LONG_MAX, 0, 0 };
-
-    pImpl->ForEachGlyph(text, [&](Glyph const* glyph, float x, float y, float advance) noexcept
-        {
-            auto const isWhitespace = iswspace(wchar_t(glyph->Character));
-            auto const w = static_cast<float>(glyph->Subrect.right - glyph->Subrect.left);
-            auto const h = isWhitespace ?
-                pImpl->lineSpacing :
-                static_cast<float>(glyph->Subrect.bottom - glyph->Subrect.top);
+    DrawString(spriteBatch, text, XMLoadFloat2(&position), color, rotation, XMLoadFloat2(&origin), XMLoadFloat2(&scale), effects, layerDepth);
+}
 
-            const float minX = position.x + x;
-            const float minY = position.y + y + (isWhitespace ? 0.0f : glyph->YOffset);
 
-            const float maxX = std::max(minX + advance, minX + w);
-            const float maxY = minY + h;
+void XM_CALLCONV SpriteFont::DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ char const* text, FXMVECTOR position, FXMVECTOR color, float rotation, FXMVECTOR origin, float scale, SpriteEffects effects, float layerDepth) const
+{
+    DrawString(spriteBatch, text, position, color, rotation, origin, XMVectorReplicate(scale), effects, layerDepth);
+}
 
-            if (minX < float(result.left))
-                result.left = long(minX);
 
-            if (minY < float(result.top))
-                result.top = long(minY);
+void XM_CALLCONV SpriteFont::DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ char const* text, FXMVECTOR position, FXMVECTOR color, float rotation, FXMVECTOR origin, GXMVECTOR scale, SpriteEffects effects, float layerDepth) const
+{
+    pImpl->DrawString(spriteBatch, text, position, color, rotation, origin, scale, effects, layerDepth);
+}
 
-            if (float(result.right) < maxX)
-                result.right = long(maxX);
 
-            if (float(result.bottom) < maxY)
-                result.bottom = long(maxY);
-        }, ignoreWhitespace);
+XMVECTOR XM_CALLCONV SpriteFont::MeasureString(_In_z_ char const* text, bool ignoreWhitespace) const
+{
+    return pImpl->MeasureString(text, ignoreWhitespace);
+}
 
-    if (result.left == LONG_MAX)
-    {
-        result.left = 0;
-        result.top = 0;
-    }
 
-    return result;
+RECT SpriteFont::MeasureDrawBounds(_In_z_ char const* text, XMFLOAT2 const& position, bool ignoreWhitespace) const
+{
+    return pImpl->MeasureDrawBounds(text, position, ignoreWhitespace);
 }
 
 
-RECT XM_CALLCONV SpriteFont::MeasureDrawBounds(_In_z_ wchar_t const* text, FXMVECTOR position, bool ignoreWhitespace) const
+RECT XM_CALLCONV SpriteFont::MeasureDrawBounds(_In_z_ char const* text, FXMVECTOR position, bool ignoreWhitespace) const
 {
     XMFLOAT2 pos;
     XMStoreFloat2(&pos, position);
@@ -544,49 +842,70 @@ RECT XM_CALLCONV SpriteFont::MeasureDrawBounds(_In_z_ wchar_t const* text, FXMVE
 }
 
 
-// UTF-8
-void XM_CALLCONV SpriteFont::DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ char const* text, XMFLOAT2 const& position, FXMVECTOR color, float rotation, XMFLOAT2 const& origin, float scale, SpriteEffects effects, float layerDepth) const
+TextMetrics SpriteFont::MeasureText(_In_z_ char const* text, XMFLOAT2 const& position, bool ignoreWhitespace) const
 {
-    DrawString(spriteBatch, pImpl->ConvertUTF8(text), XMLoadFloat2(&position), color, rotation, XMLoadFloat2(&origin), XMVectorReplicate(scale), effects, layerDepth);
+    return GetTextMetrics(pImpl->MeasureGlyphs(text, position, ignoreWhitespace));
 }
 
 
-void XM_CALLCONV SpriteFont::DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ char const* text, XMFLOAT2 const& position, FXMVECTOR color, float rotation, XMFLOAT2 const& origin, XMFLOAT2 const& scale, SpriteEffects effects, float layerDepth) const
+// Layouts
+TextLayout SpriteFont::CreateLayout(_In_z_ wchar_t const* text) const
+{
+    TextLayout result;
+    result.pImpl = pImpl->CreateLayout(text);
+    return result;
+}
+
+
+TextLayout SpriteFont::CreateLayout(_In_z_ char const* text) const
 {
-    DrawString(spriteBatch, pImpl->ConvertUTF8(text), XMLoadFloat2(&position), color, rotation, XMLoadFloat2(&origin), XMLoadFloat2(&scale), effects, layerDepth);
+    TextLayout result;
+    result.pImpl = pImpl->CreateLayout(text);
+    return result;
 }
 
 
-void XM_CALLCONV SpriteFont::DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ char const* text, FXMVECTOR position, FXMVECTOR color, float rotation, FXMVECTOR origin, float scale, SpriteEffects effects, float layerDepth) const
+TextLayout SpriteFont::CreateLayout(_In_z_ wchar_t const* text, TextLayoutOptions const& options) const
 {
-    DrawString(spriteBatch, pImpl->ConvertUTF8(text), position, color, rotation, origin, XMVectorReplicate(scale), effects, layerDepth);
+    TextLayout result;
+    result.pImpl = pImpl->CreateLayout(text, pImpl->GetLayoutOptions(options));
+    return result;
 }
 
 
-void XM_CALLCONV SpriteFont::DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ char const* text, FXMVECTOR position, FXMVECTOR color, float rotation, FXMVECTOR origin, GXMVECTOR scale, SpriteEffects effects, float layerDepth) const
+TextLayout SpriteFont::CreateLayout(_In_z_ char const* text, TextLayoutOptions const& options) const
 {
-    DrawString(spriteBatch, pImpl->ConvertUTF8(text), position, color, rotation, origin, scale, effects, layerDepth);
+    TextLayout result;
+    result.pImpl = pImpl->CreateLayout(text, pImpl->GetLayoutOptions(options));
+    return result;
 }
 
 
-XMVECTOR XM_CALLCONV SpriteFont::MeasureString(_In_z_ char const* text, bool ignoreWhitespace) const
+TextLayout SpriteFont::UpdateLayout(TextLayout const& previous, _In_z_ wchar_t const* text) const
 {
-    return MeasureString(pImpl->ConvertUTF8(text), ignoreWhitespace);
+    TextLayout result;
+    result.pImpl = pImpl->UpdateLayout(previous.pImpl.get(), text);
+    return result;
 }
 
 
-RECT SpriteFont::MeasureDrawBounds(_In_z_ char const* text, XMFLOAT2 const& position, bool ignoreWhitespace) const
+TextLayout SpriteFont::UpdateLayout(TextLayout const& previous, _In_z_ char const* text) const
 {
-    return MeasureDrawBounds(pImpl->ConvertUTF8(text), position, ignoreWhitespace);
+    TextLayout result;
+    result.pImpl = pImpl->UpdateLayout(previous.pImpl.get(), text);
+    return result;
 }
 
 
-RECT XM_CALLCONV SpriteFont::MeasureDrawBounds(_In_z_ char const* text, FXMVECTOR position, bool ignoreWhitespace) const
+void SpriteFont::SetLayoutCacheSize(size_t maxEntries)
 {
-    XMFLOAT2 pos;
-    XMStoreFloat2(&pos, position);
+    pImpl->layoutCache.SetCapacity(maxEntries);
+}
 
-    return MeasureDrawBounds(pImpl->ConvertUTF8(text), pos, ignoreWhitespace);
+
+size_t SpriteFont::GetLayoutCacheSize() const noexcept
+{
+    return pImpl->layoutCache.GetCapacity();
 }
 
 
@@ -600,13 +919,23 @@ float SpriteFont::GetLineSpacing() const noexcept
 void SpriteFont::SetLineSpacing(float spacing)
 {
     pImpl->lineSpacing = spacing;
+    pImpl->BuildGlyphMetrics();
+
+    // Existing layouts were made with the old spacing.
+    pImpl->InvalidateLayouts();
 }
 
 
 // Font properties
 wchar_t SpriteFont::GetDefaultCharacter() const noexcept
 {
-    return static_cast<wchar_t>(pImpl->defaultGlyph ? pImpl->defaultGlyph->Character : 0);
+    return static_cast<wchar_t>(GetDefaultCodePoint());
+}
+
+
+uint32_t SpriteFont::GetDefaultCodePoint() const noexcept
+{
+    return pImpl->defaultGlyph ? pImpl->defaultGlyph->Character : 0;
 }
 
 
@@ -618,7 +947,7 @@ void SpriteFont::SetDefaultCharacter(wchar_t character)
 
 bool SpriteFont::ContainsCharacter(wchar_t character) const
 {
-    return std::binary_search(pImpl->glyphs.begin(), pImpl->glyphs.end(), character);
+    return pImpl->ContainsCharacter(character);
 }
 
 
@@ -636,3 +965,75 @@ void SpriteFont::GetSpriteSheet(ID3D11ShaderResourceView** texture) const
 
     ThrowIfFailed(pImpl->texture.CopyTo(texture));
 }
+
+
+//--------------------------------------------------------------------------------------
+// TextLayout
+//--------------------------------------------------------------------------------------
+
+TextLayout::TextLayout() noexcept = default;
+TextLayout::TextLayout(TextLayout&&) noexcept = default;
+TextLayout& TextLayout::operator= (TextLayout&&) noexcept = default;
+TextLayout::TextLayout(TextLayout const&) = default;
+TextLayout& TextLayout::operator= (TextLayout const&) = default;
+TextLayout::~TextLayout() = default;
+
+
+void XM_CALLCONV TextLayout::Draw(_In_ SpriteBatch* spriteBatch, FXMVECTOR position, FXMVECTOR color, float rotation, FXMVECTOR origin, float scale, SpriteEffects effects, float layerDepth) const
+{
+    Draw(spriteBatch, position, color, rotation, origin, XMVectorReplicate(scale), effects, layerDepth);
+}
+
+
+void XM_CALLCONV TextLayout::Draw(_In_ SpriteBatch* spriteBatch, FXMVECTOR position, FXMVECTOR color, float rotation, FXMVECTOR origin, GXMVECTOR scale, SpriteEffects effects, float layerDepth) const
+{
+    if (pImpl)
+    {
+        pImpl->Draw(spriteBatch, position, color, rotation, origin, scale, effects, layerDepth);
+    }
+}
+
+
+XMVECTOR XM_CALLCONV TextLayout::GetSize() const noexcept
+{
+    if (!pImpl)
+        return XMVectorZero();
+
+    return XMVectorSet(pImpl->layout.GetWidth(), pImpl->layout.GetHeight(), 0, 0);
+}
+
+
+RECT TextLayout::GetDrawBounds(XMFLOAT2 const& position) const noexcept
+{
+    if (!pImpl)
+        return RECT{};
+
+    return pImpl->GetDrawBounds(position);
+}
+
+
+size_t TextLayout::GetGlyphCount() const noexcept
+{
+    return pImpl ? pImpl->layout.GetGlyphs().size() : 0;
+}
+
+
+size_t TextLayout::GetLineCount() const noexcept
+{
+    return pImpl ? pImpl->layout.GetLines().size() : 0;
+}
+
+
+float TextLayout::GetLineWidth(size_t line) const
+{
+    if (line >= GetLineCount())
+        throw std::out_of_range("Line index out of range");
+
+    return pImpl->layout.GetLines()[line].width;
+}
+
+
+bool TextLayout::IsTruncated() const noexcept
+{
+    return pImpl ? pImpl->layout.IsTruncated() : false;
+}
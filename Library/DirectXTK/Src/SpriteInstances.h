@@ -0,0 +1,161 @@
+//--------------------------------------------------------------------------------------
+// File: SpriteInstances.h
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <DirectXMath.h>
+
+#include <algorithm>
+#include <cstddef>
+
+
+namespace DirectX
+{
+    // One sprite as read by the instanced sprite vertex shader, which expands it into four
+    // corners. This is 64 bytes, compared to 144 for four VertexPositionColorTexture vertices.
+    XM_ALIGNED_STRUCT(16) SpriteInstance
+    {
+        XMFLOAT4 positionAxisX;         // xy = position of the top left corner, zw = offset to the top right corner
+        XMFLOAT4 axisYDepthSlot;        // xy = offset to the bottom left corner, z = depth, w = texture slot
+        XMFLOAT4 textureCoordinates;    // xy = texture coordinate of the top left corner, zw = offset to the bottom right one
+        XMFLOAT4 color;
+    };
+
+    static_assert(sizeof(SpriteInstance) == 64, "Instance layout must match the SpriteVertexShaderInstanced inputs");
+
+
+    // Fills an instance from a sprite whose parameters have already been resolved:
+    //  destination = position (xy) and size (zw) in pixels
+    //  source = texture coordinate (xy) and size (zw), normalized
+    //  originRotationDepth = origin as a fraction of the size (xy), rotation (z) and depth (w)
+    // The corner positions match those computed by the vertex path in SpriteBatch.
+    inline void XM_CALLCONV PackSpriteInstance(_Out_ SpriteInstance* instance,
+        FXMVECTOR destination,
+        FXMVECTOR source,
+        FXMVECTOR color,
+        GXMVECTOR originRotationDepth,
+        unsigned int mirrorBits,
+        unsigned int textureSlot) noexcept
+    {
+        XMFLOAT4A dest;
+        XMFLOAT4A ord;
+        XMStoreFloat4A(&dest, destination);
+        XMStoreFloat4A(&ord, originRotationDepth);
+
+        float sin = 0;
+        float cos = 1;
+
+        if (ord.z != 0)
+        {
+            XMScalarSinCos(&sin, &cos, ord.z);
+        }
+
+        // Offset from the rotation origin to the top left corner, before rotating.
+        const float offsetX = -ord.x * dest.z;
+        const float offsetY = -ord.y * dest.w;
+
+        instance->positionAxisX = XMFLOAT4(
+            dest.x + offsetX * cos - offsetY * sin,
+            dest.y + offsetX * sin + offsetY * cos,
+            dest.z * cos,
+            dest.z * sin);
+
+        instance->axisYDepthSlot = XMFLOAT4(
+            -dest.w * sin,
+            dest.w * cos,
+            ord.w,
+            static_cast<float>(textureSlot));
+
+        // Mirroring swaps the texture coordinates of opposite edges, which is the same as
+        // starting from the far edge and stepping backwards.
+        XMFLOAT4A uv;
+        XMStoreFloat4A(&uv, source);
+
+        if (mirrorBits & 1)
+        {
+            uv.x += uv.z;
+            uv.z = -uv.z;
+        }
+
+        if (mirrorBits & 2)
+        {
+            uv.y += uv.w;
+            uv.w = -uv.w;
+        }
+
+        instance->textureCoordinates = uv;
+
+        XMStoreFloat4(&instance->color, color);
+    }
+
+
+    // Hands out space in a dynamic buffer of instances that is filled front to back and then
+    // wrapped, so a batch never overwrites data the GPU may still be reading. Wrapping back to the
+    // start means the buffer must be mapped with discard. Batches are limited only by the buffer
+    // capacity, as instanced draws need no index buffer.
+    class SpriteInstanceRing
+    {
+    public:
+        struct Span
+        {
+            size_t start;
+            size_t count;
+            bool discard;
+            bool wrapped;   // Set if the buffer ran out of room, rather than this being its first use.
+        };
+
+        SpriteInstanceRing(size_t capacity, size_t minBatchSize) noexcept :
+            mCapacity(capacity),
+            mMinBatchSize(std::min(minBatchSize, capacity)),
+            mPosition(0)
+        {
+        }
+
+        // Reserves room for up to count instances, returning where they go and how many fit.
+        Span Reserve(size_t count) noexcept
+        {
+            const size_t remainingSpace = mCapacity - mPosition;
+
+            bool wrapped = false;
+
+            if (count > remainingSpace)
+            {
+                if (remainingSpace < mMinBatchSize)
+                {
+                    // If we are out of room, or about to submit an excessively small batch, wrap back to the start.
+                    wrapped = (mPosition > 0);
+                    mPosition = 0;
+
+                    count = std::min(count, mCapacity);
+                }
+                else
+                {
+                    // Take however many instances fit in what's left of the buffer.
+                    count = remainingSpace;
+                }
+            }
+
+            const Span span = { mPosition, count, mPosition == 0, wrapped };
+
+            mPosition += count;
+
+            return span;
+        }
+
+        // Makes the next reservation start over with a discard.
+        void Reset() noexcept { mPosition = 0; }
+
+        size_t GetCapacity() const noexcept { return mCapacity; }
+
+    private:
+        size_t mCapacity;
+        size_t mMinBatchSize;
+        size_t mPosition;
+    };
+}
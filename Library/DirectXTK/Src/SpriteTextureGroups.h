@@ -0,0 +1,149 @@
+//--------------------------------------------------------------------------------------
+// File: SpriteTextureGroups.h
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+
+
+namespace DirectX
+{
+    // Splits a sequence of sprites into groups that each reference at most a fixed number of
+    // distinct textures, so every group can be drawn with a single call by binding its textures
+    // to consecutive slots. Sprites are never reordered. The texture type is a template parameter
+    // so this logic does not depend on Direct3D.
+    template<typename TTexture, size_t MaxTextures>
+    class SpriteTextureGrouper
+    {
+    public:
+        static_assert(MaxTextures > 0 && MaxTextures <= 256, "Slot indices must fit in 8 bits");
+
+        struct Group
+        {
+            TTexture textures[MaxTextures];
+            size_t textureCount;
+            size_t firstSprite;
+            size_t spriteCount;
+        };
+
+        // getTexture(i) returns the texture of sprite i, and slots[i] receives the slot that sprite
+        // uses within its group. onGroup(group) is called for each completed group, in order.
+        template<typename TGetTexture, typename TOnGroup>
+        static void Build(size_t count,
+            size_t maxTextures,
+            TGetTexture&& getTexture,
+            _Out_writes_(count) uint8_t* slots,
+            TOnGroup&& onGroup)
+        {
+            assert(maxTextures > 0 && maxTextures <= MaxTextures);
+
+            Group group = {};
+            size_t lastSlot = 0;
+
+            for (size_t i = 0; i < count; i++)
+            {
+                const TTexture texture = getTexture(i);
+
+                // Consecutive sprites usually share a texture, so try the previous slot first.
+                // Otherwise search the group, which is small enough that a linear scan is fastest.
+                size_t slot = lastSlot;
+
+                if (slot >= group.textureCount || !(group.textures[slot] == texture))
+                {
+                    slot = 0;
+
+                    while (slot < group.textureCount && !(group.textures[slot] == texture))
+                    {
+                        slot++;
+                    }
+
+                    if (slot == group.textureCount)
+                    {
+                        // Start a new group once every slot is taken.
+                        if (group.textureCount == maxTextures)
+                        {
+                            onGroup(static_cast<Group const&>(group));
+
+                            group.textureCount = 0;
+                            group.firstSprite = i;
+                            group.spriteCount = 0;
+                            slot = 0;
+                        }
+
+                        group.textures[group.textureCount++] = texture;
+                    }
+                }
+
+                slots[i] = static_cast<uint8_t>(slot);
+                lastSlot = slot;
+
+                group.spriteCount++;
+            }
+
+            if (group.spriteCount > 0)
+            {
+                onGroup(static_cast<Group const&>(group));
+            }
+        }
+    };
+
+
+    // Caches a value computed from each texture, such as its size, so textures that appear in
+    // many batches are only queried once. Keys are not reference counted, so the owner must clear
+    // the cache before any texture it holds could be released and its address reused.
+    template<typename TTexture, typename TValue>
+    class SpriteTextureCache
+    {
+    public:
+        SpriteTextureCache() noexcept :
+            mLastTexture{},
+            mLastValue(nullptr)
+        {
+        }
+
+        template<typename TLookup>
+        TValue const& Get(TTexture const& texture, TLookup&& lookup)
+        {
+            if (mLastValue && mLastTexture == texture)
+                return *mLastValue;
+
+            auto it = mEntries.find(texture);
+
+            if (it == mEntries.end())
+            {
+                it = mEntries.emplace(texture, lookup(texture)).first;
+            }
+
+            // Elements of an unordered_map never move, so this pointer stays valid until Clear.
+            mLastTexture = texture;
+            mLastValue = &it->second;
+
+            return it->second;
+        }
+
+        void Clear() noexcept
+        {
+            mEntries.clear();
+            mLastTexture = TTexture{};
+            mLastValue = nullptr;
+        }
+
+        size_t Size() const noexcept { return mEntries.size(); }
+
+    private:
+        std::unordered_map<TTexture, TValue> mEntries;
+
+        TTexture mLastTexture;
+        TValue const* mLastValue;
+    };
+}
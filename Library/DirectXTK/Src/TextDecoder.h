@@ -0,0 +1,235 @@
+//--------------------------------------------------------------------------------------
+// File: TextDecoder.h
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cwchar>
+
+#if (defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)) && !defined(_XM_NO_INTRINSICS_)
+#define DIRECTX_TEXTDECODER_SSE2
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// The ASCII scan reads whole aligned blocks, which can include bytes past the terminator.
+#if defined(__clang__) || defined(__GNUC__)
+#define DIRECTX_TEXTDECODER_NO_SANITIZE __attribute__((no_sanitize_address))
+#elif defined(_MSC_VER)
+#define DIRECTX_TEXTDECODER_NO_SANITIZE __declspec(no_sanitize_address)
+#endif
+#endif
+
+#ifndef DIRECTX_TEXTDECODER_NO_SANITIZE
+#define DIRECTX_TEXTDECODER_NO_SANITIZE
+#endif
+
+
+namespace DirectX
+{
+    // Reads Unicode code points one at a time from a null terminated string, without copying it.
+    // Next returns 0 at the terminator, and keeps returning 0 if called again.
+    template<typename TChar>
+    class TextDecoder;
+
+
+    // UTF-8. Ill-formed sequences decode to U+FFFD, one per maximal invalid subpart, which matches
+    // what MultiByteToWideChar produces without MB_ERR_INVALID_CHARS.
+    template<>
+    class TextDecoder<char>
+    {
+    public:
+        static constexpr uint32_t ReplacementCharacter = 0xFFFD;
+
+        explicit TextDecoder(char const* text) noexcept :
+            mText(text),
+            mAsciiEnd(text)
+        {
+        }
+
+        uint32_t Next() noexcept
+        {
+            // Inside a run of ASCII already known to be free of terminators and multi-byte sequences.
+            if (mText < mAsciiEnd)
+                return static_cast<uint8_t>(*mText++);
+
+            const auto lead = static_cast<uint8_t>(*mText);
+
+            if (lead < 0x80)
+            {
+                if (!lead)
+                    return 0;
+
+                mAsciiEnd = FindAsciiEnd(mText);
+
+                return static_cast<uint8_t>(*mText++);
+            }
+
+            return DecodeSequence();
+        }
+
+    private:
+        // Returns the first byte at or after text that is either the terminator or not ASCII.
+        DIRECTX_TEXTDECODER_NO_SANITIZE static char const* FindAsciiEnd(char const* text) noexcept
+        {
+        #if defined(DIRECTX_TEXTDECODER_SSE2)
+            // Aligned loads never cross a page boundary, so reading the rest of the block that
+            // holds the terminator cannot fault.
+            const auto offset = static_cast<unsigned int>(reinterpret_cast<uintptr_t>(text) & 15);
+            auto block = reinterpret_cast<__m128i const*>(text - offset);
+
+            const __m128i zero = _mm_setzero_si128();
+
+            // The sign bit of each byte is set for non-ASCII bytes, and the compare sets it for the terminator.
+            __m128i data = _mm_load_si128(block);
+            auto mask = static_cast<unsigned int>(_mm_movemask_epi8(_mm_or_si128(data, _mm_cmpeq_epi8(data, zero))));
+
+            mask &= 0xFFFFu << offset;
+
+            while (!mask)
+            {
+                data = _mm_load_si128(++block);
+                mask = static_cast<unsigned int>(_mm_movemask_epi8(_mm_or_si128(data, _mm_cmpeq_epi8(data, zero))));
+            }
+
+        #if defined(_MSC_VER) && !defined(__clang__)
+            unsigned long index;
+            _BitScanForward(&index, mask);
+        #else
+            const unsigned int index = static_cast<unsigned int>(__builtin_ctz(mask));
+        #endif
+
+            return reinterpret_cast<char const*>(block) + index;
+        #else
+            while (static_cast<uint8_t>(*text - 1) < 0x7F)
+            {
+                text++;
+            }
+
+            return text;
+        #endif
+        }
+
+        // Decodes a sequence starting with a non-ASCII byte, following the well-formed byte
+        // sequences of the Unicode standard (table 3-7). Continuation bytes are only read while
+        // the ones before them are valid, so a truncated sequence never reads past the terminator.
+        uint32_t DecodeSequence() noexcept
+        {
+            auto const bytes = reinterpret_cast<uint8_t const*>(mText);
+            const uint32_t lead = bytes[0];
+
+            size_t length;
+            uint32_t codePoint;
+            uint8_t lower = 0x80;
+            uint8_t upper = 0xBF;
+
+            if (lead >= 0xC2 && lead <= 0xDF)
+            {
+                length = 2;
+                codePoint = lead & 0x1F;
+            }
+            else if (lead >= 0xE0 && lead <= 0xEF)
+            {
+                // Reject overlong forms, and UTF-16 surrogates.
+                length = 3;
+                codePoint = lead & 0x0F;
+
+                if (lead == 0xE0)
+                    lower = 0xA0;
+                else if (lead == 0xED)
+                    upper = 0x9F;
+            }
+            else if (lead >= 0xF0 && lead <= 0xF4)
+            {
+                // Reject overlong forms, and code points above U+10FFFF.
+                length = 4;
+                codePoint = lead & 0x07;
+
+                if (lead == 0xF0)
+                    lower = 0x90;
+                else if (lead == 0xF4)
+                    upper = 0x8F;
+            }
+            else
+            {
+                // Stray continuation byte, or a lead byte that is never valid.
+                mText++;
+                return ReplacementCharacter;
+            }
+
+            for (size_t i = 1; i < length; i++)
+            {
+                const uint8_t next = bytes[i];
+
+                if (next < lower || next > upper)
+                {
+                    // Consume the valid prefix, but leave the offending byte (which may be the terminator) to be read next.
+                    mText += i;
+                    return ReplacementCharacter;
+                }
+
+                codePoint = (codePoint << 6) | (next & 0x3Fu);
+
+                lower = 0x80;
+                upper = 0xBF;
+            }
+
+            mText += length;
+
+            return codePoint;
+        }
+
+        char const* mText;
+        char const* mAsciiEnd;
+    };
+
+
+    // Wide characters. Where wchar_t is 16-bit the text is UTF-16, and surrogate pairs are
+    // combined into a single code point. Unpaired surrogates are passed through unchanged.
+    template<>
+    class TextDecoder<wchar_t>
+    {
+    public:
+        explicit TextDecoder(wchar_t const* text) noexcept :
+            mText(text)
+        {
+        }
+
+        uint32_t Next() noexcept
+        {
+            const auto character = static_cast<uint32_t>(*mText);
+
+            if (!character)
+                return 0;
+
+            mText++;
+
+        #if WCHAR_MAX <= 0xFFFF
+            if (character >= 0xD800 && character <= 0xDBFF)
+            {
+                const auto low = static_cast<uint32_t>(*mText);
+
+                if (low >= 0xDC00 && low <= 0xDFFF)
+                {
+                    mText++;
+
+                    return 0x10000 + ((character - 0xD800) << 10) + (low - 0xDC00);
+                }
+            }
+        #endif
+
+            return character;
+        }
+
+    private:
+        wchar_t const* mText;
+    };
+}
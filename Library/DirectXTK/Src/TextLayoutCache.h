@@ -0,0 +1,155 @@
+//--------------------------------------------------------------------------------------
+// File: TextLayoutCache.h
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+
+namespace DirectX
+{
+    // Least recently used cache of laid out strings, keyed by a hash of the text. Hits compare
+    // the text against the stored copy but do not allocate. A capacity of zero disables the
+    // cache. Safe to use from several threads at once.
+    template<typename TValue>
+    class TextLayoutCache
+    {
+    public:
+        explicit TextLayoutCache(size_t capacity = 0) :
+            mCapacity(capacity)
+        {
+        }
+
+        TextLayoutCache(TextLayoutCache const&) = delete;
+        TextLayoutCache& operator= (TextLayoutCache const&) = delete;
+
+        size_t GetCapacity() const noexcept { return mCapacity.load(std::memory_order_relaxed); }
+
+        void SetCapacity(size_t capacity)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+
+            mCapacity = capacity;
+
+            Trim();
+        }
+
+        void Clear()
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+
+            mEntries.clear();
+            mIndex.clear();
+        }
+
+        // Returns the cached value for text, calling create() to make it on a miss. The lock is
+        // not held while creating, so a string first seen by two threads at once may be built twice.
+        template<typename TChar, typename TCreate>
+        std::shared_ptr<TValue const> GetOrCreate(TChar const* text, TCreate&& create)
+        {
+            size_t length;
+            const uint64_t hash = Hash(text, &length);
+
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+
+                auto it = mIndex.find(hash);
+
+                if (it != mIndex.end() && it->second->Matches(text, length))
+                {
+                    // Move the entry to the front of the recently used list.
+                    mEntries.splice(mEntries.begin(), mEntries, it->second);
+
+                    return it->second->value;
+                }
+            }
+
+            std::shared_ptr<TValue const> value = create();
+
+            std::lock_guard<std::mutex> lock(mMutex);
+
+            if (mCapacity > 0)
+            {
+                // A different string with the same hash is simply replaced.
+                auto it = mIndex.find(hash);
+
+                if (it != mIndex.end())
+                {
+                    mEntries.erase(it->second);
+                    mIndex.erase(it);
+                }
+
+                mEntries.push_front({ hash, std::string(reinterpret_cast<char const*>(text), length * sizeof(TChar)), sizeof(TChar), value });
+                mIndex[hash] = mEntries.begin();
+
+                Trim();
+            }
+
+            return value;
+        }
+
+    private:
+        struct Entry
+        {
+            uint64_t hash;
+            std::string text;
+            size_t charSize;
+            std::shared_ptr<TValue const> value;
+
+            template<typename TChar>
+            bool Matches(TChar const* other, size_t length) const noexcept
+            {
+                return charSize == sizeof(TChar)
+                    && text.size() == length * sizeof(TChar)
+                    && memcmp(text.data(), other, text.size()) == 0;
+            }
+        };
+
+        // 64-bit FNV-1a over the code units, which also measures the string. The code unit size
+        // is mixed in first, so narrow and wide strings with the same values hash differently.
+        template<typename TChar>
+        static uint64_t Hash(TChar const* text, size_t* length) noexcept
+        {
+            uint64_t hash = 14695981039346656037ull ^ sizeof(TChar);
+            size_t count = 0;
+
+            for (; text[count]; count++)
+            {
+                hash ^= static_cast<uint64_t>(text[count]);
+                hash *= 1099511628211ull;
+            }
+
+            *length = count;
+
+            return hash;
+        }
+
+        void Trim()
+        {
+            while (mEntries.size() > mCapacity)
+            {
+                mIndex.erase(mEntries.back().hash);
+                mEntries.pop_back();
+            }
+        }
+
+        std::mutex mMutex;
+        std::atomic<size_t> mCapacity;
+        std::list<Entry> mEntries;
+        std::unordered_map<uint64_t, typename std::list<Entry>::iterator> mIndex;
+    };
+}
@@ -0,0 +1,782 @@
+//--------------------------------------------------------------------------------------
+// File: TriangleBVH.cpp
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "pch.h"
+#include "TriangleBVH.h"
+#include "PlatformHelpers.h"
+#include "TriangleBVHKernels.h"
+#include "WorkerPool.h"
+
+using namespace DirectX;
+using BVH::Node;
+
+static_assert(sizeof(SimpleMath::Ray) == 6 * sizeof(float), "Rays are traced as six floats");
+static_assert(offsetof(SimpleMath::Ray, direction) == 3 * sizeof(float), "Layout mismatch");
+
+
+namespace
+{
+    // Candidate split positions per axis are the boundaries between this many bins of centroids.
+    constexpr size_t BinCount = 16;
+
+    // Larger ranges are split even when the surface area heuristic says not to.
+    constexpr uint32_t MaxLeafSize = 8;
+
+    // Ranges are split serially down to at least this size, then shared out as subtrees to build in parallel.
+    constexpr size_t MinSubtreeSize = 1024;
+
+    // Triangles per chunk when computing bounds on the worker threads.
+    constexpr size_t BoundsChunkSize = 16384;
+
+    struct TriangleBounds
+    {
+        XMFLOAT3 min;
+        XMFLOAT3 max;
+        XMFLOAT3 centroid;
+    };
+
+    struct BuildRange
+    {
+        uint32_t node;
+        uint32_t depth;
+    };
+
+    inline XMVECTOR LoadMin(Node const& node) noexcept
+    {
+        return XMLoadFloat3(reinterpret_cast<XMFLOAT3 const*>(node.min));
+    }
+
+    inline XMVECTOR LoadMax(Node const& node) noexcept
+    {
+        return XMLoadFloat3(reinterpret_cast<XMFLOAT3 const*>(node.max));
+    }
+
+    inline void XM_CALLCONV SetBounds(Node& node, FXMVECTOR min, FXMVECTOR max) noexcept
+    {
+        XMStoreFloat3(reinterpret_cast<XMFLOAT3*>(node.min), min);
+        XMStoreFloat3(reinterpret_cast<XMFLOAT3*>(node.max), max);
+    }
+
+    // Half the surface area, which is all the heuristic needs.
+    inline float XM_CALLCONV HalfArea(FXMVECTOR min, FXMVECTOR max) noexcept
+    {
+        const XMVECTOR extent = XMVectorMax(XMVectorSubtract(max, min), g_XMZero);
+        return XMVectorGetX(XMVector3Dot(extent, XMVectorSwizzle<1, 2, 0, 3>(extent)));
+    }
+
+    inline float Component(XMFLOAT3 const& v, size_t axis) noexcept
+    {
+        return (&v.x)[axis];
+    }
+
+    inline size_t BinIndex(float value, float lowest, float scale) noexcept
+    {
+        return std::min(BinCount - 1, static_cast<size_t>((value - lowest) * scale));
+    }
+
+    // Splits ranges of triangles top down, writing nodes to an array big enough for the whole subtree.
+    // Nodes waiting to be split look like leaves holding their range.
+    class SubtreeBuilder
+    {
+    public:
+        SubtreeBuilder(TriangleBounds const* triangles, uint32_t* order, Node* nodes, size_t nodeCount) noexcept :
+            mTriangles(triangles),
+            mOrder(order),
+            mNodes(nodes),
+            mNodeCount(nodeCount)
+        {
+        }
+
+        size_t GetNodeCount() const noexcept { return mNodeCount; }
+
+        // Either splits the node, adding its two children, or leaves it as a leaf.
+        bool Split(uint32_t index, uint32_t depth) noexcept
+        {
+            Node& node = mNodes[index];
+
+            const uint32_t first = node.leftFirst;
+            const uint32_t count = node.count;
+
+            if (count <= 1 || depth >= BVH::MaxDepth)
+                return false;
+
+            uint32_t* begin = mOrder + first;
+            uint32_t* end = begin + count;
+
+            XMVECTOR centroidMin = g_XMFltMax;
+            XMVECTOR centroidMax = XMVectorNegate(g_XMFltMax);
+
+            for (auto it = begin; it != end; ++it)
+            {
+                const XMVECTOR centroid = XMLoadFloat3(&mTriangles[*it].centroid);
+
+                centroidMin = XMVectorMin(centroidMin, centroid);
+                centroidMax = XMVectorMax(centroidMax, centroid);
+            }
+
+            XMFLOAT3 lowest, highest;
+            XMStoreFloat3(&lowest, centroidMin);
+            XMStoreFloat3(&highest, centroidMax);
+
+            float bestCost = FLT_MAX;
+            size_t bestAxis = 0;
+            size_t bestSplit = 0;
+
+            for (size_t axis = 0; axis < 3; axis++)
+            {
+                const float low = Component(lowest, axis);
+                const float extent = Component(highest, axis) - low;
+
+                if (!(extent > 0))
+                    continue;
+
+                const float scale = float(BinCount) / extent;
+
+                XMVECTOR binMin[BinCount];
+                XMVECTOR binMax[BinCount];
+                uint32_t binCount[BinCount] = {};
+
+                for (size_t b = 0; b < BinCount; b++)
+                {
+                    binMin[b] = g_XMFltMax;
+                    binMax[b] = XMVectorNegate(g_XMFltMax);
+                }
+
+                for (auto it = begin; it != end; ++it)
+                {
+                    auto const& triangle = mTriangles[*it];
+                    const size_t b = BinIndex(Component(triangle.centroid, axis), low, scale);
+
+                    binMin[b] = XMVectorMin(binMin[b], XMLoadFloat3(&triangle.min));
+                    binMax[b] = XMVectorMax(binMax[b], XMLoadFloat3(&triangle.max));
+                    binCount[b]++;
+                }
+
+                // Area and count of everything at or above each bin.
+                float aboveArea[BinCount];
+                uint32_t aboveCount[BinCount];
+
+                XMVECTOR sweepMin = g_XMFltMax;
+                XMVECTOR sweepMax = XMVectorNegate(g_XMFltMax);
+                uint32_t sweepCount = 0;
+
+                for (size_t b = BinCount; b-- > 1;)
+                {
+                    sweepMin = XMVectorMin(sweepMin, binMin[b]);
+                    sweepMax = XMVectorMax(sweepMax, binMax[b]);
+                    sweepCount += binCount[b];
+
+                    aboveArea[b] = HalfArea(sweepMin, sweepMax);
+                    aboveCount[b] = sweepCount;
+                }
+
+                sweepMin = g_XMFltMax;
+                sweepMax = XMVectorNegate(g_XMFltMax);
+                sweepCount = 0;
+
+                for (size_t b = 0; b + 1 < BinCount; b++)
+                {
+                    sweepMin = XMVectorMin(sweepMin, binMin[b]);
+                    sweepMax = XMVectorMax(sweepMax, binMax[b]);
+                    sweepCount += binCount[b];
+
+                    if (!sweepCount || !aboveCount[b + 1])
+                        continue;
+
+                    const float cost = HalfArea(sweepMin, sweepMax) * float(sweepCount) + aboveArea[b + 1] * float(aboveCount[b + 1]);
+
+                    if (cost < bestCost)
+                    {
+                        bestCost = cost;
+                        bestAxis = axis;
+                        bestSplit = b + 1;
+                    }
+                }
+            }
+
+            const bool found = (bestCost < FLT_MAX);
+
+            // Splitting costs one more node visit, and saves the triangles no longer tested.
+            const float area = HalfArea(LoadMin(node), LoadMax(node));
+
+            if (count <= MaxLeafSize && (!found || area + bestCost >= area * float(count)))
+                return false;
+
+            uint32_t* middle = begin + count / 2;
+
+            if (found)
+            {
+                const float low = Component(lowest, bestAxis);
+                const float scale = float(BinCount) / (Component(highest, bestAxis) - low);
+
+                middle = std::partition(begin, end, [&](uint32_t triangle) noexcept
+                    {
+                        return BinIndex(Component(mTriangles[triangle].centroid, bestAxis), low, scale) < bestSplit;
+                    });
+            }
+
+            // Only when every centroid is the same, so any split is as good as another.
+            if (middle == begin || middle == end)
+                middle = begin + count / 2;
+
+            const auto left = static_cast<uint32_t>(mNodeCount);
+            mNodeCount += 2;
+
+            const auto leftCount = static_cast<uint32_t>(middle - begin);
+
+            InitializeLeaf(mNodes[left], first, leftCount);
+            InitializeLeaf(mNodes[left + 1], first + leftCount, count - leftCount);
+
+            node.leftFirst = left;
+            node.count = 0;
+
+            return true;
+        }
+
+        // Builds everything under a node.
+        void Build(uint32_t index, uint32_t depth) noexcept
+        {
+            // Splitting pushes two nodes and pops one, so this holds at most one node per level, plus one.
+            BuildRange stack[BVH::MaxDepth + 2];
+            size_t stackSize = 0;
+
+            stack[stackSize++] = { index, depth };
+
+            while (stackSize)
+            {
+                const BuildRange range = stack[--stackSize];
+
+                if (Split(range.node, range.depth))
+                {
+                    const uint32_t left = mNodes[range.node].leftFirst;
+
+                    stack[stackSize++] = { left + 1, range.depth + 1 };
+                    stack[stackSize++] = { left, range.depth + 1 };
+                }
+            }
+        }
+
+    private:
+        void InitializeLeaf(Node& node, uint32_t first, uint32_t count) const noexcept
+        {
+            XMVECTOR min = g_XMFltMax;
+            XMVECTOR max = XMVectorNegate(g_XMFltMax);
+
+            for (uint32_t i = first; i < first + count; i++)
+            {
+                auto const& triangle = mTriangles[mOrder[i]];
+
+                min = XMVectorMin(min, XMLoadFloat3(&triangle.min));
+                max = XMVectorMax(max, XMLoadFloat3(&triangle.max));
+            }
+
+            SetBounds(node, min, max);
+
+            node.leftFirst = first;
+            node.count = count;
+        }
+
+        TriangleBounds const* mTriangles;
+        uint32_t* mOrder;
+        Node* mNodes;
+        size_t mNodeCount;
+    };
+
+    // Where along the ray it enters the node's box, if it does so before limit.
+    inline bool XM_CALLCONV SlabTest(Node const& node, FXMVECTOR origin, FXMVECTOR inverseDirection, float limit, float& enter) noexcept
+    {
+        const XMVECTOR t0 = XMVectorMultiply(XMVectorSubtract(LoadMin(node), origin), inverseDirection);
+        const XMVECTOR t1 = XMVectorMultiply(XMVectorSubtract(LoadMax(node), origin), inverseDirection);
+
+        const XMVECTOR slabNear = XMVectorMin(t0, t1);
+        const XMVECTOR slabFar = XMVectorMax(t0, t1);
+
+        const float tNear = std::max(std::max(XMVectorGetX(slabNear), XMVectorGetY(slabNear)), std::max(XMVectorGetZ(slabNear), 0.0f));
+        const float tFar = std::min(std::min(XMVectorGetX(slabFar), XMVectorGetY(slabFar)), std::min(XMVectorGetZ(slabFar), limit));
+
+        enter = tNear;
+        return tNear <= tFar;
+    }
+}
+
+
+// Internal TriangleBVH implementation class.
+class TriangleBVH::Impl
+{
+public:
+    Impl() noexcept :
+        mVertexCount(0)
+    {
+    }
+
+    template<typename TIndex>
+    void Build(void const* vertices, size_t vertexCount, size_t vertexStride, TIndex const* indices, size_t indexCount);
+
+    void Refit(void const* vertices, size_t vertexCount, size_t vertexStride);
+
+    bool Intersects(SimpleMath::Ray const& ray, float& dist, uint32_t* triangle) const noexcept;
+    size_t Intersects(SimpleMath::Ray const* rays, size_t count, float* dist, uint32_t* triangles) const noexcept;
+
+    size_t GetTriangleCount() const noexcept { return mTriangleIds.size(); }
+
+    BoundingBox GetBounds() const noexcept;
+
+private:
+    void LoadPositions(void const* vertices, size_t vertexCount, size_t vertexStride);
+
+    std::vector<Node> mNodes;
+    std::vector<XMFLOAT3> mPositions;
+    std::vector<uint32_t> mVertexIndices;
+    std::vector<uint32_t> mTriangleIds;
+    size_t mVertexCount;
+};
+
+
+void TriangleBVH::Impl::LoadPositions(void const* vertices, size_t vertexCount, size_t vertexStride)
+{
+    if (vertexCount && !vertices)
+        throw std::invalid_argument("Vertices needed");
+
+    if (vertexStride < sizeof(XMFLOAT3))
+    {
+        DebugTrace("ERROR: TriangleBVH needs vertices of at least 12 bytes for their positions (stride %zu)\n", vertexStride);
+        throw std::invalid_argument("Invalid vertex stride");
+    }
+
+    mPositions.resize(vertexCount);
+
+    auto source = static_cast<uint8_t const*>(vertices);
+
+    for (size_t i = 0; i < vertexCount; i++, source += vertexStride)
+    {
+        memcpy(&mPositions[i], source, sizeof(XMFLOAT3));
+    }
+}
+
+
+template<typename TIndex>
+void TriangleBVH::Impl::Build(void const* vertices, size_t vertexCount, size_t vertexStride, TIndex const* indices, size_t indexCount)
+{
+    if (indexCount && !indices)
+        throw std::invalid_argument("Indices needed");
+
+    if (indexCount % 3)
+        throw std::invalid_argument("Expected triangular faces");
+
+    if (indexCount / 3 >= BVH::NoHit)
+        throw std::out_of_range("Too many triangles for TriangleBVH");
+
+    const size_t triangleCount = indexCount / 3;
+
+    for (size_t i = 0; i < indexCount; i++)
+    {
+        if (indices[i] >= vertexCount)
+        {
+            DebugTrace("ERROR: TriangleBVH index %zu refers to vertex %u, but there are only %zu\n", i, static_cast<unsigned int>(indices[i]), vertexCount);
+            throw std::out_of_range("Index value out of range");
+        }
+    }
+
+    LoadPositions(vertices, vertexCount, vertexStride);
+    mVertexCount = vertexCount;
+
+    mNodes.clear();
+    mVertexIndices.clear();
+    mTriangleIds.clear();
+
+    if (!triangleCount)
+        return;
+
+    auto& pool = WorkerPool::Get();
+
+    std::vector<TriangleBounds> triangles(triangleCount);
+
+    pool.ParallelFor(triangleCount, BoundsChunkSize, [&](size_t begin, size_t end) noexcept
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                const XMVECTOR p0 = XMLoadFloat3(&mPositions[indices[i * 3]]);
+                const XMVECTOR p1 = XMLoadFloat3(&mPositions[indices[i * 3 + 1]]);
+                const XMVECTOR p2 = XMLoadFloat3(&mPositions[indices[i * 3 + 2]]);
+
+                const XMVECTOR min = XMVectorMin(p0, XMVectorMin(p1, p2));
+                const XMVECTOR max = XMVectorMax(p0, XMVectorMax(p1, p2));
+
+                XMStoreFloat3(&triangles[i].min, min);
+                XMStoreFloat3(&triangles[i].max, max);
+                XMStoreFloat3(&triangles[i].centroid, XMVectorScale(XMVectorAdd(min, max), 0.5f));
+            }
+        });
+
+    std::vector<uint32_t> order(triangleCount);
+
+    for (size_t i = 0; i < triangleCount; i++)
+    {
+        order[i] = static_cast<uint32_t>(i);
+    }
+
+    // A binary tree over n triangles has at most 2n - 1 nodes.
+    mNodes.resize(triangleCount * 2 - 1);
+
+    {
+        XMVECTOR min = g_XMFltMax;
+        XMVECTOR max = XMVectorNegate(g_XMFltMax);
+
+        for (auto const& triangle : triangles)
+        {
+            min = XMVectorMin(min, XMLoadFloat3(&triangle.min));
+            max = XMVectorMax(max, XMLoadFloat3(&triangle.max));
+        }
+
+        SetBounds(mNodes[0], min, max);
+
+        mNodes[0].leftFirst = 0;
+        mNodes[0].count = static_cast<uint32_t>(triangleCount);
+    }
+
+    // Split the top of the tree serially, until there are enough ranges to keep every thread busy.
+    const size_t subtreeSize = std::max(MinSubtreeSize, triangleCount / (pool.GetThreadCount() * 4));
+
+    SubtreeBuilder top(triangles.data(), order.data(), mNodes.data(), 1);
+
+    std::vector<BuildRange> pending;
+    std::vector<BuildRange> subtrees;
+
+    pending.push_back({ 0, 0 });
+
+    while (!pending.empty())
+    {
+        const BuildRange range = pending.back();
+        pending.pop_back();
+
+        if (mNodes[range.node].count <= subtreeSize)
+        {
+            subtrees.push_back(range);
+        }
+        else if (top.Split(range.node, range.depth))
+        {
+            const uint32_t left = mNodes[range.node].leftFirst;
+
+            pending.push_back({ left + 1, range.depth + 1 });
+            pending.push_back({ left, range.depth + 1 });
+        }
+    }
+
+    // Each subtree is built into its own nodes, since how many it needs is not known until it is done.
+    std::vector<std::vector<Node>> subtreeNodes(subtrees.size());
+    std::vector<size_t> subtreeNodeCounts(subtrees.size());
+
+    for (size_t i = 0; i < subtrees.size(); i++)
+    {
+        auto const& root = mNodes[subtrees[i].node];
+
+        subtreeNodes[i].resize(size_t(root.count) * 2 - 1);
+        subtreeNodes[i][0] = root;
+    }
+
+    pool.ParallelFor(subtrees.size(), 1, [&](size_t begin, size_t end) noexcept
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                SubtreeBuilder builder(triangles.data(), order.data(), subtreeNodes[i].data(), 1);
+                builder.Build(0, subtrees[i].depth);
+
+                subtreeNodeCounts[i] = builder.GetNodeCount();
+            }
+        });
+
+    // Append the subtrees. Children still come after their parents, which Refit relies on.
+    size_t nodeCount = top.GetNodeCount();
+
+    for (size_t i = 0; i < subtrees.size(); i++)
+    {
+        auto const& nodes = subtreeNodes[i];
+
+        // Subtree node k > 0 becomes node offset + k.
+        const auto offset = static_cast<uint32_t>(nodeCount - 1);
+
+        for (size_t k = 0; k < subtreeNodeCounts[i]; k++)
+        {
+            Node node = nodes[k];
+
+            if (!node.count)
+                node.leftFirst += offset;
+
+            mNodes[k ? offset + k : subtrees[i].node] = node;
+        }
+
+        nodeCount += subtreeNodeCounts[i] - 1;
+    }
+
+    mNodes.resize(nodeCount);
+    mNodes.shrink_to_fit();
+
+    mVertexIndices.resize(triangleCount * 3);
+
+    for (size_t i = 0; i < triangleCount; i++)
+    {
+        for (size_t j = 0; j < 3; j++)
+        {
+            mVertexIndices[i * 3 + j] = indices[size_t(order[i]) * 3 + j];
+        }
+    }
+
+    mTriangleIds = std::move(order);
+}
+
+
+void TriangleBVH::Impl::Refit(void const* vertices, size_t vertexCount, size_t vertexStride)
+{
+    if (vertexCount != mVertexCount)
+    {
+        DebugTrace("ERROR: TriangleBVH was built with %zu vertices, but refit with %zu\n", mVertexCount, vertexCount);
+        throw std::invalid_argument("Refit needs the vertices the tree was built with");
+    }
+
+    LoadPositions(vertices, vertexCount, vertexStride);
+
+    // Leaves in parallel, then interior nodes from the bottom up: children always follow their parents.
+    WorkerPool::Get().ParallelFor(mNodes.size(), BoundsChunkSize / MaxLeafSize, [&](size_t begin, size_t end) noexcept
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                Node& node = mNodes[i];
+
+                if (!node.count)
+                    continue;
+
+                XMVECTOR min = g_XMFltMax;
+                XMVECTOR max = XMVectorNegate(g_XMFltMax);
+
+                for (size_t j = size_t(node.leftFirst) * 3; j < (size_t(node.leftFirst) + node.count) * 3; j++)
+                {
+                    const XMVECTOR p = XMLoadFloat3(&mPositions[mVertexIndices[j]]);
+
+                    min = XMVectorMin(min, p);
+                    max = XMVectorMax(max, p);
+                }
+
+                SetBounds(node, min, max);
+            }
+        });
+
+    for (size_t i = mNodes.size(); i-- > 0;)
+    {
+        Node& node = mNodes[i];
+
+        if (node.count)
+            continue;
+
+        Node const& left = mNodes[node.leftFirst];
+        Node const& right = mNodes[node.leftFirst + 1];
+
+        SetBounds(node, XMVectorMin(LoadMin(left), LoadMin(right)), XMVectorMax(LoadMax(left), LoadMax(right)));
+    }
+}
+
+
+bool TriangleBVH::Impl::Intersects(SimpleMath::Ray const& ray, float& dist, uint32_t* triangle) const noexcept
+{
+    dist = 0;
+
+    if (triangle)
+        *triangle = NoHit;
+
+    if (mNodes.empty())
+        return false;
+
+    const XMVECTOR origin = XMLoadFloat3(&ray.position);
+    const XMVECTOR direction = XMLoadFloat3(&ray.direction);
+    const XMVECTOR inverseDirection = XMVectorSet(
+        BVH::SafeReciprocal(ray.direction.x),
+        BVH::SafeReciprocal(ray.direction.y),
+        BVH::SafeReciprocal(ray.direction.z),
+        0);
+
+    float nearest = FLT_MAX;
+    uint32_t nearestTriangle = NoHit;
+
+    struct Entry
+    {
+        uint32_t node;
+        float enter;
+    };
+
+    // Visiting a node pops one entry and pushes up to two, so one per level, plus one, is enough.
+    Entry stack[BVH::MaxDepth + 2];
+    size_t stackSize = 0;
+
+    float enter;
+
+    if (SlabTest(mNodes[0], origin, inverseDirection, nearest, enter))
+    {
+        stack[stackSize++] = { 0, enter };
+    }
+
+    while (stackSize)
+    {
+        const Entry entry = stack[--stackSize];
+
+        // A closer hit may have been found since this was pushed.
+        if (entry.enter > nearest)
+            continue;
+
+        Node const& node = mNodes[entry.node];
+
+        if (node.count)
+        {
+            for (uint32_t i = node.leftFirst; i < node.leftFirst + node.count; i++)
+            {
+                uint32_t const* indices = &mVertexIndices[size_t(i) * 3];
+
+                float t;
+                if (TriangleTests::Intersects(origin, direction,
+                    XMLoadFloat3(&mPositions[indices[0]]),
+                    XMLoadFloat3(&mPositions[indices[1]]),
+                    XMLoadFloat3(&mPositions[indices[2]]), t)
+                    && t < nearest)
+                {
+                    nearest = t;
+                    nearestTriangle = mTriangleIds[i];
+                }
+            }
+        }
+        else
+        {
+            // Visit the nearer child first, so the other can often be skipped.
+            float enterLeft, enterRight;
+            const bool hitLeft = SlabTest(mNodes[node.leftFirst], origin, inverseDirection, nearest, enterLeft);
+            const bool hitRight = SlabTest(mNodes[node.leftFirst + 1], origin, inverseDirection, nearest, enterRight);
+
+            if (hitLeft && hitRight)
+            {
+                if (enterLeft <= enterRight)
+                {
+                    stack[stackSize++] = { node.leftFirst + 1, enterRight };
+                    stack[stackSize++] = { node.leftFirst, enterLeft };
+                }
+                else
+                {
+                    stack[stackSize++] = { node.leftFirst, enterLeft };
+                    stack[stackSize++] = { node.leftFirst + 1, enterRight };
+                }
+            }
+            else if (hitLeft)
+            {
+                stack[stackSize++] = { node.leftFirst, enterLeft };
+            }
+            else if (hitRight)
+            {
+                stack[stackSize++] = { node.leftFirst + 1, enterRight };
+            }
+        }
+    }
+
+    if (nearestTriangle == NoHit)
+        return false;
+
+    dist = nearest;
+
+    if (triangle)
+        *triangle = nearestTriangle;
+
+    return true;
+}
+
+
+size_t TriangleBVH::Impl::Intersects(SimpleMath::Ray const* rays, size_t count, float* dist, uint32_t* triangles) const noexcept
+{
+    if (mNodes.empty())
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            dist[i] = 0;
+            triangles[i] = NoHit;
+        }
+
+        return 0;
+    }
+
+    const BVH::TreeView tree =
+    {
+        mNodes.data(),
+        mPositions.data(),
+        mVertexIndices.data(),
+        mTriangleIds.data(),
+    };
+
+    return BVH::GetIntersectRaysKernel()(tree, &rays->position.x, count, dist, triangles);
+}
+
+
+BoundingBox TriangleBVH::Impl::GetBounds() const noexcept
+{
+    BoundingBox box;
+
+    if (!mNodes.empty())
+    {
+        BoundingBox::CreateFromPoints(box, LoadMin(mNodes[0]), LoadMax(mNodes[0]));
+    }
+
+    return box;
+}
+
+
+// Public constructor.
+TriangleBVH::TriangleBVH() noexcept(false) :
+    pImpl(std::make_unique<Impl>())
+{
+}
+
+
+TriangleBVH::TriangleBVH(TriangleBVH&&) noexcept = default;
+TriangleBVH& TriangleBVH::operator= (TriangleBVH&&) noexcept = default;
+TriangleBVH::~TriangleBVH() = default;
+
+
+void TriangleBVH::Build(void const* vertices, size_t vertexCount, size_t vertexStride, uint16_t const* indices, size_t indexCount)
+{
+    pImpl->Build(vertices, vertexCount, vertexStride, indices, indexCount);
+}
+
+
+void TriangleBVH::Build(void const* vertices, size_t vertexCount, size_t vertexStride, uint32_t const* indices, size_t indexCount)
+{
+    pImpl->Build(vertices, vertexCount, vertexStride, indices, indexCount);
+}
+
+
+void TriangleBVH::Refit(void const* vertices, size_t vertexCount, size_t vertexStride)
+{
+    pImpl->Refit(vertices, vertexCount, vertexStride);
+}
+
+
+bool TriangleBVH::Intersects(SimpleMath::Ray const& ray, float& dist, uint32_t* triangle) const noexcept
+{
+    return pImpl->Intersects(ray, dist, triangle);
+}
+
+
+size_t TriangleBVH::Intersects(SimpleMath::Ray const* rays, size_t count, float* dist, uint32_t* triangles) const noexcept
+{
+    return pImpl->Intersects(rays, count, dist, triangles);
+}
+
+
+size_t TriangleBVH::GetTriangleCount() const noexcept
+{
+    return pImpl->GetTriangleCount();
+}
+
+
+BoundingBox TriangleBVH::GetBounds() const noexcept
+{
+    return pImpl->GetBounds();
+}
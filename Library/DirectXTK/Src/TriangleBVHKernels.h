@@ -0,0 +1,116 @@
+//--------------------------------------------------------------------------------------
+// File: TriangleBVHKernels.h
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "VectorStream.h"
+
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace DirectX
+{
+    namespace BVH
+    {
+        // A node of the tree. Interior nodes have count 0, and their two children are stored together
+        // at index leftFirst, after the node itself. Leaves hold count triangles, starting at leftFirst.
+        struct Node
+        {
+            float min[3];
+            uint32_t leftFirst;
+            float max[3];
+            uint32_t count;
+        };
+
+        static_assert(sizeof(Node) == 32, "Nodes are sized to share cache lines evenly");
+
+        // Deeper ranges are made leaves whatever their size, which bounds the traversal stacks.
+        constexpr size_t MaxDepth = 64;
+
+        constexpr uint32_t NoHit = uint32_t(-1);
+
+        // The tree, with triangles in leaf order. vertexIndices holds three per triangle, and
+        // triangleIds the triangle's position in the original index buffer.
+        struct TreeView
+        {
+            Node const* nodes;
+            XMFLOAT3 const* positions;
+            uint32_t const* vertexIndices;
+            uint32_t const* triangleIds;
+        };
+
+        // Rays are six floats each, the origin then the direction. Returns the number of rays that hit.
+        using IntersectRaysKernel = size_t (*)(TreeView const& tree, float const* rays, size_t count, float* dist, uint32_t* triangles);
+
+        // Keeps the slab tests free of infinities and NaNs for axis-aligned rays.
+        inline float SafeReciprocal(float d) noexcept
+        {
+            constexpr float tiny = 1e-20f;
+
+            if (fabsf(d) < tiny)
+                d = (d < 0) ? -tiny : tiny;
+
+            return 1.0f / d;
+        }
+    }
+
+    namespace VectorStream
+    {
+        namespace Baseline
+        {
+        #include "TriangleBVHKernels.inl"
+        }
+
+    #if defined(DIRECTX_SIMD_X86)
+        DIRECTX_BEGIN_TARGET_AVX2
+
+        namespace AVX2
+        {
+        #include "TriangleBVHKernels.inl"
+        }
+
+        DIRECTX_END_TARGET
+
+        DIRECTX_BEGIN_TARGET_AVX512
+
+        namespace AVX512
+        {
+        #include "TriangleBVHKernels.inl"
+        }
+
+        DIRECTX_END_TARGET
+    #endif
+    }
+
+    namespace BVH
+    {
+        // Traces packets of 4, 8 or 16 rays, the widest this CPU supports.
+        inline IntersectRaysKernel GetIntersectRaysKernel() noexcept
+        {
+        #if defined(DIRECTX_SIMD_X86)
+            switch (GetSimdLevel())
+            {
+            case SimdLevel::AVX512:
+                return VectorStream::AVX512::IntersectRays;
+
+            case SimdLevel::AVX2:
+                return VectorStream::AVX2::IntersectRays;
+
+            default:
+                break;
+            }
+        #endif
+
+            return VectorStream::Baseline::IntersectRays;
+        }
+    }
+}
@@ -0,0 +1,195 @@
+//--------------------------------------------------------------------------------------
+// File: TriangleBVHKernels.inl
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+// No include guard: TriangleBVHKernels.h includes this once per instruction set, inside the
+// VectorStream namespace that defines Lanes for it.
+//
+// Rays are traced Lanes::Width at a time. Each node is slab tested against the whole packet, and
+// the packet descends into it if any of its rays might still find a closer hit there. Triangles
+// use the Moller-Trumbore test.
+
+inline size_t IntersectRays(BVH::TreeView const& tree, float const* rays, size_t count, float* dist, uint32_t* triangles) noexcept
+{
+    using Vector = Lanes::Vector;
+
+    const Vector zero = Lanes::Splat(0.0f);
+    const Vector one = Lanes::Splat(1.0f);
+    const Vector epsilon = Lanes::Splat(1e-20f);
+
+    size_t hits = 0;
+
+    for (size_t base = 0; base < count; base += Lanes::Width)
+    {
+        const size_t packetCount = std::min(Lanes::Width, count - base);
+
+        // Unused lanes trace a harmless ray, and are masked out of the results.
+        float lanes[9][Lanes::Width] = {};
+
+        for (size_t j = 0; j < Lanes::Width; j++)
+        {
+            lanes[5][j] = 1.0f;
+        }
+
+        for (size_t j = 0; j < packetCount; j++)
+        {
+            float const* ray = rays + (base + j) * 6;
+
+            for (size_t c = 0; c < 6; c++)
+            {
+                lanes[c][j] = ray[c];
+            }
+        }
+
+        for (size_t j = 0; j < Lanes::Width; j++)
+        {
+            for (size_t c = 0; c < 3; c++)
+            {
+                lanes[6 + c][j] = BVH::SafeReciprocal(lanes[3 + c][j]);
+            }
+        }
+
+        Vector origin[3], direction[3], inverse[3];
+
+        for (size_t c = 0; c < 3; c++)
+        {
+            origin[c] = Lanes::Load(lanes[c]);
+            direction[c] = Lanes::Load(lanes[3 + c]);
+            inverse[c] = Lanes::Load(lanes[6 + c]);
+        }
+
+        const uint32_t activeBits = (packetCount == Lanes::Width) ? uint32_t((uint64_t(1) << Lanes::Width) - 1) : ((1u << packetCount) - 1);
+
+        Vector nearest = Lanes::Splat(FLT_MAX);
+
+        uint32_t hitTriangles[Lanes::Width];
+
+        for (size_t j = 0; j < Lanes::Width; j++)
+        {
+            hitTriangles[j] = BVH::NoHit;
+        }
+
+        // Both children are pushed, so this holds at most one node per level, plus one.
+        uint32_t stack[BVH::MaxDepth + 2];
+        size_t stackSize = 0;
+
+        stack[stackSize++] = 0;
+
+        while (stackSize)
+        {
+            auto const& node = tree.nodes[stack[--stackSize]];
+
+            Vector slabNear[3], slabFar[3];
+
+            for (size_t c = 0; c < 3; c++)
+            {
+                const Vector t0 = Lanes::Multiply(Lanes::Subtract(Lanes::Splat(node.min[c]), origin[c]), inverse[c]);
+                const Vector t1 = Lanes::Multiply(Lanes::Subtract(Lanes::Splat(node.max[c]), origin[c]), inverse[c]);
+
+                slabNear[c] = Lanes::Min(t0, t1);
+                slabFar[c] = Lanes::Max(t0, t1);
+            }
+
+            const Vector enter = Lanes::Max(Lanes::Max(slabNear[0], slabNear[1]), Lanes::Max(slabNear[2], zero));
+            const Vector exit = Lanes::Min(Lanes::Min(slabFar[0], slabFar[1]), Lanes::Min(slabFar[2], nearest));
+
+            if (!(Lanes::MaskBits(Lanes::LessOrEqual(enter, exit)) & activeBits))
+                continue;
+
+            if (node.count)
+            {
+                for (uint32_t i = node.leftFirst; i < node.leftFirst + node.count; i++)
+                {
+                    uint32_t const* indices = tree.vertexIndices + size_t(i) * 3;
+
+                    auto const& p0 = tree.positions[indices[0]];
+                    auto const& p1 = tree.positions[indices[1]];
+                    auto const& p2 = tree.positions[indices[2]];
+
+                    const float v0[3] = { p0.x, p0.y, p0.z };
+                    const float e1s[3] = { p1.x - p0.x, p1.y - p0.y, p1.z - p0.z };
+                    const float e2s[3] = { p2.x - p0.x, p2.y - p0.y, p2.z - p0.z };
+
+                    Vector e1[3], e2[3], s[3];
+
+                    for (size_t c = 0; c < 3; c++)
+                    {
+                        e1[c] = Lanes::Splat(e1s[c]);
+                        e2[c] = Lanes::Splat(e2s[c]);
+                        s[c] = Lanes::Subtract(origin[c], Lanes::Splat(v0[c]));
+                    }
+
+                    // p = direction x e2, q = s x e1
+                    const Vector p[3] =
+                    {
+                        Lanes::Subtract(Lanes::Multiply(direction[1], e2[2]), Lanes::Multiply(direction[2], e2[1])),
+                        Lanes::Subtract(Lanes::Multiply(direction[2], e2[0]), Lanes::Multiply(direction[0], e2[2])),
+                        Lanes::Subtract(Lanes::Multiply(direction[0], e2[1]), Lanes::Multiply(direction[1], e2[0])),
+                    };
+
+                    const Vector q[3] =
+                    {
+                        Lanes::Subtract(Lanes::Multiply(s[1], e1[2]), Lanes::Multiply(s[2], e1[1])),
+                        Lanes::Subtract(Lanes::Multiply(s[2], e1[0]), Lanes::Multiply(s[0], e1[2])),
+                        Lanes::Subtract(Lanes::Multiply(s[0], e1[1]), Lanes::Multiply(s[1], e1[0])),
+                    };
+
+                    const Vector det = Lanes::MultiplyAdd(e1[2], p[2], Lanes::MultiplyAdd(e1[1], p[1], Lanes::Multiply(e1[0], p[0])));
+                    const Vector inverseDet = Lanes::Divide(one, det);
+
+                    const Vector u = Lanes::Multiply(Lanes::MultiplyAdd(s[2], p[2], Lanes::MultiplyAdd(s[1], p[1], Lanes::Multiply(s[0], p[0]))), inverseDet);
+                    const Vector v = Lanes::Multiply(Lanes::MultiplyAdd(direction[2], q[2], Lanes::MultiplyAdd(direction[1], q[1], Lanes::Multiply(direction[0], q[0]))), inverseDet);
+                    const Vector t = Lanes::Multiply(Lanes::MultiplyAdd(e2[2], q[2], Lanes::MultiplyAdd(e2[1], q[1], Lanes::Multiply(e2[0], q[0]))), inverseDet);
+
+                    auto hit = Lanes::And(Lanes::Less(epsilon, Lanes::Abs(det)), Lanes::LessOrEqual(zero, u));
+                    hit = Lanes::And(hit, Lanes::LessOrEqual(zero, v));
+                    hit = Lanes::And(hit, Lanes::LessOrEqual(Lanes::Add(u, v), one));
+                    hit = Lanes::And(hit, Lanes::LessOrEqual(zero, t));
+                    hit = Lanes::And(hit, Lanes::Less(t, nearest));
+
+                    uint32_t hitBits = Lanes::MaskBits(hit) & activeBits;
+
+                    if (hitBits)
+                    {
+                        nearest = Lanes::Select(nearest, t, hit);
+
+                        for (size_t j = 0; hitBits; j++, hitBits >>= 1)
+                        {
+                            if (hitBits & 1)
+                            {
+                                hitTriangles[j] = tree.triangleIds[i];
+                            }
+                        }
+                    }
+                }
+            }
+            else
+            {
+                stack[stackSize++] = node.leftFirst + 1;
+                stack[stackSize++] = node.leftFirst;
+            }
+        }
+
+        float nearestLanes[Lanes::Width];
+        Lanes::Store(nearestLanes, nearest);
+
+        for (size_t j = 0; j < packetCount; j++)
+        {
+            // Misses report a distance of zero, like Ray::Intersects.
+            const bool hit = (hitTriangles[j] != BVH::NoHit);
+
+            dist[base + j] = hit ? nearestLanes[j] : 0.0f;
+            triangles[base + j] = hitTriangles[j];
+
+            if (hit)
+                hits++;
+        }
+    }
+
+    return hits;
+}
@@ -0,0 +1,269 @@
+//--------------------------------------------------------------------------------------
+// File: VectorStream.h
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CpuFeatures.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include <DirectXMath.h>
+
+
+namespace DirectX
+{
+    namespace VectorStream
+    {
+        // Component arrays of a structure-of-arrays stream. Components a kernel does not use are ignored.
+        struct StreamInput
+        {
+            float const* c[4];
+        };
+
+        struct StreamOutput
+        {
+            float* c[4];
+        };
+
+        // Frustum planes for the culling kernels, with normals pointing into the frustum, stored as
+        // separate component arrays. absX, absY and absZ hold the magnitudes of the normals, for boxes.
+        struct CullPlanes
+        {
+            float x[6];
+            float y[6];
+            float z[6];
+            float d[6];
+            float absX[6];
+            float absY[6];
+            float absZ[6];
+        };
+
+        using TransformKernel = void (*)(StreamInput const& in, size_t count, XMFLOAT4X4 const& m, StreamOutput const& out);
+        using NormalizeKernel = void (*)(StreamInput const& in, size_t count, StreamOutput const& out);
+        using DotKernel = void (*)(StreamInput const& a, StreamInput const& b, size_t count, float* result);
+        using CullSpheresKernel = void (*)(CullPlanes const& planes, StreamInput const& centers, float const* radii, size_t count, uint32_t* visible);
+        using CullBoxesKernel = void (*)(CullPlanes const& planes, StreamInput const& centers, StreamInput const& extents, size_t count, uint32_t* visible);
+        using InterpolateKernel = void (*)(StreamInput const& q1, StreamInput const& q2, size_t count, float t, StreamOutput const& out);
+        using BlendKernel = void (*)(StreamInput const* poses, float const* weights, size_t poseCount, size_t count, StreamOutput const& out);
+        using ProjectBoxesKernel = void (*)(XMFLOAT4X4 const& m, StreamInput const& centers, StreamInput const& extents, size_t count, StreamOutput const& out);
+
+        // The kernels for one instruction set. Outputs may alias their inputs exactly, but must not
+        // otherwise overlap them.
+        struct StreamKernels
+        {
+            TransformKernel transformCoord2;
+            TransformKernel transformCoord3;
+            TransformKernel transformNormal2;
+            TransformKernel transformNormal3;
+            TransformKernel transform4;
+            NormalizeKernel normalize2;
+            NormalizeKernel normalize3;
+            NormalizeKernel normalize4;
+            DotKernel dot2;
+            DotKernel dot3;
+            DotKernel dot4;
+            CullSpheresKernel cullSpheres;
+            CullBoxesKernel cullBoxes;
+            InterpolateKernel quaternionLerp;
+            InterpolateKernel quaternionSlerp;
+            InterpolateKernel quaternionFastSlerp;
+            BlendKernel quaternionBlend;
+            ProjectBoxesKernel projectBoxes;
+        };
+
+        // Four lanes using DirectXMath, so whatever it was built for: SSE, ARM-NEON or plain C++.
+        namespace Baseline
+        {
+            struct Lanes
+            {
+                using Vector = XMVECTOR;
+                using Mask = XMVECTOR;
+
+                static constexpr size_t Width = 4;
+
+                static XMVECTOR Load(float const* p) noexcept { return XMLoadFloat4(reinterpret_cast<XMFLOAT4 const*>(p)); }
+                static void XM_CALLCONV Store(float* p, FXMVECTOR v) noexcept { XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(p), v); }
+                static XMVECTOR Splat(float value) noexcept { return XMVectorReplicate(value); }
+
+                static XMVECTOR XM_CALLCONV Add(FXMVECTOR a, FXMVECTOR b) noexcept { return XMVectorAdd(a, b); }
+                static XMVECTOR XM_CALLCONV Subtract(FXMVECTOR a, FXMVECTOR b) noexcept { return XMVectorSubtract(a, b); }
+                static XMVECTOR XM_CALLCONV Multiply(FXMVECTOR a, FXMVECTOR b) noexcept { return XMVectorMultiply(a, b); }
+                static XMVECTOR XM_CALLCONV MultiplyAdd(FXMVECTOR a, FXMVECTOR b, FXMVECTOR c) noexcept { return XMVectorMultiplyAdd(a, b, c); }
+                static XMVECTOR XM_CALLCONV Divide(FXMVECTOR a, FXMVECTOR b) noexcept { return XMVectorDivide(a, b); }
+                static XMVECTOR XM_CALLCONV Sqrt(FXMVECTOR v) noexcept { return XMVectorSqrt(v); }
+                static XMVECTOR XM_CALLCONV Min(FXMVECTOR a, FXMVECTOR b) noexcept { return XMVectorMin(a, b); }
+                static XMVECTOR XM_CALLCONV Max(FXMVECTOR a, FXMVECTOR b) noexcept { return XMVectorMax(a, b); }
+                static XMVECTOR XM_CALLCONV Abs(FXMVECTOR v) noexcept { return XMVectorAbs(v); }
+
+                // Select takes b in the lanes where mask is set, and a elsewhere.
+                static XMVECTOR XM_CALLCONV Less(FXMVECTOR a, FXMVECTOR b) noexcept { return XMVectorLess(a, b); }
+                static XMVECTOR XM_CALLCONV LessOrEqual(FXMVECTOR a, FXMVECTOR b) noexcept { return XMVectorLessOrEqual(a, b); }
+                static XMVECTOR XM_CALLCONV And(FXMVECTOR a, FXMVECTOR b) noexcept { return XMVectorAndInt(a, b); }
+                static XMVECTOR XM_CALLCONV Select(FXMVECTOR a, FXMVECTOR b, FXMVECTOR mask) noexcept { return XMVectorSelect(a, b, mask); }
+
+                // One bit per lane, set where the mask is.
+                static uint32_t XM_CALLCONV MaskBits(FXMVECTOR mask) noexcept
+                {
+                #if defined(_XM_SSE_INTRINSICS_)
+                    return static_cast<uint32_t>(_mm_movemask_ps(mask));
+                #else
+                    XMUINT4 bits;
+                    XMStoreUInt4(&bits, mask);
+                    return (bits.x & 1u) | (bits.y & 2u) | (bits.z & 4u) | (bits.w & 8u);
+                #endif
+                }
+
+                // One bit per lane, set if the lane is zero or positive.
+                static uint32_t XM_CALLCONV NonNegativeBits(FXMVECTOR v) noexcept
+                {
+                    return MaskBits(XMVectorGreaterOrEqual(v, g_XMZero));
+                }
+
+                static XMVECTOR XM_CALLCONV DivideOrZero(FXMVECTOR a, FXMVECTOR b) noexcept
+                {
+                    return XMVectorSelect(g_XMZero, XMVectorDivide(a, b), XMVectorGreater(b, g_XMZero));
+                }
+            };
+
+        #include "VectorStreamKernels.inl"
+        }
+
+    #if defined(DIRECTX_SIMD_X86)
+        DIRECTX_BEGIN_TARGET_AVX2
+
+        // Eight lanes with fused multiply-add.
+        namespace AVX2
+        {
+            struct Lanes
+            {
+                using Vector = __m256;
+                using Mask = __m256;
+
+                static constexpr size_t Width = 8;
+
+                static __m256 Load(float const* p) noexcept { return _mm256_loadu_ps(p); }
+                static void Store(float* p, __m256 v) noexcept { _mm256_storeu_ps(p, v); }
+                static __m256 Splat(float value) noexcept { return _mm256_set1_ps(value); }
+
+                static __m256 Add(__m256 a, __m256 b) noexcept { return _mm256_add_ps(a, b); }
+                static __m256 Subtract(__m256 a, __m256 b) noexcept { return _mm256_sub_ps(a, b); }
+                static __m256 Multiply(__m256 a, __m256 b) noexcept { return _mm256_mul_ps(a, b); }
+                static __m256 MultiplyAdd(__m256 a, __m256 b, __m256 c) noexcept { return _mm256_fmadd_ps(a, b, c); }
+                static __m256 Divide(__m256 a, __m256 b) noexcept { return _mm256_div_ps(a, b); }
+                static __m256 Sqrt(__m256 v) noexcept { return _mm256_sqrt_ps(v); }
+                static __m256 Min(__m256 a, __m256 b) noexcept { return _mm256_min_ps(a, b); }
+                static __m256 Max(__m256 a, __m256 b) noexcept { return _mm256_max_ps(a, b); }
+                static __m256 Abs(__m256 v) noexcept { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), v); }
+
+                static __m256 Less(__m256 a, __m256 b) noexcept { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+                static __m256 LessOrEqual(__m256 a, __m256 b) noexcept { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+                static __m256 And(__m256 a, __m256 b) noexcept { return _mm256_and_ps(a, b); }
+                static __m256 Select(__m256 a, __m256 b, __m256 mask) noexcept { return _mm256_blendv_ps(a, b, mask); }
+
+                static uint32_t MaskBits(__m256 mask) noexcept { return static_cast<uint32_t>(_mm256_movemask_ps(mask)); }
+
+                static uint32_t NonNegativeBits(__m256 v) noexcept
+                {
+                    return MaskBits(_mm256_cmp_ps(v, _mm256_setzero_ps(), _CMP_GE_OQ));
+                }
+
+                static __m256 DivideOrZero(__m256 a, __m256 b) noexcept
+                {
+                    return _mm256_and_ps(_mm256_div_ps(a, b), _mm256_cmp_ps(b, _mm256_setzero_ps(), _CMP_GT_OQ));
+                }
+            };
+
+        #include "VectorStreamKernels.inl"
+        }
+
+        DIRECTX_END_TARGET
+
+        DIRECTX_BEGIN_TARGET_AVX512
+
+        // Sixteen lanes with fused multiply-add.
+        namespace AVX512
+        {
+            struct Lanes
+            {
+                using Vector = __m512;
+                using Mask = __mmask16;
+
+                static constexpr size_t Width = 16;
+
+                static __m512 Load(float const* p) noexcept { return _mm512_loadu_ps(p); }
+                static void Store(float* p, __m512 v) noexcept { _mm512_storeu_ps(p, v); }
+                static __m512 Splat(float value) noexcept { return _mm512_set1_ps(value); }
+
+                static __m512 Add(__m512 a, __m512 b) noexcept { return _mm512_add_ps(a, b); }
+                static __m512 Subtract(__m512 a, __m512 b) noexcept { return _mm512_sub_ps(a, b); }
+                static __m512 Multiply(__m512 a, __m512 b) noexcept { return _mm512_mul_ps(a, b); }
+                static __m512 MultiplyAdd(__m512 a, __m512 b, __m512 c) noexcept { return _mm512_fmadd_ps(a, b, c); }
+                static __m512 Divide(__m512 a, __m512 b) noexcept { return _mm512_div_ps(a, b); }
+                static __m512 Sqrt(__m512 v) noexcept { return _mm512_sqrt_ps(v); }
+                static __m512 Min(__m512 a, __m512 b) noexcept { return _mm512_min_ps(a, b); }
+                static __m512 Max(__m512 a, __m512 b) noexcept { return _mm512_max_ps(a, b); }
+                static __m512 Abs(__m512 v) noexcept { return _mm512_abs_ps(v); }
+
+                static __mmask16 Less(__m512 a, __m512 b) noexcept { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+                static __mmask16 LessOrEqual(__m512 a, __m512 b) noexcept { return _mm512_cmp_ps_mask(a, b, _CMP_LE_OQ); }
+                static __mmask16 And(__mmask16 a, __mmask16 b) noexcept { return static_cast<__mmask16>(a & b); }
+                static __m512 Select(__m512 a, __m512 b, __mmask16 mask) noexcept { return _mm512_mask_blend_ps(mask, a, b); }
+
+                static uint32_t MaskBits(__mmask16 mask) noexcept { return mask; }
+
+                static uint32_t NonNegativeBits(__m512 v) noexcept
+                {
+                    return MaskBits(_mm512_cmp_ps_mask(v, _mm512_setzero_ps(), _CMP_GE_OQ));
+                }
+
+                static __m512 DivideOrZero(__m512 a, __m512 b) noexcept
+                {
+                    return _mm512_maskz_div_ps(_mm512_cmp_ps_mask(b, _mm512_setzero_ps(), _CMP_GT_OQ), a, b);
+                }
+            };
+
+        #include "VectorStreamKernels.inl"
+        }
+
+        DIRECTX_END_TARGET
+    #endif
+
+        // The kernels for an instruction set the CPU supports, which the tests use to check each one.
+        inline StreamKernels const& GetStreamKernels(SimdLevel level) noexcept
+        {
+        #if defined(DIRECTX_SIMD_X86)
+            switch (level)
+            {
+            case SimdLevel::AVX512:
+                return AVX512::GetKernels();
+
+            case SimdLevel::AVX2:
+                return AVX2::GetKernels();
+
+            default:
+                break;
+            }
+        #else
+            (void)level;
+        #endif
+
+            return Baseline::GetKernels();
+        }
+
+        // The kernels for the widest instruction set this CPU supports.
+        inline StreamKernels const& GetStreamKernels() noexcept
+        {
+            return GetStreamKernels(GetSimdLevel());
+        }
+    }
+}
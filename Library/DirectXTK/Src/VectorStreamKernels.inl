@@ -0,0 +1,861 @@
+//--------------------------------------------------------------------------------------
+// File: VectorStreamKernels.inl
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+// No include guard: VectorStream.h includes this once per instruction set, inside a namespace that
+// defines Lanes, so each copy of these kernels is compiled for that instruction set.
+//
+// Lanes::Width components are processed at a time, with the remainder done one at a time. Products
+// are summed in the same order as the DirectXMath functions for single vectors, but the AVX2 and
+// AVX-512 copies fuse each multiply and add, so their results can differ from those functions by
+// the rounding of the intermediate products.
+
+// Dim component vectors to Dim components, divided by w (XMVector2TransformCoord, XMVector3TransformCoord).
+template<size_t Dim>
+void TransformCoord(StreamInput const& in, size_t count, XMFLOAT4X4 const& m, StreamOutput const& out) noexcept
+{
+    using Vector = typename Lanes::Vector;
+
+    Vector rows[Dim + 1][Dim + 1];
+
+    for (size_t r = 0; r <= Dim; r++)
+    {
+        const size_t row = (r < Dim) ? r : 3;
+
+        for (size_t c = 0; c <= Dim; c++)
+        {
+            rows[r][c] = Lanes::Splat(m.m[row][(c < Dim) ? c : 3]);
+        }
+    }
+
+    size_t i = 0;
+
+    for (; i + Lanes::Width <= count; i += Lanes::Width)
+    {
+        Vector v[Dim];
+
+        for (size_t d = 0; d < Dim; d++)
+        {
+            v[d] = Lanes::Load(in.c[d] + i);
+        }
+
+        Vector result[Dim + 1];
+
+        for (size_t c = 0; c <= Dim; c++)
+        {
+            result[c] = rows[Dim][c];
+
+            for (size_t d = Dim; d-- > 0;)
+            {
+                result[c] = Lanes::MultiplyAdd(v[d], rows[d][c], result[c]);
+            }
+        }
+
+        for (size_t c = 0; c < Dim; c++)
+        {
+            Lanes::Store(out.c[c] + i, Lanes::Divide(result[c], result[Dim]));
+        }
+    }
+
+    for (; i < count; i++)
+    {
+        float result[Dim + 1];
+
+        for (size_t c = 0; c <= Dim; c++)
+        {
+            result[c] = m.m[3][(c < Dim) ? c : 3];
+
+            for (size_t d = Dim; d-- > 0;)
+            {
+                result[c] += in.c[d][i] * m.m[d][(c < Dim) ? c : 3];
+            }
+        }
+
+        for (size_t c = 0; c < Dim; c++)
+        {
+            out.c[c][i] = result[c] / result[Dim];
+        }
+    }
+}
+
+
+// Dim component vectors to Dim components, ignoring translation (XMVector2TransformNormal, XMVector3TransformNormal).
+template<size_t Dim>
+void TransformNormal(StreamInput const& in, size_t count, XMFLOAT4X4 const& m, StreamOutput const& out) noexcept
+{
+    using Vector = typename Lanes::Vector;
+
+    Vector rows[Dim][Dim];
+
+    for (size_t r = 0; r < Dim; r++)
+    {
+        for (size_t c = 0; c < Dim; c++)
+        {
+            rows[r][c] = Lanes::Splat(m.m[r][c]);
+        }
+    }
+
+    size_t i = 0;
+
+    for (; i + Lanes::Width <= count; i += Lanes::Width)
+    {
+        Vector v[Dim];
+
+        for (size_t d = 0; d < Dim; d++)
+        {
+            v[d] = Lanes::Load(in.c[d] + i);
+        }
+
+        for (size_t c = 0; c < Dim; c++)
+        {
+            Vector result = Lanes::Multiply(v[Dim - 1], rows[Dim - 1][c]);
+
+            for (size_t d = Dim - 1; d-- > 0;)
+            {
+                result = Lanes::MultiplyAdd(v[d], rows[d][c], result);
+            }
+
+            Lanes::Store(out.c[c] + i, result);
+        }
+    }
+
+    for (; i < count; i++)
+    {
+        float result[Dim];
+
+        for (size_t c = 0; c < Dim; c++)
+        {
+            result[c] = in.c[Dim - 1][i] * m.m[Dim - 1][c];
+
+            for (size_t d = Dim - 1; d-- > 0;)
+            {
+                result[c] += in.c[d][i] * m.m[d][c];
+            }
+        }
+
+        for (size_t c = 0; c < Dim; c++)
+        {
+            out.c[c][i] = result[c];
+        }
+    }
+}
+
+
+// Four component vectors by the full matrix (XMVector4Transform).
+inline void Transform4(StreamInput const& in, size_t count, XMFLOAT4X4 const& m, StreamOutput const& out) noexcept
+{
+    using Vector = Lanes::Vector;
+
+    Vector rows[4][4];
+
+    for (size_t r = 0; r < 4; r++)
+    {
+        for (size_t c = 0; c < 4; c++)
+        {
+            rows[r][c] = Lanes::Splat(m.m[r][c]);
+        }
+    }
+
+    size_t i = 0;
+
+    for (; i + Lanes::Width <= count; i += Lanes::Width)
+    {
+        const Vector x = Lanes::Load(in.c[0] + i);
+        const Vector y = Lanes::Load(in.c[1] + i);
+        const Vector z = Lanes::Load(in.c[2] + i);
+        const Vector w = Lanes::Load(in.c[3] + i);
+
+        Vector result[4];
+
+        for (size_t c = 0; c < 4; c++)
+        {
+            result[c] = Lanes::Multiply(w, rows[3][c]);
+            result[c] = Lanes::MultiplyAdd(z, rows[2][c], result[c]);
+            result[c] = Lanes::MultiplyAdd(y, rows[1][c], result[c]);
+            result[c] = Lanes::MultiplyAdd(x, rows[0][c], result[c]);
+        }
+
+        for (size_t c = 0; c < 4; c++)
+        {
+            Lanes::Store(out.c[c] + i, result[c]);
+        }
+    }
+
+    for (; i < count; i++)
+    {
+        const float x = in.c[0][i];
+        const float y = in.c[1][i];
+        const float z = in.c[2][i];
+        const float w = in.c[3][i];
+
+        float result[4];
+
+        for (size_t c = 0; c < 4; c++)
+        {
+            result[c] = x * m.m[0][c] + (y * m.m[1][c] + (z * m.m[2][c] + w * m.m[3][c]));
+        }
+
+        for (size_t c = 0; c < 4; c++)
+        {
+            out.c[c][i] = result[c];
+        }
+    }
+}
+
+
+// Scales vectors to unit length. Zero length vectors become zero.
+template<size_t Dim>
+void Normalize(StreamInput const& in, size_t count, StreamOutput const& out) noexcept
+{
+    using Vector = typename Lanes::Vector;
+
+    size_t i = 0;
+
+    for (; i + Lanes::Width <= count; i += Lanes::Width)
+    {
+        Vector v[Dim];
+
+        for (size_t d = 0; d < Dim; d++)
+        {
+            v[d] = Lanes::Load(in.c[d] + i);
+        }
+
+        Vector lengthSq = Lanes::Multiply(v[0], v[0]);
+
+        for (size_t d = 1; d < Dim; d++)
+        {
+            lengthSq = Lanes::MultiplyAdd(v[d], v[d], lengthSq);
+        }
+
+        const Vector length = Lanes::Sqrt(lengthSq);
+
+        for (size_t d = 0; d < Dim; d++)
+        {
+            Lanes::Store(out.c[d] + i, Lanes::DivideOrZero(v[d], length));
+        }
+    }
+
+    for (; i < count; i++)
+    {
+        float v[Dim];
+
+        for (size_t d = 0; d < Dim; d++)
+        {
+            v[d] = in.c[d][i];
+        }
+
+        float lengthSq = v[0] * v[0];
+
+        for (size_t d = 1; d < Dim; d++)
+        {
+            lengthSq += v[d] * v[d];
+        }
+
+        const float length = sqrtf(lengthSq);
+
+        for (size_t d = 0; d < Dim; d++)
+        {
+            out.c[d][i] = (length > 0) ? v[d] / length : 0.0f;
+        }
+    }
+}
+
+
+template<size_t Dim>
+void Dot(StreamInput const& a, StreamInput const& b, size_t count, float* result) noexcept
+{
+    using Vector = typename Lanes::Vector;
+
+    size_t i = 0;
+
+    for (; i + Lanes::Width <= count; i += Lanes::Width)
+    {
+        Vector dot = Lanes::Multiply(Lanes::Load(a.c[0] + i), Lanes::Load(b.c[0] + i));
+
+        for (size_t d = 1; d < Dim; d++)
+        {
+            dot = Lanes::MultiplyAdd(Lanes::Load(a.c[d] + i), Lanes::Load(b.c[d] + i), dot);
+        }
+
+        Lanes::Store(result + i, dot);
+    }
+
+    for (; i < count; i++)
+    {
+        float dot = a.c[0][i] * b.c[0][i];
+
+        for (size_t d = 1; d < Dim; d++)
+        {
+            dot += a.c[d][i] * b.c[d][i];
+        }
+
+        result[i] = dot;
+    }
+}
+
+
+// Sets a bit for each sphere that is not entirely behind one of the planes, packed 32 to a word.
+inline void CullSpheres(CullPlanes const& planes, StreamInput const& centers, float const* radii, size_t count, uint32_t* visible) noexcept
+{
+    using Vector = Lanes::Vector;
+
+    Vector px[6], py[6], pz[6], pd[6];
+
+    for (size_t p = 0; p < 6; p++)
+    {
+        px[p] = Lanes::Splat(planes.x[p]);
+        py[p] = Lanes::Splat(planes.y[p]);
+        pz[p] = Lanes::Splat(planes.z[p]);
+        pd[p] = Lanes::Splat(planes.d[p]);
+    }
+
+    for (size_t base = 0; base < count; base += 32)
+    {
+        const size_t end = std::min(base + 32, count);
+        uint32_t bits = 0;
+        size_t i = base;
+
+        for (; i + Lanes::Width <= end; i += Lanes::Width)
+        {
+            const Vector x = Lanes::Load(centers.c[0] + i);
+            const Vector y = Lanes::Load(centers.c[1] + i);
+            const Vector z = Lanes::Load(centers.c[2] + i);
+            const Vector r = Lanes::Load(radii + i);
+
+            // The smallest signed distance from any plane, with the radius added.
+            Vector margin = Lanes::Add(pd[0], r);
+            margin = Lanes::MultiplyAdd(z, pz[0], margin);
+            margin = Lanes::MultiplyAdd(y, py[0], margin);
+            margin = Lanes::MultiplyAdd(x, px[0], margin);
+
+            for (size_t p = 1; p < 6; p++)
+            {
+                Vector distance = Lanes::Add(pd[p], r);
+                distance = Lanes::MultiplyAdd(z, pz[p], distance);
+                distance = Lanes::MultiplyAdd(y, py[p], distance);
+                distance = Lanes::MultiplyAdd(x, px[p], distance);
+
+                margin = Lanes::Min(margin, distance);
+            }
+
+            bits |= Lanes::NonNegativeBits(margin) << (i - base);
+        }
+
+        for (; i < end; i++)
+        {
+            bool inside = true;
+
+            for (size_t p = 0; p < 6; p++)
+            {
+                float distance = planes.d[p] + radii[i];
+                distance = centers.c[2][i] * planes.z[p] + distance;
+                distance = centers.c[1][i] * planes.y[p] + distance;
+                distance = centers.c[0][i] * planes.x[p] + distance;
+
+                inside = inside && (distance >= 0);
+            }
+
+            if (inside)
+            {
+                bits |= 1u << (i - base);
+            }
+        }
+
+        visible[base / 32] = bits;
+    }
+}
+
+
+// Sets a bit for each box that is not entirely behind one of the planes, packed 32 to a word.
+inline void CullBoxes(CullPlanes const& planes, StreamInput const& centers, StreamInput const& extents, size_t count, uint32_t* visible) noexcept
+{
+    using Vector = Lanes::Vector;
+
+    Vector px[6], py[6], pz[6], pd[6], ax[6], ay[6], az[6];
+
+    for (size_t p = 0; p < 6; p++)
+    {
+        px[p] = Lanes::Splat(planes.x[p]);
+        py[p] = Lanes::Splat(planes.y[p]);
+        pz[p] = Lanes::Splat(planes.z[p]);
+        pd[p] = Lanes::Splat(planes.d[p]);
+        ax[p] = Lanes::Splat(planes.absX[p]);
+        ay[p] = Lanes::Splat(planes.absY[p]);
+        az[p] = Lanes::Splat(planes.absZ[p]);
+    }
+
+    for (size_t base = 0; base < count; base += 32)
+    {
+        const size_t end = std::min(base + 32, count);
+        uint32_t bits = 0;
+        size_t i = base;
+
+        for (; i + Lanes::Width <= end; i += Lanes::Width)
+        {
+            const Vector x = Lanes::Load(centers.c[0] + i);
+            const Vector y = Lanes::Load(centers.c[1] + i);
+            const Vector z = Lanes::Load(centers.c[2] + i);
+            const Vector ex = Lanes::Load(extents.c[0] + i);
+            const Vector ey = Lanes::Load(extents.c[1] + i);
+            const Vector ez = Lanes::Load(extents.c[2] + i);
+
+            // The smallest signed distance of the center from any plane, with the box's extent
+            // along that plane's normal added.
+            Vector margin = Lanes::MultiplyAdd(z, pz[0], pd[0]);
+            margin = Lanes::MultiplyAdd(y, py[0], margin);
+            margin = Lanes::MultiplyAdd(x, px[0], margin);
+            margin = Lanes::MultiplyAdd(ez, az[0], margin);
+            margin = Lanes::MultiplyAdd(ey, ay[0], margin);
+            margin = Lanes::MultiplyAdd(ex, ax[0], margin);
+
+            for (size_t p = 1; p < 6; p++)
+            {
+                Vector distance = Lanes::MultiplyAdd(z, pz[p], pd[p]);
+                distance = Lanes::MultiplyAdd(y, py[p], distance);
+                distance = Lanes::MultiplyAdd(x, px[p], distance);
+                distance = Lanes::MultiplyAdd(ez, az[p], distance);
+                distance = Lanes::MultiplyAdd(ey, ay[p], distance);
+                distance = Lanes::MultiplyAdd(ex, ax[p], distance);
+
+                margin = Lanes::Min(margin, distance);
+            }
+
+            bits |= Lanes::NonNegativeBits(margin) << (i - base);
+        }
+
+        for (; i < end; i++)
+        {
+            bool inside = true;
+
+            for (size_t p = 0; p < 6; p++)
+            {
+                float distance = centers.c[2][i] * planes.z[p] + planes.d[p];
+                distance = centers.c[1][i] * planes.y[p] + distance;
+                distance = centers.c[0][i] * planes.x[p] + distance;
+                distance = extents.c[2][i] * planes.absZ[p] + distance;
+                distance = extents.c[1][i] * planes.absY[p] + distance;
+                distance = extents.c[0][i] * planes.absX[p] + distance;
+
+                inside = inside && (distance >= 0);
+            }
+
+            if (inside)
+            {
+                bits |= 1u << (i - base);
+            }
+        }
+
+        visible[base / 32] = bits;
+    }
+}
+
+
+// Loads and stores count < Lanes::Width components, so the quaternion kernels can finish with a
+// partial block instead of repeating their math for one component at a time. Unused lanes are zero.
+inline Lanes::Vector LoadPartial(float const* p, size_t count) noexcept
+{
+    float block[Lanes::Width] = {};
+
+    for (size_t j = 0; j < count; j++)
+    {
+        block[j] = p[j];
+    }
+
+    return Lanes::Load(block);
+}
+
+inline void StorePartial(float* p, size_t count, Lanes::Vector v) noexcept
+{
+    float block[Lanes::Width];
+    Lanes::Store(block, v);
+
+    for (size_t j = 0; j < count; j++)
+    {
+        p[j] = block[j];
+    }
+}
+
+inline void LoadQuaternions(StreamInput const& q, size_t i, size_t count, Lanes::Vector* v) noexcept
+{
+    for (size_t c = 0; c < 4; c++)
+    {
+        v[c] = (count == Lanes::Width) ? Lanes::Load(q.c[c] + i) : LoadPartial(q.c[c] + i, count);
+    }
+}
+
+inline void StoreQuaternions(StreamOutput const& q, size_t i, size_t count, Lanes::Vector const* v) noexcept
+{
+    for (size_t c = 0; c < 4; c++)
+    {
+        if (count == Lanes::Width)
+        {
+            Lanes::Store(q.c[c] + i, v[c]);
+        }
+        else
+        {
+            StorePartial(q.c[c] + i, count, v[c]);
+        }
+    }
+}
+
+inline Lanes::Vector QuaternionDot(Lanes::Vector const* a, Lanes::Vector const* b) noexcept
+{
+    Lanes::Vector dot = Lanes::Multiply(a[3], b[3]);
+    dot = Lanes::MultiplyAdd(a[2], b[2], dot);
+    dot = Lanes::MultiplyAdd(a[1], b[1], dot);
+    return Lanes::MultiplyAdd(a[0], b[0], dot);
+}
+
+// Zero length quaternions stay zero, as in Normalize.
+inline void NormalizeQuaternions(Lanes::Vector* q) noexcept
+{
+    const Lanes::Vector length = Lanes::Sqrt(QuaternionDot(q, q));
+
+    for (size_t c = 0; c < 4; c++)
+    {
+        q[c] = Lanes::DivideOrZero(q[c], length);
+    }
+}
+
+// acos for 0 <= x <= 1, with an absolute error below 2e-8 (the polynomial XMScalarACos uses).
+inline Lanes::Vector ACosUnit(Lanes::Vector x) noexcept
+{
+    Lanes::Vector p = Lanes::Splat(-0.0012624911f);
+    p = Lanes::MultiplyAdd(p, x, Lanes::Splat(0.0066700901f));
+    p = Lanes::MultiplyAdd(p, x, Lanes::Splat(-0.0170881256f));
+    p = Lanes::MultiplyAdd(p, x, Lanes::Splat(0.0308918810f));
+    p = Lanes::MultiplyAdd(p, x, Lanes::Splat(-0.0501743046f));
+    p = Lanes::MultiplyAdd(p, x, Lanes::Splat(0.0889789874f));
+    p = Lanes::MultiplyAdd(p, x, Lanes::Splat(-0.2145988016f));
+    p = Lanes::MultiplyAdd(p, x, Lanes::Splat(1.5707963050f));
+
+    return Lanes::Multiply(p, Lanes::Sqrt(Lanes::Subtract(Lanes::Splat(1.0f), x)));
+}
+
+// sin for -pi/2 <= x <= pi/2 (the 11-degree polynomial XMScalarSin uses).
+inline Lanes::Vector SinHalfPi(Lanes::Vector x) noexcept
+{
+    const Lanes::Vector x2 = Lanes::Multiply(x, x);
+
+    Lanes::Vector p = Lanes::Splat(-2.3889859e-08f);
+    p = Lanes::MultiplyAdd(p, x2, Lanes::Splat(2.7525562e-06f));
+    p = Lanes::MultiplyAdd(p, x2, Lanes::Splat(-0.00019840874f));
+    p = Lanes::MultiplyAdd(p, x2, Lanes::Splat(0.0083333310f));
+    p = Lanes::MultiplyAdd(p, x2, Lanes::Splat(-0.16666667f));
+    p = Lanes::MultiplyAdd(p, x2, Lanes::Splat(1.0f));
+
+    return Lanes::Multiply(p, x);
+}
+
+enum class Interpolation
+{
+    Lerp,           // Quaternion::Lerp
+    Slerp,          // XMQuaternionSlerp
+    FastSlerp,      // Lerp with t adjusted to follow Slerp
+};
+
+// Interpolates along the shorter arc from q1 (t = 0) to q2 (t = 1).
+template<Interpolation Mode>
+void InterpolateQuaternions(StreamInput const& q1, StreamInput const& q2, size_t count, float t, StreamOutput const& out) noexcept
+{
+    using Vector = typename Lanes::Vector;
+
+    const Vector zero = Lanes::Splat(0.0f);
+    const Vector one = Lanes::Splat(1.0f);
+    const Vector tv = Lanes::Splat(t);
+
+    for (size_t i = 0; i < count; i += Lanes::Width)
+    {
+        const size_t blockCount = std::min(Lanes::Width, count - i);
+
+        Vector a[4], b[4];
+        LoadQuaternions(q1, i, blockCount, a);
+        LoadQuaternions(q2, i, blockCount, b);
+
+        const Vector dot = QuaternionDot(a, b);
+        const Vector cosine = Lanes::Abs(dot);
+
+        Vector scale1;
+
+        switch (Mode)
+        {
+        case Interpolation::Slerp:
+        {
+            const Vector omega = ACosUnit(cosine);
+            const Vector sine = Lanes::Sqrt(Lanes::Multiply(Lanes::Subtract(one, cosine), Lanes::Add(one, cosine)));
+
+            // Nearly identical rotations are interpolated linearly, as XMQuaternionSlerp does.
+            const auto nearlyParallel = Lanes::Less(Lanes::Splat(1.0f - 0.00001f), cosine);
+
+            const Vector scale0 = Lanes::Select(
+                Lanes::Divide(SinHalfPi(Lanes::Multiply(Lanes::Subtract(one, tv), omega)), sine),
+                Lanes::Subtract(one, tv),
+                nearlyParallel);
+
+            scale1 = Lanes::Select(
+                Lanes::Divide(SinHalfPi(Lanes::Multiply(tv, omega)), sine),
+                tv,
+                nearlyParallel);
+
+            for (size_t c = 0; c < 4; c++)
+            {
+                a[c] = Lanes::Multiply(a[c], scale0);
+            }
+            break;
+        }
+
+        case Interpolation::FastSlerp:
+        {
+            // Kapoulkine, "Approximating slerp" (2015): a correction to t, fitted over the angle
+            // between the quaternions, which keeps the angular error of the result below 1e-3 radians.
+            const Vector h = Lanes::Subtract(tv, Lanes::Splat(0.5f));
+
+            Vector A = Lanes::MultiplyAdd(cosine, Lanes::Splat(-1.43519f), Lanes::Splat(3.55645f));
+            A = Lanes::MultiplyAdd(cosine, A, Lanes::Splat(-3.2452f));
+            A = Lanes::MultiplyAdd(cosine, A, Lanes::Splat(1.0904f));
+
+            Vector B = Lanes::MultiplyAdd(cosine, Lanes::Splat(0.215638f), Lanes::Splat(-1.06021f));
+            B = Lanes::MultiplyAdd(cosine, B, Lanes::Splat(0.848013f));
+
+            const Vector k = Lanes::MultiplyAdd(Lanes::Multiply(A, h), h, B);
+            const Vector bend = Lanes::Multiply(Lanes::Multiply(tv, h), Lanes::Subtract(tv, one));
+
+            scale1 = Lanes::MultiplyAdd(bend, k, tv);
+
+            for (size_t c = 0; c < 4; c++)
+            {
+                a[c] = Lanes::Multiply(a[c], Lanes::Subtract(one, scale1));
+            }
+            break;
+        }
+
+        default:
+            scale1 = tv;
+
+            for (size_t c = 0; c < 4; c++)
+            {
+                a[c] = Lanes::Multiply(a[c], Lanes::Subtract(one, tv));
+            }
+            break;
+        }
+
+        // q2 is negated when that is the shorter arc.
+        scale1 = Lanes::Select(scale1, Lanes::Subtract(zero, scale1), Lanes::Less(dot, zero));
+
+        for (size_t c = 0; c < 4; c++)
+        {
+            a[c] = Lanes::MultiplyAdd(b[c], scale1, a[c]);
+        }
+
+        if (Mode != Interpolation::Slerp)
+        {
+            NormalizeQuaternions(a);
+        }
+
+        StoreQuaternions(out, i, blockCount, a);
+    }
+}
+
+// The normalized, weighted sum of several poses, each flipped into the hemisphere of the first.
+inline void BlendQuaternions(StreamInput const* poses, float const* weights, size_t poseCount, size_t count, StreamOutput const& out) noexcept
+{
+    using Vector = Lanes::Vector;
+
+    if (!poseCount)
+        return;
+
+    const Vector zero = Lanes::Splat(0.0f);
+
+    for (size_t i = 0; i < count; i += Lanes::Width)
+    {
+        const size_t blockCount = std::min(Lanes::Width, count - i);
+
+        Vector first[4], sum[4];
+        LoadQuaternions(poses[0], i, blockCount, first);
+
+        const Vector weight0 = Lanes::Splat(weights[0]);
+
+        for (size_t c = 0; c < 4; c++)
+        {
+            sum[c] = Lanes::Multiply(first[c], weight0);
+        }
+
+        for (size_t p = 1; p < poseCount; p++)
+        {
+            Vector q[4];
+            LoadQuaternions(poses[p], i, blockCount, q);
+
+            const Vector weight = Lanes::Splat(weights[p]);
+            const Vector scale = Lanes::Select(weight, Lanes::Subtract(zero, weight), Lanes::Less(QuaternionDot(first, q), zero));
+
+            for (size_t c = 0; c < 4; c++)
+            {
+                sum[c] = Lanes::MultiplyAdd(q[c], scale, sum[c]);
+            }
+        }
+
+        NormalizeQuaternions(sum);
+
+        StoreQuaternions(out, i, blockCount, sum);
+    }
+}
+
+// Widens the bounds to take in the points (x / w, y / w) where mask is set, given w > 0 there.
+inline void IncludePoints(Lanes::Vector x, Lanes::Vector y, Lanes::Vector w, Lanes::Mask mask, Lanes::Vector* bounds) noexcept
+{
+    const Lanes::Vector sx = Lanes::DivideOrZero(x, w);
+    const Lanes::Vector sy = Lanes::DivideOrZero(y, w);
+
+    bounds[0] = Lanes::Select(bounds[0], Lanes::Min(bounds[0], sx), mask);
+    bounds[1] = Lanes::Select(bounds[1], Lanes::Min(bounds[1], sy), mask);
+    bounds[2] = Lanes::Select(bounds[2], Lanes::Max(bounds[2], sx), mask);
+    bounds[3] = Lanes::Select(bounds[3], Lanes::Max(bounds[3], sy), mask);
+}
+
+// Bounds of x / w and y / w over each box after m, for the part of the box in front of the camera
+// (w above a small epsilon, which suits both normal and reversed depth). out gets the minimum x and
+// y, then the maximum x and y. Boxes entirely behind the camera get minimums above their maximums.
+inline void ProjectBoxes(XMFLOAT4X4 const& m, StreamInput const& centers, StreamInput const& extents, size_t count, StreamOutput const& out) noexcept
+{
+    using Vector = Lanes::Vector;
+
+    // Only the x, y and w columns of m are needed.
+    constexpr size_t Columns[3] = { 0, 1, 3 };
+
+    Vector rows[4][3];
+
+    for (size_t r = 0; r < 4; r++)
+    {
+        for (size_t c = 0; c < 3; c++)
+        {
+            rows[r][c] = Lanes::Splat(m.m[r][Columns[c]]);
+        }
+    }
+
+    const Vector nearW = Lanes::Splat(1e-6f);
+
+    for (size_t i = 0; i < count; i += Lanes::Width)
+    {
+        const size_t blockCount = std::min(Lanes::Width, count - i);
+
+        Vector center[3], extent[3];
+
+        for (size_t d = 0; d < 3; d++)
+        {
+            center[d] = (blockCount == Lanes::Width) ? Lanes::Load(centers.c[d] + i) : LoadPartial(centers.c[d] + i, blockCount);
+            extent[d] = (blockCount == Lanes::Width) ? Lanes::Load(extents.c[d] + i) : LoadPartial(extents.c[d] + i, blockCount);
+        }
+
+        // Each corner is the transformed center, plus or minus the transformed extent along each axis.
+        Vector corners[8][3];
+
+        for (size_t c = 0; c < 3; c++)
+        {
+            Vector mid = rows[3][c];
+            Vector axis[3];
+
+            for (size_t d = 3; d-- > 0;)
+            {
+                mid = Lanes::MultiplyAdd(center[d], rows[d][c], mid);
+                axis[d] = Lanes::Multiply(extent[d], rows[d][c]);
+            }
+
+            for (size_t k = 0; k < 8; k++)
+            {
+                Vector v = mid;
+
+                for (size_t d = 0; d < 3; d++)
+                {
+                    v = (k & (size_t(1) << d)) ? Lanes::Add(v, axis[d]) : Lanes::Subtract(v, axis[d]);
+                }
+
+                corners[k][c] = v;
+            }
+        }
+
+        Vector bounds[4] =
+        {
+            Lanes::Splat(FLT_MAX),
+            Lanes::Splat(FLT_MAX),
+            Lanes::Splat(-FLT_MAX),
+            Lanes::Splat(-FLT_MAX),
+        };
+
+        Vector depth[8];
+
+        for (size_t k = 0; k < 8; k++)
+        {
+            depth[k] = Lanes::Subtract(corners[k][2], nearW);
+
+            IncludePoints(corners[k][0], corners[k][1], corners[k][2], Lanes::LessOrEqual(nearW, corners[k][2]), bounds);
+        }
+
+        // Where an edge passes behind the camera, the point where it does so bounds the rest.
+        for (size_t k = 0; k < 8; k++)
+        {
+            for (size_t d = 0; d < 3; d++)
+            {
+                const size_t other = k | (size_t(1) << d);
+
+                if (other == k)
+                    continue;
+
+                const Vector t = Lanes::Divide(depth[k], Lanes::Subtract(depth[k], depth[other]));
+                const auto crosses = Lanes::Less(Lanes::Multiply(depth[k], depth[other]), Lanes::Splat(0.0f));
+
+                Vector p[2];
+
+                for (size_t c = 0; c < 2; c++)
+                {
+                    p[c] = Lanes::MultiplyAdd(Lanes::Subtract(corners[other][c], corners[k][c]), t, corners[k][c]);
+                }
+
+                IncludePoints(p[0], p[1], nearW, crosses, bounds);
+            }
+        }
+
+        for (size_t c = 0; c < 4; c++)
+        {
+            if (blockCount == Lanes::Width)
+            {
+                Lanes::Store(out.c[c] + i, bounds[c]);
+            }
+            else
+            {
+                StorePartial(out.c[c] + i, blockCount, bounds[c]);
+            }
+        }
+    }
+}
+
+inline StreamKernels const& GetKernels() noexcept
+{
+    static const StreamKernels s_kernels =
+    {
+        TransformCoord<2>,
+        TransformCoord<3>,
+        TransformNormal<2>,
+        TransformNormal<3>,
+        Transform4,
+        Normalize<2>,
+        Normalize<3>,
+        Normalize<4>,
+        Dot<2>,
+        Dot<3>,
+        Dot<4>,
+        CullSpheres,
+        CullBoxes,
+        InterpolateQuaternions<Interpolation::Lerp>,
+        InterpolateQuaternions<Interpolation::Slerp>,
+        InterpolateQuaternions<Interpolation::FastSlerp>,
+        BlendQuaternions,
+        ProjectBoxes,
+    };
+
+    return s_kernels;
+}
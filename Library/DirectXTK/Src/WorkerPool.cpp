@@ -0,0 +1,196 @@
+//--------------------------------------------------------------------------------------
+// File: WorkerPool.cpp
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "pch.h"
+#include "WorkerPool.h"
+
+using namespace DirectX;
+
+namespace
+{
+    // The pool whose chunks the current thread is running, if any.
+    thread_local WorkerPool const* t_activePool = nullptr;
+
+    class ActivePoolScope
+    {
+    public:
+        explicit ActivePoolScope(WorkerPool const* pool) noexcept :
+            mPrevious(t_activePool)
+        {
+            t_activePool = pool;
+        }
+
+        ActivePoolScope(ActivePoolScope const&) = delete;
+        ActivePoolScope& operator= (ActivePoolScope const&) = delete;
+
+        ~ActivePoolScope()
+        {
+            t_activePool = mPrevious;
+        }
+
+    private:
+        WorkerPool const* mPrevious;
+    };
+}
+
+
+WorkerPool::WorkerPool(size_t workerCount) :
+    mJob(nullptr),
+    mGeneration(0),
+    mActiveWorkers(0),
+    mShutdown(false)
+{
+    mWorkers.reserve(workerCount);
+
+    for (size_t i = 0; i < workerCount; i++)
+    {
+        mWorkers.emplace_back(&WorkerPool::WorkerThread, this);
+    }
+}
+
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mJobMutex);
+        mShutdown = true;
+    }
+
+    mJobReady.notify_all();
+
+    for (auto& worker : mWorkers)
+    {
+        worker.join();
+    }
+}
+
+
+void WorkerPool::ParallelFor(size_t count, size_t minChunkSize, std::function<void(size_t, size_t)> const& action)
+{
+    if (!count)
+        return;
+
+    if (!minChunkSize)
+        minChunkSize = 1;
+
+    // Aim for a few chunks per thread so uneven work still balances out.
+    const size_t targetChunks = GetThreadCount() * 4;
+    const size_t chunkSize = std::max(minChunkSize, (count + targetChunks - 1) / targetChunks);
+    const size_t chunkCount = (count + chunkSize - 1) / chunkSize;
+
+    // A nested call from one of our own chunks runs inline, since the other threads may all
+    // be busy with the outer loop, which also still holds the submit lock.
+    if (mWorkers.empty() || chunkCount < 2 || t_activePool == this)
+    {
+        action(0, count);
+        return;
+    }
+
+    std::lock_guard<std::mutex> submitLock(mSubmitMutex);
+
+    Job job;
+    job.action = &action;
+    job.count = count;
+    job.chunkSize = chunkSize;
+    job.chunkCount = chunkCount;
+    job.nextChunk = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(mJobMutex);
+
+        mJob = &job;
+        mGeneration++;
+    }
+
+    mJobReady.notify_all();
+
+    // The calling thread works on the job too. Once it runs out of chunks to claim, every
+    // chunk has been handed out, so we only need to wait for workers still running one.
+    {
+        ActivePoolScope scope(this);
+
+        RunChunks(job);
+    }
+
+    std::unique_lock<std::mutex> lock(mJobMutex);
+
+    mJobDone.wait(lock, [this] { return mActiveWorkers == 0; });
+
+    // Workers that have not woken up yet will now skip this job.
+    mJob = nullptr;
+}
+
+
+// Claims chunks of a job until none are left.
+void WorkerPool::RunChunks(Job& job) noexcept
+{
+    for (;;)
+    {
+        const size_t chunk = job.nextChunk.fetch_add(1);
+
+        if (chunk >= job.chunkCount)
+            break;
+
+        const size_t begin = chunk * job.chunkSize;
+        const size_t end = std::min(begin + job.chunkSize, job.count);
+
+        (*job.action)(begin, end);
+    }
+}
+
+
+void WorkerPool::WorkerThread()
+{
+    uint64_t lastGeneration = 0;
+
+    for (;;)
+    {
+        Job* job;
+
+        {
+            std::unique_lock<std::mutex> lock(mJobMutex);
+
+            mJobReady.wait(lock, [&] { return mShutdown || (mJob && mGeneration != lastGeneration); });
+
+            if (mShutdown)
+                return;
+
+            lastGeneration = mGeneration;
+            job = mJob;
+            mActiveWorkers++;
+        }
+
+        {
+            ActivePoolScope scope(this);
+
+            RunChunks(*job);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mJobMutex);
+
+            if (--mActiveWorkers == 0)
+            {
+                mJobDone.notify_all();
+            }
+        }
+    }
+}
+
+
+WorkerPool& WorkerPool::Get()
+{
+    static WorkerPool s_pool([]() -> size_t
+        {
+            const unsigned int hardwareThreads = std::thread::hardware_concurrency();
+            return (hardwareThreads > 1) ? size_t(hardwareThreads - 1) : 0;
+        }());
+
+    return s_pool;
+}
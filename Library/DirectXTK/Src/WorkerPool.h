@@ -0,0 +1,78 @@
+//--------------------------------------------------------------------------------------
+// File: WorkerPool.h
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace DirectX
+{
+    // Small fixed-size pool of worker threads used to split data-parallel loops into chunks.
+    // The calling thread always takes part in the work, so a pool with zero workers simply
+    // runs everything inline.
+    class WorkerPool
+    {
+    public:
+        explicit WorkerPool(size_t workerCount);
+
+        WorkerPool(WorkerPool const&) = delete;
+        WorkerPool& operator= (WorkerPool const&) = delete;
+
+        ~WorkerPool();
+
+        // Total number of threads that run chunks, including the caller of ParallelFor.
+        size_t GetThreadCount() const noexcept { return mWorkers.size() + 1; }
+
+        // Invokes action(begin, end) over [0, count) in chunks of at least minChunkSize items and
+        // returns once every chunk has completed. The action must not throw. If it calls back into
+        // ParallelFor on the same pool, the nested loop runs inline as a single chunk.
+        void ParallelFor(size_t count, size_t minChunkSize, std::function<void(size_t, size_t)> const& action);
+
+        // Process-wide pool sized to the hardware, created on first use.
+        static WorkerPool& Get();
+
+    private:
+        // Describes the loop currently being executed.
+        struct Job
+        {
+            std::function<void(size_t, size_t)> const* action;
+            size_t count;
+            size_t chunkSize;
+            size_t chunkCount;
+            std::atomic<size_t> nextChunk;
+        };
+
+        void WorkerThread();
+
+        static void RunChunks(Job& job) noexcept;
+
+        std::vector<std::thread> mWorkers;
+
+        // Serializes ParallelFor calls made from different threads.
+        std::mutex mSubmitMutex;
+
+        // Guards the fields below.
+        std::mutex mJobMutex;
+        std::condition_variable mJobReady;
+        std::condition_variable mJobDone;
+
+        Job* mJob;
+        uint64_t mGeneration;
+        size_t mActiveWorkers;
+        bool mShutdown;
+    };
+}
@@ -0,0 +1,270 @@
+//--------------------------------------------------------------------------------------
+// File: AdaptiveRingTest.cpp
+//
+// Checks when AdaptiveRingSizer grows and shrinks, and that a ring driven by it settles at
+// a size where it rarely wraps.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHarness.h"
+
+#include "AdaptiveRing.h"
+
+#include <random>
+
+using namespace DirectX;
+using namespace DirectX::Tests;
+
+namespace
+{
+    constexpr size_t Window = AdaptiveRingSizer::WindowSize;
+
+
+    // Fills a ring the way SpriteBatch and PrimitiveBatch do: each draw goes at the current
+    // position, or at the start if it does not fit, which counts as a wrap unless the ring was
+    // already empty. The position carries over from one interval to the next.
+    class SimulatedRing
+    {
+    public:
+        explicit SimulatedRing(AdaptiveRingSizer& sizer) noexcept :
+            mSizer(sizer),
+            mPosition(0)
+        {
+        }
+
+        // Draws elements in chunks of drawSize, and returns the number of wraps.
+        size_t Frame(size_t elements, size_t drawSize)
+        {
+            size_t wraps = 0;
+
+            for (size_t done = 0; done < elements; done += drawSize)
+            {
+                const size_t count = std::min(drawSize, elements - done);
+
+                if (mPosition + count > mSizer.GetCapacity())
+                {
+                    if (mPosition > 0)
+                    {
+                        wraps++;
+                    }
+
+                    mPosition = 0;
+                }
+
+                mPosition += count;
+            }
+
+            // A resize recreates the buffer, which starts out empty.
+            if (mSizer.EndInterval(elements, wraps))
+            {
+                mPosition = 0;
+            }
+
+            return wraps;
+        }
+
+    private:
+        AdaptiveRingSizer& mSizer;
+        size_t mPosition;
+    };
+}
+
+
+TEST_CASE(AdaptiveRingStartsAtMinimum)
+{
+    AdaptiveRingSizer sizer(1000, 16000);
+
+    CHECK(sizer.GetCapacity() == 1000);
+    CHECK(sizer.GetIntervalCount() == 0);
+    CHECK(sizer.GetWrapCount() == 0);
+
+    // Light demand that never wraps leaves the ring alone, and it never shrinks below the minimum.
+    for (size_t i = 0; i < 10 * Window; i++)
+    {
+        CHECK(!sizer.EndInterval(10, 0));
+    }
+
+    CHECK(sizer.GetCapacity() == 1000);
+    CHECK(sizer.GetIntervalCount() == 10 * Window);
+
+    return true;
+}
+
+
+TEST_CASE(AdaptiveRingGrowsOnOverrun)
+{
+    AdaptiveRingSizer sizer(1000, 16000);
+
+    // An interval larger than the ring grows it at once, to a power-of-two multiple of the minimum
+    // with room for twice the demand.
+    CHECK(sizer.EndInterval(1001, 1));
+    CHECK(sizer.GetCapacity() == 4000);
+
+    CHECK(sizer.EndInterval(2500, 0) == false);
+    CHECK(sizer.GetCapacity() == 4000);
+
+    CHECK(sizer.EndInterval(4500, 1));
+    CHECK(sizer.GetCapacity() == 16000);
+
+    // Growth stops at the maximum, even for demand beyond it.
+    CHECK(!sizer.EndInterval(100000, 7));
+    CHECK(sizer.GetCapacity() == 16000);
+
+    CHECK(sizer.GetIntervalCount() == 4);
+    CHECK(sizer.GetWrapCount() == 9);
+
+    // A maximum that is not a power-of-two multiple of the minimum is still respected.
+    AdaptiveRingSizer odd(1000, 5000);
+
+    CHECK(odd.EndInterval(3000, 0));
+    CHECK(odd.GetCapacity() == 5000);
+
+    return true;
+}
+
+
+TEST_CASE(AdaptiveRingWrapThreshold)
+{
+    // Wrapping exactly once every eight intervals is tolerated...
+    AdaptiveRingSizer tolerated(1000, 16000);
+
+    for (size_t i = 0; i < Window; i++)
+    {
+        CHECK(!tolerated.EndInterval(900, (i % 8 == 0) ? 1 : 0));
+    }
+
+    CHECK(tolerated.GetCapacity() == 1000);
+
+    // ...but one more wrap in the window doubles the ring when the window closes, and not before.
+    AdaptiveRingSizer busy(1000, 16000);
+
+    for (size_t i = 0; i < Window - 1; i++)
+    {
+        CHECK(!busy.EndInterval(900, (i % 8 == 0 || i == 1) ? 1 : 0));
+    }
+
+    CHECK(busy.GetCapacity() == 1000);
+    CHECK(busy.EndInterval(900, 0));
+    CHECK(busy.GetCapacity() == 2000);
+
+    return true;
+}
+
+
+TEST_CASE(AdaptiveRingShrinksWhenQuiet)
+{
+    AdaptiveRingSizer sizer(1000, 16000);
+
+    CHECK(sizer.EndInterval(7000, 1));
+    CHECK(sizer.GetCapacity() == 16000);
+
+    // A window that peaks at a quarter of the ring or more keeps its size.
+    for (size_t i = 0; i < Window; i++)
+    {
+        CHECK(!sizer.EndInterval((i == 10) ? 4000 : 100, 0));
+    }
+
+    CHECK(sizer.GetCapacity() == 16000);
+
+    // Quiet windows halve it one step at a time, down to the minimum and no further.
+    size_t expected = 16000;
+
+    while (expected > 1000)
+    {
+        for (size_t i = 0; i < Window - 1; i++)
+        {
+            CHECK(!sizer.EndInterval(100, 0));
+        }
+
+        CHECK(sizer.EndInterval(100, 0));
+
+        expected /= 2;
+
+        CHECK(sizer.GetCapacity() == expected);
+    }
+
+    for (size_t i = 0; i < Window; i++)
+    {
+        CHECK(!sizer.EndInterval(100, 0));
+    }
+
+    CHECK(sizer.GetCapacity() == 1000);
+
+    // Too many wraps in a window also prevent shrinking, however small the peak.
+    CHECK(sizer.EndInterval(3000, 1));
+    CHECK(sizer.GetCapacity() == 8000);
+
+    for (size_t i = 0; i < Window; i++)
+    {
+        sizer.EndInterval(100, (i < 3) ? 1 : 0);
+    }
+
+    CHECK(sizer.GetCapacity() == 8000);
+
+    return true;
+}
+
+
+TEST_CASE(AdaptiveRingSettles)
+{
+    std::mt19937 rng(8);
+
+    for (int trial = 0; trial < 200; trial++)
+    {
+        const size_t minCapacity = size_t(256) << (rng() % 4);
+        const size_t maxCapacity = minCapacity * 16;
+
+        // Demand between 1% and the whole of the largest ring, drawn in uneven chunks.
+        const size_t demand = std::max<size_t>(maxCapacity / 100, rng() % maxCapacity);
+        const size_t drawSize = 1 + rng() % std::min<size_t>(demand, minCapacity);
+
+        std::uniform_int_distribution<size_t> jitter(demand * 3 / 4, demand);
+
+        AdaptiveRingSizer sizer(minCapacity, maxCapacity);
+        SimulatedRing ring(sizer);
+
+        constexpr size_t Windows = 16;
+        constexpr size_t MeasuredWindows = 4;
+
+        size_t resizes = 0;
+        size_t measuredWraps = 0;
+
+        for (size_t frame = 0; frame < Windows * Window; frame++)
+        {
+            const size_t capacity = sizer.GetCapacity();
+
+            const size_t wraps = ring.Frame(jitter(rng), drawSize);
+
+            if (frame >= (Windows - MeasuredWindows) * Window)
+            {
+                measuredWraps += wraps;
+            }
+
+            if (sizer.GetCapacity() != capacity)
+            {
+                resizes++;
+            }
+
+            CHECK(sizer.GetCapacity() >= minCapacity && sizer.GetCapacity() <= maxCapacity);
+        }
+
+        // Steady demand must not make the ring thrash between sizes, and once settled it must wrap
+        // rarely, unless it is already as large as it may get. Growth stops at one wrap every eight
+        // frames, which the jitter and uneven draws can push a little over, so allow for twice that.
+        const bool thrashing = resizes > 8;
+        const bool wrapsOften = (measuredWraps * 4 > MeasuredWindows * Window) && (sizer.GetCapacity() < maxCapacity);
+
+        if (thrashing || wrapsOften)
+        {
+            printf("ERROR: trial %d: demand %zu in draws of %zu ended at capacity %zu (min %zu) after %zu resizes, with %zu wraps in the last %zu frames\n",
+                trial, demand, drawSize, sizer.GetCapacity(), minCapacity, resizes, measuredWraps, MeasuredWindows * Window);
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,185 @@
+//--------------------------------------------------------------------------------------
+// File: ColorKernelsBenchmark.cpp
+//
+// Times the color array kernels for each instruction set against the DirectXMath call they
+// replace, made once per color: XMColorSRGBToRGB and XMColorRGBToSRGB for the fast sRGB
+// conversions, XMColorAdjustSaturation, and XMStoreUByteN4, XMLoadUByteN4 and XMStoreColor for
+// packing, unpacking and swapping red and blue.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHarness.h"
+#include "SimdTestLevels.h"
+
+#include "ColorKernels.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+using namespace DirectX::PackedVector;
+using namespace DirectX::Tests;
+
+namespace
+{
+    // One line: the DirectXMath loop, then the kernel for each instruction set, in ns per color.
+    template<typename TScalar, typename TKernel>
+    void TimeRow(char const* label, size_t count, size_t iterations, std::vector<SimdLevel> const& levels, TScalar&& scalar, TKernel&& kernel)
+    {
+        printf("  %-20s %12.3f", label, MeasureNanoseconds(iterations, scalar) / double(count));
+
+        for (const SimdLevel level : levels)
+        {
+            auto const& kernels = ColorKernels::GetColorKernels(level);
+
+            const double time = MeasureNanoseconds(iterations, [&]()
+                {
+                    kernel(kernels);
+                });
+
+            printf(" %12.3f", time / double(count));
+        }
+
+        printf("\n");
+    }
+}
+
+
+BENCHMARK(ColorKernelsThroughput)
+{
+    const auto levels = GetTestedSimdLevels();
+
+    for (const size_t count : { size_t(1) << 12, size_t(1) << 20 })
+    {
+        std::mt19937 rng(static_cast<uint32_t>(count));
+        std::uniform_real_distribution<float> channel(0.f, 1.f);
+
+        std::vector<float> colors(count * 4);
+        for (auto& c : colors)
+        {
+            c = channel(rng);
+        }
+
+        std::vector<float> results(count * 4);
+        std::vector<uint32_t> packed(count);
+        std::vector<uint32_t> swapped(count);
+
+        auto const* source = reinterpret_cast<XMFLOAT4 const*>(colors.data());
+        auto* result = reinterpret_cast<XMFLOAT4*>(results.data());
+
+        // About 16M colors per measurement, however many there are.
+        const size_t iterations = std::max<size_t>(1, (size_t(1) << 24) / count);
+
+        char label[32];
+        snprintf(label, sizeof(label), "%zu colors", count);
+
+        printf("%-22s %12s", label, "DirectXMath");
+
+        for (const SimdLevel level : levels)
+        {
+            printf(" %12s", GetSimdLevelName(level));
+        }
+
+        printf("   (ns per color)\n");
+
+        TimeRow("sRGB to linear", count, iterations, levels,
+            [&]()
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    XMStoreFloat4(&result[i], XMColorSRGBToRGB(XMLoadFloat4(&source[i])));
+                }
+            },
+            [&](ColorKernels::Kernels const& kernels)
+            {
+                kernels.srgbToLinearFast(colors.data(), count, results.data());
+            });
+
+        TimeRow("linear to sRGB", count, iterations, levels,
+            [&]()
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    XMStoreFloat4(&result[i], XMColorRGBToSRGB(XMLoadFloat4(&source[i])));
+                }
+            },
+            [&](ColorKernels::Kernels const& kernels)
+            {
+                kernels.linearToSRGBFast(colors.data(), count, results.data());
+            });
+
+        TimeRow("adjust saturation", count, iterations, levels,
+            [&]()
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    XMStoreFloat4(&result[i], XMColorAdjustSaturation(XMLoadFloat4(&source[i]), 0.5f));
+                }
+            },
+            [&](ColorKernels::Kernels const& kernels)
+            {
+                kernels.adjustSaturation(colors.data(), count, 0.5f, results.data());
+            });
+
+        KeepResult(static_cast<uint64_t>(results[count * 2] * 1000.f));
+
+        TimeRow("pack RGBA", count, iterations, levels,
+            [&]()
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    XMUBYTEN4 rgba;
+                    XMStoreUByteN4(&rgba, XMLoadFloat4(&source[i]));
+                    packed[i] = rgba.v;
+                }
+            },
+            [&](ColorKernels::Kernels const& kernels)
+            {
+                kernels.packRGBA(colors.data(), count, packed.data());
+            });
+
+        TimeRow("unpack RGBA", count, iterations, levels,
+            [&]()
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    const XMUBYTEN4 rgba(packed[i]);
+                    XMStoreFloat4(&result[i], XMLoadUByteN4(&rgba));
+                }
+            },
+            [&](ColorKernels::Kernels const& kernels)
+            {
+                kernels.unpackRGBA(packed.data(), count, results.data());
+            });
+
+        KeepResult(static_cast<uint64_t>(results[count * 2] * 1000.f));
+
+        TimeRow("swap red and blue", count, iterations, levels,
+            [&]()
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    const XMUBYTEN4 rgba(packed[i]);
+
+                    XMCOLOR bgra;
+                    XMStoreColor(&bgra, XMLoadUByteN4(&rgba));
+                    swapped[i] = bgra.c;
+                }
+            },
+            [&](ColorKernels::Kernels const& kernels)
+            {
+                kernels.swapRedBlue(packed.data(), count, swapped.data());
+            });
+
+        KeepResult(swapped[count / 2]);
+
+        printf("\n");
+    }
+
+    return true;
+}
@@ -0,0 +1,583 @@
+//--------------------------------------------------------------------------------------
+// File: ColorKernelsTest.cpp
+//
+// Checks the Color array functions against the scalar DirectXMath paths: the exact sRGB
+// conversions bit for bit against XMColorSRGBToRGB and XMColorRGBToSRGB, the fast ones to
+// within their stated error for each instruction set, and packing, unpacking and swapping red
+// and blue against XMUBYTEN4 and XMCOLOR.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHarness.h"
+#include "SimdTestLevels.h"
+
+#include "SimpleMath.h"
+#include "ColorKernels.h"
+
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+using namespace DirectX::PackedVector;
+using namespace DirectX::SimpleMath;
+using namespace DirectX::Tests;
+
+namespace
+{
+    uint32_t FloatBits(float value) noexcept
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+
+    // What SimpleMath.h promises for SRGBToLinearFast and LinearToSRGBFast.
+    constexpr float FastSRGBTolerance = 1e-6f;
+
+    constexpr float GuardChannel = -12345.f;
+    constexpr uint32_t GuardPacked = 0xDEADBEEFu;
+
+    // Around each register width: 2 colors for AVX2, 4 for AVX-512, and 4 or 8 for packing and swizzling.
+    const size_t ColorCounts[] = { 0, 1, 2, 3, 4, 5, 7, 8, 9, 11, 15, 16, 17, 1000 };
+
+
+    // Channel values for the sRGB curves: every 16-bit unorm value, the floats either side of both
+    // cutoffs, powers of two down to where the linear segments go to zero, and values outside [0, 1],
+    // which both paths clamp.
+    std::vector<float> MakeCurveInputs()
+    {
+        std::vector<float> inputs;
+
+        for (uint32_t i = 0; i <= 0xFFFF; i++)
+        {
+            inputs.push_back(float(i) / 65535.f);
+        }
+
+        for (const float cutoff : { ColorKernels::SRGBCutoff, ColorKernels::LinearCutoff })
+        {
+            float below = cutoff;
+            float above = cutoff;
+
+            for (int step = 0; step < 64; step++)
+            {
+                inputs.push_back(below);
+                inputs.push_back(above);
+
+                below = std::nextafter(below, 0.f);
+                above = std::nextafter(above, 1.f);
+            }
+        }
+
+        for (int exponent = -1; exponent >= -149; exponent--)
+        {
+            inputs.push_back(std::ldexp(1.f, exponent));
+        }
+
+        const float outside[] = { -0.f, -FLT_MIN, -0.5f, -1.f, 1.0000001f, 1.5f, 100.f, FLT_MAX, std::numeric_limits<float>::infinity() };
+
+        for (const float value : outside)
+        {
+            inputs.push_back(value);
+            inputs.push_back(-value);
+        }
+
+        return inputs;
+    }
+
+
+    // Values for packing to 8 bits: each byte's exact value, the ties halfway between neighbors and the
+    // floats either side, out of range values and NaN, then ordinary values.
+    std::vector<float> MakePackInputs(std::mt19937& rng)
+    {
+        std::vector<float> inputs;
+
+        for (uint32_t k = 0; k < 256; k++)
+        {
+            const float tie = (float(k) + 0.5f) / 255.f;
+
+            inputs.push_back(float(k) / 255.f);
+            inputs.push_back(tie);
+            inputs.push_back(std::nextafter(tie, 0.f));
+            inputs.push_back(std::nextafter(tie, 1.f));
+        }
+
+        const float special[] =
+        {
+            0.f, -0.f, 1.f, -1.f, 2.f, FLT_MIN, FLT_MAX, -FLT_MAX,
+            std::numeric_limits<float>::infinity(),
+            -std::numeric_limits<float>::infinity(),
+            std::numeric_limits<float>::quiet_NaN(),
+        };
+
+        inputs.insert(inputs.end(), std::begin(special), std::end(special));
+
+        std::uniform_real_distribution<float> value(-0.25f, 1.25f);
+
+        for (size_t i = 0; i < 10000; i++)
+        {
+            inputs.push_back(value(rng));
+        }
+
+        return inputs;
+    }
+
+
+    // Colors from a list of channel values, each channel starting at a different place in the list so
+    // that all of them see every value.
+    std::vector<float> MakeColors(std::vector<float> const& values, std::vector<float> const& alphas)
+    {
+        const size_t count = values.size();
+
+        std::vector<float> colors(count * 4);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            colors[i * 4] = values[i];
+            colors[i * 4 + 1] = values[(i + count / 3) % count];
+            colors[i * 4 + 2] = values[(i + 2 * count / 3) % count];
+            colors[i * 4 + 3] = alphas[i % alphas.size()];
+        }
+
+        return colors;
+    }
+
+
+    // Every byte in every channel, then random colors.
+    std::vector<uint32_t> MakePackedInputs(std::mt19937& rng)
+    {
+        std::vector<uint32_t> inputs;
+
+        for (uint32_t k = 0; k < 256; k++)
+        {
+            inputs.push_back(k * 0x01010101u);
+            inputs.push_back((k * 0x00010101u) | ((255u - k) << 24));
+            inputs.push_back(k | ((255u - k) << 8) | (((k * 7u) & 0xFFu) << 16) | (((k * 13u) & 0xFFu) << 24));
+        }
+
+        for (size_t i = 0; i < 10000; i++)
+        {
+            inputs.push_back(static_cast<uint32_t>(rng()));
+        }
+
+        return inputs;
+    }
+
+
+    // Running a kernel on a short piece of the input from a few starting points must give the same
+    // values as the long run, and write nothing past the end.
+    template<typename TKernel>
+    bool CheckColorTails(char const* name, TKernel&& kernel, std::vector<float> const& source, std::vector<float> const& expected)
+    {
+        for (const size_t count : ColorCounts)
+        {
+            for (const size_t start : { size_t(0), size_t(1), size_t(3) })
+            {
+                if ((start + count) * 4 > source.size())
+                    continue;
+
+                std::vector<float> result(count * 4 + 4, GuardChannel);
+                kernel(source.data() + start * 4, count, result.data());
+
+                if (memcmp(result.data(), expected.data() + start * 4, count * 4 * sizeof(float)) != 0)
+                {
+                    printf("ERROR: %s: %zu colors from %zu differ from the same colors in a longer array\n", name, count, start);
+                    return false;
+                }
+
+                for (size_t i = count * 4; i < result.size(); i++)
+                {
+                    if (FloatBits(result[i]) != FloatBits(GuardChannel))
+                    {
+                        printf("ERROR: %s: %zu colors from %zu wrote past the end\n", name, count, start);
+                        return false;
+                    }
+                }
+
+                // In place.
+                std::vector<float> inPlace(source.data() + start * 4, source.data() + (start + count) * 4);
+                kernel(inPlace.data(), count, inPlace.data());
+
+                if (count > 0 && memcmp(inPlace.data(), result.data(), count * 4 * sizeof(float)) != 0)
+                {
+                    printf("ERROR: %s: %zu colors converted in place differ\n", name, count);
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+}
+
+
+TEST_CASE(ColorArraysMatchScalarColor)
+{
+    // Through the public functions, on whichever kernels this CPU gets.
+    std::mt19937 rng(25);
+
+    const auto curveInputs = MakeCurveInputs();
+    const auto colors = MakeColors(curveInputs, { 1.f, 0.5f, 0.f });
+
+    const size_t count = colors.size() / 4;
+    auto const* source = reinterpret_cast<Color const*>(colors.data());
+
+    std::vector<Color> linear(count);
+    Color::SRGBToLinear(source, count, linear.data());
+
+    std::vector<Color> srgb(count);
+    Color::LinearToSRGB(source, count, srgb.data());
+
+    for (size_t i = 0; i < count; i++)
+    {
+        XMFLOAT4 expectedLinear;
+        XMStoreFloat4(&expectedLinear, XMColorSRGBToRGB(XMLoadFloat4(&source[i])));
+
+        XMFLOAT4 expectedSRGB;
+        XMStoreFloat4(&expectedSRGB, XMColorRGBToSRGB(XMLoadFloat4(&source[i])));
+
+        if (memcmp(&linear[i], &expectedLinear, sizeof(XMFLOAT4)) != 0 || memcmp(&srgb[i], &expectedSRGB, sizeof(XMFLOAT4)) != 0)
+        {
+            printf("ERROR: color %zu (%.9g, %.9g, %.9g): SRGBToLinear or LinearToSRGB differs from XMColorSRGBToRGB or XMColorRGBToSRGB\n",
+                i, double(source[i].x), double(source[i].y), double(source[i].z));
+            return false;
+        }
+    }
+
+    const auto packInputs = MakePackInputs(rng);
+    const auto packColors = MakeColors(packInputs, { 1.f, 0.25f, 0.f, 2.f, -1.f });
+
+    const size_t packCount = packColors.size() / 4;
+    auto const* packSource = reinterpret_cast<Color const*>(packColors.data());
+
+    std::vector<XMUBYTEN4> rgba(packCount);
+    Color::Pack(packSource, packCount, rgba.data());
+
+    std::vector<XMCOLOR> bgra(packCount);
+    Color::Pack(packSource, packCount, bgra.data());
+
+    std::vector<XMCOLOR> swizzled(packCount);
+    Color::Swizzle(rgba.data(), packCount, swizzled.data());
+
+    std::vector<Color> unpacked(packCount);
+    Color::Unpack(rgba.data(), packCount, unpacked.data());
+
+    for (size_t i = 0; i < packCount; i++)
+    {
+        const XMUBYTEN4 expectedRGBA = packSource[i].RGBA();
+        const XMCOLOR expectedBGRA = packSource[i].BGRA();
+        const Color expectedColor(expectedRGBA);
+
+        if (rgba[i].v != expectedRGBA.v || bgra[i].c != expectedBGRA.c)
+        {
+            printf("ERROR: color %zu: Pack gave 0x%08X and 0x%08X, RGBA() and BGRA() give 0x%08X and 0x%08X\n",
+                i, rgba[i].v, bgra[i].c, expectedRGBA.v, expectedBGRA.c);
+            return false;
+        }
+
+        CHECK(swizzled[i].c == expectedBGRA.c);
+        CHECK(memcmp(&unpacked[i], &expectedColor, sizeof(Color)) == 0);
+    }
+
+    return true;
+}
+
+
+TEST_CASE(ColorKernelsFastSRGBWithinBound)
+{
+    const auto curveInputs = MakeCurveInputs();
+
+    // The alphas, including NaN, must come through bit for bit.
+    const auto colors = MakeColors(curveInputs, { 1.f, 0.f, 0.3f, -2.f, 5.f, std::numeric_limits<float>::quiet_NaN() });
+    const size_t count = colors.size() / 4;
+
+    std::vector<float> exactLinear(colors.size());
+    std::vector<float> exactSRGB(colors.size());
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const XMVECTOR c = XMLoadFloat4(reinterpret_cast<XMFLOAT4 const*>(colors.data() + i * 4));
+
+        XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(exactLinear.data() + i * 4), XMColorSRGBToRGB(c));
+        XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(exactSRGB.data() + i * 4), XMColorRGBToSRGB(c));
+    }
+
+    for (const SimdLevel level : GetTestedSimdLevels())
+    {
+        auto const& kernels = ColorKernels::GetColorKernels(level);
+        char const* name = GetSimdLevelName(level);
+
+        struct Curve
+        {
+            char const* name;
+            ColorKernels::ColorKernel kernel;
+            std::vector<float> const& exact;
+        };
+
+        const Curve curves[] =
+        {
+            { "srgbToLinearFast", kernels.srgbToLinearFast, exactLinear },
+            { "linearToSRGBFast", kernels.linearToSRGBFast, exactSRGB },
+        };
+
+        for (auto const& curve : curves)
+        {
+            std::vector<float> fast(colors.size() + 4, GuardChannel);
+            curve.kernel(colors.data(), count, fast.data());
+
+            for (size_t i = 0; i < colors.size(); i++)
+            {
+                if ((i % 4) == 3)
+                {
+                    CHECK(FloatBits(fast[i]) == FloatBits(colors[i]));
+                    continue;
+                }
+
+                const float error = std::fabs(fast[i] - curve.exact[i]);
+
+                if (!(error <= FastSRGBTolerance))
+                {
+                    printf("ERROR: %s %s(%.9g) gave %.9g, the exact conversion %.9g, an error of %g\n",
+                        name, curve.name, double(colors[i]), double(fast[i]), double(curve.exact[i]), double(error));
+                    return false;
+                }
+            }
+
+            CHECK(FloatBits(fast[colors.size()]) == FloatBits(GuardChannel));
+
+            char label[64];
+            snprintf(label, sizeof(label), "%s %s", name, curve.name);
+
+            if (!CheckColorTails(label, curve.kernel, colors, fast))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+
+TEST_CASE(ColorKernelsPackMatchPackedVector)
+{
+    std::mt19937 rng(26);
+
+    const auto packInputs = MakePackInputs(rng);
+    const auto colors = MakeColors(packInputs, packInputs);
+    const size_t count = colors.size() / 4;
+
+    std::vector<uint32_t> expectedRGBA(count);
+    std::vector<uint32_t> expectedBGRA(count);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const XMVECTOR c = XMLoadFloat4(reinterpret_cast<XMFLOAT4 const*>(colors.data() + i * 4));
+
+        XMUBYTEN4 rgba;
+        XMStoreUByteN4(&rgba, c);
+        expectedRGBA[i] = rgba.v;
+
+        XMCOLOR bgra;
+        XMStoreColor(&bgra, c);
+        expectedBGRA[i] = bgra.c;
+    }
+
+    const auto packed = MakePackedInputs(rng);
+
+    std::vector<float> expectedFromRGBA(packed.size() * 4);
+    std::vector<float> expectedFromBGRA(packed.size() * 4);
+
+    for (size_t i = 0; i < packed.size(); i++)
+    {
+        const XMUBYTEN4 rgba(packed[i]);
+        XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(expectedFromRGBA.data() + i * 4), XMLoadUByteN4(&rgba));
+
+        const XMCOLOR bgra(packed[i]);
+        XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(expectedFromBGRA.data() + i * 4), XMLoadColor(&bgra));
+    }
+
+    for (const SimdLevel level : GetTestedSimdLevels())
+    {
+        auto const& kernels = ColorKernels::GetColorKernels(level);
+        char const* name = GetSimdLevelName(level);
+
+        struct Pack
+        {
+            char const* name;
+            ColorKernels::PackKernel kernel;
+            std::vector<uint32_t> const& expected;
+        };
+
+        const Pack packs[] =
+        {
+            { "packRGBA", kernels.packRGBA, expectedRGBA },
+            { "packBGRA", kernels.packBGRA, expectedBGRA },
+        };
+
+        for (auto const& pack : packs)
+        {
+            std::vector<uint32_t> result(count + 1, GuardPacked);
+            pack.kernel(colors.data(), count, result.data());
+
+            for (size_t i = 0; i < count; i++)
+            {
+                if (result[i] != pack.expected[i])
+                {
+                    auto const* c = colors.data() + i * 4;
+
+                    printf("ERROR: %s %s(%.9g, %.9g, %.9g, %.9g) gave 0x%08X, DirectXMath 0x%08X\n",
+                        name, pack.name, double(c[0]), double(c[1]), double(c[2]), double(c[3]), result[i], pack.expected[i]);
+                    return false;
+                }
+            }
+
+            CHECK(result[count] == GuardPacked);
+
+            for (const size_t shortCount : ColorCounts)
+            {
+                for (const size_t start : { size_t(0), size_t(1), size_t(3) })
+                {
+                    std::vector<uint32_t> shortResult(shortCount + 1, GuardPacked);
+                    pack.kernel(colors.data() + start * 4, shortCount, shortResult.data());
+
+                    CHECK(memcmp(shortResult.data(), result.data() + start, shortCount * sizeof(uint32_t)) == 0);
+                    CHECK(shortResult[shortCount] == GuardPacked);
+                }
+            }
+        }
+
+        struct Unpack
+        {
+            char const* name;
+            ColorKernels::UnpackKernel kernel;
+            std::vector<float> const& expected;
+        };
+
+        const Unpack unpacks[] =
+        {
+            { "unpackRGBA", kernels.unpackRGBA, expectedFromRGBA },
+            { "unpackBGRA", kernels.unpackBGRA, expectedFromBGRA },
+        };
+
+        for (auto const& unpack : unpacks)
+        {
+            std::vector<float> result(packed.size() * 4 + 4, GuardChannel);
+            unpack.kernel(packed.data(), packed.size(), result.data());
+
+            for (size_t i = 0; i < packed.size() * 4; i++)
+            {
+                if (FloatBits(result[i]) != FloatBits(unpack.expected[i]))
+                {
+                    printf("ERROR: %s %s(0x%08X) channel %zu gave %.9g, DirectXMath %.9g\n",
+                        name, unpack.name, packed[i / 4], i % 4, double(result[i]), double(unpack.expected[i]));
+                    return false;
+                }
+            }
+
+            CHECK(FloatBits(result[packed.size() * 4]) == FloatBits(GuardChannel));
+
+            for (const size_t shortCount : ColorCounts)
+            {
+                for (const size_t start : { size_t(0), size_t(1), size_t(3) })
+                {
+                    std::vector<float> shortResult(shortCount * 4 + 4, GuardChannel);
+                    unpack.kernel(packed.data() + start, shortCount, shortResult.data());
+
+                    CHECK(memcmp(shortResult.data(), result.data() + start * 4, shortCount * 4 * sizeof(float)) == 0);
+                    CHECK(FloatBits(shortResult[shortCount * 4]) == FloatBits(GuardChannel));
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+
+TEST_CASE(ColorKernelsRoundTrip)
+{
+    std::mt19937 rng(27);
+
+    const auto packed = MakePackedInputs(rng);
+    const size_t count = packed.size();
+
+    for (const SimdLevel level : GetTestedSimdLevels())
+    {
+        auto const& kernels = ColorKernels::GetColorKernels(level);
+        char const* name = GetSimdLevelName(level);
+
+        // Unpacking then packing any 8-bit color gives it back, in either layout.
+        std::vector<float> colors(count * 4);
+        std::vector<uint32_t> back(count);
+
+        kernels.unpackRGBA(packed.data(), count, colors.data());
+        kernels.packRGBA(colors.data(), count, back.data());
+
+        for (size_t i = 0; i < count; i++)
+        {
+            if (back[i] != packed[i])
+            {
+                printf("ERROR: %s RGBA 0x%08X came back as 0x%08X\n", name, packed[i], back[i]);
+                return false;
+            }
+        }
+
+        kernels.unpackBGRA(packed.data(), count, colors.data());
+        kernels.packBGRA(colors.data(), count, back.data());
+
+        for (size_t i = 0; i < count; i++)
+        {
+            if (back[i] != packed[i])
+            {
+                printf("ERROR: %s BGRA 0x%08X came back as 0x%08X\n", name, packed[i], back[i]);
+                return false;
+            }
+        }
+
+        // Swapping red and blue gives the XMCOLOR of the same color as an XMUBYTEN4, and back again.
+        std::vector<uint32_t> swapped(count + 1, GuardPacked);
+        kernels.swapRedBlue(packed.data(), count, swapped.data());
+
+        CHECK(swapped[count] == GuardPacked);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            const XMUBYTEN4 rgba(packed[i]);
+
+            XMCOLOR expected;
+            XMStoreColor(&expected, XMLoadUByteN4(&rgba));
+
+            if (swapped[i] != expected.c)
+            {
+                printf("ERROR: %s swapRedBlue(0x%08X) gave 0x%08X, XMStoreColor(XMLoadUByteN4) 0x%08X\n", name, packed[i], swapped[i], expected.c);
+                return false;
+            }
+        }
+
+        for (const size_t shortCount : ColorCounts)
+        {
+            for (const size_t start : { size_t(0), size_t(1), size_t(3) })
+            {
+                std::vector<uint32_t> shortResult(shortCount + 1, GuardPacked);
+                kernels.swapRedBlue(packed.data() + start, shortCount, shortResult.data());
+
+                CHECK(memcmp(shortResult.data(), swapped.data() + start, shortCount * sizeof(uint32_t)) == 0);
+                CHECK(shortResult[shortCount] == GuardPacked);
+            }
+        }
+
+        // In place, swapping back.
+        kernels.swapRedBlue(swapped.data(), count, swapped.data());
+        CHECK(memcmp(swapped.data(), packed.data(), count * sizeof(uint32_t)) == 0);
+    }
+
+    return true;
+}
@@ -0,0 +1,383 @@
+//--------------------------------------------------------------------------------------
+// File: DeviceTest.cpp
+//
+// Direct3D helpers for the tests that drive SpriteBatch and friends on a WARP device.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "DeviceTest.h"
+
+#include <d3dcompiler.h>
+
+#include <cstdarg>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+
+#include "BufferHelpers.h"
+#include "PlatformHelpers.h"
+
+using namespace DirectX;
+using namespace DirectX::Tests;
+using Microsoft::WRL::ComPtr;
+
+namespace
+{
+    // Passes the sprite vertex straight through, so stream output sees the CPU-generated data.
+    const char s_passThroughShader[] =
+        "struct Vertex\n"
+        "{\n"
+        "    float3 position : SV_Position;\n"
+        "    float4 color : COLOR;\n"
+        "    float2 textureCoordinate : TEXCOORD0;\n"
+        "};\n"
+        "\n"
+        "struct Output\n"
+        "{\n"
+        "    float3 position : POSITION;\n"
+        "    float4 color : COLOR;\n"
+        "    float2 textureCoordinate : TEXCOORD0;\n"
+        "};\n"
+        "\n"
+        "Output main(Vertex vertex)\n"
+        "{\n"
+        "    Output output;\n"
+        "    output.position = vertex.position;\n"
+        "    output.color = vertex.color;\n"
+        "    output.textureCoordinate = vertex.textureCoordinate;\n"
+        "    return output;\n"
+        "}\n";
+
+    const D3D11_SO_DECLARATION_ENTRY s_streamOutputDeclaration[] =
+    {
+        { 0, "POSITION", 0, 0, 3, 0 },
+        { 0, "COLOR", 0, 0, 4, 0 },
+        { 0, "TEXCOORD", 0, 0, 2, 0 },
+    };
+
+    static_assert(sizeof(VertexPositionColorTexture) == 9 * sizeof(float), "Stream output layout must match the sprite vertex");
+}
+
+
+bool DirectX::Tests::CreateTestDevice(TestDevice& result)
+{
+    static const D3D_FEATURE_LEVEL featureLevels[] =
+    {
+        D3D_FEATURE_LEVEL_11_1,
+        D3D_FEATURE_LEVEL_11_0,
+    };
+
+    const HRESULT hr = D3D11CreateDevice(
+        nullptr,
+        D3D_DRIVER_TYPE_WARP,
+        nullptr,
+        0,
+        featureLevels,
+        static_cast<UINT>(std::size(featureLevels)),
+        D3D11_SDK_VERSION,
+        result.device.ReleaseAndGetAddressOf(),
+        nullptr,
+        result.context.ReleaseAndGetAddressOf());
+
+    if (FAILED(hr))
+    {
+        printf("ERROR: failed to create a WARP device (%08X)\n", static_cast<unsigned int>(hr));
+        return false;
+    }
+
+    return true;
+}
+
+
+void DirectX::Tests::SetTestViewport(ID3D11DeviceContext* context, UINT width, UINT height)
+{
+    const D3D11_VIEWPORT viewport = { 0.f, 0.f, float(width), float(height), 0.f, 1.f };
+
+    context->RSSetViewports(1, &viewport);
+}
+
+
+ComPtr<ID3D11ShaderResourceView> DirectX::Tests::CreateTestTexture(ID3D11Device* device, UINT width, UINT height, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+
+    std::vector<uint32_t> pixels(size_t(width) * height);
+
+    for (auto& pixel : pixels)
+    {
+        pixel = rng() | 0xff000000u;
+    }
+
+    D3D11_SUBRESOURCE_DATA initData = {};
+    initData.pSysMem = pixels.data();
+    initData.SysMemPitch = width * sizeof(uint32_t);
+
+    ComPtr<ID3D11ShaderResourceView> textureView;
+
+    ThrowIfFailed(CreateTextureFromMemory(device, width, height, DXGI_FORMAT_R8G8B8A8_UNORM, initData, nullptr, textureView.GetAddressOf()));
+
+    return textureView;
+}
+
+
+void DirectX::Tests::WaitForGpu(ID3D11Device* device, ID3D11DeviceContext* context)
+{
+    const D3D11_QUERY_DESC queryDesc = { D3D11_QUERY_EVENT, 0 };
+
+    ComPtr<ID3D11Query> query;
+
+    ThrowIfFailed(device->CreateQuery(&queryDesc, query.GetAddressOf()));
+
+    context->End(query.Get());
+
+    BOOL done = FALSE;
+
+    while (context->GetData(query.Get(), &done, sizeof(done), 0) == S_FALSE)
+    {
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+// VertexCapture
+//--------------------------------------------------------------------------------------
+
+VertexCapture::VertexCapture(ID3D11Device* device, size_t maxVertices) :
+    mMaxVertices(maxVertices),
+    mAppend(false)
+{
+    ComPtr<ID3DBlob> code;
+    ComPtr<ID3DBlob> errors;
+
+    const HRESULT hr = D3DCompile(s_passThroughShader, sizeof(s_passThroughShader) - 1, "PassThrough", nullptr, nullptr,
+        "main", "vs_4_0", D3DCOMPILE_OPTIMIZATION_LEVEL3, 0, code.GetAddressOf(), errors.GetAddressOf());
+
+    if (FAILED(hr))
+    {
+        if (errors)
+        {
+            printf("ERROR: %s\n", static_cast<const char*>(errors->GetBufferPointer()));
+        }
+
+        throw com_exception(hr);
+    }
+
+    ThrowIfFailed(device->CreateVertexShader(code->GetBufferPointer(), code->GetBufferSize(), nullptr, mVertexShader.GetAddressOf()));
+
+    ThrowIfFailed(device->CreateInputLayout(VertexPositionColorTexture::InputElements, VertexPositionColorTexture::InputElementCount,
+        code->GetBufferPointer(), code->GetBufferSize(), mInputLayout.GetAddressOf()));
+
+    constexpr UINT stride = sizeof(VertexPositionColorTexture);
+
+    ThrowIfFailed(device->CreateGeometryShaderWithStreamOutput(code->GetBufferPointer(), code->GetBufferSize(),
+        s_streamOutputDeclaration, static_cast<UINT>(std::size(s_streamOutputDeclaration)),
+        &stride, 1, D3D11_SO_NO_RASTERIZED_STREAM, nullptr, mGeometryShader.GetAddressOf()));
+
+    D3D11_BUFFER_DESC desc = {};
+    desc.ByteWidth = static_cast<UINT>(maxVertices * sizeof(VertexPositionColorTexture));
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.BindFlags = D3D11_BIND_STREAM_OUTPUT;
+
+    ThrowIfFailed(device->CreateBuffer(&desc, nullptr, mBuffer.GetAddressOf()));
+
+    desc.Usage = D3D11_USAGE_STAGING;
+    desc.BindFlags = 0;
+    desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+
+    ThrowIfFailed(device->CreateBuffer(&desc, nullptr, mStagingBuffer.GetAddressOf()));
+
+    const D3D11_QUERY_DESC queryDesc = { D3D11_QUERY_SO_STATISTICS, 0 };
+
+    ThrowIfFailed(device->CreateQuery(&queryDesc, mQuery.GetAddressOf()));
+}
+
+
+std::function<void()> VertexCapture::Begin(ID3D11DeviceContext* context)
+{
+    mAppend = false;
+
+    context->Begin(mQuery.Get());
+
+    return [this, context]()
+        {
+            // The first batch writes from the start of the buffer, later ones append.
+            ID3D11Buffer* buffer = mBuffer.Get();
+            const UINT offset = mAppend ? UINT(-1) : 0;
+
+            context->VSSetShader(mVertexShader.Get(), nullptr, 0);
+            context->GSSetShader(mGeometryShader.Get(), nullptr, 0);
+            context->SOSetTargets(1, &buffer, &offset);
+
+            mAppend = true;
+        };
+}
+
+
+std::vector<VertexPositionColorTexture> VertexCapture::End(ID3D11DeviceContext* context)
+{
+    context->End(mQuery.Get());
+
+    context->SOSetTargets(0, nullptr, nullptr);
+    context->GSSetShader(nullptr, nullptr, 0);
+
+    D3D11_QUERY_DATA_SO_STATISTICS statistics = {};
+
+    while (context->GetData(mQuery.Get(), &statistics, sizeof(statistics), 0) == S_FALSE)
+    {
+    }
+
+    if (statistics.PrimitivesStorageNeeded > statistics.NumPrimitivesWritten)
+        throw std::runtime_error("VertexCapture buffer is too small");
+
+    const size_t vertexCount = static_cast<size_t>(statistics.NumPrimitivesWritten) * 3;
+
+    std::vector<VertexPositionColorTexture> vertices(vertexCount);
+
+    if (vertexCount)
+    {
+        context->CopyResource(mStagingBuffer.Get(), mBuffer.Get());
+
+        D3D11_MAPPED_SUBRESOURCE mapped = {};
+
+        ThrowIfFailed(context->Map(mStagingBuffer.Get(), 0, D3D11_MAP_READ, 0, &mapped));
+
+        memcpy(vertices.data(), mapped.pData, vertexCount * sizeof(VertexPositionColorTexture));
+
+        context->Unmap(mStagingBuffer.Get(), 0);
+    }
+
+    return vertices;
+}
+
+
+//--------------------------------------------------------------------------------------
+// TestRenderTarget
+//--------------------------------------------------------------------------------------
+
+TestRenderTarget::TestRenderTarget(ID3D11Device* device, UINT width, UINT height) :
+    mWidth(width),
+    mHeight(height)
+{
+    D3D11_TEXTURE2D_DESC desc = {};
+    desc.Width = width;
+    desc.Height = height;
+    desc.MipLevels = 1;
+    desc.ArraySize = 1;
+    desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    desc.SampleDesc.Count = 1;
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.BindFlags = D3D11_BIND_RENDER_TARGET;
+
+    ThrowIfFailed(device->CreateTexture2D(&desc, nullptr, mTexture.GetAddressOf()));
+    ThrowIfFailed(device->CreateRenderTargetView(mTexture.Get(), nullptr, mRenderTargetView.GetAddressOf()));
+
+    desc.Usage = D3D11_USAGE_STAGING;
+    desc.BindFlags = 0;
+    desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+
+    ThrowIfFailed(device->CreateTexture2D(&desc, nullptr, mStagingTexture.GetAddressOf()));
+}
+
+
+void TestRenderTarget::Begin(ID3D11DeviceContext* context)
+{
+    static const float clearColor[4] = { 0.f, 0.f, 0.f, 0.f };
+
+    context->ClearRenderTargetView(mRenderTargetView.Get(), clearColor);
+
+    ID3D11RenderTargetView* renderTargetView = mRenderTargetView.Get();
+
+    context->OMSetRenderTargets(1, &renderTargetView, nullptr);
+
+    SetTestViewport(context, mWidth, mHeight);
+}
+
+
+std::vector<uint32_t> TestRenderTarget::Read(ID3D11DeviceContext* context)
+{
+    context->CopyResource(mStagingTexture.Get(), mTexture.Get());
+
+    D3D11_MAPPED_SUBRESOURCE mapped = {};
+
+    ThrowIfFailed(context->Map(mStagingTexture.Get(), 0, D3D11_MAP_READ, 0, &mapped));
+
+    std::vector<uint32_t> pixels(size_t(mWidth) * mHeight);
+
+    for (UINT y = 0; y < mHeight; y++)
+    {
+        memcpy(&pixels[size_t(y) * mWidth], static_cast<const uint8_t*>(mapped.pData) + size_t(y) * mapped.RowPitch, mWidth * sizeof(uint32_t));
+    }
+
+    context->Unmap(mStagingTexture.Get(), 0);
+
+    return pixels;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Comparisons
+//--------------------------------------------------------------------------------------
+
+bool DirectX::Tests::CompareVertices(
+    std::vector<VertexPositionColorTexture> const& expected,
+    std::vector<VertexPositionColorTexture> const& actual,
+    const char* context)
+{
+    if (expected.size() != actual.size())
+    {
+        printf("ERROR: %s: expected %zu vertices, got %zu\n", context, expected.size(), actual.size());
+        return false;
+    }
+
+    for (size_t i = 0; i < expected.size(); i++)
+    {
+        if (memcmp(&expected[i], &actual[i], sizeof(VertexPositionColorTexture)) != 0)
+        {
+            auto const& e = expected[i];
+            auto const& a = actual[i];
+
+            printf("ERROR: %s: vertex %zu (sprite %zu) differs\n"
+                "  expected pos (%.9g, %.9g, %.9g) color (%.9g, %.9g, %.9g, %.9g) uv (%.9g, %.9g)\n"
+                "  actual   pos (%.9g, %.9g, %.9g) color (%.9g, %.9g, %.9g, %.9g) uv (%.9g, %.9g)\n",
+                context, i, i / 6,
+                e.position.x, e.position.y, e.position.z, e.color.x, e.color.y, e.color.z, e.color.w, e.textureCoordinate.x, e.textureCoordinate.y,
+                a.position.x, a.position.y, a.position.z, a.color.x, a.color.y, a.color.z, a.color.w, a.textureCoordinate.x, a.textureCoordinate.y);
+
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+size_t DirectX::Tests::CountDifferentPixels(std::vector<uint32_t> const& expected, std::vector<uint32_t> const& actual, int tolerance)
+{
+    if (expected.size() != actual.size())
+        return std::max(expected.size(), actual.size());
+
+    size_t count = 0;
+
+    for (size_t i = 0; i < expected.size(); i++)
+    {
+        for (unsigned shift = 0; shift < 32; shift += 8)
+        {
+            const int e = int((expected[i] >> shift) & 0xff);
+            const int a = int((actual[i] >> shift) & 0xff);
+
+            if (abs(e - a) > tolerance)
+            {
+                count++;
+                break;
+            }
+        }
+    }
+
+    return count;
+}
@@ -0,0 +1,121 @@
+//--------------------------------------------------------------------------------------
+// File: DeviceTest.h
+//
+// Direct3D helpers for the tests that drive SpriteBatch and friends on a WARP device.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "TestHarness.h"
+
+#include <d3d11_1.h>
+#include <DirectXMath.h>
+#include <wrl/client.h>
+
+#include <functional>
+#include <vector>
+
+#include "VertexTypes.h"
+
+
+namespace DirectX
+{
+    namespace Tests
+    {
+        // The reference rasterizer's results do not depend on the GPU, so every test uses WARP.
+        struct TestDevice
+        {
+            Microsoft::WRL::ComPtr<ID3D11Device> device;
+            Microsoft::WRL::ComPtr<ID3D11DeviceContext> context;
+        };
+
+        bool CreateTestDevice(_Out_ TestDevice& result);
+
+        // Sets a full-target viewport, which SpriteBatch reads back to build its transform.
+        void SetTestViewport(_In_ ID3D11DeviceContext* context, UINT width, UINT height);
+
+        // Creates an RGBA texture filled with a pattern derived from seed.
+        Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> CreateTestTexture(_In_ ID3D11Device* device, UINT width, UINT height, uint32_t seed);
+
+        // Blocks until the device has finished all the work submitted so far.
+        void WaitForGpu(_In_ ID3D11Device* device, _In_ ID3D11DeviceContext* context);
+
+
+        // Captures the untransformed vertices that SpriteBatch or StaticSpriteBatch submit. The
+        // setCustomShaders callback swaps in a pass-through vertex shader whose output goes to a
+        // stream-output buffer, so the captured data is exactly what the CPU generated.
+        class VertexCapture
+        {
+        public:
+            VertexCapture(_In_ ID3D11Device* device, size_t maxVertices);
+
+            // Starts a capture, returning the callback to pass as setCustomShaders.
+            std::function<void()> Begin(_In_ ID3D11DeviceContext* context);
+
+            // Finishes the capture. Every sprite contributes six vertices, for its two triangles.
+            std::vector<VertexPositionColorTexture> End(_In_ ID3D11DeviceContext* context);
+
+            // Input layout for VertexPositionColorTexture, for callers that do not set their own, such as PrimitiveBatch.
+            ID3D11InputLayout* GetInputLayout() const noexcept { return mInputLayout.Get(); }
+
+        private:
+            Microsoft::WRL::ComPtr<ID3D11VertexShader> mVertexShader;
+            Microsoft::WRL::ComPtr<ID3D11GeometryShader> mGeometryShader;
+            Microsoft::WRL::ComPtr<ID3D11InputLayout> mInputLayout;
+            Microsoft::WRL::ComPtr<ID3D11Buffer> mBuffer;
+            Microsoft::WRL::ComPtr<ID3D11Buffer> mStagingBuffer;
+            Microsoft::WRL::ComPtr<ID3D11Query> mQuery;
+            size_t mMaxVertices;
+            bool mAppend;
+        };
+
+
+        // Render target whose pixels can be read back, for paths that custom shaders would disable.
+        class TestRenderTarget
+        {
+        public:
+            TestRenderTarget(_In_ ID3D11Device* device, UINT width, UINT height);
+
+            // Clears the target, then binds it along with a matching viewport.
+            void Begin(_In_ ID3D11DeviceContext* context);
+
+            std::vector<uint32_t> Read(_In_ ID3D11DeviceContext* context);
+
+        private:
+            Microsoft::WRL::ComPtr<ID3D11Texture2D> mTexture;
+            Microsoft::WRL::ComPtr<ID3D11Texture2D> mStagingTexture;
+            Microsoft::WRL::ComPtr<ID3D11RenderTargetView> mRenderTargetView;
+            UINT mWidth;
+            UINT mHeight;
+        };
+
+
+        // Compares vertices bit for bit, printing the first difference.
+        bool CompareVertices(std::vector<VertexPositionColorTexture> const& expected,
+            std::vector<VertexPositionColorTexture> const& actual,
+            _In_z_ const char* context);
+
+        // Counts the pixels that differ by more than tolerance in any channel.
+        size_t CountDifferentPixels(std::vector<uint32_t> const& expected,
+            std::vector<uint32_t> const& actual,
+            int tolerance = 0);
+    }
+}
+
+
+// Fails the current test if hr is a failure code.
+#define CHECK_HR(expression) \
+    do \
+    { \
+        const HRESULT hrCheck = (expression); \
+        if (FAILED(hrCheck)) \
+        { \
+            printf("ERROR: %s(%d): %s failed with %08X\n", __FILE__, __LINE__, #expression, static_cast<unsigned int>(hrCheck)); \
+            return false; \
+        } \
+    } while (false)
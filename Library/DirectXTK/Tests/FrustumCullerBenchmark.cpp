@@ -0,0 +1,188 @@
+//--------------------------------------------------------------------------------------
+// File: FrustumCullerBenchmark.cpp
+//
+// Times FrustumCuller on a million spheres and a million boxes, stored as arrays of
+// structures and as streams, on one thread and across the worker pool, against calling
+// BoundingFrustum::Contains for each volume.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHarness.h"
+
+#include "SimpleMath.h"
+
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+using namespace DirectX::SimpleMath;
+using namespace DirectX::Tests;
+
+namespace
+{
+    constexpr size_t VolumeCount = size_t(1) << 20;
+    constexpr size_t Iterations = 8;
+
+    // A 60 degree camera at the origin looking down +z, with volumes scattered all around it so
+    // that roughly one in ten ends up inside.
+    BoundingFrustum MakeBenchmarkFrustum()
+    {
+        return BoundingFrustum(XMMatrixPerspectiveFovLH(XM_PI / 3.f, 16.f / 9.f, 0.1f, 500.f));
+    }
+
+
+    struct Volumes
+    {
+        std::vector<BoundingSphere> spheres;
+        std::vector<BoundingBox> boxes;
+
+        std::vector<float> x, y, z;
+        std::vector<float> radii;
+        std::vector<float> extentX, extentY, extentZ;
+
+        Volumes() :
+            spheres(VolumeCount), boxes(VolumeCount),
+            x(VolumeCount), y(VolumeCount), z(VolumeCount),
+            radii(VolumeCount),
+            extentX(VolumeCount), extentY(VolumeCount), extentZ(VolumeCount)
+        {
+            std::mt19937 rng(19);
+            std::uniform_real_distribution<float> position(-500.f, 500.f);
+            std::uniform_real_distribution<float> size(0.5f, 10.f);
+
+            for (size_t i = 0; i < VolumeCount; i++)
+            {
+                x[i] = position(rng);
+                y[i] = position(rng);
+                z[i] = position(rng);
+                radii[i] = size(rng);
+                extentX[i] = size(rng);
+                extentY[i] = size(rng);
+                extentZ[i] = size(rng);
+
+                spheres[i] = BoundingSphere(XMFLOAT3(x[i], y[i], z[i]), radii[i]);
+                boxes[i] = BoundingBox(XMFLOAT3(x[i], y[i], z[i]), XMFLOAT3(extentX[i], extentY[i], extentZ[i]));
+            }
+        }
+    };
+
+
+    uint64_t CountVisible(std::vector<uint32_t> const& visible) noexcept
+    {
+        uint64_t count = 0;
+
+        for (uint32_t word : visible)
+        {
+            for (; word; word &= word - 1)
+            {
+                count++;
+            }
+        }
+
+        return count;
+    }
+
+
+    void PrintRow(char const* label, double contains, double aos, double soa, double aosParallel, double soaParallel)
+    {
+        printf("%-10s %12.3f %12.3f %12.3f %12.3f %12.3f\n", label,
+            contains / double(VolumeCount), aos / double(VolumeCount), soa / double(VolumeCount),
+            aosParallel / double(VolumeCount), soaParallel / double(VolumeCount));
+    }
+}
+
+
+BENCHMARK(FrustumCullerMillionVolumes)
+{
+    const BoundingFrustum frustum = MakeBenchmarkFrustum();
+    const FrustumCuller culler(frustum);
+
+    const Volumes volumes;
+
+    const ConstVector3Stream centers(volumes.x.data(), volumes.y.data(), volumes.z.data());
+    const ConstVector3Stream extents(volumes.extentX.data(), volumes.extentY.data(), volumes.extentZ.data());
+
+    std::vector<uint8_t> contained(VolumeCount);
+    std::vector<uint32_t> visible((VolumeCount + 31) / 32);
+
+    printf("%-10s %12s %12s %12s %12s %12s   (ns per volume, %zu volumes)\n",
+        "", "Contains", "Cull", "Cull stream", "Parallel", "Par. stream", VolumeCount);
+
+    {
+        const double contains = MeasureNanoseconds(Iterations, [&]()
+            {
+                for (size_t i = 0; i < VolumeCount; i++)
+                {
+                    contained[i] = static_cast<uint8_t>(frustum.Contains(volumes.spheres[i]) != DISJOINT);
+                }
+            });
+
+        KeepResult(contained[VolumeCount / 2]);
+
+        const double aos = MeasureNanoseconds(Iterations, [&]()
+            {
+                culler.Cull(volumes.spheres.data(), VolumeCount, visible.data());
+            });
+
+        const double soa = MeasureNanoseconds(Iterations, [&]()
+            {
+                culler.Cull(centers, volumes.radii.data(), VolumeCount, visible.data());
+            });
+
+        const double aosParallel = MeasureNanoseconds(Iterations, [&]()
+            {
+                culler.CullParallel(volumes.spheres.data(), VolumeCount, visible.data());
+            });
+
+        const double soaParallel = MeasureNanoseconds(Iterations, [&]()
+            {
+                culler.CullParallel(centers, volumes.radii.data(), VolumeCount, visible.data());
+            });
+
+        KeepResult(CountVisible(visible));
+
+        PrintRow("spheres", contains, aos, soa, aosParallel, soaParallel);
+    }
+
+    {
+        const double contains = MeasureNanoseconds(Iterations, [&]()
+            {
+                for (size_t i = 0; i < VolumeCount; i++)
+                {
+                    contained[i] = static_cast<uint8_t>(frustum.Contains(volumes.boxes[i]) != DISJOINT);
+                }
+            });
+
+        KeepResult(contained[VolumeCount / 2]);
+
+        const double aos = MeasureNanoseconds(Iterations, [&]()
+            {
+                culler.Cull(volumes.boxes.data(), VolumeCount, visible.data());
+            });
+
+        const double soa = MeasureNanoseconds(Iterations, [&]()
+            {
+                culler.Cull(centers, extents, VolumeCount, visible.data());
+            });
+
+        const double aosParallel = MeasureNanoseconds(Iterations, [&]()
+            {
+                culler.CullParallel(volumes.boxes.data(), VolumeCount, visible.data());
+            });
+
+        const double soaParallel = MeasureNanoseconds(Iterations, [&]()
+            {
+                culler.CullParallel(centers, extents, VolumeCount, visible.data());
+            });
+
+        KeepResult(CountVisible(visible));
+
+        PrintRow("boxes", contains, aos, soa, aosParallel, soaParallel);
+    }
+
+    return true;
+}
@@ -0,0 +1,410 @@
+//--------------------------------------------------------------------------------------
+// File: FrustumCullerTest.cpp
+//
+// Checks FrustumCuller against BoundingFrustum::Contains for spheres and boxes, through every
+// Cull and CullParallel overload and each instruction set's kernels, and checks that planes
+// taken from a view-projection matrix bound Direct3D's 0 to 1 depth range.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHarness.h"
+#include "SimdTestLevels.h"
+
+#include "SimpleMath.h"
+#include "VectorStream.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+using namespace DirectX::SimpleMath;
+using namespace DirectX::Tests;
+
+namespace
+{
+    // Written after the last word of every mask, to catch writes past the end.
+    constexpr uint32_t Guard = 0xDEADBEEF;
+
+
+    struct TestFrustum
+    {
+        char const* name;
+        BoundingFrustum frustum;    // In world space
+        Matrix viewProjection;
+
+        // Volumes closer than this to a plane may go either way. Planes taken from the matrix lose
+        // precision as the far plane moves out, so this grows with it.
+        float tolerance;
+    };
+
+
+    // A symmetric perspective frustum has the same shape whichever way the camera's z axis points,
+    // so the left-handed BoundingFrustum also bounds the right-handed view and projection.
+    TestFrustum MakeFrustum(char const* name, Vector3 const& eye, Vector3 const& target, Vector3 const& up, float fov, float aspect, float nearPlane, float farPlane, bool rhcoords)
+    {
+        const Matrix view = rhcoords ? Matrix::CreateLookAt(eye, target, up) : Matrix(XMMatrixLookAtLH(eye, target, up));
+        const Matrix projection = rhcoords ? Matrix::CreatePerspectiveFieldOfView(fov, aspect, nearPlane, farPlane) : Matrix(XMMatrixPerspectiveFovLH(fov, aspect, nearPlane, farPlane));
+
+        TestFrustum result = { name, BoundingFrustum(XMMatrixPerspectiveFovLH(fov, aspect, nearPlane, farPlane)), view * projection, farPlane * 1e-4f };
+
+        result.frustum.Transform(result.frustum, XMMatrixInverse(nullptr, XMMatrixLookAtLH(eye, target, up)));
+
+        return result;
+    }
+
+
+    std::vector<TestFrustum> MakeTestFrustums()
+    {
+        std::vector<TestFrustum> frustums;
+
+        frustums.push_back(MakeFrustum("left-handed", Vector3(10, 5, -30), Vector3(0, 0, 20), Vector3::Up, 1.f, 1.6f, 0.5f, 60.f, false));
+        frustums.push_back(MakeFrustum("right-handed", Vector3(-40, 20, 15), Vector3(5, -3, -20), Vector3::Up, 1.2f, 0.75f, 2.f, 200.f, true));
+        frustums.push_back(MakeFrustum("narrow", Vector3(0, 80, 0), Vector3(1, 0, 1), Vector3::UnitX, 0.2f, 1.f, 10.f, 150.f, true));
+
+        return frustums;
+    }
+
+
+    // Random volumes around the frustum's bounding box, sized relative to it.
+    void MakeVolumes(std::mt19937& rng, BoundingFrustum const& frustum, size_t count, std::vector<BoundingSphere>& spheres, std::vector<BoundingBox>& boxes)
+    {
+        XMFLOAT3 corners[BoundingFrustum::CORNER_COUNT];
+        frustum.GetCorners(corners);
+
+        BoundingBox bounds;
+        BoundingBox::CreateFromPoints(bounds, BoundingFrustum::CORNER_COUNT, corners, sizeof(XMFLOAT3));
+
+        const float size = std::max(bounds.Extents.x, std::max(bounds.Extents.y, bounds.Extents.z));
+
+        std::uniform_real_distribution<float> unit(-1.2f, 1.2f);
+        std::uniform_real_distribution<float> radius(0.f, size * 0.1f);
+
+        spheres.resize(count);
+        boxes.resize(count);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            const Vector3 center(
+                bounds.Center.x + unit(rng) * bounds.Extents.x,
+                bounds.Center.y + unit(rng) * bounds.Extents.y,
+                bounds.Center.z + unit(rng) * bounds.Extents.z);
+
+            spheres[i] = BoundingSphere(center, radius(rng));
+            boxes[i] = BoundingBox(center, Vector3(radius(rng), radius(rng), radius(rng)));
+        }
+    }
+
+
+    BoundingSphere Resize(BoundingSphere sphere, float delta) noexcept
+    {
+        sphere.Radius = std::max(sphere.Radius + delta, 0.f);
+        return sphere;
+    }
+
+    BoundingBox Resize(BoundingBox box, float delta) noexcept
+    {
+        box.Extents.x = std::max(box.Extents.x + delta, 0.f);
+        box.Extents.y = std::max(box.Extents.y + delta, 0.f);
+        box.Extents.z = std::max(box.Extents.z + delta, 0.f);
+        return box;
+    }
+
+
+    // How far the volume reaches in front of the plane, negative if it is entirely behind it.
+    double PlaneMargin(Plane const& plane, BoundingSphere const& sphere) noexcept
+    {
+        return double(plane.x) * sphere.Center.x + double(plane.y) * sphere.Center.y + double(plane.z) * sphere.Center.z + plane.w + sphere.Radius;
+    }
+
+    double PlaneMargin(Plane const& plane, BoundingBox const& box) noexcept
+    {
+        return double(plane.x) * box.Center.x + double(plane.y) * box.Center.y + double(plane.z) * box.Center.z + plane.w
+            + std::fabs(plane.x) * double(box.Extents.x) + std::fabs(plane.y) * double(box.Extents.y) + std::fabs(plane.z) * double(box.Extents.z);
+    }
+
+
+    std::vector<uint32_t> MakeMask(size_t count)
+    {
+        std::vector<uint32_t> mask((count + 31) / 32 + 1, 0xA5A5A5A5);
+        mask.back() = Guard;
+        return mask;
+    }
+
+
+    // Checks the contract for culling: every volume that Contains finds in the frustum is marked
+    // visible, no volume that is entirely behind one of the planes is, and unused bits are clear.
+    template<typename TVolume>
+    bool CheckMask(TestFrustum const& test, FrustumCuller const& culler, std::vector<TVolume> const& volumes, std::vector<uint32_t> const& mask, char const* description)
+    {
+        const size_t count = volumes.size();
+
+        if (mask.back() != Guard)
+        {
+            printf("ERROR: %s, %s, %zu volumes: wrote past the end of the mask\n", test.name, description, count);
+            return false;
+        }
+
+        for (size_t i = 0; i < count; i++)
+        {
+            const bool visible = (mask[i / 32] & (1u << (i % 32))) != 0;
+
+            if (!visible && test.frustum.Contains(Resize(volumes[i], -test.tolerance)) != DISJOINT)
+            {
+                printf("ERROR: %s, %s, %zu volumes: volume %zu is in the frustum but was culled\n", test.name, description, count, i);
+                return false;
+            }
+
+            if (visible)
+            {
+                const auto grown = Resize(volumes[i], test.tolerance);
+
+                for (size_t p = 0; p < 6; p++)
+                {
+                    if (PlaneMargin(culler.planes[p], grown) < 0)
+                    {
+                        printf("ERROR: %s, %s, %zu volumes: volume %zu is behind plane %zu but is visible\n", test.name, description, count, i, p);
+                        return false;
+                    }
+                }
+            }
+        }
+
+        if ((count % 32) != 0 && (mask[count / 32] >> (count % 32)) != 0)
+        {
+            printf("ERROR: %s, %s, %zu volumes: unused bits of the last word are set\n", test.name, description, count);
+            return false;
+        }
+
+        return true;
+    }
+
+
+    VectorStream::CullPlanes GetCullPlanes(FrustumCuller const& culler) noexcept
+    {
+        VectorStream::CullPlanes result;
+
+        for (size_t p = 0; p < 6; p++)
+        {
+            result.x[p] = culler.planes[p].x;
+            result.y[p] = culler.planes[p].y;
+            result.z[p] = culler.planes[p].z;
+            result.d[p] = culler.planes[p].w;
+            result.absX[p] = std::fabs(culler.planes[p].x);
+            result.absY[p] = std::fabs(culler.planes[p].y);
+            result.absZ[p] = std::fabs(culler.planes[p].z);
+        }
+
+        return result;
+    }
+
+
+    bool CheckCuller(TestFrustum const& test, FrustumCuller const& culler, std::mt19937& rng, char const* source)
+    {
+        // Tail lengths for each lane width, part-filled words, and enough for several parallel chunks.
+        for (const size_t count : { size_t(0), size_t(1), size_t(5), size_t(31), size_t(32), size_t(33), size_t(100), size_t(257), size_t(1000), size_t(100003) })
+        {
+            std::vector<BoundingSphere> spheres;
+            std::vector<BoundingBox> boxes;
+            MakeVolumes(rng, test.frustum, count, spheres, boxes);
+
+            std::vector<float> x(count), y(count), z(count), radii(count), ex(count), ey(count), ez(count);
+
+            for (size_t i = 0; i < count; i++)
+            {
+                x[i] = spheres[i].Center.x;
+                y[i] = spheres[i].Center.y;
+                z[i] = spheres[i].Center.z;
+                radii[i] = spheres[i].Radius;
+                ex[i] = boxes[i].Extents.x;
+                ey[i] = boxes[i].Extents.y;
+                ez[i] = boxes[i].Extents.z;
+            }
+
+            const ConstVector3Stream centers(x.data(), y.data(), z.data());
+            const ConstVector3Stream extents(ex.data(), ey.data(), ez.data());
+
+            char description[64];
+
+            // Each instruction set's kernels, which may disagree only within the tolerance.
+            for (const SimdLevel level : GetTestedSimdLevels())
+            {
+                auto const& kernels = VectorStream::GetStreamKernels(level);
+                const auto planes = GetCullPlanes(culler);
+
+                auto sphereMask = MakeMask(count);
+                kernels.cullSpheres(planes, { { x.data(), y.data(), z.data() } }, radii.data(), count, sphereMask.data());
+
+                auto boxMask = MakeMask(count);
+                kernels.cullBoxes(planes, { { x.data(), y.data(), z.data() } }, { { ex.data(), ey.data(), ez.data() } }, count, boxMask.data());
+
+                snprintf(description, sizeof(description), "%s, %s spheres", source, GetSimdLevelName(level));
+
+                if (!CheckMask(test, culler, spheres, sphereMask, description))
+                    return false;
+
+                snprintf(description, sizeof(description), "%s, %s boxes", source, GetSimdLevelName(level));
+
+                if (!CheckMask(test, culler, boxes, boxMask, description))
+                    return false;
+            }
+
+            // The public overloads all use the same kernels, so they agree exactly.
+            auto sphereMask = MakeMask(count);
+            culler.Cull(spheres.data(), count, sphereMask.data());
+
+            snprintf(description, sizeof(description), "%s, Cull spheres", source);
+
+            if (!CheckMask(test, culler, spheres, sphereMask, description))
+                return false;
+
+            auto boxMask = MakeMask(count);
+            culler.Cull(boxes.data(), count, boxMask.data());
+
+            snprintf(description, sizeof(description), "%s, Cull boxes", source);
+
+            if (!CheckMask(test, culler, boxes, boxMask, description))
+                return false;
+
+            auto mask = MakeMask(count);
+
+            culler.Cull(centers, radii.data(), count, mask.data());
+            CHECK(mask == sphereMask);
+
+            culler.CullParallel(spheres.data(), count, mask.data());
+            CHECK(mask == sphereMask);
+
+            culler.CullParallel(centers, radii.data(), count, mask.data());
+            CHECK(mask == sphereMask);
+
+            culler.Cull(centers, extents, count, mask.data());
+            CHECK(mask == boxMask);
+
+            culler.CullParallel(boxes.data(), count, mask.data());
+            CHECK(mask == boxMask);
+
+            culler.CullParallel(centers, extents, count, mask.data());
+            CHECK(mask == boxMask);
+        }
+
+        return true;
+    }
+}
+
+
+TEST_CASE(FrustumCullerMatchesBoundingFrustum)
+{
+    std::mt19937 rng(50);
+
+    for (auto const& test : MakeTestFrustums())
+    {
+        if (!CheckCuller(test, FrustumCuller(test.frustum), rng, "BoundingFrustum planes"))
+            return false;
+
+        if (!CheckCuller(test, FrustumCuller(test.viewProjection), rng, "matrix planes"))
+            return false;
+    }
+
+    return true;
+}
+
+
+TEST_CASE(FrustumCullerMatrixPlanesMatchBoundingFrustum)
+{
+    // The planes taken from the view-projection matrix, in whatever order, are the frustum's.
+    for (auto const& test : MakeTestFrustums())
+    {
+        const FrustumCuller fromFrustum(test.frustum);
+        const FrustumCuller fromMatrix(test.viewProjection);
+
+        for (auto const& plane : fromMatrix.planes)
+        {
+            bool found = false;
+
+            for (auto const& expected : fromFrustum.planes)
+            {
+                if ((plane.Normal() - expected.Normal()).Length() < 1e-4f && std::fabs(plane.w - expected.w) < test.tolerance)
+                {
+                    found = true;
+                }
+            }
+
+            if (!found)
+            {
+                printf("ERROR: %s: plane (%g, %g, %g, %g) from the matrix is not one of the frustum's\n", test.name, plane.x, plane.y, plane.z, plane.w);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+TEST_CASE(FrustumCullerMatrixNearAndFarPlanes)
+{
+    // Small volumes just either side of the near and far planes. Direct3D clips z to 0..1, so the
+    // near plane is where z is 0, not where z is -w as it would be for OpenGL.
+    constexpr float NearPlane = 1.f;
+    constexpr float FarPlane = 50.f;
+    constexpr float Size = 0.05f;
+
+    const Vector3 eye(3, 4, 5);
+    const Vector3 target(-2, 1, -7);
+
+    Vector3 forward = target - eye;
+    forward.Normalize();
+
+    struct Projection
+    {
+        char const* name;
+        Matrix view;
+        Matrix projection;
+    };
+
+    const Projection projections[] =
+    {
+        { "left-handed perspective", XMMatrixLookAtLH(eye, target, Vector3::Up), XMMatrixPerspectiveFovLH(1.f, 1.5f, NearPlane, FarPlane) },
+        { "right-handed perspective", Matrix::CreateLookAt(eye, target, Vector3::Up), Matrix::CreatePerspectiveFieldOfView(1.f, 1.5f, NearPlane, FarPlane) },
+        { "right-handed orthographic", Matrix::CreateLookAt(eye, target, Vector3::Up), Matrix::CreateOrthographic(10.f, 10.f, NearPlane, FarPlane) },
+    };
+
+    const float distances[] = { NearPlane + 2 * Size, NearPlane - 2 * Size, FarPlane - 2 * Size, FarPlane + 2 * Size };
+    const uint32_t expected = 0x5;
+
+    for (auto const& test : projections)
+    {
+        const FrustumCuller culler(test.view * test.projection);
+
+        BoundingSphere spheres[std::size(distances)];
+        BoundingBox boxes[std::size(distances)];
+
+        for (size_t i = 0; i < std::size(distances); i++)
+        {
+            const Vector3 center = eye + forward * distances[i];
+
+            spheres[i] = BoundingSphere(center, Size);
+            boxes[i] = BoundingBox(center, Vector3(Size, Size, Size));
+        }
+
+        uint32_t sphereMask = 0;
+        uint32_t boxMask = 0;
+
+        culler.Cull(spheres, std::size(spheres), &sphereMask);
+        culler.Cull(boxes, std::size(boxes), &boxMask);
+
+        if (sphereMask != expected || boxMask != expected)
+        {
+            printf("ERROR: %s: spheres 0x%X and boxes 0x%X visible, expected 0x%X\n", test.name, sphereMask, boxMask, expected);
+            return false;
+        }
+    }
+
+    return true;
+}
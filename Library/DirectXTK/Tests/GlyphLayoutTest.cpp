@@ -0,0 +1,878 @@
+//--------------------------------------------------------------------------------------
+// File: GlyphLayoutTest.cpp
+//
+// Checks that GlyphLayout places glyphs exactly as DrawString does, that it wraps, aligns and
+// truncates lines as documented, and that Update reuses lines without changing the result.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHarness.h"
+#include "TestFont.h"
+
+#include "GlyphLayout.h"
+
+#include <cmath>
+
+using namespace DirectX;
+using namespace DirectX::Tests;
+
+namespace
+{
+    using Font = TestFont<TestGlyph>;
+    using Layout = GlyphLayout<TestGlyph>;
+
+
+    std::vector<uint32_t> DecodeText(std::string const& text)
+    {
+        std::vector<uint32_t> result;
+
+        TextDecoder<char> decoder(text.c_str());
+
+        for (uint32_t c = decoder.Next(); c != 0; c = decoder.Next())
+        {
+            result.push_back(c);
+        }
+
+        return result;
+    }
+
+
+    float GlyphWidth(TestGlyph const* glyph) noexcept
+    {
+        return float(glyph->Subrect.right) - float(glyph->Subrect.left);
+    }
+
+
+    // Checks the line breaks of a wrapped layout against its text:
+    //  - nothing but whitespace and line feeds goes missing, and nothing is added;
+    //  - only whitespace, or the first visible character of a line, can extend past maxWidth;
+    //  - a line ends at a line feed, or where the next character would not have fitted;
+    //  - word wrapping only breaks inside a word if the word does not fit on a line by itself.
+    bool CheckWrapping(Layout const& layout, Font const& font, GlyphLayoutOptions const& options, char const* description)
+    {
+        auto const& text = layout.GetText();
+        auto const& lines = layout.GetLines();
+        auto const& glyphs = layout.GetGlyphs();
+
+        std::vector<TestGlyph const*> expectedGlyphs;
+
+        for (const auto c : text)
+        {
+            if (c != '\r' && c != '\n' && !IsWhitespaceCharacter(c))
+            {
+                expectedGlyphs.push_back(font.Find(c));
+            }
+        }
+
+        std::vector<TestGlyph const*> actualGlyphs;
+
+        for (auto const& placed : glyphs)
+        {
+            if (!IsWhitespaceCharacter(placed.glyph->Character))
+            {
+                actualGlyphs.push_back(placed.glyph);
+            }
+        }
+
+        if (actualGlyphs != expectedGlyphs)
+        {
+            printf("ERROR: %s: laid out %zu visible glyphs, expected %zu\n", description, actualGlyphs.size(), expectedGlyphs.size());
+            return false;
+        }
+
+        for (size_t i = 0; i < lines.size(); i++)
+        {
+            auto const& line = lines[i];
+
+            // Line offsets are zero for left alignment, so glyph positions are line positions.
+            bool hasContent = false;
+
+            for (size_t g = line.firstGlyph; g < line.firstGlyph + line.glyphCount; g++)
+            {
+                auto const& placed = glyphs[g];
+
+                if (placed.y != line.y)
+                {
+                    printf("ERROR: %s: glyph %zu of line %zu is at y = %g, not %g\n", description, g, i, placed.y, line.y);
+                    return false;
+                }
+
+                if (IsWhitespaceCharacter(placed.glyph->Character))
+                    continue;
+
+                if (hasContent && placed.x + GlyphWidth(placed.glyph) > options.maxWidth)
+                {
+                    printf("ERROR: %s: glyph %zu of line %zu ends at %g, past %g\n", description, g, i, placed.x + GlyphWidth(placed.glyph), options.maxWidth);
+                    return false;
+                }
+
+                hasContent = true;
+            }
+
+            if (i + 1 == lines.size())
+                break;
+
+            const size_t nextStart = lines[i + 1].firstCharacter;
+
+            if (text[nextStart - 1] == '\n')
+                continue;
+
+            // Broken by wrapping: the character before endCharacter is the one that did not fit. Laying
+            // out the line up to and including it, as DrawString would, must overflow.
+            if (line.endCharacter <= line.firstCharacter || line.endCharacter > text.size())
+            {
+                printf("ERROR: %s: line %zu covers characters %zu to %zu of %zu\n", description, i, line.firstCharacter, line.endCharacter, text.size());
+                return false;
+            }
+
+            std::string prefix;
+
+            for (size_t c = line.firstCharacter; c < line.endCharacter; c++)
+            {
+                AppendUtf8(prefix, text[c]);
+            }
+
+            float right = 0;
+
+            LayoutGlyphs(prefix.c_str(), font.GetLineSpacing(), true, font.Finder(),
+                [&](TestGlyph const* glyph, float x, float, float)
+                {
+                    right = x + GlyphWidth(glyph);
+                },
+                [](float) noexcept {});
+
+            if (!(right > options.maxWidth))
+            {
+                printf("ERROR: %s: line %zu was broken at character %zu, which fits (%g <= %g)\n", description, i, line.endCharacter - 1, right, options.maxWidth);
+                return false;
+            }
+
+            const uint32_t breakCharacter = text[line.endCharacter - 1];
+
+            if (IsWhitespaceCharacter(breakCharacter))
+            {
+                printf("ERROR: %s: line %zu was broken at whitespace\n", description, i);
+                return false;
+            }
+
+            if (options.wrapping == GlyphLayoutOptions::WrapWord)
+            {
+                // A break inside a word is only allowed if the line holds nothing but that word.
+                const bool atWordStart = IsWhitespaceCharacter(text[nextStart - 1]);
+
+                if (!atWordStart)
+                {
+                    for (size_t c = line.firstCharacter; c < nextStart; c++)
+                    {
+                        if (IsWhitespaceCharacter(text[c]) && c > line.firstCharacter && !IsWhitespaceCharacter(text[c - 1]))
+                        {
+                            printf("ERROR: %s: line %zu was broken inside a word, although it had whitespace at %zu\n", description, i, c);
+                            return false;
+                        }
+                    }
+                }
+            }
+        }
+
+        return true;
+    }
+}
+
+
+TEST_CASE(GlyphLayoutMatchesDrawString)
+{
+    Font font(3);
+    std::mt19937 rng(13);
+
+    for (int trial = 0; trial < 500; trial++)
+    {
+        const auto text = MakeTestText(rng, 1 + rng() % 60);
+
+        Layout layout;
+        layout.Build(text.c_str(), font.GetLineSpacing(), font.Finder());
+
+        std::vector<Layout::PlacedGlyph> expected;
+
+        LayoutGlyphs(text.c_str(), font.GetLineSpacing(), true, font.Finder(),
+            [&](TestGlyph const* glyph, float x, float y, float advance)
+            {
+                expected.push_back({ glyph, x, y, advance });
+            },
+            [](float) noexcept {});
+
+        auto const& actual = layout.GetGlyphs();
+
+        bool same = (actual.size() == expected.size());
+
+        for (size_t i = 0; same && i < actual.size(); i++)
+        {
+            same = (actual[i].glyph == expected[i].glyph)
+                && (actual[i].x == expected[i].x)
+                && (actual[i].y == expected[i].y)
+                && (actual[i].advance == expected[i].advance);
+        }
+
+        if (!same)
+        {
+            printf("ERROR: trial %d: glyphs differ from DrawString's\n", trial);
+            return false;
+        }
+
+        float width, height;
+        ReferenceMeasureString(text.c_str(), font, true, &width, &height);
+
+        if (layout.GetWidth() != width || layout.GetHeight() != height)
+        {
+            printf("ERROR: trial %d: layout measures %g x %g, MeasureString %g x %g\n", trial, layout.GetWidth(), layout.GetHeight(), width, height);
+            return false;
+        }
+
+        const auto codePoints = DecodeText(text);
+
+        CHECK(layout.GetLines().size() == size_t(std::count(codePoints.begin(), codePoints.end(), uint32_t('\n'))) + 1);
+        CHECK(!layout.IsTruncated());
+    }
+
+    // Empty text has a single empty line.
+    Layout empty;
+    empty.Build("", font.GetLineSpacing(), font.Finder());
+
+    CHECK(empty.GetGlyphs().empty());
+    CHECK(empty.GetLines().size() == 1);
+    CHECK(empty.GetWidth() == 0 && empty.GetHeight() == 0);
+
+    return true;
+}
+
+
+TEST_CASE(GlyphLayoutWraps)
+{
+    Font font(4);
+    std::mt19937 rng(14);
+
+    for (int trial = 0; trial < 1000; trial++)
+    {
+        const auto text = MakeTestText(rng, 1 + rng() % 80);
+
+        GlyphLayoutOptions options = {};
+        options.maxWidth = float(20 + rng() % 300);
+        options.wrapping = (trial & 1) ? GlyphLayoutOptions::WrapWord : GlyphLayoutOptions::WrapCharacter;
+
+        Layout layout;
+        layout.Build(text.c_str(), font.GetLineSpacing(), options, font.Finder());
+
+        char description[64];
+        snprintf(description, sizeof(description), "trial %d, %s wrapping at %g", trial,
+            (options.wrapping == GlyphLayoutOptions::WrapWord) ? "word" : "character", options.maxWidth);
+
+        if (!CheckWrapping(layout, font, options, description))
+            return false;
+
+        // Each line sits one line spacing below the last.
+        auto const& lines = layout.GetLines();
+
+        for (size_t i = 0; i < lines.size(); i++)
+        {
+            CHECK(lines[i].y == float(i) * font.GetLineSpacing());
+        }
+
+        CHECK(!layout.IsTruncated());
+    }
+
+    // A single word too wide for the line breaks between characters, one glyph per line if need be.
+    GlyphLayoutOptions narrow = {};
+    narrow.maxWidth = 1;
+    narrow.wrapping = GlyphLayoutOptions::WrapWord;
+
+    Layout layout;
+    layout.Build("WWWW", font.GetLineSpacing(), narrow, font.Finder());
+
+    CHECK(layout.GetLines().size() == 4);
+    CHECK(layout.GetGlyphs().size() == 4);
+
+    // Without a width limit, wrapping does nothing.
+    GlyphLayoutOptions unlimited = {};
+    unlimited.wrapping = GlyphLayoutOptions::WrapWord;
+
+    layout.Build("one two three", font.GetLineSpacing(), unlimited, font.Finder());
+
+    CHECK(layout.GetLines().size() == 1);
+
+    return true;
+}
+
+
+TEST_CASE(GlyphLayoutAligns)
+{
+    Font font(5);
+    std::mt19937 rng(15);
+
+    for (int trial = 0; trial < 300; trial++)
+    {
+        const auto text = MakeTestText(rng, 1 + rng() % 40);
+
+        GlyphLayoutOptions options = {};
+        options.maxWidth = (trial % 3) ? float(50 + rng() % 300) : 0.f;
+        options.wrapping = options.maxWidth > 0 ? GlyphLayoutOptions::WrapWord : GlyphLayoutOptions::WrapNone;
+
+        Layout left;
+        left.Build(text.c_str(), font.GetLineSpacing(), options, font.Finder());
+
+        // Alignment is relative to maxWidth, or to the widest line without one.
+        float alignWidth = options.maxWidth;
+
+        if (!(alignWidth > 0))
+        {
+            alignWidth = 0;
+
+            for (auto const& line : left.GetLines())
+            {
+                alignWidth = std::max(alignWidth, line.width);
+            }
+        }
+
+        for (const auto alignment : { GlyphLayoutOptions::AlignCenter, GlyphLayoutOptions::AlignRight })
+        {
+            options.alignment = alignment;
+
+            Layout aligned;
+            aligned.Build(text.c_str(), font.GetLineSpacing(), options, font.Finder());
+
+            // The same lines, each moved as a whole.
+            CHECK(aligned.GetLines().size() == left.GetLines().size());
+            CHECK(aligned.GetGlyphs().size() == left.GetGlyphs().size());
+
+            float totalWidth = 0;
+
+            for (size_t i = 0; i < left.GetLines().size(); i++)
+            {
+                auto const& line = aligned.GetLines()[i];
+
+                CHECK(line.width == left.GetLines()[i].width);
+                CHECK(line.firstGlyph == left.GetLines()[i].firstGlyph && line.glyphCount == left.GetLines()[i].glyphCount);
+
+                const float expected = (alignment == GlyphLayoutOptions::AlignCenter) ?
+                    (alignWidth - line.width) * 0.5f :
+                    alignWidth - line.width;
+
+                if (line.offset != expected)
+                {
+                    printf("ERROR: trial %d: line %zu offset %g, expected %g\n", trial, i, line.offset, expected);
+                    return false;
+                }
+
+                for (size_t g = line.firstGlyph; g < line.firstGlyph + line.glyphCount; g++)
+                {
+                    const float moved = left.GetGlyphs()[g].x + line.offset;
+
+                    if (std::abs(aligned.GetGlyphs()[g].x - moved) > 1e-4f * std::max(1.f, alignWidth))
+                    {
+                        printf("ERROR: trial %d: glyph %zu at %g, expected %g\n", trial, g, aligned.GetGlyphs()[g].x, moved);
+                        return false;
+                    }
+                }
+
+                if (line.glyphCount > 0)
+                {
+                    totalWidth = std::max(totalWidth, line.offset + line.width);
+                }
+
+                // Right aligned lines end at the alignment width.
+                if (alignment == GlyphLayoutOptions::AlignRight && line.glyphCount > 0)
+                {
+                    CHECK(std::abs(line.offset + line.width - alignWidth) <= 1e-4f * std::max(1.f, alignWidth));
+                }
+            }
+
+            CHECK(aligned.GetWidth() == totalWidth);
+            CHECK(aligned.GetHeight() == left.GetHeight());
+        }
+    }
+
+    return true;
+}
+
+
+namespace
+{
+    const GlyphLayoutOptions::Alignment Alignments[] = { GlyphLayoutOptions::AlignLeft, GlyphLayoutOptions::AlignCenter, GlyphLayoutOptions::AlignRight };
+
+
+    std::string EncodeText(std::vector<uint32_t> const& text)
+    {
+        std::string result;
+
+        for (const auto c : text)
+        {
+            AppendUtf8(result, c);
+        }
+
+        return result;
+    }
+
+
+    // Compares two layouts of the same text. Alignment offsets are applied to the glyphs of reused
+    // lines as a difference from their old offset, so positions only match exactly for left alignment.
+    bool LayoutsMatch(Layout const& expected, Layout const& actual, char const* description)
+    {
+        const bool exact = (expected.GetOptions().alignment == GlyphLayoutOptions::AlignLeft);
+        const float tolerance = exact ? 0.f : 1e-3f;
+
+        auto near = [=](float a, float b) noexcept
+            {
+                return std::abs(a - b) <= tolerance * std::max(1.f, std::abs(b));
+            };
+
+        auto const& expectedLines = expected.GetLines();
+        auto const& actualLines = actual.GetLines();
+
+        if (actualLines.size() != expectedLines.size() || actual.GetGlyphs().size() != expected.GetGlyphs().size())
+        {
+            printf("ERROR: %s: %zu lines and %zu glyphs, expected %zu and %zu\n", description,
+                actualLines.size(), actual.GetGlyphs().size(), expectedLines.size(), expected.GetGlyphs().size());
+            return false;
+        }
+
+        for (size_t i = 0; i < expectedLines.size(); i++)
+        {
+            auto const& a = actualLines[i];
+            auto const& e = expectedLines[i];
+
+            if (a.firstGlyph != e.firstGlyph || a.glyphCount != e.glyphCount
+                || a.firstCharacter != e.firstCharacter || a.endCharacter != e.endCharacter
+                || a.y != e.y || a.width != e.width || a.height != e.height
+                || !near(a.offset, e.offset) || a.truncated != e.truncated)
+            {
+                printf("ERROR: %s: line %zu differs\n", description, i);
+                return false;
+            }
+        }
+
+        for (size_t i = 0; i < expected.GetGlyphs().size(); i++)
+        {
+            auto const& a = actual.GetGlyphs()[i];
+            auto const& e = expected.GetGlyphs()[i];
+
+            if (a.glyph != e.glyph || !near(a.x, e.x) || a.y != e.y || a.advance != e.advance)
+            {
+                printf("ERROR: %s: glyph %zu is U+%04X at (%g, %g), expected U+%04X at (%g, %g)\n", description, i,
+                    a.glyph->Character, a.x, a.y, e.glyph->Character, e.x, e.y);
+                return false;
+            }
+        }
+
+        if (!near(actual.GetWidth(), expected.GetWidth()) || actual.GetHeight() != expected.GetHeight())
+        {
+            printf("ERROR: %s: measures %g x %g, expected %g x %g\n", description,
+                actual.GetWidth(), actual.GetHeight(), expected.GetWidth(), expected.GetHeight());
+            return false;
+        }
+
+        return true;
+    }
+
+
+    // Places the ellipsis after a line ending at x, as truncation should, returning its width measured from 0.
+    float PlaceEllipsis(Font const& font, GlyphLayoutOptions const& options, float x, std::vector<Layout::PlacedGlyph>* placed)
+    {
+        float width = 0;
+        float measureX = 0;
+
+        for (size_t i = 0; i < options.ellipsisLength; i++)
+        {
+            auto glyph = font.Find(options.ellipsis[i]);
+
+            measureX = std::max(measureX + glyph->XOffset, 0.f);
+            width = std::max(width, measureX + GlyphWidth(glyph));
+            measureX += GlyphWidth(glyph) + glyph->XAdvance;
+
+            x = std::max(x + glyph->XOffset, 0.f);
+
+            if (placed)
+            {
+                placed->push_back({ glyph, x, 0.f, GlyphWidth(glyph) + glyph->XAdvance });
+            }
+
+            x += GlyphWidth(glyph) + glyph->XAdvance;
+        }
+
+        return width;
+    }
+}
+
+
+TEST_CASE(GlyphLayoutUpdateReusesLines)
+{
+    Font font(8);
+
+    Layout layout;
+    layout.Build("first line\nsecond line\nthird line", font.GetLineSpacing(), font.Finder());
+
+    CHECK(layout.GetLines().size() == 3);
+
+    // An edit in the last line keeps the two before it.
+    auto before = layout;
+
+    CHECK(layout.Update("first line\nsecond line\nthird lime", font.Finder()) == 2);
+
+    for (size_t i = 0; i < 2; i++)
+    {
+        auto const& line = layout.GetLines()[i];
+
+        CHECK(line.firstGlyph == before.GetLines()[i].firstGlyph && line.glyphCount == before.GetLines()[i].glyphCount);
+
+        for (size_t g = line.firstGlyph; g < line.firstGlyph + line.glyphCount; g++)
+        {
+            CHECK(layout.GetGlyphs()[g].glyph == before.GetGlyphs()[g].glyph && layout.GetGlyphs()[g].x == before.GetGlyphs()[g].x);
+        }
+    }
+
+    // Appending only redoes the last line, and an edit to the first character redoes everything.
+    CHECK(layout.Update("first line\nsecond line\nthird lime!", font.Finder()) == 2);
+    CHECK(layout.Update("First line\nsecond line\nthird lime!", font.Finder()) == 0);
+
+    // Editing the line feed that ends a line redoes that line too.
+    CHECK(layout.Update("First line second line\nthird lime!", font.Finder()) == 0);
+    CHECK(layout.Update("First line second line\nthird lime!\n", font.Finder()) == 1);
+    CHECK(layout.GetLines().size() == 3);
+
+    // An unchanged string keeps every line but the last, which always depends on where the text ends.
+    CHECK(layout.Update("First line second line\nthird lime!\n", font.Finder()) == 2);
+
+    // Wrapped lines end where the character that did not fit is, so an edit past it keeps the line.
+    GlyphLayoutOptions options = {};
+    options.maxWidth = 40;
+    options.wrapping = GlyphLayoutOptions::WrapWord;
+
+    layout.Build("aaa bbb ccc ddd eee fff ggg", font.GetLineSpacing(), options, font.Finder());
+
+    const auto lines = layout.GetLines();
+
+    CHECK(lines.size() > 2);
+
+    const size_t edit = lines[1].endCharacter;
+
+    std::string edited = "aaa bbb ccc ddd eee fff ggg";
+    edited[edit] = '#';
+
+    CHECK(layout.Update(edited.c_str(), font.Finder()) == 2);
+
+    // In general, Update keeps exactly the lines that end before the first changed character.
+    std::mt19937 rng(23);
+
+    for (int trial = 0; trial < 500; trial++)
+    {
+        const auto text = MakeTestText(rng, 1 + rng() % 40);
+
+        options.maxWidth = (trial % 3) ? float(30 + rng() % 200) : 0.f;
+        options.wrapping = (trial & 1) ? GlyphLayoutOptions::WrapWord : GlyphLayoutOptions::WrapCharacter;
+
+        layout.Build(text.c_str(), font.GetLineSpacing(), options, font.Finder());
+
+        before = layout;
+
+        auto codePoints = DecodeText(text);
+        const size_t change = rng() % (codePoints.size() + 1);
+
+        codePoints.insert(codePoints.begin() + static_cast<ptrdiff_t>(change), uint32_t('A' + rng() % 26));
+
+        size_t expectedReused = 0;
+
+        while (expectedReused < before.GetLines().size() && before.GetLines()[expectedReused].endCharacter <= change)
+        {
+            expectedReused++;
+        }
+
+        const size_t reused = layout.Update(EncodeText(codePoints).c_str(), font.Finder());
+
+        if (reused != expectedReused)
+        {
+            printf("ERROR: trial %d: reused %zu lines after an edit at %zu, expected %zu\n", trial, reused, change, expectedReused);
+            return false;
+        }
+
+        // The reused lines' glyphs are left as they were.
+        const size_t keptGlyphs = reused ? layout.GetLines()[reused - 1].firstGlyph + layout.GetLines()[reused - 1].glyphCount : 0;
+
+        for (size_t g = 0; g < keptGlyphs; g++)
+        {
+            CHECK(layout.GetGlyphs()[g].glyph == before.GetGlyphs()[g].glyph && layout.GetGlyphs()[g].x == before.GetGlyphs()[g].x);
+        }
+    }
+
+    return true;
+}
+
+
+TEST_CASE(GlyphLayoutUpdateMatchesBuild)
+{
+    Font font(9);
+    std::mt19937 rng(24);
+
+    for (int sequence = 0; sequence < 200; sequence++)
+    {
+        GlyphLayoutOptions options = {};
+
+        if (sequence % 4)
+        {
+            options.maxWidth = float(30 + rng() % 250);
+        }
+
+        if (sequence % 5 == 1)
+        {
+            options.maxHeight = font.GetLineSpacing() * float(1 + rng() % 4) + 3.f;
+        }
+
+        options.wrapping = static_cast<GlyphLayoutOptions::Wrapping>(rng() % 3);
+        options.alignment = Alignments[rng() % 3];
+
+        if (sequence & 1)
+        {
+            options.ellipsis[0] = 0x2026;
+            options.ellipsisLength = 1;
+        }
+
+        auto codePoints = DecodeText(MakeTestText(rng, 1 + rng() % 30));
+
+        Layout layout;
+        layout.Build(EncodeText(codePoints).c_str(), font.GetLineSpacing(), options, font.Finder());
+
+        for (int edit = 0; edit < 30; edit++)
+        {
+            const size_t at = rng() % (codePoints.size() + 1);
+
+            switch (rng() % 4)
+            {
+            case 0:
+                {
+                    // Insert some text, possibly with line feeds.
+                    const auto inserted = DecodeText(MakeTestText(rng, 1 + rng() % 3));
+
+                    codePoints.insert(codePoints.begin() + static_cast<ptrdiff_t>(at), inserted.begin(), inserted.end());
+                }
+                break;
+
+            case 1:
+                {
+                    // Delete a range.
+                    const size_t count = std::min(codePoints.size() - at, size_t(rng() % 12));
+
+                    codePoints.erase(codePoints.begin() + static_cast<ptrdiff_t>(at), codePoints.begin() + static_cast<ptrdiff_t>(at + count));
+                }
+                break;
+
+            case 2:
+                // Replace a character, or append one.
+                if (at < codePoints.size())
+                {
+                    codePoints[at] = (rng() & 1) ? uint32_t(' ') : uint32_t('!' + rng() % 94);
+                }
+                else
+                {
+                    codePoints.push_back('\n');
+                }
+                break;
+
+            default:
+                // Cut the text short.
+                codePoints.resize(at);
+                break;
+            }
+
+            const auto text = EncodeText(codePoints);
+
+            layout.Update(text.c_str(), font.Finder());
+
+            Layout fresh;
+            fresh.Build(text.c_str(), font.GetLineSpacing(), options, font.Finder());
+
+            char description[64];
+            snprintf(description, sizeof(description), "sequence %d, edit %d", sequence, edit);
+
+            if (!LayoutsMatch(fresh, layout, description))
+                return false;
+
+            CHECK(layout.IsTruncated() == fresh.IsTruncated());
+            CHECK(layout.GetText() == fresh.GetText());
+        }
+    }
+
+    return true;
+}
+
+
+TEST_CASE(GlyphLayoutTruncatesWithEllipsis)
+{
+    Font font(10);
+    std::mt19937 rng(25);
+
+    GlyphLayoutOptions unlimited = {};
+
+    for (int trial = 0; trial < 1000; trial++)
+    {
+        const auto text = MakeTestText(rng, 1 + rng() % 40);
+
+        GlyphLayoutOptions options = {};
+        options.maxWidth = float(10 + rng() % 200);
+
+        if (trial & 1)
+        {
+            options.ellipsis[0] = 0x2026;
+            options.ellipsisLength = 1;
+        }
+        else
+        {
+            options.ellipsis[0] = options.ellipsis[1] = options.ellipsis[2] = '.';
+            options.ellipsisLength = 3;
+        }
+
+        // Without wrapping, each line is cut short where it no longer fits. Compare with the whole lines.
+        Layout full;
+        full.Build(text.c_str(), font.GetLineSpacing(), unlimited, font.Finder());
+
+        Layout layout;
+        layout.Build(text.c_str(), font.GetLineSpacing(), options, font.Finder());
+
+        CHECK(layout.GetLines().size() == full.GetLines().size());
+
+        const float ellipsisWidth = PlaceEllipsis(font, options, 0.f, nullptr);
+
+        bool anyTruncated = false;
+
+        for (size_t i = 0; i < full.GetLines().size(); i++)
+        {
+            auto const& fullLine = full.GetLines()[i];
+            auto const& line = layout.GetLines()[i];
+
+            auto fullGlyph = [&](size_t g) -> Layout::PlacedGlyph const& { return full.GetGlyphs()[fullLine.firstGlyph + g]; };
+
+            // The line overflows at the first visible character, other than the first on the line, that ends past maxWidth.
+            size_t overflow = SIZE_MAX;
+            bool hasContent = false;
+
+            for (size_t g = 0; g < fullLine.glyphCount; g++)
+            {
+                if (IsWhitespaceCharacter(fullGlyph(g).glyph->Character))
+                    continue;
+
+                if (hasContent && fullGlyph(g).x + GlyphWidth(fullGlyph(g).glyph) > options.maxWidth)
+                {
+                    overflow = g;
+                    break;
+                }
+
+                hasContent = true;
+            }
+
+            char description[64];
+            snprintf(description, sizeof(description), "trial %d, line %zu", trial, i);
+
+            if (line.truncated != (overflow != SIZE_MAX))
+            {
+                printf("ERROR: %s: truncated is %d, but the line %s\n", description, int(line.truncated), (overflow != SIZE_MAX) ? "overflows" : "fits");
+                return false;
+            }
+
+            std::vector<Layout::PlacedGlyph> expected;
+
+            if (overflow == SIZE_MAX)
+            {
+                expected.assign(full.GetGlyphs().begin() + static_cast<ptrdiff_t>(fullLine.firstGlyph),
+                    full.GetGlyphs().begin() + static_cast<ptrdiff_t>(fullLine.firstGlyph + fullLine.glyphCount));
+            }
+            else
+            {
+                anyTruncated = true;
+
+                // Keep the longest run of glyphs that ends in a visible character and leaves room for the ellipsis.
+                size_t kept = overflow;
+
+                while (kept > 0)
+                {
+                    auto const& last = fullGlyph(kept - 1);
+
+                    if (!IsWhitespaceCharacter(last.glyph->Character) && last.x + last.advance + ellipsisWidth <= options.maxWidth)
+                        break;
+
+                    kept--;
+                }
+
+                for (size_t g = 0; g < kept; g++)
+                {
+                    expected.push_back(fullGlyph(g));
+                }
+
+                const float end = kept ? fullGlyph(kept - 1).x + fullGlyph(kept - 1).advance : 0.f;
+
+                const size_t ellipsisStart = expected.size();
+
+                PlaceEllipsis(font, options, end, &expected);
+
+                for (size_t g = ellipsisStart; g < expected.size(); g++)
+                {
+                    expected[g].y = line.y;
+                }
+
+                // Unless nothing else fits, the ellipsis itself stays within the line.
+                if (kept > 0)
+                {
+                    auto const& last = expected.back();
+
+                    CHECK(last.x + GlyphWidth(last.glyph) <= options.maxWidth);
+                }
+            }
+
+            bool same = (line.glyphCount == expected.size());
+
+            for (size_t g = 0; same && g < expected.size(); g++)
+            {
+                auto const& actual = layout.GetGlyphs()[line.firstGlyph + g];
+
+                same = (actual.glyph == expected[g].glyph) && (actual.x == expected[g].x)
+                    && (actual.y == expected[g].y) && (actual.advance == expected[g].advance);
+            }
+
+            if (!same)
+            {
+                printf("ERROR: %s: %zu glyphs differ from the %zu expected\n", description, line.glyphCount, expected.size());
+                return false;
+            }
+        }
+
+        CHECK(layout.IsTruncated() == anyTruncated);
+    }
+
+    // Lines that do not fit in maxHeight are dropped, and the ellipsis goes on the last one kept,
+    // even though that line fits.
+    GlyphLayoutOptions options = {};
+    options.maxHeight = font.GetLineSpacing() * 2.5f;
+    options.ellipsis[0] = 0x2026;
+    options.ellipsisLength = 1;
+
+    Layout layout;
+    layout.Build("one\ntwo\nthree\nfour", font.GetLineSpacing(), options, font.Finder());
+
+    CHECK(layout.GetLines().size() == 2);
+    CHECK(layout.IsTruncated());
+    CHECK(!layout.GetLines()[0].truncated && layout.GetLines()[1].truncated);
+    CHECK(layout.GetLines()[1].glyphCount == 4);
+    CHECK(layout.GetGlyphs().back().glyph->Character == 0x2026);
+
+    // Text that just fits is left alone, even when it ends with a line feed.
+    layout.Build("one\ntwo", font.GetLineSpacing(), options, font.Finder());
+
+    CHECK(layout.GetLines().size() == 2);
+    CHECK(!layout.IsTruncated());
+
+    // Trailing whitespace goes before the ellipsis.
+    layout.Build("one\ntwo   \nthree", font.GetLineSpacing(), options, font.Finder());
+
+    CHECK(layout.GetLines()[1].glyphCount == 4);
+    CHECK(layout.GetGlyphs()[layout.GetGlyphs().size() - 2].glyph->Character == 'o');
+
+    return true;
+}
@@ -0,0 +1,91 @@
+//--------------------------------------------------------------------------------------
+// File: GlyphLookupBenchmark.cpp
+//
+// Compares GlyphLookupTable with the binary search it replaced, in bytes per font and time
+// per lookup, for several shapes of character set.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHarness.h"
+#include "GlyphLookupReference.h"
+
+#include "GlyphLookup.h"
+
+using namespace DirectX;
+using namespace DirectX::Tests;
+
+
+BENCHMARK(GlyphLookupFind)
+{
+    printf("%10s %8s %14s %14s %14s %14s\n", "font", "glyphs", "search bytes", "table bytes", "search ns", "table ns");
+
+    static const struct
+    {
+        FontShape shape;
+        char const* name;
+    } fonts[] =
+    {
+        { FontShape::Ascii, "ASCII" },
+        { FontShape::Latin, "Latin" },
+        { FontShape::Cjk, "CJK" },
+        { FontShape::Sparse, "sparse" },
+    };
+
+    std::mt19937 rng(5);
+
+    for (auto const& font : fonts)
+    {
+        const auto characters = MakeCharacterSet(font.shape, rng);
+
+        GlyphLookupTable table;
+        table.Build(characters.data(), characters.size());
+
+        // Text drawn from the font's own characters, with one in fifty missing from it.
+        constexpr size_t TextLength = 4096;
+
+        std::vector<uint32_t> text(TextLength);
+
+        for (auto& c : text)
+        {
+            c = (rng() % 50) ? characters[rng() % characters.size()] : 0xE000 + rng() % 0x100;
+        }
+
+        uint64_t searchFound = 0;
+        uint64_t tableFound = 0;
+
+        const double searchTime = MeasureNanoseconds(256, [&]()
+            {
+                for (const auto c : text)
+                {
+                    searchFound += BinarySearchGlyph(characters, c);
+                }
+
+                KeepResult(searchFound);
+            });
+
+        const double tableTime = MeasureNanoseconds(256, [&]()
+            {
+                for (const auto c : text)
+                {
+                    tableFound += table.Find(c);
+                }
+
+                KeepResult(tableFound);
+            });
+
+        // The binary search kept one copy of each glyph's character.
+        printf("%10s %8zu %14zu %14zu %14.2f %14.2f\n",
+            font.name,
+            characters.size(),
+            characters.size() * sizeof(uint32_t),
+            table.GetMemoryUsage(),
+            searchTime / double(TextLength),
+            tableTime / double(TextLength));
+    }
+
+    return true;
+}
@@ -0,0 +1,138 @@
+//--------------------------------------------------------------------------------------
+// File: GlyphLookupReference.h
+//
+// The binary search SpriteFont used to find glyphs before GlyphLookupTable, and typical font
+// character sets, shared by the glyph lookup test and benchmark.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+
+namespace DirectX
+{
+    namespace Tests
+    {
+        // SpriteFont::Impl::FindGlyph as it was, returning the index found or UINT32_MAX.
+        inline uint32_t BinarySearchGlyph(std::vector<uint32_t> const& glyphsIndex, uint32_t character) noexcept
+        {
+            if (glyphsIndex.empty())
+                return UINT32_MAX;
+
+            size_t lower = 0;
+            size_t higher = glyphsIndex.size() - 1;
+            size_t index = higher / 2;
+            const size_t size = glyphsIndex.size();
+
+            while (index < size)
+            {
+                const auto curChar = glyphsIndex[index];
+                if (curChar == character) { return static_cast<uint32_t>(index); }
+                if (curChar < character)
+                {
+                    lower = index + 1;
+                }
+                else
+                {
+                    higher = index - 1;
+                }
+                if (higher < lower) { break; }
+                else if (higher - lower <= 4)
+                {
+                    for (index = lower; index <= higher; index++)
+                    {
+                        if (glyphsIndex[index] == character)
+                        {
+                            return static_cast<uint32_t>(index);
+                        }
+                    }
+                }
+                index = lower + ((higher - lower) / 2);
+            }
+
+            return UINT32_MAX;
+        }
+
+
+        enum class FontShape
+        {
+            Ascii,      // The 95 printable ASCII characters.
+            Latin,      // Latin-1, Latin Extended-A and B, Greek and Cyrillic.
+            Cjk,        // ASCII, punctuation, kana and a 7000 character subset of the CJK ideographs.
+            Sparse,     // 20000 characters scattered over the whole Unicode range.
+        };
+
+
+        // Returns the sorted character set of a font of the given shape.
+        inline std::vector<uint32_t> MakeCharacterSet(FontShape shape, std::mt19937& rng)
+        {
+            std::vector<uint32_t> characters;
+
+            auto addRange = [&](uint32_t first, uint32_t last)
+            {
+                for (uint32_t c = first; c <= last; c++)
+                {
+                    characters.push_back(c);
+                }
+            };
+
+            switch (shape)
+            {
+            case FontShape::Ascii:
+                addRange(0x20, 0x7E);
+                break;
+
+            case FontShape::Latin:
+                addRange(0x20, 0x7E);
+                addRange(0xA0, 0x24F);
+                addRange(0x370, 0x3FF);
+                addRange(0x400, 0x4FF);
+                break;
+
+            case FontShape::Cjk:
+            {
+                addRange(0x20, 0x7E);
+                addRange(0x3000, 0x303F);
+                addRange(0x3040, 0x30FF);
+
+                std::vector<uint32_t> ideographs;
+
+                for (uint32_t c = 0x4E00; c <= 0x9FFF; c++)
+                {
+                    ideographs.push_back(c);
+                }
+
+                std::shuffle(ideographs.begin(), ideographs.end(), rng);
+                characters.insert(characters.end(), ideographs.begin(), ideographs.begin() + 7000);
+
+                addRange(0xFF01, 0xFF5E);
+                break;
+            }
+
+            case FontShape::Sparse:
+                while (characters.size() < 20000)
+                {
+                    characters.push_back(rng() % 0x110000);
+                }
+
+                std::sort(characters.begin(), characters.end());
+                characters.erase(std::unique(characters.begin(), characters.end()), characters.end());
+                break;
+            }
+
+            std::sort(characters.begin(), characters.end());
+
+            return characters;
+        }
+    }
+}
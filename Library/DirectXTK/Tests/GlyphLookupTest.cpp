@@ -0,0 +1,149 @@
+//--------------------------------------------------------------------------------------
+// File: GlyphLookupTest.cpp
+//
+// Checks that GlyphLookupTable finds the same glyphs as the binary search SpriteFont used
+// before it, for dense, sparse, duplicated and out of range character sets.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHarness.h"
+#include "GlyphLookupReference.h"
+
+#include "GlyphLookup.h"
+
+#include <random>
+
+using namespace DirectX;
+using namespace DirectX::Tests;
+
+namespace
+{
+    // Compares the table against the binary search for every code point in the Unicode range,
+    // and for values around the edges of the character set and beyond.
+    bool MatchesBinarySearch(std::vector<uint32_t> const& characters, char const* description)
+    {
+        GlyphLookupTable table;
+        table.Build(characters.data(), characters.size());
+
+        std::vector<uint32_t> queries;
+
+        for (uint32_t c = 0; c <= GlyphLookupTable::MaxCodePoint + 1; c++)
+        {
+            queries.push_back(c);
+        }
+
+        for (const auto c : characters)
+        {
+            queries.push_back(c);
+            queries.push_back(c + 1);
+            queries.push_back(c - 1);
+        }
+
+        queries.push_back(UINT32_MAX - 1);
+        queries.push_back(UINT32_MAX);
+
+        for (const auto c : queries)
+        {
+            const uint32_t expected = BinarySearchGlyph(characters, c);
+            const uint32_t actual = table.Find(c);
+
+            // The binary search may land on any copy of a duplicated character, and the table
+            // always returns the first, so compare the characters found and then the position.
+            const bool found = (expected != GlyphLookupTable::NotFound);
+
+            bool match = (found == (actual != GlyphLookupTable::NotFound));
+
+            if (match && found)
+            {
+                match = (characters[actual] == characters[expected])
+                    && (actual == 0 || characters[actual - 1] != characters[actual]);
+            }
+
+            if (!match)
+            {
+                printf("ERROR: %s: U+%04X found glyph %u, expected %u\n", description, c, actual, expected);
+                return false;
+            }
+        }
+
+        return true;
+    }
+}
+
+
+TEST_CASE(GlyphLookupMatchesBinarySearch)
+{
+    std::mt19937 rng(12);
+
+    CHECK(MatchesBinarySearch({ 'a' }, "single glyph"));
+    CHECK(MatchesBinarySearch(MakeCharacterSet(FontShape::Ascii, rng), "ASCII"));
+    CHECK(MatchesBinarySearch(MakeCharacterSet(FontShape::Latin, rng), "Latin"));
+    CHECK(MatchesBinarySearch(MakeCharacterSet(FontShape::Cjk, rng), "CJK subset"));
+    CHECK(MatchesBinarySearch(MakeCharacterSet(FontShape::Sparse, rng), "sparse"));
+
+    // Edges of the direct range, of pages and of the mask words, and the last code point.
+    CHECK(MatchesBinarySearch({ 0, 0x3F, 0x40, 0xFF, 0x100, 0x7FF, 0x800, 0x83F, 0x840, 0x8FF, 0x900, 0xFFFF, 0x10000, 0x10FFFF }, "range edges"));
+
+    // Nothing in the direct range, and nothing but values beyond it.
+    CHECK(MatchesBinarySearch({ 0x4E00, 0x4E01, 0x9FFF }, "no direct range"));
+    CHECK(MatchesBinarySearch({ 0x110000, 0x200000, 0xFFFFFFFE }, "only out of range"));
+
+    // Custom glyph sets can repeat characters, and use values beyond U+10FFFF.
+    CHECK(MatchesBinarySearch({ 'a', 'a', 'b', 0x900, 0x900, 0x900, 0x901, 0x10FFFF, 0x10FFFF, 0x110000, 0x110000, 0x7FFFFFFF }, "duplicates"));
+
+    for (int trial = 0; trial < 20; trial++)
+    {
+        const size_t count = 1 + rng() % 3000;
+        const uint32_t limit = (trial % 4 == 0) ? 0x120000 : (0x800u << (trial % 8));
+
+        std::vector<uint32_t> characters(count);
+
+        for (auto& c : characters)
+        {
+            c = rng() % limit;
+        }
+
+        std::sort(characters.begin(), characters.end());
+
+        char description[32];
+        snprintf(description, sizeof(description), "random set %d", trial);
+
+        if (!MatchesBinarySearch(characters, description))
+            return false;
+    }
+
+    // An empty table finds nothing.
+    GlyphLookupTable empty;
+    empty.Build(nullptr, 0);
+
+    CHECK(empty.Find(0) == GlyphLookupTable::NotFound);
+    CHECK(empty.Find('a') == GlyphLookupTable::NotFound);
+    CHECK(empty.Find(UINT32_MAX) == GlyphLookupTable::NotFound);
+
+    return true;
+}
+
+
+TEST_CASE(GlyphLookupRebuild)
+{
+    // Building again replaces the previous set rather than adding to it.
+    GlyphLookupTable table;
+
+    const std::vector<uint32_t> first = { 'a', 0x4E00, 0x110000 };
+    const std::vector<uint32_t> second = { 'b', 0x4E01 };
+
+    table.Build(first.data(), first.size());
+    table.Build(second.data(), second.size());
+
+    CHECK(table.Find('a') == GlyphLookupTable::NotFound);
+    CHECK(table.Find(0x4E00) == GlyphLookupTable::NotFound);
+    CHECK(table.Find(0x110000) == GlyphLookupTable::NotFound);
+    CHECK(table.Find('b') == 0);
+    CHECK(table.Find(0x4E01) == 1);
+
+    return true;
+}
@@ -0,0 +1,96 @@
+//--------------------------------------------------------------------------------------
+// File: GlyphMetricsBenchmark.cpp
+//
+// Times GlyphMetricsTable::Measure against the LayoutGlyphs loops MeasureString and
+// MeasureDrawBounds used before it, on the test font. Both sides look glyphs up with the
+// font's binary search, so the difference is in the measuring alone.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHarness.h"
+#include "TestFont.h"
+
+#include "GlyphMetrics.h"
+
+using namespace DirectX;
+using namespace DirectX::Tests;
+
+
+BENCHMARK(GlyphMetricsMeasure)
+{
+    using Font = TestFont<TestGlyph>;
+
+    const Font font(30);
+
+    GlyphMetricsTable<TestGlyph> table;
+    table.Build(font.GetGlyphs().data(), font.GetGlyphs().size(), font.GetDefault(), font.GetLineSpacing());
+
+    auto findIndex = [&](uint32_t character) noexcept
+        {
+            const size_t index = font.FindIndex(character);
+
+            return (index != SIZE_MAX) ? index : table.GetDefaultIndex(IsWhitespaceCharacter(character));
+        };
+
+    printf("%-12s %14s %14s %14s %14s   (ns per byte of UTF-8)\n", "text", "MeasureString", "DrawBounds", "both", "Measure");
+
+    std::mt19937 rng(31);
+
+    // A label, a paragraph, and a page.
+    for (const size_t words : { size_t(4), size_t(100), size_t(5000) })
+    {
+        const auto text = MakeTestText(rng, words);
+        const size_t iterations = std::max<size_t>(1, (size_t(1) << 22) / text.size());
+
+        float width = 0;
+        float height = 0;
+
+        const double measureString = MeasureNanoseconds(iterations, [&]()
+            {
+                ReferenceMeasureString(text.c_str(), font, true, &width, &height);
+            });
+
+        KeepResult(static_cast<uint64_t>(width + height));
+
+        TestGlyph::Rect bounds = {};
+
+        const double drawBounds = MeasureNanoseconds(iterations, [&]()
+            {
+                bounds = ReferenceMeasureDrawBounds(text.c_str(), font, 10.f, 20.f, true);
+            });
+
+        KeepResult(static_cast<uint64_t>(bounds.right));
+
+        // What a caller wanting both the size and the bounds had to do.
+        const double both = MeasureNanoseconds(iterations, [&]()
+            {
+                ReferenceMeasureString(text.c_str(), font, true, &width, &height);
+                bounds = ReferenceMeasureDrawBounds(text.c_str(), font, 10.f, 20.f, true);
+            });
+
+        KeepResult(static_cast<uint64_t>(width + height) + static_cast<uint64_t>(bounds.right));
+
+        GlyphMetricsResult metrics = {};
+
+        const double measure = MeasureNanoseconds(iterations, [&]()
+            {
+                metrics = table.Measure(text.c_str(), font.GetLineSpacing(), true, 10.f, 20.f, findIndex);
+            });
+
+        KeepResult(metrics.glyphCount);
+
+        char label[32];
+        snprintf(label, sizeof(label), "%zu words", words);
+
+        const double length = double(text.size());
+
+        printf("%-12s %14.2f %14.2f %14.2f %14.2f\n", label,
+            measureString / length, drawBounds / length, both / length, measure / length);
+    }
+
+    return true;
+}
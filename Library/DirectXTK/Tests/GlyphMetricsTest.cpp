@@ -0,0 +1,228 @@
+//--------------------------------------------------------------------------------------
+// File: GlyphMetricsTest.cpp
+//
+// Checks that GlyphMetricsTable's single-pass measurement reports exactly what the separate
+// MeasureString and MeasureDrawBounds loops did, with and without whitespace, across line
+// breaks, and for characters missing from the font.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHarness.h"
+#include "TestFont.h"
+
+#include "GlyphMetrics.h"
+
+using namespace DirectX;
+using namespace DirectX::Tests;
+
+namespace
+{
+    using Font = TestFont<TestGlyph>;
+    using Table = GlyphMetricsTable<TestGlyph>;
+
+
+    // The conversion SpriteFont applies to the bounds before returning them.
+    TestGlyph::Rect GetDrawBounds(GlyphMetricsResult const& metrics) noexcept
+    {
+        TestGlyph::Rect result = { 0, 0, 0, 0 };
+
+        if (metrics.glyphCount > 0)
+        {
+            result.left = long(metrics.left);
+            result.top = long(metrics.top);
+        }
+
+        if (metrics.right > 0)
+            result.right = long(metrics.right);
+
+        if (metrics.bottom > 0)
+            result.bottom = long(metrics.bottom);
+
+        return result;
+    }
+
+
+    // Whitespace the font has no glyph for, which is measured with the default glyph.
+    const uint32_t MissingWhitespace[] = { '\v', '\f', 0x2003, 0x2028 };
+
+
+    // Random text, with some characters replaced by missing whitespace and stray carriage returns.
+    std::string MakeMeasureText(std::mt19937& rng)
+    {
+        std::string text;
+
+        TextDecoder<char> decoder(MakeTestText(rng, 1 + rng() % 25).c_str());
+
+        for (uint32_t c = decoder.Next(); c != 0; c = decoder.Next())
+        {
+            const uint32_t kind = rng() % 100;
+
+            if (kind < 3)
+            {
+                AppendUtf8(text, MissingWhitespace[rng() % std::size(MissingWhitespace)]);
+            }
+            else if (kind < 5)
+            {
+                text += '\r';
+            }
+
+            AppendUtf8(text, c);
+        }
+
+        return text;
+    }
+
+
+    template<typename TChar>
+    bool CheckMeasure(Font const& font, Table const& table, TChar const* text, bool ignoreWhitespace, float positionX, float positionY, char const* description)
+    {
+        const auto metrics = table.Measure(text, font.GetLineSpacing(), ignoreWhitespace, positionX, positionY,
+            [&](uint32_t character) noexcept
+            {
+                const size_t index = font.FindIndex(character);
+
+                return (index != SIZE_MAX) ? index : table.GetDefaultIndex(IsWhitespaceCharacter(character));
+            });
+
+        float width, height;
+        ReferenceMeasureString(text, font, ignoreWhitespace, &width, &height);
+
+        const auto expected = ReferenceMeasureDrawBounds(text, font, positionX, positionY, ignoreWhitespace);
+        const auto actual = GetDrawBounds(metrics);
+
+        size_t glyphCount = 0;
+        size_t lineCount = 1;
+
+        LayoutGlyphs(text, font.GetLineSpacing(), ignoreWhitespace, font.Finder(),
+            [&](TestGlyph const*, float, float, float) noexcept { glyphCount++; },
+            [&](float) noexcept { lineCount++; });
+
+        if (metrics.width != width || metrics.height != height)
+        {
+            printf("ERROR: %s: measures %g x %g, expected %g x %g\n", description, metrics.width, metrics.height, width, height);
+            return false;
+        }
+
+        if (actual.left != expected.left || actual.top != expected.top || actual.right != expected.right || actual.bottom != expected.bottom)
+        {
+            printf("ERROR: %s: bounds (%ld, %ld, %ld, %ld), expected (%ld, %ld, %ld, %ld)\n", description,
+                actual.left, actual.top, actual.right, actual.bottom, expected.left, expected.top, expected.right, expected.bottom);
+            return false;
+        }
+
+        if (metrics.glyphCount != glyphCount || metrics.lineCount != lineCount)
+        {
+            printf("ERROR: %s: %zu glyphs on %zu lines, expected %zu on %zu\n", description, metrics.glyphCount, metrics.lineCount, glyphCount, lineCount);
+            return false;
+        }
+
+        return true;
+    }
+}
+
+
+TEST_CASE(GlyphMetricsMatchesReference)
+{
+    std::mt19937 rng(28);
+
+    std::uniform_real_distribution<float> position(-300.f, 300.f);
+
+    // Default glyphs that are visible, invisible whitespace, and visible whitespace. Line spacings
+    // above and below the glyph heights, and zero.
+    const uint32_t defaults[] = { '?', ' ', '\t' };
+    const float lineSpacings[] = { 18.f, 7.5f, 0.f };
+
+    for (size_t d = 0; d < std::size(defaults); d++)
+    {
+        for (const float lineSpacing : lineSpacings)
+        {
+            Font font(static_cast<uint32_t>(20 + d), lineSpacing);
+            font.SetDefault(defaults[d]);
+
+            Table table;
+            table.Build(font.GetGlyphs().data(), font.GetGlyphs().size(), font.GetDefault(), lineSpacing);
+
+            for (int trial = 0; trial < 300; trial++)
+            {
+                const auto text = MakeMeasureText(rng);
+                const auto wideText = WidenUtf8(text);
+
+                // Whole pixels, and fractions that truncate differently either side of zero.
+                const float x = (trial & 4) ? float(int(position(rng))) : position(rng);
+                const float y = (trial & 8) ? float(int(position(rng))) : position(rng);
+
+                for (const bool ignoreWhitespace : { true, false })
+                {
+                    char description[96];
+                    snprintf(description, sizeof(description), "default U+%04X, line spacing %g, trial %d, ignoreWhitespace %d",
+                        defaults[d], lineSpacing, trial, int(ignoreWhitespace));
+
+                    if (!CheckMeasure(font, table, text.c_str(), ignoreWhitespace, x, y, description))
+                        return false;
+
+                    if (!CheckMeasure(font, table, wideText.c_str(), ignoreWhitespace, x, y, description))
+                        return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+
+TEST_CASE(GlyphMetricsWhitespaceAndLineBreaks)
+{
+    Font font(29);
+
+    Table table;
+    table.Build(font.GetGlyphs().data(), font.GetGlyphs().size(), font.GetDefault(), font.GetLineSpacing());
+
+    // Strings made only of whitespace and line breaks, where measuring and ignoring whitespace differ
+    // most, along with leading and trailing breaks and blank lines around visible text.
+    const char* const strings[] =
+    {
+        "",
+        " ",
+        "   ",
+        "\t",
+        "\n",
+        "\r\n",
+        "\r",
+        "\n\n\n",
+        " \n \n ",
+        "\t\n\t",
+        "\xE3\x80\x80",             // U+3000
+        "\v\f",
+        "\nA",
+        "A\n",
+        "\n\nA\n\n",
+        "A \n \nB",
+        "  leading",
+        "trailing  ",
+        "tab\tbetween",
+        "A\r\nB\rC",
+        "\xE2\x80\x83word\xE2\x80\x83",     // U+2003 either side
+    };
+
+    for (size_t i = 0; i < std::size(strings); i++)
+    {
+        for (const bool ignoreWhitespace : { true, false })
+        {
+            for (const float x : { 0.f, 10.5f, -10.5f })
+            {
+                char description[64];
+                snprintf(description, sizeof(description), "string %zu, ignoreWhitespace %d, x %g", i, int(ignoreWhitespace), x);
+
+                if (!CheckMeasure(font, table, strings[i], ignoreWhitespace, x, -x, description))
+                    return false;
+            }
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,124 @@
+//--------------------------------------------------------------------------------------
+// File: GlyphRunWriterBenchmark.cpp
+//
+// Times GlyphRunWriter turning laid out glyphs into sprite run elements, with a flush that
+// only counts what it is handed, so no device is needed. SpriteBatchDrawRun in
+// SpriteFontBenchmark.cpp times what the elements then cost to queue on a real SpriteBatch.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHarness.h"
+#include "TestFont.h"
+
+#include "GlyphLayout.h"
+
+using namespace DirectX;
+using namespace DirectX::Tests;
+
+namespace
+{
+    using Font = TestFont<TestGlyph>;
+
+
+    // Stands in for SpriteBatch::DrawRun, touching each element once so the writer's stores
+    // cannot be optimized away.
+    struct CountingFlush
+    {
+        size_t elements = 0;
+        float originSum = 0;
+
+        void operator()(TestRunElement const* run, size_t count) noexcept
+        {
+            elements += count;
+
+            for (size_t i = 0; i < count; i++)
+            {
+                originSum += run[i].origin.x;
+            }
+        }
+    };
+
+
+    // Lays out text through a GlyphRunWriter with the given chunk size, as DrawString does.
+    template<size_t ChunkSize>
+    double TimeWriter(Font const& font, std::string const& text, size_t iterations, CountingFlush& flush)
+    {
+        GlyphRunWriter<TestRunElement, ChunkSize> run;
+
+        return MeasureNanoseconds(iterations, [&]()
+            {
+                run.SetPlacement(10.f, 20.f, 0.f, 0.f, 0);
+
+                LayoutGlyphs(text.c_str(), font.GetLineSpacing(), true, font.Finder(),
+                    [&](TestGlyph const* glyph, float x, float y, float)
+                    {
+                        run.Add(glyph, x, y, flush);
+                    },
+                    [](float) noexcept {});
+
+                run.Flush(flush);
+            });
+    }
+}
+
+
+BENCHMARK(GlyphRunWriterThroughput)
+{
+    const Font font(30);
+
+    printf("%-12s %14s %14s %14s   (ns per glyph)\n", "text", "layout only", "writer, 16", "writer, 256");
+
+    std::mt19937 rng(14);
+
+    // A label, a paragraph, and a page.
+    for (const size_t words : { size_t(4), size_t(100), size_t(5000) })
+    {
+        const auto text = MakeTestText(rng, words);
+        const size_t iterations = std::max<size_t>(1, (size_t(1) << 22) / text.size());
+
+        // The layout on its own, counting glyphs, to show what the writer adds.
+        size_t glyphCount = 0;
+
+        const double layout = MeasureNanoseconds(iterations, [&]()
+            {
+                glyphCount = 0;
+
+                LayoutGlyphs(text.c_str(), font.GetLineSpacing(), true, font.Finder(),
+                    [&](TestGlyph const*, float, float, float) noexcept
+                    {
+                        glyphCount++;
+                    },
+                    [](float) noexcept {});
+            });
+
+        KeepResult(glyphCount);
+
+        CountingFlush small;
+        const double writerSmall = TimeWriter<16>(font, text, iterations, small);
+
+        CountingFlush large;
+        const double writerLarge = TimeWriter<256>(font, text, iterations, large);
+
+        KeepResult(small.elements + large.elements + static_cast<uint64_t>(small.originSum < large.originSum));
+
+        // Both writers must have handed over every glyph, however they chunked them.
+        if (glyphCount == 0 || small.elements != large.elements || small.elements % glyphCount != 0)
+        {
+            printf("ERROR: the writers flushed %zu and %zu elements for %zu glyphs\n", small.elements, large.elements, glyphCount);
+            return false;
+        }
+
+        char label[32];
+        snprintf(label, sizeof(label), "%zu words", words);
+
+        const double glyphs = double(glyphCount);
+
+        printf("%-12s %14.2f %14.2f %14.2f\n", label, layout / glyphs, writerSmall / glyphs, writerLarge / glyphs);
+    }
+
+    return true;
+}
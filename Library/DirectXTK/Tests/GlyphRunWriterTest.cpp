@@ -0,0 +1,195 @@
+//--------------------------------------------------------------------------------------
+// File: GlyphRunWriterTest.cpp
+//
+// Checks that GlyphRunWriter produces the sprite origins the per-glyph DrawString loop passed
+// to SpriteBatch::Draw, for every mirroring mode, and hands them over in complete chunks.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHarness.h"
+#include "TestFont.h"
+
+#include "GlyphLayout.h"
+
+using namespace DirectX;
+using namespace DirectX::Tests;
+
+namespace
+{
+    using Font = TestFont<TestGlyph>;
+
+    // The origin DrawString used to compute for each glyph: (x, y + YOffset) scaled by the axis
+    // direction and added to the base offset, then, on mirrored axes, the glyph size added on.
+    TestRunElement::Float2 ReferenceOrigin(TestGlyph const* glyph, float x, float y, float baseX, float baseY, uint32_t effects) noexcept
+    {
+        const bool flipX = (effects & 1) != 0;
+        const bool flipY = (effects & 2) != 0;
+
+        const float glyphY = y + glyph->YOffset;
+
+        TestRunElement::Float2 origin;
+        origin.x = (flipX ? x : -x) + baseX;
+        origin.y = (flipY ? glyphY : -glyphY) + baseY;
+
+        if (flipX)
+            origin.x = float(glyph->Subrect.right - glyph->Subrect.left) + origin.x;
+
+        if (flipY)
+            origin.y = float(glyph->Subrect.bottom - glyph->Subrect.top) + origin.y;
+
+        return origin;
+    }
+
+
+    template<size_t ChunkSize>
+    bool CheckWriter(Font const& font, std::string const& text, uint32_t effects, char const* description)
+    {
+        constexpr float PositionX = 123.25f, PositionY = -45.5f;
+        const float baseX = 17.f + float(effects), baseY = -3.5f * float(effects);
+
+        struct Expected
+        {
+            TestGlyph const* glyph;
+            TestRunElement::Float2 origin;
+        };
+
+        std::vector<Expected> expected;
+
+        LayoutGlyphs(text.c_str(), font.GetLineSpacing(), true, font.Finder(),
+            [&](TestGlyph const* glyph, float x, float y, float)
+            {
+                expected.push_back({ glyph, ReferenceOrigin(glyph, x, y, baseX, baseY, effects) });
+            },
+            [](float) noexcept {});
+
+        GlyphRunWriter<TestRunElement, ChunkSize> run;
+        run.SetPlacement(PositionX, PositionY, baseX, baseY, effects);
+
+        std::vector<TestRunElement> actual;
+        std::vector<size_t> chunks;
+
+        auto flush = [&](TestRunElement const* elements, size_t count)
+            {
+                chunks.push_back(count);
+                actual.insert(actual.end(), elements, elements + count);
+            };
+
+        LayoutGlyphs(text.c_str(), font.GetLineSpacing(), true, font.Finder(),
+            [&](TestGlyph const* glyph, float x, float y, float)
+            {
+                run.Add(glyph, x, y, flush);
+            },
+            [](float) noexcept {});
+
+        run.Flush(flush);
+
+        // Every chunk but the last is full, and flushing an empty writer does nothing.
+        for (size_t i = 0; i + 1 < chunks.size(); i++)
+        {
+            CHECK(chunks[i] == ChunkSize);
+        }
+
+        CHECK(chunks.empty() || (chunks.back() > 0 && chunks.back() <= ChunkSize));
+
+        const size_t before = chunks.size();
+        run.Flush(flush);
+        CHECK(chunks.size() == before);
+
+        CHECK(actual.size() == expected.size());
+
+        for (size_t i = 0; i < actual.size(); i++)
+        {
+            auto const& element = actual[i];
+            auto const glyph = expected[i].glyph;
+
+            const bool same = element.position.x == PositionX && element.position.y == PositionY
+                && element.origin.x == expected[i].origin.x && element.origin.y == expected[i].origin.y
+                && element.sourceRectangle.left == glyph->Subrect.left && element.sourceRectangle.top == glyph->Subrect.top
+                && element.sourceRectangle.right == glyph->Subrect.right && element.sourceRectangle.bottom == glyph->Subrect.bottom;
+
+            if (!same)
+            {
+                printf("ERROR: %s: glyph %zu has origin (%g, %g), expected (%g, %g)\n",
+                    description, i, element.origin.x, element.origin.y, expected[i].origin.x, expected[i].origin.y);
+                return false;
+            }
+        }
+
+        return true;
+    }
+}
+
+
+TEST_CASE(GlyphRunWriterMatchesDrawString)
+{
+    Font font(6);
+    std::mt19937 rng(19);
+
+    for (int trial = 0; trial < 400; trial++)
+    {
+        const auto text = MakeTestText(rng, 1 + rng() % 100);
+        const auto effects = static_cast<uint32_t>(trial & 3);
+
+        char description[48];
+        snprintf(description, sizeof(description), "trial %d, effects %u", trial, effects);
+
+        // The default chunk size, and one small enough to split most strings.
+        if (!CheckWriter<256>(font, text, effects, description))
+            return false;
+
+        if (!CheckWriter<7>(font, text, effects, description))
+            return false;
+    }
+
+    CHECK(CheckWriter<7>(font, "", 0, "empty text"));
+    CHECK(CheckWriter<7>(font, "   \n \t", 3, "whitespace"));
+
+    return true;
+}
+
+
+TEST_CASE(GlyphRunWriterSharedAcrossStrings)
+{
+    // Several strings can go through one writer, each with its own placement, without flushing in between.
+    Font font(7);
+
+    GlyphRunWriter<TestRunElement, 4> run;
+
+    std::vector<TestRunElement> actual;
+
+    auto flush = [&](TestRunElement const* elements, size_t count)
+        {
+            actual.insert(actual.end(), elements, elements + count);
+        };
+
+    const char* const strings[] = { "abc", "defgh", "ij" };
+
+    for (size_t i = 0; i < std::size(strings); i++)
+    {
+        run.SetPlacement(float(i) * 100.f, 0.f, 0.f, 0.f, 0);
+
+        LayoutGlyphs(strings[i], font.GetLineSpacing(), true, font.Finder(),
+            [&](TestGlyph const* glyph, float x, float y, float)
+            {
+                run.Add(glyph, x, y, flush);
+            },
+            [](float) noexcept {});
+    }
+
+    run.Flush(flush);
+
+    CHECK(actual.size() == 10);
+
+    for (size_t i = 0; i < actual.size(); i++)
+    {
+        const float expectedX = (i < 3) ? 0.f : (i < 8) ? 100.f : 200.f;
+
+        CHECK(actual[i].position.x == expectedX);
+    }
+
+    return true;
+}
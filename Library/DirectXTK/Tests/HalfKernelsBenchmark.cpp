@@ -0,0 +1,112 @@
+//--------------------------------------------------------------------------------------
+// File: HalfKernelsBenchmark.cpp
+//
+// Times converting arrays between float and half with each instruction set's kernels, against
+// XMConvertFloatToHalf and XMConvertHalfToFloat called once per component.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHarness.h"
+#include "SimdTestLevels.h"
+
+#include "HalfKernels.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+using namespace DirectX::PackedVector;
+using namespace DirectX::Tests;
+
+
+BENCHMARK(HalfKernelsThroughput)
+{
+    const auto levels = GetTestedSimdLevels();
+
+    for (const size_t count : { size_t(1) << 12, size_t(1) << 22 })
+    {
+        std::mt19937 rng(static_cast<uint32_t>(count));
+        std::uniform_real_distribution<float> value(-1000.f, 1000.f);
+
+        std::vector<float> floats(count);
+        for (auto& f : floats)
+        {
+            f = value(rng);
+        }
+
+        std::vector<HALF> halves(count);
+        std::vector<float> back(count);
+
+        // About 64M components per measurement, however long the arrays are.
+        const size_t iterations = std::max<size_t>(1, (size_t(1) << 26) / count);
+
+        char label[32];
+        snprintf(label, sizeof(label), "%zu components", count);
+
+        printf("%-20s %12s", label, "one at a time");
+
+        for (const SimdLevel level : levels)
+        {
+            printf(" %12s", GetSimdLevelName(level));
+        }
+
+        printf("   (ns per component)\n");
+
+        const double scalarToHalf = MeasureNanoseconds(iterations, [&]()
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    halves[i] = XMConvertFloatToHalf(floats[i]);
+                }
+            });
+
+        printf("  %-18s %12.3f", "float to half", scalarToHalf / double(count));
+
+        for (const SimdLevel level : levels)
+        {
+            const auto floatToHalf = HalfKernels::GetHalfKernels(level).floatToHalf;
+
+            const double time = MeasureNanoseconds(iterations, [&]()
+                {
+                    floatToHalf(floats.data(), count, halves.data());
+                });
+
+            printf(" %12.3f", time / double(count));
+        }
+
+        KeepResult(halves[count / 2]);
+
+        const double scalarToFloat = MeasureNanoseconds(iterations, [&]()
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    back[i] = XMConvertHalfToFloat(halves[i]);
+                }
+            });
+
+        printf("\n  %-18s %12.3f", "half to float", scalarToFloat / double(count));
+
+        for (const SimdLevel level : levels)
+        {
+            const auto halfToFloat = HalfKernels::GetHalfKernels(level).halfToFloat;
+
+            const double time = MeasureNanoseconds(iterations, [&]()
+                {
+                    halfToFloat(halves.data(), count, back.data());
+                });
+
+            printf(" %12.3f", time / double(count));
+        }
+
+        KeepResult(static_cast<uint64_t>(back[count / 2] * 1000.f));
+
+        printf("\n\n");
+    }
+
+    return true;
+}
@@ -0,0 +1,411 @@
+//--------------------------------------------------------------------------------------
+// File: HalfKernelsTest.cpp
+//
+// Checks the half-precision array conversions for each instruction set against DirectXMath's
+// XMConvertFloatToHalf and XMConvertHalfToFloat, for every array length up to a few vectors,
+// and the round trip through HalfVector2, HalfVector3 and HalfVector4.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHarness.h"
+#include "SimdTestLevels.h"
+
+#include "SimpleMath.h"
+#include "HalfKernels.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+using namespace DirectX::PackedVector;
+using namespace DirectX::SimpleMath;
+using namespace DirectX::Tests;
+
+namespace
+{
+    uint32_t FloatBits(float value) noexcept
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+
+    float BitsToFloat(uint32_t bits) noexcept
+    {
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+
+    // F16C always returns quiet NaNs, so NaNs are compared with their quiet bit set.
+    HALF QuietHalf(HALF h) noexcept
+    {
+        return ((h & 0x7C00u) == 0x7C00u && (h & 0x3FFu) != 0) ? HALF(h | 0x200u) : h;
+    }
+
+
+    uint32_t QuietFloatBits(float value) noexcept
+    {
+        const uint32_t bits = FloatBits(value);
+        return std::isnan(value) ? (bits | 0x400000u) : bits;
+    }
+
+
+    // The value of a half, built from its fields rather than by any of the conversions under test.
+    float DecodeHalf(HALF h) noexcept
+    {
+        const uint32_t exponent = (h >> 10) & 0x1Fu;
+        const uint32_t mantissa = h & 0x3FFu;
+        const float sign = (h & 0x8000u) ? -1.f : 1.f;
+
+        if (exponent == 0x1F)
+            return BitsToFloat((uint32_t(h & 0x8000u) << 16) | 0x7F800000u | (mantissa << 13));
+
+        if (exponent == 0)
+            return sign * std::ldexp(float(mantissa), -24);
+
+        return sign * std::ldexp(float(mantissa | 0x400u), int(exponent) - 25);
+    }
+
+
+    // DirectXMath's scalar conversions have not always treated the top exponent as infinities and
+    // NaNs, nor rounded every denormal to nearest, as F16C does. Where they do not, only values
+    // that are normal as halves are compared.
+    bool ScalarConversionsFollowIeee()
+    {
+        // Just above the tie between the denormals 2 and 3 times 2^-24, so it must round up.
+        const float aboveTie = std::ldexp(2.5f + std::ldexp(1.f, -19), -24);
+
+        return XMConvertFloatToHalf(std::numeric_limits<float>::infinity()) == 0x7C00
+            && XMConvertFloatToHalf(1e6f) == 0x7C00
+            && std::isinf(XMConvertHalfToFloat(0x7C00))
+            && std::isnan(XMConvertHalfToFloat(0x7E00))
+            && XMConvertFloatToHalf(aboveTie) == 3;
+    }
+
+
+    bool IsNormalHalfRange(float value) noexcept
+    {
+        const float magnitude = std::fabs(value);
+        return magnitude == 0.f || (magnitude >= std::ldexp(1.f, -14) && magnitude <= 65504.f);
+    }
+
+
+    // Every half as a float, the ties halfway to the next one, and the floats either side of those
+    // ties, then float denormals, overflows, infinities, NaNs with payloads and ordinary values.
+    std::vector<float> MakeFloatInputs(std::mt19937& rng)
+    {
+        std::vector<float> inputs;
+
+        for (uint32_t h = 0; h < 0x10000; h++)
+        {
+            if ((h & 0x7C00u) == 0x7C00u)
+                continue;
+
+            const float value = DecodeHalf(HALF(h));
+            inputs.push_back(value);
+
+            if ((h & 0x7FFFu) == 0x7BFFu)
+                continue;
+
+            const float next = DecodeHalf(HALF(h + 1));
+            const float tie = value + (next - value) * 0.5f;
+
+            inputs.push_back(tie);
+            inputs.push_back(std::nextafter(tie, 0.f));
+            inputs.push_back(std::nextafter(tie, std::copysign(FLT_MAX, tie)));
+        }
+
+        const float special[] =
+        {
+            65519.f, 65520.f, 65536.f, 131008.f, 1e6f, FLT_MAX,
+            std::numeric_limits<float>::infinity(),
+            std::numeric_limits<float>::denorm_min(),
+            FLT_MIN,
+            std::ldexp(1.f, -25),
+            std::nextafter(std::ldexp(1.f, -25), 1.f),
+            BitsToFloat(0x7FC00000u),
+            BitsToFloat(0x7F800001u),
+            BitsToFloat(0x7FA00000u),
+            BitsToFloat(0x7F802000u),
+            BitsToFloat(0x7FFFFFFFu),
+        };
+
+        for (const float value : special)
+        {
+            inputs.push_back(value);
+            inputs.push_back(-value);
+        }
+
+        std::uniform_real_distribution<float> mantissa(-1.f, 1.f);
+        std::uniform_int_distribution<int> exponent(-30, 20);
+
+        for (size_t i = 0; i < 100000; i++)
+        {
+            inputs.push_back(std::ldexp(mantissa(rng), exponent(rng)));
+        }
+
+        std::shuffle(inputs.begin(), inputs.end(), rng);
+
+        return inputs;
+    }
+
+
+    // Lengths around each vector width, and where they fall in the array, so that every tail is run.
+    constexpr size_t MaxTailCount = 40;
+    constexpr HALF GuardHalf = 0xABCD;
+    constexpr float GuardFloat = -12345.f;
+
+    const size_t VectorCounts[] = { 0, 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 1000 };
+}
+
+
+TEST_CASE(HalfKernelsMatchXMConvert)
+{
+    std::mt19937 rng(23);
+
+    const bool ieee = ScalarConversionsFollowIeee();
+
+    if (!ieee)
+    {
+        printf("  DirectXMath's scalar half conversions have no infinities or NaNs, so only normal halves are compared\n");
+    }
+
+    const auto floats = MakeFloatInputs(rng);
+
+    std::vector<HALF> halves(0x10000);
+    for (size_t i = 0; i < halves.size(); i++)
+    {
+        halves[i] = HALF(i);
+    }
+
+    std::vector<HALF> expectedHalves(floats.size());
+    for (size_t i = 0; i < floats.size(); i++)
+    {
+        expectedHalves[i] = QuietHalf(XMConvertFloatToHalf(floats[i]));
+    }
+
+    std::vector<uint32_t> expectedFloats(halves.size());
+    for (size_t i = 0; i < halves.size(); i++)
+    {
+        expectedFloats[i] = QuietFloatBits(XMConvertHalfToFloat(halves[i]));
+    }
+
+    for (const SimdLevel level : GetTestedSimdLevels())
+    {
+        auto const& kernels = HalfKernels::GetHalfKernels(level);
+        char const* name = GetSimdLevelName(level);
+
+        std::vector<HALF> toHalf(floats.size() + 1, GuardHalf);
+        kernels.floatToHalf(floats.data(), floats.size(), toHalf.data());
+
+        for (size_t i = 0; i < floats.size(); i++)
+        {
+            if (!ieee && !IsNormalHalfRange(floats[i]))
+                continue;
+
+            if (QuietHalf(toHalf[i]) != expectedHalves[i])
+            {
+                printf("ERROR: %s floatToHalf(%.9g = 0x%08X) gave 0x%04X, XMConvertFloatToHalf gives 0x%04X\n",
+                    name, double(floats[i]), FloatBits(floats[i]), toHalf[i], expectedHalves[i]);
+                return false;
+            }
+        }
+
+        CHECK(toHalf.back() == GuardHalf);
+
+        std::vector<float> toFloat(halves.size() + 1, GuardFloat);
+        kernels.halfToFloat(halves.data(), halves.size(), toFloat.data());
+
+        for (size_t i = 0; i < halves.size(); i++)
+        {
+            if (!ieee && (halves[i] & 0x7C00u) == 0x7C00u)
+                continue;
+
+            if (QuietFloatBits(toFloat[i]) != expectedFloats[i])
+            {
+                printf("ERROR: %s halfToFloat(0x%04zX) gave 0x%08X, XMConvertHalfToFloat gives 0x%08X\n",
+                    name, i, FloatBits(toFloat[i]), expectedFloats[i]);
+                return false;
+            }
+        }
+
+        CHECK(toFloat.back() == GuardFloat);
+
+        // Each short length from several starting points, with nothing written past the end.
+        for (size_t count = 0; count <= MaxTailCount; count++)
+        {
+            for (const size_t start : { size_t(0), size_t(1), size_t(7), size_t(1001) })
+            {
+                std::vector<HALF> shortHalf(count + 1, GuardHalf);
+                kernels.floatToHalf(floats.data() + start, count, shortHalf.data());
+
+                CHECK(memcmp(shortHalf.data(), toHalf.data() + start, count * sizeof(HALF)) == 0);
+                CHECK(shortHalf[count] == GuardHalf);
+
+                std::vector<float> shortFloat(count + 1, GuardFloat);
+                kernels.halfToFloat(halves.data() + start, count, shortFloat.data());
+
+                CHECK(memcmp(shortFloat.data(), toFloat.data() + start, count * sizeof(float)) == 0);
+                CHECK(shortFloat[count] == GuardFloat);
+            }
+        }
+    }
+
+    return true;
+}
+
+
+TEST_CASE(HalfKernelsRoundTrip)
+{
+    std::mt19937 rng(24);
+
+    const bool ieee = ScalarConversionsFollowIeee();
+
+    for (const SimdLevel level : GetTestedSimdLevels())
+    {
+        auto const& kernels = HalfKernels::GetHalfKernels(level);
+        char const* name = GetSimdLevelName(level);
+
+        // The baseline kernels are DirectXMath's own, so hold their denormals to the bound only
+        // where DirectXMath rounds them to nearest.
+        const bool checkDenormals = ieee || level != SimdLevel::Baseline;
+
+        // Every half comes back from float unchanged, apart from NaNs being made quiet.
+        std::vector<HALF> halves(0x10000);
+        for (size_t i = 0; i < halves.size(); i++)
+        {
+            halves[i] = HALF(i);
+        }
+
+        std::vector<float> floats(halves.size());
+        kernels.halfToFloat(halves.data(), halves.size(), floats.data());
+
+        std::vector<HALF> back(halves.size());
+        kernels.floatToHalf(floats.data(), floats.size(), back.data());
+
+        for (size_t i = 0; i < halves.size(); i++)
+        {
+            if (QuietHalf(back[i]) != QuietHalf(halves[i]))
+            {
+                printf("ERROR: %s half 0x%04zX came back as 0x%04X\n", name, i, back[i]);
+                return false;
+            }
+        }
+
+        // Floats in range come back to within half a unit in the last place: 2^-11 of the value for
+        // normal halves, and 2^-25 for denormals, whose spacing is 2^-24.
+        std::uniform_real_distribution<float> mantissa(-1.f, 1.f);
+        std::uniform_int_distribution<int> exponent(-26, 16);
+
+        std::vector<float> values(100003);
+        for (auto& value : values)
+        {
+            value = std::fmin(std::fmax(std::ldexp(mantissa(rng), exponent(rng)), -65504.f), 65504.f);
+        }
+
+        std::vector<HALF> packed(values.size());
+        kernels.floatToHalf(values.data(), values.size(), packed.data());
+
+        std::vector<float> unpacked(values.size());
+        kernels.halfToFloat(packed.data(), packed.size(), unpacked.data());
+
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            const double value = values[i];
+            const bool denormal = std::fabs(value) < std::ldexp(1., -14);
+
+            if (denormal && !checkDenormals)
+                continue;
+
+            const double error = std::fabs(double(unpacked[i]) - value);
+            const double bound = denormal ? std::ldexp(1., -25) : std::ldexp(std::fabs(value), -11);
+
+            if (error > bound)
+            {
+                printf("ERROR: %s %.9g came back as %.9g, an error of %g over %g\n", name, value, double(unpacked[i]), error, bound);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+TEST_CASE(HalfVectorsMatchXMStoreHalf)
+{
+    // Through the public functions, which use whichever kernels this CPU gets. Values stay within the
+    // normal half range, where every DirectXMath rounds the same way.
+    std::mt19937 rng(25);
+    std::uniform_real_distribution<float> mantissa(-1.f, 1.f);
+    std::uniform_int_distribution<int> exponent(-12, 15);
+
+    auto random = [&]() { return std::ldexp(mantissa(rng), exponent(rng)); };
+
+    for (const size_t count : VectorCounts)
+    {
+        std::vector<Vector2> v2(count);
+        std::vector<Vector3> v3(count);
+        std::vector<Vector4> v4(count);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            v2[i] = Vector2(random(), random());
+            v3[i] = Vector3(random(), random(), random());
+            v4[i] = Vector4(random(), random(), random(), random());
+        }
+
+        std::vector<HalfVector2> h2(count);
+        std::vector<HalfVector3> h3(count);
+        std::vector<HalfVector4> h4(count);
+
+        HalfVector2::Pack(v2.data(), count, h2.data());
+        HalfVector3::Pack(v3.data(), count, h3.data());
+        HalfVector4::Pack(v4.data(), count, h4.data());
+
+        std::vector<Vector2> u2(count);
+        std::vector<Vector3> u3(count);
+        std::vector<Vector4> u4(count);
+
+        HalfVector2::Unpack(h2.data(), count, u2.data());
+        HalfVector3::Unpack(h3.data(), count, u3.data());
+        HalfVector4::Unpack(h4.data(), count, u4.data());
+
+        for (size_t i = 0; i < count; i++)
+        {
+            const HalfVector2 e2(v2[i]);
+            const HalfVector3 e3(v3[i]);
+            const HalfVector4 e4(v4[i]);
+
+            const Vector2 f2 = e2;
+            const Vector3 f3 = e3;
+            const Vector4 f4 = e4;
+
+            if (memcmp(&h2[i], &e2, sizeof(e2)) != 0 || memcmp(&h3[i], &e3, sizeof(e3)) != 0 || memcmp(&h4[i], &e4, sizeof(e4)) != 0)
+            {
+                printf("ERROR: %zu vectors: Pack result %zu differs from XMStoreHalf\n", count, i);
+                return false;
+            }
+
+            if (memcmp(&u2[i], &f2, sizeof(f2)) != 0 || memcmp(&u3[i], &f3, sizeof(f3)) != 0 || memcmp(&u4[i], &f4, sizeof(f4)) != 0)
+            {
+                printf("ERROR: %zu vectors: Unpack result %zu differs from XMLoadHalf\n", count, i);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,123 @@
+//--------------------------------------------------------------------------------------
+// File: InstancedRenderingBenchmark.cpp
+//
+// Compares SpriteBatch's vertex and instanced paths: bytes uploaded and draws issued per
+// frame, and the time spent in End and in the whole frame.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "DeviceTest.h"
+
+#include "SpriteBatch.h"
+
+#include <random>
+
+using namespace DirectX;
+using namespace DirectX::Tests;
+
+namespace
+{
+    struct SpriteParameters
+    {
+        XMFLOAT2 position;
+        float rotation;
+        float depth;
+    };
+
+
+    std::vector<SpriteParameters> MakeSprites(size_t count)
+    {
+        std::mt19937 rng(3);
+        std::uniform_real_distribution<float> position(0.f, 512.f);
+        std::uniform_real_distribution<float> unit(0.f, 1.f);
+
+        std::vector<SpriteParameters> sprites(count);
+
+        for (auto& sprite : sprites)
+        {
+            sprite.position.x = position(rng);
+            sprite.position.y = position(rng);
+            sprite.rotation = unit(rng);
+            sprite.depth = unit(rng);
+        }
+
+        return sprites;
+    }
+}
+
+
+BENCHMARK(InstancedRenderingFrame)
+{
+    TestDevice test;
+
+    if (!CreateTestDevice(test))
+        return false;
+
+    auto context = test.context.Get();
+
+    TestRenderTarget renderTarget(test.device.Get(), 512, 512);
+
+    renderTarget.Begin(context);
+
+    auto texture = CreateTestTexture(test.device.Get(), 16, 16, 1);
+
+    static const RECT source = { 0, 0, 8, 8 };
+
+    printf("%10s %10s %14s %8s %10s %10s   (per frame)\n", "sprites", "path", "bytes mapped", "draws", "End ms", "frame ms");
+
+    for (const size_t count : { size_t(1000), size_t(10000), size_t(100000) })
+    {
+        constexpr size_t Frames = 10;
+
+        const auto sprites = MakeSprites(count);
+
+        for (const bool instanced : { false, true })
+        {
+            SpriteBatch batch(context);
+
+            batch.SetInstancedRendering(instanced);
+
+            using clock = std::chrono::steady_clock;
+
+            clock::duration endTime{};
+
+            const auto start = clock::now();
+
+            for (size_t frame = 0; frame < Frames; frame++)
+            {
+                batch.Begin();
+
+                for (auto const& sprite : sprites)
+                {
+                    batch.Draw(texture.Get(), sprite.position, &source, Colors::White, sprite.rotation, XMFLOAT2(4.f, 4.f), 1.f, SpriteEffects_None, sprite.depth);
+                }
+
+                const auto endStart = clock::now();
+
+                batch.End();
+
+                endTime += clock::now() - endStart;
+
+                WaitForGpu(test.device.Get(), context);
+            }
+
+            const auto total = clock::now() - start;
+
+            const auto statistics = batch.GetStatistics();
+
+            printf("%10zu %10s %14zu %8zu %10.3f %10.3f\n",
+                count,
+                instanced ? "instanced" : "vertex",
+                statistics.bytesMapped,
+                statistics.batchesIssued,
+                std::chrono::duration<double, std::milli>(endTime).count() / double(Frames),
+                std::chrono::duration<double, std::milli>(total).count() / double(Frames));
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,263 @@
+//--------------------------------------------------------------------------------------
+// File: InstancedRenderingTest.cpp
+//
+// Checks the instanced sprite path: the packed instance corners, the instance ring's wrap
+// policy, and that SetInstancedRendering draws the same image in fewer, smaller uploads.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "DeviceTest.h"
+#include "SpriteTestData.h"
+
+#include "SpriteInstances.h"
+
+#include <cmath>
+#include <random>
+
+using namespace DirectX;
+using namespace DirectX::Tests;
+using Microsoft::WRL::ComPtr;
+
+namespace
+{
+    bool NearlyEqual(double expected, float actual, double scale) noexcept
+    {
+        return std::abs(expected - double(actual)) <= 1e-5 * scale;
+    }
+}
+
+
+TEST_CASE(SpriteInstanceCorners)
+{
+    std::mt19937 rng(4);
+
+    std::uniform_real_distribution<float> position(-500.f, 1500.f);
+    std::uniform_real_distribution<float> size(-100.f, 300.f);
+    std::uniform_real_distribution<float> fraction(-0.5f, 1.5f);
+    std::uniform_real_distribution<float> angle(-10.f, 10.f);
+    std::uniform_real_distribution<float> unit(0.f, 1.f);
+
+    for (int i = 0; i < 100000; i++)
+    {
+        const float x = position(rng), y = position(rng), width = size(rng), height = size(rng);
+        const float originX = fraction(rng), originY = fraction(rng);
+        const float rotation = (i & 3) ? angle(rng) : 0.f;
+        const float depth = unit(rng);
+        const float u = unit(rng), v = unit(rng), uSize = unit(rng), vSize = unit(rng);
+        const unsigned int mirror = static_cast<unsigned int>(i) & 3;
+        const unsigned int slot = static_cast<unsigned int>(i) % 8;
+
+        SpriteInstance instance;
+        PackSpriteInstance(&instance,
+            XMVectorSet(x, y, width, height),
+            XMVectorSet(u, v, uSize, vSize),
+            XMVectorSet(0.25f, 0.5f, 0.75f, 1.f),
+            XMVectorSet(originX, originY, rotation, depth),
+            mirror,
+            slot);
+
+        const double sinR = std::sin(double(rotation));
+        const double cosR = std::cos(double(rotation));
+
+        const double scale = std::abs(x) + std::abs(y) + std::abs(width) + std::abs(height);
+
+        // The shader places corner (cx, cy) at position + cx * axisX + cy * axisY, which must land
+        // where rotating the unit square offset by the origin does.
+        for (int corner = 0; corner < 4; corner++)
+        {
+            const double cx = double(corner & 1);
+            const double cy = double(corner >> 1);
+
+            const double localX = (cx - originX) * width;
+            const double localY = (cy - originY) * height;
+
+            const double expectedX = x + cosR * localX - sinR * localY;
+            const double expectedY = y + sinR * localX + cosR * localY;
+
+            const float actualX = instance.positionAxisX.x + float(cx) * instance.positionAxisX.z + float(cy) * instance.axisYDepthSlot.x;
+            const float actualY = instance.positionAxisX.y + float(cx) * instance.positionAxisX.w + float(cy) * instance.axisYDepthSlot.y;
+
+            if (!NearlyEqual(expectedX, actualX, scale) || !NearlyEqual(expectedY, actualY, scale))
+            {
+                printf("ERROR: sprite %d corner %d is at (%g, %g), expected (%g, %g)\n", i, corner, actualX, actualY, expectedX, expectedY);
+                return false;
+            }
+
+            // Mirroring swaps the texture coordinates of opposite edges.
+            const double mirroredX = (mirror & 1) ? 1.0 - cx : cx;
+            const double mirroredY = (mirror & 2) ? 1.0 - cy : cy;
+
+            const float actualU = instance.textureCoordinates.x + float(cx) * instance.textureCoordinates.z;
+            const float actualV = instance.textureCoordinates.y + float(cy) * instance.textureCoordinates.w;
+
+            if (!NearlyEqual(u + mirroredX * uSize, actualU, 1.0) || !NearlyEqual(v + mirroredY * vSize, actualV, 1.0))
+            {
+                printf("ERROR: sprite %d corner %d has texture coordinate (%g, %g) with mirror bits %u\n", i, corner, actualU, actualV, mirror);
+                return false;
+            }
+        }
+
+        CHECK(instance.axisYDepthSlot.z == depth);
+        CHECK(instance.axisYDepthSlot.w == float(slot));
+    }
+
+    return true;
+}
+
+
+TEST_CASE(SpriteInstanceRingWraps)
+{
+    constexpr size_t Capacity = 1000;
+    constexpr size_t MinBatch = 100;
+
+    SpriteInstanceRing ring(Capacity, MinBatch);
+
+    CHECK(ring.GetCapacity() == Capacity);
+
+    // The first reservation discards, but has not wrapped.
+    auto span = ring.Reserve(600);
+    CHECK(span.start == 0 && span.count == 600 && span.discard && !span.wrapped);
+
+    // Later ones append without discarding.
+    span = ring.Reserve(250);
+    CHECK(span.start == 600 && span.count == 250 && !span.discard && !span.wrapped);
+
+    // 150 left, which is at least MinBatch, so a larger request is cut to fit.
+    span = ring.Reserve(400);
+    CHECK(span.start == 850 && span.count == 150 && !span.discard && !span.wrapped);
+
+    // Full: wrap, discarding, and report it.
+    span = ring.Reserve(10);
+    CHECK(span.start == 0 && span.count == 10 && span.discard && span.wrapped);
+
+    // Fewer than MinBatch left: wrap rather than submit a sliver.
+    ring.Reserve(920);
+    span = ring.Reserve(200);
+    CHECK(span.start == 0 && span.count == 200 && span.discard && span.wrapped);
+
+    // Requests larger than the buffer are capped at its capacity.
+    ring.Reset();
+    span = ring.Reserve(5000);
+    CHECK(span.start == 0 && span.count == Capacity && span.discard && !span.wrapped);
+
+    // Random requests never run past the end, and a span that starts over always discards.
+    std::mt19937 rng(6);
+
+    for (int i = 0; i < 10000; i++)
+    {
+        const size_t request = 1 + rng() % 1500;
+
+        span = ring.Reserve(request);
+
+        CHECK(span.count > 0 && span.count <= request);
+        CHECK(span.start + span.count <= Capacity);
+        CHECK(span.discard == (span.start == 0));
+        CHECK(!span.wrapped || span.start == 0);
+    }
+
+    return true;
+}
+
+
+TEST_CASE(InstancedRenderingMatchesVertexPath)
+{
+    TestDevice test;
+
+    if (!CreateTestDevice(test))
+        return false;
+
+    auto context = test.context.Get();
+
+    constexpr UINT TargetSize = 256;
+
+    TestRenderTarget target(test.device.Get(), TargetSize, TargetSize);
+
+    ComPtr<ID3D11ShaderResourceView> textures[] =
+    {
+        CreateTestTexture(test.device.Get(), 64, 32, 1),
+        CreateTestTexture(test.device.Get(), 17, 9, 2),
+        CreateTestTexture(test.device.Get(), 128, 128, 3),
+    };
+
+    ID3D11ShaderResourceView* const textureViews[] = { textures[0].Get(), textures[1].Get(), textures[2].Get() };
+
+    // Enough sprites for several 2048 sprite vertex batches.
+    constexpr size_t SpriteCount = 10000;
+
+    for (const size_t maxTextures : { size_t(1), size_t(4) })
+    {
+        for (const auto sortMode : { SpriteSortMode_Deferred, SpriteSortMode_Texture, SpriteSortMode_BackToFront })
+        {
+            std::vector<uint32_t> images[2];
+            SpriteBatchStatistics statistics[2];
+
+            for (const bool instanced : { false, true })
+            {
+                target.Begin(context);
+
+                SpriteBatch batch(context);
+
+                batch.SetMaxTexturesPerBatch(maxTextures);
+                batch.SetInstancedRendering(instanced);
+
+                batch.Begin(sortMode);
+                DrawTestSprites(batch, textureViews, std::size(textureViews), SpriteCount, 12, float(TargetSize));
+                batch.End();
+
+                images[instanced] = target.Read(context);
+                statistics[instanced] = batch.GetStatistics();
+            }
+
+            char description[64];
+            snprintf(description, sizeof(description), "sort mode %d, %zu textures per batch", int(sortMode), maxTextures);
+
+            // The instanced shader computes corners on the GPU rather than the CPU, so an edge that
+            // lands exactly on a pixel center can round the other way. Anything more is a real difference.
+            const size_t different = CountDifferentPixels(images[0], images[1], 2);
+
+            if (different > TargetSize * TargetSize / 200)
+            {
+                printf("ERROR: %s: %zu pixels differ between the vertex and instanced paths\n", description, different);
+                return false;
+            }
+
+            // One instance of 64 bytes per sprite, rather than four vertices of 36 bytes and, with
+            // several textures per batch, four texture slot bytes.
+            const size_t vertexBytes = (sizeof(VertexPositionColorTexture) + ((maxTextures > 1) ? 1 : 0)) * 4 * SpriteCount;
+
+            if (statistics[0].bytesMapped != vertexBytes || statistics[1].bytesMapped != sizeof(SpriteInstance) * SpriteCount)
+            {
+                printf("ERROR: %s: mapped %zu and %zu bytes\n", description, statistics[0].bytesMapped, statistics[1].bytesMapped);
+                return false;
+            }
+
+            // Instanced batches are not limited by the index buffer, so they never need more draws.
+            if (statistics[1].batchesIssued > statistics[0].batchesIssued)
+            {
+                printf("ERROR: %s: %zu instanced draws, but %zu without\n", description, statistics[1].batchesIssued, statistics[0].batchesIssued);
+                return false;
+            }
+
+            CHECK(statistics[0].spritesQueued == SpriteCount && statistics[1].spritesQueued == SpriteCount);
+        }
+    }
+
+    // With one texture, the whole batch needs one instanced draw, or two if it straddles the end of the instance ring.
+    SpriteBatch batch(context);
+
+    batch.SetInstancedRendering(true);
+
+    target.Begin(context);
+
+    batch.Begin();
+    DrawTestSprites(batch, textureViews, 1, SpriteCount, 13, float(TargetSize));
+    batch.End();
+
+    CHECK(batch.GetStatistics().batchesIssued <= 2);
+
+    return true;
+}
@@ -0,0 +1,233 @@
+//--------------------------------------------------------------------------------------
+// File: MappedFileTest.cpp
+//
+// Checks the POSIX backend of MappedFile: the contents and size of the view, the errors for
+// files that cannot be mapped, and the ownership of the view as it is moved and closed. The
+// Windows backend is covered through SpriteFont in SpriteFontFileTest.cpp.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHarness.h"
+
+#ifndef _WIN32
+
+#include "MappedFile.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+using namespace DirectX;
+using namespace DirectX::Tests;
+
+namespace
+{
+    // A file in the temporary directory, deleted when the object is destroyed.
+    class TempFile
+    {
+    public:
+        explicit TempFile(std::vector<uint8_t> const& contents)
+        {
+            char const* directory = getenv("TMPDIR");
+
+            mName = std::string((directory && *directory) ? directory : "/tmp") + "/MappedFileTestXXXXXX";
+
+            const int fd = mkstemp(&mName[0]);
+
+            if (fd < 0)
+                throw std::runtime_error("mkstemp");
+
+            size_t written = 0;
+
+            while (written < contents.size())
+            {
+                const ssize_t result = write(fd, contents.data() + written, contents.size() - written);
+
+                if (result <= 0)
+                {
+                    close(fd);
+                    throw std::runtime_error("write");
+                }
+
+                written += static_cast<size_t>(result);
+            }
+
+            close(fd);
+        }
+
+        TempFile(TempFile const&) = delete;
+        TempFile& operator= (TempFile const&) = delete;
+
+        ~TempFile()
+        {
+            unlink(mName.c_str());
+        }
+
+        char const* GetName() const noexcept { return mName.c_str(); }
+
+    private:
+        std::string mName;
+    };
+
+
+    std::vector<uint8_t> MakeContents(size_t size, uint32_t seed)
+    {
+        std::mt19937 rng(seed);
+
+        std::vector<uint8_t> contents(size);
+
+        for (auto& c : contents)
+        {
+            c = static_cast<uint8_t>(rng());
+        }
+
+        return contents;
+    }
+
+
+    bool Holds(MappedFile const& file, std::vector<uint8_t> const& contents)
+    {
+        return file.IsOpen()
+            && file.GetSize() == contents.size()
+            && memcmp(file.GetData(), contents.data(), contents.size()) == 0;
+    }
+}
+
+
+TEST_CASE(MappedFileMapsContents)
+{
+    // Sizes below, at and across page boundaries.
+    const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+    for (const size_t size : { size_t(1), size_t(17), pageSize - 1, pageSize, pageSize + 1, 3 * pageSize + 123, size_t(5) << 20 })
+    {
+        const auto contents = MakeContents(size, static_cast<uint32_t>(size));
+
+        TempFile temp(contents);
+
+        MappedFile file;
+
+        CHECK(!file.IsOpen());
+        CHECK(file.GetData() == nullptr && file.GetSize() == 0);
+
+        CHECK(file.Open(temp.GetName()) == 0);
+        CHECK(Holds(file, contents));
+
+        file.Close();
+
+        CHECK(!file.IsOpen());
+        CHECK(file.GetData() == nullptr && file.GetSize() == 0);
+
+        // Closing twice is harmless.
+        file.Close();
+
+        CHECK(!file.IsOpen());
+    }
+
+    return true;
+}
+
+
+TEST_CASE(MappedFileReportsErrors)
+{
+    MappedFile file;
+
+    CHECK(file.Open(nullptr) == EINVAL);
+    CHECK(!file.IsOpen());
+
+    CHECK(file.Open("/nonexistent-directory/no-such-file") == ENOENT);
+    CHECK(!file.IsOpen());
+
+    // Empty files cannot be mapped.
+    {
+        TempFile empty({});
+
+        CHECK(file.Open(empty.GetName()) == EINVAL);
+        CHECK(!file.IsOpen());
+    }
+
+    // Nor can directories.
+    CHECK(file.Open("/") != 0);
+    CHECK(!file.IsOpen());
+
+    // A failed Open closes the view that was open before it.
+    const auto contents = MakeContents(100, 1);
+
+    TempFile temp(contents);
+
+    CHECK(file.Open(temp.GetName()) == 0);
+    CHECK(file.Open("/nonexistent-directory/no-such-file") == ENOENT);
+    CHECK(!file.IsOpen());
+
+    return true;
+}
+
+
+TEST_CASE(MappedFileOwnership)
+{
+    const auto contents1 = MakeContents(5000, 2);
+    const auto contents2 = MakeContents(70, 3);
+
+    TempFile temp1(contents1);
+    TempFile temp2(contents2);
+
+    MappedFile file;
+
+    CHECK(file.Open(temp1.GetName()) == 0);
+
+    // Opening another file replaces the view.
+    CHECK(file.Open(temp2.GetName()) == 0);
+    CHECK(Holds(file, contents2));
+
+    // Moving transfers the view, leaving the source empty.
+    MappedFile moved(std::move(file));
+
+    CHECK(!file.IsOpen());
+    CHECK(file.GetData() == nullptr && file.GetSize() == 0);
+    CHECK(Holds(moved, contents2));
+
+    MappedFile assigned;
+
+    CHECK(assigned.Open(temp1.GetName()) == 0);
+
+    assigned = std::move(moved);
+
+    CHECK(!moved.IsOpen());
+    CHECK(Holds(assigned, contents2));
+
+    // Self-assignment keeps the view.
+    auto& self = assigned;
+    assigned = std::move(self);
+
+    CHECK(Holds(assigned, contents2));
+
+    return true;
+}
+
+
+TEST_CASE(MappedFileOutlivesFileName)
+{
+    // The view holds its own reference to the file, so the data stays readable after the
+    // file is unlinked, just as it does after Open closes its descriptor.
+    const auto contents = MakeContents(10000, 4);
+
+    MappedFile file;
+
+    {
+        TempFile temp(contents);
+
+        CHECK(file.Open(temp.GetName()) == 0);
+    }
+
+    CHECK(Holds(file, contents));
+
+    return true;
+}
+
+#endif
@@ -0,0 +1,160 @@
+//--------------------------------------------------------------------------------------
+// File: MatrixKernelsBenchmark.cpp
+//
+// Times the matrix array kernels for each instruction set against XMMatrixMultiply called once
+// per matrix: plain products, products stored transposed as 3x4 bone palettes, and products
+// down a bone hierarchy.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHarness.h"
+#include "SimdTestLevels.h"
+
+#include "SimpleMath.h"
+#include "MatrixKernels.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+using namespace DirectX::SimpleMath;
+using namespace DirectX::Tests;
+
+namespace
+{
+    // One line: the XMMatrixMultiply loop, then the kernel for each instruction set, in ns per matrix.
+    template<typename TScalar, typename TKernel>
+    void TimeRow(char const* label, size_t count, size_t iterations, std::vector<SimdLevel> const& levels, TScalar&& scalar, TKernel&& kernel)
+    {
+        printf("  %-20s %12.3f", label, MeasureNanoseconds(iterations, scalar) / double(count));
+
+        for (const SimdLevel level : levels)
+        {
+            auto const& kernels = MatrixKernels::GetMatrixKernels(level);
+
+            const double time = MeasureNanoseconds(iterations, [&]()
+                {
+                    kernel(kernels);
+                });
+
+            printf(" %12.3f", time / double(count));
+        }
+
+        printf("\n");
+    }
+}
+
+
+BENCHMARK(MatrixKernelsThroughput)
+{
+    const auto levels = GetTestedSimdLevels();
+
+    // A skinned character's palette, then a crowd's worth.
+    for (const size_t count : { size_t(64), size_t(1) << 16 })
+    {
+        std::mt19937 rng(static_cast<uint32_t>(count));
+        std::uniform_real_distribution<float> angle(-XM_PI, XM_PI);
+        std::uniform_real_distribution<float> offset(-1.f, 1.f);
+
+        // Rigid transforms, as bones are, so that long chains of products stay finite.
+        auto makeTransform = [&]()
+            {
+                return Matrix::CreateFromYawPitchRoll(angle(rng), angle(rng), angle(rng)) * Matrix::CreateTranslation(offset(rng), offset(rng), offset(rng));
+            };
+
+        std::vector<Matrix> m1(count), m2(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            m1[i] = makeTransform();
+            m2[i] = makeTransform();
+        }
+
+        // Parents before children, mostly in chains as in a skeleton.
+        std::vector<uint32_t> parents(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            parents[i] = (i == 0) ? MatrixKernels::NoParent
+                : (rng() % 4) ? uint32_t(i - 1)
+                : uint32_t(rng() % i);
+        }
+
+        const Matrix root = Matrix::CreateTranslation(1.f, 2.f, 3.f);
+
+        std::vector<Matrix> result(count);
+        std::vector<XMFLOAT3X4> result3x4(count);
+
+        // About 4M matrices per measurement, however many there are.
+        const size_t iterations = std::max<size_t>(1, (size_t(1) << 22) / count);
+
+        char label[32];
+        snprintf(label, sizeof(label), "%zu matrices", count);
+
+        printf("%-22s %12s", label, "one at a time");
+
+        for (const SimdLevel level : levels)
+        {
+            printf(" %12s", GetSimdLevelName(level));
+        }
+
+        printf("   (ns per matrix)\n");
+
+        TimeRow("multiply", count, iterations, levels,
+            [&]()
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    result[i] = XMMatrixMultiply(m1[i], m2[i]);
+                }
+            },
+            [&](MatrixKernels::Kernels const& kernels)
+            {
+                kernels.multiply(&m1.data()->_11, &m2.data()->_11, count, &result.data()->_11);
+            });
+
+        KeepResult(static_cast<uint64_t>(result[count / 2]._11 > 0.f));
+
+        TimeRow("multiply to 3x4", count, iterations, levels,
+            [&]()
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    const XMMATRIX M = XMMatrixTranspose(XMMatrixMultiply(m1[i], m2[i]));
+
+                    XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&result3x4[i]._11), M.r[0]);
+                    XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&result3x4[i]._21), M.r[1]);
+                    XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&result3x4[i]._31), M.r[2]);
+                }
+            },
+            [&](MatrixKernels::Kernels const& kernels)
+            {
+                kernels.multiply3x4(&m1.data()->_11, &m2.data()->_11, count, &result3x4.data()->_11);
+            });
+
+        KeepResult(static_cast<uint64_t>(result3x4[count / 2]._11 > 0.f));
+
+        TimeRow("hierarchy", count, iterations, levels,
+            [&]()
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    const Matrix& parent = (parents[i] == MatrixKernels::NoParent) ? root : result[parents[i]];
+                    result[i] = XMMatrixMultiply(m1[i], parent);
+                }
+            },
+            [&](MatrixKernels::Kernels const& kernels)
+            {
+                kernels.multiplyHierarchy(&m1.data()->_11, parents.data(), count, &root._11, &result.data()->_11);
+            });
+
+        KeepResult(static_cast<uint64_t>(result[count - 1]._11 > 0.f));
+
+        printf("\n");
+    }
+
+    return true;
+}
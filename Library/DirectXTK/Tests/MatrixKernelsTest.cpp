@@ -0,0 +1,244 @@
+//--------------------------------------------------------------------------------------
+// File: MatrixKernelsTest.cpp
+//
+// Checks that the matrix array kernels for each instruction set, and the Matrix functions built
+// on them, give bit-for-bit the results of XMMatrixMultiply.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHarness.h"
+#include "SimdTestLevels.h"
+
+#include "SimpleMath.h"
+#include "MatrixKernels.h"
+
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+using namespace DirectX::SimpleMath;
+using namespace DirectX::Tests;
+
+namespace
+{
+    // Each element has its own magnitude, so that the four products summed for each result round
+    // differently depending on the order they are added. Some are zero, negative zero or denormal.
+    std::vector<Matrix> MakeMatrices(std::mt19937& rng, size_t count)
+    {
+        std::uniform_real_distribution<float> mantissa(-1.f, 1.f);
+        std::uniform_int_distribution<int> exponent(-20, 20);
+
+        std::vector<Matrix> matrices(count);
+
+        for (auto& matrix : matrices)
+        {
+            float* m = &matrix._11;
+
+            for (size_t j = 0; j < 16; j++)
+            {
+                switch (rng() % 16)
+                {
+                case 0:  m[j] = 0.f; break;
+                case 1:  m[j] = -0.f; break;
+                case 2:  m[j] = mantissa(rng) * 1e-39f; break;
+                default: m[j] = std::ldexp(mantissa(rng), exponent(rng)); break;
+                }
+            }
+        }
+
+        return matrices;
+    }
+
+
+    // Affine, for MultiplyAffine, whose callers drop the last column.
+    std::vector<Matrix> MakeAffineMatrices(std::mt19937& rng, size_t count)
+    {
+        auto matrices = MakeMatrices(rng, count);
+
+        for (auto& m : matrices)
+        {
+            m._14 = m._24 = m._34 = 0.f;
+            m._44 = 1.f;
+        }
+
+        return matrices;
+    }
+
+
+    bool SameBits(void const* actual, void const* expected, size_t size, char const* description, size_t count, size_t index)
+    {
+        if (memcmp(actual, expected, size) != 0)
+        {
+            printf("ERROR: %s, %zu matrices: result %zu differs from XMMatrixMultiply\n", description, count, index);
+            return false;
+        }
+
+        return true;
+    }
+
+
+    XMFLOAT3X4 Expected3x4(Matrix const& m1, Matrix const& m2) noexcept
+    {
+        const XMMATRIX M = XMMatrixTranspose(XMMatrixMultiply(m1, m2));
+
+        XMFLOAT3X4 result;
+        XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&result._11), M.r[0]);
+        XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&result._21), M.r[1]);
+        XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&result._31), M.r[2]);
+        return result;
+    }
+
+
+    // Parents before children: some roots, some chains, some wide fans.
+    std::vector<uint32_t> MakeParents(std::mt19937& rng, size_t count)
+    {
+        std::vector<uint32_t> parents(count);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            parents[i] = (i == 0 || rng() % 8 == 0) ? MatrixKernels::NoParent
+                : (rng() % 2) ? uint32_t(i - 1)
+                : uint32_t(rng() % i);
+        }
+
+        return parents;
+    }
+
+
+    std::vector<Matrix> ExpectedHierarchy(std::vector<Matrix> const& local, std::vector<uint32_t> const& parents, Matrix const& root)
+    {
+        std::vector<Matrix> result(local.size());
+
+        for (size_t i = 0; i < local.size(); i++)
+        {
+            const Matrix parent = (parents[i] == MatrixKernels::NoParent) ? root : result[parents[i]];
+
+            result[i] = XMMatrixMultiply(local[i], parent);
+        }
+
+        return result;
+    }
+
+
+    // Every tail length for each width, and enough to run for a while.
+    const size_t TestCounts[] = { 0, 1, 2, 3, 4, 5, 7, 8, 9, 16, 17, 1000 };
+}
+
+
+TEST_CASE(MatrixKernelsMatchXMMatrixMultiply)
+{
+    std::mt19937 rng(20);
+
+    for (const SimdLevel level : GetTestedSimdLevels())
+    {
+        auto const& kernels = MatrixKernels::GetMatrixKernels(level);
+        char const* name = GetSimdLevelName(level);
+
+        for (const size_t count : TestCounts)
+        {
+            const auto m1 = MakeMatrices(rng, count);
+            const auto m2 = MakeMatrices(rng, count);
+
+            std::vector<Matrix> result(count);
+            kernels.multiply(&m1.data()->_11, &m2.data()->_11, count, &result.data()->_11);
+
+            std::vector<XMFLOAT3X4> result3x4(count);
+            kernels.multiply3x4(&m1.data()->_11, &m2.data()->_11, count, &result3x4.data()->_11);
+
+            for (size_t i = 0; i < count; i++)
+            {
+                const Matrix expected = XMMatrixMultiply(m1[i], m2[i]);
+                const XMFLOAT3X4 expected3x4 = Expected3x4(m1[i], m2[i]);
+
+                if (!SameBits(&result[i], &expected, sizeof(Matrix), name, count, i))
+                    return false;
+
+                if (!SameBits(&result3x4[i], &expected3x4, sizeof(XMFLOAT3X4), name, count, i))
+                    return false;
+            }
+
+            // The result may be either input.
+            auto aliased = m1;
+            kernels.multiply(&aliased.data()->_11, &m2.data()->_11, count, &aliased.data()->_11);
+            CHECK(count == 0 || memcmp(aliased.data(), result.data(), count * sizeof(Matrix)) == 0);
+
+            aliased = m2;
+            kernels.multiply(&m1.data()->_11, &aliased.data()->_11, count, &aliased.data()->_11);
+            CHECK(count == 0 || memcmp(aliased.data(), result.data(), count * sizeof(Matrix)) == 0);
+
+            const auto parents = MakeParents(rng, count);
+            const Matrix root = MakeMatrices(rng, 1)[0];
+            const auto expected = ExpectedHierarchy(m1, parents, root);
+
+            std::vector<Matrix> hierarchy(count);
+            kernels.multiplyHierarchy(&m1.data()->_11, parents.data(), count, &root._11, &hierarchy.data()->_11);
+
+            for (size_t i = 0; i < count; i++)
+            {
+                if (!SameBits(&hierarchy[i], &expected[i], sizeof(Matrix), name, count, i))
+                    return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+TEST_CASE(MatrixArraysMatchOperator)
+{
+    // Through the public functions, which use whichever kernels this CPU gets.
+    std::mt19937 rng(21);
+
+    for (const size_t count : TestCounts)
+    {
+        const auto m1 = MakeAffineMatrices(rng, count);
+        const auto m2 = MakeAffineMatrices(rng, count);
+
+        std::vector<Matrix> result(count);
+        Matrix::Multiply(m1.data(), m2.data(), count, result.data());
+
+        for (size_t i = 0; i < count; i++)
+        {
+            const Matrix expected = m1[i] * m2[i];
+
+            if (!SameBits(&result[i], &expected, sizeof(Matrix), "Matrix::Multiply", count, i))
+                return false;
+        }
+
+    #if DIRECTX_MATH_VERSION >= 313
+        std::vector<XMFLOAT3X4> affine(count);
+        Matrix::MultiplyAffine(m1.data(), m2.data(), count, affine.data());
+
+        for (size_t i = 0; i < count; i++)
+        {
+            XMFLOAT3X4 expected;
+            XMStoreFloat3x4(&expected, m1[i] * m2[i]);
+
+            if (!SameBits(&affine[i], &expected, sizeof(XMFLOAT3X4), "Matrix::MultiplyAffine", count, i))
+                return false;
+        }
+    #endif
+
+        const auto parents = MakeParents(rng, count);
+        const Matrix root = MakeAffineMatrices(rng, 1)[0];
+        const auto expected = ExpectedHierarchy(m1, parents, root);
+
+        std::vector<Matrix> hierarchy(count);
+        Matrix::MultiplyHierarchy(m1.data(), parents.data(), count, root, hierarchy.data());
+
+        for (size_t i = 0; i < count; i++)
+        {
+            if (!SameBits(&hierarchy[i], &expected[i], sizeof(Matrix), "Matrix::MultiplyHierarchy", count, i))
+                return false;
+        }
+    }
+
+    return true;
+}
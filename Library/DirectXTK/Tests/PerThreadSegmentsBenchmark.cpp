@@ -0,0 +1,109 @@
+//--------------------------------------------------------------------------------------
+// File: PerThreadSegmentsBenchmark.cpp
+//
+// Times recording into PerThreadSegments from 1 to 16 threads and merging the segments into
+// one queue afterwards, the way SpriteBatch records and merges with threaded recording on.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHarness.h"
+
+#include "PerThreadSegments.h"
+
+#include <chrono>
+#include <thread>
+
+using namespace DirectX;
+using namespace DirectX::Tests;
+
+namespace
+{
+    // Stands in for SpriteBatch's RecordingSegment, with one value per sprite.
+    struct Segment
+    {
+        std::vector<uint64_t> values;
+    };
+
+    constexpr size_t ValueCount = 1000000;
+    constexpr size_t Frames = 10;
+}
+
+
+BENCHMARK(PerThreadSegmentsRecordAndMerge)
+{
+    printf("%zu values per frame, %u hardware threads\n", ValueCount, std::thread::hardware_concurrency());
+    printf("%10s %12s %12s   (ms per frame; record includes starting the threads)\n", "threads", "record", "merge");
+
+    for (const size_t threadCount : { size_t(1), size_t(2), size_t(4), size_t(8), size_t(16) })
+    {
+        PerThreadSegments<Segment> segments;
+        std::vector<uint64_t> merged;
+
+        using clock = std::chrono::steady_clock;
+
+        clock::duration recordTime{};
+        clock::duration mergeTime{};
+
+        for (size_t frame = 0; frame < Frames; frame++)
+        {
+            segments.NextGeneration();
+
+            const auto recordStart = clock::now();
+
+            std::vector<std::thread> threads;
+
+            for (size_t thread = 0; thread < threadCount; thread++)
+            {
+                const size_t begin = ValueCount * thread / threadCount;
+                const size_t end = ValueCount * (thread + 1) / threadCount;
+
+                // Looks the segment up for every value, as each SpriteBatch::Draw call does.
+                threads.emplace_back([&segments, begin, end]()
+                    {
+                        for (size_t i = begin; i < end; i++)
+                        {
+                            segments.Get().values.push_back(i);
+                        }
+                    });
+            }
+
+            for (auto& thread : threads)
+            {
+                thread.join();
+            }
+
+            const auto mergeStart = clock::now();
+
+            merged.clear();
+
+            segments.ForEachActive([&](Segment& segment)
+                {
+                    merged.insert(merged.end(), segment.values.begin(), segment.values.end());
+                    segment.values.clear();
+                });
+
+            const auto mergeFinish = clock::now();
+
+            recordTime += mergeStart - recordStart;
+            mergeTime += mergeFinish - mergeStart;
+
+            if (merged.size() != ValueCount)
+            {
+                printf("ERROR: %zu threads merged %zu values, expected %zu\n", threadCount, merged.size(), ValueCount);
+                return false;
+            }
+        }
+
+        KeepResult(merged.back());
+
+        printf("%10zu %12.3f %12.3f\n", threadCount,
+            std::chrono::duration<double, std::milli>(recordTime).count() / double(Frames),
+            std::chrono::duration<double, std::milli>(mergeTime).count() / double(Frames));
+    }
+
+    return true;
+}
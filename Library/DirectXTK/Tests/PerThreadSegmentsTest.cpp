@@ -0,0 +1,263 @@
+//--------------------------------------------------------------------------------------
+// File: PerThreadSegmentsTest.cpp
+//
+// Checks that PerThreadSegments gives every thread its own segment, reports the segments
+// used in a generation in the order threads first asked for them, and frees idle ones.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHarness.h"
+
+#include "PerThreadSegments.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+using namespace DirectX;
+using namespace DirectX::Tests;
+
+namespace
+{
+    struct Segment
+    {
+        std::vector<uint32_t> values;
+    };
+
+    // Counts the live segments, to see which ones NextGeneration frees.
+    struct CountedSegment
+    {
+        static std::atomic<int> live;
+
+        CountedSegment() noexcept { live++; }
+        ~CountedSegment() { live--; }
+
+        CountedSegment(CountedSegment const&) = delete;
+        CountedSegment& operator= (CountedSegment const&) = delete;
+    };
+
+    std::atomic<int> CountedSegment::live(0);
+
+
+    // Each thread's values encode the thread and the position, so misplaced ones are easy to spot.
+    uint32_t MakeValue(size_t thread, size_t index) noexcept
+    {
+        return static_cast<uint32_t>((thread << 20) | index);
+    }
+
+
+    // Runs one thread per entry of turnOrder, each appending valueCount values. Thread
+    // turnOrder[k] makes its first append only after thread turnOrder[k - 1] has, so the order of
+    // first use is known, and the rest of the appends race freely.
+    void Record(PerThreadSegments<Segment>& segments, std::vector<size_t> const& turnOrder, size_t valueCount)
+    {
+        std::atomic<size_t> turn(0);
+
+        std::vector<std::thread> threads;
+
+        for (size_t thread = 0; thread < turnOrder.size(); thread++)
+        {
+            threads.emplace_back([&, thread]()
+                {
+                    const size_t myTurn = static_cast<size_t>(std::find(turnOrder.begin(), turnOrder.end(), thread) - turnOrder.begin());
+
+                    while (turn.load() != myTurn)
+                    {
+                        std::this_thread::yield();
+                    }
+
+                    segments.Get().values.push_back(MakeValue(thread, 0));
+
+                    turn++;
+
+                    for (size_t i = 1; i < valueCount; i++)
+                    {
+                        segments.Get().values.push_back(MakeValue(thread, i));
+                    }
+                });
+        }
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+
+    bool CheckOrder(PerThreadSegments<Segment>& segments, std::vector<size_t> const& turnOrder, size_t valueCount, const char* context)
+    {
+        size_t position = 0;
+        bool ok = true;
+
+        segments.ForEachActive([&](Segment& segment)
+            {
+                if (!ok)
+                    return;
+
+                if (position >= turnOrder.size() || segment.values.size() != valueCount)
+                {
+                    printf("ERROR: %s: segment %zu of %zu holds %zu values\n", context, position, turnOrder.size(), segment.values.size());
+                    ok = false;
+                    return;
+                }
+
+                for (size_t i = 0; i < valueCount; i++)
+                {
+                    if (segment.values[i] != MakeValue(turnOrder[position], i))
+                    {
+                        printf("ERROR: %s: segment %zu value %zu is %08X, expected thread %zu\n", context, position, i, segment.values[i], turnOrder[position]);
+                        ok = false;
+                        return;
+                    }
+                }
+
+                // Consumed, as SpriteBatch does when it merges a segment.
+                segment.values.clear();
+                position++;
+            });
+
+        if (ok && position != turnOrder.size())
+        {
+            printf("ERROR: %s: %zu active segments, expected %zu\n", context, position, turnOrder.size());
+            ok = false;
+        }
+
+        return ok;
+    }
+}
+
+
+TEST_CASE(PerThreadSegmentsFirstUseOrder)
+{
+    PerThreadSegments<Segment> segments;
+
+    const std::vector<std::vector<size_t>> turnOrders =
+    {
+        { 0 },
+        { 0, 1, 2, 3 },
+        { 3, 2, 1, 0 },
+        { 5, 0, 7, 2, 6, 1, 4, 3 },
+    };
+
+    for (size_t generation = 0; generation < turnOrders.size(); generation++)
+    {
+        segments.NextGeneration();
+
+        Record(segments, turnOrders[generation], 5000);
+
+        char context[64];
+        snprintf(context, sizeof(context), "generation %zu", generation);
+
+        if (!CheckOrder(segments, turnOrders[generation], 5000, context))
+            return false;
+    }
+
+    return true;
+}
+
+
+TEST_CASE(PerThreadSegmentsGenerations)
+{
+    PerThreadSegments<Segment> segments;
+
+    segments.NextGeneration();
+
+    Segment* first = &segments.Get();
+    CHECK(&segments.Get() == first);
+
+    first->values.push_back(1);
+
+    // A segment is reused in later generations, but only reported once its thread uses it again.
+    segments.NextGeneration();
+
+    size_t active = 0;
+    segments.ForEachActive([&](Segment&) { active++; });
+    CHECK(active == 0);
+
+    CHECK(&segments.Get() == first);
+
+    Segment* reported = nullptr;
+    segments.ForEachActive([&](Segment& segment) { active++; reported = &segment; });
+    CHECK(active == 1);
+    CHECK(reported == first);
+
+    return true;
+}
+
+
+TEST_CASE(PerThreadSegmentsSeveralInstances)
+{
+    // The thread-local cache is shared by every instance, so switching between them must not
+    // hand one instance's segment to another.
+    auto a = std::make_unique<PerThreadSegments<Segment>>();
+    auto b = std::make_unique<PerThreadSegments<Segment>>();
+
+    a->NextGeneration();
+    b->NextGeneration();
+
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        a->Get().values.push_back(i);
+        b->Get().values.push_back(100 + i);
+    }
+
+    CHECK(&a->Get() != &b->Get());
+
+    std::vector<uint32_t> valuesA, valuesB;
+    a->ForEachActive([&](Segment& segment) { valuesA = segment.values; });
+    b->ForEachActive([&](Segment& segment) { valuesB = segment.values; });
+
+    CHECK(valuesA.size() == 10 && valuesA[9] == 9);
+    CHECK(valuesB.size() == 10 && valuesB[9] == 109);
+
+    // A new instance, possibly at the same address, must not pick up the old cache entry.
+    a.reset();
+    a = std::make_unique<PerThreadSegments<Segment>>();
+    a->NextGeneration();
+
+    CHECK(a->Get().values.empty());
+
+    return true;
+}
+
+
+TEST_CASE(PerThreadSegmentsFreesIdleSegments)
+{
+    PerThreadSegments<CountedSegment> segments;
+
+    segments.NextGeneration();
+
+    CountedSegment* mine = &segments.Get();
+
+    std::vector<std::thread> threads;
+
+    for (size_t thread = 0; thread < 4; thread++)
+    {
+        threads.emplace_back([&]() { segments.Get(); });
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    CHECK(CountedSegment::live == 5);
+
+    // Every segment was used in the generation that just ended, so all of them are kept.
+    segments.NextGeneration();
+    CHECK(CountedSegment::live == 5);
+
+    CHECK(&segments.Get() == mine);
+
+    // The other threads have gone, so their segments are freed, and this thread keeps its own.
+    segments.NextGeneration();
+    CHECK(CountedSegment::live == 1);
+
+    CHECK(&segments.Get() == mine);
+
+    return true;
+}
@@ -0,0 +1,208 @@
+//--------------------------------------------------------------------------------------
+// File: PrimitiveBatchTest.cpp
+//
+// Checks that PrimitiveBatch draws exactly the vertices its indices select, with 32-bit
+// indices and while its buffers grow from 16-bit to 32-bit index rings.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "DeviceTest.h"
+
+#include "PrimitiveBatch.h"
+
+#include <random>
+
+using namespace DirectX;
+using namespace DirectX::Tests;
+
+namespace
+{
+    using Batch = PrimitiveBatch<VertexPositionColorTexture>;
+
+
+    // Vertices that are all different, so the captured triangles show which index was used.
+    std::vector<VertexPositionColorTexture> MakeVertices(size_t count, float tag)
+    {
+        std::vector<VertexPositionColorTexture> vertices(count);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            vertices[i].position = XMFLOAT3(float(i % 1024), float(i / 1024), tag);
+            vertices[i].color = XMFLOAT4(float(i & 0xff) / 255.f, float((i >> 8) & 0xff) / 255.f, float(i >> 16) / 255.f, 1.f);
+            vertices[i].textureCoordinate = XMFLOAT2(float(i), tag);
+        }
+
+        return vertices;
+    }
+
+
+    template<typename TIndex>
+    std::vector<TIndex> MakeIndices(size_t count, size_t vertexCount, std::mt19937& rng)
+    {
+        std::uniform_int_distribution<size_t> index(0, vertexCount - 1);
+
+        std::vector<TIndex> indices(count);
+
+        for (auto& i : indices)
+        {
+            i = static_cast<TIndex>(index(rng));
+        }
+
+        // Always reach the last vertex, which is past 65535 in the 32-bit cases.
+        indices[count / 2] = static_cast<TIndex>(vertexCount - 1);
+
+        return indices;
+    }
+
+
+    // The triangle list vertices the draw should produce.
+    template<typename TIndex>
+    void AppendExpected(std::vector<VertexPositionColorTexture>& expected,
+        std::vector<TIndex> const& indices,
+        std::vector<VertexPositionColorTexture> const& vertices)
+    {
+        for (const auto i : indices)
+        {
+            expected.push_back(vertices[i]);
+        }
+    }
+}
+
+
+TEST_CASE(PrimitiveBatch32BitIndices)
+{
+    TestDevice test;
+
+    if (!CreateTestDevice(test))
+        return false;
+
+    auto context = test.context.Get();
+
+    constexpr size_t VertexCount = 100000;
+    constexpr size_t IndexCount = 3 * 60000;
+
+    VertexCapture capture(test.device.Get(), IndexCount + 3 * 1000);
+
+    // maxVertices above 65536 selects a 32-bit index buffer. A single draw must stay below both limits.
+    Batch batch(context, IndexCount + 1, VertexCount + 1);
+
+    std::mt19937 rng(14);
+
+    const auto bigVertices = MakeVertices(VertexCount, 1.f);
+    const auto bigIndices = MakeIndices<uint32_t>(IndexCount, VertexCount, rng);
+
+    const auto smallVertices = MakeVertices(500, 2.f);
+    const auto smallIndices = MakeIndices<uint16_t>(3 * 1000, smallVertices.size(), rng);
+
+    // The second frame starts with a 16-bit draw, so the large one that follows no longer fits
+    // and wraps the rings, and both index types share the 32-bit buffer.
+    for (int frame = 0; frame < 3; frame++)
+    {
+        std::vector<VertexPositionColorTexture> expected;
+
+        context->IASetInputLayout(capture.GetInputLayout());
+
+        auto setShaders = capture.Begin(context);
+
+        setShaders();
+
+        batch.Begin();
+
+        if (frame > 0)
+        {
+            batch.DrawIndexed(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST, smallIndices.data(), smallIndices.size(), smallVertices.data(), smallVertices.size());
+            AppendExpected(expected, smallIndices, smallVertices);
+        }
+
+        batch.DrawIndexed(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST, bigIndices.data(), bigIndices.size(), bigVertices.data(), bigVertices.size());
+        AppendExpected(expected, bigIndices, bigVertices);
+
+        batch.End();
+
+        const auto actual = capture.End(context);
+
+        char description[32];
+        snprintf(description, sizeof(description), "frame %d", frame);
+
+        if (!CompareVertices(expected, actual, description))
+            return false;
+    }
+
+    return true;
+}
+
+
+TEST_CASE(PrimitiveBatchRingGrowth)
+{
+    TestDevice test;
+
+    if (!CreateTestDevice(test))
+        return false;
+
+    auto context = test.context.Get();
+
+    // Small enough to start with 16-bit indices, but the ring may grow sixteen-fold, past 65536
+    // vertices, which switches it to 32-bit indices.
+    constexpr size_t MaxVertices = 8192;
+    constexpr size_t MaxIndices = 3 * MaxVertices / 2;
+
+    constexpr size_t DrawVertices = 1000;
+    constexpr size_t DrawIndices = 1500;
+    constexpr size_t DrawsPerFrame = 100;
+
+    VertexCapture capture(test.device.Get(), DrawIndices * DrawsPerFrame);
+
+    Batch batch(context, MaxIndices, MaxVertices);
+
+    std::mt19937 rng(15);
+
+    std::vector<std::vector<VertexPositionColorTexture>> vertices;
+    std::vector<std::vector<uint16_t>> indices;
+
+    for (size_t draw = 0; draw < DrawsPerFrame; draw++)
+    {
+        vertices.push_back(MakeVertices(DrawVertices, float(draw)));
+        indices.push_back(MakeIndices<uint16_t>(DrawIndices, DrawVertices, rng));
+    }
+
+    std::vector<VertexPositionColorTexture> expected;
+
+    for (size_t draw = 0; draw < DrawsPerFrame; draw++)
+    {
+        AppendExpected(expected, indices[draw], vertices[draw]);
+    }
+
+    // The first frame wraps the small rings many times and makes them grow at End. Later frames
+    // use the larger buffers, with the 16-bit indices widened as they are copied.
+    for (int frame = 0; frame < 4; frame++)
+    {
+        context->IASetInputLayout(capture.GetInputLayout());
+
+        auto setShaders = capture.Begin(context);
+
+        setShaders();
+
+        batch.Begin();
+
+        for (size_t draw = 0; draw < DrawsPerFrame; draw++)
+        {
+            batch.DrawIndexed(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST, indices[draw].data(), DrawIndices, vertices[draw].data(), DrawVertices);
+        }
+
+        batch.End();
+
+        const auto actual = capture.End(context);
+
+        char description[32];
+        snprintf(description, sizeof(description), "frame %d", frame);
+
+        if (!CompareVertices(expected, actual, description))
+            return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,183 @@
+//--------------------------------------------------------------------------------------
+// File: QuaternionStreamBenchmark.cpp
+//
+// Times quaternion interpolation and blending over component streams, with each instruction
+// set's kernels, against calling Quaternion::Lerp and Quaternion::Slerp once per rotation.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHarness.h"
+#include "SimdTestLevels.h"
+
+#include "SimpleMath.h"
+#include "VectorStream.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+using namespace DirectX::SimpleMath;
+using namespace DirectX::Tests;
+
+namespace
+{
+    constexpr size_t BlendPoses = 4;
+
+
+    struct Rotations
+    {
+        std::vector<Quaternion> quaternions;
+        std::vector<float> c[4];
+
+        Rotations(std::mt19937& rng, size_t count)
+        {
+            std::normal_distribution<float> component;
+
+            quaternions.resize(count);
+
+            for (auto& v : c)
+            {
+                v.resize(count);
+            }
+
+            for (size_t i = 0; i < count; i++)
+            {
+                Quaternion q(component(rng), component(rng), component(rng), component(rng));
+                q.Normalize();
+
+                quaternions[i] = q;
+                c[0][i] = q.x;
+                c[1][i] = q.y;
+                c[2][i] = q.z;
+                c[3][i] = q.w;
+            }
+        }
+
+        VectorStream::StreamInput Input() const noexcept { return { { c[0].data(), c[1].data(), c[2].data(), c[3].data() } }; }
+        VectorStream::StreamOutput Output() noexcept { return { { c[0].data(), c[1].data(), c[2].data(), c[3].data() } }; }
+    };
+}
+
+
+BENCHMARK(QuaternionStreamInterpolation)
+{
+    const auto levels = GetTestedSimdLevels();
+
+    for (const size_t count : { size_t(1) << 12, size_t(1) << 20 })
+    {
+        std::mt19937 rng(static_cast<uint32_t>(count));
+
+        const Rotations q1(rng, count);
+        const Rotations q2(rng, count);
+        Rotations result(rng, count);
+
+        std::vector<Rotations> poses;
+        std::vector<VectorStream::StreamInput> inputs;
+
+        for (size_t p = 0; p < BlendPoses; p++)
+        {
+            poses.emplace_back(rng, count);
+        }
+
+        for (auto const& pose : poses)
+        {
+            inputs.push_back(pose.Input());
+        }
+
+        const float weights[BlendPoses] = { 0.4f, 0.3f, 0.2f, 0.1f };
+
+        // About 16M rotations per measurement, however long the arrays are.
+        const size_t iterations = std::max<size_t>(1, (size_t(1) << 24) / count);
+
+        char label[32];
+        snprintf(label, sizeof(label), "%zu rotations", count);
+
+        printf("%-17s", label);
+
+        for (const SimdLevel level : levels)
+        {
+            printf(" %12s", GetSimdLevelName(level));
+        }
+
+        printf("   (ns per rotation)\n");
+
+        const double lerp = MeasureNanoseconds(iterations, [&]()
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    result.quaternions[i] = Quaternion::Lerp(q1.quaternions[i], q2.quaternions[i], 0.3f);
+                }
+            });
+
+        const double slerp = MeasureNanoseconds(iterations, [&]()
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    result.quaternions[i] = Quaternion::Slerp(q1.quaternions[i], q2.quaternions[i], 0.3f);
+                }
+            });
+
+        KeepResult(static_cast<uint64_t>(result.quaternions[count / 2].x * 1000.f));
+
+        printf("  one at a time: Lerp %.3f, Slerp %.3f\n", lerp / double(count), slerp / double(count));
+
+        struct Kernel
+        {
+            char const* name;
+            VectorStream::InterpolateKernel VectorStream::StreamKernels::* kernel;
+        };
+
+        const Kernel kernels[] =
+        {
+            { "Lerp", &VectorStream::StreamKernels::quaternionLerp },
+            { "Slerp", &VectorStream::StreamKernels::quaternionSlerp },
+            { "FastSlerp", &VectorStream::StreamKernels::quaternionFastSlerp },
+        };
+
+        for (auto const& kernel : kernels)
+        {
+            printf("  %-15s", kernel.name);
+
+            for (const SimdLevel level : levels)
+            {
+                const auto function = VectorStream::GetStreamKernels(level).*kernel.kernel;
+
+                const double time = MeasureNanoseconds(iterations, [&]()
+                    {
+                        function(q1.Input(), q2.Input(), count, 0.3f, result.Output());
+                    });
+
+                printf(" %12.3f", time / double(count));
+            }
+
+            printf("\n");
+        }
+
+        snprintf(label, sizeof(label), "Blend %zu poses", BlendPoses);
+
+        printf("  %-15s", label);
+
+        for (const SimdLevel level : levels)
+        {
+            const auto blend = VectorStream::GetStreamKernels(level).quaternionBlend;
+
+            const double time = MeasureNanoseconds(iterations, [&]()
+                {
+                    blend(inputs.data(), weights, BlendPoses, count, result.Output());
+                });
+
+            printf(" %12.3f", time / double(count));
+        }
+
+        KeepResult(static_cast<uint64_t>(result.c[0][count / 2] * 1000.f));
+
+        printf("\n\n");
+    }
+
+    return true;
+}
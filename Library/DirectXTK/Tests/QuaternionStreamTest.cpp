@@ -0,0 +1,537 @@
+//--------------------------------------------------------------------------------------
+// File: QuaternionStreamTest.cpp
+//
+// Checks quaternion Lerp, Slerp, FastSlerp and Blend over component streams, for every
+// instruction set this CPU runs, against slerp evaluated in double precision and against
+// XMQuaternionSlerp. Errors are the angle between the rotations, in radians.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHarness.h"
+#include "SimdTestLevels.h"
+
+#include "SimpleMath.h"
+#include "VectorStream.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+using namespace DirectX::SimpleMath;
+using namespace DirectX::Tests;
+using namespace DirectX::VectorStream;
+
+namespace
+{
+    // Slerp is within this of the exact rotation, and of XMQuaternionSlerp, which rounds its
+    // angle and sines about as much. Lerp and Blend only add a normalize to a few products.
+    constexpr double SlerpTolerance = 1e-6;
+    constexpr double XMSlerpTolerance = 2e-6;
+    constexpr double NormalizeTolerance = 1e-6;
+
+    // The bound Quaternion::FastSlerp documents.
+    constexpr double FastSlerpTolerance = 1e-3;
+
+    // Slerp falls back to linear weights without normalizing, as XMQuaternionSlerp does, when the
+    // rotations are within about 0.009 radians. At most this much is lost from the length there.
+    constexpr double SlerpLengthTolerance = 4e-6;
+
+
+    struct QuaternionStream
+    {
+        std::vector<float> c[4];
+
+        explicit QuaternionStream(size_t count)
+        {
+            for (auto& component : c)
+            {
+                component.resize(count);
+            }
+        }
+
+        StreamInput Input() const noexcept { return { { c[0].data(), c[1].data(), c[2].data(), c[3].data() } }; }
+        StreamOutput Output() noexcept { return { { c[0].data(), c[1].data(), c[2].data(), c[3].data() } }; }
+
+        XMVECTOR Get(size_t i) const noexcept { return XMVectorSet(c[0][i], c[1][i], c[2][i], c[3][i]); }
+
+        void Set(size_t i, double const* q) noexcept
+        {
+            for (size_t j = 0; j < 4; j++)
+            {
+                c[j][i] = static_cast<float>(q[j]);
+            }
+        }
+
+        void Get(size_t i, double* q) const noexcept
+        {
+            for (size_t j = 0; j < 4; j++)
+            {
+                q[j] = c[j][i];
+            }
+        }
+    };
+
+
+    double Dot(double const* a, double const* b) noexcept
+    {
+        return a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+    }
+
+    void Normalize(double* q) noexcept
+    {
+        const double length = std::sqrt(Dot(q, q));
+
+        for (size_t j = 0; j < 4; j++)
+        {
+            q[j] /= length;
+        }
+    }
+
+
+    // The angle between the rotations a and b, whatever their lengths, accurate for small angles
+    // where acos of their dot product would not be.
+    double RotationAngle(double const* a, double const* b) noexcept
+    {
+        double na[4] = { a[0], a[1], a[2], a[3] };
+        double nb[4] = { b[0], b[1], b[2], b[3] };
+        Normalize(na);
+        Normalize(nb);
+
+        const double sign = (Dot(na, nb) < 0) ? -1.0 : 1.0;
+
+        double distance = 0;
+
+        for (size_t j = 0; j < 4; j++)
+        {
+            const double d = na[j] - sign * nb[j];
+            distance += d * d;
+        }
+
+        return 4.0 * std::asin(std::min(1.0, std::sqrt(distance) * 0.5));
+    }
+
+
+    // Slerp along the shorter arc, in double precision.
+    void ReferenceSlerp(double const* a, double const* b, double t, double* result) noexcept
+    {
+        const double dot = Dot(a, b);
+        const double sign = (dot < 0) ? -1.0 : 1.0;
+        const double omega = std::acos(std::min(1.0, std::fabs(dot)));
+
+        double s0 = 1.0 - t;
+        double s1 = t;
+
+        if (omega > 1e-12)
+        {
+            s0 = std::sin((1.0 - t) * omega) / std::sin(omega);
+            s1 = std::sin(t * omega) / std::sin(omega);
+        }
+
+        for (size_t j = 0; j < 4; j++)
+        {
+            result[j] = s0 * a[j] + sign * s1 * b[j];
+        }
+
+        Normalize(result);
+    }
+
+
+    void ReferenceLerp(double const* a, double const* b, double t, double* result) noexcept
+    {
+        const double sign = (Dot(a, b) < 0) ? -1.0 : 1.0;
+
+        for (size_t j = 0; j < 4; j++)
+        {
+            result[j] = (1.0 - t) * a[j] + sign * t * b[j];
+        }
+
+        Normalize(result);
+    }
+
+
+    void RandomRotation(std::mt19937& rng, double* q)
+    {
+        std::normal_distribution<double> component;
+
+        for (size_t j = 0; j < 4; j++)
+        {
+            q[j] = component(rng);
+        }
+
+        Normalize(q);
+    }
+
+
+    // Pairs of unit quaternions: random, nearly parallel either side of where Slerp switches to
+    // linear weights, in opposite hemispheres, equal, opposite and nearly perpendicular.
+    void MakePairs(std::mt19937& rng, size_t count, QuaternionStream& q1, QuaternionStream& q2)
+    {
+        std::uniform_real_distribution<double> exponent(-7.0, -1.0);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            double a[4], b[4];
+            RandomRotation(rng, a);
+            RandomRotation(rng, b);
+
+            switch (i % 8)
+            {
+            case 1:
+            case 2:
+            case 6:
+            {
+                // b is a turned a little way from a, within the plane they span, or turned nearly a
+                // right angle. Exactly a right angle is left out, since either arc is then as short
+                // and rounding decides which one is taken.
+                const double angle = (i % 8 == 6) ? 1.5707963 + ((i & 8) ? 1e-3 : -1e-3) : std::pow(10.0, exponent(rng));
+                const double along = Dot(a, b);
+
+                for (size_t j = 0; j < 4; j++)
+                {
+                    b[j] -= along * a[j];
+                }
+
+                Normalize(b);
+
+                for (size_t j = 0; j < 4; j++)
+                {
+                    b[j] = std::cos(angle) * a[j] + std::sin(angle) * b[j];
+                }
+                break;
+            }
+
+            case 3:
+                if (Dot(a, b) > 0)
+                {
+                    for (auto& c : b) c = -c;
+                }
+                break;
+
+            case 4:
+                std::memcpy(b, a, sizeof(b));
+                break;
+
+            case 5:
+                for (size_t j = 0; j < 4; j++) b[j] = -a[j];
+                break;
+
+            default:
+                break;
+            }
+
+            q1.Set(i, a);
+            q2.Set(i, b);
+        }
+    }
+
+
+    double LengthError(double const* q) noexcept
+    {
+        return std::fabs(std::sqrt(Dot(q, q)) - 1.0);
+    }
+
+
+    const size_t TestCounts[] = { 0, 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 33, 1003 };
+    const float TestTimes[] = { 0.f, 0.1f, 0.5f, 0.75f, 1.f };
+
+
+    // Runs kernel on q1 and q2, and checks each result against expected within tolerance, and
+    // that its length is within lengthTolerance of 1.
+    template<typename TExpected>
+    bool CheckInterpolation(InterpolateKernel kernel, QuaternionStream const& q1, QuaternionStream const& q2, size_t count, float t,
+        TExpected expected, double tolerance, double lengthTolerance, char const* description)
+    {
+        QuaternionStream out(count);
+        kernel(q1.Input(), q2.Input(), count, t, out.Output());
+
+        for (size_t i = 0; i < count; i++)
+        {
+            double a[4], b[4], actual[4], reference[4];
+            q1.Get(i, a);
+            q2.Get(i, b);
+            out.Get(i, actual);
+
+            expected(a, b, t, i, reference);
+
+            const double error = RotationAngle(actual, reference);
+
+            if (!(error <= tolerance) || !(LengthError(actual) <= lengthTolerance))
+            {
+                printf("ERROR: %s, %zu quaternions, t = %g: result %zu is %g radians out, with length %.9g\n",
+                    description, count, t, i, error, std::sqrt(Dot(actual, actual)));
+                return false;
+            }
+        }
+
+        // Written over either input, which gives the same results.
+        QuaternionStream inPlace = q1;
+        kernel(inPlace.Input(), q2.Input(), count, t, inPlace.Output());
+
+        for (size_t j = 0; j < 4; j++)
+        {
+            if (inPlace.c[j] != out.c[j])
+            {
+                printf("ERROR: %s, %zu quaternions, t = %g: results differ when written over q1\n", description, count, t);
+                return false;
+            }
+        }
+
+        inPlace = q2;
+        kernel(q1.Input(), inPlace.Input(), count, t, inPlace.Output());
+
+        for (size_t j = 0; j < 4; j++)
+        {
+            if (inPlace.c[j] != out.c[j])
+            {
+                printf("ERROR: %s, %zu quaternions, t = %g: results differ when written over q2\n", description, count, t);
+                return false;
+            }
+        }
+
+        return true;
+    }
+}
+
+
+TEST_CASE(QuaternionStreamInterpolationWithinBounds)
+{
+    std::mt19937 rng(21);
+
+    auto reference = [](double const* a, double const* b, double t, size_t, double* result) noexcept
+        {
+            ReferenceSlerp(a, b, t, result);
+        };
+
+    auto lerpReference = [](double const* a, double const* b, double t, size_t, double* result) noexcept
+        {
+            ReferenceLerp(a, b, t, result);
+        };
+
+    for (const SimdLevel level : GetTestedSimdLevels())
+    {
+        auto const& kernels = GetStreamKernels(level);
+        char const* name = GetSimdLevelName(level);
+
+        char description[64];
+
+        for (const size_t count : TestCounts)
+        {
+            QuaternionStream q1(count), q2(count);
+            MakePairs(rng, count, q1, q2);
+
+            for (const float t : TestTimes)
+            {
+                auto xmSlerp = [&](double const*, double const*, double, size_t i, double* result) noexcept
+                    {
+                        XMFLOAT4 q;
+                        XMStoreFloat4(&q, XMQuaternionSlerp(q1.Get(i), q2.Get(i), t));
+
+                        result[0] = q.x;
+                        result[1] = q.y;
+                        result[2] = q.z;
+                        result[3] = q.w;
+                    };
+
+                snprintf(description, sizeof(description), "%s Slerp", name);
+
+                if (!CheckInterpolation(kernels.quaternionSlerp, q1, q2, count, t, reference, SlerpTolerance, SlerpLengthTolerance, description))
+                    return false;
+
+                snprintf(description, sizeof(description), "%s Slerp against XMQuaternionSlerp", name);
+
+                if (!CheckInterpolation(kernels.quaternionSlerp, q1, q2, count, t, xmSlerp, XMSlerpTolerance, SlerpLengthTolerance, description))
+                    return false;
+
+                snprintf(description, sizeof(description), "%s FastSlerp", name);
+
+                if (!CheckInterpolation(kernels.quaternionFastSlerp, q1, q2, count, t, reference, FastSlerpTolerance, NormalizeTolerance, description))
+                    return false;
+
+                snprintf(description, sizeof(description), "%s Lerp", name);
+
+                if (!CheckInterpolation(kernels.quaternionLerp, q1, q2, count, t, lerpReference, NormalizeTolerance, NormalizeTolerance, description))
+                    return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+TEST_CASE(QuaternionStreamBlendWithinBounds)
+{
+    std::mt19937 rng(22);
+
+    for (const SimdLevel level : GetTestedSimdLevels())
+    {
+        auto const& kernels = GetStreamKernels(level);
+
+        for (const size_t poseCount : { size_t(0), size_t(1), size_t(2), size_t(5) })
+        {
+            for (const size_t count : TestCounts)
+            {
+                std::vector<QuaternionStream> poses(poseCount, QuaternionStream(count));
+                std::vector<StreamInput> inputs;
+                std::vector<float> weights;
+
+                std::uniform_real_distribution<float> weight(0.f, 1.f);
+
+                for (size_t p = 0; p < poseCount; p++)
+                {
+                    for (size_t i = 0; i < count; i++)
+                    {
+                        double q[4];
+                        RandomRotation(rng, q);
+                        poses[p].Set(i, q);
+                    }
+
+                    inputs.push_back(poses[p].Input());
+                    weights.push_back((p == 0) ? 1.f : weight(rng));
+                }
+
+                // Poses that are the same rotation but opposite signs must not cancel.
+                if (poseCount > 1)
+                {
+                    for (size_t i = 0; i < count; i += 3)
+                    {
+                        for (size_t j = 0; j < 4; j++)
+                        {
+                            poses[1].c[j][i] = -poses[0].c[j][i];
+                        }
+                    }
+                }
+
+                QuaternionStream out(count);
+
+                // No poses leaves the results untouched.
+                for (auto& c : out.c)
+                {
+                    std::fill(c.begin(), c.end(), 2.f);
+                }
+
+                kernels.quaternionBlend(inputs.data(), weights.data(), poseCount, count, out.Output());
+
+                for (size_t i = 0; i < count; i++)
+                {
+                    double actual[4];
+                    out.Get(i, actual);
+
+                    if (!poseCount)
+                    {
+                        CHECK(actual[0] == 2 && actual[1] == 2 && actual[2] == 2 && actual[3] == 2);
+                        continue;
+                    }
+
+                    double first[4], expected[4] = {};
+                    poses[0].Get(i, first);
+
+                    for (size_t p = 0; p < poseCount; p++)
+                    {
+                        double q[4];
+                        poses[p].Get(i, q);
+
+                        const double sign = (Dot(first, q) < 0) ? -1.0 : 1.0;
+
+                        for (size_t j = 0; j < 4; j++)
+                        {
+                            expected[j] += sign * weights[p] * q[j];
+                        }
+                    }
+
+                    const double error = RotationAngle(actual, expected);
+
+                    if (!(error <= NormalizeTolerance) || !(LengthError(actual) <= NormalizeTolerance))
+                    {
+                        printf("ERROR: %s Blend, %zu poses, %zu quaternions: result %zu is %g radians out, with length %.9g\n",
+                            GetSimdLevelName(level), poseCount, count, i, error, std::sqrt(Dot(actual, actual)));
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+
+TEST_CASE(QuaternionStreamsMatchKernels)
+{
+    // The public functions use the kernels for this CPU, so they give exactly the same results.
+    std::mt19937 rng(23);
+
+    constexpr size_t count = 1003;
+
+    QuaternionStream q1(count), q2(count);
+    MakePairs(rng, count, q1, q2);
+
+    auto const& kernels = GetStreamKernels();
+
+    const ConstVector4Stream in1(q1.c[0].data(), q1.c[1].data(), q1.c[2].data(), q1.c[3].data());
+    const ConstVector4Stream in2(q2.c[0].data(), q2.c[1].data(), q2.c[2].data(), q2.c[3].data());
+
+    auto matches = [&](InterpolateKernel kernel, void (*function)(const ConstVector4Stream&, const ConstVector4Stream&, size_t, float, const Vector4Stream&))
+        {
+            QuaternionStream expected(count), actual(count);
+            kernel(q1.Input(), q2.Input(), count, 0.3f, expected.Output());
+            function(in1, in2, count, 0.3f, Vector4Stream(actual.c[0].data(), actual.c[1].data(), actual.c[2].data(), actual.c[3].data()));
+
+            for (size_t j = 0; j < 4; j++)
+            {
+                if (actual.c[j] != expected.c[j])
+                    return false;
+            }
+
+            return true;
+        };
+
+    CHECK(matches(kernels.quaternionLerp, Quaternion::Lerp));
+    CHECK(matches(kernels.quaternionSlerp, Quaternion::Slerp));
+    CHECK(matches(kernels.quaternionFastSlerp, Quaternion::FastSlerp));
+
+    const ConstVector4Stream poses[] = { in1, in2 };
+    const float weights[] = { 0.7f, 0.3f };
+
+    QuaternionStream expected(count), actual(count);
+    kernels.quaternionBlend(std::vector<StreamInput>{ q1.Input(), q2.Input() }.data(), weights, 2, count, expected.Output());
+    Quaternion::Blend(poses, weights, 2, count, Vector4Stream(actual.c[0].data(), actual.c[1].data(), actual.c[2].data(), actual.c[3].data()));
+
+    for (size_t j = 0; j < 4; j++)
+    {
+        CHECK(actual.c[j] == expected.c[j]);
+    }
+
+    // The single Lerp and Slerp, within the same bounds.
+    for (size_t i = 0; i < count; i++)
+    {
+        const Quaternion a(q1.c[0][i], q1.c[1][i], q1.c[2][i], q1.c[3][i]);
+        const Quaternion b(q2.c[0][i], q2.c[1][i], q2.c[2][i], q2.c[3][i]);
+
+        const Quaternion lerp = Quaternion::Lerp(a, b, 0.3f);
+        const Quaternion slerp = Quaternion::Slerp(a, b, 0.3f);
+
+        QuaternionStream one(1);
+
+        double single[4], stream[4];
+
+        Quaternion::Lerp(ConstVector4Stream(&a.x, &a.y, &a.z, &a.w), ConstVector4Stream(&b.x, &b.y, &b.z, &b.w), 1, 0.3f, Vector4Stream(&one.c[0][0], &one.c[1][0], &one.c[2][0], &one.c[3][0]));
+        one.Get(0, stream);
+        single[0] = lerp.x; single[1] = lerp.y; single[2] = lerp.z; single[3] = lerp.w;
+        CHECK(RotationAngle(single, stream) <= NormalizeTolerance);
+
+        Quaternion::Slerp(ConstVector4Stream(&a.x, &a.y, &a.z, &a.w), ConstVector4Stream(&b.x, &b.y, &b.z, &b.w), 1, 0.3f, Vector4Stream(&one.c[0][0], &one.c[1][0], &one.c[2][0], &one.c[3][0]));
+        one.Get(0, stream);
+        single[0] = slerp.x; single[1] = slerp.y; single[2] = slerp.z; single[3] = slerp.w;
+        CHECK(RotationAngle(single, stream) <= XMSlerpTolerance);
+    }
+
+    return true;
+}
@@ -0,0 +1,87 @@
+//--------------------------------------------------------------------------------------
+// File: RadixSortBenchmark.cpp
+//
+// Times the SpriteBatch depth sort: the previous std::sort over queue indices, a
+// std::stable_sort with the same comparison, and key extraction plus radix sort.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHarness.h"
+
+#include "RadixSort.h"
+
+#include <numeric>
+#include <random>
+
+using namespace DirectX;
+using namespace DirectX::Tests;
+
+
+BENCHMARK(RadixSortBackToFront)
+{
+    using SortKey = RadixSort::KeyIndex<uint64_t>;
+
+    printf("%10s %14s %14s %14s   (ns per sprite)\n", "sprites", "std::sort", "stable_sort", "radix");
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> value(0.f, 1.f);
+
+    for (const size_t count : { size_t(256), size_t(2048), size_t(16384), size_t(131072) })
+    {
+        std::vector<float> depths(count);
+
+        for (auto& depth : depths)
+        {
+            depth = value(rng);
+        }
+
+        const size_t iterations = std::max<size_t>(1, (1u << 22) / count);
+
+        std::vector<uint32_t> order(count);
+
+        const auto backToFront = [&](uint32_t x, uint32_t y) { return depths[x] > depths[y]; };
+
+        const double sortTime = MeasureNanoseconds(iterations, [&]()
+            {
+                std::iota(order.begin(), order.end(), 0u);
+                std::sort(order.begin(), order.end(), backToFront);
+                KeepResult(order[0]);
+            });
+
+        const double stableTime = MeasureNanoseconds(iterations, [&]()
+            {
+                std::iota(order.begin(), order.end(), 0u);
+                std::stable_sort(order.begin(), order.end(), backToFront);
+                KeepResult(order[0]);
+            });
+
+        std::vector<SortKey> keys(count);
+        std::vector<SortKey> scratch(count);
+
+        const double radixTime = MeasureNanoseconds(iterations, [&]()
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    keys[i] = { ~RadixSort::FloatToSortableKey(depths[i]), static_cast<uint32_t>(i) };
+                }
+
+                SortKey const* sorted = RadixSort::Sort(keys.data(), scratch.data(), count, sizeof(uint32_t));
+
+                for (size_t i = 0; i < count; i++)
+                {
+                    order[i] = sorted[i].index;
+                }
+
+                KeepResult(order[0]);
+            });
+
+        printf("%10zu %14.2f %14.2f %14.2f\n", count,
+            sortTime / double(count), stableTime / double(count), radixTime / double(count));
+    }
+
+    return true;
+}
@@ -0,0 +1,243 @@
+//--------------------------------------------------------------------------------------
+// File: RadixSortTest.cpp
+//
+// Checks the SpriteBatch radix sort against the std::stable_sort order of the comparisons
+// SpriteBatch used before it switched to sort keys.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHarness.h"
+
+#include "RadixSort.h"
+
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <random>
+
+using namespace DirectX;
+using namespace DirectX::Tests;
+
+namespace
+{
+    using SortKey = RadixSort::KeyIndex<uint64_t>;
+
+    // Queue sizes either side of the insertion sort cutoff, plus some full radix sizes.
+    const size_t TestSizes[] = { 0, 1, 2, 3, 63, 64, 65, 127, 1000, 2048, 5000 };
+
+
+    // Sorts keys the way SpriteBatch::Impl::SortSpritesByKey does, returning the queue order.
+    std::vector<uint32_t> RadixOrder(std::vector<SortKey> keys, size_t keyBytes)
+    {
+        std::vector<SortKey> scratch(keys.size());
+
+        SortKey const* sorted = RadixSort::Sort(keys.data(), scratch.data(), keys.size(), keyBytes);
+
+        std::vector<uint32_t> order(keys.size());
+
+        for (size_t i = 0; i < keys.size(); i++)
+        {
+            order[i] = sorted[i].index;
+        }
+
+        return order;
+    }
+
+
+    template<typename TLess>
+    std::vector<uint32_t> StableOrder(size_t count, TLess less)
+    {
+        std::vector<uint32_t> order(count);
+        std::iota(order.begin(), order.end(), 0u);
+        std::stable_sort(order.begin(), order.end(), less);
+        return order;
+    }
+
+
+    // Depths with plenty of ties, both zeros, denormals and infinities mixed in.
+    std::vector<float> MakeDepths(size_t count, std::mt19937& rng)
+    {
+        const float specials[] =
+        {
+            0.f, -0.f, 1.f, -1.f, 0.5f,
+            std::numeric_limits<float>::denorm_min(),
+            -std::numeric_limits<float>::denorm_min(),
+            std::numeric_limits<float>::min(),
+            std::numeric_limits<float>::max(),
+            -std::numeric_limits<float>::max(),
+            std::numeric_limits<float>::infinity(),
+            -std::numeric_limits<float>::infinity(),
+        };
+
+        std::uniform_int_distribution<int> choice(0, 3);
+        std::uniform_int_distribution<size_t> special(0, std::size(specials) - 1);
+        std::uniform_int_distribution<int> layer(0, 15);
+        std::uniform_real_distribution<float> value(-1000.f, 1000.f);
+
+        std::vector<float> depths(count);
+
+        for (auto& depth : depths)
+        {
+            switch (choice(rng))
+            {
+            case 0: depth = specials[special(rng)]; break;
+            case 1: depth = float(layer(rng)) / 16.f; break;
+            default: depth = value(rng); break;
+            }
+        }
+
+        return depths;
+    }
+}
+
+
+TEST_CASE(RadixSortFrontToBackMatchesStableSort)
+{
+    std::mt19937 rng(1);
+
+    for (const size_t count : TestSizes)
+    {
+        const auto depths = MakeDepths(count, rng);
+
+        std::vector<SortKey> keys(count);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            keys[i] = { RadixSort::FloatToSortableKey(depths[i]), static_cast<uint32_t>(i) };
+        }
+
+        const auto expected = StableOrder(count, [&](uint32_t x, uint32_t y) { return depths[x] < depths[y]; });
+
+        CHECK(RadixOrder(keys, sizeof(uint32_t)) == expected);
+    }
+
+    return true;
+}
+
+
+TEST_CASE(RadixSortBackToFrontMatchesStableSort)
+{
+    std::mt19937 rng(2);
+
+    for (const size_t count : TestSizes)
+    {
+        const auto depths = MakeDepths(count, rng);
+
+        std::vector<SortKey> keys(count);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            keys[i] = { ~RadixSort::FloatToSortableKey(depths[i]), static_cast<uint32_t>(i) };
+        }
+
+        const auto expected = StableOrder(count, [&](uint32_t x, uint32_t y) { return depths[x] > depths[y]; });
+
+        CHECK(RadixOrder(keys, sizeof(uint32_t)) == expected);
+    }
+
+    return true;
+}
+
+
+TEST_CASE(RadixSortTextureMatchesStableSort)
+{
+    std::mt19937 rng(3);
+
+    // A handful of heap-like addresses, which share their high bytes and low alignment bits.
+    std::vector<uintptr_t> textures(24);
+
+    for (size_t i = 0; i < textures.size(); i++)
+    {
+        textures[i] = uintptr_t(0x7ff3a0000000ull) + ((rng() & 0xffff) << 4);
+    }
+
+    std::uniform_int_distribution<size_t> pick(0, textures.size() - 1);
+
+    for (const size_t count : TestSizes)
+    {
+        std::vector<uintptr_t> spriteTextures(count);
+        std::vector<SortKey> keys(count);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            spriteTextures[i] = textures[pick(rng)];
+            keys[i] = { spriteTextures[i], static_cast<uint32_t>(i) };
+        }
+
+        const auto expected = StableOrder(count, [&](uint32_t x, uint32_t y) { return spriteTextures[x] < spriteTextures[y]; });
+
+        CHECK(RadixOrder(keys, sizeof(uintptr_t)) == expected);
+    }
+
+    return true;
+}
+
+
+TEST_CASE(RadixSortKeyBytes)
+{
+    std::mt19937_64 rng(4);
+
+    for (size_t keyBytes = 1; keyBytes <= sizeof(uint64_t); keyBytes++)
+    {
+        const uint64_t mask = (keyBytes == sizeof(uint64_t)) ? ~0ull : ((1ull << (keyBytes * 8)) - 1);
+
+        for (const size_t count : TestSizes)
+        {
+            // Small values give ties, and the bytes above keyBytes must be ignored.
+            std::vector<SortKey> keys(count);
+
+            for (size_t i = 0; i < count; i++)
+            {
+                const uint64_t value = (rng() & 1) ? (rng() & 0x1ff) : rng();
+                keys[i] = { value, static_cast<uint32_t>(i) };
+            }
+
+            const auto expected = StableOrder(count, [&](uint32_t x, uint32_t y) { return (keys[x].key & mask) < (keys[y].key & mask); });
+
+            CHECK(RadixOrder(keys, keyBytes) == expected);
+        }
+    }
+
+    return true;
+}
+
+
+TEST_CASE(RadixSortEqualKeysKeepQueueOrder)
+{
+    // Every pass is skipped, so the input must come back untouched.
+    for (const size_t count : TestSizes)
+    {
+        std::vector<SortKey> keys(count);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            keys[i] = { RadixSort::FloatToSortableKey(0.25f), static_cast<uint32_t>(i) };
+        }
+
+        const auto order = RadixOrder(keys, sizeof(uint32_t));
+
+        for (size_t i = 0; i < count; i++)
+        {
+            CHECK(order[i] == i);
+        }
+    }
+
+    return true;
+}
+
+
+TEST_CASE(FloatToSortableKeyOrder)
+{
+    CHECK(RadixSort::FloatToSortableKey(-0.f) == RadixSort::FloatToSortableKey(0.f));
+    CHECK(RadixSort::FloatToSortableKey(-std::numeric_limits<float>::infinity()) < RadixSort::FloatToSortableKey(-1.f));
+    CHECK(RadixSort::FloatToSortableKey(-1.f) < RadixSort::FloatToSortableKey(-std::numeric_limits<float>::denorm_min()));
+    CHECK(RadixSort::FloatToSortableKey(-std::numeric_limits<float>::denorm_min()) < RadixSort::FloatToSortableKey(0.f));
+    CHECK(RadixSort::FloatToSortableKey(0.f) < RadixSort::FloatToSortableKey(std::numeric_limits<float>::denorm_min()));
+    CHECK(RadixSort::FloatToSortableKey(1.f) < RadixSort::FloatToSortableKey(std::numeric_limits<float>::infinity()));
+
+    return true;
+}
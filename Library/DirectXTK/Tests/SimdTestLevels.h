@@ -0,0 +1,51 @@
+//--------------------------------------------------------------------------------------
+// File: SimdTestLevels.h
+//
+// The instruction sets this CPU can run, so that each copy of a batch math kernel can be
+// tested and timed, not only the one GetSimdLevel picks.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CpuFeatures.h"
+
+#include <vector>
+
+
+namespace DirectX
+{
+    namespace Tests
+    {
+        // Baseline first, then each wider set up to the one GetSimdLevel reports.
+        inline std::vector<SimdLevel> GetTestedSimdLevels()
+        {
+            std::vector<SimdLevel> levels = { SimdLevel::Baseline };
+
+        #if defined(DIRECTX_SIMD_X86)
+            if (GetSimdLevel() >= SimdLevel::AVX2)
+                levels.push_back(SimdLevel::AVX2);
+
+            if (GetSimdLevel() >= SimdLevel::AVX512)
+                levels.push_back(SimdLevel::AVX512);
+        #endif
+
+            return levels;
+        }
+
+
+        inline char const* GetSimdLevelName(SimdLevel level) noexcept
+        {
+            switch (level)
+            {
+            case SimdLevel::AVX2:   return "AVX2";
+            case SimdLevel::AVX512: return "AVX-512";
+            default:                return "baseline";
+            }
+        }
+    }
+}
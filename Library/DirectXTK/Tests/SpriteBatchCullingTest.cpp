@@ -0,0 +1,107 @@
+//--------------------------------------------------------------------------------------
+// File: SpriteBatchCullingTest.cpp
+//
+// Checks that SpriteBatch culling leaves the rendered image unchanged. SpriteCuller itself is
+// tested in SpriteCullingTest.cpp.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "DeviceTest.h"
+#include "SpriteTestData.h"
+
+using namespace DirectX;
+using namespace DirectX::Tests;
+using Microsoft::WRL::ComPtr;
+
+
+TEST_CASE(SpriteBatchCullingKeepsImage)
+{
+    TestDevice test;
+
+    if (!CreateTestDevice(test))
+        return false;
+
+    auto context = test.context.Get();
+
+    constexpr UINT TargetSize = 256;
+
+    TestRenderTarget target(test.device.Get(), TargetSize, TargetSize);
+
+    ComPtr<ID3D11ShaderResourceView> textures[] =
+    {
+        CreateTestTexture(test.device.Get(), 64, 32, 1),
+        CreateTestTexture(test.device.Get(), 17, 9, 2),
+    };
+
+    ID3D11ShaderResourceView* const textureViews[] = { textures[0].Get(), textures[1].Get() };
+
+    // The scissor rectangle limits drawing to the clip rectangle, so culling against it must not change the image either.
+    D3D11_RASTERIZER_DESC rasterizerDesc = {};
+    rasterizerDesc.FillMode = D3D11_FILL_SOLID;
+    rasterizerDesc.CullMode = D3D11_CULL_NONE;
+    rasterizerDesc.DepthClipEnable = TRUE;
+    rasterizerDesc.ScissorEnable = TRUE;
+
+    ComPtr<ID3D11RasterizerState> scissorState;
+    CHECK_HR(test.device->CreateRasterizerState(&rasterizerDesc, &scissorState));
+
+    const RECT clipRectangle = { 40, 50, 200, 180 };
+    const RECT fullTarget = { 0, 0, LONG(TargetSize), LONG(TargetSize) };
+
+    for (const bool clip : { false, true })
+    {
+        for (const auto sortMode : { SpriteSortMode_Deferred, SpriteSortMode_BackToFront })
+        {
+            std::vector<uint32_t> images[2];
+            size_t culledCount = 0;
+
+            for (const bool culling : { false, true })
+            {
+                target.Begin(context);
+
+                context->RSSetScissorRects(1, clip ? &clipRectangle : &fullTarget);
+
+                SpriteBatch batch(context);
+
+                batch.SetCulling(culling, clip ? &clipRectangle : nullptr);
+
+                batch.Begin(sortMode, nullptr, nullptr, nullptr, scissorState.Get());
+
+                // Positions span four times the target, so most sprites lie outside it.
+                DrawTestSprites(batch, textureViews, std::size(textureViews), 3000, 9, 4.f * TargetSize);
+
+                batch.End();
+
+                images[culling] = target.Read(context);
+
+                CHECK(batch.GetCulledSpriteCount() == batch.GetStatistics().spritesCulled);
+
+                culledCount = batch.GetCulledSpriteCount();
+            }
+
+            char description[64];
+            snprintf(description, sizeof(description), "%s, %s", sortMode == SpriteSortMode_Deferred ? "Deferred" : "BackToFront",
+                clip ? "clip rectangle" : "viewport");
+
+            if (culledCount == 0)
+            {
+                printf("ERROR: %s: no sprites were culled\n", description);
+                return false;
+            }
+
+            const size_t different = CountDifferentPixels(images[0], images[1]);
+
+            if (different)
+            {
+                printf("ERROR: %s: culling %zu sprites changed %zu pixels\n", description, culledCount, different);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,246 @@
+//--------------------------------------------------------------------------------------
+// File: SpriteBatchDrawRunTest.cpp
+//
+// Checks that DrawRun generates exactly the vertices of calling Draw for each element, in
+// every sort mode, with threaded recording, and when recorded by a StaticSpriteBatch.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "DeviceTest.h"
+
+#include "SpriteBatch.h"
+
+#include <random>
+#include <stdexcept>
+
+using namespace DirectX;
+using namespace DirectX::Tests;
+using Microsoft::WRL::ComPtr;
+
+namespace
+{
+    const SpriteSortMode SortModes[] =
+    {
+        SpriteSortMode_Deferred,
+        SpriteSortMode_Immediate,
+        SpriteSortMode_Texture,
+        SpriteSortMode_BackToFront,
+        SpriteSortMode_FrontToBack,
+    };
+
+    const char* const SortModeNames[] = { "Deferred", "Immediate", "Texture", "BackToFront", "FrontToBack" };
+
+    // Run lengths: single sprites, typical strings, and one longer than the 2048 sprites of a draw call.
+    const size_t RunLengths[] = { 1, 37, 5000, 2, 300, 64, 1, 900 };
+
+    // The run lengths, plus the lone sprite drawn after each run.
+    constexpr size_t MaxSprites = 6305 + std::size(RunLengths);
+
+
+    // Draws runs of sprites into batch, which may be a SpriteBatch or a StaticSpriteBatch, either
+    // with DrawRun or with the equivalent Draw call per element. Between runs it draws a lone
+    // sprite with another texture, so runs do not always extend the batch before them.
+    template<typename TBatch>
+    void DrawTestRuns(TBatch& batch, _In_reads_(2) ID3D11ShaderResourceView* const* textures, bool useRun, uint32_t seed)
+    {
+        std::mt19937 rng(seed);
+
+        std::uniform_real_distribution<float> position(-100.f, 1100.f);
+        std::uniform_real_distribution<float> unit(0.f, 1.f);
+        std::uniform_real_distribution<float> angle(-3.f, 3.f);
+        std::uniform_real_distribution<float> scale(0.25f, 3.f);
+        std::uniform_int_distribution<long> texel(0, 31);
+
+        std::vector<SpriteRunElement> elements;
+
+        for (size_t run = 0; run < std::size(RunLengths); run++)
+        {
+            const XMVECTORF32 color = { { { unit(rng), unit(rng), unit(rng), unit(rng) } } };
+            const float rotation = (run & 1) ? angle(rng) : 0.f;
+            const auto effects = static_cast<SpriteEffects>(run & 3);
+            const float depth = unit(rng);
+
+            XMFLOAT2 scale2;
+            scale2.x = scale(rng);
+            scale2.y = (run % 3) ? scale(rng) : scale2.x;
+
+            elements.resize(RunLengths[run]);
+
+            for (auto& element : elements)
+            {
+                element.position.x = position(rng);
+                element.position.y = position(rng);
+                element.origin.x = unit(rng) * 40.f - 20.f;
+                element.origin.y = unit(rng) * 40.f - 20.f;
+                element.sourceRectangle.left = texel(rng);
+                element.sourceRectangle.top = texel(rng);
+                element.sourceRectangle.right = element.sourceRectangle.left + texel(rng);
+                element.sourceRectangle.bottom = element.sourceRectangle.top + texel(rng);
+            }
+
+            if (useRun)
+            {
+                batch.DrawRun(textures[0], elements.data(), elements.size(), color, rotation, XMLoadFloat2(&scale2), effects, depth);
+            }
+            else
+            {
+                for (auto const& element : elements)
+                {
+                    batch.Draw(textures[0], XMLoadFloat2(&element.position), &element.sourceRectangle, color, rotation,
+                        XMLoadFloat2(&element.origin), XMLoadFloat2(&scale2), effects, depth);
+                }
+            }
+
+            XMFLOAT2 at;
+            at.x = position(rng);
+            at.y = position(rng);
+
+            batch.Draw(textures[1], at, nullptr, Colors::White, 0.f, XMFLOAT2(0, 0), 1.f, SpriteEffects_None, unit(rng));
+        }
+    }
+}
+
+
+TEST_CASE(SpriteBatchDrawRunMatchesDraw)
+{
+    TestDevice test;
+
+    if (!CreateTestDevice(test))
+        return false;
+
+    auto context = test.context.Get();
+
+    SetTestViewport(context, 1024, 1024);
+
+    ComPtr<ID3D11ShaderResourceView> textures[] =
+    {
+        CreateTestTexture(test.device.Get(), 64, 64, 1),
+        CreateTestTexture(test.device.Get(), 17, 9, 2),
+    };
+
+    ID3D11ShaderResourceView* const textureViews[] = { textures[0].Get(), textures[1].Get() };
+
+    VertexCapture capture(test.device.Get(), MaxSprites * 6);
+
+    for (size_t mode = 0; mode < std::size(SortModes); mode++)
+    {
+        const auto seed = static_cast<uint32_t>(20 + mode);
+
+        SpriteBatch batch(context);
+
+        batch.Begin(SortModes[mode], nullptr, nullptr, nullptr, nullptr, capture.Begin(context));
+        DrawTestRuns(batch, textureViews, false, seed);
+        batch.End();
+
+        const auto expected = capture.End(context);
+
+        char description[96];
+        snprintf(description, sizeof(description), "%s, DrawRun", SortModeNames[mode]);
+
+        batch.Begin(SortModes[mode], nullptr, nullptr, nullptr, nullptr, capture.Begin(context));
+        DrawTestRuns(batch, textureViews, true, seed);
+        batch.End();
+
+        if (!CompareVertices(expected, capture.End(context), description))
+            return false;
+
+        if (SortModes[mode] == SpriteSortMode_Immediate)
+            continue;
+
+        // Threaded recording stores runs in the calling thread's segment.
+        SpriteBatch threaded(context);
+
+        threaded.SetThreadedRecording(true);
+
+        threaded.Begin(SortModes[mode], nullptr, nullptr, nullptr, nullptr, capture.Begin(context));
+        DrawTestRuns(threaded, textureViews, true, seed);
+        threaded.End();
+
+        snprintf(description, sizeof(description), "%s, threaded DrawRun", SortModeNames[mode]);
+
+        if (!CompareVertices(expected, capture.End(context), description))
+            return false;
+
+        StaticSpriteBatch staticBatch(context);
+
+        staticBatch.Begin(SortModes[mode]);
+        DrawTestRuns(staticBatch, textureViews, true, seed);
+        staticBatch.End();
+
+        CHECK(staticBatch.GetSpriteCount() == MaxSprites);
+
+        staticBatch.Render(XMMatrixIdentity(), nullptr, nullptr, nullptr, nullptr, capture.Begin(context));
+
+        snprintf(description, sizeof(description), "%s, StaticSpriteBatch DrawRun", SortModeNames[mode]);
+
+        if (!CompareVertices(expected, capture.End(context), description))
+            return false;
+    }
+
+    return true;
+}
+
+
+TEST_CASE(SpriteBatchDrawRunValidatesArguments)
+{
+    TestDevice test;
+
+    if (!CreateTestDevice(test))
+        return false;
+
+    auto context = test.context.Get();
+
+    SetTestViewport(context, 1024, 1024);
+
+    auto texture = CreateTestTexture(test.device.Get(), 16, 16, 1);
+
+    SpriteRunElement element = {};
+    element.sourceRectangle = { 0, 0, 8, 8 };
+
+    SpriteBatch batch(context);
+
+    auto throwsInvalidArgument = [&](ID3D11ShaderResourceView* runTexture, SpriteRunElement const* elements, size_t count)
+        {
+            try
+            {
+                batch.DrawRun(runTexture, elements, count);
+            }
+            catch (std::invalid_argument const&)
+            {
+                return true;
+            }
+
+            return false;
+        };
+
+    // Outside Begin/End.
+    bool threw = false;
+
+    try
+    {
+        batch.DrawRun(texture.Get(), &element, 1);
+    }
+    catch (std::logic_error const&)
+    {
+        threw = true;
+    }
+
+    CHECK(threw);
+
+    batch.Begin();
+
+    CHECK(throwsInvalidArgument(nullptr, &element, 1));
+    CHECK(throwsInvalidArgument(texture.Get(), nullptr, 1));
+
+    // An empty run is allowed, with or without elements.
+    CHECK(!throwsInvalidArgument(texture.Get(), nullptr, 0));
+    CHECK(!throwsInvalidArgument(texture.Get(), &element, 0));
+
+    batch.End();
+
+    return true;
+}
@@ -0,0 +1,108 @@
+//--------------------------------------------------------------------------------------
+// File: SpriteBatchExpansionTest.cpp
+//
+// Checks that the four- and eight-wide sprite expansion paths generate exactly the same
+// vertices as the one-sprite-at-a-time path.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "DeviceTest.h"
+#include "SpriteTestData.h"
+
+#include <intrin.h>
+
+using namespace DirectX;
+using namespace DirectX::Tests;
+
+namespace
+{
+    bool IsAVXAvailable() noexcept
+    {
+    #if defined(_M_X64) || defined(_M_IX86)
+        int cpuInfo[4] = {};
+        __cpuid(cpuInfo, 1);
+
+        if (!(cpuInfo[2] & (1 << 27)) || !(cpuInfo[2] & (1 << 28)))
+            return false;
+
+        return (_xgetbv(0) & 6) == 6;
+    #else
+        return false;
+    #endif
+    }
+
+
+    std::vector<VertexPositionColorTexture> CaptureSprites(TestDevice const& test,
+        VertexCapture& capture,
+        SpriteSortMode sortMode,
+        bool parallel,
+        ID3D11ShaderResourceView* texture,
+        size_t count,
+        uint32_t seed)
+    {
+        auto context = test.context.Get();
+
+        SpriteBatch batch(context);
+
+        batch.SetParallelVertexGeneration(parallel, 64);
+
+        batch.Begin(sortMode, nullptr, nullptr, nullptr, nullptr, capture.Begin(context));
+        DrawTestSprites(batch, &texture, 1, count, seed);
+        batch.End();
+
+        return capture.End(context);
+    }
+}
+
+
+TEST_CASE(SpriteExpansionMatchesScalarPath)
+{
+    TestDevice test;
+
+    if (!CreateTestDevice(test))
+        return false;
+
+    SetTestViewport(test.context.Get(), 1024, 1024);
+
+    auto texture = CreateTestTexture(test.device.Get(), 64, 32, 1);
+
+    VertexCapture capture(test.device.Get(), 2048 * 6);
+
+    printf("  eight-wide AVX path %s\n", IsAVXAvailable() ? "enabled" : "unavailable, checking the four-wide path only");
+
+    // Immediate mode expands each sprite as it is drawn, which always takes the scalar path.
+    // Deferred mode expands the whole batch eight (or four) at a time, finishing any remainder
+    // on the narrower paths, so the counts below cover every mix of the three.
+    const size_t counts[] = { 1, 3, 4, 7, 8, 9, 12, 15, 16, 17, 1000, 2048 };
+
+    for (const size_t count : counts)
+    {
+        const auto seed = static_cast<uint32_t>(count);
+
+        const auto scalar = CaptureSprites(test, capture, SpriteSortMode_Immediate, false, texture.Get(), count, seed);
+
+        CHECK(scalar.size() == count * 6);
+
+        const auto wide = CaptureSprites(test, capture, SpriteSortMode_Deferred, false, texture.Get(), count, seed);
+
+        char context[64];
+        snprintf(context, sizeof(context), "%zu sprites", count);
+
+        if (!CompareVertices(scalar, wide, context))
+            return false;
+
+        // Parallel generation splits the batch at arbitrary points, which moves sprites between paths.
+        const auto parallel = CaptureSprites(test, capture, SpriteSortMode_Deferred, true, texture.Get(), count, seed);
+
+        snprintf(context, sizeof(context), "%zu sprites, parallel", count);
+
+        if (!CompareVertices(scalar, parallel, context))
+            return false;
+    }
+
+    return true;
+}
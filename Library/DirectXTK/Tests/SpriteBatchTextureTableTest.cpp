@@ -0,0 +1,275 @@
+//--------------------------------------------------------------------------------------
+// File: SpriteBatchTextureTableTest.cpp
+//
+// Checks that SetMaxTexturesPerBatch merges sprites with different textures into fewer
+// draws, as reported by GetStatistics, without changing what ends up on screen.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "DeviceTest.h"
+
+#include "SpriteBatch.h"
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+
+using namespace DirectX;
+using namespace DirectX::Tests;
+using Microsoft::WRL::ComPtr;
+
+namespace
+{
+    constexpr UINT TargetSize = 256;
+    constexpr UINT TextureSize = 16;
+
+    // Small enough that no batch is ever split to fit the vertex ring, which would add draws
+    // that have nothing to do with texture grouping.
+    constexpr size_t SpriteCount = 120;
+
+    constexpr size_t TextureCount = 12;
+
+
+    struct TextureSet
+    {
+        ComPtr<ID3D11ShaderResourceView> textures[TextureCount];
+        ID3D11ShaderResourceView* views[TextureCount];
+
+        explicit TextureSet(ID3D11Device* device)
+        {
+            for (size_t i = 0; i < TextureCount; i++)
+            {
+                textures[i] = CreateTestTexture(device, TextureSize, TextureSize, static_cast<uint32_t>(i + 1));
+                views[i] = textures[i].Get();
+            }
+        }
+    };
+
+
+    // Each sprite gets its own cell of the target, so the picture shows which texture it sampled.
+    void DrawGrid(SpriteBatch& batch, std::vector<size_t> const& textureIndices, ID3D11ShaderResourceView* const* textures)
+    {
+        constexpr size_t Columns = TargetSize / TextureSize;
+
+        for (size_t i = 0; i < textureIndices.size(); i++)
+        {
+            const XMFLOAT2 position(float((i % Columns) * TextureSize), float((i / Columns) * TextureSize));
+
+            batch.Draw(textures[textureIndices[i]], position);
+        }
+    }
+
+
+    // The number of draws expected when the sorted sprites are grouped greedily, in order.
+    size_t CountGroups(std::vector<size_t> const& textureIndices, size_t maxTextures)
+    {
+        size_t groupCount = 0;
+        std::vector<size_t> current;
+
+        for (const size_t texture : textureIndices)
+        {
+            if (std::find(current.begin(), current.end(), texture) != current.end())
+                continue;
+
+            if (current.empty() || current.size() == maxTextures)
+            {
+                groupCount++;
+                current.clear();
+            }
+
+            current.push_back(texture);
+        }
+
+        return groupCount;
+    }
+
+
+    std::vector<uint32_t> RenderGrid(TestDevice const& test,
+        TestRenderTarget& target,
+        TextureSet const& textures,
+        std::vector<size_t> const& textureIndices,
+        SpriteSortMode sortMode,
+        size_t maxTextures,
+        bool customShaders,
+        SpriteBatchStatistics& statistics)
+    {
+        auto context = test.context.Get();
+
+        target.Begin(context);
+
+        SpriteBatch batch(context);
+
+        batch.SetMaxTexturesPerBatch(maxTextures);
+
+        // A callback that leaves the standard shaders bound, but still turns off multi-texture batching.
+        std::function<void()> setCustomShaders;
+
+        if (customShaders)
+        {
+            setCustomShaders = []() {};
+        }
+
+        batch.Begin(sortMode, nullptr, nullptr, nullptr, nullptr, setCustomShaders);
+        DrawGrid(batch, textureIndices, textures.views);
+        batch.End();
+
+        statistics = batch.GetStatistics();
+
+        return target.Read(context);
+    }
+}
+
+
+TEST_CASE(TextureTableBatchCounts)
+{
+    TestDevice test;
+
+    if (!CreateTestDevice(test))
+        return false;
+
+    TestRenderTarget target(test.device.Get(), TargetSize, TargetSize);
+
+    const TextureSet textures(test.device.Get());
+
+    std::mt19937 rng(7);
+
+    for (const size_t used : { size_t(1), size_t(3), size_t(8), size_t(9), TextureCount })
+    {
+        // Both the worst case, a different texture for every sprite, and a shuffled order.
+        std::vector<size_t> cycle(SpriteCount);
+        std::vector<size_t> shuffled(SpriteCount);
+
+        for (size_t i = 0; i < SpriteCount; i++)
+        {
+            cycle[i] = i % used;
+            shuffled[i] = rng() % used;
+        }
+
+        for (auto const* textureIndices : { &cycle, &shuffled })
+        {
+            SpriteBatchStatistics reference;
+
+            const auto expected = RenderGrid(test, target, textures, *textureIndices, SpriteSortMode_Deferred, 1, false, reference);
+
+            CHECK(reference.spritesQueued == SpriteCount);
+            CHECK(reference.batchesIssued == CountGroups(*textureIndices, 1));
+            CHECK(reference.textureChanges + 1 == reference.batchesIssued);
+
+            for (const size_t maxTextures : { size_t(2), size_t(4), SpriteBatch::MaxTexturesPerBatch })
+            {
+                char context[96];
+                snprintf(context, sizeof(context), "%zu textures %s, %zu per batch", used,
+                    (textureIndices == &cycle) ? "in turn" : "shuffled", maxTextures);
+
+                SpriteBatchStatistics statistics;
+
+                const auto actual = RenderGrid(test, target, textures, *textureIndices, SpriteSortMode_Deferred, maxTextures, false, statistics);
+
+                if (statistics.batchesIssued != CountGroups(*textureIndices, maxTextures)
+                    || statistics.textureChanges + 1 != statistics.batchesIssued
+                    || statistics.spritesQueued != SpriteCount)
+                {
+                    printf("ERROR: %s: %zu batches and %zu texture changes, expected %zu batches\n", context,
+                        statistics.batchesIssued, statistics.textureChanges, CountGroups(*textureIndices, maxTextures));
+                    return false;
+                }
+
+                // The multi-texture shader must sample the same texels as the single-texture one.
+                const size_t different = CountDifferentPixels(expected, actual);
+
+                if (different)
+                {
+                    printf("ERROR: %s: %zu pixels differ from one texture per batch\n", context, different);
+                    return false;
+                }
+
+                // Custom shaders always get one texture per draw, whatever the setting.
+                RenderGrid(test, target, textures, *textureIndices, SpriteSortMode_Deferred, maxTextures, true, statistics);
+
+                if (statistics.batchesIssued != reference.batchesIssued)
+                {
+                    printf("ERROR: %s: %zu batches with custom shaders, expected %zu\n", context,
+                        statistics.batchesIssued, reference.batchesIssued);
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+
+TEST_CASE(TextureTableSortedByTexture)
+{
+    TestDevice test;
+
+    if (!CreateTestDevice(test))
+        return false;
+
+    TestRenderTarget target(test.device.Get(), TargetSize, TargetSize);
+
+    const TextureSet textures(test.device.Get());
+
+    // Every texture is used, in a random order.
+    std::vector<size_t> textureIndices(SpriteCount);
+
+    for (size_t i = 0; i < SpriteCount; i++)
+    {
+        textureIndices[i] = i % TextureCount;
+    }
+
+    std::mt19937 rng(11);
+    std::shuffle(textureIndices.begin(), textureIndices.end(), rng);
+
+    // Texture sort mode leaves one run per texture, which grouping then packs into full batches.
+    SpriteBatchStatistics single;
+    const auto expected = RenderGrid(test, target, textures, textureIndices, SpriteSortMode_Texture, 1, false, single);
+
+    CHECK(single.batchesIssued == TextureCount);
+    CHECK(single.textureChanges == TextureCount - 1);
+
+    SpriteBatchStatistics grouped;
+    const auto actual = RenderGrid(test, target, textures, textureIndices, SpriteSortMode_Texture, SpriteBatch::MaxTexturesPerBatch, false, grouped);
+
+    const size_t expectedBatches = (TextureCount + SpriteBatch::MaxTexturesPerBatch - 1) / SpriteBatch::MaxTexturesPerBatch;
+
+    CHECK(grouped.batchesIssued == expectedBatches);
+    CHECK(grouped.textureChanges == expectedBatches - 1);
+    CHECK(CountDifferentPixels(expected, actual) == 0);
+
+    return true;
+}
+
+
+TEST_CASE(TextureTableRejectsInvalidCounts)
+{
+    TestDevice test;
+
+    if (!CreateTestDevice(test))
+        return false;
+
+    SpriteBatch batch(test.context.Get());
+
+    for (const size_t count : { size_t(0), SpriteBatch::MaxTexturesPerBatch + 1 })
+    {
+        bool threw = false;
+
+        try
+        {
+            batch.SetMaxTexturesPerBatch(count);
+        }
+        catch (std::invalid_argument const&)
+        {
+            threw = true;
+        }
+
+        CHECK(threw);
+    }
+
+    return true;
+}
@@ -0,0 +1,149 @@
+//--------------------------------------------------------------------------------------
+// File: SpriteCullingBenchmark.cpp
+//
+// Times culling 100,000 sprites the way SpriteBatch::Impl::CullSprites does, against the
+// vertex expansion that culling saves for the sprites it drops.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHarness.h"
+#include "TestSprites.h"
+
+#include "SpriteCulling.h"
+
+using namespace DirectX;
+using namespace DirectX::Tests;
+
+namespace
+{
+    using SpriteExpansion::VerticesPerSprite;
+
+    constexpr size_t SpriteCount = 100000;
+    constexpr size_t Iterations = 20;
+
+
+    // Resolves each sprite's size and origin, tests four at a time, and compacts the draw order
+    // down to the sprites that may be visible, as CullSprites does. Returns the number kept.
+    size_t CullSprites(SpriteCuller const& culler, TestSpriteQueue const& queue, uint32_t const* order, size_t count, uint32_t* visible) noexcept
+    {
+        const XMVECTOR textureSize = GetTestTextureSize();
+
+        XMFLOAT4A rects[4];
+        XMFLOAT4A originRotationDepth[4];
+
+        size_t visibleCount = 0;
+
+        for (size_t pos = 0; pos < count; pos += 4)
+        {
+            const size_t groupSize = std::min<size_t>(4, count - pos);
+
+            for (size_t i = 0; i < 4; i++)
+            {
+                const uint32_t sprite = order[pos + (i < groupSize ? i : 0)];
+
+                const XMVECTOR source = XMLoadFloat4A(&queue.source[sprite]);
+                const XMVECTOR destination = XMLoadFloat4A(&queue.destination[sprite]);
+                const XMVECTOR ord = XMLoadFloat4A(&queue.originRotationDepth[sprite]);
+                const unsigned int flags = queue.flags[sprite];
+
+                XMVECTOR sourceSize = XMVectorSwizzle<2, 3, 2, 3>(source);
+                XMVECTOR destinationSize = XMVectorSwizzle<2, 3, 2, 3>(destination);
+
+                if (!(flags & SpriteExpansion::SourceInTexels))
+                {
+                    sourceSize = textureSize;
+                }
+
+                if (!(flags & SpriteExpansion::DestSizeInPixels))
+                {
+                    destinationSize = XMVectorMultiply(destinationSize, textureSize);
+                }
+
+                const XMVECTOR origin = XMVectorDivide(ord, XMVectorSelect(sourceSize, g_XMEpsilon, XMVectorEqual(sourceSize, XMVectorZero())));
+
+                XMStoreFloat4A(&rects[i], XMVectorPermute<0, 1, 4, 5>(destination, destinationSize));
+                XMStoreFloat4A(&originRotationDepth[i], XMVectorPermute<0, 1, 6, 7>(origin, ord));
+            }
+
+            static const uint32_t lanes[4] = { 0, 1, 2, 3 };
+
+            const unsigned int mask = culler.Test4(
+                SpriteExpansion::LoadTransposed4(rects, lanes),
+                SpriteExpansion::LoadTransposed4(originRotationDepth, lanes));
+
+            for (size_t i = 0; i < groupSize; i++)
+            {
+                visible[visibleCount] = order[pos + i];
+                visibleCount += (mask >> i) & 1;
+            }
+        }
+
+        return visibleCount;
+    }
+}
+
+
+BENCHMARK(SpriteCullingHundredThousand)
+{
+    std::mt19937 rng(100);
+
+    const auto queue = MakeTestSprites(rng, SpriteCount);
+    const auto order = MakeTestSpriteOrder(rng, SpriteCount);
+
+    const XMVECTOR textureSize = GetTestTextureSize();
+    const XMVECTOR inverseTextureSize = XMVectorReciprocal(textureSize);
+
+    std::vector<uint32_t> visible(SpriteCount);
+    std::vector<TestSpriteVertex> vertices(SpriteCount * VerticesPerSprite);
+
+    printf("%-10s %10s %12s %12s %12s   (ns per sprite, %zu sprites)\n", "viewport", "visible", "cull", "expand all", "cull+expand", SpriteCount);
+
+    // The test sprites lie between -100 and 1000 pixels, so a smaller viewport culls more.
+    for (const float size : { 1024.f, 512.f, 128.f })
+    {
+        SpriteCuller culler;
+
+        const XMMATRIX pixelToClip = XMMatrixMultiply(XMMatrixScaling(2.f / size, -2.f / size, 1.f), XMMatrixTranslation(-1.f, 1.f, 0.f));
+
+        if (!culler.SetTransform(pixelToClip, XMVectorSet(-1.f, -1.f, 1.f, 1.f)))
+        {
+            printf("ERROR: the viewport transform was refused\n");
+            return false;
+        }
+
+        size_t visibleCount = 0;
+
+        const double cull = MeasureNanoseconds(Iterations, [&]()
+            {
+                visibleCount = CullSprites(culler, queue, order.data(), SpriteCount, visible.data());
+            });
+
+        const double expandAll = MeasureNanoseconds(Iterations, [&]()
+            {
+                SpriteExpansion::RenderSprites(queue, order.data(), SpriteCount, vertices.data(), textureSize, inverseTextureSize);
+            });
+
+        KeepResult(static_cast<uint64_t>(vertices[SpriteCount].position.x > 0.f));
+
+        const double cullAndExpand = MeasureNanoseconds(Iterations, [&]()
+            {
+                const size_t kept = CullSprites(culler, queue, order.data(), SpriteCount, visible.data());
+
+                SpriteExpansion::RenderSprites(queue, visible.data(), kept, vertices.data(), textureSize, inverseTextureSize);
+            });
+
+        KeepResult(static_cast<uint64_t>(vertices[0].position.x > 0.f));
+
+        char label[32];
+        snprintf(label, sizeof(label), "%.0fx%.0f", size, size);
+
+        printf("%-10s %9.1f%% %12.2f %12.2f %12.2f\n", label, 100.0 * double(visibleCount) / double(SpriteCount),
+            cull / double(SpriteCount), expandAll / double(SpriteCount), cullAndExpand / double(SpriteCount));
+    }
+
+    return true;
+}
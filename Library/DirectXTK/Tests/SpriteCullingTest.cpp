@@ -0,0 +1,352 @@
+//--------------------------------------------------------------------------------------
+// File: SpriteCullingTest.cpp
+//
+// Checks that SpriteCuller never culls a sprite that touches the visible region, and culls the
+// ones clearly outside it.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHarness.h"
+
+#include "SpriteCulling.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <random>
+
+using namespace DirectX;
+
+namespace
+{
+    // A sprite as SpriteCuller sees it: position and size in pixels, origin as a fraction of the size.
+    struct TestSprite
+    {
+        float x, y;
+        float width, height;
+        float originX, originY;
+        float rotation;
+        float depth;
+    };
+
+
+    unsigned int TestSprites(SpriteCuller const& culler, TestSprite const* sprites)
+    {
+        XMFLOAT4X4 rects;
+        XMFLOAT4X4 originRotationDepth;
+
+        for (size_t i = 0; i < 4; i++)
+        {
+            rects.m[0][i] = sprites[i].x;
+            rects.m[1][i] = sprites[i].y;
+            rects.m[2][i] = sprites[i].width;
+            rects.m[3][i] = sprites[i].height;
+
+            originRotationDepth.m[0][i] = sprites[i].originX;
+            originRotationDepth.m[1][i] = sprites[i].originY;
+            originRotationDepth.m[2][i] = sprites[i].rotation;
+            originRotationDepth.m[3][i] = sprites[i].depth;
+        }
+
+        return culler.Test4(XMLoadFloat4x4(&rects), XMLoadFloat4x4(&originRotationDepth));
+    }
+
+
+    bool IsKept(SpriteCuller const& culler, TestSprite const& sprite)
+    {
+        const TestSprite sprites[4] = { sprite, sprite, sprite, sprite };
+
+        return TestSprites(culler, sprites) == 0xF;
+    }
+
+
+    // Transforms the exact rotated corners, the way RenderSprite places them, and measures how far
+    // their bounds lie outside region. Zero or less means the sprite touches it.
+    double DistanceOutside(TestSprite const& sprite, XMFLOAT4X4 const& transform, XMFLOAT4 const& region)
+    {
+        const double sinR = std::sin(double(sprite.rotation));
+        const double cosR = std::cos(double(sprite.rotation));
+
+        double minX = DBL_MAX, minY = DBL_MAX, maxX = -DBL_MAX, maxY = -DBL_MAX;
+
+        for (int corner = 0; corner < 4; corner++)
+        {
+            const double localX = (double(corner & 1) - sprite.originX) * sprite.width;
+            const double localY = (double(corner >> 1) - sprite.originY) * sprite.height;
+
+            const double px = sprite.x + cosR * localX - sinR * localY;
+            const double py = sprite.y + sinR * localX + cosR * localY;
+
+            const double clipX = px * transform._11 + py * transform._21 + sprite.depth * transform._31 + transform._41;
+            const double clipY = px * transform._12 + py * transform._22 + sprite.depth * transform._32 + transform._42;
+
+            minX = std::min(minX, clipX);
+            minY = std::min(minY, clipY);
+            maxX = std::max(maxX, clipX);
+            maxY = std::max(maxY, clipY);
+        }
+
+        return std::max({ region.x - maxX, region.y - maxY, minX - region.z, minY - region.w });
+    }
+
+
+    TestSprite RandomSprite(std::mt19937& rng, float extent)
+    {
+        std::uniform_real_distribution<float> position(-0.5f * extent, 1.5f * extent);
+        std::uniform_real_distribution<float> size(-64.f, 256.f);
+        std::uniform_real_distribution<float> origin(-0.5f, 1.5f);
+        std::uniform_real_distribution<float> angle(-10.f, 10.f);
+        std::uniform_real_distribution<float> unit(0.f, 1.f);
+
+        TestSprite sprite;
+        sprite.x = position(rng);
+        sprite.y = position(rng);
+        sprite.width = size(rng);
+        sprite.height = size(rng);
+        sprite.originX = origin(rng);
+        sprite.originY = origin(rng);
+        sprite.rotation = (rng() & 3) ? angle(rng) : 0.f;
+        sprite.depth = unit(rng);
+
+        return sprite;
+    }
+
+
+    // The transform SpriteBatch builds for a width x height viewport, mapping pixels to clip space.
+    XMMATRIX PixelToClip(float width, float height)
+    {
+        return XMMatrixMultiply(XMMatrixScaling(2.f / width, -2.f / height, 1.f), XMMatrixTranslation(-1.f, 1.f, 0.f));
+    }
+}
+
+
+TEST_CASE(SpriteCullerRotatedSprites)
+{
+    constexpr float Extent = 1024.f;
+
+    const XMFLOAT4 regions[] =
+    {
+        { -1.f, -1.f, 1.f, 1.f },
+        { -0.25f, -0.75f, 0.5f, 0.125f },
+    };
+
+    // Scaled and translated, as SpriteBatch uses by default, and with an extra rotation and depth
+    // term, for which the bounds are looser but must still be conservative.
+    const XMMATRIX transforms[] =
+    {
+        PixelToClip(Extent, Extent),
+        XMMatrixMultiply(XMMatrixMultiply(XMMatrixRotationZ(0.6f), XMMatrixTranslation(200.f, -100.f, 0.5f)), PixelToClip(Extent, Extent)),
+    };
+
+    std::mt19937 rng(3);
+
+    for (size_t t = 0; t < std::size(transforms); t++)
+    {
+        XMFLOAT4X4 transform;
+        XMStoreFloat4x4(&transform, transforms[t]);
+
+        for (auto const& region : regions)
+        {
+            SpriteCuller culler;
+            CHECK(culler.SetTransform(transforms[t], XMLoadFloat4(&region)));
+
+            size_t kept = 0, culled = 0;
+
+            for (int group = 0; group < 20000; group++)
+            {
+                TestSprite sprites[4];
+
+                for (auto& sprite : sprites)
+                {
+                    sprite = RandomSprite(rng, Extent);
+                }
+
+                const unsigned int mask = TestSprites(culler, sprites);
+
+                for (size_t i = 0; i < 4; i++)
+                {
+                    const bool isKept = (mask & (1u << i)) != 0;
+                    const double outside = DistanceOutside(sprites[i], transform, region);
+
+                    // Allow for float rounding in the culler, relative to the size of the sprite in clip space.
+                    const double tolerance = 1e-3 * (std::abs(sprites[i].width) + std::abs(sprites[i].height)) / Extent + 1e-5;
+
+                    if (!isKept && outside <= 0)
+                    {
+                        printf("ERROR: transform %zu: visible sprite at (%g, %g) size (%g, %g) rotation %g was culled\n",
+                            t, sprites[i].x, sprites[i].y, sprites[i].width, sprites[i].height, sprites[i].rotation);
+                        return false;
+                    }
+
+                    // With no rotation in the transform, the rotated bounds are exact, so the test is also tight.
+                    if (t == 0 && isKept && outside > tolerance)
+                    {
+                        printf("ERROR: sprite at (%g, %g) size (%g, %g) rotation %g is %g outside, but was kept\n",
+                            sprites[i].x, sprites[i].y, sprites[i].width, sprites[i].height, sprites[i].rotation, outside);
+                        return false;
+                    }
+
+                    (isKept ? kept : culled)++;
+                }
+            }
+
+            // Make sure the random sprites covered both outcomes.
+            CHECK(kept > 1000 && culled > 1000);
+        }
+    }
+
+    return true;
+}
+
+
+TEST_CASE(SpriteCullerClipEdges)
+{
+    // With an identity transform, the region is in pixels, like a scissor rectangle.
+    const XMFLOAT4 region(100.f, 200.f, 300.f, 350.f);
+
+    SpriteCuller culler;
+    CHECK(culler.SetTransform(XMMatrixIdentity(), XMLoadFloat4(&region)));
+
+    // Squares centered on their origin, placed on either side of each edge. The step is large
+    // compared to float rounding but well under a pixel.
+    constexpr float Size = 20.f;
+    constexpr float Step = 0.25f;
+
+    const float halfDiagonal = Size * 0.5f * std::sqrt(2.f);
+
+    struct Edge
+    {
+        float x, y;         // A point on the edge
+        float dx, dy;       // Outward direction
+    };
+
+    const Edge edges[] =
+    {
+        { region.x, 275.f, -1.f, 0.f },
+        { region.z, 275.f, 1.f, 0.f },
+        { 200.f, region.y, 0.f, -1.f },
+        { 200.f, region.w, 0.f, 1.f },
+    };
+
+    for (auto const& edge : edges)
+    {
+        for (const float rotation : { 0.f, XM_PIDIV4, XM_PI + XM_PIDIV4, -XM_PIDIV2 })
+        {
+            // How far the square reaches from its center along the edge normal.
+            const float reach = (rotation == XM_PIDIV4 || rotation == XM_PI + XM_PIDIV4) ? halfDiagonal : Size * 0.5f;
+
+            for (const float offset : { -Step, 0.f, Step })
+            {
+                // offset < 0 overlaps the region, 0 touches the edge exactly, and > 0 leaves a gap.
+                const float distance = reach + offset;
+
+                TestSprite sprite = {};
+                sprite.x = edge.x + edge.dx * distance;
+                sprite.y = edge.y + edge.dy * distance;
+                sprite.width = Size;
+                sprite.height = Size;
+                sprite.originX = 0.5f;
+                sprite.originY = 0.5f;
+                sprite.rotation = rotation;
+
+                const bool kept = IsKept(culler, sprite);
+
+                if ((offset < 0 && !kept) || (offset > 0 && kept))
+                {
+                    printf("ERROR: sprite %g past the edge at (%g, %g) with rotation %g was %s\n",
+                        offset, edge.x, edge.y, rotation, kept ? "kept" : "culled");
+                    return false;
+                }
+
+                if (offset == 0 && !kept)
+                {
+                    printf("ERROR: sprite touching the edge at (%g, %g) with rotation %g was culled\n", edge.x, edge.y, rotation);
+                    return false;
+                }
+            }
+
+            // A full pixel of gap leaves no doubt, whatever the rounding.
+            TestSprite outside = {};
+            outside.x = edge.x + edge.dx * (reach + 1.f);
+            outside.y = edge.y + edge.dy * (reach + 1.f);
+            outside.width = Size;
+            outside.height = Size;
+            outside.originX = 0.5f;
+            outside.originY = 0.5f;
+            outside.rotation = rotation;
+
+            CHECK(!IsKept(culler, outside));
+        }
+    }
+
+    return true;
+}
+
+
+TEST_CASE(SpriteCullerFullyOutside)
+{
+    constexpr float Extent = 512.f;
+
+    SpriteCuller culler;
+    CHECK(culler.SetTransform(PixelToClip(Extent, Extent), XMVectorSet(-1.f, -1.f, 1.f, 1.f)));
+
+    // Rotated sprites off every side and corner of the viewport are all culled together.
+    for (int dy = -1; dy <= 1; dy++)
+    {
+        for (int dx = -1; dx <= 1; dx++)
+        {
+            if (!dx && !dy)
+                continue;
+
+            TestSprite sprites[4];
+
+            for (size_t i = 0; i < 4; i++)
+            {
+                sprites[i] = {};
+                sprites[i].x = Extent * 0.5f + float(dx) * (Extent * 0.5f + 100.f + 10.f * float(i));
+                sprites[i].y = Extent * 0.5f + float(dy) * (Extent * 0.5f + 100.f + 10.f * float(i));
+                sprites[i].width = 64.f;
+                sprites[i].height = 32.f;
+                sprites[i].originX = 0.5f;
+                sprites[i].originY = 0.5f;
+                sprites[i].rotation = 0.7f * float(i);
+            }
+
+            CHECK(TestSprites(culler, sprites) == 0);
+        }
+    }
+
+    // A sprite larger than the viewport, with every corner outside it, still covers it.
+    TestSprite cover = {};
+    cover.x = -100.f;
+    cover.y = -100.f;
+    cover.width = Extent + 200.f;
+    cover.height = Extent + 200.f;
+    cover.rotation = 0.1f;
+
+    CHECK(IsKept(culler, cover));
+
+    // NaN positions are kept, as they were before culling.
+    TestSprite invalid = cover;
+    invalid.x = std::numeric_limits<float>::quiet_NaN();
+
+    CHECK(IsKept(culler, invalid));
+
+    // Only the lanes that are outside are cleared.
+    TestSprite mixed[4] = { cover, cover, cover, cover };
+    mixed[1].x = -Extent * 4.f;
+    mixed[3].y = Extent * 4.f;
+
+    CHECK(TestSprites(culler, mixed) == 0x5);
+
+    // A perspective transform is refused, so the caller skips culling.
+    CHECK(!culler.SetTransform(XMMatrixPerspectiveFovLH(1.f, 1.f, 0.1f, 100.f), XMVectorSet(-1.f, -1.f, 1.f, 1.f)));
+
+    return true;
+}
@@ -0,0 +1,163 @@
+//--------------------------------------------------------------------------------------
+// File: SpriteExpansionBenchmark.cpp
+//
+// Times the three sprite expansion kernels on their own, writing into a plain buffer:
+// RenderSprite one sprite at a time, RenderSprites4 with SSE, and RenderSprites8 with AVX.
+// Then times RenderSprites on one thread against the chunked split across the worker pool
+// that SpriteBatch::Impl::GenerateVertices uses for large runs.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHarness.h"
+#include "TestSprites.h"
+
+#include "WorkerPool.h"
+
+#include <cstring>
+
+using namespace DirectX;
+using namespace DirectX::Tests;
+
+namespace
+{
+    using SpriteExpansion::VerticesPerSprite;
+
+    double SpritesPerSecond(size_t count, double nanoseconds) noexcept
+    {
+        return double(count) * 1e9 / nanoseconds;
+    }
+}
+
+
+BENCHMARK(SpriteExpansionThroughput)
+{
+    printf("%-14s %12s %12s %12s   (millions of sprites per second)\n", "sprites", "scalar", "SSE", "AVX");
+
+    // One full batch, then a large run such as a particle system.
+    for (const size_t count : { size_t(2048), size_t(1) << 16 })
+    {
+        std::mt19937 rng(static_cast<uint32_t>(count));
+
+        const auto queue = MakeTestSprites(rng, count);
+        const auto order = MakeTestSpriteOrder(rng, count);
+
+        const XMVECTOR textureSize = GetTestTextureSize();
+        const XMVECTOR inverseTextureSize = XMVectorReciprocal(textureSize);
+
+        std::vector<TestSpriteVertex> vertices(count * VerticesPerSprite);
+
+        // About 4M sprites per measurement, however many there are.
+        const size_t iterations = std::max<size_t>(1, (size_t(1) << 22) / count);
+
+        const double scalar = MeasureNanoseconds(iterations, [&]()
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    SpriteExpansion::RenderSprite(queue, order[i], &vertices[i * VerticesPerSprite], textureSize, inverseTextureSize);
+                }
+            });
+
+        KeepResult(static_cast<uint64_t>(vertices[count].position.x > 0.f));
+
+        const double sse = MeasureNanoseconds(iterations, [&]()
+            {
+                for (size_t i = 0; i < count; i += 4)
+                {
+                    SpriteExpansion::RenderSprites4(queue, &order[i], &vertices[i * VerticesPerSprite], textureSize, inverseTextureSize);
+                }
+            });
+
+        KeepResult(static_cast<uint64_t>(vertices[count].position.x > 0.f));
+
+        char label[32];
+        snprintf(label, sizeof(label), "%zu", count);
+
+        printf("%-14s %12.1f %12.1f", label, SpritesPerSecond(count, scalar) / 1e6, SpritesPerSecond(count, sse) / 1e6);
+
+    #if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+        if (SpriteExpansion::IsAVXSupported())
+        {
+            const double avx = MeasureNanoseconds(iterations, [&]()
+                {
+                    for (size_t i = 0; i < count; i += 8)
+                    {
+                        SpriteExpansion::RenderSprites8(queue, &order[i], &vertices[i * VerticesPerSprite], textureSize, inverseTextureSize);
+                    }
+                });
+
+            KeepResult(static_cast<uint64_t>(vertices[count].position.x > 0.f));
+
+            printf(" %12.1f", SpritesPerSecond(count, avx) / 1e6);
+        }
+        else
+    #endif
+        {
+            printf(" %12s", "-");
+        }
+
+        printf("\n");
+    }
+
+    return true;
+}
+
+
+BENCHMARK(SpriteExpansionParallel)
+{
+    WorkerPool& pool = WorkerPool::Get();
+
+    printf("%zu threads in the worker pool, at least %zu sprites per chunk\n", pool.GetThreadCount(), SpriteExpansion::ParallelChunkSize);
+    if (pool.GetThreadCount() < 2)
+    {
+        printf("The pool has no workers on this machine, so the parallel loop runs inline.\n");
+    }
+
+    printf("%-14s %12s %12s   (ns per sprite)\n", "sprites", "one thread", "parallel");
+
+    for (const size_t count : { size_t(1000), size_t(10000), size_t(100000) })
+    {
+        std::mt19937 rng(static_cast<uint32_t>(count));
+
+        const auto queue = MakeTestSprites(rng, count);
+        const auto order = MakeTestSpriteOrder(rng, count);
+
+        const XMVECTOR textureSize = GetTestTextureSize();
+        const XMVECTOR inverseTextureSize = XMVectorReciprocal(textureSize);
+
+        std::vector<TestSpriteVertex> single(count * VerticesPerSprite);
+        std::vector<TestSpriteVertex> parallel(count * VerticesPerSprite);
+
+        const size_t iterations = std::max<size_t>(1, (size_t(1) << 22) / count);
+
+        const double oneThread = MeasureNanoseconds(iterations, [&]()
+            {
+                SpriteExpansion::RenderSprites(queue, order.data(), count, single.data(), textureSize, inverseTextureSize);
+            });
+
+        const double chunked = MeasureNanoseconds(iterations, [&]()
+            {
+                pool.ParallelFor(count, SpriteExpansion::ParallelChunkSize, [&](size_t begin, size_t end) noexcept
+                    {
+                        SpriteExpansion::RenderSprites(queue, order.data() + begin, end - begin, parallel.data() + begin * VerticesPerSprite, textureSize, inverseTextureSize);
+                    });
+            });
+
+        // The wide kernels match RenderSprite bit for bit, so where the chunks split cannot matter.
+        if (memcmp(single.data(), parallel.data(), single.size() * sizeof(TestSpriteVertex)) != 0)
+        {
+            printf("ERROR: the chunked expansion of %zu sprites differs from the single-threaded one\n", count);
+            return false;
+        }
+
+        char label[32];
+        snprintf(label, sizeof(label), "%zu", count);
+
+        printf("%-14s %12.2f %12.2f\n", label, oneThread / double(count), chunked / double(count));
+    }
+
+    return true;
+}
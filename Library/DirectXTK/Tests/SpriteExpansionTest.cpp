@@ -0,0 +1,254 @@
+//--------------------------------------------------------------------------------------
+// File: SpriteExpansionTest.cpp
+//
+// Checks that the four and eight-wide sprite expansion kernels write exactly the vertices
+// RenderSprite does, bit for bit, that RenderSprite itself puts the corners in the right
+// places, and that PackSprites describes the same corners.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHarness.h"
+#include "TestSprites.h"
+
+#include <cmath>
+#include <cstring>
+
+using namespace DirectX;
+using namespace DirectX::Tests;
+
+namespace
+{
+    using SpriteExpansion::VerticesPerSprite;
+
+    constexpr size_t SpriteCount = 4096;
+
+
+    // Expands every sprite in order through RenderSprite.
+    std::vector<TestSpriteVertex> ExpandOneAtATime(TestSpriteQueue const& queue, std::vector<uint32_t> const& order)
+    {
+        const XMVECTOR textureSize = GetTestTextureSize();
+        const XMVECTOR inverseTextureSize = XMVectorReciprocal(textureSize);
+
+        std::vector<TestSpriteVertex> vertices(order.size() * VerticesPerSprite);
+
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            SpriteExpansion::RenderSprite(queue, order[i], &vertices[i * VerticesPerSprite], textureSize, inverseTextureSize);
+        }
+
+        return vertices;
+    }
+
+
+    bool CheckIdentical(std::vector<TestSpriteVertex> const& expected, std::vector<TestSpriteVertex> const& actual, std::vector<uint32_t> const& order, char const* path)
+    {
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            if (memcmp(&expected[i * VerticesPerSprite], &actual[i * VerticesPerSprite], sizeof(TestSpriteVertex) * VerticesPerSprite) != 0)
+            {
+                printf("ERROR: %s differs from RenderSprite for sprite %u, drawn at %zu\n", path, order[i], i);
+                return false;
+            }
+        }
+
+        return true;
+    }
+}
+
+
+TEST_CASE(SpriteExpansionFourWideMatchesScalar)
+{
+    std::mt19937 rng(3);
+
+    const auto queue = MakeTestSprites(rng, SpriteCount);
+    const auto order = MakeTestSpriteOrder(rng, SpriteCount);
+    const auto expected = ExpandOneAtATime(queue, order);
+
+    const XMVECTOR textureSize = GetTestTextureSize();
+    const XMVECTOR inverseTextureSize = XMVectorReciprocal(textureSize);
+
+    std::vector<TestSpriteVertex> vertices(SpriteCount * VerticesPerSprite);
+
+    for (size_t i = 0; i < SpriteCount; i += 4)
+    {
+        SpriteExpansion::RenderSprites4(queue, &order[i], &vertices[i * VerticesPerSprite], textureSize, inverseTextureSize);
+    }
+
+    return CheckIdentical(expected, vertices, order, "RenderSprites4");
+}
+
+
+TEST_CASE(SpriteExpansionEightWideMatchesScalar)
+{
+#if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+    // RenderSprites never takes the eight-wide path on CPUs without AVX.
+    if (!SpriteExpansion::IsAVXSupported())
+        return true;
+
+    std::mt19937 rng(8);
+
+    const auto queue = MakeTestSprites(rng, SpriteCount);
+    const auto order = MakeTestSpriteOrder(rng, SpriteCount);
+    const auto expected = ExpandOneAtATime(queue, order);
+
+    const XMVECTOR textureSize = GetTestTextureSize();
+    const XMVECTOR inverseTextureSize = XMVectorReciprocal(textureSize);
+
+    std::vector<TestSpriteVertex> vertices(SpriteCount * VerticesPerSprite);
+
+    for (size_t i = 0; i < SpriteCount; i += 8)
+    {
+        SpriteExpansion::RenderSprites8(queue, &order[i], &vertices[i * VerticesPerSprite], textureSize, inverseTextureSize);
+    }
+
+    return CheckIdentical(expected, vertices, order, "RenderSprites8");
+#else
+    return true;
+#endif
+}
+
+
+// Runs whose length is not a multiple of eight finish on the narrower paths.
+TEST_CASE(SpriteExpansionRunsMatchScalar)
+{
+    std::mt19937 rng(11);
+
+    const auto queue = MakeTestSprites(rng, SpriteCount);
+    const auto order = MakeTestSpriteOrder(rng, SpriteCount);
+    const auto expected = ExpandOneAtATime(queue, order);
+
+    const XMVECTOR textureSize = GetTestTextureSize();
+    const XMVECTOR inverseTextureSize = XMVectorReciprocal(textureSize);
+
+    std::vector<TestSpriteVertex> vertices(SpriteCount * VerticesPerSprite);
+
+    for (size_t start = 0; start < SpriteCount; )
+    {
+        const size_t count = std::min<size_t>(1 + rng() % 40, SpriteCount - start);
+
+        SpriteExpansion::RenderSprites(queue, &order[start], count, &vertices[start * VerticesPerSprite], textureSize, inverseTextureSize);
+
+        start += count;
+    }
+
+    return CheckIdentical(expected, vertices, order, "RenderSprites");
+}
+
+
+// An unrotated sprite lands on its destination rectangle, with the corners in Z order and the
+// texture coordinates following the mirroring flags.
+TEST_CASE(SpriteExpansionCorners)
+{
+    TestSpriteQueue queue(4);
+
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        static_cast<XMFLOAT4A&>(queue.source[i]) = XMFLOAT4A(64.f, 32.f, 32.f, 16.f);
+        static_cast<XMFLOAT4A&>(queue.destination[i]) = XMFLOAT4A(100.f, 200.f, 64.f, 64.f);
+        static_cast<XMFLOAT4A&>(queue.color[i]) = XMFLOAT4A(0.25f, 0.5f, 0.75f, 1.f);
+        static_cast<XMFLOAT4A&>(queue.originRotationDepth[i]) = XMFLOAT4A(16.f, 0.f, 0.f, 0.5f);
+        queue.flags[i] = SpriteExpansion::SourceInTexels | SpriteExpansion::DestSizeInPixels | i;
+    }
+
+    const XMVECTOR textureSize = GetTestTextureSize();
+
+    TestSpriteVertex vertices[VerticesPerSprite];
+
+    static const float expectedPositions[VerticesPerSprite][2] = { { 68.f, 200.f }, { 132.f, 200.f }, { 68.f, 264.f }, { 132.f, 264.f } };
+    static const float edgesU[2] = { 0.25f, 0.375f };
+    static const float edgesV[2] = { 0.25f, 0.375f };
+
+    for (uint32_t sprite = 0; sprite < 4; sprite++)
+    {
+        SpriteExpansion::RenderSprite(queue, sprite, vertices, textureSize, XMVectorReciprocal(textureSize));
+
+        for (size_t i = 0; i < VerticesPerSprite; i++)
+        {
+            TestSpriteVertex const& v = vertices[i];
+
+            const size_t corner = i ^ sprite;
+
+            if (v.position.x != expectedPositions[i][0] || v.position.y != expectedPositions[i][1] || v.position.z != 0.5f)
+            {
+                printf("ERROR: corner %zu of sprite %u is at (%g, %g, %g)\n", i, sprite, v.position.x, v.position.y, v.position.z);
+                return false;
+            }
+
+            if (v.color.x != 0.25f || v.color.y != 0.5f || v.color.z != 0.75f || v.color.w != 1.f)
+            {
+                printf("ERROR: corner %zu of sprite %u has color (%g, %g, %g, %g)\n", i, sprite, v.color.x, v.color.y, v.color.z, v.color.w);
+                return false;
+            }
+
+            if (std::fabs(v.textureCoordinate.x - edgesU[corner & 1]) > 1e-6f || std::fabs(v.textureCoordinate.y - edgesV[(corner >> 1) & 1]) > 1e-6f)
+            {
+                printf("ERROR: corner %zu of sprite %u has texture coordinate (%g, %g)\n", i, sprite, v.textureCoordinate.x, v.textureCoordinate.y);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+// An instance holds one corner plus the two edges leading away from it, so adding those up
+// must land on the corners RenderSprite writes, up to rounding.
+TEST_CASE(SpriteExpansionPackMatchesVertices)
+{
+    std::mt19937 rng(64);
+
+    const auto queue = MakeTestSprites(rng, SpriteCount);
+    const auto order = MakeTestSpriteOrder(rng, SpriteCount);
+    const auto vertices = ExpandOneAtATime(queue, order);
+
+    std::vector<SpriteInstance> instances(SpriteCount);
+
+    const XMVECTOR textureSize = GetTestTextureSize();
+
+    SpriteExpansion::PackSprites(queue, order.data(), nullptr, SpriteCount, instances.data(), textureSize, XMVectorReciprocal(textureSize));
+
+    for (size_t i = 0; i < SpriteCount; i++)
+    {
+        SpriteInstance const& instance = instances[i];
+
+        for (size_t corner = 0; corner < VerticesPerSprite; corner++)
+        {
+            TestSpriteVertex const& v = vertices[i * VerticesPerSprite + corner];
+
+            const float stepX = float(corner & 1);
+            const float stepY = float(corner >> 1);
+
+            const float x = instance.positionAxisX.x + stepX * instance.positionAxisX.z + stepY * instance.axisYDepthSlot.x;
+            const float y = instance.positionAxisX.y + stepX * instance.positionAxisX.w + stepY * instance.axisYDepthSlot.y;
+
+            // The test sprites are up to about 1000 pixels from the origin and 800 across.
+            if (std::fabs(x - v.position.x) > 1e-3f || std::fabs(y - v.position.y) > 1e-3f || instance.axisYDepthSlot.z != v.position.z)
+            {
+                printf("ERROR: corner %zu of sprite %u packs to (%g, %g), expanded to (%g, %g)\n", corner, order[i], x, y, v.position.x, v.position.y);
+                return false;
+            }
+
+            const float u = instance.textureCoordinates.x + stepX * instance.textureCoordinates.z;
+            const float t = instance.textureCoordinates.y + stepY * instance.textureCoordinates.w;
+
+            if (std::fabs(u - v.textureCoordinate.x) > 1e-5f || std::fabs(t - v.textureCoordinate.y) > 1e-5f)
+            {
+                printf("ERROR: corner %zu of sprite %u packs texture coordinate (%g, %g), expanded to (%g, %g)\n", corner, order[i], u, t, v.textureCoordinate.x, v.textureCoordinate.y);
+                return false;
+            }
+
+            if (memcmp(&instance.color, &v.color, sizeof(XMFLOAT4)) != 0)
+            {
+                printf("ERROR: sprite %u packs a different color\n", order[i]);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
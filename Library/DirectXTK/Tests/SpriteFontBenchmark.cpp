@@ -0,0 +1,194 @@
+//--------------------------------------------------------------------------------------
+// File: SpriteFontBenchmark.cpp
+//
+// Compares the CPU cost of queueing text through DrawString, which hands glyphs to
+// SpriteBatch::DrawRun in bulk, with the per-glyph Draw loop it replaced.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "SpriteFontTestData.h"
+
+using namespace DirectX;
+using namespace DirectX::Tests;
+
+namespace
+{
+    // Times the draw calls made by draw between Begin and End, leaving out End, which sorts and
+    // submits the sprites, and the wait for WARP to rasterize them. Returns the best frame.
+    template<typename TDraw>
+    double TimeQueueing(TestDevice const& test, SpriteBatch& batch, TDraw&& draw)
+    {
+        using clock = std::chrono::steady_clock;
+
+        constexpr int Frames = 20;
+
+        double best = DBL_MAX;
+
+        for (int frame = 0; frame < Frames; frame++)
+        {
+            batch.Begin();
+
+            const auto start = clock::now();
+
+            draw();
+
+            const std::chrono::duration<double, std::nano> elapsed = clock::now() - start;
+
+            batch.End();
+
+            WaitForGpu(test.device.Get(), test.context.Get());
+
+            best = std::min(best, elapsed.count());
+        }
+
+        return best;
+    }
+}
+
+
+BENCHMARK(SpriteFontDrawString)
+{
+    TestDevice test;
+
+    if (!CreateTestDevice(test))
+        return false;
+
+    auto context = test.context.Get();
+
+    // A small target keeps End cheap, since only the queueing is timed.
+    TestRenderTarget renderTarget(test.device.Get(), 64, 64);
+
+    renderTarget.Begin(context);
+
+    TestSpriteFont testFont(test.device.Get(), 11);
+
+    auto& font = *testFont.font;
+
+    SpriteBatch batch(context);
+
+    printf("%10s %14s %14s %14s   (ns per glyph)\n", "words", "per glyph", "DrawString", "cached");
+
+    for (const size_t words : { size_t(2), size_t(20), size_t(200) })
+    {
+        std::mt19937 rng(static_cast<uint32_t>(words));
+
+        std::vector<std::string> strings;
+        size_t glyphCount = 0;
+
+        for (size_t i = 0; i < 20000 / words; i++)
+        {
+            strings.push_back(MakeTestText(rng, words));
+
+            LayoutGlyphs(strings.back().c_str(), font.GetLineSpacing(), true, testFont.glyphs.Finder(),
+                [&](SpriteFont::Glyph const*, float, float, float) { glyphCount++; },
+                [](float) noexcept {});
+        }
+
+        auto drawAll = [&](auto&& drawString)
+            {
+                for (size_t i = 0; i < strings.size(); i++)
+                {
+                    const XMFLOAT2 position(float(i % 50), float(i % 37));
+
+                    drawString(strings[i].c_str(), XMLoadFloat2(&position));
+                }
+            };
+
+        const double reference = TimeQueueing(test, batch, [&]()
+            {
+                drawAll([&](char const* text, FXMVECTOR position)
+                    {
+                        ReferenceDrawString(testFont, batch, text, position, Colors::White, 0.f, g_XMZero, g_XMOne, SpriteEffects_None, 0.f);
+                    });
+            });
+
+        font.SetLayoutCacheSize(0);
+
+        const double uncached = TimeQueueing(test, batch, [&]()
+            {
+                drawAll([&](char const* text, FXMVECTOR position)
+                    {
+                        font.DrawString(&batch, text, position);
+                    });
+            });
+
+        // Large enough to hold every string, so all but the first frame hit.
+        font.SetLayoutCacheSize(strings.size());
+
+        const double cached = TimeQueueing(test, batch, [&]()
+            {
+                drawAll([&](char const* text, FXMVECTOR position)
+                    {
+                        font.DrawString(&batch, text, position);
+                    });
+            });
+
+        font.SetLayoutCacheSize(0);
+
+        const double glyphs = double(std::max(glyphCount, size_t(1)));
+
+        printf("%10zu %14.2f %14.2f %14.2f\n", words, reference / glyphs, uncached / glyphs, cached / glyphs);
+    }
+
+    return true;
+}
+
+
+BENCHMARK(SpriteBatchDrawRun)
+{
+    TestDevice test;
+
+    if (!CreateTestDevice(test))
+        return false;
+
+    auto context = test.context.Get();
+
+    TestRenderTarget renderTarget(test.device.Get(), 64, 64);
+
+    renderTarget.Begin(context);
+
+    auto texture = CreateTestTexture(test.device.Get(), 64, 64, 1);
+
+    SpriteBatch batch(context);
+
+    printf("%10s %14s %14s   (ns per sprite)\n", "run length", "Draw", "DrawRun");
+
+    constexpr size_t SpriteCount = 20000;
+
+    std::vector<SpriteRunElement> elements(SpriteCount);
+
+    for (size_t i = 0; i < SpriteCount; i++)
+    {
+        elements[i].position = XMFLOAT2(float(i % 50), float(i % 37));
+        elements[i].origin = XMFLOAT2(-float(i % 200) * 8.f, -float(i / 200) * 12.f);
+        elements[i].sourceRectangle = { long(i % 8) * 8, 0, long(i % 8) * 8 + 8, 12 };
+    }
+
+    for (const size_t runLength : { size_t(1), size_t(16), size_t(256) })
+    {
+        const double draw = TimeQueueing(test, batch, [&]()
+            {
+                for (auto const& element : elements)
+                {
+                    batch.Draw(texture.Get(), XMLoadFloat2(&element.position), &element.sourceRectangle, Colors::White, 0.f,
+                        XMLoadFloat2(&element.origin), g_XMOne);
+                }
+            });
+
+        const double run = TimeQueueing(test, batch, [&]()
+            {
+                for (size_t i = 0; i < SpriteCount; i += runLength)
+                {
+                    batch.DrawRun(texture.Get(), elements.data() + i, std::min(runLength, SpriteCount - i));
+                }
+            });
+
+        printf("%10zu %14.2f %14.2f\n", runLength, draw / double(SpriteCount), run / double(SpriteCount));
+    }
+
+    return true;
+}
@@ -0,0 +1,167 @@
+//--------------------------------------------------------------------------------------
+// File: SpriteFontCacheTest.cpp
+//
+// Checks that SpriteFont's layout cache changes nothing about what DrawString draws or what
+// MeasureString and MeasureDrawBounds report, whether a string hits or misses, and after the
+// font's settings change.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "SpriteFontTestData.h"
+
+using namespace DirectX;
+using namespace DirectX::Tests;
+
+namespace
+{
+    // Draws every string in one deferred batch, returning the vertices generated.
+    template<typename TChar>
+    std::vector<VertexPositionColorTexture> DrawStrings(ID3D11DeviceContext* context, VertexCapture& capture, SpriteBatch& batch, SpriteFont const& font, std::vector<std::basic_string<TChar>> const& strings)
+    {
+        batch.Begin(SpriteSortMode_Deferred, nullptr, nullptr, nullptr, nullptr, capture.Begin(context));
+        DrawTestStrings(font, batch, strings, 17);
+        batch.End();
+
+        return capture.End(context);
+    }
+
+
+    template<typename TChar>
+    bool MeasurementsMatch(SpriteFont const& font, std::vector<std::basic_string<TChar>> const& strings, std::vector<XMFLOAT2> const& sizes, std::vector<RECT> const& bounds, char const* description)
+    {
+        for (size_t i = 0; i < strings.size(); i++)
+        {
+            XMFLOAT2 size;
+            XMStoreFloat2(&size, font.MeasureString(strings[i].c_str()));
+
+            const RECT rect = font.MeasureDrawBounds(strings[i].c_str(), XMFLOAT2(12.5f, -7.f));
+
+            if (size.x != sizes[i].x || size.y != sizes[i].y
+                || rect.left != bounds[i].left || rect.top != bounds[i].top || rect.right != bounds[i].right || rect.bottom != bounds[i].bottom)
+            {
+                printf("ERROR: %s: string %zu measures %g x %g, bounds (%ld, %ld, %ld, %ld), expected %g x %g, (%ld, %ld, %ld, %ld)\n",
+                    description, i, size.x, size.y, rect.left, rect.top, rect.right, rect.bottom,
+                    sizes[i].x, sizes[i].y, bounds[i].left, bounds[i].top, bounds[i].right, bounds[i].bottom);
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+
+    template<typename TChar>
+    bool CheckCache(TestDevice& test, VertexCapture& capture, TestSpriteFont& testFont, std::vector<std::basic_string<TChar>> const& strings)
+    {
+        auto context = test.context.Get();
+        auto& font = *testFont.font;
+
+        SpriteBatch batch(context);
+
+        // Settings the cache has to notice: the original ones, a new line spacing, and a new default character.
+        for (int settings = 0; settings < 3; settings++)
+        {
+            if (settings == 1)
+            {
+                font.SetLineSpacing(font.GetLineSpacing() + 7.f);
+            }
+            else if (settings == 2)
+            {
+                font.SetDefaultCharacter(L'#');
+            }
+
+            font.SetLayoutCacheSize(0);
+
+            const auto expected = DrawStrings(context, capture, batch, font, strings);
+
+            std::vector<XMFLOAT2> sizes;
+            std::vector<RECT> bounds;
+
+            for (auto const& text : strings)
+            {
+                XMFLOAT2 size;
+                XMStoreFloat2(&size, font.MeasureString(text.c_str()));
+
+                sizes.push_back(size);
+                bounds.push_back(font.MeasureDrawBounds(text.c_str(), XMFLOAT2(12.5f, -7.f)));
+            }
+
+            // The first pass fills the cache, and the second hits it. The small capacity makes the
+            // strings evict one another, so the third pass misses again.
+            for (const size_t capacity : { size_t(64), size_t(64), size_t(5) })
+            {
+                font.SetLayoutCacheSize(capacity);
+
+                char description[64];
+                snprintf(description, sizeof(description), "%zu-byte text, settings %d, cache size %zu", sizeof(TChar), settings, capacity);
+
+                if (!CompareVertices(expected, DrawStrings(context, capture, batch, font, strings), description))
+                    return false;
+
+                if (!MeasurementsMatch(font, strings, sizes, bounds, description))
+                    return false;
+            }
+        }
+
+        font.SetLayoutCacheSize(0);
+
+        return true;
+    }
+}
+
+
+TEST_CASE(SpriteFontCachedDrawStringMatches)
+{
+    TestDevice test;
+
+    if (!CreateTestDevice(test))
+        return false;
+
+    SetTestViewport(test.context.Get(), 1024, 1024);
+
+    std::mt19937 rng(18);
+
+    std::vector<std::string> strings;
+    std::vector<std::wstring> wideStrings;
+
+    for (int i = 0; i < 40; i++)
+    {
+        strings.push_back(MakeTestText(rng, 1 + rng() % 30));
+        wideStrings.push_back(WidenUtf8(strings.back()));
+    }
+
+    // Empty strings, and strings with nothing visible.
+    strings.push_back("");
+    strings.push_back("   \n  ");
+    wideStrings.push_back(L"");
+    wideStrings.push_back(L"\t\n");
+
+    size_t glyphCount = 0;
+
+    for (auto const& text : strings)
+    {
+        glyphCount += text.size();
+    }
+
+    VertexCapture capture(test.device.Get(), glyphCount * 6);
+
+    {
+        TestSpriteFont font(test.device.Get(), 7);
+
+        if (!CheckCache(test, capture, font, strings))
+            return false;
+    }
+
+    {
+        TestSpriteFont font(test.device.Get(), 8);
+
+        if (!CheckCache(test, capture, font, wideStrings))
+            return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,151 @@
+//--------------------------------------------------------------------------------------
+// File: SpriteFontDrawStringTest.cpp
+//
+// Checks that DrawString, which hands glyphs to SpriteBatch::DrawRun in bulk, draws exactly
+// what calling SpriteBatch::Draw once per glyph used to.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "SpriteFontTestData.h"
+
+using namespace DirectX;
+using namespace DirectX::Tests;
+
+namespace
+{
+    // Draws every string with either DrawString or the reference loop, in one batch.
+    template<typename TChar>
+    std::vector<VertexPositionColorTexture> DrawStrings(ID3D11DeviceContext* context, VertexCapture& capture, SpriteBatch& batch,
+        TestSpriteFont const& testFont, std::vector<std::basic_string<TChar>> const& strings, SpriteSortMode sortMode, bool reference)
+    {
+        std::mt19937 rng(21);
+
+        std::uniform_real_distribution<float> position(-100.f, 900.f);
+        std::uniform_real_distribution<float> unit(0.f, 1.f);
+        std::uniform_real_distribution<float> angle(-3.f, 3.f);
+        std::uniform_real_distribution<float> scale(0.5f, 2.f);
+
+        batch.Begin(sortMode, nullptr, nullptr, nullptr, nullptr, capture.Begin(context));
+
+        for (size_t i = 0; i < strings.size(); i++)
+        {
+            const XMVECTORF32 color = { { { unit(rng), unit(rng), unit(rng), 1.f } } };
+            const float rotation = (i % 3) ? angle(rng) : 0.f;
+            const auto effects = static_cast<SpriteEffects>(i & 3);
+            const float depth = unit(rng);
+
+            XMFLOAT2 at;
+            at.x = position(rng);
+            at.y = position(rng);
+
+            XMFLOAT2 origin;
+            origin.x = unit(rng) * 40.f;
+            origin.y = unit(rng) * 40.f;
+
+            XMFLOAT2 scale2;
+            scale2.x = scale(rng);
+            scale2.y = scale(rng);
+
+            if (reference)
+            {
+                ReferenceDrawString(testFont, batch, strings[i].c_str(), XMLoadFloat2(&at), color, rotation, XMLoadFloat2(&origin), XMLoadFloat2(&scale2), effects, depth);
+            }
+            else
+            {
+                testFont.font->DrawString(&batch, strings[i].c_str(), XMLoadFloat2(&at), color, rotation, XMLoadFloat2(&origin), XMLoadFloat2(&scale2), effects, depth);
+            }
+        }
+
+        batch.End();
+
+        return capture.End(context);
+    }
+
+
+    template<typename TChar>
+    bool CheckDrawString(TestDevice& test, VertexCapture& capture, TestSpriteFont& testFont, std::vector<std::basic_string<TChar>> const& strings)
+    {
+        auto context = test.context.Get();
+
+        SpriteBatch batch(context);
+
+        for (const SpriteSortMode sortMode : { SpriteSortMode_Deferred, SpriteSortMode_Immediate, SpriteSortMode_BackToFront })
+        {
+            const auto expected = DrawStrings(context, capture, batch, testFont, strings, sortMode, true);
+
+            // Without the layout cache DrawString writes glyph runs as it lays text out, and with
+            // it the cached layout draws its stored runs.
+            for (const size_t cacheSize : { size_t(0), size_t(64) })
+            {
+                testFont.font->SetLayoutCacheSize(cacheSize);
+
+                char description[64];
+                snprintf(description, sizeof(description), "%zu-byte text, sort mode %d, cache size %zu", sizeof(TChar), int(sortMode), cacheSize);
+
+                if (!CompareVertices(expected, DrawStrings(context, capture, batch, testFont, strings, sortMode, false), description))
+                    return false;
+            }
+
+            testFont.font->SetLayoutCacheSize(0);
+        }
+
+        return true;
+    }
+}
+
+
+TEST_CASE(SpriteFontDrawStringMatchesPerGlyphDraw)
+{
+    TestDevice test;
+
+    if (!CreateTestDevice(test))
+        return false;
+
+    SetTestViewport(test.context.Get(), 1024, 1024);
+
+    std::mt19937 rng(22);
+
+    std::vector<std::string> strings;
+    std::vector<std::wstring> wideStrings;
+
+    // Enough glyphs for several full chunks of the run writer, and some strings longer than one chunk.
+    for (int i = 0; i < 60; i++)
+    {
+        strings.push_back(MakeTestText(rng, 1 + rng() % ((i % 10) ? 30 : 200)));
+        wideStrings.push_back(WidenUtf8(strings.back()));
+    }
+
+    strings.push_back("");
+    strings.push_back(" \n\t ");
+    wideStrings.push_back(L"");
+    wideStrings.push_back(L"\n \n");
+
+    size_t glyphCount = 0;
+
+    for (auto const& text : strings)
+    {
+        glyphCount += text.size();
+    }
+
+    VertexCapture capture(test.device.Get(), glyphCount * 6);
+
+    {
+        TestSpriteFont font(test.device.Get(), 9);
+
+        if (!CheckDrawString(test, capture, font, strings))
+            return false;
+    }
+
+    {
+        TestSpriteFont font(test.device.Get(), 10);
+
+        if (!CheckDrawString(test, capture, font, wideStrings))
+            return false;
+    }
+
+    return true;
+}
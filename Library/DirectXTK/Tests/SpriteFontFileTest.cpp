@@ -0,0 +1,175 @@
+//--------------------------------------------------------------------------------------
+// File: SpriteFontFileTest.cpp
+//
+// Checks that a font loaded from a mapped .spritefont file, with the glyphs used in place or
+// copied, draws and measures like one made from the same glyphs in memory, and that
+// keepFileMapped = false lets the file go while the font is still in use.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "SpriteFontTestData.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+using namespace DirectX;
+using namespace DirectX::Tests;
+
+namespace
+{
+    constexpr uint32_t TextureWidth = 1024;
+    constexpr uint32_t TextureHeight = 64;
+
+
+    template<typename T>
+    void WriteValue(std::ofstream& stream, T const& value)
+    {
+        stream.write(reinterpret_cast<char const*>(&value), sizeof(T));
+    }
+
+
+    // Writes glyphs in the MakeSpriteFont format, with an RGBA texture the size of TestSpriteFont's.
+    bool WriteSpriteFontFile(std::filesystem::path const& fileName, TestFont<SpriteFont::Glyph> const& font)
+    {
+        std::ofstream stream(fileName, std::ios::binary | std::ios::trunc);
+
+        stream.write("DXTKfont", 8);
+
+        auto const& glyphs = font.GetGlyphs();
+
+        WriteValue(stream, static_cast<uint32_t>(glyphs.size()));
+        stream.write(reinterpret_cast<char const*>(glyphs.data()), static_cast<std::streamsize>(glyphs.size() * sizeof(SpriteFont::Glyph)));
+
+        WriteValue(stream, font.GetLineSpacing());
+        WriteValue(stream, uint32_t('?'));
+
+        WriteValue(stream, TextureWidth);
+        WriteValue(stream, TextureHeight);
+        WriteValue(stream, DXGI_FORMAT_R8G8B8A8_UNORM);
+        WriteValue(stream, TextureWidth * 4);
+        WriteValue(stream, TextureHeight);
+
+        const std::vector<char> pixels(TextureWidth * TextureHeight * 4, char(0x7F));
+
+        stream.write(pixels.data(), static_cast<std::streamsize>(pixels.size()));
+
+        return stream.good();
+    }
+
+
+    std::vector<VertexPositionColorTexture> DrawStrings(ID3D11DeviceContext* context, VertexCapture& capture, SpriteFont const& font, std::vector<std::string> const& strings)
+    {
+        SpriteBatch batch(context);
+
+        batch.Begin(SpriteSortMode_Deferred, nullptr, nullptr, nullptr, nullptr, capture.Begin(context));
+        DrawTestStrings(font, batch, strings, 26);
+        batch.End();
+
+        return capture.End(context);
+    }
+
+
+    bool MeasuresMatch(SpriteFont const& expected, SpriteFont const& actual, std::vector<std::string> const& strings, char const* description)
+    {
+        for (auto const& text : strings)
+        {
+            XMFLOAT2 expectedSize, actualSize;
+            XMStoreFloat2(&expectedSize, expected.MeasureString(text.c_str()));
+            XMStoreFloat2(&actualSize, actual.MeasureString(text.c_str()));
+
+            const RECT expectedBounds = expected.MeasureDrawBounds(text.c_str(), XMFLOAT2(3.f, 4.f));
+            const RECT actualBounds = actual.MeasureDrawBounds(text.c_str(), XMFLOAT2(3.f, 4.f));
+
+            if (expectedSize.x != actualSize.x || expectedSize.y != actualSize.y
+                || memcmp(&expectedBounds, &actualBounds, sizeof(RECT)) != 0)
+            {
+                printf("ERROR: %s: \"%s\" measures differently\n", description, text.c_str());
+                return false;
+            }
+        }
+
+        return true;
+    }
+}
+
+
+TEST_CASE(SpriteFontLoadsMappedFile)
+{
+    TestDevice test;
+
+    if (!CreateTestDevice(test))
+        return false;
+
+    auto context = test.context.Get();
+
+    SetTestViewport(context, 1024, 1024);
+
+    TestSpriteFont reference(test.device.Get(), 12);
+
+    const auto fileName = std::filesystem::temp_directory_path() / L"SpriteFontFileTest.spritefont";
+
+    CHECK(WriteSpriteFontFile(fileName, reference.glyphs));
+
+    // Deletes the file, returning whether that succeeded.
+    auto deleteFile = [&]()
+        {
+            std::error_code error;
+
+            return std::filesystem::remove(fileName, error);
+        };
+
+    std::mt19937 rng(27);
+
+    std::vector<std::string> strings;
+    size_t glyphCount = 0;
+
+    for (int i = 0; i < 30; i++)
+    {
+        strings.push_back(MakeTestText(rng, 1 + rng() % 20));
+        glyphCount += strings.back().size();
+    }
+
+    VertexCapture capture(test.device.Get(), glyphCount * 6);
+
+    const auto expected = DrawStrings(context, capture, *reference.font, strings);
+
+    for (const bool keepFileMapped : { true, false })
+    {
+        char description[32];
+        snprintf(description, sizeof(description), "keepFileMapped = %d", int(keepFileMapped));
+
+        {
+            SpriteFont font(test.device.Get(), fileName.c_str(), false, keepFileMapped);
+
+            CHECK(font.GetLineSpacing() == reference.font->GetLineSpacing());
+            CHECK(font.GetDefaultCodePoint() == '?');
+
+            if (!keepFileMapped)
+            {
+                // The file was released once the font was loaded, so it can be deleted and rewritten
+                // while the font is still in use.
+                CHECK(deleteFile());
+                CHECK(WriteSpriteFontFile(fileName, TestFont<SpriteFont::Glyph>(13)));
+            }
+
+            if (!CompareVertices(expected, DrawStrings(context, capture, font, strings), description))
+                return false;
+
+            if (!MeasuresMatch(*reference.font, font, strings, description))
+                return false;
+        }
+
+        // Either way, destroying the font releases the file.
+        CHECK(deleteFile());
+        CHECK(WriteSpriteFontFile(fileName, reference.glyphs));
+    }
+
+    deleteFile();
+
+    return true;
+}
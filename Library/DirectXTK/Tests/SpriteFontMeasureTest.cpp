@@ -0,0 +1,119 @@
+//--------------------------------------------------------------------------------------
+// File: SpriteFontMeasureTest.cpp
+//
+// Checks that SpriteFont's MeasureString, MeasureDrawBounds and MeasureText, which share one
+// pass through GlyphMetrics, report exactly what the separate measuring loops did.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "SpriteFontTestData.h"
+
+using namespace DirectX;
+using namespace DirectX::Tests;
+
+namespace
+{
+    template<typename TChar>
+    bool CheckMeasure(TestSpriteFont const& testFont, TChar const* text, XMFLOAT2 const& position, bool ignoreWhitespace, char const* description)
+    {
+        auto const& font = *testFont.font;
+
+        float width, height;
+        ReferenceMeasureString(text, testFont.glyphs, ignoreWhitespace, &width, &height);
+
+        const auto expected = ReferenceMeasureDrawBounds(text, testFont.glyphs, position.x, position.y, ignoreWhitespace);
+
+        size_t lineCount = 1;
+
+        LayoutGlyphs(text, testFont.glyphs.GetLineSpacing(), ignoreWhitespace, testFont.glyphs.Finder(),
+            [](SpriteFont::Glyph const*, float, float, float) noexcept {},
+            [&](float) noexcept { lineCount++; });
+
+        XMFLOAT2 size;
+        XMStoreFloat2(&size, font.MeasureString(text, ignoreWhitespace));
+
+        const RECT bounds = font.MeasureDrawBounds(text, position, ignoreWhitespace);
+        const auto metrics = font.MeasureText(text, position, ignoreWhitespace);
+
+        auto boundsMatch = [&](RECT const& rect) noexcept
+            {
+                return rect.left == expected.left && rect.top == expected.top && rect.right == expected.right && rect.bottom == expected.bottom;
+            };
+
+        if (size.x != width || size.y != height || metrics.size.x != width || metrics.size.y != height)
+        {
+            printf("ERROR: %s: measures %g x %g (MeasureText %g x %g), expected %g x %g\n", description,
+                size.x, size.y, metrics.size.x, metrics.size.y, width, height);
+            return false;
+        }
+
+        if (!boundsMatch(bounds) || !boundsMatch(metrics.drawBounds))
+        {
+            printf("ERROR: %s: bounds (%ld, %ld, %ld, %ld), expected (%ld, %ld, %ld, %ld)\n", description,
+                bounds.left, bounds.top, bounds.right, bounds.bottom, expected.left, expected.top, expected.right, expected.bottom);
+            return false;
+        }
+
+        if (metrics.lineCount != lineCount)
+        {
+            printf("ERROR: %s: %zu lines, expected %zu\n", description, metrics.lineCount, lineCount);
+            return false;
+        }
+
+        return true;
+    }
+}
+
+
+TEST_CASE(SpriteFontMeasuresLikeReference)
+{
+    TestDevice test;
+
+    if (!CreateTestDevice(test))
+        return false;
+
+    TestSpriteFont testFont(test.device.Get(), 30);
+
+    std::mt19937 rng(30);
+
+    std::uniform_real_distribution<float> coordinate(-300.f, 300.f);
+
+    std::vector<std::string> strings = { "", " ", "\t", "\n", "\r\n", " \n\n ", "\v\f", "\xE2\x80\x83word\xE2\x80\x83", "A\n" };
+
+    for (int i = 0; i < 200; i++)
+    {
+        strings.push_back(MakeTestText(rng, 1 + rng() % 25));
+    }
+
+    for (size_t i = 0; i < strings.size(); i++)
+    {
+        const auto wideText = WidenUtf8(strings[i]);
+
+        // Whole pixels, and fractions that truncate differently either side of zero.
+        XMFLOAT2 position(coordinate(rng), coordinate(rng));
+
+        if (i & 1)
+        {
+            position.x = float(int(position.x));
+            position.y = float(int(position.y));
+        }
+
+        for (const bool ignoreWhitespace : { true, false })
+        {
+            char description[64];
+            snprintf(description, sizeof(description), "string %zu, ignoreWhitespace %d", i, int(ignoreWhitespace));
+
+            if (!CheckMeasure(testFont, strings[i].c_str(), position, ignoreWhitespace, description))
+                return false;
+
+            if (!CheckMeasure(testFont, wideText.c_str(), position, ignoreWhitespace, description))
+                return false;
+        }
+    }
+
+    return true;
+}
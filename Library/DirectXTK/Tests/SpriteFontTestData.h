@@ -0,0 +1,151 @@
+//--------------------------------------------------------------------------------------
+// File: SpriteFontTestData.h
+//
+// A SpriteFont made from TestFont's glyphs, repeatable pseudo-random DrawString calls, and the
+// per-glyph DrawString loop that SpriteBatch::DrawRun replaced.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "DeviceTest.h"
+#include "TestFont.h"
+
+#include "GlyphLayout.h"
+#include "SpriteFont.h"
+
+#include <memory>
+#include <random>
+#include <string>
+
+
+namespace DirectX
+{
+    namespace Tests
+    {
+        struct TestSpriteFont
+        {
+            TestFont<SpriteFont::Glyph> glyphs;
+            Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> texture;
+            std::unique_ptr<SpriteFont> font;
+
+            TestSpriteFont(_In_ ID3D11Device* device, uint32_t seed) :
+                glyphs(seed),
+                texture(CreateTestTexture(device, 1024, 64, seed))
+            {
+                font = std::make_unique<SpriteFont>(texture.Get(), glyphs.GetGlyphs().data(), glyphs.GetGlyphs().size(), glyphs.GetLineSpacing());
+                font->SetDefaultCharacter(L'?');
+            }
+        };
+
+
+        // The per-glyph DrawString loop that DrawRun replaced.
+        template<typename TChar>
+        void XM_CALLCONV ReferenceDrawString(TestSpriteFont const& testFont, SpriteBatch& batch, TChar const* text,
+            FXMVECTOR position, FXMVECTOR color, float rotation, FXMVECTOR origin, GXMVECTOR scale, SpriteEffects effects, float layerDepth)
+        {
+            static const XMVECTORF32 axisDirectionTable[4] =
+            {
+                { { { -1, -1, 0, 0 } } },
+                { { {  1, -1, 0, 0 } } },
+                { { { -1,  1, 0, 0 } } },
+                { { {  1,  1, 0, 0 } } },
+            };
+
+            static const XMVECTORF32 axisIsMirroredTable[4] =
+            {
+                { { { 0, 0, 0, 0 } } },
+                { { { 1, 0, 0, 0 } } },
+                { { { 0, 1, 0, 0 } } },
+                { { { 1, 1, 0, 0 } } },
+            };
+
+            XMVECTOR baseOffset = origin;
+
+            if (effects)
+            {
+                baseOffset = XMVectorNegativeMultiplySubtract(testFont.font->MeasureString(text), axisIsMirroredTable[effects & 3], baseOffset);
+            }
+
+            auto texture = testFont.texture.Get();
+
+            LayoutGlyphs(text, testFont.font->GetLineSpacing(), true, testFont.glyphs.Finder(),
+                [&](SpriteFont::Glyph const* glyph, float x, float y, float)
+                {
+                    XMVECTOR offset = XMVectorMultiplyAdd(XMVectorSet(x, y + glyph->YOffset, 0, 0), axisDirectionTable[effects & 3], baseOffset);
+
+                    if (effects)
+                    {
+                        XMVECTOR glyphRect = XMConvertVectorIntToFloat(XMLoadInt4(reinterpret_cast<uint32_t const*>(&glyph->Subrect)), 0);
+
+                        glyphRect = XMVectorSubtract(XMVectorSwizzle<2, 3, 0, 1>(glyphRect), glyphRect);
+
+                        offset = XMVectorMultiplyAdd(glyphRect, axisIsMirroredTable[effects & 3], offset);
+                    }
+
+                    batch.Draw(texture, position, &glyph->Subrect, color, rotation, offset, scale, effects, layerDepth);
+                },
+                [](float) noexcept {});
+        }
+
+
+        // Draws each string with a mix of positions, colors, rotations, origins, scales and
+        // mirroring, covering the XMFLOAT2 and vector overloads of DrawString.
+        template<typename TChar>
+        void DrawTestStrings(SpriteFont const& font, SpriteBatch& batch, std::vector<std::basic_string<TChar>> const& strings, uint32_t seed)
+        {
+            std::mt19937 rng(seed);
+
+            std::uniform_real_distribution<float> position(-100.f, 900.f);
+            std::uniform_real_distribution<float> unit(0.f, 1.f);
+            std::uniform_real_distribution<float> angle(-3.f, 3.f);
+            std::uniform_real_distribution<float> scale(0.5f, 2.f);
+
+            for (size_t i = 0; i < strings.size(); i++)
+            {
+                auto const text = strings[i].c_str();
+
+                const XMVECTORF32 color = { { { unit(rng), unit(rng), unit(rng), 1.f } } };
+                const float rotation = (i % 3) ? angle(rng) : 0.f;
+                const auto effects = static_cast<SpriteEffects>(i & 3);
+                const float depth = unit(rng);
+
+                // Separate statements, since the order function arguments are evaluated in is unspecified.
+                XMFLOAT2 at;
+                at.x = position(rng);
+                at.y = position(rng);
+
+                XMFLOAT2 origin;
+                origin.x = unit(rng) * 40.f;
+                origin.y = unit(rng) * 40.f;
+
+                XMFLOAT2 scale2;
+                scale2.x = scale(rng);
+                scale2.y = scale(rng);
+
+                switch (i % 4)
+                {
+                case 0:
+                    font.DrawString(&batch, text, at);
+                    break;
+
+                case 1:
+                    font.DrawString(&batch, text, at, color, rotation, origin, scale2.x, effects, depth);
+                    break;
+
+                case 2:
+                    font.DrawString(&batch, text, at, color, rotation, origin, scale2, effects, depth);
+                    break;
+
+                default:
+                    font.DrawString(&batch, text, XMLoadFloat2(&at), color, rotation, XMLoadFloat2(&origin), XMLoadFloat2(&scale2), effects, depth);
+                    break;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,67 @@
+//--------------------------------------------------------------------------------------
+// File: SpriteInstancesBenchmark.cpp
+//
+// Times packing sprites into 64-byte instances for the instanced path, against expanding
+// them into four 36-byte vertices each, both into a plain buffer.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHarness.h"
+#include "TestSprites.h"
+
+using namespace DirectX;
+using namespace DirectX::Tests;
+
+namespace
+{
+    using SpriteExpansion::VerticesPerSprite;
+}
+
+
+BENCHMARK(SpriteInstancesPack)
+{
+    printf("%-10s %14s %14s   (ns per sprite; %zu vs %zu bytes written per sprite)\n", "sprites", "vertices", "instances",
+        sizeof(TestSpriteVertex) * VerticesPerSprite, sizeof(SpriteInstance));
+
+    // One full batch, then a large run such as a particle system.
+    for (const size_t count : { size_t(2048), size_t(1) << 16 })
+    {
+        std::mt19937 rng(static_cast<uint32_t>(count) + 1);
+
+        const auto queue = MakeTestSprites(rng, count);
+        const auto order = MakeTestSpriteOrder(rng, count);
+
+        const XMVECTOR textureSize = GetTestTextureSize();
+        const XMVECTOR inverseTextureSize = XMVectorReciprocal(textureSize);
+
+        std::vector<TestSpriteVertex> vertices(count * VerticesPerSprite);
+        std::vector<SpriteInstance> instances(count);
+
+        const size_t iterations = std::max<size_t>(1, (size_t(1) << 22) / count);
+
+        const double expand = MeasureNanoseconds(iterations, [&]()
+            {
+                SpriteExpansion::RenderSprites(queue, order.data(), count, vertices.data(), textureSize, inverseTextureSize);
+            });
+
+        KeepResult(static_cast<uint64_t>(vertices[count].position.x > 0.f));
+
+        const double pack = MeasureNanoseconds(iterations, [&]()
+            {
+                SpriteExpansion::PackSprites(queue, order.data(), nullptr, count, instances.data(), textureSize, inverseTextureSize);
+            });
+
+        KeepResult(static_cast<uint64_t>(instances[count / 2].positionAxisX.x > 0.f));
+
+        char label[32];
+        snprintf(label, sizeof(label), "%zu", count);
+
+        printf("%-10s %14.2f %14.2f\n", label, expand / double(count), pack / double(count));
+    }
+
+    return true;
+}
@@ -0,0 +1,105 @@
+//--------------------------------------------------------------------------------------
+// File: SpriteTestData.h
+//
+// Repeatable pseudo-random sprites that exercise every SpriteBatch Draw overload.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpriteBatch.h"
+
+#include <random>
+
+
+namespace DirectX
+{
+    namespace Tests
+    {
+        // Draws count sprites into batch, which may be a SpriteBatch or a StaticSpriteBatch. The mix
+        // covers zero and non-zero rotations, flips, missing and empty source rectangles, and both
+        // texel and destination-rectangle sizes. Denormals are avoided, since shaders may flush them.
+        template<typename TBatch>
+        void DrawTestSprites(TBatch& batch,
+            _In_reads_(textureCount) ID3D11ShaderResourceView* const* textures,
+            size_t textureCount,
+            size_t count,
+            uint32_t seed,
+            float extent = 1024.f)
+        {
+            std::mt19937 rng(seed);
+
+            std::uniform_real_distribution<float> position(-0.1f * extent, 1.1f * extent);
+            std::uniform_real_distribution<float> unit(0.f, 1.f);
+            std::uniform_real_distribution<float> angle(-10.f, 10.f);
+            std::uniform_real_distribution<float> scale(0.25f, 4.f);
+            std::uniform_int_distribution<long> texel(0, 31);
+            std::uniform_int_distribution<size_t> texture(0, textureCount - 1);
+
+            for (size_t i = 0; i < count; i++)
+            {
+                ID3D11ShaderResourceView* spriteTexture = textures[texture(rng)];
+
+                const float rotation = (i % 3) ? angle(rng) : 0.f;
+                const auto effects = static_cast<SpriteEffects>(rng() & 3);
+                const float depth = unit(rng);
+                const XMVECTORF32 color = { { { unit(rng), unit(rng), unit(rng), unit(rng) } } };
+
+                RECT source;
+                source.left = texel(rng);
+                source.top = texel(rng);
+                source.right = source.left + ((i % 7) ? texel(rng) : 0);
+                source.bottom = source.top + texel(rng);
+
+                // Separate statements, since the order function arguments are evaluated in is unspecified.
+                XMFLOAT2 origin;
+                origin.x = unit(rng) * 16.f;
+                origin.y = unit(rng) * 16.f;
+
+                XMFLOAT2 at;
+                at.x = position(rng);
+                at.y = position(rng);
+
+                XMFLOAT2 scale2;
+                scale2.x = scale(rng);
+                scale2.y = scale(rng);
+
+                switch (i % 5)
+                {
+                case 0:
+                    batch.Draw(spriteTexture, at, color);
+                    break;
+
+                case 1:
+                    batch.Draw(spriteTexture, at, &source, color, rotation, origin, scale2, effects, depth);
+                    break;
+
+                case 2:
+                    batch.Draw(spriteTexture, at, (i & 8) ? &source : nullptr, color, rotation, origin, scale2.x, effects, depth);
+                    break;
+
+                case 3:
+                    {
+                        RECT destination;
+                        destination.left = static_cast<long>(at.x);
+                        destination.top = static_cast<long>(at.y);
+                        destination.right = destination.left + long(scale2.x * 32.f);
+                        destination.bottom = destination.top + long(scale2.y * 32.f);
+
+                        batch.Draw(spriteTexture, destination, (i & 8) ? &source : nullptr, color, rotation, origin, effects, depth);
+                    }
+                    break;
+
+                default:
+                    batch.Draw(spriteTexture, XMLoadFloat2(&at), &source, color, rotation, XMLoadFloat2(&origin),
+                        XMLoadFloat2(&scale2), effects, depth);
+                    break;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,269 @@
+//--------------------------------------------------------------------------------------
+// File: SpriteTextureGroupsTest.cpp
+//
+// Checks how SpriteTextureGrouper splits sprites into multi-texture batches, and that
+// SpriteTextureCache only looks each texture up once.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHarness.h"
+
+#include "SpriteTextureGroups.h"
+
+#include <random>
+
+using namespace DirectX;
+using namespace DirectX::Tests;
+
+namespace
+{
+    constexpr size_t MaxSlots = 8;
+
+    using Grouper = SpriteTextureGrouper<uint32_t, MaxSlots>;
+
+    struct GroupRecord
+    {
+        std::vector<uint32_t> textures;
+        size_t firstSprite;
+        size_t spriteCount;
+    };
+
+
+    std::vector<GroupRecord> BuildGroups(std::vector<uint32_t> const& textures, size_t maxTextures, std::vector<uint8_t>& slots)
+    {
+        std::vector<GroupRecord> groups;
+
+        slots.assign(textures.size(), 0xff);
+
+        Grouper::Build(textures.size(),
+            maxTextures,
+            [&](size_t i) { return textures[i]; },
+            slots.data(),
+            [&](Grouper::Group const& group)
+            {
+                groups.push_back({ std::vector<uint32_t>(group.textures, group.textures + group.textureCount), group.firstSprite, group.spriteCount });
+            });
+
+        return groups;
+    }
+
+
+    // The fewest groups that keep the sprite order: greedily extend each group until a sprite
+    // would need one texture too many.
+    size_t CountGreedyGroups(std::vector<uint32_t> const& textures, size_t maxTextures)
+    {
+        size_t groupCount = 0;
+        std::vector<uint32_t> current;
+
+        for (const uint32_t texture : textures)
+        {
+            if (std::find(current.begin(), current.end(), texture) != current.end())
+                continue;
+
+            if (current.empty() || current.size() == maxTextures)
+            {
+                groupCount++;
+                current.clear();
+            }
+
+            current.push_back(texture);
+        }
+
+        return groupCount;
+    }
+
+
+    bool CheckGroups(std::vector<uint32_t> const& textures, size_t maxTextures, const char* context)
+    {
+        std::vector<uint8_t> slots;
+
+        const auto groups = BuildGroups(textures, maxTextures, slots);
+
+        if (groups.size() != CountGreedyGroups(textures, maxTextures))
+        {
+            printf("ERROR: %s: %zu groups, expected %zu\n", context, groups.size(), CountGreedyGroups(textures, maxTextures));
+            return false;
+        }
+
+        size_t nextSprite = 0;
+
+        for (size_t g = 0; g < groups.size(); g++)
+        {
+            auto const& group = groups[g];
+
+            // Groups must tile the sprites in order, each with distinct textures that fit the slots.
+            if (group.firstSprite != nextSprite || group.spriteCount == 0
+                || group.textures.empty() || group.textures.size() > maxTextures)
+            {
+                printf("ERROR: %s: group %zu covers [%zu, +%zu) with %zu textures\n", context, g, group.firstSprite, group.spriteCount, group.textures.size());
+                return false;
+            }
+
+            for (size_t a = 0; a < group.textures.size(); a++)
+            {
+                for (size_t b = a + 1; b < group.textures.size(); b++)
+                {
+                    if (group.textures[a] == group.textures[b])
+                    {
+                        printf("ERROR: %s: group %zu binds texture %u twice\n", context, g, group.textures[a]);
+                        return false;
+                    }
+                }
+            }
+
+            for (size_t i = group.firstSprite; i < group.firstSprite + group.spriteCount; i++)
+            {
+                if (slots[i] >= group.textures.size() || group.textures[slots[i]] != textures[i])
+                {
+                    printf("ERROR: %s: sprite %zu has slot %u, which does not hold its texture %u\n", context, i, slots[i], textures[i]);
+                    return false;
+                }
+            }
+
+            nextSprite += group.spriteCount;
+        }
+
+        if (nextSprite != textures.size())
+        {
+            printf("ERROR: %s: groups cover %zu of %zu sprites\n", context, nextSprite, textures.size());
+            return false;
+        }
+
+        return true;
+    }
+}
+
+
+TEST_CASE(TextureGroupsEmptyInput)
+{
+    std::vector<uint8_t> slots;
+
+    CHECK(BuildGroups({}, MaxSlots, slots).empty());
+
+    return true;
+}
+
+
+TEST_CASE(TextureGroupsSingleTexturePerBatch)
+{
+    // With one slot, every texture change starts a group, which is what FlushBatch does.
+    const std::vector<uint32_t> textures = { 1, 1, 2, 2, 2, 1, 3, 3, 1 };
+
+    std::vector<uint8_t> slots;
+
+    const auto groups = BuildGroups(textures, 1, slots);
+
+    CHECK(groups.size() == 5);
+
+    for (auto const& group : groups)
+    {
+        CHECK(group.textures.size() == 1);
+    }
+
+    for (const uint8_t slot : slots)
+    {
+        CHECK(slot == 0);
+    }
+
+    return true;
+}
+
+
+TEST_CASE(TextureGroupsRoundRobin)
+{
+    // Cycling through more textures than there are slots fills each group completely.
+    for (size_t textureCount = 1; textureCount <= 3 * MaxSlots; textureCount++)
+    {
+        for (size_t maxTextures = 1; maxTextures <= MaxSlots; maxTextures++)
+        {
+            std::vector<uint32_t> textures(500);
+
+            for (size_t i = 0; i < textures.size(); i++)
+            {
+                textures[i] = static_cast<uint32_t>(100 + i % textureCount);
+            }
+
+            char context[64];
+            snprintf(context, sizeof(context), "%zu textures, %zu slots", textureCount, maxTextures);
+
+            if (!CheckGroups(textures, maxTextures, context))
+                return false;
+
+            if (textureCount <= maxTextures)
+            {
+                std::vector<uint8_t> slots;
+                CHECK(BuildGroups(textures, maxTextures, slots).size() == 1);
+            }
+        }
+    }
+
+    return true;
+}
+
+
+TEST_CASE(TextureGroupsRandomSequences)
+{
+    std::mt19937 rng(5);
+
+    for (int trial = 0; trial < 2000; trial++)
+    {
+        // Runs of repeated textures, as sorted sprites tend to have, mixed with isolated changes.
+        std::uniform_int_distribution<uint32_t> texture(0, 1 + rng() % 20);
+        std::uniform_int_distribution<size_t> runLength(1, 1 + rng() % 12);
+
+        std::vector<uint32_t> textures;
+        const size_t count = rng() % 400;
+
+        while (textures.size() < count)
+        {
+            textures.insert(textures.end(), std::min(runLength(rng), count - textures.size()), texture(rng));
+        }
+
+        const size_t maxTextures = 1 + rng() % MaxSlots;
+
+        char context[64];
+        snprintf(context, sizeof(context), "trial %d, %zu sprites, %zu slots", trial, count, maxTextures);
+
+        if (!CheckGroups(textures, maxTextures, context))
+            return false;
+    }
+
+    return true;
+}
+
+
+TEST_CASE(TextureCacheLooksUpOnce)
+{
+    SpriteTextureCache<uint32_t, uint64_t> cache;
+
+    size_t lookups = 0;
+
+    auto lookup = [&](uint32_t texture)
+    {
+        lookups++;
+        return uint64_t(texture) * 3;
+    };
+
+    const uint32_t sequence[] = { 1, 1, 2, 1, 3, 3, 2, 1, 4 };
+
+    for (const uint32_t texture : sequence)
+    {
+        CHECK(cache.Get(texture, lookup) == uint64_t(texture) * 3);
+    }
+
+    CHECK(lookups == 4);
+    CHECK(cache.Size() == 4);
+
+    // After Clear, the same key must be looked up again, even straight after the last one used.
+    cache.Clear();
+
+    CHECK(cache.Size() == 0);
+    CHECK(cache.Get(4, lookup) == 12);
+    CHECK(lookups == 5);
+
+    return true;
+}
@@ -0,0 +1,22 @@
+//--------------------------------------------------------------------------------------
+// File: StandalonePch.h
+//
+// Stands in for Src/pch.h when library sources without Direct3D dependencies are built
+// into the standalone tests. CMake copies it next to the copied sources as pch.h.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <vector>
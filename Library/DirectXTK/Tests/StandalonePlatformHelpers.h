@@ -0,0 +1,33 @@
+//--------------------------------------------------------------------------------------
+// File: StandalonePlatformHelpers.h
+//
+// Stands in for Src/PlatformHelpers.h in the standalone tests, for library sources that only
+// use its debug tracing. CMake copies it next to the copied sources as PlatformHelpers.h.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstdarg>
+#include <cstdio>
+
+
+namespace DirectX
+{
+    // Debug builds write to stderr, where Windows would use OutputDebugStringA.
+    inline void DebugTrace(const char* format, ...) noexcept
+    {
+    #ifdef _DEBUG
+        va_list args;
+        va_start(args, format);
+        vfprintf(stderr, format, args);
+        va_end(args);
+    #else
+        (void)format;
+    #endif
+    }
+}
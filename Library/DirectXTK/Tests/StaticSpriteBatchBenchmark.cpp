@@ -0,0 +1,145 @@
+//--------------------------------------------------------------------------------------
+// File: StaticSpriteBatchBenchmark.cpp
+//
+// Compares the per-frame cost of redrawing sprites through SpriteBatch with replaying
+// them from a StaticSpriteBatch.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "DeviceTest.h"
+
+#include "SpriteBatch.h"
+
+#include <random>
+
+using namespace DirectX;
+using namespace DirectX::Tests;
+
+namespace
+{
+    struct SpriteParameters
+    {
+        XMFLOAT2 position;
+        RECT source;
+        float rotation;
+        float depth;
+    };
+
+
+    // Generated up front, so the SpriteBatch timings do not include making up the sprites.
+    std::vector<SpriteParameters> MakeSprites(size_t count)
+    {
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<float> position(0.f, 512.f);
+        std::uniform_real_distribution<float> unit(0.f, 1.f);
+
+        std::vector<SpriteParameters> sprites(count);
+
+        for (auto& sprite : sprites)
+        {
+            sprite.position.x = position(rng);
+            sprite.position.y = position(rng);
+            sprite.source = { 0, 0, 8, 8 };
+            sprite.rotation = unit(rng);
+            sprite.depth = unit(rng);
+        }
+
+        return sprites;
+    }
+
+
+    template<typename TBatch>
+    void DrawSprites(TBatch& batch, ID3D11ShaderResourceView* texture, std::vector<SpriteParameters> const& sprites)
+    {
+        for (auto const& sprite : sprites)
+        {
+            batch.Draw(texture, sprite.position, &sprite.source, Colors::White, sprite.rotation, XMFLOAT2(4.f, 4.f), 1.f, SpriteEffects_None, sprite.depth);
+        }
+    }
+
+    // Times submit, the CPU work up to and including End or Render, separately from the whole
+    // frame, which also waits for WARP to rasterize it.
+    template<typename TSubmit>
+    void TimeFrames(TestDevice const& test, size_t frames, TSubmit&& submit, double& submitMs, double& frameMs)
+    {
+        using clock = std::chrono::steady_clock;
+
+        clock::duration submitTime{};
+
+        const auto start = clock::now();
+
+        for (size_t frame = 0; frame < frames; frame++)
+        {
+            const auto submitStart = clock::now();
+
+            submit();
+
+            submitTime += clock::now() - submitStart;
+
+            WaitForGpu(test.device.Get(), test.context.Get());
+        }
+
+        const auto total = clock::now() - start;
+
+        submitMs = std::chrono::duration<double, std::milli>(submitTime).count() / double(frames);
+        frameMs = std::chrono::duration<double, std::milli>(total).count() / double(frames);
+    }
+}
+
+
+BENCHMARK(StaticSpriteBatchReplay)
+{
+    TestDevice test;
+
+    if (!CreateTestDevice(test))
+        return false;
+
+    auto context = test.context.Get();
+
+    TestRenderTarget renderTarget(test.device.Get(), 512, 512);
+
+    renderTarget.Begin(context);
+
+    auto texture = CreateTestTexture(test.device.Get(), 16, 16, 1);
+
+    printf("%10s %22s %22s   (ms per frame, submit / whole frame)\n", "sprites", "SpriteBatch", "StaticSpriteBatch");
+
+    for (const size_t count : { size_t(1000), size_t(10000), size_t(50000) })
+    {
+        constexpr size_t Frames = 20;
+
+        const auto sprites = MakeSprites(count);
+
+        SpriteBatch batch(context);
+
+        double dynamicSubmit, dynamicFrame;
+
+        TimeFrames(test, Frames, [&]()
+            {
+                batch.Begin();
+                DrawSprites(batch, texture.Get(), sprites);
+                batch.End();
+            }, dynamicSubmit, dynamicFrame);
+
+        StaticSpriteBatch staticBatch(context);
+
+        staticBatch.Begin();
+        DrawSprites(staticBatch, texture.Get(), sprites);
+        staticBatch.End();
+
+        double staticSubmit, staticFrame;
+
+        TimeFrames(test, Frames, [&]()
+            {
+                staticBatch.Render();
+            }, staticSubmit, staticFrame);
+
+        printf("%10zu %10.3f / %9.3f %10.3f / %9.3f\n", count, dynamicSubmit, dynamicFrame, staticSubmit, staticFrame);
+    }
+
+    return true;
+}
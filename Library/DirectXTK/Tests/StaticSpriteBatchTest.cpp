@@ -0,0 +1,244 @@
+//--------------------------------------------------------------------------------------
+// File: StaticSpriteBatchTest.cpp
+//
+// Checks that StaticSpriteBatch replays exactly the vertices an immediate SpriteBatch
+// generates for the same sprites, including after ranges are redrawn in place.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "DeviceTest.h"
+#include "SpriteTestData.h"
+
+#include <stdexcept>
+
+using namespace DirectX;
+using namespace DirectX::Tests;
+using Microsoft::WRL::ComPtr;
+
+namespace
+{
+    const SpriteSortMode SortModes[] =
+    {
+        SpriteSortMode_Deferred,
+        SpriteSortMode_Texture,
+        SpriteSortMode_BackToFront,
+        SpriteSortMode_FrontToBack,
+    };
+
+    const char* const SortModeNames[] = { "Deferred", "Texture", "BackToFront", "FrontToBack" };
+
+
+    // A sprite whose placement depends on variant, but whose depth does not, so that redrawing
+    // it with another variant keeps its position in every sort order.
+    template<typename TBatch>
+    void DrawVariant(TBatch& batch, ID3D11ShaderResourceView* texture, size_t index, int variant)
+    {
+        const float x = float((index * 37) % 1000) + 0.25f * float(variant);
+        const float y = float((index * 91) % 700) - 0.5f * float(variant);
+        const float rotation = float(index % 5) * 0.7f + float(variant);
+        const float depth = float(index % 17) / 17.f;
+
+        const RECT source = { long(index % 8), long(index % 4), long(index % 8) + 16, long(index % 4) + 8 };
+
+        batch.Draw(texture, XMFLOAT2(x, y), &source, Colors::White, rotation, XMFLOAT2(4.f, 2.f),
+            1.f + float(variant), static_cast<SpriteEffects>((index + size_t(variant)) & 3), depth);
+    }
+}
+
+
+TEST_CASE(StaticSpriteBatchMatchesSpriteBatch)
+{
+    TestDevice test;
+
+    if (!CreateTestDevice(test))
+        return false;
+
+    auto context = test.context.Get();
+
+    SetTestViewport(context, 1024, 1024);
+
+    ComPtr<ID3D11ShaderResourceView> textures[] =
+    {
+        CreateTestTexture(test.device.Get(), 64, 32, 1),
+        CreateTestTexture(test.device.Get(), 17, 9, 2),
+        CreateTestTexture(test.device.Get(), 128, 128, 3),
+    };
+
+    ID3D11ShaderResourceView* const textureViews[] = { textures[0].Get(), textures[1].Get(), textures[2].Get() };
+
+    // The largest count needs several 2048 sprite draws per texture.
+    constexpr size_t MaxSprites = 7000;
+
+    VertexCapture capture(test.device.Get(), MaxSprites * 6);
+
+    for (size_t mode = 0; mode < std::size(SortModes); mode++)
+    {
+        for (const size_t count : { size_t(1), size_t(100), MaxSprites })
+        {
+            const auto seed = static_cast<uint32_t>(count + mode);
+
+            SpriteBatch batch(context);
+
+            batch.Begin(SortModes[mode], nullptr, nullptr, nullptr, nullptr, capture.Begin(context));
+            DrawTestSprites(batch, textureViews, std::size(textureViews), count, seed);
+            batch.End();
+
+            const auto expected = capture.End(context);
+
+            StaticSpriteBatch staticBatch(context);
+
+            staticBatch.Begin(SortModes[mode]);
+            DrawTestSprites(staticBatch, textureViews, std::size(textureViews), count, seed);
+            staticBatch.End();
+
+            CHECK(staticBatch.GetSpriteCount() == count);
+
+            // Replay twice, with a transform, since neither may change the retained vertices.
+            for (int replay = 0; replay < 2; replay++)
+            {
+                staticBatch.Render(replay ? XMMatrixTranslation(10.f, 20.f, 0.f) : XMMatrixIdentity(),
+                    nullptr, nullptr, nullptr, nullptr, capture.Begin(context));
+
+                const auto actual = capture.End(context);
+
+                char description[96];
+                snprintf(description, sizeof(description), "%s, %zu sprites, replay %d", SortModeNames[mode], count, replay);
+
+                if (!CompareVertices(expected, actual, description))
+                    return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+TEST_CASE(StaticSpriteBatchUpdateMatchesRebuild)
+{
+    TestDevice test;
+
+    if (!CreateTestDevice(test))
+        return false;
+
+    auto context = test.context.Get();
+
+    SetTestViewport(context, 1024, 1024);
+
+    auto texture = CreateTestTexture(test.device.Get(), 64, 32, 1);
+
+    constexpr size_t Count = 3000;
+
+    VertexCapture capture(test.device.Get(), Count * 6);
+
+    struct Update
+    {
+        size_t first;
+        size_t count;
+    };
+
+    const Update updates[] = { { 0, 1 }, { 0, Count }, { 100, 50 }, { Count - 7, 7 }, { 2040, 20 } };
+
+    for (const SpriteSortMode mode : { SpriteSortMode_Deferred, SpriteSortMode_BackToFront })
+    {
+        for (auto const& update : updates)
+        {
+            StaticSpriteBatch staticBatch(context);
+
+            staticBatch.Begin(mode);
+
+            for (size_t i = 0; i < Count; i++)
+            {
+                DrawVariant(staticBatch, texture.Get(), i, 0);
+            }
+
+            staticBatch.End();
+
+            staticBatch.BeginUpdate(update.first);
+
+            for (size_t i = update.first; i < update.first + update.count; i++)
+            {
+                DrawVariant(staticBatch, texture.Get(), i, 1);
+            }
+
+            staticBatch.End();
+
+            CHECK(staticBatch.GetSpriteCount() == Count);
+
+            // The same sprites drawn from scratch.
+            SpriteBatch batch(context);
+
+            batch.Begin(mode, nullptr, nullptr, nullptr, nullptr, capture.Begin(context));
+
+            for (size_t i = 0; i < Count; i++)
+            {
+                const bool updated = (i >= update.first && i < update.first + update.count);
+
+                DrawVariant(batch, texture.Get(), i, updated ? 1 : 0);
+            }
+
+            batch.End();
+
+            const auto expected = capture.End(context);
+
+            staticBatch.Render(XMMatrixIdentity(), nullptr, nullptr, nullptr, nullptr, capture.Begin(context));
+
+            const auto actual = capture.End(context);
+
+            char description[96];
+            snprintf(description, sizeof(description), "%s, update %zu+%zu",
+                (mode == SpriteSortMode_Deferred) ? "Deferred" : "BackToFront", update.first, update.count);
+
+            if (!CompareVertices(expected, actual, description))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+
+TEST_CASE(StaticSpriteBatchRejectsTextureChange)
+{
+    TestDevice test;
+
+    if (!CreateTestDevice(test))
+        return false;
+
+    auto context = test.context.Get();
+
+    SetTestViewport(context, 1024, 1024);
+
+    auto texture1 = CreateTestTexture(test.device.Get(), 16, 16, 1);
+    auto texture2 = CreateTestTexture(test.device.Get(), 16, 16, 2);
+
+    StaticSpriteBatch staticBatch(context);
+
+    staticBatch.Begin();
+    DrawVariant(staticBatch, texture1.Get(), 0, 0);
+    DrawVariant(staticBatch, texture1.Get(), 1, 0);
+    staticBatch.End();
+
+    staticBatch.BeginUpdate(1);
+    DrawVariant(staticBatch, texture2.Get(), 1, 0);
+
+    bool threw = false;
+
+    try
+    {
+        staticBatch.End();
+    }
+    catch (std::invalid_argument const&)
+    {
+        threw = true;
+    }
+
+    CHECK(threw);
+    CHECK(staticBatch.GetSpriteCount() == 2);
+
+    return true;
+}
@@ -0,0 +1,334 @@
+//--------------------------------------------------------------------------------------
+// File: TestFont.h
+//
+// A synthetic font and random text for the layout and measurement tests, along with the
+// measurements SpriteFont made before GlyphLayout and GlyphMetrics, to compare against.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "GlyphLayout.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cwctype>
+#include <random>
+#include <string>
+#include <vector>
+
+
+namespace DirectX
+{
+    namespace Tests
+    {
+        // Has the members of SpriteFont::Glyph, for tests that do not link the library.
+        struct TestGlyph
+        {
+            struct Rect
+            {
+                long left;
+                long top;
+                long right;
+                long bottom;
+            };
+
+            uint32_t Character;
+            Rect Subrect;
+            float XOffset;
+            float YOffset;
+            float XAdvance;
+        };
+
+
+        // Has the members of SpriteRunElement, which GlyphRunWriter fills in.
+        struct TestRunElement
+        {
+            struct Float2
+            {
+                float x;
+                float y;
+            };
+
+            Float2 position;
+            Float2 origin;
+            TestGlyph::Rect sourceRectangle;
+        };
+
+
+        // Glyphs with varied sizes and offsets, including negative ones, for printable ASCII,
+        // invisible and visible whitespace, an ellipsis, and characters beyond the BMP. Missing
+        // characters map to the default glyph, '?'. TGlyph is TestGlyph or SpriteFont::Glyph.
+        template<typename TGlyph>
+        class TestFont
+        {
+        public:
+            explicit TestFont(uint32_t seed = 1, float lineSpacing = 18.f) :
+                mLineSpacing(lineSpacing)
+            {
+                std::mt19937 rng(seed);
+
+                std::vector<uint32_t> characters = { '\t', 0x2026, 0x3000, 0x1F600, 0x1F601 };
+
+                for (uint32_t c = ' '; c <= '~'; c++)
+                {
+                    characters.push_back(c);
+                }
+
+                std::sort(characters.begin(), characters.end());
+
+                long left = 0;
+
+                for (const auto c : characters)
+                {
+                    TGlyph glyph = {};
+
+                    glyph.Character = c;
+
+                    // Plain spaces are 1x1 so the layout skips them, while the ideographic space and tab
+                    // are large enough to be drawn.
+                    const bool invisible = (c == ' ');
+
+                    const long width = invisible ? 1 : 2 + long(rng() % 12);
+                    const long height = invisible ? 1 : 6 + long(rng() % 14);
+
+                    glyph.Subrect.left = left;
+                    glyph.Subrect.top = long(rng() % 32);
+                    glyph.Subrect.right = left + width;
+                    glyph.Subrect.bottom = glyph.Subrect.top + height;
+
+                    glyph.XOffset = float(int(rng() % 5) - 2) * 0.5f;
+                    glyph.YOffset = float(rng() % 5);
+                    glyph.XAdvance = invisible ? 4.f : float(int(rng() % 7) - 3) * 0.75f;
+
+                    mGlyphs.push_back(glyph);
+
+                    left += width + 1;
+                }
+
+                mDefault = static_cast<size_t>(std::find_if(mGlyphs.begin(), mGlyphs.end(), [](TGlyph const& glyph) noexcept { return glyph.Character == '?'; }) - mGlyphs.begin());
+            }
+
+            std::vector<TGlyph> const& GetGlyphs() const noexcept { return mGlyphs; }
+            float GetLineSpacing() const noexcept { return mLineSpacing; }
+            TGlyph const* GetDefault() const noexcept { return &mGlyphs[mDefault]; }
+
+            // Makes missing characters map to another glyph of the font.
+            void SetDefault(uint32_t character) noexcept
+            {
+                const size_t index = FindIndex(character);
+
+                if (index != SIZE_MAX)
+                {
+                    mDefault = index;
+                }
+            }
+
+            // Returns the glyph for a character, or the default glyph.
+            TGlyph const* Find(uint32_t character) const noexcept
+            {
+                auto it = std::lower_bound(mGlyphs.begin(), mGlyphs.end(), character,
+                    [](TGlyph const& glyph, uint32_t value) noexcept { return glyph.Character < value; });
+
+                return (it != mGlyphs.end() && it->Character == character) ? &*it : GetDefault();
+            }
+
+            // Returns the index of a character's glyph, or SIZE_MAX if it is missing.
+            size_t FindIndex(uint32_t character) const noexcept
+            {
+                auto glyph = Find(character);
+
+                return (glyph->Character == character) ? static_cast<size_t>(glyph - mGlyphs.data()) : SIZE_MAX;
+            }
+
+            auto Finder() const noexcept
+            {
+                return [this](uint32_t character) noexcept { return Find(character); };
+            }
+
+        private:
+            std::vector<TGlyph> mGlyphs;
+            size_t mDefault;
+            float mLineSpacing;
+        };
+
+
+        inline void AppendUtf8(std::string& text, uint32_t codePoint)
+        {
+            if (codePoint < 0x80)
+            {
+                text += char(codePoint);
+            }
+            else if (codePoint < 0x800)
+            {
+                text += char(0xC0 | (codePoint >> 6));
+                text += char(0x80 | (codePoint & 0x3F));
+            }
+            else if (codePoint < 0x10000)
+            {
+                text += char(0xE0 | (codePoint >> 12));
+                text += char(0x80 | ((codePoint >> 6) & 0x3F));
+                text += char(0x80 | (codePoint & 0x3F));
+            }
+            else
+            {
+                text += char(0xF0 | (codePoint >> 18));
+                text += char(0x80 | ((codePoint >> 12) & 0x3F));
+                text += char(0x80 | ((codePoint >> 6) & 0x3F));
+                text += char(0x80 | (codePoint & 0x3F));
+            }
+        }
+
+
+        // Random UTF-8 text of words separated by runs of whitespace, with line breaks, carriage
+        // returns, characters beyond the BMP, and characters missing from the font.
+        inline std::string MakeTestText(std::mt19937& rng, size_t words)
+        {
+            std::string text;
+
+            for (size_t word = 0; word < words; word++)
+            {
+                const size_t length = 1 + rng() % ((rng() % 8) ? 8 : 40);
+
+                for (size_t i = 0; i < length; i++)
+                {
+                    const uint32_t kind = rng() % 100;
+
+                    if (kind < 90)
+                        AppendUtf8(text, '!' + rng() % 94);
+                    else if (kind < 95)
+                        AppendUtf8(text, 0x1F600 + rng() % 2);
+                    else if (kind < 98)
+                        AppendUtf8(text, 0x2026);
+                    else
+                        AppendUtf8(text, 0x4E00 + rng() % 100);
+                }
+
+                const uint32_t separator = rng() % 100;
+
+                if (separator < 70)
+                    text += ' ';
+                else if (separator < 80)
+                    text += "   ";
+                else if (separator < 85)
+                    text += '\t';
+                else if (separator < 88)
+                    AppendUtf8(text, 0x3000);
+                else if (separator < 94)
+                    text += '\n';
+                else if (separator < 97)
+                    text += "\r\n";
+                else
+                    text += " \n\n ";
+            }
+
+            return text;
+        }
+
+
+        // Converts UTF-8 to wide characters, as UTF-16 where wchar_t is 16-bit.
+        inline std::wstring WidenUtf8(std::string const& text)
+        {
+            std::wstring result;
+
+            TextDecoder<char> decoder(text.c_str());
+
+            for (uint32_t c = decoder.Next(); c != 0; c = decoder.Next())
+            {
+            #if WCHAR_MAX <= 0xFFFF
+                if (c >= 0x10000)
+                {
+                    result += wchar_t(0xD800 + ((c - 0x10000) >> 10));
+                    result += wchar_t(0xDC00 + ((c - 0x10000) & 0x3FF));
+                    continue;
+                }
+            #endif
+
+                result += wchar_t(c);
+            }
+
+            return result;
+        }
+
+
+        // MeasureString as SpriteFont implemented it before GlyphMetrics.
+        template<typename TChar, typename TGlyph>
+        void ReferenceMeasureString(TChar const* text, TestFont<TGlyph> const& font, bool ignoreWhitespace, float* width, float* height)
+        {
+            float resultX = 0;
+            float resultY = 0;
+
+            const float lineSpacing = font.GetLineSpacing();
+
+            LayoutGlyphs(text, lineSpacing, ignoreWhitespace, font.Finder(),
+                [&](TGlyph const* glyph, float x, float y, float)
+                {
+                    auto const w = static_cast<float>(glyph->Subrect.right - glyph->Subrect.left);
+                    auto h = static_cast<float>(glyph->Subrect.bottom - glyph->Subrect.top) + glyph->YOffset;
+
+                    h = iswspace(static_cast<wint_t>(glyph->Character)) ?
+                        lineSpacing :
+                        std::max(h, lineSpacing);
+
+                    resultX = std::max(resultX, x + w);
+                    resultY = std::max(resultY, y + h);
+                },
+                [](float) noexcept {});
+
+            *width = resultX;
+            *height = resultY;
+        }
+
+
+        // MeasureDrawBounds as SpriteFont implemented it before GlyphMetrics.
+        template<typename TChar, typename TGlyph>
+        typename TestGlyph::Rect ReferenceMeasureDrawBounds(TChar const* text, TestFont<TGlyph> const& font, float positionX, float positionY, bool ignoreWhitespace)
+        {
+            typename TestGlyph::Rect result = { LONG_MAX, LONG_MAX, 0, 0 };
+
+            const float lineSpacing = font.GetLineSpacing();
+
+            LayoutGlyphs(text, lineSpacing, ignoreWhitespace, font.Finder(),
+                [&](TGlyph const* glyph, float x, float y, float advance)
+                {
+                    auto const isWhitespace = iswspace(static_cast<wint_t>(glyph->Character));
+                    auto const w = static_cast<float>(glyph->Subrect.right - glyph->Subrect.left);
+                    auto const h = isWhitespace ?
+                        lineSpacing :
+                        static_cast<float>(glyph->Subrect.bottom - glyph->Subrect.top);
+
+                    const float minX = positionX + x;
+                    const float minY = positionY + y + (isWhitespace ? 0.0f : glyph->YOffset);
+
+                    const float maxX = std::max(minX + advance, minX + w);
+                    const float maxY = minY + h;
+
+                    if (minX < float(result.left))
+                        result.left = long(minX);
+
+                    if (minY < float(result.top))
+                        result.top = long(minY);
+
+                    if (float(result.right) < maxX)
+                        result.right = long(maxX);
+
+                    if (float(result.bottom) < maxY)
+                        result.bottom = long(maxY);
+                },
+                [](float) noexcept {});
+
+            if (result.left == LONG_MAX)
+            {
+                result.left = 0;
+                result.top = 0;
+            }
+
+            return result;
+        }
+    }
+}
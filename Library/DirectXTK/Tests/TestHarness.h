@@ -0,0 +1,110 @@
+//--------------------------------------------------------------------------------------
+// File: TestHarness.h
+//
+// Minimal self-registering harness shared by the tests and benchmarks.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#if defined(_WIN32) || __has_include(<sal.h>)
+#include <sal.h>
+#else
+// The internal headers carry a few SAL annotations, which only mean something to the MSVC analyzer.
+// Other hosts only have sal.h if it came with DirectXMath.
+#define _Inout_updates_(size)
+#define _Out_writes_(size)
+#endif
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+
+namespace DirectX
+{
+    namespace Tests
+    {
+        // A test returns false after printing an ERROR line describing what went wrong.
+        using TestFunction = bool(*)();
+
+        struct TestCase
+        {
+            const char* name;
+            TestFunction function;
+        };
+
+        std::vector<TestCase>& GetTestCases();
+
+        struct TestRegistration
+        {
+            TestRegistration(const char* name, TestFunction function)
+            {
+                GetTestCases().push_back({ name, function });
+            }
+        };
+
+
+        // Runs action iterations times per trial, and returns the best trial's average time per call.
+        template<typename TAction>
+        double MeasureNanoseconds(size_t iterations, TAction&& action)
+        {
+            constexpr int Trials = 5;
+
+            double best = DBL_MAX;
+
+            for (int trial = 0; trial < Trials; trial++)
+            {
+                const auto start = std::chrono::steady_clock::now();
+
+                for (size_t i = 0; i < iterations; i++)
+                {
+                    action();
+                }
+
+                const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+                best = std::min(best, elapsed.count() / double(iterations));
+            }
+
+            return best;
+        }
+
+
+        // Stores a benchmark result where the optimizer cannot discard the work that produced it.
+        extern volatile uint64_t g_resultSink;
+
+        inline void KeepResult(uint64_t value) noexcept
+        {
+            g_resultSink = value;
+        }
+    }
+}
+
+
+// Defines a test function and registers it with the harness.
+#define TEST_CASE(name) \
+    static bool name(); \
+    static const DirectX::Tests::TestRegistration name##Registration(#name, name); \
+    static bool name()
+
+// Benchmarks use the same registration, but live in executables that are not run by CTest.
+#define BENCHMARK(name) TEST_CASE(name)
+
+#define CHECK(condition) \
+    do \
+    { \
+        if (!(condition)) \
+        { \
+            printf("ERROR: %s(%d): check failed: %s\n", __FILE__, __LINE__, #condition); \
+            return false; \
+        } \
+    } while (false)
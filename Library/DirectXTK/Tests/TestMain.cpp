@@ -0,0 +1,70 @@
+//--------------------------------------------------------------------------------------
+// File: TestMain.cpp
+//
+// Runs every registered test, or those whose names contain the command-line argument.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHarness.h"
+
+#include <cstring>
+#include <exception>
+
+using namespace DirectX::Tests;
+
+
+volatile uint64_t DirectX::Tests::g_resultSink;
+
+std::vector<TestCase>& DirectX::Tests::GetTestCases()
+{
+    static std::vector<TestCase> s_testCases;
+    return s_testCases;
+}
+
+
+int main(int argc, char* argv[])
+{
+    const char* filter = (argc > 1) ? argv[1] : nullptr;
+
+    size_t passed = 0;
+    size_t failed = 0;
+
+    for (auto const& test : GetTestCases())
+    {
+        if (filter && !strstr(test.name, filter))
+            continue;
+
+        printf("%s\n", test.name);
+        fflush(stdout);
+
+        bool success;
+
+        try
+        {
+            success = test.function();
+        }
+        catch (std::exception const& e)
+        {
+            printf("ERROR: %s threw an exception: %s\n", test.name, e.what());
+            success = false;
+        }
+
+        if (success)
+        {
+            passed++;
+        }
+        else
+        {
+            printf("FAILED: %s\n", test.name);
+            failed++;
+        }
+    }
+
+    printf("%zu passed, %zu failed\n", passed, failed);
+
+    return failed ? 1 : 0;
+}
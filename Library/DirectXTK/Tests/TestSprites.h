@@ -0,0 +1,138 @@
+//--------------------------------------------------------------------------------------
+// File: TestSprites.h
+//
+// A sprite queue laid out like the one in SpriteBatch, filled with random sprites, for the
+// tests and benchmarks of the vertex expansion kernels.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpriteExpansion.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <vector>
+
+
+namespace DirectX
+{
+    namespace Tests
+    {
+        // Has the layout of VertexPositionColorTexture, for tests that do not link the library.
+        struct TestSpriteVertex
+        {
+            XMFLOAT3 position;
+            XMFLOAT4 color;
+            XMFLOAT2 textureCoordinate;
+        };
+
+        static_assert(sizeof(TestSpriteVertex) == 36, "Must match VertexPositionColorTexture");
+
+
+        XM_ALIGNED_STRUCT(16) TestSpriteField : public XMFLOAT4A
+        {
+        };
+
+
+        // Has the members of SpriteBatch::Impl::SpriteQueue that the expansion reads.
+        struct TestSpriteQueue
+        {
+            explicit TestSpriteQueue(size_t count) :
+                source(new TestSpriteField[count]),
+                destination(new TestSpriteField[count]),
+                color(new TestSpriteField[count]),
+                originRotationDepth(new TestSpriteField[count]),
+                flags(new unsigned int[count])
+            {
+            }
+
+            std::unique_ptr<TestSpriteField[]> source;
+            std::unique_ptr<TestSpriteField[]> destination;
+            std::unique_ptr<TestSpriteField[]> color;
+            std::unique_ptr<TestSpriteField[]> originRotationDepth;
+            std::unique_ptr<unsigned int[]> flags;
+        };
+
+
+        // The size of the texture every test sprite is drawn from.
+        constexpr float TestTextureWidth = 256.f;
+        constexpr float TestTextureHeight = 128.f;
+
+
+        // Queues count sprites with every combination of mirroring and of source and size units
+        // the expansion handles, which is more than the SpriteBatch::Draw overloads produce. About
+        // half are rotated, by up to two turns either way, and a few have an empty source region.
+        inline TestSpriteQueue MakeTestSprites(std::mt19937& rng, size_t count)
+        {
+            TestSpriteQueue queue(count);
+
+            std::uniform_real_distribution<float> position(-100.f, 1000.f);
+            std::uniform_real_distribution<float> unit(0.f, 1.f);
+            std::uniform_real_distribution<float> angle(-4.f * XM_PI, 4.f * XM_PI);
+
+            for (size_t i = 0; i < count; i++)
+            {
+                const unsigned int flags = static_cast<unsigned int>(rng() & 15u);
+
+                float sourceWidth = 1.f + unit(rng) * 63.f;
+                float sourceHeight = 1.f + unit(rng) * 63.f;
+
+                if (rng() % 16 == 0)
+                {
+                    sourceWidth = 0;
+                }
+
+                XMFLOAT4A source(unit(rng) * 128.f, unit(rng) * 64.f, sourceWidth, sourceHeight);
+
+                if (!(flags & SpriteExpansion::SourceInTexels))
+                {
+                    source.x /= TestTextureWidth;
+                    source.y /= TestTextureHeight;
+                    source.z /= TestTextureWidth;
+                    source.w /= TestTextureHeight;
+                }
+
+                // A size in pixels, or a scale of the source region.
+                const XMFLOAT4A destination = (flags & SpriteExpansion::DestSizeInPixels)
+                    ? XMFLOAT4A(position(rng), position(rng), 1.f + unit(rng) * 200.f, 1.f + unit(rng) * 200.f)
+                    : XMFLOAT4A(position(rng), position(rng), 0.25f + unit(rng) * 4.f, 0.25f + unit(rng) * 4.f);
+
+                const float rotation = (rng() & 1) ? angle(rng) : 0.f;
+
+                static_cast<XMFLOAT4A&>(queue.source[i]) = source;
+                static_cast<XMFLOAT4A&>(queue.destination[i]) = destination;
+                static_cast<XMFLOAT4A&>(queue.color[i]) = XMFLOAT4A(unit(rng), unit(rng), unit(rng), unit(rng));
+                static_cast<XMFLOAT4A&>(queue.originRotationDepth[i]) = XMFLOAT4A(unit(rng) * sourceWidth, unit(rng) * sourceHeight, rotation, unit(rng));
+                queue.flags[i] = flags;
+            }
+
+            return queue;
+        }
+
+
+        // The draw order of count sprites after sorting, which is not the queue order.
+        inline std::vector<uint32_t> MakeTestSpriteOrder(std::mt19937& rng, size_t count)
+        {
+            std::vector<uint32_t> order(count);
+            std::iota(order.begin(), order.end(), 0u);
+            std::shuffle(order.begin(), order.end(), rng);
+
+            return order;
+        }
+
+
+        // As returned by SpriteBatch::Impl::GetTextureSize.
+        inline XMVECTOR XM_CALLCONV GetTestTextureSize() noexcept
+        {
+            return XMVectorSet(TestTextureWidth, TestTextureHeight, 0, 0);
+        }
+    }
+}
@@ -0,0 +1,455 @@
+//--------------------------------------------------------------------------------------
+// File: TextDecoderTest.cpp
+//
+// Checks TextDecoder's UTF-8 decoding against the well-formed byte sequences of the Unicode
+// standard (table 3-7), including its replacement of ill-formed input, and checks the SSE2
+// ASCII scan at every alignment.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHarness.h"
+
+#include "TextDecoder.h"
+
+#include <cstring>
+#include <random>
+#include <string>
+
+using namespace DirectX;
+using namespace DirectX::Tests;
+
+namespace
+{
+    constexpr uint32_t Replacement = 0xFFFD;
+
+
+    // Table 3-7 of the Unicode standard, one row per form of well-formed sequence.
+    struct ByteRange
+    {
+        uint8_t first;
+        uint8_t last;
+    };
+
+    struct SequenceForm
+    {
+        size_t length;
+        ByteRange bytes[4];
+    };
+
+    constexpr SequenceForm WellFormed[] =
+    {
+        { 1, { { 0x00, 0x7F } } },
+        { 2, { { 0xC2, 0xDF }, { 0x80, 0xBF } } },
+        { 3, { { 0xE0, 0xE0 }, { 0xA0, 0xBF }, { 0x80, 0xBF } } },
+        { 3, { { 0xE1, 0xEC }, { 0x80, 0xBF }, { 0x80, 0xBF } } },
+        { 3, { { 0xED, 0xED }, { 0x80, 0x9F }, { 0x80, 0xBF } } },
+        { 3, { { 0xEE, 0xEF }, { 0x80, 0xBF }, { 0x80, 0xBF } } },
+        { 4, { { 0xF0, 0xF0 }, { 0x90, 0xBF }, { 0x80, 0xBF }, { 0x80, 0xBF } } },
+        { 4, { { 0xF1, 0xF3 }, { 0x80, 0xBF }, { 0x80, 0xBF }, { 0x80, 0xBF } } },
+        { 4, { { 0xF4, 0xF4 }, { 0x80, 0x8F }, { 0x80, 0xBF }, { 0x80, 0xBF } } },
+    };
+
+
+    // A straightforward decoder built from the table, to compare against. Each ill-formed
+    // sequence becomes one U+FFFD per maximal subpart: the longest prefix of a well-formed
+    // sequence, or a single byte if no form starts with it.
+    std::vector<uint32_t> ReferenceDecode(std::string const& text)
+    {
+        std::vector<uint32_t> result;
+
+        auto const bytes = reinterpret_cast<uint8_t const*>(text.c_str());
+        const size_t size = text.size();
+
+        size_t i = 0;
+
+        while (i < size)
+        {
+            size_t matched = 0;
+            size_t length = 1;
+
+            for (auto const& form : WellFormed)
+            {
+                size_t n = 0;
+
+                while (n < form.length && i + n < size && bytes[i + n] >= form.bytes[n].first && bytes[i + n] <= form.bytes[n].last)
+                {
+                    n++;
+                }
+
+                if (n > matched)
+                {
+                    matched = n;
+                    length = form.length;
+                }
+            }
+
+            if (matched == 0)
+            {
+                result.push_back(Replacement);
+                i++;
+            }
+            else if (matched < length)
+            {
+                result.push_back(Replacement);
+                i += matched;
+            }
+            else
+            {
+                static const uint8_t leadMask[] = { 0, 0x7F, 0x1F, 0x0F, 0x07 };
+
+                uint32_t codePoint = bytes[i] & leadMask[length];
+
+                for (size_t n = 1; n < length; n++)
+                {
+                    codePoint = (codePoint << 6) | (bytes[i + n] & 0x3Fu);
+                }
+
+                result.push_back(codePoint);
+                i += length;
+            }
+        }
+
+        return result;
+    }
+
+
+    std::vector<uint32_t> Decode(char const* text)
+    {
+        std::vector<uint32_t> result;
+
+        TextDecoder<char> decoder(text);
+
+        while (auto codePoint = decoder.Next())
+        {
+            result.push_back(codePoint);
+        }
+
+        // Reading past the end keeps returning the terminator.
+        if (decoder.Next() != 0 || decoder.Next() != 0)
+        {
+            result.push_back(~0u);
+        }
+
+        return result;
+    }
+
+
+    std::string Encode(uint32_t codePoint)
+    {
+        std::string result;
+
+        if (codePoint < 0x80)
+        {
+            result += char(codePoint);
+        }
+        else if (codePoint < 0x800)
+        {
+            result += char(0xC0 | (codePoint >> 6));
+            result += char(0x80 | (codePoint & 0x3F));
+        }
+        else if (codePoint < 0x10000)
+        {
+            result += char(0xE0 | (codePoint >> 12));
+            result += char(0x80 | ((codePoint >> 6) & 0x3F));
+            result += char(0x80 | (codePoint & 0x3F));
+        }
+        else
+        {
+            result += char(0xF0 | (codePoint >> 18));
+            result += char(0x80 | ((codePoint >> 12) & 0x3F));
+            result += char(0x80 | ((codePoint >> 6) & 0x3F));
+            result += char(0x80 | (codePoint & 0x3F));
+        }
+
+        return result;
+    }
+
+
+    std::string Hex(std::string const& text)
+    {
+        std::string result;
+
+        for (const char c : text)
+        {
+            char digits[4];
+            snprintf(digits, sizeof(digits), "%02X ", static_cast<unsigned int>(static_cast<uint8_t>(c)));
+            result += digits;
+        }
+
+        return result;
+    }
+
+
+    bool Matches(std::string const& text, std::vector<uint32_t> const& expected)
+    {
+        const auto actual = Decode(text.c_str());
+
+        if (actual != expected)
+        {
+            printf("ERROR: %s decoded to", Hex(text).c_str());
+
+            for (const auto c : actual)
+            {
+                printf(" %04X", c);
+            }
+
+            printf(", expected");
+
+            for (const auto c : expected)
+            {
+                printf(" %04X", c);
+            }
+
+            printf("\n");
+            return false;
+        }
+
+        return true;
+    }
+}
+
+
+TEST_CASE(TextDecoderWellFormed)
+{
+    // Every scalar value round-trips, including the first and last of each sequence length.
+    for (uint32_t codePoint = 1; codePoint <= 0x10FFFF; codePoint++)
+    {
+        if (codePoint >= 0xD800 && codePoint <= 0xDFFF)
+            continue;
+
+        const auto text = Encode(codePoint);
+
+        TextDecoder<char> decoder(text.c_str());
+
+        const uint32_t decoded = decoder.Next();
+
+        if (decoded != codePoint || decoder.Next() != 0)
+        {
+            printf("ERROR: U+%04X (%s) decoded to %04X\n", codePoint, Hex(text).c_str(), decoded);
+            return false;
+        }
+    }
+
+    CHECK(Matches("", {}));
+    CHECK(Matches("a\xC2\x80\xDF\xBF\xE0\xA0\x80\xED\x9F\xBF\xEE\x80\x80\xF0\x90\x80\x80\xF4\x8F\xBF\xBFz",
+        { 'a', 0x80, 0x7FF, 0x800, 0xD7FF, 0xE000, 0x10000, 0x10FFFF, 'z' }));
+
+    return true;
+}
+
+
+TEST_CASE(TextDecoderIllFormed)
+{
+    // The example of table 3-8: one replacement per maximal subpart.
+    CHECK(Matches("\x61\xF1\x80\x80\xE1\x80\xC2\x62\x80\x63\x80\xBF\x64",
+        { 0x61, Replacement, Replacement, Replacement, 0x62, Replacement, 0x63, Replacement, Replacement, 0x64 }));
+
+    // Lead bytes that never start a sequence.
+    CHECK(Matches("\xC0\xAF", { Replacement, Replacement }));
+    CHECK(Matches("\xC1\xBF", { Replacement, Replacement }));
+    CHECK(Matches("\xF5\x80\x80\x80", { Replacement, Replacement, Replacement, Replacement }));
+    CHECK(Matches("\xF8\x88\x80\x80\x80", { Replacement, Replacement, Replacement, Replacement, Replacement }));
+    CHECK(Matches("\xFE\xFF", { Replacement, Replacement }));
+
+    // Overlong forms of '/' and of U+07FF and U+FFFF.
+    CHECK(Matches("\xE0\x80\xAF", { Replacement, Replacement, Replacement }));
+    CHECK(Matches("\xE0\x9F\xBF", { Replacement, Replacement, Replacement }));
+    CHECK(Matches("\xF0\x80\x80\xAF", { Replacement, Replacement, Replacement, Replacement }));
+    CHECK(Matches("\xF0\x8F\xBF\xBF", { Replacement, Replacement, Replacement, Replacement }));
+
+    // UTF-16 surrogates, alone and paired.
+    CHECK(Matches("\xED\xA0\x80", { Replacement, Replacement, Replacement }));
+    CHECK(Matches("\xED\xBF\xBF", { Replacement, Replacement, Replacement }));
+    CHECK(Matches("\xED\xA0\xBD\xED\xB2\xA9", { Replacement, Replacement, Replacement, Replacement, Replacement, Replacement }));
+
+    // Above U+10FFFF.
+    CHECK(Matches("\xF4\x90\x80\x80", { Replacement, Replacement, Replacement, Replacement }));
+
+    // Stray continuation bytes.
+    CHECK(Matches("\x80", { Replacement }));
+    CHECK(Matches("a\xBF\x80z", { 'a', Replacement, Replacement, 'z' }));
+
+    // Sequences cut short by the next character keep the valid prefix as one replacement.
+    CHECK(Matches("\xE2\x82z", { Replacement, 'z' }));
+    CHECK(Matches("\xF0\x9F\x98z", { Replacement, 'z' }));
+    CHECK(Matches("\xF0\x9F\xE2\x82\xAC", { Replacement, 0x20AC }));
+    CHECK(Matches("\xC3\xC3\xA9", { Replacement, 0xE9 }));
+
+    // ...and by the terminator, which is never read past.
+    CHECK(Matches("\xC3", { Replacement }));
+    CHECK(Matches("\xE2\x82", { Replacement }));
+    CHECK(Matches("\xF0\x9F\x98", { Replacement }));
+    CHECK(Matches("\xF4\x8F", { Replacement }));
+
+    const char truncated[] = { 'a', char(0xF0), char(0x9F), 0, char(0x98), char(0x80), 0 };
+    CHECK(Matches(truncated, { 'a', Replacement }));
+
+    return true;
+}
+
+
+TEST_CASE(TextDecoderMatchesReference)
+{
+    // Every one and two byte string, and every three byte string with a multi-byte lead.
+    for (unsigned int a = 1; a < 256; a++)
+    {
+        for (unsigned int b = 0; b < 256; b++)
+        {
+            std::string text(1, char(a));
+
+            if (b)
+            {
+                text += char(b);
+            }
+
+            if (!Matches(text, ReferenceDecode(text)))
+                return false;
+
+            if (a < 0xC0 || !b)
+                continue;
+
+            for (unsigned int c = 1; c < 256; c++)
+            {
+                const std::string longer = text + char(c);
+
+                if (!Matches(longer, ReferenceDecode(longer)))
+                    return false;
+            }
+        }
+    }
+
+    // Random strings, biased towards the bytes at the edges of the table's ranges.
+    std::mt19937 rng(11);
+
+    static const uint8_t interesting[] =
+    {
+        'a', 0x7F, 0x80, 0x8F, 0x90, 0x9F, 0xA0, 0xBF, 0xC0, 0xC1, 0xC2, 0xDF,
+        0xE0, 0xE1, 0xEC, 0xED, 0xEE, 0xEF, 0xF0, 0xF1, 0xF3, 0xF4, 0xF5, 0xFF,
+    };
+
+    for (int i = 0; i < 200000; i++)
+    {
+        std::string text(1 + rng() % 24, ' ');
+
+        for (auto& c : text)
+        {
+            c = char((rng() & 1) ? interesting[rng() % std::size(interesting)] : 1 + rng() % 255);
+        }
+
+        if (!Matches(text, ReferenceDecode(text)))
+            return false;
+    }
+
+    return true;
+}
+
+
+TEST_CASE(TextDecoderAsciiScanAlignment)
+{
+    // The scan reads aligned 16 byte blocks, so place runs of ASCII of every length at every
+    // alignment, ended by the terminator or by a multi-byte character, with bytes after the
+    // terminator that must never be decoded.
+    constexpr size_t BufferSize = 128;
+
+    alignas(16) char buffer[BufferSize + 16];
+
+    for (size_t offset = 0; offset < 16; offset++)
+    {
+        for (size_t length = 0; length + offset + 8 < BufferSize; length++)
+        {
+            for (const bool multiByte : { false, true })
+            {
+                memset(buffer, char(0xFF), sizeof(buffer));
+
+                char* text = buffer + offset;
+                std::vector<uint32_t> expected;
+
+                for (size_t i = 0; i < length; i++)
+                {
+                    text[i] = char('A' + (i % 26));
+                    expected.push_back(uint32_t(text[i]));
+                }
+
+                size_t end = length;
+
+                if (multiByte)
+                {
+                    // A euro sign, then more ASCII to restart the scan from an unaligned position.
+                    memcpy(text + end, "\xE2\x82\xACxy", 5);
+                    end += 5;
+                    expected.insert(expected.end(), { 0x20AC, 'x', 'y' });
+                }
+
+                text[end] = 0;
+
+                const auto actual = Decode(text);
+
+                if (actual != expected)
+                {
+                    printf("ERROR: %zu ASCII bytes at offset %zu%s decoded to %zu code points, expected %zu\n",
+                        length, offset, multiByte ? " followed by U+20AC" : "", actual.size(), expected.size());
+                    return false;
+                }
+            }
+        }
+    }
+
+    // A single non-ASCII byte at every position of a longer ASCII run.
+    std::string text(100, 'q');
+
+    for (size_t position = 0; position < text.size(); position++)
+    {
+        for (size_t offset = 0; offset < 16; offset++)
+        {
+            memset(buffer, 0, sizeof(buffer));
+            memcpy(buffer + offset, text.c_str(), text.size());
+
+            buffer[offset + position] = char(0xC3);
+
+            std::vector<uint32_t> expected(text.size() - 1, 'q');
+            expected.insert(expected.begin() + std::ptrdiff_t(position), Replacement);
+
+            // A lead byte followed by ASCII is a truncated sequence, which consumes only the lead.
+            const auto actual = Decode(buffer + offset);
+
+            if (actual != expected)
+            {
+                printf("ERROR: stray lead byte at position %zu, offset %zu\n", position, offset);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+TEST_CASE(TextDecoderWide)
+{
+    std::wstring text = L"a\x00E9\x20AC";
+
+#if WCHAR_MAX <= 0xFFFF
+    // A surrogate pair, an unpaired high surrogate, and an unpaired low surrogate.
+    text += L"\xD83D\xDE00\xD800z\xDC00";
+    const std::vector<uint32_t> expected = { 'a', 0xE9, 0x20AC, 0x1F600, 0xD800, 'z', 0xDC00 };
+#else
+    text += wchar_t(0x1F600);
+    const std::vector<uint32_t> expected = { 'a', 0xE9, 0x20AC, 0x1F600 };
+#endif
+
+    TextDecoder<wchar_t> decoder(text.c_str());
+
+    for (const auto codePoint : expected)
+    {
+        CHECK(decoder.Next() == codePoint);
+    }
+
+    CHECK(decoder.Next() == 0);
+    CHECK(decoder.Next() == 0);
+
+    return true;
+}
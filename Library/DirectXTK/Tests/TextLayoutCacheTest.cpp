@@ -0,0 +1,263 @@
+//--------------------------------------------------------------------------------------
+// File: TextLayoutCacheTest.cpp
+//
+// Checks TextLayoutCache's hits, least recently used eviction, capacity changes, and use
+// from several threads.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHarness.h"
+
+#include "TextLayoutCache.h"
+
+#include <random>
+#include <string>
+#include <thread>
+
+using namespace DirectX;
+using namespace DirectX::Tests;
+
+namespace
+{
+    using Cache = TextLayoutCache<std::string>;
+
+
+    // Looks text up, counting the values created on misses. Each value records the text it was made for.
+    class CountingCache
+    {
+    public:
+        explicit CountingCache(size_t capacity) :
+            mCache(capacity),
+            mCreated(0)
+        {
+        }
+
+        template<typename TChar>
+        std::shared_ptr<std::string const> Get(TChar const* text)
+        {
+            return mCache.GetOrCreate(text, [&]()
+                {
+                    mCreated++;
+
+                    std::string value;
+
+                    for (size_t i = 0; text[i]; i++)
+                    {
+                        value += char(text[i]);
+                    }
+
+                    return std::make_shared<std::string const>(value);
+                });
+        }
+
+        // Returns whether looking text up created a new value.
+        template<typename TChar>
+        bool Misses(TChar const* text)
+        {
+            const size_t before = mCreated;
+
+            Get(text);
+
+            return mCreated != before;
+        }
+
+        Cache& GetCache() noexcept { return mCache; }
+
+    private:
+        Cache mCache;
+        size_t mCreated;
+    };
+}
+
+
+TEST_CASE(TextLayoutCacheHits)
+{
+    CountingCache cache(8);
+
+    const auto first = cache.Get("hello");
+
+    CHECK(*first == "hello");
+
+    // A hit returns the stored value, without creating another.
+    CHECK(!cache.Misses("hello"));
+    CHECK(cache.Get("hello") == first);
+
+    // Different strings, prefixes and extensions of a cached string are all misses.
+    CHECK(cache.Misses("hellO"));
+    CHECK(cache.Misses("hell"));
+    CHECK(cache.Misses("hello!"));
+    CHECK(cache.Misses(""));
+    CHECK(!cache.Misses(""));
+
+    // Narrow and wide strings with the same values are cached separately.
+    CHECK(cache.Misses(L"hello"));
+    CHECK(!cache.Misses(L"hello"));
+    CHECK(cache.Get("hello") == first);
+
+    // Clearing forgets everything, but values already handed out stay valid.
+    cache.GetCache().Clear();
+
+    CHECK(cache.Misses("hello"));
+    CHECK(*first == "hello");
+    CHECK(cache.Get("hello") != first);
+
+    return true;
+}
+
+
+TEST_CASE(TextLayoutCacheEvictsLeastRecentlyUsed)
+{
+    CountingCache cache(3);
+
+    CHECK(cache.Misses("a"));
+    CHECK(cache.Misses("b"));
+    CHECK(cache.Misses("c"));
+
+    // Using "a" makes "b" the least recently used, so it is the one that makes room for "d".
+    CHECK(!cache.Misses("a"));
+    CHECK(cache.Misses("d"));
+
+    CHECK(!cache.Misses("a"));
+    CHECK(!cache.Misses("c"));
+    CHECK(!cache.Misses("d"));
+
+    // Now "a" is the oldest.
+    CHECK(cache.Misses("b"));
+    CHECK(cache.Misses("a"));
+
+    // Random use agrees with a simple model of the list, most recent first.
+    std::mt19937 rng(16);
+
+    std::vector<std::string> model = { "a", "b", "d" };
+
+    for (int i = 0; i < 20000; i++)
+    {
+        const std::string text(1, char('a' + rng() % 6));
+
+        auto it = std::find(model.begin(), model.end(), text);
+        const bool expectMiss = (it == model.end());
+
+        if (!expectMiss)
+        {
+            model.erase(it);
+        }
+
+        model.insert(model.begin(), text);
+
+        if (model.size() > 3)
+        {
+            model.pop_back();
+        }
+
+        if (cache.Misses(text.c_str()) != expectMiss)
+        {
+            printf("ERROR: lookup %d of \"%s\" %s\n", i, text.c_str(), expectMiss ? "hit, expected a miss" : "missed, expected a hit");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+TEST_CASE(TextLayoutCacheCapacity)
+{
+    CountingCache cache(4);
+
+    CHECK(cache.GetCache().GetCapacity() == 4);
+
+    for (const char* text : { "a", "b", "c", "d" })
+    {
+        CHECK(cache.Misses(text));
+    }
+
+    // Shrinking keeps the most recently used entries.
+    cache.GetCache().SetCapacity(2);
+
+    CHECK(!cache.Misses("d"));
+    CHECK(!cache.Misses("c"));
+    CHECK(cache.Misses("b"));
+
+    // A capacity of zero turns the cache off: every lookup creates a value, and none are kept.
+    cache.GetCache().SetCapacity(0);
+
+    CHECK(cache.Misses("b"));
+    CHECK(cache.Misses("b"));
+
+    cache.GetCache().SetCapacity(2);
+
+    CHECK(cache.Misses("b"));
+    CHECK(!cache.Misses("b"));
+
+    CountingCache disabled(0);
+
+    CHECK(disabled.Misses("x"));
+    CHECK(disabled.Misses("x"));
+    CHECK(*disabled.Get("x") == "x");
+
+    return true;
+}
+
+
+TEST_CASE(TextLayoutCacheThreads)
+{
+    Cache cache(16);
+
+    std::vector<std::string> strings;
+
+    for (int i = 0; i < 40; i++)
+    {
+        strings.push_back("string " + std::to_string(i));
+    }
+
+    constexpr int ThreadCount = 8;
+
+    std::vector<int> wrong(ThreadCount, 0);
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < ThreadCount; t++)
+    {
+        threads.emplace_back([&, t]()
+            {
+                std::mt19937 rng(static_cast<uint32_t>(t));
+
+                for (int i = 0; i < 20000; i++)
+                {
+                    auto const& text = strings[rng() % strings.size()];
+
+                    // Every value must be the one made for the text it was looked up with.
+                    auto value = cache.GetOrCreate(text.c_str(), [&]() { return std::make_shared<std::string const>(text); });
+
+                    if (*value != text)
+                    {
+                        wrong[size_t(t)]++;
+                    }
+
+                    if (i % 5000 == 0)
+                    {
+                        cache.SetCapacity(8 + (rng() % 16));
+                    }
+                }
+            });
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    for (int t = 0; t < ThreadCount; t++)
+    {
+        if (wrong[size_t(t)])
+        {
+            printf("ERROR: thread %d got %d values made for other strings\n", t, wrong[size_t(t)]);
+            return false;
+        }
+    }
+
+    return true;
+}
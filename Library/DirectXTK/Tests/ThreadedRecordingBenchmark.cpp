@@ -0,0 +1,166 @@
+//--------------------------------------------------------------------------------------
+// File: ThreadedRecordingBenchmark.cpp
+//
+// Measures how the time to record a frame of sprites scales with the number of threads
+// calling SpriteBatch::Draw, and what End's merge adds.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "DeviceTest.h"
+
+#include "SpriteBatch.h"
+
+#include <random>
+#include <thread>
+
+using namespace DirectX;
+using namespace DirectX::Tests;
+
+namespace
+{
+    struct SpriteParameters
+    {
+        XMFLOAT2 position;
+        float rotation;
+        float depth;
+    };
+
+
+    std::vector<SpriteParameters> MakeSprites(size_t count)
+    {
+        std::mt19937 rng(2);
+        std::uniform_real_distribution<float> position(0.f, 512.f);
+        std::uniform_real_distribution<float> unit(0.f, 1.f);
+
+        std::vector<SpriteParameters> sprites(count);
+
+        for (auto& sprite : sprites)
+        {
+            sprite.position.x = position(rng);
+            sprite.position.y = position(rng);
+            sprite.rotation = unit(rng);
+            sprite.depth = unit(rng);
+        }
+
+        return sprites;
+    }
+
+
+    void DrawRange(SpriteBatch& batch, ID3D11ShaderResourceView* texture, SpriteParameters const* sprites, size_t count)
+    {
+        static const RECT source = { 0, 0, 8, 8 };
+
+        for (size_t i = 0; i < count; i++)
+        {
+            batch.Draw(texture, sprites[i].position, &source, Colors::White, sprites[i].rotation, XMFLOAT2(4.f, 4.f), 1.f, SpriteEffects_None, sprites[i].depth);
+        }
+    }
+}
+
+
+BENCHMARK(ThreadedRecordingScaling)
+{
+    TestDevice test;
+
+    if (!CreateTestDevice(test))
+        return false;
+
+    auto context = test.context.Get();
+
+    TestRenderTarget renderTarget(test.device.Get(), 512, 512);
+
+    renderTarget.Begin(context);
+
+    auto texture = CreateTestTexture(test.device.Get(), 16, 16, 1);
+
+    constexpr size_t SpriteCount = 200000;
+    constexpr size_t Frames = 10;
+
+    const auto sprites = MakeSprites(SpriteCount);
+
+    const size_t hardwareThreads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+
+    printf("%zu sprites per frame, %zu hardware threads\n", SpriteCount, hardwareThreads);
+    printf("%10s %12s %12s %12s   (ms per frame; record includes starting the threads)\n", "threads", "mode", "record", "End");
+
+    for (const auto sortMode : { SpriteSortMode_Deferred, SpriteSortMode_BackToFront })
+    {
+        // The single-threaded baseline records straight into the main queue, with no merge.
+        for (size_t threadCount = 0; threadCount <= hardwareThreads; threadCount = threadCount ? threadCount * 2 : 1)
+        {
+            SpriteBatch batch(context);
+
+            batch.SetThreadedRecording(threadCount > 0);
+
+            using clock = std::chrono::steady_clock;
+
+            clock::duration recordTime{};
+            clock::duration endTime{};
+
+            for (size_t frame = 0; frame < Frames; frame++)
+            {
+                batch.Begin(sortMode);
+
+                const auto recordStart = clock::now();
+
+                if (!threadCount)
+                {
+                    DrawRange(batch, texture.Get(), sprites.data(), SpriteCount);
+                }
+                else
+                {
+                    std::vector<std::thread> threads;
+
+                    for (size_t thread = 0; thread < threadCount; thread++)
+                    {
+                        const size_t begin = SpriteCount * thread / threadCount;
+                        const size_t end = SpriteCount * (thread + 1) / threadCount;
+
+                        threads.emplace_back([&, begin, end]()
+                            {
+                                DrawRange(batch, texture.Get(), sprites.data() + begin, end - begin);
+                            });
+                    }
+
+                    for (auto& thread : threads)
+                    {
+                        thread.join();
+                    }
+                }
+
+                const auto endStart = clock::now();
+
+                batch.End();
+
+                const auto endFinish = clock::now();
+
+                recordTime += endStart - recordStart;
+                endTime += endFinish - endStart;
+
+                WaitForGpu(test.device.Get(), context);
+            }
+
+            const double recordMs = std::chrono::duration<double, std::milli>(recordTime).count() / double(Frames);
+            const double endMs = std::chrono::duration<double, std::milli>(endTime).count() / double(Frames);
+
+            char threadLabel[16];
+
+            if (threadCount)
+            {
+                snprintf(threadLabel, sizeof(threadLabel), "%zu", threadCount);
+            }
+            else
+            {
+                snprintf(threadLabel, sizeof(threadLabel), "off");
+            }
+
+            printf("%10s %12s %12.3f %12.3f\n", threadLabel, (sortMode == SpriteSortMode_Deferred) ? "Deferred" : "BackToFront", recordMs, endMs);
+        }
+    }
+
+    return true;
+}
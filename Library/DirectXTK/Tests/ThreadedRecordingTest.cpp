@@ -0,0 +1,220 @@
+//--------------------------------------------------------------------------------------
+// File: ThreadedRecordingTest.cpp
+//
+// Checks that sprites drawn from several threads with SetThreadedRecording come out exactly
+// as if one thread had drawn each thread's sprites in turn.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "DeviceTest.h"
+#include "SpriteTestData.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+
+using namespace DirectX;
+using namespace DirectX::Tests;
+using Microsoft::WRL::ComPtr;
+
+namespace
+{
+    // Forwards Draw to a SpriteBatch, holding back a thread's first Draw until the thread before
+    // it has made its own. That fixes the order End merges the threads in, while every later Draw
+    // still races with the other threads.
+    class TurnTakingBatch
+    {
+    public:
+        TurnTakingBatch(SpriteBatch& batch, std::atomic<size_t>& turn, size_t myTurn) noexcept :
+            mBatch(batch),
+            mTurn(turn),
+            mMyTurn(myTurn),
+            mStarted(false)
+        {
+        }
+
+        template<typename... TArgs>
+        void Draw(TArgs&&... args)
+        {
+            if (mStarted)
+            {
+                mBatch.Draw(std::forward<TArgs>(args)...);
+                return;
+            }
+
+            while (mTurn.load() != mMyTurn)
+            {
+                std::this_thread::yield();
+            }
+
+            mBatch.Draw(std::forward<TArgs>(args)...);
+
+            mStarted = true;
+            mTurn++;
+        }
+
+    private:
+        SpriteBatch& mBatch;
+        std::atomic<size_t>& mTurn;
+        size_t mMyTurn;
+        bool mStarted;
+    };
+
+
+    const SpriteSortMode SortModes[] =
+    {
+        SpriteSortMode_Deferred,
+        SpriteSortMode_Texture,
+        SpriteSortMode_BackToFront,
+        SpriteSortMode_FrontToBack,
+    };
+
+    const char* const SortModeNames[] = { "Deferred", "Texture", "BackToFront", "FrontToBack" };
+
+    constexpr size_t MaxThreads = 8;
+    constexpr size_t SpritesPerThread = 1500;
+
+
+    uint32_t ThreadSeed(size_t thread) noexcept
+    {
+        return static_cast<uint32_t>(1000 + thread);
+    }
+}
+
+
+TEST_CASE(ThreadedRecordingMatchesSingleThread)
+{
+    TestDevice test;
+
+    if (!CreateTestDevice(test))
+        return false;
+
+    auto context = test.context.Get();
+
+    SetTestViewport(context, 1024, 1024);
+
+    ComPtr<ID3D11ShaderResourceView> textures[] =
+    {
+        CreateTestTexture(test.device.Get(), 64, 32, 1),
+        CreateTestTexture(test.device.Get(), 17, 9, 2),
+        CreateTestTexture(test.device.Get(), 128, 128, 3),
+    };
+
+    ID3D11ShaderResourceView* const textureViews[] = { textures[0].Get(), textures[1].Get(), textures[2].Get() };
+
+    VertexCapture capture(test.device.Get(), MaxThreads * SpritesPerThread * 6);
+
+    // The same SpriteBatch records every frame, so segments left over from earlier frames with
+    // more threads must not leak into later ones.
+    SpriteBatch threaded(context);
+
+    threaded.SetThreadedRecording(true);
+
+    for (size_t mode = 0; mode < std::size(SortModes); mode++)
+    {
+        for (const size_t threadCount : { size_t(1), size_t(2), MaxThreads, size_t(3) })
+        {
+            // Reference: one thread draws each thread's sprites in turn.
+            SpriteBatch reference(context);
+
+            reference.Begin(SortModes[mode], nullptr, nullptr, nullptr, nullptr, capture.Begin(context));
+
+            for (size_t thread = 0; thread < threadCount; thread++)
+            {
+                DrawTestSprites(reference, textureViews, std::size(textureViews), SpritesPerThread, ThreadSeed(thread));
+            }
+
+            reference.End();
+
+            const auto expected = capture.End(context);
+
+            CHECK(expected.size() == threadCount * SpritesPerThread * 6);
+
+            // The threads take their first turns in reverse, so the merge order is not simply creation order.
+            std::atomic<size_t> turn(0);
+
+            threaded.Begin(SortModes[mode], nullptr, nullptr, nullptr, nullptr, capture.Begin(context));
+
+            std::vector<std::thread> threads;
+
+            for (size_t thread = 0; thread < threadCount; thread++)
+            {
+                threads.emplace_back([&, thread]()
+                    {
+                        TurnTakingBatch batch(threaded, turn, threadCount - 1 - thread);
+
+                        DrawTestSprites(batch, textureViews, std::size(textureViews), SpritesPerThread, ThreadSeed(threadCount - 1 - thread));
+                    });
+            }
+
+            for (auto& thread : threads)
+            {
+                thread.join();
+            }
+
+            threaded.End();
+
+            const auto actual = capture.End(context);
+
+            CHECK(threaded.GetStatistics().spritesQueued == threadCount * SpritesPerThread);
+
+            char description[64];
+            snprintf(description, sizeof(description), "%s, %zu threads", SortModeNames[mode], threadCount);
+
+            if (!CompareVertices(expected, actual, description))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+
+TEST_CASE(ThreadedRecordingRejectsImmediateMode)
+{
+    TestDevice test;
+
+    if (!CreateTestDevice(test))
+        return false;
+
+    SpriteBatch batch(test.context.Get());
+
+    batch.SetThreadedRecording(true);
+
+    bool threw = false;
+
+    try
+    {
+        batch.Begin(SpriteSortMode_Immediate);
+    }
+    catch (std::logic_error const&)
+    {
+        threw = true;
+    }
+
+    CHECK(threw);
+
+    // The setting cannot change while a batch is being recorded.
+    batch.Begin();
+
+    threw = false;
+
+    try
+    {
+        batch.SetThreadedRecording(false);
+    }
+    catch (std::logic_error const&)
+    {
+        threw = true;
+    }
+
+    batch.End();
+
+    CHECK(threw);
+
+    return true;
+}
@@ -0,0 +1,289 @@
+//--------------------------------------------------------------------------------------
+// File: TriangleBVHBenchmark.cpp
+//
+// Times TriangleBVH Build and Refit, and picking with single rays and with packets, for rays
+// from a camera and for rays in random directions, against testing every triangle.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHarness.h"
+
+#include "TriangleBVH.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+using namespace DirectX::SimpleMath;
+using namespace DirectX::Tests;
+
+namespace
+{
+    struct BenchmarkMesh
+    {
+        char const* name;
+        std::vector<XMFLOAT3> positions;
+        std::vector<uint32_t> indices;
+    };
+
+
+    // A height field of size x size quads, like terrain or a tessellated surface.
+    BenchmarkMesh MakeTerrain(size_t size)
+    {
+        BenchmarkMesh mesh = { "terrain", {}, {} };
+
+        for (size_t z = 0; z <= size; z++)
+        {
+            for (size_t x = 0; x <= size; x++)
+            {
+                const float fx = float(x) * 20.f / float(size) - 10.f;
+                const float fz = float(z) * 20.f / float(size) - 10.f;
+
+                mesh.positions.emplace_back(fx, 2.f * std::sin(fx * 0.7f) * std::cos(fz * 0.5f), fz);
+            }
+        }
+
+        const auto stride = static_cast<uint32_t>(size + 1);
+
+        for (uint32_t z = 0; z < uint32_t(size); z++)
+        {
+            for (uint32_t x = 0; x < uint32_t(size); x++)
+            {
+                const uint32_t i = z * stride + x;
+                const uint32_t quad[] = { i, i + stride, i + 1, i + 1, i + stride, i + stride + 1 };
+
+                mesh.indices.insert(mesh.indices.end(), quad, quad + 6);
+            }
+        }
+
+        return mesh;
+    }
+
+
+    // Small unconnected triangles filling a cube, which overlap far more than a real mesh.
+    BenchmarkMesh MakeSoup(std::mt19937& rng, size_t triangleCount)
+    {
+        std::uniform_real_distribution<float> center(-10.f, 10.f);
+        std::uniform_real_distribution<float> offset(-0.3f, 0.3f);
+
+        BenchmarkMesh mesh = { "soup", {}, {} };
+
+        for (size_t t = 0; t < triangleCount; t++)
+        {
+            const float cx = center(rng);
+            const float cy = center(rng);
+            const float cz = center(rng);
+
+            for (uint32_t corner = 0; corner < 3; corner++)
+            {
+                mesh.indices.push_back(static_cast<uint32_t>(mesh.positions.size()));
+                mesh.positions.emplace_back(cx + offset(rng), cy + offset(rng), cz + offset(rng));
+            }
+        }
+
+        return mesh;
+    }
+
+
+    // One ray per pixel of a width x width image, looking down at the middle of the scene.
+    std::vector<Ray> MakeCameraRays(size_t width)
+    {
+        const XMVECTOR eye = XMVectorSet(0.f, 12.f, -18.f, 0.f);
+        const XMMATRIX view = XMMatrixLookAtLH(eye, g_XMZero, g_XMIdentityR1);
+        const XMMATRIX cameraToWorld = XMMatrixInverse(nullptr, view);
+
+        std::vector<Ray> rays;
+        rays.reserve(width * width);
+
+        for (size_t y = 0; y < width; y++)
+        {
+            for (size_t x = 0; x < width; x++)
+            {
+                const float sx = (float(x) + 0.5f) / float(width) * 1.2f - 0.6f;
+                const float sy = 0.6f - (float(y) + 0.5f) / float(width) * 1.2f;
+
+                const XMVECTOR direction = XMVector3Normalize(XMVector3TransformNormal(XMVectorSet(sx, sy, 1.f, 0.f), cameraToWorld));
+
+                rays.emplace_back(Vector3(eye), Vector3(direction));
+            }
+        }
+
+        return rays;
+    }
+
+
+    // From anywhere in the scene, in any direction, so neighboring rays share little of the tree.
+    std::vector<Ray> MakeRandomRays(std::mt19937& rng, size_t count)
+    {
+        std::uniform_real_distribution<float> position(-12.f, 12.f);
+        std::normal_distribution<float> component;
+
+        std::vector<Ray> rays;
+        rays.reserve(count);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            const XMVECTOR direction = XMVector3Normalize(XMVectorSet(component(rng), component(rng), component(rng), 0.f));
+
+            rays.emplace_back(Vector3(position(rng), position(rng), position(rng)), Vector3(direction));
+        }
+
+        return rays;
+    }
+
+
+    // What picking costs without the tree: the nearest of every triangle's TriangleTests::Intersects.
+    size_t BruteForceIntersects(BenchmarkMesh const& mesh, Ray const& ray)
+    {
+        const XMVECTOR origin = XMLoadFloat3(&ray.position);
+        const XMVECTOR direction = XMLoadFloat3(&ray.direction);
+
+        float nearest = FLT_MAX;
+        size_t hits = 0;
+
+        for (size_t i = 0; i < mesh.indices.size(); i += 3)
+        {
+            const XMVECTOR v0 = XMLoadFloat3(&mesh.positions[mesh.indices[i]]);
+            const XMVECTOR v1 = XMLoadFloat3(&mesh.positions[mesh.indices[i + 1]]);
+            const XMVECTOR v2 = XMLoadFloat3(&mesh.positions[mesh.indices[i + 2]]);
+
+            float dist;
+            if (TriangleTests::Intersects(origin, direction, v0, v1, v2, dist) && dist < nearest)
+            {
+                nearest = dist;
+                hits++;
+            }
+        }
+
+        return hits;
+    }
+
+
+    double RaysPerSecond(double nanoseconds, size_t rays) noexcept
+    {
+        return double(rays) * 1e9 / nanoseconds;
+    }
+}
+
+
+BENCHMARK(TriangleBVHBuildAndRefit)
+{
+    std::mt19937 rng(22);
+
+    // About 200K triangles each.
+    const BenchmarkMesh meshes[] = { MakeTerrain(316), MakeSoup(rng, 200000) };
+
+    printf("%-8s %10s %12s %12s\n", "mesh", "triangles", "Build (ms)", "Refit (ms)");
+
+    for (auto const& mesh : meshes)
+    {
+        TriangleBVH bvh;
+
+        const double build = MeasureNanoseconds(1, [&]()
+            {
+                bvh.Build(mesh.positions, mesh.indices);
+            });
+
+        // Refit to a mesh moved a little, the way a skinned mesh would be from frame to frame.
+        auto moved = mesh.positions;
+
+        for (size_t i = 0; i < moved.size(); i++)
+        {
+            moved[i].y += 0.05f * std::sin(float(i) * 0.01f);
+        }
+
+        const double refit = MeasureNanoseconds(4, [&]()
+            {
+                bvh.Refit(moved);
+            });
+
+        KeepResult(bvh.GetTriangleCount());
+
+        printf("%-8s %10zu %12.2f %12.2f\n", mesh.name, mesh.indices.size() / 3, build * 1e-6, refit * 1e-6);
+    }
+
+    return true;
+}
+
+
+BENCHMARK(TriangleBVHRaysPerSecond)
+{
+    std::mt19937 rng(23);
+
+    const BenchmarkMesh meshes[] = { MakeTerrain(316), MakeSoup(rng, 200000) };
+
+    struct RaySet
+    {
+        char const* name;
+        std::vector<Ray> rays;
+    };
+
+    const RaySet raySets[] =
+    {
+        { "camera", MakeCameraRays(256) },
+        { "random", MakeRandomRays(rng, 65536) },
+    };
+
+    // Testing every triangle is slow enough that a few rays are plenty to time it.
+    constexpr size_t BruteForceRays = 64;
+
+    printf("%-8s %-8s %14s %14s %14s   (rays per second)\n", "mesh", "rays", "brute force", "single", "packets");
+
+    for (auto const& mesh : meshes)
+    {
+        TriangleBVH bvh;
+        bvh.Build(mesh.positions, mesh.indices);
+
+        for (auto const& raySet : raySets)
+        {
+            auto const& rays = raySet.rays;
+            const size_t count = rays.size();
+
+            std::vector<float> dist(count);
+            std::vector<uint32_t> triangles(count);
+
+            const double bruteForce = MeasureNanoseconds(1, [&]()
+                {
+                    size_t hits = 0;
+
+                    for (size_t i = 0; i < BruteForceRays; i++)
+                    {
+                        hits += BruteForceIntersects(mesh, rays[i * (count / BruteForceRays)]);
+                    }
+
+                    KeepResult(hits);
+                });
+
+            const double single = MeasureNanoseconds(4, [&]()
+                {
+                    size_t hits = 0;
+
+                    for (size_t i = 0; i < count; i++)
+                    {
+                        hits += bvh.Intersects(rays[i], dist[i], &triangles[i]) ? 1 : 0;
+                    }
+
+                    KeepResult(hits);
+                });
+
+            const double packets = MeasureNanoseconds(4, [&]()
+                {
+                    KeepResult(bvh.Intersects(rays.data(), count, dist.data(), triangles.data()));
+                });
+
+            printf("%-8s %-8s %14.0f %14.0f %14.0f\n", mesh.name, raySet.name,
+                RaysPerSecond(bruteForce, BruteForceRays),
+                RaysPerSecond(single, count),
+                RaysPerSecond(packets, count));
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,619 @@
+//--------------------------------------------------------------------------------------
+// File: TriangleBVHTest.cpp
+//
+// Checks TriangleBVH picking, for single rays and for packets, against testing every triangle
+// with TriangleTests::Intersects: after Build, on meshes large enough to be built in parallel
+// subtrees, and after Refit.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHarness.h"
+
+#include "TriangleBVH.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace DirectX;
+using namespace DirectX::SimpleMath;
+
+namespace
+{
+    // Laid out like VertexPositionNormalTexture, so positions are read with a stride.
+    struct TestVertex
+    {
+        XMFLOAT3 position;
+        XMFLOAT3 normal;
+        XMFLOAT2 textureCoordinate;
+    };
+
+
+    struct TestMesh
+    {
+        std::vector<TestVertex> vertices;
+        std::vector<uint32_t> indices;
+
+        size_t TriangleCount() const noexcept { return indices.size() / 3; }
+
+        XMVECTOR Position(size_t triangle, size_t corner) const noexcept
+        {
+            return XMLoadFloat3(&vertices[indices[triangle * 3 + corner]].position);
+        }
+    };
+
+
+    // Triangles of many sizes scattered through a cube, some of them repeated, sharing an edge or
+    // a vertex with the one before, or with no area.
+    TestMesh MakeSoup(std::mt19937& rng, size_t triangleCount)
+    {
+        std::uniform_real_distribution<float> coordinate(-10.f, 10.f);
+        std::uniform_real_distribution<float> exponent(-2.f, 0.5f);
+        std::uniform_real_distribution<float> offset(-1.f, 1.f);
+
+        TestMesh mesh;
+
+        auto addVertex = [&](float x, float y, float z)
+            {
+                TestVertex vertex = {};
+                vertex.position = XMFLOAT3(x, y, z);
+
+                mesh.vertices.push_back(vertex);
+                return static_cast<uint32_t>(mesh.vertices.size() - 1);
+            };
+
+        for (size_t t = 0; t < triangleCount; t++)
+        {
+            const size_t count = mesh.indices.size();
+
+            if (t > 0 && t % 50 == 0)
+            {
+                // Repeated, so two triangles are hit at exactly the same distance.
+                const uint32_t previous[] = { mesh.indices[count - 3], mesh.indices[count - 2], mesh.indices[count - 1] };
+                mesh.indices.insert(mesh.indices.end(), previous, previous + 3);
+                continue;
+            }
+
+            const float cx = coordinate(rng);
+            const float cy = coordinate(rng);
+            const float cz = coordinate(rng);
+            const float size = std::pow(10.f, exponent(rng));
+
+            uint32_t corners[3];
+
+            for (auto& corner : corners)
+            {
+                corner = addVertex(cx + offset(rng) * size, cy + offset(rng) * size, cz + offset(rng) * size);
+            }
+
+            if (t % 50 == 17)
+            {
+                // No area, with all three corners one vertex. Corners that are only nearly in line
+                // may be hit or missed depending on rounding, so are left out.
+                corners[1] = corners[2] = corners[0];
+            }
+            else if (count && t % 7 == 3)
+            {
+                corners[0] = mesh.indices[count - 1];
+                corners[1] = mesh.indices[count - 2];
+            }
+            else if (count && t % 7 == 5)
+            {
+                corners[0] = mesh.indices[count - 3];
+            }
+
+            mesh.indices.insert(mesh.indices.end(), corners, corners + 3);
+        }
+
+        return mesh;
+    }
+
+
+    // A rolling height field of size x size quads, two triangles each, sharing all their edges.
+    TestMesh MakeGrid(std::mt19937& rng, size_t size)
+    {
+        std::uniform_real_distribution<float> phase(0.f, 6.f);
+
+        const float px = phase(rng);
+        const float pz = phase(rng);
+
+        TestMesh mesh;
+
+        for (size_t z = 0; z <= size; z++)
+        {
+            for (size_t x = 0; x <= size; x++)
+            {
+                const float fx = float(x) * 20.f / float(size) - 10.f;
+                const float fz = float(z) * 20.f / float(size) - 10.f;
+
+                TestVertex vertex = {};
+                vertex.position = XMFLOAT3(fx, 2.f * std::sin(fx * 0.7f + px) * std::cos(fz * 0.5f + pz), fz);
+
+                mesh.vertices.push_back(vertex);
+            }
+        }
+
+        for (size_t z = 0; z < size; z++)
+        {
+            for (size_t x = 0; x < size; x++)
+            {
+                const auto corner = static_cast<uint32_t>(z * (size + 1) + x);
+                const auto stride = static_cast<uint32_t>(size + 1);
+
+                const uint32_t quad[] = { corner, corner + stride, corner + 1, corner + 1, corner + stride, corner + stride + 1 };
+                mesh.indices.insert(mesh.indices.end(), quad, quad + 6);
+            }
+        }
+
+        return mesh;
+    }
+
+
+    Ray MakeRay(XMVECTOR origin, XMVECTOR direction) noexcept
+    {
+        Ray ray;
+        XMStoreFloat3(&ray.position, origin);
+        XMStoreFloat3(&ray.direction, XMVector3Normalize(direction));
+        return ray;
+    }
+
+
+    // Most rays are aimed at a point inside a random triangle, from somewhere around the mesh, so
+    // that they hit something. The rest go in random directions, some of them along an axis.
+    std::vector<Ray> MakeRays(std::mt19937& rng, TestMesh const& mesh, size_t count)
+    {
+        std::uniform_real_distribution<float> coordinate(-15.f, 15.f);
+        std::uniform_real_distribution<float> weight(0.05f, 1.f);
+
+        std::vector<Ray> rays(count);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            const XMVECTOR origin = XMVectorSet(coordinate(rng), coordinate(rng), coordinate(rng), 0);
+
+            if (mesh.TriangleCount() && i % 4 != 0)
+            {
+                const size_t t = rng() % mesh.TriangleCount();
+
+                const float w0 = weight(rng);
+                const float w1 = weight(rng);
+                const float w2 = weight(rng);
+                const float total = w0 + w1 + w2;
+
+                XMVECTOR target = XMVectorScale(mesh.Position(t, 0), w0 / total);
+                target = XMVectorMultiplyAdd(mesh.Position(t, 1), XMVectorReplicate(w1 / total), target);
+                target = XMVectorMultiplyAdd(mesh.Position(t, 2), XMVectorReplicate(w2 / total), target);
+
+                const XMVECTOR direction = XMVectorSubtract(target, origin);
+
+                rays[i] = MakeRay(origin, XMVector3Equal(direction, XMVectorZero()) ? g_XMIdentityR1 : direction);
+            }
+            else
+            {
+                XMVECTOR direction = XMVectorSet(coordinate(rng), coordinate(rng), coordinate(rng), 0);
+
+                switch (i % 12)
+                {
+                case 4: direction = XMVectorSet(0, 0, XMVectorGetZ(direction), 0); break;
+                case 8: direction = XMVectorSet(0, XMVectorGetY(direction), 0, 0); break;
+                default: break;
+                }
+
+                rays[i] = MakeRay(origin, XMVector3Equal(direction, XMVectorZero()) ? g_XMIdentityR2 : direction);
+            }
+        }
+
+        return rays;
+    }
+
+
+    bool IntersectsTriangle(TestMesh const& mesh, size_t triangle, Ray const& ray, float& dist) noexcept
+    {
+        return TriangleTests::Intersects(XMLoadFloat3(&ray.position), XMLoadFloat3(&ray.direction),
+            mesh.Position(triangle, 0), mesh.Position(triangle, 1), mesh.Position(triangle, 2), dist);
+    }
+
+
+    // The nearest hit over every triangle, taking the first in index order on a tie.
+    uint32_t BruteForceIntersects(TestMesh const& mesh, Ray const& ray, float& nearest) noexcept
+    {
+        nearest = FLT_MAX;
+        uint32_t nearestTriangle = TriangleBVH::NoHit;
+
+        for (size_t t = 0; t < mesh.TriangleCount(); t++)
+        {
+            float dist;
+            if (IntersectsTriangle(mesh, t, ray, dist) && dist < nearest)
+            {
+                nearest = dist;
+                nearestTriangle = static_cast<uint32_t>(t);
+            }
+        }
+
+        return nearestTriangle;
+    }
+
+
+    // The packets use their own ray-triangle test, which rounds differently from TriangleTests.
+    // Both lose digits for small triangles far from the ray's origin, where they can disagree in
+    // the fourth significant digit of the distance.
+    bool IsNearDistance(float actual, float expected) noexcept
+    {
+        return std::fabs(actual - expected) <= 1e-3f * std::max(1.f, expected);
+    }
+
+
+    // Whether triangle, which the tree reported at dist, is hit there, and is no further than the
+    // nearest hit: it need not be the same triangle where several are hit at the same distance.
+    bool IsNearestTriangle(TestMesh const& mesh, Ray const& ray, uint32_t triangle, float dist, float nearest, bool exact) noexcept
+    {
+        float triangleDist;
+
+        if (triangle >= mesh.TriangleCount() || !IntersectsTriangle(mesh, triangle, ray, triangleDist))
+            return false;
+
+        return exact ? (triangleDist == dist && dist == nearest) : (IsNearDistance(triangleDist, dist) && IsNearDistance(dist, nearest));
+    }
+
+
+    // Where a ray passes within this of a triangle's edge, in barycentric terms, rounding decides
+    // whether a test in floats hits it.
+    constexpr double EdgeMargin = 1e-4;
+
+    enum class HitKind
+    {
+        Miss,
+        Edge,
+        Hit,
+    };
+
+    // The ray against the triangle in double precision.
+    HitKind ClassifyHit(TestMesh const& mesh, size_t triangle, Ray const& ray, double& dist) noexcept
+    {
+        XMFLOAT3 corners[3];
+
+        for (size_t k = 0; k < 3; k++)
+        {
+            XMStoreFloat3(&corners[k], mesh.Position(triangle, k));
+        }
+
+        auto subtract = [](XMFLOAT3 const& a, XMFLOAT3 const& b, double* result) noexcept
+            {
+                result[0] = double(a.x) - b.x;
+                result[1] = double(a.y) - b.y;
+                result[2] = double(a.z) - b.z;
+            };
+
+        auto cross = [](double const* a, double const* b, double* result) noexcept
+            {
+                result[0] = a[1] * b[2] - a[2] * b[1];
+                result[1] = a[2] * b[0] - a[0] * b[2];
+                result[2] = a[0] * b[1] - a[1] * b[0];
+            };
+
+        auto dot = [](double const* a, double const* b) noexcept { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; };
+
+        const double direction[3] = { ray.direction.x, ray.direction.y, ray.direction.z };
+
+        double e1[3], e2[3], s[3], p[3], q[3];
+        subtract(corners[1], corners[0], e1);
+        subtract(corners[2], corners[0], e2);
+        subtract(ray.position, corners[0], s);
+
+        cross(direction, e2, p);
+        const double det = dot(e1, p);
+
+        dist = 0;
+
+        if (det == 0)
+            return HitKind::Miss;
+
+        cross(s, e1, q);
+
+        const double u = dot(s, p) / det;
+        const double v = dot(direction, q) / det;
+        const double edge = std::min(u, std::min(v, 1.0 - u - v));
+
+        dist = dot(e2, q) / det;
+
+        if (edge < -EdgeMargin || dist < 0)
+            return HitKind::Miss;
+
+        return (edge > EdgeMargin) ? HitKind::Hit : HitKind::Edge;
+    }
+
+
+    // Whether a packet's result differs from TriangleTests only where the ray passes so close to an
+    // edge that either could be right: the triangle it hit, if any, is hit or nearly hit there, and
+    // nothing nearer is clearly hit.
+    bool IsEdgeCase(TestMesh const& mesh, Ray const& ray, uint32_t triangle, float dist) noexcept
+    {
+        for (size_t t = 0; t < mesh.TriangleCount(); t++)
+        {
+            double triangleDist;
+            const HitKind kind = ClassifyHit(mesh, t, ray, triangleDist);
+
+            if (t == triangle)
+            {
+                if (kind == HitKind::Miss || !IsNearDistance(dist, float(triangleDist)))
+                    return false;
+            }
+            else if (kind == HitKind::Hit && (triangle == TriangleBVH::NoHit || (triangleDist < dist && !IsNearDistance(dist, float(triangleDist)))))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+
+    // Each ray through the tree, singly and as packets, must find what testing every triangle finds.
+    bool CheckAgainstBruteForce(TriangleBVH const& bvh, TestMesh const& mesh, std::vector<Ray> const& rays, char const* description)
+    {
+        const size_t count = rays.size();
+
+        std::vector<float> packetDist(count, -1.f);
+        std::vector<uint32_t> packetTriangles(count, 0);
+
+        const size_t packetHits = bvh.Intersects(rays.data(), count, packetDist.data(), packetTriangles.data());
+
+        for (size_t i = 0; i < count; i++)
+        {
+            float nearest;
+            const uint32_t expected = BruteForceIntersects(mesh, rays[i], nearest);
+            const bool expectHit = (expected != TriangleBVH::NoHit);
+
+            // The single ray path uses TriangleTests itself, so finds exactly the same distance.
+            float dist = -1.f;
+            uint32_t triangle = 0;
+            const bool hit = bvh.Intersects(rays[i], dist, &triangle);
+
+            if (hit != expectHit
+                || (hit && !IsNearestTriangle(mesh, rays[i], triangle, dist, nearest, true))
+                || (!hit && (dist != 0 || triangle != TriangleBVH::NoHit)))
+            {
+                printf("ERROR: %s, ray %zu of %zu: hit triangle %u at %g, expected %u at %g\n",
+                    description, i, count, hit ? triangle : TriangleBVH::NoHit, dist, expected, expectHit ? nearest : 0.f);
+                return false;
+            }
+
+            const bool packetHit = (packetTriangles[i] != TriangleBVH::NoHit);
+
+            const bool packetMatches = (packetHit == expectHit)
+                && (!packetHit || IsNearestTriangle(mesh, rays[i], packetTriangles[i], packetDist[i], nearest, false));
+
+            if ((!packetMatches && !IsEdgeCase(mesh, rays[i], packetTriangles[i], packetDist[i]))
+                || (!packetHit && packetDist[i] != 0))
+            {
+                printf("ERROR: %s, ray %zu of %zu in a packet: hit triangle %u at %g, expected %u at %g\n",
+                    description, i, count, packetTriangles[i], packetDist[i], expected, expectHit ? nearest : 0.f);
+                return false;
+            }
+        }
+
+        size_t reported = 0;
+
+        for (const uint32_t triangle : packetTriangles)
+        {
+            reported += (triangle != TriangleBVH::NoHit) ? 1 : 0;
+        }
+
+        if (packetHits != reported)
+        {
+            printf("ERROR: %s, %zu rays: packets returned %zu hits, but reported %zu\n", description, count, packetHits, reported);
+            return false;
+        }
+
+        return true;
+    }
+
+
+    bool CheckBounds(TriangleBVH const& bvh, TestMesh const& mesh, char const* description)
+    {
+        XMVECTOR min = g_XMFltMax;
+        XMVECTOR max = XMVectorNegate(g_XMFltMax);
+
+        for (const uint32_t index : mesh.indices)
+        {
+            const XMVECTOR p = XMLoadFloat3(&mesh.vertices[index].position);
+            min = XMVectorMin(min, p);
+            max = XMVectorMax(max, p);
+        }
+
+        // An empty tree has the default box.
+        BoundingBox expected;
+
+        if (!mesh.indices.empty())
+        {
+            BoundingBox::CreateFromPoints(expected, min, max);
+        }
+
+        const BoundingBox bounds = bvh.GetBounds();
+
+        if (bvh.GetTriangleCount() != mesh.TriangleCount()
+            || !XMVector3NearEqual(XMLoadFloat3(&bounds.Center), XMLoadFloat3(&expected.Center), XMVectorReplicate(1e-5f))
+            || !XMVector3NearEqual(XMLoadFloat3(&bounds.Extents), XMLoadFloat3(&expected.Extents), XMVectorReplicate(1e-5f)))
+        {
+            printf("ERROR: %s: %zu triangles, bounds centered (%g, %g, %g), expected %zu triangles centered (%g, %g, %g)\n", description,
+                bvh.GetTriangleCount(), bounds.Center.x, bounds.Center.y, bounds.Center.z,
+                mesh.TriangleCount(), expected.Center.x, expected.Center.y, expected.Center.z);
+            return false;
+        }
+
+        return true;
+    }
+
+
+    std::vector<uint16_t> NarrowIndices(std::vector<uint32_t> const& indices)
+    {
+        std::vector<uint16_t> result(indices.size());
+
+        for (size_t i = 0; i < indices.size(); i++)
+        {
+            result[i] = static_cast<uint16_t>(indices[i]);
+        }
+
+        return result;
+    }
+}
+
+
+TEST_CASE(TriangleBVHMatchesBruteForce)
+{
+    std::mt19937 rng(22);
+
+    // Ray counts leave every tail length for packets of 4, 8 and 16.
+    const size_t rayCounts[] = { 0, 1, 3, 7, 13, 16, 17, 31, 1000 };
+
+    // The largest meshes are split into subtrees of at least 1024 triangles, built in parallel.
+    for (const size_t triangleCount : { size_t(0), size_t(1), size_t(2), size_t(9), size_t(100), size_t(3000), size_t(40000) })
+    {
+        const auto mesh = MakeSoup(rng, triangleCount);
+
+        TriangleBVH bvh;
+        bvh.Build(mesh.vertices, mesh.indices);
+
+        char description[64];
+        snprintf(description, sizeof(description), "%zu triangle soup", triangleCount);
+
+        if (!CheckBounds(bvh, mesh, description))
+            return false;
+
+        for (const size_t rayCount : rayCounts)
+        {
+            if (!CheckAgainstBruteForce(bvh, mesh, MakeRays(rng, mesh, rayCount), description))
+                return false;
+        }
+    }
+
+    // Shared edges and vertices, with 16-bit indices.
+    for (const size_t size : { size_t(1), size_t(10), size_t(120) })
+    {
+        const auto mesh = MakeGrid(rng, size);
+        const auto indices = NarrowIndices(mesh.indices);
+
+        TriangleBVH bvh;
+        bvh.Build(mesh.vertices, indices);
+
+        char description[64];
+        snprintf(description, sizeof(description), "%zu x %zu grid", size, size);
+
+        if (!CheckBounds(bvh, mesh, description))
+            return false;
+
+        if (!CheckAgainstBruteForce(bvh, mesh, MakeRays(rng, mesh, 1000), description))
+            return false;
+    }
+
+    return true;
+}
+
+
+TEST_CASE(TriangleBVHRefitMatchesBruteForce)
+{
+    std::mt19937 rng(23);
+
+    for (const bool grid : { false, true })
+    {
+        auto mesh = grid ? MakeGrid(rng, 100) : MakeSoup(rng, 20000);
+
+        TriangleBVH bvh;
+        bvh.Build(mesh.vertices, mesh.indices);
+
+        std::uniform_real_distribution<float> jitter(-0.3f, 0.3f);
+
+        // Twice: a gentle deformation, then one that moves some vertices a long way, which the
+        // tree's bounds must still take in even though its shape no longer fits the mesh.
+        for (const float scale : { 1.f, 10.f })
+        {
+            for (size_t i = 0; i < mesh.vertices.size(); i++)
+            {
+                auto& p = mesh.vertices[i].position;
+
+                p.y += std::sin(p.x * 0.3f) * scale * 0.2f + jitter(rng);
+
+                if (i % 97 == 0)
+                {
+                    p.x += jitter(rng) * scale * 10.f;
+                }
+            }
+
+            bvh.Refit(mesh.vertices);
+
+            char description[64];
+            snprintf(description, sizeof(description), "%s refit, scale %g", grid ? "grid" : "soup", scale);
+
+            if (!CheckBounds(bvh, mesh, description))
+                return false;
+
+            if (!CheckAgainstBruteForce(bvh, mesh, MakeRays(rng, mesh, 1000), description))
+                return false;
+        }
+
+        // Only the vertices the tree was built with.
+        mesh.vertices.push_back(mesh.vertices.back());
+
+        bool threw = false;
+
+        try
+        {
+            bvh.Refit(mesh.vertices);
+        }
+        catch (std::invalid_argument const&)
+        {
+            threw = true;
+        }
+
+        CHECK(threw);
+    }
+
+    return true;
+}
+
+
+TEST_CASE(TriangleBVHBuildRejectsBadMeshes)
+{
+    std::vector<TestVertex> vertices(4);
+
+    auto throws = [&](auto&& build)
+        {
+            try
+            {
+                TriangleBVH bvh;
+                build(bvh);
+            }
+            catch (std::logic_error const&)
+            {
+                return true;
+            }
+
+            return false;
+        };
+
+    CHECK(throws([&](TriangleBVH& bvh) { bvh.Build(vertices, std::vector<uint16_t>{ 0, 1, 4 }); }));
+    CHECK(throws([&](TriangleBVH& bvh) { bvh.Build(vertices, std::vector<uint32_t>{ 0, 1, 2, 3 }); }));
+    CHECK(throws([&](TriangleBVH& bvh) { bvh.Build(vertices.data(), vertices.size(), 8, std::vector<uint32_t>{ 0, 1, 2 }.data(), 3); }));
+
+    // An empty mesh is allowed, and misses everything.
+    TriangleBVH bvh;
+    bvh.Build(vertices, std::vector<uint32_t>());
+
+    const Ray ray(Vector3::Zero, Vector3::UnitZ);
+
+    float dist = -1.f;
+    uint32_t triangle = 0;
+    CHECK(!bvh.Intersects(ray, dist, &triangle));
+    CHECK(dist == 0 && triangle == TriangleBVH::NoHit);
+    CHECK(bvh.Intersects(&ray, 1, &dist, &triangle) == 0);
+    CHECK(bvh.GetTriangleCount() == 0);
+
+    return true;
+}
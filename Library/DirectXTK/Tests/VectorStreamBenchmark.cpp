@@ -0,0 +1,98 @@
+//--------------------------------------------------------------------------------------
+// File: VectorStreamBenchmark.cpp
+//
+// Compares transforming points held as separate component arrays, with each instruction
+// set's kernels, against the Vector3::Transform overload for arrays of Vector3.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHarness.h"
+#include "SimdTestLevels.h"
+
+#include "SimpleMath.h"
+#include "VectorStream.h"
+
+#include <random>
+
+using namespace DirectX;
+using namespace DirectX::SimpleMath;
+using namespace DirectX::Tests;
+
+
+BENCHMARK(VectorStreamTransform)
+{
+    const Matrix m = Matrix::CreateLookAt(Vector3(1, 2, 3), Vector3::Zero, Vector3::Up)
+        * Matrix::CreatePerspectiveFieldOfView(1.f, 1.5f, 0.1f, 100.f);
+
+    const auto levels = GetTestedSimdLevels();
+
+    printf("%10s %14s %14s", "points", "AoS", "streams");
+
+    for (const SimdLevel level : levels)
+    {
+        printf(" %14s", GetSimdLevelName(level));
+    }
+
+    printf("   (ns per point)\n");
+
+    for (const size_t count : { size_t(1) << 12, size_t(1) << 16, size_t(1) << 20, size_t(1) << 22 })
+    {
+        std::mt19937 rng(static_cast<uint32_t>(count));
+        std::uniform_real_distribution<float> coordinate(-10.f, 10.f);
+
+        std::vector<Vector3> points(count);
+        std::vector<Vector3> transformed(count);
+
+        std::vector<float> x(count), y(count), z(count);
+        std::vector<float> outX(count), outY(count), outZ(count);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            points[i] = Vector3(coordinate(rng), coordinate(rng), coordinate(rng));
+
+            x[i] = points[i].x;
+            y[i] = points[i].y;
+            z[i] = points[i].z;
+        }
+
+        // About 16M points per measurement, however long the arrays are.
+        const size_t iterations = std::max<size_t>(1, (size_t(1) << 24) / count);
+
+        const double aos = MeasureNanoseconds(iterations, [&]()
+            {
+                Vector3::Transform(points.data(), count, m, transformed.data());
+            });
+
+        const double streams = MeasureNanoseconds(iterations, [&]()
+            {
+                Vector3::Transform(ConstVector3Stream(x.data(), y.data(), z.data()), count, m, Vector3Stream(outX.data(), outY.data(), outZ.data()));
+            });
+
+        KeepResult(static_cast<uint64_t>(transformed[count / 2].x + outX[count / 2]));
+
+        printf("%10zu %14.3f %14.3f", count, aos / double(count), streams / double(count));
+
+        for (const SimdLevel level : levels)
+        {
+            const auto kernel = VectorStream::GetStreamKernels(level).transformCoord3;
+
+            XMFLOAT4X4 matrix;
+            XMStoreFloat4x4(&matrix, m);
+
+            const double kernelTime = MeasureNanoseconds(iterations, [&]()
+                {
+                    kernel({ { x.data(), y.data(), z.data() } }, count, matrix, { { outX.data(), outY.data(), outZ.data() } });
+                });
+
+            printf(" %14.3f", kernelTime / double(count));
+        }
+
+        printf("\n");
+    }
+
+    return true;
+}
@@ -0,0 +1,401 @@
+//--------------------------------------------------------------------------------------
+// File: VectorStreamTest.cpp
+//
+// Checks the structure-of-arrays stream kernels for every instruction set this CPU runs
+// against the DirectXMath functions for single vectors. The AVX2 and AVX-512 kernels fuse
+// each multiply and add, so results are compared within the rounding error of the sums
+// rather than exactly.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHarness.h"
+#include "SimdTestLevels.h"
+
+#include "SimpleMath.h"
+#include "VectorStream.h"
+
+#include <cmath>
+#include <random>
+
+using namespace DirectX;
+using namespace DirectX::SimpleMath;
+using namespace DirectX::Tests;
+using namespace DirectX::VectorStream;
+
+namespace
+{
+    // Four component arrays, whatever the dimension being tested.
+    struct TestStream
+    {
+        std::vector<float> c[4];
+
+        explicit TestStream(size_t count)
+        {
+            for (auto& component : c)
+            {
+                component.resize(count);
+            }
+        }
+
+        StreamInput Input() const noexcept { return { { c[0].data(), c[1].data(), c[2].data(), c[3].data() } }; }
+        StreamOutput Output() noexcept { return { { c[0].data(), c[1].data(), c[2].data(), c[3].data() } }; }
+
+        XMVECTOR Get(size_t i) const noexcept { return XMVectorSet(c[0][i], c[1][i], c[2][i], c[3][i]); }
+    };
+
+
+    // Components in [-range, range], with every seventh vector zero.
+    TestStream MakeStream(std::mt19937& rng, size_t count, float range)
+    {
+        std::uniform_real_distribution<float> component(-range, range);
+
+        TestStream stream(count);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            for (auto& c : stream.c)
+            {
+                c[i] = (i % 7 == 3) ? 0.f : component(rng);
+            }
+        }
+
+        return stream;
+    }
+
+
+    // A random matrix whose w column keeps w within [0.4, 1.6] for points in [-10, 10].
+    XMFLOAT4X4 MakeMatrix(std::mt19937& rng)
+    {
+        std::uniform_real_distribution<float> element(-2.f, 2.f);
+        std::uniform_real_distribution<float> projection(-0.02f, 0.02f);
+
+        XMFLOAT4X4 m;
+
+        for (size_t r = 0; r < 4; r++)
+        {
+            for (size_t c = 0; c < 3; c++)
+            {
+                m.m[r][c] = element(rng);
+            }
+
+            m.m[r][3] = (r < 3) ? projection(rng) : 1.f;
+        }
+
+        return m;
+    }
+
+
+    // Whether two ways of summing terms whose magnitudes add up to magnitude agree, allowing
+    // for a few roundings in each, fused or not.
+    bool IsNear(float actual, float expected, float magnitude) noexcept
+    {
+        return std::fabs(actual - expected) <= 8.f * FLT_EPSILON * magnitude;
+    }
+
+
+    // The magnitude of the terms summed for component c of v transformed by m, with the sum for w
+    // carried through the divide, where result is the component after the divide.
+    template<size_t Dim>
+    float TransformCoordMagnitude(XMFLOAT4X4 const& m, float const* v, size_t c, float result) noexcept
+    {
+        float w = m.m[3][3];
+        float wMagnitude = std::fabs(m.m[3][3]);
+        float magnitude = std::fabs(m.m[3][c]);
+
+        for (size_t d = 0; d < Dim; d++)
+        {
+            w += v[d] * m.m[d][3];
+            wMagnitude += std::fabs(v[d] * m.m[d][3]);
+            magnitude += std::fabs(v[d] * m.m[d][c]);
+        }
+
+        return (magnitude + std::fabs(result) * wMagnitude) / std::fabs(w);
+    }
+
+
+    // Counts that leave every tail length for 16 lanes, and a long stream.
+    const size_t TestCounts[] = { 0, 1, 2, 3, 4, 5, 7, 8, 9, 12, 15, 16, 17, 20, 23, 24, 31, 32, 33, 47, 48, 63, 1003 };
+
+
+    template<size_t Dim>
+    bool CheckTransformCoord(SimdLevel level, std::mt19937& rng)
+    {
+        const auto kernel = (Dim == 2) ? GetStreamKernels(level).transformCoord2 : GetStreamKernels(level).transformCoord3;
+
+        for (const size_t count : TestCounts)
+        {
+            const auto m = MakeMatrix(rng);
+            const XMMATRIX M = XMLoadFloat4x4(&m);
+
+            const auto in = MakeStream(rng, count, 10.f);
+
+            TestStream out(count);
+            kernel(in.Input(), count, m, out.Output());
+
+            // Written over the input, which gives the same results.
+            auto inPlace = in;
+            kernel(inPlace.Input(), count, m, inPlace.Output());
+
+            for (size_t i = 0; i < count; i++)
+            {
+                const XMVECTOR v = in.Get(i);
+
+                XMFLOAT4 expected;
+                XMStoreFloat4(&expected, (Dim == 2) ? XMVector2TransformCoord(v, M) : XMVector3TransformCoord(v, M));
+
+                const float* expectedComponents = &expected.x;
+                const float components[3] = { in.c[0][i], in.c[1][i], in.c[2][i] };
+
+                for (size_t c = 0; c < Dim; c++)
+                {
+                    const float magnitude = TransformCoordMagnitude<Dim>(m, components, c, expectedComponents[c]);
+
+                    if (!IsNear(out.c[c][i], expectedComponents[c], magnitude) || inPlace.c[c][i] != out.c[c][i])
+                    {
+                        printf("ERROR: %s TransformCoord%zu, count %zu, vector %zu component %zu: %.9g, expected %.9g (in place %.9g)\n",
+                            GetSimdLevelName(level), Dim, count, i, c, out.c[c][i], expectedComponents[c], inPlace.c[c][i]);
+                        return false;
+                    }
+                }
+            }
+        }
+
+        return true;
+    }
+
+
+    template<size_t Dim>
+    bool CheckTransformNormal(SimdLevel level, std::mt19937& rng)
+    {
+        const auto kernel = (Dim == 2) ? GetStreamKernels(level).transformNormal2 : GetStreamKernels(level).transformNormal3;
+
+        for (const size_t count : TestCounts)
+        {
+            const auto m = MakeMatrix(rng);
+            const XMMATRIX M = XMLoadFloat4x4(&m);
+
+            const auto in = MakeStream(rng, count, 10.f);
+
+            TestStream out(count);
+            kernel(in.Input(), count, m, out.Output());
+
+            for (size_t i = 0; i < count; i++)
+            {
+                const XMVECTOR v = in.Get(i);
+
+                XMFLOAT4 expected;
+                XMStoreFloat4(&expected, (Dim == 2) ? XMVector2TransformNormal(v, M) : XMVector3TransformNormal(v, M));
+
+                const float* expectedComponents = &expected.x;
+
+                for (size_t c = 0; c < Dim; c++)
+                {
+                    float magnitude = 0;
+
+                    for (size_t d = 0; d < Dim; d++)
+                    {
+                        magnitude += std::fabs(in.c[d][i] * m.m[d][c]);
+                    }
+
+                    if (!IsNear(out.c[c][i], expectedComponents[c], magnitude))
+                    {
+                        printf("ERROR: %s TransformNormal%zu, count %zu, vector %zu component %zu: %.9g, expected %.9g\n",
+                            GetSimdLevelName(level), Dim, count, i, c, out.c[c][i], expectedComponents[c]);
+                        return false;
+                    }
+                }
+            }
+        }
+
+        return true;
+    }
+
+
+    bool CheckTransform4(SimdLevel level, std::mt19937& rng)
+    {
+        for (const size_t count : TestCounts)
+        {
+            const auto m = MakeMatrix(rng);
+            const XMMATRIX M = XMLoadFloat4x4(&m);
+
+            const auto in = MakeStream(rng, count, 10.f);
+
+            TestStream out(count);
+            GetStreamKernels(level).transform4(in.Input(), count, m, out.Output());
+
+            for (size_t i = 0; i < count; i++)
+            {
+                XMFLOAT4 expected;
+                XMStoreFloat4(&expected, XMVector4Transform(in.Get(i), M));
+
+                const float* expectedComponents = &expected.x;
+
+                for (size_t c = 0; c < 4; c++)
+                {
+                    float magnitude = 0;
+
+                    for (size_t d = 0; d < 4; d++)
+                    {
+                        magnitude += std::fabs(in.c[d][i] * m.m[d][c]);
+                    }
+
+                    if (!IsNear(out.c[c][i], expectedComponents[c], magnitude))
+                    {
+                        printf("ERROR: %s Transform4, count %zu, vector %zu component %zu: %.9g, expected %.9g\n",
+                            GetSimdLevelName(level), count, i, c, out.c[c][i], expectedComponents[c]);
+                        return false;
+                    }
+                }
+            }
+        }
+
+        return true;
+    }
+
+
+    template<size_t Dim>
+    bool CheckNormalizeAndDot(SimdLevel level, std::mt19937& rng)
+    {
+        auto const& kernels = GetStreamKernels(level);
+
+        const auto normalize = (Dim == 2) ? kernels.normalize2 : (Dim == 3) ? kernels.normalize3 : kernels.normalize4;
+        const auto dot = (Dim == 2) ? kernels.dot2 : (Dim == 3) ? kernels.dot3 : kernels.dot4;
+
+        for (const size_t count : TestCounts)
+        {
+            const auto a = MakeStream(rng, count, 100.f);
+            const auto b = MakeStream(rng, count, 100.f);
+
+            TestStream normalized(count);
+            normalize(a.Input(), count, normalized.Output());
+
+            std::vector<float> dots(count);
+            dot(a.Input(), b.Input(), count, dots.data());
+
+            for (size_t i = 0; i < count; i++)
+            {
+                const XMVECTOR v = a.Get(i);
+
+                XMFLOAT4 expected;
+                XMStoreFloat4(&expected, (Dim == 2) ? XMVector2Normalize(v) : (Dim == 3) ? XMVector3Normalize(v) : XMVector4Normalize(v));
+
+                const float* expectedComponents = &expected.x;
+
+                // The components of a unit vector are at most one.
+                for (size_t c = 0; c < Dim; c++)
+                {
+                    if (!IsNear(normalized.c[c][i], expectedComponents[c], 1.f))
+                    {
+                        printf("ERROR: %s Normalize%zu, count %zu, vector %zu component %zu: %.9g, expected %.9g\n",
+                            GetSimdLevelName(level), Dim, count, i, c, normalized.c[c][i], expectedComponents[c]);
+                        return false;
+                    }
+                }
+
+                const XMVECTOR u = b.Get(i);
+                const float expectedDot = XMVectorGetX((Dim == 2) ? XMVector2Dot(v, u) : (Dim == 3) ? XMVector3Dot(v, u) : XMVector4Dot(v, u));
+
+                float magnitude = 0;
+
+                for (size_t d = 0; d < Dim; d++)
+                {
+                    magnitude += std::fabs(a.c[d][i] * b.c[d][i]);
+                }
+
+                if (!IsNear(dots[i], expectedDot, magnitude))
+                {
+                    printf("ERROR: %s Dot%zu, count %zu, vector %zu: %.9g, expected %.9g\n",
+                        GetSimdLevelName(level), Dim, count, i, dots[i], expectedDot);
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+}
+
+
+TEST_CASE(VectorStreamTransformWithinRounding)
+{
+    std::mt19937 rng(40);
+
+    for (const SimdLevel level : GetTestedSimdLevels())
+    {
+        if (!CheckTransformCoord<2>(level, rng)
+            || !CheckTransformCoord<3>(level, rng)
+            || !CheckTransformNormal<2>(level, rng)
+            || !CheckTransformNormal<3>(level, rng)
+            || !CheckTransform4(level, rng))
+            return false;
+    }
+
+    return true;
+}
+
+
+TEST_CASE(VectorStreamNormalizeAndDotWithinRounding)
+{
+    std::mt19937 rng(41);
+
+    for (const SimdLevel level : GetTestedSimdLevels())
+    {
+        if (!CheckNormalizeAndDot<2>(level, rng)
+            || !CheckNormalizeAndDot<3>(level, rng)
+            || !CheckNormalizeAndDot<4>(level, rng))
+            return false;
+    }
+
+    return true;
+}
+
+
+TEST_CASE(SimpleMathStreamsMatchArrayOverloads)
+{
+    // The stream functions against the AoS array overloads, through whichever kernels the
+    // library picked for this CPU.
+    std::mt19937 rng(42);
+
+    constexpr size_t Count = 1003;
+
+    const auto m = MakeMatrix(rng);
+    const Matrix M(m);
+
+    const auto in = MakeStream(rng, Count, 10.f);
+
+    std::vector<Vector3> points(Count);
+
+    for (size_t i = 0; i < Count; i++)
+    {
+        points[i] = Vector3(in.c[0][i], in.c[1][i], in.c[2][i]);
+    }
+
+    std::vector<Vector3> expected(Count);
+    Vector3::Transform(points.data(), Count, M, expected.data());
+
+    TestStream out(Count);
+    Vector3::Transform(ConstVector3Stream(in.c[0].data(), in.c[1].data(), in.c[2].data()), Count, M,
+        Vector3Stream(out.c[0].data(), out.c[1].data(), out.c[2].data()));
+
+    for (size_t i = 0; i < Count; i++)
+    {
+        const float* point = &points[i].x;
+        const float* expectedPoint = &expected[i].x;
+
+        for (size_t c = 0; c < 3; c++)
+        {
+            if (IsNear(out.c[c][i], expectedPoint[c], TransformCoordMagnitude<3>(m, point, c, expectedPoint[c])))
+                continue;
+
+            printf("ERROR: %s: point %zu transforms to (%.9g, %.9g, %.9g), expected (%.9g, %.9g, %.9g)\n", GetSimdLevelName(GetSimdLevel()),
+                i, out.c[0][i], out.c[1][i], out.c[2][i], expected[i].x, expected[i].y, expected[i].z);
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,107 @@
+//--------------------------------------------------------------------------------------
+// File: VertexRingTest.cpp
+//
+// Checks that SpriteBatch's vertex ring grows until it rarely wraps, that the bufferWraps
+// statistic counts the wraps, and that recreating the buffer never changes what is drawn.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "DeviceTest.h"
+#include "SpriteTestData.h"
+
+#include "AdaptiveRing.h"
+
+using namespace DirectX;
+using namespace DirectX::Tests;
+using Microsoft::WRL::ComPtr;
+
+
+TEST_CASE(SpriteBatchVertexRingGrows)
+{
+    // A new device, so the per-context ring starts at its minimum size.
+    TestDevice test;
+
+    if (!CreateTestDevice(test))
+        return false;
+
+    auto context = test.context.Get();
+
+    SetTestViewport(context, 1024, 1024);
+
+    auto texture = CreateTestTexture(test.device.Get(), 64, 32, 1);
+
+    ID3D11ShaderResourceView* const textureView = texture.Get();
+
+    // Under half the initial 2048 sprite ring, so at first it wraps every other frame. Each growth
+    // step halves that rate, until the ring wraps at most once every eight frames.
+    constexpr size_t SpritesPerFrame = 1000;
+    constexpr size_t Window = AdaptiveRingSizer::WindowSize;
+    constexpr size_t Frames = 5 * Window;
+
+    VertexCapture capture(test.device.Get(), SpritesPerFrame * 6);
+
+    SpriteBatch batch(context);
+
+    std::vector<VertexPositionColorTexture> firstFrame;
+    std::vector<size_t> wraps(Frames);
+
+    for (size_t frame = 0; frame < Frames; frame++)
+    {
+        batch.Begin(SpriteSortMode_Deferred, nullptr, nullptr, nullptr, nullptr, capture.Begin(context));
+        DrawTestSprites(batch, &textureView, 1, SpritesPerFrame, 21);
+        batch.End();
+
+        const auto vertices = capture.End(context);
+
+        wraps[frame] = batch.GetStatistics().bufferWraps;
+
+        // Whatever the ring position or size, every frame draws the same vertices.
+        if (frame == 0)
+        {
+            firstFrame = vertices;
+            CHECK(firstFrame.size() == SpritesPerFrame * 6);
+        }
+        else
+        {
+            char description[32];
+            snprintf(description, sizeof(description), "frame %zu", frame);
+
+            if (!CompareVertices(firstFrame, vertices, description))
+                return false;
+        }
+
+        // One frame is smaller than the ring, so it can wrap at most once.
+        CHECK(wraps[frame] <= 1);
+    }
+
+    auto windowWraps = [&](size_t window)
+    {
+        size_t total = 0;
+
+        for (size_t frame = window * Window; frame < (window + 1) * Window; frame++)
+        {
+            total += wraps[frame];
+        }
+
+        return total;
+    };
+
+    printf("  wraps per %zu frames:", Window);
+
+    for (size_t window = 0; window < Frames / Window; window++)
+    {
+        printf(" %zu", windowWraps(window));
+    }
+
+    printf("\n");
+
+    // The first window wraps often enough to trigger growth, and the ring settles below that rate.
+    CHECK(windowWraps(0) * 8 > Window);
+    CHECK(windowWraps(Frames / Window - 1) * 8 <= Window);
+
+    return true;
+}
@@ -0,0 +1,205 @@
+//--------------------------------------------------------------------------------------
+// File: ViewportProjectBenchmark.cpp
+//
+// Times the Viewport array and stream Project and Unproject against calling the single
+// versions for each point, and ProjectBounds and ProjectBoundsParallel against projecting
+// each box's eight corners.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHarness.h"
+
+#include "SimpleMath.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+using namespace DirectX::SimpleMath;
+using namespace DirectX::Tests;
+
+namespace
+{
+    const Viewport BenchmarkViewport(0.f, 0.f, 1920.f, 1080.f);
+
+    const Matrix BenchmarkView = XMMatrixLookAtLH(XMVectorSet(0.f, 10.f, -30.f, 0.f), g_XMZero, g_XMIdentityR1);
+    const Matrix BenchmarkProj = XMMatrixPerspectiveFovLH(XM_PIDIV4, 1920.f / 1080.f, 0.1f, 1000.f);
+
+    // About 16M points or boxes per measurement, however long the arrays are.
+    size_t Iterations(size_t count) noexcept
+    {
+        return std::max<size_t>(1, (size_t(1) << 24) / count);
+    }
+}
+
+
+BENCHMARK(ViewportProjectPoints)
+{
+    auto const& vp = BenchmarkViewport;
+
+    printf("%-18s %14s %14s %14s   (ns per point)\n", "points", "one at a time", "array", "stream");
+
+    for (const size_t count : { size_t(1) << 12, size_t(1) << 20 })
+    {
+        std::mt19937 rng(static_cast<uint32_t>(count));
+        std::uniform_real_distribution<float> coordinate(-20.f, 20.f);
+
+        std::vector<Vector3> points(count);
+        std::vector<float> x(count), y(count), z(count);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            points[i] = Vector3(coordinate(rng), coordinate(rng), coordinate(rng));
+
+            x[i] = points[i].x;
+            y[i] = points[i].y;
+            z[i] = points[i].z;
+        }
+
+        std::vector<Vector3> results(count);
+        std::vector<float> rx(count), ry(count), rz(count);
+
+        const ConstVector3Stream input(x.data(), y.data(), z.data());
+        const Vector3Stream output(rx.data(), ry.data(), rz.data());
+
+        const size_t iterations = Iterations(count);
+
+        const double singleProject = MeasureNanoseconds(iterations, [&]()
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    results[i] = vp.Project(points[i], BenchmarkProj, BenchmarkView, Matrix::Identity);
+                }
+            });
+
+        const double arrayProject = MeasureNanoseconds(iterations, [&]()
+            {
+                vp.Project(points.data(), count, BenchmarkProj, BenchmarkView, Matrix::Identity, results.data());
+            });
+
+        const double streamProject = MeasureNanoseconds(iterations, [&]()
+            {
+                vp.Project(input, count, BenchmarkProj, BenchmarkView, Matrix::Identity, output);
+            });
+
+        KeepResult(static_cast<uint64_t>(results[count / 2].x > rx[count / 2]));
+
+        char label[32];
+        snprintf(label, sizeof(label), "Project %zu", count);
+
+        printf("%-18s %14.3f %14.3f %14.3f\n", label,
+            singleProject / double(count), arrayProject / double(count), streamProject / double(count));
+
+        // Unproject the projected points, as picking would.
+        vp.Project(points.data(), count, BenchmarkProj, BenchmarkView, Matrix::Identity, points.data());
+        vp.Project(input, count, BenchmarkProj, BenchmarkView, Matrix::Identity, { x.data(), y.data(), z.data() });
+
+        const double singleUnproject = MeasureNanoseconds(iterations, [&]()
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    results[i] = vp.Unproject(points[i], BenchmarkProj, BenchmarkView, Matrix::Identity);
+                }
+            });
+
+        const double arrayUnproject = MeasureNanoseconds(iterations, [&]()
+            {
+                vp.Unproject(points.data(), count, BenchmarkProj, BenchmarkView, Matrix::Identity, results.data());
+            });
+
+        const double streamUnproject = MeasureNanoseconds(iterations, [&]()
+            {
+                vp.Unproject(input, count, BenchmarkProj, BenchmarkView, Matrix::Identity, output);
+            });
+
+        KeepResult(static_cast<uint64_t>(results[count / 2].x > rx[count / 2]));
+
+        snprintf(label, sizeof(label), "Unproject %zu", count);
+
+        printf("%-18s %14.3f %14.3f %14.3f\n", label,
+            singleUnproject / double(count), arrayUnproject / double(count), streamUnproject / double(count));
+    }
+
+    return true;
+}
+
+
+BENCHMARK(ViewportProjectBoundsBoxes)
+{
+    auto const& vp = BenchmarkViewport;
+
+    printf("%-18s %14s %14s %14s   (ns per box)\n", "boxes", "corners", "ProjectBounds", "Parallel");
+
+    for (const size_t count : { size_t(1) << 12, size_t(1) << 20 })
+    {
+        // Spread around the camera, so some are off screen, behind it, or across the camera plane.
+        std::mt19937 rng(static_cast<uint32_t>(count) + 1);
+        std::uniform_real_distribution<float> position(-60.f, 60.f);
+        std::uniform_real_distribution<float> extent(0.1f, 3.f);
+
+        std::vector<BoundingBox> boxes(count);
+        for (auto& box : boxes)
+        {
+            box = BoundingBox(XMFLOAT3(position(rng), position(rng), position(rng)), XMFLOAT3(extent(rng), extent(rng), extent(rng)));
+        }
+
+        std::vector<XMFLOAT4> cornerBounds(count);
+        std::vector<Rectangle> rects(count);
+
+        const size_t iterations = Iterations(count);
+
+        // The screen bounds of the projected corners, which is only right for boxes in front of the camera.
+        const double corners = MeasureNanoseconds(iterations, [&]()
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    XMFLOAT3 points[BoundingBox::CORNER_COUNT];
+                    boxes[i].GetCorners(points);
+
+                    float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+
+                    for (auto const& point : points)
+                    {
+                        const Vector3 p = vp.Project(Vector3(point), BenchmarkProj, BenchmarkView, Matrix::Identity);
+
+                        minX = std::min(minX, p.x);
+                        minY = std::min(minY, p.y);
+                        maxX = std::max(maxX, p.x);
+                        maxY = std::max(maxY, p.y);
+                    }
+
+                    cornerBounds[i] = XMFLOAT4(minX, minY, maxX, maxY);
+                }
+            });
+
+        KeepResult(static_cast<uint64_t>(cornerBounds[count / 2].z > cornerBounds[count / 2].x));
+
+        size_t visible = 0;
+
+        const double bounds = MeasureNanoseconds(iterations, [&]()
+            {
+                visible = vp.ProjectBounds(boxes.data(), count, BenchmarkProj, BenchmarkView, Matrix::Identity, rects.data());
+            });
+
+        const double parallel = MeasureNanoseconds(iterations, [&]()
+            {
+                visible = vp.ProjectBoundsParallel(boxes.data(), count, BenchmarkProj, BenchmarkView, Matrix::Identity, rects.data());
+            });
+
+        KeepResult(visible);
+
+        char label[32];
+        snprintf(label, sizeof(label), "%zu boxes", count);
+
+        printf("%-18s %14.3f %14.3f %14.3f\n", label,
+            corners / double(count), bounds / double(count), parallel / double(count));
+    }
+
+    return true;
+}
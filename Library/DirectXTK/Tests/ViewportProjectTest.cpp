@@ -0,0 +1,543 @@
+//--------------------------------------------------------------------------------------
+// File: ViewportProjectTest.cpp
+//
+// Checks the Viewport array Project and Unproject against XMVector3Project and
+// XMVector3Unproject, and ProjectBounds against the projected corners of boxes in front of
+// the camera, for boxes that cross the camera plane, and for boxes off screen.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHarness.h"
+
+#include "SimpleMath.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+using namespace DirectX::SimpleMath;
+
+namespace
+{
+    // Offset from the render target's corner, with a depth range narrower than 0 to 1.
+    const Viewport TestViewport(16.f, 8.f, 640.f, 480.f, 0.1f, 0.9f);
+
+    constexpr float FieldOfView = XM_PIDIV4;
+    constexpr float AspectRatio = 640.f / 480.f;
+
+
+    struct TestCamera
+    {
+        char const* name;
+        Matrix view;
+        Matrix proj;
+        float forward;      // Sign of view space z in front of the camera.
+    };
+
+
+    // Left and right handed, and reversed depth, which swaps the near and far distances.
+    std::vector<TestCamera> MakeCameras()
+    {
+        const XMVECTOR eye = XMVectorSet(1.f, 2.f, -8.f, 0.f);
+
+        const XMMATRIX viewLH = XMMatrixLookAtLH(eye, g_XMZero, g_XMIdentityR1);
+        const XMMATRIX viewRH = XMMatrixLookAtRH(eye, g_XMZero, g_XMIdentityR1);
+
+        return
+        {
+            { "left-handed", viewLH, XMMatrixPerspectiveFovLH(FieldOfView, AspectRatio, 0.1f, 100.f), 1.f },
+            { "right-handed", viewRH, XMMatrixPerspectiveFovRH(FieldOfView, AspectRatio, 0.1f, 100.f), -1.f },
+            { "reversed depth", viewLH, XMMatrixPerspectiveFovLH(FieldOfView, AspectRatio, 100.f, 0.1f), 1.f },
+        };
+    }
+
+
+    // Screen position with XMVector3Project, of a point given in the camera's view space.
+    Vector3 ProjectViewPoint(TestCamera const& camera, float x, float y, float depth)
+    {
+        auto const& vp = TestViewport;
+
+        return XMVector3Project(XMVectorSet(x, y, depth * camera.forward, 0.f),
+            vp.x, vp.y, vp.width, vp.height, vp.minDepth, vp.maxDepth, camera.proj, Matrix::Identity, Matrix::Identity);
+    }
+
+
+    // Boxes are placed in the camera's view space, so world undoes the view.
+    BoundingBox ViewBox(TestCamera const& camera, float x, float y, float depth, float ex, float ey, float ez) noexcept
+    {
+        return BoundingBox(XMFLOAT3(x, y, depth * camera.forward), XMFLOAT3(ex, ey, ez));
+    }
+
+
+    bool IsNear(Vector3 const& actual, Vector3 const& expected, Vector3 const& tolerance) noexcept
+    {
+        return std::fabs(actual.x - expected.x) <= tolerance.x
+            && std::fabs(actual.y - expected.y) <= tolerance.y
+            && std::fabs(actual.z - expected.z) <= tolerance.z;
+    }
+
+
+    bool IsEmpty(Rectangle const& rect) noexcept
+    {
+        return rect.x == 0 && rect.y == 0 && rect.width == 0 && rect.height == 0;
+    }
+
+
+    // The viewport-clipped, whole-pixel rectangle around screen bounds, as ProjectBounds should give.
+    Rectangle BoundsToRectangle(float minX, float minY, float maxX, float maxY) noexcept
+    {
+        auto const& vp = TestViewport;
+
+        minX = std::max(minX, vp.x);
+        minY = std::max(minY, vp.y);
+        maxX = std::min(maxX, vp.x + vp.width);
+        maxY = std::min(maxY, vp.y + vp.height);
+
+        if (minX > maxX || minY > maxY)
+            return Rectangle();
+
+        const auto left = static_cast<long>(std::floor(minX));
+        const auto top = static_cast<long>(std::floor(minY));
+
+        return Rectangle(left, top, static_cast<long>(std::ceil(maxX)) - left, static_cast<long>(std::ceil(maxY)) - top);
+    }
+
+
+    // Each edge may be a pixel out, where the bounds are within rounding of a whole pixel.
+    bool IsNear(Rectangle const& actual, Rectangle const& expected) noexcept
+    {
+        return std::abs(actual.x - expected.x) <= 1
+            && std::abs(actual.y - expected.y) <= 1
+            && std::abs((actual.x + actual.width) - (expected.x + expected.width)) <= 1
+            && std::abs((actual.y + actual.height) - (expected.y + expected.height)) <= 1;
+    }
+
+
+    void PrintRectangle(char const* label, Rectangle const& rect)
+    {
+        printf("  %s: x %ld, y %ld, width %ld, height %ld\n", label, rect.x, rect.y, rect.width, rect.height);
+    }
+
+
+    bool CheckVisibleCount(size_t visible, std::vector<Rectangle> const& rects, char const* name)
+    {
+        const auto expected = static_cast<size_t>(std::count_if(rects.begin(), rects.end(), [](Rectangle const& r) { return !IsEmpty(r); }));
+
+        if (visible != expected)
+        {
+            printf("ERROR: %s: ProjectBounds counted %zu boxes on screen, but returned %zu rectangles\n", name, visible, expected);
+            return false;
+        }
+
+        return true;
+    }
+
+
+    // Every tail length for each width, and either side of the 256 copied to the stack at a time.
+    const size_t TestCounts[] = { 0, 1, 3, 4, 5, 7, 8, 9, 15, 16, 17, 255, 256, 257, 1000 };
+
+    // Combining the matrices changes the rounding. Projected x and y, in pixels, can be a couple of
+    // float steps out at these coordinates. Unproject goes through an inverse, so its points, all
+    // within a few units of the origin, can be further out.
+    const Vector3 ProjectTolerance(1e-3f, 1e-3f, 1e-5f);
+    const Vector3 UnprojectTolerance(1e-3f, 1e-3f, 1e-3f);
+}
+
+
+TEST_CASE(ViewportArrayProjectMatchesXMVector3Project)
+{
+    std::mt19937 rng(24);
+    std::uniform_real_distribution<float> coordinate(-2.f, 2.f);
+
+    auto const& vp = TestViewport;
+
+    const Matrix world = Matrix::CreateScale(1.5f) * Matrix::CreateRotationY(0.3f) * Matrix::CreateTranslation(0.5f, -0.2f, 0.3f);
+
+    for (auto const& camera : MakeCameras())
+    {
+        for (const size_t count : TestCounts)
+        {
+            // In front of the camera, some of them off screen.
+            std::vector<Vector3> points(count);
+            for (auto& p : points)
+            {
+                p = Vector3(coordinate(rng), coordinate(rng), coordinate(rng));
+            }
+
+            std::vector<Vector3> projected(count);
+            vp.Project(points.data(), count, camera.proj, camera.view, world, projected.data());
+
+            std::vector<Vector3> unprojected(count);
+            vp.Unproject(projected.data(), count, camera.proj, camera.view, world, unprojected.data());
+
+            for (size_t i = 0; i < count; i++)
+            {
+                const Vector3 expected = XMVector3Project(points[i], vp.x, vp.y, vp.width, vp.height, vp.minDepth, vp.maxDepth, camera.proj, camera.view, world);
+
+                if (!IsNear(projected[i], expected, ProjectTolerance))
+                {
+                    printf("ERROR: %s, %zu points: Project gave (%.7g, %.7g, %.7g) for point %zu, XMVector3Project (%.7g, %.7g, %.7g)\n",
+                        camera.name, count, double(projected[i].x), double(projected[i].y), double(projected[i].z), i,
+                        double(expected.x), double(expected.y), double(expected.z));
+                    return false;
+                }
+
+                const Vector3 expectedBack = XMVector3Unproject(projected[i], vp.x, vp.y, vp.width, vp.height, vp.minDepth, vp.maxDepth, camera.proj, camera.view, world);
+
+                if (!IsNear(unprojected[i], expectedBack, UnprojectTolerance))
+                {
+                    printf("ERROR: %s, %zu points: Unproject gave (%.7g, %.7g, %.7g) for point %zu, XMVector3Unproject (%.7g, %.7g, %.7g)\n",
+                        camera.name, count, double(unprojected[i].x), double(unprojected[i].y), double(unprojected[i].z), i,
+                        double(expectedBack.x), double(expectedBack.y), double(expectedBack.z));
+                    return false;
+                }
+            }
+
+            // The stream versions go through the same transform, so give the same bits.
+            std::vector<float> x(count), y(count), z(count);
+            for (size_t i = 0; i < count; i++)
+            {
+                x[i] = points[i].x;
+                y[i] = points[i].y;
+                z[i] = points[i].z;
+            }
+
+            const Vector3Stream stream(x.data(), y.data(), z.data());
+
+            vp.Project(stream, count, camera.proj, camera.view, world, stream);
+
+            for (size_t i = 0; i < count; i++)
+            {
+                CHECK(x[i] == projected[i].x && y[i] == projected[i].y && z[i] == projected[i].z);
+            }
+
+            vp.Unproject(stream, count, camera.proj, camera.view, world, stream);
+
+            for (size_t i = 0; i < count; i++)
+            {
+                CHECK(x[i] == unprojected[i].x && y[i] == unprojected[i].y && z[i] == unprojected[i].z);
+            }
+
+            // The results may be written over the inputs.
+            auto aliased = points;
+            vp.Project(aliased.data(), count, camera.proj, camera.view, world, aliased.data());
+            CHECK(count == 0 || memcmp(aliased.data(), projected.data(), count * sizeof(Vector3)) == 0);
+
+            vp.Unproject(aliased.data(), count, camera.proj, camera.view, world, aliased.data());
+            CHECK(count == 0 || memcmp(aliased.data(), unprojected.data(), count * sizeof(Vector3)) == 0);
+        }
+    }
+
+    return true;
+}
+
+
+TEST_CASE(ViewportProjectBoundsMatchesCorners)
+{
+    // Boxes wholly in front of the camera, where the rectangle is the projected corners' bounds.
+    std::mt19937 rng(25);
+    std::uniform_real_distribution<float> position(-12.f, 12.f);
+    std::uniform_real_distribution<float> depth(3.f, 60.f);
+    std::uniform_real_distribution<float> extent(0.f, 2.f);
+
+    auto const& vp = TestViewport;
+
+    for (auto const& camera : MakeCameras())
+    {
+        const Matrix world = camera.view.Invert();
+
+        for (const size_t count : TestCounts)
+        {
+            std::vector<BoundingBox> boxes(count);
+            for (auto& box : boxes)
+            {
+                box = ViewBox(camera, position(rng), position(rng), depth(rng), extent(rng), extent(rng), extent(rng));
+            }
+
+            std::vector<Rectangle> rects(count, Rectangle(-1, -1, -1, -1));
+            const size_t visible = vp.ProjectBounds(boxes.data(), count, camera.proj, camera.view, world, rects.data());
+
+            if (!CheckVisibleCount(visible, rects, camera.name))
+                return false;
+
+            for (size_t i = 0; i < count; i++)
+            {
+                XMFLOAT3 corners[BoundingBox::CORNER_COUNT];
+                boxes[i].GetCorners(corners);
+
+                float bounds[4] = { FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+                for (auto const& corner : corners)
+                {
+                    const Vector3 p = vp.Project(Vector3(corner), camera.proj, camera.view, world);
+
+                    bounds[0] = std::min(bounds[0], p.x);
+                    bounds[1] = std::min(bounds[1], p.y);
+                    bounds[2] = std::max(bounds[2], p.x);
+                    bounds[3] = std::max(bounds[3], p.y);
+                }
+
+                const Rectangle expected = BoundsToRectangle(bounds[0], bounds[1], bounds[2], bounds[3]);
+
+                // Only a box within rounding of the viewport's edge may come out empty on one side and not the other.
+                if (IsEmpty(expected) != IsEmpty(rects[i]))
+                {
+                    const float gap = std::max({ vp.x - bounds[2], vp.y - bounds[3], bounds[0] - (vp.x + vp.width), bounds[1] - (vp.y + vp.height) });
+
+                    if (std::fabs(gap) < 0.01f)
+                        continue;
+                }
+
+                if (!IsNear(rects[i], expected))
+                {
+                    printf("ERROR: %s, %zu boxes: box %zu differs from its projected corners\n", camera.name, count, i);
+                    PrintRectangle("ProjectBounds", rects[i]);
+                    PrintRectangle("corners", expected);
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+
+TEST_CASE(ViewportProjectBoundsOffScreen)
+{
+    auto const& vp = TestViewport;
+
+    // View space x / depth at the edge of the screen.
+    const float edgeX = std::tan(FieldOfView * 0.5f) * AspectRatio;
+    const float edgeY = std::tan(FieldOfView * 0.5f);
+
+    for (auto const& camera : MakeCameras())
+    {
+        const Matrix world = camera.view.Invert();
+
+        const BoundingBox boxes[] =
+        {
+            // Left, right, above and below the screen.
+            ViewBox(camera, -edgeX * 10.f - 2.f, 0.f, 10.f, 1.f, 1.f, 1.f),
+            ViewBox(camera, edgeX * 10.f + 2.f, 0.f, 10.f, 1.f, 1.f, 1.f),
+            ViewBox(camera, 0.f, edgeY * 10.f + 2.f, 10.f, 1.f, 1.f, 1.f),
+            ViewBox(camera, 0.f, -edgeY * 10.f - 2.f, 10.f, 1.f, 1.f, 1.f),
+
+            // Behind the camera, where dividing by w would turn the box around onto the screen.
+            ViewBox(camera, 0.f, 0.f, -5.f, 1.f, 1.f, 1.f),
+            ViewBox(camera, 3.f, -2.f, -20.f, 2.f, 2.f, 2.f),
+            ViewBox(camera, 0.f, 0.f, -1.f, 100.f, 100.f, 0.5f),
+
+            // Across the camera plane, but with the part in front off to the left.
+            ViewBox(camera, -29.f, 0.f, -2.25f, 1.f, 1.f, 2.75f),
+        };
+
+        constexpr size_t count = std::size(boxes);
+
+        std::vector<Rectangle> rects(count, Rectangle(-1, -1, -1, -1));
+        const size_t visible = vp.ProjectBounds(boxes, count, camera.proj, camera.view, world, rects.data());
+
+        for (size_t i = 0; i < count; i++)
+        {
+            if (!IsEmpty(rects[i]))
+            {
+                printf("ERROR: %s: off-screen box %zu was given a rectangle\n", camera.name, i);
+                PrintRectangle("ProjectBounds", rects[i]);
+                return false;
+            }
+        }
+
+        CHECK(visible == 0);
+
+        // Parallel too, where they are a few among many boxes on screen.
+        std::vector<BoundingBox> many(10000, ViewBox(camera, 0.f, 0.f, 10.f, 1.f, 1.f, 1.f));
+
+        for (size_t i = 0; i < count; i++)
+        {
+            many[i * 997] = boxes[i];
+        }
+
+        std::vector<Rectangle> manyRects(many.size());
+        const size_t manyVisible = vp.ProjectBoundsParallel(many.data(), many.size(), camera.proj, camera.view, world, manyRects.data());
+
+        CHECK(manyVisible == many.size() - count);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            CHECK(IsEmpty(manyRects[i * 997]));
+        }
+    }
+
+    return true;
+}
+
+
+TEST_CASE(ViewportProjectBoundsClipsAtCamera)
+{
+    auto const& vp = TestViewport;
+
+    const Rectangle fullScreen(16, 8, 640, 480);
+
+    for (auto const& camera : MakeCameras())
+    {
+        const Matrix world = camera.view.Invert();
+
+        // Around the camera, so it fills the screen.
+        const BoundingBox around = ViewBox(camera, 0.f, 0.f, 0.f, 2.f, 2.f, 2.f);
+
+        // Off to the right and from behind the camera to in front, so only its nearest part to the left
+        // is on screen: the edge at x = 1 and depth 6. Towards the camera it spreads past the other edges.
+        const BoundingBox right = ViewBox(camera, 2.f, 0.f, 2.f, 1.f, 1.f, 4.f);
+
+        const BoundingBox boxes[] = { around, right };
+
+        Rectangle rects[2];
+        const size_t visible = vp.ProjectBounds(boxes, 2, camera.proj, camera.view, world, rects);
+
+        CHECK(visible == 2);
+
+        if (!IsNear(rects[0], fullScreen))
+        {
+            printf("ERROR: %s: box around the camera should fill the screen\n", camera.name);
+            PrintRectangle("ProjectBounds", rects[0]);
+            return false;
+        }
+
+        const float left = ProjectViewPoint(camera, 1.f, 0.f, 6.f).x;
+        const Rectangle expected(static_cast<long>(std::floor(left)), 8, 656 - static_cast<long>(std::floor(left)), 480);
+
+        if (!IsNear(rects[1], expected))
+        {
+            printf("ERROR: %s: box across the camera plane should reach from x = %g to the right of the screen\n", camera.name, double(left));
+            PrintRectangle("ProjectBounds", rects[1]);
+            PrintRectangle("expected", expected);
+            return false;
+        }
+    }
+
+    // Random boxes across the camera plane. The rectangle must take in every point on the boxes'
+    // surfaces that is in front of the camera and on screen.
+    std::mt19937 rng(26);
+    std::uniform_real_distribution<float> position(-6.f, 6.f);
+    std::uniform_real_distribution<float> depth(-2.f, 2.f);
+    std::uniform_real_distribution<float> extent(0.1f, 4.f);
+
+    constexpr int Steps = 16;
+
+    for (auto const& camera : MakeCameras())
+    {
+        const Matrix world = camera.view.Invert();
+
+        std::vector<BoundingBox> boxes;
+
+        while (boxes.size() < 300)
+        {
+            const float d = depth(rng);
+            const float ez = extent(rng);
+
+            if (std::fabs(d) < ez)
+            {
+                boxes.push_back(ViewBox(camera, position(rng), position(rng), d, extent(rng), extent(rng), ez));
+            }
+        }
+
+        std::vector<Rectangle> rects(boxes.size());
+        const size_t visible = vp.ProjectBounds(boxes.data(), boxes.size(), camera.proj, camera.view, world, rects.data());
+
+        if (!CheckVisibleCount(visible, rects, camera.name))
+            return false;
+
+        for (size_t i = 0; i < boxes.size(); i++)
+        {
+            auto const& box = boxes[i];
+            auto const& rect = rects[i];
+
+            for (int a = 0; a <= Steps; a++)
+            {
+                for (int b = 0; b <= Steps; b++)
+                {
+                    for (int c = 0; c <= Steps; c++)
+                    {
+                        // Surface points only.
+                        if (a % Steps && b % Steps && c % Steps)
+                            continue;
+
+                        const float px = box.Center.x + box.Extents.x * (2.f * float(a) / Steps - 1.f);
+                        const float py = box.Center.y + box.Extents.y * (2.f * float(b) / Steps - 1.f);
+                        const float pz = box.Center.z + box.Extents.z * (2.f * float(c) / Steps - 1.f);
+
+                        if (pz * camera.forward < 1e-3f)
+                            continue;
+
+                        const Vector3 p = ProjectViewPoint(camera, px, py, pz * camera.forward);
+
+                        if (p.x < vp.x || p.y < vp.y || p.x > vp.x + vp.width || p.y > vp.y + vp.height)
+                            continue;
+
+                        constexpr float slack = 0.01f;
+
+                        if (p.x < float(rect.x) - slack || p.y < float(rect.y) - slack
+                            || p.x > float(rect.x + rect.width) + slack || p.y > float(rect.y + rect.height) + slack)
+                        {
+                            printf("ERROR: %s: box %zu across the camera plane has a point at (%g, %g) outside its rectangle\n",
+                                camera.name, i, double(p.x), double(p.y));
+                            PrintRectangle("ProjectBounds", rect);
+                            return false;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+
+TEST_CASE(ViewportProjectBoundsParallelMatches)
+{
+    std::mt19937 rng(27);
+    std::uniform_real_distribution<float> position(-15.f, 15.f);
+    std::uniform_real_distribution<float> depth(-10.f, 40.f);
+    std::uniform_real_distribution<float> extent(0.1f, 4.f);
+
+    auto const& vp = TestViewport;
+
+    for (auto const& camera : MakeCameras())
+    {
+        const Matrix world = camera.view.Invert();
+
+        for (const size_t count : { size_t(0), size_t(1), size_t(4097), size_t(100003) })
+        {
+            // On screen, off screen, behind the camera and across the camera plane.
+            std::vector<BoundingBox> boxes(count);
+            for (auto& box : boxes)
+            {
+                box = ViewBox(camera, position(rng), position(rng), depth(rng), extent(rng), extent(rng), extent(rng));
+            }
+
+            std::vector<Rectangle> rects(count);
+            const size_t visible = vp.ProjectBounds(boxes.data(), count, camera.proj, camera.view, world, rects.data());
+
+            std::vector<Rectangle> parallelRects(count, Rectangle(-1, -1, -1, -1));
+            const size_t parallelVisible = vp.ProjectBoundsParallel(boxes.data(), count, camera.proj, camera.view, world, parallelRects.data());
+
+            if (!CheckVisibleCount(visible, rects, camera.name))
+                return false;
+
+            CHECK(parallelVisible == visible);
+            CHECK(count == 0 || memcmp(parallelRects.data(), rects.data(), count * sizeof(Rectangle)) == 0);
+        }
+    }
+
+    return true;
+}
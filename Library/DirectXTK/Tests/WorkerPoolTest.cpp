@@ -0,0 +1,241 @@
+//--------------------------------------------------------------------------------------
+// File: WorkerPoolTest.cpp
+//
+// Checks that WorkerPool::ParallelFor visits every index exactly once, for edge-case
+// counts, nested loops and loops submitted from several threads at once.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHarness.h"
+
+#include "WorkerPool.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+using namespace DirectX;
+using namespace DirectX::Tests;
+
+namespace
+{
+    const size_t WorkerCounts[] = { 0, 1, 3, 7 };
+
+    // Records how often each index was visited, and checks the shape of every chunk.
+    class Coverage
+    {
+    public:
+        Coverage(size_t count, size_t minChunkSize) :
+            mVisits(new std::atomic<uint32_t>[count]),
+            mCount(count),
+            mMinChunkSize(std::max<size_t>(minChunkSize, 1)),
+            mChunks(0),
+            mBadChunks(0)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                mVisits[i] = 0;
+            }
+        }
+
+        void Visit(size_t begin, size_t end)
+        {
+            mChunks++;
+
+            // Only the final chunk may be smaller than the minimum.
+            if (begin >= end || end > mCount || (end - begin < mMinChunkSize && end != mCount))
+            {
+                mBadChunks++;
+                return;
+            }
+
+            for (size_t i = begin; i < end; i++)
+            {
+                mVisits[i]++;
+            }
+        }
+
+        bool Check(const char* context) const
+        {
+            if (mBadChunks)
+            {
+                printf("ERROR: %s: %zu malformed chunks\n", context, size_t(mBadChunks));
+                return false;
+            }
+
+            for (size_t i = 0; i < mCount; i++)
+            {
+                if (mVisits[i] != 1)
+                {
+                    printf("ERROR: %s: index %zu visited %u times\n", context, i, unsigned(mVisits[i]));
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        size_t GetChunkCount() const noexcept { return mChunks; }
+
+    private:
+        std::unique_ptr<std::atomic<uint32_t>[]> mVisits;
+        size_t mCount;
+        size_t mMinChunkSize;
+        std::atomic<size_t> mChunks;
+        std::atomic<size_t> mBadChunks;
+    };
+}
+
+
+TEST_CASE(ParallelForVisitsEachIndexOnce)
+{
+    const size_t counts[] = { 1, 2, 7, 64, 1000, 100003 };
+    const size_t minChunkSizes[] = { 0, 1, 3, 64, 5000 };
+
+    for (const size_t workers : WorkerCounts)
+    {
+        WorkerPool pool(workers);
+
+        CHECK(pool.GetThreadCount() == workers + 1);
+
+        for (const size_t count : counts)
+        {
+            for (const size_t minChunkSize : minChunkSizes)
+            {
+                Coverage coverage(count, minChunkSize);
+
+                pool.ParallelFor(count, minChunkSize, [&](size_t begin, size_t end) { coverage.Visit(begin, end); });
+
+                char context[96];
+                snprintf(context, sizeof(context), "workers %zu, count %zu, min chunk %zu", workers, count, minChunkSize);
+
+                if (!coverage.Check(context))
+                    return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+TEST_CASE(ParallelForZeroAndOne)
+{
+    for (const size_t workers : WorkerCounts)
+    {
+        WorkerPool pool(workers);
+
+        size_t calls = 0;
+
+        pool.ParallelFor(0, 1, [&](size_t, size_t) { calls++; });
+
+        CHECK(calls == 0);
+
+        size_t begin = ~size_t(0);
+        size_t end = ~size_t(0);
+
+        pool.ParallelFor(1, 0, [&](size_t b, size_t e) { calls++; begin = b; end = e; });
+
+        CHECK(calls == 1);
+        CHECK(begin == 0 && end == 1);
+    }
+
+    return true;
+}
+
+
+TEST_CASE(ParallelForSplitsLargeLoops)
+{
+    WorkerPool pool(3);
+
+    Coverage coverage(10000, 16);
+
+    pool.ParallelFor(10000, 16, [&](size_t begin, size_t end) { coverage.Visit(begin, end); });
+
+    CHECK(coverage.Check("split"));
+
+    // Four threads aim for a few chunks each.
+    CHECK(coverage.GetChunkCount() > 1);
+
+    return true;
+}
+
+
+TEST_CASE(ParallelForNested)
+{
+    constexpr size_t OuterCount = 64;
+    constexpr size_t InnerCount = 100;
+
+    for (const size_t workers : WorkerCounts)
+    {
+        WorkerPool pool(workers);
+
+        Coverage coverage(OuterCount * InnerCount, 1);
+
+        std::atomic<size_t> innerCalls(0);
+
+        pool.ParallelFor(OuterCount, 1, [&](size_t outerBegin, size_t outerEnd)
+            {
+                for (size_t outer = outerBegin; outer < outerEnd; outer++)
+                {
+                    pool.ParallelFor(InnerCount, 1, [&](size_t begin, size_t end)
+                        {
+                            innerCalls++;
+                            coverage.Visit(outer * InnerCount + begin, outer * InnerCount + end);
+                        });
+                }
+            });
+
+        CHECK(coverage.Check("nested"));
+
+        // Nested loops run inline as a single chunk.
+        CHECK(innerCalls == OuterCount);
+    }
+
+    return true;
+}
+
+
+TEST_CASE(ParallelForFromSeveralThreads)
+{
+    constexpr size_t CallerCount = 4;
+    constexpr size_t Repeats = 50;
+    constexpr size_t Count = 4096;
+
+    WorkerPool pool(3);
+
+    std::atomic<size_t> failures(0);
+    std::vector<std::thread> callers;
+
+    for (size_t caller = 0; caller < CallerCount; caller++)
+    {
+        callers.emplace_back([&]()
+            {
+                for (size_t repeat = 0; repeat < Repeats; repeat++)
+                {
+                    Coverage coverage(Count, 32);
+
+                    pool.ParallelFor(Count, 32, [&](size_t begin, size_t end) { coverage.Visit(begin, end); });
+
+                    if (!coverage.Check("concurrent callers"))
+                    {
+                        failures++;
+                    }
+                }
+            });
+    }
+
+    for (auto& caller : callers)
+    {
+        caller.join();
+    }
+
+    CHECK(failures == 0);
+
+    return true;
+}